@@ -43,6 +43,7 @@
 #include "mrpd.h"
 #include "mrp.h"
 #include "mmrp.h"
+#include "mrpd_binary.h"
 
 int mmrp_send_notifications(struct mmrp_attribute *attrib, int notify);
 int mmrp_txpdu(void);
@@ -1409,6 +1410,7 @@ int mmrp_send_notifications(struct mmrp_attribute *attrib, int notify)
 	char *regsrc;
 	char mrp_state[8];
 	client_t *client;
+	struct mrpd_bin_notify bin_msg;
 
 	if (NULL == attrib)
 		return -1;
@@ -1464,9 +1466,21 @@ int mmrp_send_notifications(struct mmrp_attribute *attrib, int notify)
 		break;
 	}
 
+	mrp_encode_bin_notify(&bin_msg, notify, &attrib->registrar,
+			      &attrib->applicant);
+	bin_msg.rec.attrib = MRPD_BIN_ATTRIB_MMRP;
+	if (MMRP_SVCREQ_TYPE == attrib->type)
+		bin_msg.rec.u.m.svcreq = attrib->attribute.svcreq;
+	else
+		bin_msg.rec.u.m.mac = mrp_mac_to_u64(attrib->attribute.macaddr);
+
 	client = MMRP_db->mrp_db.clients;
 	while (NULL != client) {
-		mrpd_send_ctl_msg(&(client->client), msgbuf, MAX_MRPD_CMDSZ);
+		if (mrp_client_is_binary(&(client->client)))
+			mrpd_send_ctl_msg(&(client->client), (char *)&bin_msg,
+					  sizeof(bin_msg));
+		else
+			mrpd_send_ctl_msg(&(client->client), msgbuf, MAX_MRPD_CMDSZ);
 		client = client->next;
 	}
 
@@ -40,6 +40,7 @@
 
 #include "mrpd.h"
 #include "mrp.h"
+#include "mrpd_binary.h"
 
 /* state machine controls */
 int p2pmac;
@@ -349,6 +350,23 @@ int mrp_client_remove_all(client_t ** list)
 	return 0;
 }
 
+/* clients that asked for binary notifications */
+static client_t *binary_clients;
+
+int mrp_client_set_binary(struct sockaddr_in *client, int binary)
+{
+	if (binary)
+		return mrp_client_add(&binary_clients, client);
+	return mrp_client_delete(&binary_clients, client);
+}
+
+int mrp_client_is_binary(struct sockaddr_in *client)
+{
+	if (NULL == binary_clients)
+		return 0;
+	return client_lookup(binary_clients, client);
+}
+
 
 int mrp_jointimer_start(struct mrp_database *mrp_db)
 {
@@ -1124,6 +1142,49 @@ int mrp_decode_state(mrp_registrar_attribute_t * rattrib,
 	return 0;
 }
 
+uint64_t mrp_mac_to_u64(const unsigned char macaddr[6])
+{
+	uint64_t v = 0;
+	int i;
+
+	for (i = 0; i < 6; i++)
+		v = (v << 8) | macaddr[i];
+	return v;
+}
+
+void mrp_encode_bin_notify(struct mrpd_bin_notify *msg, int notify,
+			   mrp_registrar_attribute_t * rattrib,
+			   mrp_applicant_attribute_t * aattrib)
+{
+	memset(msg, 0, sizeof(*msg));
+	msg->hdr.magic = MRPD_BIN_MAGIC;
+	msg->hdr.version = MRPD_BIN_VERSION;
+	msg->hdr.count = 1;
+	msg->hdr.record_size = sizeof(struct mrpd_bin_record);
+
+	msg->rec.notify = (uint8_t)notify;
+
+	switch (rattrib->mrp_state) {
+	case MRP_IN_STATE:
+		msg->rec.state = MRPD_BIN_STATE_IN;
+		break;
+	case MRP_LV_STATE:
+		msg->rec.state = MRPD_BIN_STATE_LV;
+		break;
+	case MRP_MT_STATE:
+		msg->rec.state = MRPD_BIN_STATE_MT;
+		break;
+	default:
+		break;
+	}
+
+	if ((aattrib->mrp_state >= MRP_VO_STATE) &&
+	    (aattrib->mrp_state <= MRP_LO_STATE))
+		msg->rec.app_state = (uint8_t)(aattrib->mrp_state + 1);
+
+	msg->rec.registrar = mrp_mac_to_u64(rattrib->macaddr);
+}
+
 int mrp_init(void)
 {
 	p2pmac = MRP_DEFAULT_POINT_TO_POINT_MAC;	/* operPointToPointMAC */
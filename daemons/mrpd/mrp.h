@@ -216,6 +216,13 @@ int mrp_client_add(client_t ** list, struct sockaddr_in *newclient);
 int mrp_client_delete(client_t ** list, struct sockaddr_in *newclient);
 int mrp_client_remove_all(client_t ** list);
 
+/**
+ * Select text (the default) or binary notifications for a client.
+ * \see mrpd_binary.h
+ */
+int mrp_client_set_binary(struct sockaddr_in *client, int binary);
+int mrp_client_is_binary(struct sockaddr_in *client);
+
 int mrp_init(void);
 char *mrp_event_string(int e);
 int mrp_periodictimer_start();
@@ -236,6 +243,15 @@ int mrp_registrar_in(mrp_registrar_attribute_t * attrib);
 int mrp_decode_state(mrp_registrar_attribute_t * rattrib,
 		     mrp_applicant_attribute_t * aattrib, char *str,
 		     int strlen);
+struct mrpd_bin_notify;
+/**
+ * Fill in the header and the state fields of a binary notification and
+ * clear the attribute fields.
+ */
+void mrp_encode_bin_notify(struct mrpd_bin_notify *msg, int notify,
+			   mrp_registrar_attribute_t * rattrib,
+			   mrp_applicant_attribute_t * aattrib);
+uint64_t mrp_mac_to_u64(const unsigned char macaddr[6]);
 int mrp_applicant_state_transition_implies_tx(mrp_applicant_attribute_t * attrib);
 void mrp_schedule_tx_event(struct mrp_database *mrp_db);
 
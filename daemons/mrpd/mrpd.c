@@ -283,6 +283,8 @@ int process_ctl_msg(char *buf, int buflen, struct sockaddr_in *client)
 	 * I+S   Add a stream id to the interesting talker stream id list
 	 * I-S   Remove a stream id from the interesting talker stream id list
 	 * I-A   Remove all stream ids from the interesting talker and listener stream id lists
+	 * N+B   Send notifications to this client as binary records (mrpd_binary.h)
+	 * N-B   Send notifications to this client as text (default)
 	 *
 	 * Outbound messages
 	 * ERC - error, unrecognized command
@@ -341,6 +343,17 @@ int process_ctl_msg(char *buf, int buflen, struct sockaddr_in *client)
 		mmrp_bye(client);
 		mvrp_bye(client);
 		msrp_bye(client);
+		mrp_client_set_binary(client, 0);
+		break;
+	case 'N':
+		/* N+B binary notifications, N-B text notifications */
+		if ((buf[2] == 'B') && ((buf[1] == '+') || (buf[1] == '-'))) {
+			mrp_client_set_binary(client, buf[1] == '+');
+		} else {
+			snprintf(respbuf, sizeof(respbuf) - 1, "ERP %s", buf);
+			mrpd_send_ctl_msg(client, respbuf, sizeof(respbuf));
+			return -1;
+		}
 		break;
 	default:
 		printf("unrecognized command %s\n", buf);
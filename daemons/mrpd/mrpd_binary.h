@@ -0,0 +1,150 @@
+/******************************************************************************
+
+  Copyright (c) 2012, Intel Corporation 
+  All rights reserved.
+  
+  Redistribution and use in source and binary forms, with or without 
+  modification, are permitted provided that the following conditions are met:
+  
+   1. Redistributions of source code must retain the above copyright notice, 
+      this list of conditions and the following disclaimer.
+  
+   2. Redistributions in binary form must reproduce the above copyright 
+      notice, this list of conditions and the following disclaimer in the 
+      documentation and/or other materials provided with the distribution.
+  
+   3. Neither the name of the Intel Corporation nor the names of its 
+      contributors may be used to endorse or promote products derived from 
+      this software without specific prior written permission.
+  
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+
+******************************************************************************/
+
+#ifndef _MRPD_BINARY_H_
+#define _MRPD_BINARY_H_
+
+/*
+ * Binary notification format for mrpd clients.
+ *
+ * By default mrpd reports attribute changes as text ("SJO T:S=...") that
+ * every client has to parse. A client that sends "N+B" gets the same
+ * notifications as fixed-layout records instead, which it can read in place:
+ *
+ *   struct mrpd_bin_hdr | struct mrpd_bin_record * count
+ *
+ * The control socket is bound to 127.0.0.1 only, so records are in host byte
+ * order. Stream IDs, MAC addresses and bridge IDs hold the same values the
+ * text format prints in hex. Clients must step through records by
+ * record_size so later versions can append fields. "N-B" switches the client
+ * back to text; commands and query responses are always text.
+ *
+ * The first byte of a binary message is MRPD_BIN_MAGIC, which is never the
+ * first byte of a text message.
+ */
+
+#include <stdint.h>
+
+#define MRPD_BIN_MAGIC		0xB5
+#define MRPD_BIN_VERSION	1
+
+/* attrib, same values as enum mrpdhelper_attribtype */
+#define MRPD_BIN_ATTRIB_MMRP		1
+#define MRPD_BIN_ATTRIB_MVRP		2
+#define MRPD_BIN_ATTRIB_MSRP_DOMAIN	3
+#define MRPD_BIN_ATTRIB_MSRP_TALKER	4
+#define MRPD_BIN_ATTRIB_MSRP_LISTENER	5
+#define MRPD_BIN_ATTRIB_MSRP_TALKER_FAIL	6
+
+/* notify, same values as MRP_NOTIFY_xxx and enum mrpdhelper_notification */
+#define MRPD_BIN_NOTIFY_NEW	1
+#define MRPD_BIN_NOTIFY_JOIN	2
+#define MRPD_BIN_NOTIFY_LEAVE	3
+
+/* state (registrar), same values as enum mrpdhelper_state */
+#define MRPD_BIN_STATE_IN	1
+#define MRPD_BIN_STATE_LV	2
+#define MRPD_BIN_STATE_MT	3
+
+/* app_state is MRP_xx_STATE + 1, same values as enum mrpdhelper_applicant_state */
+
+struct mrpd_bin_hdr {
+	uint8_t magic;
+	uint8_t version;
+	uint16_t count;		/* records following the header */
+	uint16_t record_size;	/* sizeof(struct mrpd_bin_record) of the sender */
+	uint16_t reserved;
+};
+
+struct mrpd_bin_mmrp {
+	uint64_t mac;		/* 0 for a service requirement */
+	uint32_t svcreq;
+	uint32_t reserved;
+};
+
+struct mrpd_bin_mvrp {
+	uint16_t vid;
+	uint16_t reserved[3];
+};
+
+struct mrpd_bin_msrp_domain {
+	uint8_t id;
+	uint8_t priority;
+	uint8_t neighbor_priority;
+	uint8_t reserved;
+	uint16_t vid;
+	uint16_t reserved2;
+};
+
+struct mrpd_bin_msrp_listener {
+	uint64_t id;
+	uint32_t substate;	/* MSRP_LISTENER_xxx declaration type */
+	uint32_t reserved;
+};
+
+struct mrpd_bin_msrp_talker {
+	uint64_t id;
+	uint64_t dest_mac;
+	uint64_t bridge_id;	/* talker failed only */
+	uint32_t accum_latency;
+	uint16_t vid;
+	uint16_t max_frame_size;
+	uint16_t max_interval_frames;
+	uint8_t priority_and_rank;
+	uint8_t failure_code;	/* talker failed only */
+	uint32_t reserved;
+};
+
+struct mrpd_bin_record {
+	uint8_t attrib;
+	uint8_t notify;
+	uint8_t state;
+	uint8_t app_state;
+	uint32_t reserved;
+	uint64_t registrar;	/* MAC address of the last registration */
+	union {
+		struct mrpd_bin_mmrp m;
+		struct mrpd_bin_mvrp v;
+		struct mrpd_bin_msrp_domain sd;
+		struct mrpd_bin_msrp_listener sl;
+		struct mrpd_bin_msrp_talker st;
+	} u;
+};
+
+/* A single notification as mrpd sends it */
+struct mrpd_bin_notify {
+	struct mrpd_bin_hdr hdr;
+	struct mrpd_bin_record rec;
+};
+
+#endif
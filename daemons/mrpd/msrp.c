@@ -44,6 +44,7 @@
 #include "mrp.h"
 #include "msrp.h"
 #include "mmrp.h"
+#include "mrpd_binary.h"
 
 /*
  * Defines related to parsing command strings from an external mrpd client.
@@ -3016,6 +3017,51 @@ int msrp_txpdu(void)
 	return -1;
 }
 
+static void msrp_encode_bin_notify(struct mrpd_bin_notify *msg,
+				   struct msrp_attribute *attrib, int notify)
+{
+	struct mrpd_bin_record *rec = &msg->rec;
+
+	mrp_encode_bin_notify(msg, notify, &attrib->registrar,
+			      &attrib->applicant);
+
+	if (MSRP_LISTENER_TYPE == attrib->type) {
+		rec->attrib = MRPD_BIN_ATTRIB_MSRP_LISTENER;
+		rec->u.sl.id = eui64_read(attrib->attribute.talk_listen.StreamID);
+		rec->u.sl.substate = attrib->substate;
+	} else if (MSRP_DOMAIN_TYPE == attrib->type) {
+		rec->attrib = MRPD_BIN_ATTRIB_MSRP_DOMAIN;
+		rec->u.sd.id = attrib->attribute.domain.SRclassID;
+		rec->u.sd.priority = attrib->attribute.domain.SRclassPriority;
+		rec->u.sd.neighbor_priority =
+		    attrib->attribute.domain.neighborSRclassPriority;
+		rec->u.sd.vid = attrib->attribute.domain.SRclassVID;
+	} else {
+		rec->u.st.id = eui64_read(attrib->attribute.talk_listen.StreamID);
+		rec->u.st.dest_mac = mrp_mac_to_u64(attrib->attribute.talk_listen.
+						    DataFrameParameters.Dest_Addr);
+		rec->u.st.vid = attrib->attribute.talk_listen.
+		    DataFrameParameters.Vlan_ID;
+		rec->u.st.max_frame_size =
+		    attrib->attribute.talk_listen.TSpec.MaxFrameSize;
+		rec->u.st.max_interval_frames =
+		    attrib->attribute.talk_listen.TSpec.MaxIntervalFrames;
+		rec->u.st.priority_and_rank =
+		    attrib->attribute.talk_listen.PriorityAndRank;
+		rec->u.st.accum_latency =
+		    attrib->attribute.talk_listen.AccumulatedLatency;
+		if (MSRP_TALKER_ADV_TYPE == attrib->type) {
+			rec->attrib = MRPD_BIN_ATTRIB_MSRP_TALKER;
+		} else {
+			rec->attrib = MRPD_BIN_ATTRIB_MSRP_TALKER_FAIL;
+			rec->u.st.bridge_id = eui64_read(attrib->attribute.
+				talk_listen.FailureInformation.BridgeID);
+			rec->u.st.failure_code = attrib->attribute.talk_listen.
+			    FailureInformation.FailureCode;
+		}
+	}
+}
+
 int msrp_send_notifications(struct msrp_attribute *attrib, int notify)
 {
 	char *msgbuf;
@@ -3024,6 +3070,7 @@ int msrp_send_notifications(struct msrp_attribute *attrib, int notify)
 	char mrp_state[8];
 	client_t *client;
 	size_t sub_str_len = 128;
+	struct mrpd_bin_notify bin_msg;
 
 	if (NULL == attrib)
 		return -1;
@@ -3175,9 +3222,15 @@ int msrp_send_notifications(struct msrp_attribute *attrib, int notify)
 		break;
 	}
 
+	msrp_encode_bin_notify(&bin_msg, attrib, notify);
+
 	client = MSRP_db->mrp_db.clients;
 	while (NULL != client) {
-		mrpd_send_ctl_msg(&(client->client), msgbuf, MAX_MRPD_CMDSZ);
+		if (mrp_client_is_binary(&(client->client)))
+			mrpd_send_ctl_msg(&(client->client), (char *)&bin_msg,
+					  sizeof(bin_msg));
+		else
+			mrpd_send_ctl_msg(&(client->client), msgbuf, MAX_MRPD_CMDSZ);
 		client = client->next;
 	}
 
@@ -43,6 +43,7 @@
 #include "mrp.h"
 #include "mvrp.h"
 #include "parse.h"
+#include "mrpd_binary.h"
 
 int mvrp_send_notifications(struct mvrp_attribute *attrib, int notify);
 static struct mvrp_attribute *mvrp_conditional_reclaim(struct mvrp_attribute *sattrib);
@@ -1015,6 +1016,7 @@ int mvrp_send_notifications(struct mvrp_attribute *attrib, int notify)
 	char *regsrc;
 	char mrp_state[8];
 	client_t *client;
+	struct mrpd_bin_notify bin_msg;
 
 	if (NULL == attrib)
 		return -1;
@@ -1061,9 +1063,18 @@ int mvrp_send_notifications(struct mvrp_attribute *attrib, int notify)
 		break;
 	}
 
+	mrp_encode_bin_notify(&bin_msg, notify, &attrib->registrar,
+			      &attrib->applicant);
+	bin_msg.rec.attrib = MRPD_BIN_ATTRIB_MVRP;
+	bin_msg.rec.u.v.vid = attrib->attribute;
+
 	client = MVRP_db->mrp_db.clients;
 	while (NULL != client) {
-		mrpd_send_ctl_msg(&(client->client), msgbuf, MAX_MRPD_CMDSZ);
+		if (mrp_client_is_binary(&(client->client)))
+			mrpd_send_ctl_msg(&(client->client), (char *)&bin_msg,
+					  sizeof(bin_msg));
+		else
+			mrpd_send_ctl_msg(&(client->client), msgbuf, MAX_MRPD_CMDSZ);
 		client = client->next;
 	}
 
@@ -58,6 +58,7 @@ extern "C"
 #include "msrp.h"
 #include "parse.h"
 #include "eui64set.h"
+#include "mrpd_binary.h"
 
 /* Most MSRP commands operate on the global DB */
 extern struct msrp_database *MSRP_db;
@@ -657,4 +658,52 @@ TEST(MsrpTestGroup, TalkerAdvertise_To_Failed_Transition_With_Rx_rIn)
 
 }
 
+/*
+ * A client that selected binary notifications gets a single binary record
+ * with the TalkerAdv fields. After switching back it gets text again.
+ */
+TEST(MsrpTestGroup, Binary_Notification_TalkerAdv)
+{
+	char cmd_string[] = "S++:S=" STREAM_ID \
+		",A=" STREAM_DA \
+		",V=" VLAN_ID \
+		",Z=" TSPEC_MAX_FRAME_SIZE \
+		",I=" TSPEC_MAX_FRAME_INTERVAL \
+		",P=" PRIORITY_AND_RANK \
+		",L=" ACCUMULATED_LATENCY;
+	uint8_t thisStreamID[8] = { 0xDE, 0xAD, 0xBE, 0xEF, 0xBA, 0xDF, 0xCA, 0x11 };
+	struct msrp_attribute *attrib;
+	struct mrpd_bin_notify msg;
+
+	msrp_recv_cmd(cmd_string, sizeof(cmd_string), &client);
+	CHECK(msrp_tests_cmd_ok(test_state.ctl_msg_data));
 
+	attrib = msrp_lookup_stream_declaration(MSRP_TALKER_ADV_TYPE, thisStreamID);
+	CHECK(NULL != attrib);
+
+	LONGS_EQUAL(0, mrp_client_set_binary(&client, 1));
+	CHECK(mrp_client_is_binary(&client));
+
+	msrp_send_notifications(attrib, MRP_NOTIFY_NEW);
+	memcpy(&msg, test_state.ctl_msg_data, sizeof(msg));
+
+	LONGS_EQUAL(MRPD_BIN_MAGIC, msg.hdr.magic);
+	LONGS_EQUAL(MRPD_BIN_VERSION, msg.hdr.version);
+	LONGS_EQUAL(1, msg.hdr.count);
+	LONGS_EQUAL(sizeof(struct mrpd_bin_record), msg.hdr.record_size);
+	LONGS_EQUAL(MRPD_BIN_ATTRIB_MSRP_TALKER, msg.rec.attrib);
+	LONGS_EQUAL(MRPD_BIN_NOTIFY_NEW, msg.rec.notify);
+	CHECK(0xDEADBEEFBADFCA11ull == msg.rec.u.st.id);
+	CHECK(0x010203040506ull == msg.rec.u.st.dest_mac);
+	LONGS_EQUAL(2, msg.rec.u.st.vid);
+	LONGS_EQUAL(576, msg.rec.u.st.max_frame_size);
+	LONGS_EQUAL(8000, msg.rec.u.st.max_interval_frames);
+	LONGS_EQUAL(96, msg.rec.u.st.priority_and_rank);
+	LONGS_EQUAL(1000, msg.rec.u.st.accum_latency);
+
+	LONGS_EQUAL(0, mrp_client_set_binary(&client, 0));
+	CHECK(!mrp_client_is_binary(&client));
+
+	msrp_send_notifications(attrib, MRP_NOTIFY_NEW);
+	CHECK(0 == strncmp(test_state.ctl_msg_data, "SNE T:S=", 8));
+}
@@ -58,6 +58,7 @@ struct alsa_context
 {
 	snd_pcm_t			*alsa_handle;
 	snd_pcm_status_t		*alsa_status;
+	snd_pcm_uframes_t		 mmap_offset;
 	char *devname;
 	isaudk_alsa_error_t	 last_error;
 	const char		*last_error_func;
@@ -339,6 +340,57 @@ bool alsa_queue_output_buffer( isaudk_output_context_t ctx,
 	return true;
 }
 
+bool alsa_map_output_buffer( isaudk_output_context_t ctx,
+			     void **buffer, unsigned *count )
+{
+	const snd_pcm_channel_area_t *areas;
+	snd_pcm_uframes_t frames;
+	snd_pcm_sframes_t avail;
+	int err;
+
+	// Block until there is room, as snd_pcm_mmap_writei() would
+	for( ;; )
+	{
+		avail = snd_pcm_avail_update( ctx->ctx.alsa_handle );
+		err = avail;
+		CHECK_ALSA_RESULT( ISAUDK_ALSA_INTERNAL_ERROR, &ctx->ctx );
+		if( avail > 0 )
+			break;
+
+		err = snd_pcm_wait( ctx->ctx.alsa_handle, -1 );
+		CHECK_ALSA_RESULT( ISAUDK_ALSA_INTERNAL_ERROR, &ctx->ctx );
+	}
+
+	frames = *count;
+	err = snd_pcm_mmap_begin( ctx->ctx.alsa_handle, &areas,
+				  &ctx->ctx.mmap_offset, &frames );
+	CHECK_ALSA_RESULT( ISAUDK_ALSA_INTERNAL_ERROR, &ctx->ctx );
+
+	// Interleaved access, every channel shares the first area
+	*buffer = (char *) areas[0].addr +
+		( areas[0].first + ctx->ctx.mmap_offset * areas[0].step ) / 8;
+	*count = frames;
+	alsa_no_error( &ctx->ctx );
+	return true;
+}
+
+bool alsa_commit_output_buffer( isaudk_output_context_t ctx, unsigned count )
+{
+	snd_pcm_sframes_t err;
+
+	err = snd_pcm_mmap_commit( ctx->ctx.alsa_handle, ctx->ctx.mmap_offset,
+				   count );
+	CHECK_ALSA_RESULT( ISAUDK_ALSA_INTERNAL_ERROR, &ctx->ctx );
+	if( (unsigned) err != count )
+	{
+		alsa_set_error( &ctx->ctx, ISAUDK_ALSA_INTERNAL_ERROR );
+		return false;
+	}
+
+	alsa_no_error( &ctx->ctx );
+	return true;
+}
+
 static struct isaudk_output_fn default_alsa_output_fn =
 {
 	.set_audio_param		= alsa_set_audio_output_param,
@@ -346,6 +398,8 @@ static struct isaudk_output_fn default_alsa_output_fn =
 	.start				= alsa_start_output,
 	.stop				= alsa_stop_output,
 	.queue_output_buffer		= alsa_queue_output_buffer,
+	.map_output_buffer		= alsa_map_output_buffer,
+	.commit_output_buffer		= alsa_commit_output_buffer,
 };
 
 void alsa_delete_output( struct isaudk_output *output )
@@ -52,6 +52,13 @@ struct isaudk_output_fn {
 	// Queue buffer
 	bool ( *queue_output_buffer )( isaudk_output_context_t ctx,
 				       void *buffer, unsigned *count );
+	// Map up to count contiguous frames of the device buffer for writing,
+	// waiting for space. Optional, queue_output_buffer is used if NULL
+	bool ( *map_output_buffer )( isaudk_output_context_t ctx,
+				     void **buffer, unsigned *count );
+	// Commit frames written to the mapped buffer
+	bool ( *commit_output_buffer )( isaudk_output_context_t ctx,
+					unsigned count );
 	// Start
 	bool ( *start )( isaudk_output_context_t ctx );
 
@@ -35,6 +35,7 @@
 #define INIT_H
 
 #define _isaudk_io_init __attribute__((constructor(101)))
+#define _isaudk_mix_init __attribute__((constructor(101)))
 #define _isaudk_mixer_init __attribute__((constructor(102)))
 #define _isaudk_capture_init __attribute__((constructor(102)))
 #define _isaudk_stream_init __attribute__((constructor(103)))
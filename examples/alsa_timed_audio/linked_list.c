@@ -88,6 +88,12 @@ ll_get_head( struct linked_list *list )
 	return NULL;
 }
 
+struct linked_list_element *
+ll_get_next( struct linked_list_element *element )
+{
+	return element->next;
+}
+
 void
 ll_remove_head( struct linked_list *list )
 {
@@ -53,6 +53,9 @@ ll_add_head( linked_list_t list, linked_list_element_t *element );
 linked_list_element_t
 ll_get_head( linked_list_t list );
 
+linked_list_element_t
+ll_get_next( linked_list_element_t element );
+
 linked_list_element_t *
 ll_get_addr( linked_list_element_t element );
 
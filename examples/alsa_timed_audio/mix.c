@@ -0,0 +1,399 @@
+/******************************************************************************
+
+  Copyright (c) 2018, Intel Corporation
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+   1. Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+
+   2. Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+   3. Neither the name of the Intel Corporation nor the names of its
+      contributors may be used to endorse or promote products derived from
+      this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+
+******************************************************************************/
+
+
+#include <mix.h>
+#include <init.h>
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+#define MIX_HAVE_X86
+#include <immintrin.h>
+#elif defined( __aarch64__ )
+#define MIX_HAVE_NEON
+#include <arm_neon.h>
+#endif
+
+// Samples accumulated per pass; the block stays in L1 while every source
+// is added to it
+#define MIX_BLOCK_SAMPLES	( 1024 )
+
+#define MIX_SAMPLE_MAX		( 32767.0f )
+#define MIX_SAMPLE_MIN		( -32768.0f )
+
+struct mix_kernels {
+	isaudk_mix_isa_t isa;
+	// acc[i] += in[i] * gain
+	void ( *accumulate )( float *acc, const int16_t *in, unsigned count,
+			      float gain );
+	// out[i] = saturate( round( acc[i] ))
+	void ( *store )( int16_t *out, const float *acc, unsigned count );
+};
+
+void mix_init( void ) _isaudk_mix_init;
+
+static const struct mix_kernels *mix_kernels;
+
+static void
+accumulate_scalar( float *acc, const int16_t *in, unsigned count, float gain )
+{
+	unsigned i;
+
+	for( i = 0; i < count; ++i )
+		acc[i] += (float) in[i] * gain;
+}
+
+static void
+store_scalar( int16_t *out, const float *acc, unsigned count )
+{
+	unsigned i;
+
+	for( i = 0; i < count; ++i )
+	{
+		float sample = acc[i];
+
+		if( sample > MIX_SAMPLE_MAX )
+			sample = MIX_SAMPLE_MAX;
+		if( sample < MIX_SAMPLE_MIN )
+			sample = MIX_SAMPLE_MIN;
+		out[i] = (int16_t) lrintf( sample );
+	}
+}
+
+static const struct mix_kernels scalar_kernels =
+{
+	ISAUDK_MIX_SCALAR, accumulate_scalar, store_scalar
+};
+
+#ifdef MIX_HAVE_X86
+
+__attribute__((target("sse2")))
+static void
+accumulate_sse2( float *acc, const int16_t *in, unsigned count, float gain )
+{
+	__m128 g = _mm_set1_ps( gain );
+	unsigned i;
+
+	for( i = 0; i + 8 <= count; i += 8 )
+	{
+		__m128i s = _mm_loadu_si128(( const __m128i * )( in + i ));
+		// Sign extend by placing each sample in the upper half
+		__m128i lo = _mm_srai_epi32( _mm_unpacklo_epi16( s, s ), 16 );
+		__m128i hi = _mm_srai_epi32( _mm_unpackhi_epi16( s, s ), 16 );
+		__m128 a0 = _mm_loadu_ps( acc + i );
+		__m128 a1 = _mm_loadu_ps( acc + i + 4 );
+
+		a0 = _mm_add_ps( a0, _mm_mul_ps( _mm_cvtepi32_ps( lo ), g ));
+		a1 = _mm_add_ps( a1, _mm_mul_ps( _mm_cvtepi32_ps( hi ), g ));
+		_mm_storeu_ps( acc + i, a0 );
+		_mm_storeu_ps( acc + i + 4, a1 );
+	}
+	accumulate_scalar( acc + i, in + i, count - i, gain );
+}
+
+__attribute__((target("sse2")))
+static void
+store_sse2( int16_t *out, const float *acc, unsigned count )
+{
+	__m128 max = _mm_set1_ps( MIX_SAMPLE_MAX );
+	__m128 min = _mm_set1_ps( MIX_SAMPLE_MIN );
+	unsigned i;
+
+	for( i = 0; i + 8 <= count; i += 8 )
+	{
+		// Clamp first, out of range conversions return INT_MIN
+		__m128 a0 = _mm_min_ps( _mm_max_ps
+					( _mm_loadu_ps( acc + i ), min ), max );
+		__m128 a1 = _mm_min_ps( _mm_max_ps
+					( _mm_loadu_ps( acc + i + 4 ), min ), max );
+
+		_mm_storeu_si128(( __m128i * )( out + i ),
+				 _mm_packs_epi32( _mm_cvtps_epi32( a0 ),
+						  _mm_cvtps_epi32( a1 )));
+	}
+	store_scalar( out + i, acc + i, count - i );
+}
+
+static const struct mix_kernels sse2_kernels =
+{
+	ISAUDK_MIX_SSE2, accumulate_sse2, store_sse2
+};
+
+__attribute__((target("avx2")))
+static void
+accumulate_avx2( float *acc, const int16_t *in, unsigned count, float gain )
+{
+	__m256 g = _mm256_set1_ps( gain );
+	unsigned i;
+
+	for( i = 0; i + 16 <= count; i += 16 )
+	{
+		__m256i lo = _mm256_cvtepi16_epi32
+			( _mm_loadu_si128(( const __m128i * )( in + i )));
+		__m256i hi = _mm256_cvtepi16_epi32
+			( _mm_loadu_si128(( const __m128i * )( in + i + 8 )));
+		__m256 a0 = _mm256_loadu_ps( acc + i );
+		__m256 a1 = _mm256_loadu_ps( acc + i + 8 );
+
+		a0 = _mm256_add_ps( a0, _mm256_mul_ps
+				    ( _mm256_cvtepi32_ps( lo ), g ));
+		a1 = _mm256_add_ps( a1, _mm256_mul_ps
+				    ( _mm256_cvtepi32_ps( hi ), g ));
+		_mm256_storeu_ps( acc + i, a0 );
+		_mm256_storeu_ps( acc + i + 8, a1 );
+	}
+	accumulate_sse2( acc + i, in + i, count - i, gain );
+}
+
+__attribute__((target("avx2")))
+static void
+store_avx2( int16_t *out, const float *acc, unsigned count )
+{
+	__m256 max = _mm256_set1_ps( MIX_SAMPLE_MAX );
+	__m256 min = _mm256_set1_ps( MIX_SAMPLE_MIN );
+	unsigned i;
+
+	for( i = 0; i + 16 <= count; i += 16 )
+	{
+		__m256 a0 = _mm256_min_ps( _mm256_max_ps
+					   ( _mm256_loadu_ps( acc + i ), min ),
+					   max );
+		__m256 a1 = _mm256_min_ps( _mm256_max_ps
+					   ( _mm256_loadu_ps( acc + i + 8 ),
+					     min ), max );
+		__m256i packed = _mm256_packs_epi32
+			( _mm256_cvtps_epi32( a0 ), _mm256_cvtps_epi32( a1 ));
+
+		// packs works per 128 bit lane, restore sample order
+		_mm256_storeu_si256(( __m256i * )( out + i ),
+				    _mm256_permute4x64_epi64( packed, 0xD8 ));
+	}
+	store_sse2( out + i, acc + i, count - i );
+}
+
+static const struct mix_kernels avx2_kernels =
+{
+	ISAUDK_MIX_AVX2, accumulate_avx2, store_avx2
+};
+
+#endif/*MIX_HAVE_X86*/
+
+#ifdef MIX_HAVE_NEON
+
+static void
+accumulate_neon( float *acc, const int16_t *in, unsigned count, float gain )
+{
+	float32x4_t g = vdupq_n_f32( gain );
+	unsigned i;
+
+	for( i = 0; i + 8 <= count; i += 8 )
+	{
+		int16x8_t s = vld1q_s16( in + i );
+		float32x4_t lo = vcvtq_f32_s32( vmovl_s16( vget_low_s16( s )));
+		float32x4_t hi = vcvtq_f32_s32( vmovl_s16( vget_high_s16( s )));
+
+		vst1q_f32( acc + i, vaddq_f32( vld1q_f32( acc + i ),
+					       vmulq_f32( lo, g )));
+		vst1q_f32( acc + i + 4, vaddq_f32( vld1q_f32( acc + i + 4 ),
+						   vmulq_f32( hi, g )));
+	}
+	accumulate_scalar( acc + i, in + i, count - i, gain );
+}
+
+static void
+store_neon( int16_t *out, const float *acc, unsigned count )
+{
+	unsigned i;
+
+	// Round to nearest and narrow, both saturating
+	for( i = 0; i + 8 <= count; i += 8 )
+	{
+		int32x4_t lo = vcvtnq_s32_f32( vld1q_f32( acc + i ));
+		int32x4_t hi = vcvtnq_s32_f32( vld1q_f32( acc + i + 4 ));
+
+		vst1q_s16( out + i, vcombine_s16( vqmovn_s32( lo ),
+						  vqmovn_s32( hi )));
+	}
+	store_scalar( out + i, acc + i, count - i );
+}
+
+static const struct mix_kernels neon_kernels =
+{
+	ISAUDK_MIX_NEON, accumulate_neon, store_neon
+};
+
+#endif/*MIX_HAVE_NEON*/
+
+static const struct mix_kernels *get_kernels( isaudk_mix_isa_t isa )
+{
+	switch( isa )
+	{
+	default:
+		return NULL;
+	case ISAUDK_MIX_SCALAR:
+		return &scalar_kernels;
+#ifdef MIX_HAVE_X86
+	case ISAUDK_MIX_SSE2:
+		return __builtin_cpu_supports( "sse2" ) ? &sse2_kernels : NULL;
+	case ISAUDK_MIX_AVX2:
+		return __builtin_cpu_supports( "avx2" ) ? &avx2_kernels : NULL;
+#endif
+#ifdef MIX_HAVE_NEON
+	case ISAUDK_MIX_NEON:
+		return &neon_kernels;
+#endif
+	}
+
+	return NULL;
+}
+
+const char *isaudk_mix_isa_name( isaudk_mix_isa_t isa )
+{
+	switch( isa )
+	{
+	default:
+		return "unknown";
+	case ISAUDK_MIX_SCALAR:
+		return "scalar";
+	case ISAUDK_MIX_SSE2:
+		return "sse2";
+	case ISAUDK_MIX_AVX2:
+		return "avx2";
+	case ISAUDK_MIX_NEON:
+		return "neon";
+	}
+
+	return "unknown";
+}
+
+bool isaudk_mix_set_isa( isaudk_mix_isa_t isa )
+{
+	const struct mix_kernels *kernels = get_kernels( isa );
+
+	if( kernels == NULL )
+		return false;
+
+	mix_kernels = kernels;
+	return true;
+}
+
+isaudk_mix_isa_t isaudk_mix_get_isa( void )
+{
+	return mix_kernels->isa;
+}
+
+void mix_init( void )
+{
+	static const isaudk_mix_isa_t best[] =
+		{ ISAUDK_MIX_AVX2, ISAUDK_MIX_SSE2, ISAUDK_MIX_NEON };
+	const char *env = getenv( "ISAUDK_MIX_ISA" );
+	unsigned i;
+
+	mix_kernels = &scalar_kernels;
+#ifdef MIX_HAVE_X86
+	// Constructors may run before libgcc has probed the CPU
+	__builtin_cpu_init();
+#endif
+
+	if( env != NULL )
+	{
+		for( i = ISAUDK_MIX_SCALAR; i <= ISAUDK_MIX_NEON; ++i )
+		{
+			if( strcasecmp( env, isaudk_mix_isa_name( i )) == 0 &&
+			    isaudk_mix_set_isa( i ))
+				return;
+		}
+	}
+
+	for( i = 0; i < sizeof( best ) / sizeof( best[0] ); ++i )
+	{
+		if( isaudk_mix_set_isa( best[i] ))
+			return;
+	}
+}
+
+void
+isaudk_mix_ps16( int16_t *out, int64_t position, unsigned frames,
+		 unsigned channels, const struct isaudk_mix_source *source,
+		 unsigned count )
+{
+	float acc[MIX_BLOCK_SAMPLES] __attribute__((aligned(32)));
+	const struct mix_kernels *kernels = mix_kernels;
+	unsigned block_frames = MIX_BLOCK_SAMPLES / channels;
+
+	while( frames > 0 )
+	{
+		unsigned block = frames < block_frames ? frames : block_frames;
+		int64_t end = position + block;
+		bool silent = true;
+		unsigned i;
+
+		for( i = 0; i < count; ++i )
+		{
+			int64_t first = source[i].start;
+			int64_t last = source[i].start + source[i].frames;
+
+			if( first < position )
+				first = position;
+			if( last > end )
+				last = end;
+			if( first >= last )
+				continue;
+
+			if( silent )
+			{
+				memset( acc, 0, block * channels *
+					sizeof( acc[0] ));
+				silent = false;
+			}
+			kernels->accumulate
+				( acc + ( first - position ) * channels,
+				  source[i].samples +
+				  ( first - source[i].start ) * channels,
+				  ( last - first ) * channels, source[i].gain );
+		}
+
+		if( silent )
+			memset( out, 0, block * channels * sizeof( *out ));
+		else
+			kernels->store( out, acc, block * channels );
+
+		out += block * channels;
+		position += block;
+		frames -= block;
+	}
+}
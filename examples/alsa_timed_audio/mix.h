@@ -0,0 +1,86 @@
+/******************************************************************************
+
+  Copyright (c) 2018, Intel Corporation
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+   1. Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+
+   2. Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+   3. Neither the name of the Intel Corporation nor the names of its
+      contributors may be used to endorse or promote products derived from
+      this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+
+******************************************************************************/
+
+
+#ifndef MIX_H
+#define MIX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// One contiguous run of interleaved PS16 frames placed on the mix timeline
+struct isaudk_mix_source {
+	const int16_t	*samples;
+	unsigned	 frames;
+	int64_t		 start;		// Timeline frame of samples[0]
+	float		 gain;
+};
+
+typedef enum {
+	ISAUDK_MIX_SCALAR,
+	ISAUDK_MIX_SSE2,
+	ISAUDK_MIX_AVX2,
+	ISAUDK_MIX_NEON,
+} isaudk_mix_isa_t;
+
+//! \brief Sum sources into interleaved PS16 output
+//! \details	Renders timeline frames [position, position + frames). Each
+//!		source is scaled by its gain and accumulated in single
+//!		precision; the sum is rounded to nearest and saturated to 16
+//!		bits once, so a single source at unity gain is copied exactly.
+//!		Frames not covered by any source are silence.
+//!
+//! \param out[out]		interleaved output frames
+//! \param position[in]		timeline frame of out[0]
+//! \param frames[in]		number of frames to render
+//! \param channels[in]		channels per frame (output and sources)
+//! \param source[in]		source array
+//! \param count[in]		source array size
+void
+isaudk_mix_ps16( int16_t *out, int64_t position, unsigned frames,
+		 unsigned channels, const struct isaudk_mix_source *source,
+		 unsigned count );
+
+//! \brief Select the kernel used by isaudk_mix_ps16
+//! \details	The best kernel supported by the CPU is selected on first use;
+//!		ISAUDK_MIX_ISA=scalar|sse2|avx2|neon in the environment
+//!		overrides it.
+//!
+//! \return false if the CPU does not support isa
+bool isaudk_mix_set_isa( isaudk_mix_isa_t isa );
+
+isaudk_mix_isa_t isaudk_mix_get_isa( void );
+
+const char *isaudk_mix_isa_name( isaudk_mix_isa_t isa );
+
+#endif/*MIX_H*/
@@ -0,0 +1,177 @@
+/******************************************************************************
+
+  Copyright (c) 2018, Intel Corporation
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+   1. Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+
+   2. Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+   3. Neither the name of the Intel Corporation nor the names of its
+      contributors may be used to endorse or promote products derived from
+      this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+
+******************************************************************************/
+
+
+//! \file mix_bench.c
+//! \brief Measures mixing cost per mixer period for 2 to 64 streams
+//! \details	Each stream contributes the tail of one block and the head of
+//!		the next at its own sample offset, as the mixer loop does.
+//!		Every available kernel is timed and checked against the
+//!		scalar output. Exits non-zero on mismatch.
+//!
+//!		Usage: mix_bench [iterations]
+
+#include <sdk.h>
+#include <mix.h>
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define CHANNELS	( 2 )
+#define PERIOD_FRAMES	( PS16_SAMPLE_COUNT / CHANNELS )
+#define MAX_STREAMS	( 64 )
+
+static int16_t block[MAX_STREAMS][2][PS16_SAMPLE_COUNT];
+static struct isaudk_mix_source source[2 * MAX_STREAMS];
+static int16_t reference[PS16_SAMPLE_COUNT];
+static int16_t out[PS16_SAMPLE_COUNT];
+
+static uint64_t now_ns( void )
+{
+	struct timespec ts;
+
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void setup_sources( unsigned streams )
+{
+	unsigned i;
+
+	for( i = 0; i < streams; ++i )
+	{
+		// Remaining frames of the current block
+		unsigned offset = ( i * 131 ) % PERIOD_FRAMES;
+
+		source[2*i].samples = block[i][0];
+		source[2*i].frames = PERIOD_FRAMES;
+		source[2*i].start = (int64_t) offset - PERIOD_FRAMES;
+		source[2*i].gain = 1.0f / streams * ( 1 + i % 3 );
+
+		source[2*i+1] = source[2*i];
+		source[2*i+1].samples = block[i][1];
+		source[2*i+1].start = offset;
+	}
+}
+
+int main( int argc, char **argv )
+{
+	static const unsigned stream_count[] = { 2, 4, 8, 16, 32, 64 };
+	static const isaudk_mix_isa_t isa[] =
+		{ ISAUDK_MIX_SCALAR, ISAUDK_MIX_SSE2, ISAUDK_MIX_AVX2,
+		  ISAUDK_MIX_NEON };
+	unsigned iterations = 2000;
+	isaudk_mix_isa_t selected = isaudk_mix_get_isa();
+	bool ok = true;
+	unsigned i, j, k;
+
+	if( argc > 1 )
+		iterations = strtoul( argv[1], NULL, 0 );
+	if( iterations == 0 )
+		iterations = 1;
+
+	srand( 1 );
+	for( i = 0; i < MAX_STREAMS; ++i )
+		for( j = 0; j < 2; ++j )
+			for( k = 0; k < PS16_SAMPLE_COUNT; ++k )
+				block[i][j][k] = rand() - RAND_MAX / 2;
+
+	// A single source at unity gain must pass through unchanged
+	source[0].samples = block[0][0];
+	source[0].frames = PERIOD_FRAMES;
+	source[0].start = 0;
+	source[0].gain = 1.0f;
+	for( i = 0; i < sizeof( isa ) / sizeof( isa[0] ); ++i )
+	{
+		if( !isaudk_mix_set_isa( isa[i] ))
+			continue;
+		isaudk_mix_ps16( out, 0, PERIOD_FRAMES, CHANNELS, source, 1 );
+		if( memcmp( out, block[0][0], sizeof( out )) != 0 )
+		{
+			printf( "%s: unity gain is not exact\n",
+				isaudk_mix_isa_name( isa[i] ));
+			ok = false;
+		}
+	}
+
+	printf( "%u frame period, %u channels, %u iterations, default %s\n\n",
+		PERIOD_FRAMES, CHANNELS, iterations,
+		isaudk_mix_isa_name( selected ));
+	printf( "%-8s %8s %12s %14s\n", "kernel", "streams", "us/period",
+		"ns/stream-frm" );
+
+	for( j = 0; j < sizeof( stream_count ) / sizeof( stream_count[0] );
+	     ++j )
+	{
+		unsigned streams = stream_count[j];
+
+		setup_sources( streams );
+		isaudk_mix_set_isa( ISAUDK_MIX_SCALAR );
+		isaudk_mix_ps16( reference, 0, PERIOD_FRAMES, CHANNELS, source,
+				 2 * streams );
+
+		for( i = 0; i < sizeof( isa ) / sizeof( isa[0] ); ++i )
+		{
+			uint64_t start, elapsed;
+			double period_us;
+
+			if( !isaudk_mix_set_isa( isa[i] ))
+				continue;
+
+			start = now_ns();
+			for( k = 0; k < iterations; ++k )
+				isaudk_mix_ps16( out, 0, PERIOD_FRAMES,
+						 CHANNELS, source,
+						 2 * streams );
+			elapsed = now_ns() - start;
+
+			period_us = elapsed / 1000.0 / iterations;
+			printf( "%-8s %8u %12.2f %14.3f\n",
+				isaudk_mix_isa_name( isa[i] ), streams,
+				period_us, period_us * 1000.0 /
+				( (double) streams * PERIOD_FRAMES ));
+
+			if( memcmp( out, reference, sizeof( out )) != 0 )
+			{
+				printf( "%s: output differs from scalar\n",
+					isaudk_mix_isa_name( isa[i] ));
+				ok = false;
+			}
+		}
+	}
+
+	return ok ? 0 : 1;
+}
@@ -40,6 +40,7 @@
 #include <init.h>
 #include <string.h>
 #include <alsa.h>
+#include <mix.h>
 #include <math.h>
 #include <thread_signal.h>
 #include <stdlib.h>
@@ -89,6 +90,16 @@ struct isaudk_mixer_handle {
 	uint64_t samples_written;
 
 	linked_list_t stream_list;
+	// Stream whose start request started the mixer, drives start timing
+	isaudk_stream_handle_t primary;
+
+	// Mix state, owned by the mixer loop. Timeline frame 0 is played at
+	// audio_start_time
+	int64_t mix_position;
+	unsigned mix_size;
+	struct per_stream_sample_buffer **mix_stream;
+	struct isaudk_mix_source *mix_source;
+	int16_t mix_buffer[PS16_SAMPLE_COUNT];
 };
 
 struct per_stream_sample_buffer
@@ -106,6 +117,16 @@ struct per_stream_sample_buffer
 	bool flag;
 	int remainder;
 	isaudk_signal_t signal;
+
+	// Set under the mixer state lock
+	float gain;
+	bool started;
+	struct isaudk_system_time start_time;
+
+	// Owned by the mixer loop
+	bool start_valid;
+	bool done;
+	int64_t block_start;	// Timeline frame of buffer[idx]
 };
 
 void mixer_init( void ) _isaudk_mixer_init;
@@ -127,7 +148,11 @@ bool _mixer_init( struct isaudk_mixer_handle *mixer )
 	mixer->running = false;
 	mixer->start_req = false;
 	mixer->stream_list = ll_alloc();
+	mixer->primary = NULL;
 	mixer->mode = ISAUDK_SILENCE;
+	mixer->mix_size = 0;
+	mixer->mix_stream = NULL;
+	mixer->mix_source = NULL;
 
 	if( isaudk_create_signal( &mixer->wake_signal ) != ISAUDK_SIGNAL_OK )
 	{
@@ -192,6 +217,11 @@ isaudk_mixer_register_stream( struct isaudk_mixer_handle *mixer,
 	sample_buffer->idx = 0;
 	sample_buffer->flag = false;
 	sample_buffer->remainder = PS16_SAMPLE_COUNT/mixer->format.channels;
+	sample_buffer->gain = 1.0f;
+	sample_buffer->started = false;
+	sample_buffer->start_valid = false;
+	sample_buffer->done = false;
+	sample_buffer->block_start = 0;
 	if( isaudk_create_signal( &sample_buffer->signal )
 	    != ISAUDK_SIGNAL_OK )
 	{
@@ -244,6 +274,253 @@ static unsigned get_start_threshold( struct isaudk_mixer_handle *mixer )
 		( NSEC_PER_SEC / ( mixer->rate * ISAUDK_RATE_MULTIPLIER ));
 }
 
+static unsigned get_period_frames( struct isaudk_mixer_handle *mixer )
+{
+	return get_buffer_sample_count( mixer ) / mixer->format.channels;
+}
+
+isaudk_error_t
+isaudk_mixer_set_stream_gain( isaudk_stream_handle_t stream,
+			      struct isaudk_mixer_handle *mixer, float gain )
+{
+	struct per_stream_sample_buffer *buffer;
+
+	if( !isfinite( gain ))
+		return ISAUDK_INVALIDARG;
+
+	buffer = isaudk_stream_get_mixer_private( stream );
+
+	if( pthread_mutex_lock( &mixer->mixer_state_lock ) != 0 )
+		return ISAUDK_PTHREAD;
+	buffer->gain = gain;
+	if( pthread_mutex_unlock( &mixer->mixer_state_lock ) != 0 )
+		return ISAUDK_PTHREAD;
+
+	return ISAUDK_SUCCESS;
+}
+
+// Timeline frame closest to the requested stream start time, never
+// earlier than the period being mixed
+static int64_t
+get_stream_start_frame( struct isaudk_mixer_handle *mixer,
+			struct per_stream_sample_buffer *stream_buffer )
+{
+	double delta;
+	int64_t frame;
+
+	delta  = (double) stream_buffer->start_time.time;
+	delta -= mixer->audio_start_time.time;
+	frame = llround( delta * ( mixer->rate * ISAUDK_RATE_MULTIPLIER ) /
+			 NSEC_PER_SEC );
+
+	if( frame < mixer->mix_position )
+		frame = mixer->mix_position;
+
+	return frame;
+}
+
+// Wait until a buffer has been written by the client
+static void
+mixer_wait_buffer( struct isaudk_mixer_handle *mixer,
+		   struct per_stream_sample_buffer *stream_buffer,
+		   unsigned idx )
+{
+	while( stream_buffer->read_seq[idx] != stream_buffer->write_seq[idx] )
+		isaudk_signal_wait( mixer->wake_signal, 0 );
+}
+
+// Collect the started streams, growing the mix arrays as needed
+static bool
+mixer_get_streams( struct isaudk_mixer_handle *mixer, unsigned *count )
+{
+	linked_list_element_t iter;
+	unsigned total = 0;
+	bool ret = true;
+
+	if( pthread_mutex_lock( &mixer->mixer_state_lock ) != 0 )
+		return false;
+
+	for( iter = ll_get_head( mixer->stream_list ); iter != NULL;
+	     iter = ll_get_next( iter ))
+		++total;
+
+	if( total > mixer->mix_size )
+	{
+		struct per_stream_sample_buffer **mix_stream;
+		struct isaudk_mix_source *mix_source;
+
+		mix_stream = (__typeof__(mix_stream)) realloc
+			( mixer->mix_stream, total * sizeof( *mix_stream ));
+		if( mix_stream != NULL )
+			mixer->mix_stream = mix_stream;
+		// Each stream contributes at most two buffers per period
+		mix_source = (__typeof__(mix_source)) realloc
+			( mixer->mix_source, 2 * total * sizeof( *mix_source ));
+		if( mix_source != NULL )
+			mixer->mix_source = mix_source;
+		if( mix_stream == NULL || mix_source == NULL )
+		{
+			ret = false;
+			goto unlock;
+		}
+		mixer->mix_size = total;
+	}
+
+	*count = 0;
+	for( iter = ll_get_head( mixer->stream_list ); iter != NULL;
+	     iter = ll_get_next( iter ))
+	{
+		struct per_stream_sample_buffer *stream_buffer;
+
+		stream_buffer = isaudk_stream_get_mixer_private
+			( isaudk_mixer_reference_to_stream
+			  ( ll_get_addr( iter )));
+		if( stream_buffer->started && !stream_buffer->done )
+			mixer->mix_stream[(*count)++] = stream_buffer;
+	}
+
+unlock:
+	if( pthread_mutex_unlock( &mixer->mixer_state_lock ) != 0 )
+		return false;
+
+	return ret;
+}
+
+// Mix one period of every started stream at mix_position and write it to
+// the output, directly into the device buffer when the output allows.
+// Buffers that have been played out are returned to their streams.
+static bool
+mixer_mix_period( struct isaudk_mixer_handle *mixer, bool *done )
+{
+	struct isaudk_output *output = mixer->output;
+	unsigned channels = mixer->format.channels;
+	unsigned period = get_period_frames( mixer );
+	int64_t position = mixer->mix_position;
+	unsigned stream_count, source_count = 0;
+	unsigned i;
+
+	if( !mixer_get_streams( mixer, &stream_count ))
+		return false;
+
+	for( i = 0; i < stream_count; ++i )
+	{
+		struct per_stream_sample_buffer *stream_buffer;
+		struct isaudk_mix_source *source;
+		unsigned idx;
+		float gain;
+
+		stream_buffer = mixer->mix_stream[i];
+		if( !stream_buffer->start_valid )
+		{
+			stream_buffer->block_start =
+				get_stream_start_frame( mixer, stream_buffer );
+			stream_buffer->start_valid = true;
+		}
+		if( stream_buffer->block_start >= position + period )
+			continue;
+
+		pthread_mutex_lock( &mixer->mixer_state_lock );
+		gain = stream_buffer->gain;
+		pthread_mutex_unlock( &mixer->mixer_state_lock );
+
+		// Remainder of the current buffer
+		idx = stream_buffer->idx;
+		mixer_wait_buffer( mixer, stream_buffer, idx );
+		source = mixer->mix_source + source_count++;
+		source->samples = get_buffer_pointer
+			( &mixer->format, stream_buffer->buffer + idx );
+		source->frames = stream_buffer->count[idx];
+		source->start = stream_buffer->block_start;
+		source->gain = gain;
+
+		// Start of the next one
+		if( stream_buffer->block_start < position &&
+		    stream_buffer->eos != idx )
+		{
+			idx = ( idx + 1 ) % PER_STREAM_BUFFER_COUNT;
+			mixer_wait_buffer( mixer, stream_buffer, idx );
+			source = mixer->mix_source + source_count++;
+			source->samples = get_buffer_pointer
+				( &mixer->format, stream_buffer->buffer + idx );
+			source->frames = stream_buffer->count[idx];
+			source->start = stream_buffer->block_start + period;
+			source->gain = gain;
+		}
+	}
+
+	if( output->fn->map_output_buffer != NULL )
+	{
+		int64_t mapped_position = position;
+		unsigned remaining = period;
+
+		while( remaining > 0 )
+		{
+			void *area;
+			unsigned frames = remaining;
+
+			if( !output->fn->map_output_buffer
+			    ( output->ctx, &area, &frames ))
+				return false;
+			isaudk_mix_ps16( (int16_t *) area, mapped_position,
+					 frames, channels, mixer->mix_source,
+					 source_count );
+			if( !output->fn->commit_output_buffer
+			    ( output->ctx, frames ))
+				return false;
+
+			mapped_position += frames;
+			remaining -= frames;
+		}
+	}
+	else
+	{
+		unsigned frames = period;
+
+		isaudk_mix_ps16( mixer->mix_buffer, position, period, channels,
+				 mixer->mix_source, source_count );
+		if( !output->fn->queue_output_buffer
+		    ( output->ctx, mixer->mix_buffer, &frames ))
+			return false;
+	}
+
+	*done = true;
+	for( i = 0; i < stream_count; ++i )
+	{
+		struct per_stream_sample_buffer *stream_buffer;
+		unsigned idx, length;
+		bool active;
+
+		stream_buffer = mixer->mix_stream[i];
+		idx = stream_buffer->idx;
+		length = stream_buffer->eos == idx ?
+			stream_buffer->count[idx] : period;
+		active = stream_buffer->block_start < position + period;
+
+		if( stream_buffer->block_start + length <= position + period )
+		{
+			++stream_buffer->read_seq[idx];
+			if( stream_buffer->eos == idx )
+			{
+				stream_buffer->done = true;
+			}
+			else
+			{
+				stream_buffer->idx = ( idx + 1 ) %
+					PER_STREAM_BUFFER_COUNT;
+				stream_buffer->block_start += period;
+			}
+		}
+		if( active )
+			isaudk_signal_send( stream_buffer->signal );
+
+		if( !stream_buffer->done )
+			*done = false;
+	}
+
+	mixer->mix_position += period;
+	return true;
+}
+
 isaudk_error_t
 isaudk_mixer_set_buffer_sample_count( isaudk_stream_handle_t stream,
 				      struct isaudk_mixer_handle *mixer,
@@ -287,6 +564,24 @@ isaudk_mixer_set_buffer_sample_count( isaudk_stream_handle_t stream,
 	return ISAUDK_SUCCESS;
 }
 
+static void
+mixer_signal_streams( struct isaudk_mixer_handle *mixer )
+{
+	linked_list_element_t iter;
+	struct per_stream_sample_buffer *stream_buffer;
+
+	pthread_mutex_lock( &mixer->mixer_state_lock );
+	for( iter = ll_get_head( mixer->stream_list ); iter != NULL;
+	     iter = ll_get_next( iter ))
+	{
+		stream_buffer = isaudk_stream_get_mixer_private
+			( isaudk_mixer_reference_to_stream
+			  ( ll_get_addr( iter )));
+		isaudk_signal_send( stream_buffer->signal );
+	}
+	pthread_mutex_unlock( &mixer->mixer_state_lock );
+}
+
 struct mixer_loop_arg
 {
 	struct isaudk_mixer_handle *mixer;
@@ -323,11 +618,9 @@ void *mixer_loop( void *_arg )
 	int64_t remainder_sample_count, wait_buffer_count = -10, wait_time;
 	int64_t wait_samples, samples_played = 0;
 	double small_remainder;
+	bool mix_done = false;
 
 	void *buffer;
-	void *buffer_from;
-	void *next_buffer;
-	void *audio_buffer;
 	isaudk_stream_handle_t stream;
 
 	mixer->running = true;
@@ -364,12 +657,12 @@ void *mixer_loop( void *_arg )
 		bool write_result;
 		struct isaudk_cross_time curr_cross_time;
 		int16_t SILENCE[PS16_SAMPLE_COUNT] = {0};
-		int16_t offset;
-		int buffer_idx;
 
 		MIXER_LOOP_LOCK_MIXER;
-		stream = isaudk_mixer_reference_to_stream
-			( ll_get_addr( ll_get_head( mixer->stream_list )) );
+		stream = mixer->primary;
+		if( stream == NULL )
+			stream = isaudk_mixer_reference_to_stream
+				( ll_get_addr( ll_get_head( mixer->stream_list )) );
 		MIXER_LOOP_UNLOCK_MIXER;
 
 		stream_buffer = isaudk_stream_get_mixer_private( stream );
@@ -378,28 +671,15 @@ void *mixer_loop( void *_arg )
 			( &mixer->format,
 			  stream_buffer->buffer + stream_buffer->idx );
 
-		// Play buffer
-		while( stream_buffer->read_seq[stream_buffer->idx] !=
-		       stream_buffer->write_seq[stream_buffer->idx] )
-		{
-			isaudk_signal_wait( mixer->wake_signal, 0 );
-		}
-
-		samples_to_write = stream_buffer->count[stream_buffer->idx];
 		if  (mixer->mode == ISAUDK_AUDIO) {
-			buffer_idx = stream_buffer->idx;
-			audio_buffer = get_buffer_pointer( &mixer->format, stream_buffer->buffer + buffer_idx );
-			if ( buffer_idx == (PER_STREAM_BUFFER_COUNT - 1) ) {
-				next_buffer = get_buffer_pointer( &mixer->format, stream_buffer->buffer );
-			}
-			else {
-				next_buffer = get_buffer_pointer( &mixer->format, stream_buffer->buffer + buffer_idx + 1 );
-			}
-			memcpy( (void *)( SILENCE ), (const void *)( &((int16_t *)(audio_buffer))[PS16_SAMPLE_COUNT - offset] ), offset*sizeof(int16_t) );
-			memcpy( (void *)( &(SILENCE[offset]) ), (const void *)(next_buffer), (PS16_SAMPLE_COUNT - offset)*sizeof(int16_t) );
-			write_result = mixer->output->fn->queue_output_buffer( mixer->output->ctx, SILENCE, &samples_to_write );
+			// Sum every started stream
+			samples_to_write = get_period_frames( mixer );
+			write_result = mixer_mix_period( mixer, &mix_done );
 		}
 		else {
+			// Play silence until the start time is known
+			mixer_wait_buffer( mixer, stream_buffer, stream_buffer->idx );
+			samples_to_write = stream_buffer->count[stream_buffer->idx];
 			write_result = mixer->output->fn->queue_output_buffer( mixer->output->ctx, SILENCE, &samples_to_write );
 		}
 
@@ -415,9 +695,6 @@ void *mixer_loop( void *_arg )
 		}
 
 		mixer->samples_written += samples_to_write;
-		if  (mixer->mode == ISAUDK_AUDIO ) {
-			++stream_buffer->read_seq[stream_buffer->idx];
-		}
 
 		if( !mixer->playing )
 		{
@@ -479,25 +756,23 @@ void *mixer_loop( void *_arg )
 				buffer_cycles_done = 0;
 
 				samples_to_write = PS16_SAMPLE_COUNT/2;
-				offset = 2*remainder_sample_count;
 				for (int i = 0; i < wait_buffer_count; i++) {
 					write_result = mixer->output->fn->queue_output_buffer
 						( mixer->output->ctx, SILENCE, &samples_to_write );
 				}
 
-
-				for (int i = 0; i < offset; i++) {
-					SILENCE[i] = 0;
-				}
-				buffer_from = get_buffer_pointer( &mixer->format,stream_buffer->buffer );
-				memcpy( (void *)( &(SILENCE[offset]) ), (const void *)buffer_from, (PS16_SAMPLE_COUNT - offset)*sizeof(int16_t) );
-
-				write_result = mixer->output->fn->queue_output_buffer
-					( mixer->output->ctx, SILENCE, &samples_to_write );
-
 				mixer->audio_start_time.time =mixer->start_time.time + wait_time - small_remainder;
+
+				// The next period starts remainder frames before
+				// the primary stream, other streams are placed
+				// relative to it by their own start time
+				mixer->mix_position = -remainder_sample_count;
 				stream_buffer->idx = 0;
-				++stream_buffer->read_seq[stream_buffer->idx];
+				stream_buffer->block_start = 0;
+				stream_buffer->start_valid = true;
+				MIXER_LOOP_LOCK_MIXER;
+				stream_buffer->started = true;
+				MIXER_LOOP_UNLOCK_MIXER;
 				stream_buffer->remainder = remainder_sample_count;
 				mixer->start_time.time = mixer->requested_start_time.time;
 				mixer->mode = ISAUDK_AUDIO;
@@ -518,14 +793,10 @@ void *mixer_loop( void *_arg )
 			// Signal for more data
 			MIXER_LOOP_UNLOCK_MIXER;
 		}
-		if ( mixer->mode == ISAUDK_AUDIO ) {
-			isaudk_signal_send( stream_buffer->signal );
-			if( stream_buffer->eos == stream_buffer->idx )
-			{
-				mixer->output->fn->stop( mixer->output->ctx );
-				break;
-			}
-			stream_buffer->idx = ( stream_buffer->idx + 1 ) %PER_STREAM_BUFFER_COUNT;
+		// Every stream has played its end-of-stream buffer
+		if ( mixer->mode == ISAUDK_AUDIO && mix_done ) {
+			mixer->output->fn->stop( mixer->output->ctx );
+			break;
 		}
 
 	}
@@ -535,7 +806,7 @@ void *mixer_loop( void *_arg )
 
 	// Send a signal at the end, if we exit abnormally the client may
 	// be "hung" waiting for a signal
-	isaudk_signal_send( stream_buffer->signal );
+	mixer_signal_streams( mixer );
 
 	return NULL;
 }
@@ -596,6 +867,30 @@ unlock:
 	return ret;
 }
 
+isaudk_error_t
+isaudk_mixer_start_stream( isaudk_stream_handle_t stream,
+			   struct isaudk_mixer_handle *mixer,
+			   struct isaudk_system_time start_time )
+{
+	struct per_stream_sample_buffer *buffer;
+
+	buffer = isaudk_stream_get_mixer_private( stream );
+
+	if( pthread_mutex_lock( &mixer->mixer_state_lock ) != 0 )
+		return ISAUDK_PTHREAD;
+	buffer->start_time = start_time;
+	buffer->started = true;
+	// The first stream started sets the mixer start time
+	if( mixer->primary == NULL )
+		mixer->primary = stream;
+	if( pthread_mutex_unlock( &mixer->mixer_state_lock ) != 0 )
+		return ISAUDK_PTHREAD;
+
+	isaudk_signal_send( mixer->wake_signal );
+
+	return isaudk_start_mixer( mixer, start_time );
+}
+
 isaudk_error_t
 isaudk_drain_mixer( struct isaudk_mixer_handle *mixer )
 {
@@ -41,6 +41,15 @@ isaudk_mixer_handle_t isaudk_get_default_mixer();
 isaudk_error_t
 isaudk_start_mixer( isaudk_mixer_handle_t mixer, struct isaudk_system_time start_time );
 
+isaudk_error_t
+isaudk_mixer_start_stream( isaudk_stream_handle_t stream,
+			   isaudk_mixer_handle_t mixer,
+			   struct isaudk_system_time start_time );
+
+isaudk_error_t
+isaudk_mixer_set_stream_gain( isaudk_stream_handle_t stream,
+			      isaudk_mixer_handle_t mixer, float gain );
+
 void isaudk_mixer_get_stream_buffer( isaudk_stream_handle_t stream,
 				     isaudk_sample_block_t **sample_buffer,
 				     unsigned *count,
@@ -343,6 +343,9 @@ isaudk_stream_mark_buffer_done( isaudk_stream_handle_t stream, size_t idx );
 
 //! \brief Request stream start time.
 //! \details	Is accurated within 1 samples period. \see ISAUDK_PLAY_IMMED
+//!		The first stream started sets the mixer start time, streams
+//!		sharing the mixer begin at the sample nearest their own
+//!		start time, or immediately if it has passed.
 //! \ingroup StreamAPI
 //!
 //! \param handle[in]		stream_handle
@@ -353,6 +356,18 @@ isaudk_error_t
 isaudk_start_stream_at( isaudk_stream_handle_t handle,
 			struct isaudk_system_time start_time );
 
+//! \brief Set stream gain.
+//! \details	Linear factor applied when the stream is mixed, 1.0 leaves
+//!		samples unchanged. The mixed output saturates at full scale.
+//! \ingroup StreamAPI
+//!
+//! \param handle[in]		stream_handle
+//! \param gain[in]		linear gain
+//!
+//! \return Return code
+isaudk_error_t
+isaudk_set_stream_gain( isaudk_stream_handle_t handle, float gain );
+
 //! \brief Get actual stream start time.
 //! \details	In nanosecond units, accurate within system clock tick
 //!		usually sub-microsecond
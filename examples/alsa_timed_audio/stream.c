@@ -310,13 +310,23 @@ isaudk_start_stream_at( struct isaudk_stream_handle *handle,
 
 
 	if( handle->direction == ISAUDK_RENDER )
-		return isaudk_start_mixer( handle->mixer, start_time );
+		return isaudk_mixer_start_stream
+			( handle, handle->mixer, start_time );
 	else
 		return isaudk_start_capture( handle->capture );
 
 	return ISAUDK_UNIMPL;
 }
 
+isaudk_error_t
+isaudk_set_stream_gain( struct isaudk_stream_handle *handle, float gain )
+{
+	if( handle->direction != ISAUDK_RENDER )
+		return ISAUDK_INVALIDARG;
+
+	return isaudk_mixer_set_stream_gain( handle, handle->mixer, gain );
+}
+
 isaudk_error_t
 isaudk_get_stream_start_time( isaudk_stream_handle_t handle,
 			      struct isaudk_system_time *start_time )
@@ -129,6 +129,21 @@ int mrpdclient_recv(SOCKET mrpd_sock, ptr_process_mrpd_msg fn)
 	return (-1);
 }
 
+int mrpdclient_set_binary(SOCKET mrpd_sock, int binary)
+{
+	char cmd[] = "N+B";
+	int rc;
+
+	if (!binary)
+		cmd[1] = '-';
+
+	rc = mrpdclient_sendto(mrpd_sock, cmd, sizeof(cmd));
+	if (rc != sizeof(cmd))
+		return -1;
+
+	return 0;
+}
+
 int mrpdclient_sendto(SOCKET mrpd_sock, char *notify_data, int notify_len)
 {
 	struct sockaddr_in addr;
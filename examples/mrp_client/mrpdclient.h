@@ -44,4 +44,11 @@ int mrpdclient_recv(SOCKET mrpd_sock, ptr_process_mrpd_msg fn);
 int mrpdclient_sendto(SOCKET mrpd_sock, char *notify_data, int notify_len);
 int mrpdclient_close(SOCKET *mrpd_sock);
 
+/*
+ * Ask mrpd for binary (binary != 0) or text notifications on this socket.
+ * Decode them with mrpdhelper_parse_notification() or read the records in
+ * place with mrpdhelper_bin_record().
+ */
+int mrpdclient_set_binary(SOCKET mrpd_sock, int binary);
+
 #endif
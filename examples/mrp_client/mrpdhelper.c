@@ -307,9 +307,118 @@ static int parse_mmrp(char *sz, size_t len, struct mrpdhelper_notify *n)
 	return parse_registrar(sz, n, NULL);
 }
 
+unsigned int mrpdhelper_bin_count(const char *buf, size_t len)
+{
+	struct mrpd_bin_hdr hdr;
+
+	if (len < sizeof(hdr) || (uint8_t)buf[0] != MRPD_BIN_MAGIC)
+		return 0;
+
+	memcpy(&hdr, buf, sizeof(hdr));
+	/* later versions may append fields to a record, never remove them */
+	if (hdr.version < MRPD_BIN_VERSION ||
+	    hdr.record_size < sizeof(struct mrpd_bin_record) ||
+	    (hdr.record_size & 7))
+		return 0;
+	if ((len - sizeof(hdr)) / hdr.record_size < hdr.count)
+		return 0;
+
+	return hdr.count;
+}
+
+const struct mrpd_bin_record *mrpdhelper_bin_record(const char *buf,
+						    size_t len,
+						    unsigned int index)
+{
+	const struct mrpd_bin_hdr *hdr = (const struct mrpd_bin_hdr *)buf;
+
+	if (index >= mrpdhelper_bin_count(buf, len))
+		return NULL;
+
+	return (const struct mrpd_bin_record *)(buf + sizeof(*hdr) +
+						(size_t)index * hdr->record_size);
+}
+
+int mrpdhelper_bin_to_notify(const struct mrpd_bin_record *rec,
+			     struct mrpdhelper_notify *n)
+{
+	memset(n, 0, sizeof(*n));
+
+	if (rec->notify < mrpdhelper_notification_new ||
+	    rec->notify > mrpdhelper_notification_leave)
+		return -1;
+	if (rec->state < mrpdhelper_state_in ||
+	    rec->state > mrpdhelper_state_empty)
+		return -1;
+	if (rec->app_state == mrpdhelper_applicant_state_null ||
+	    rec->app_state > mrpdhelper_applicant_state_LO)
+		return -1;
+
+	n->notify = (enum mrpdhelper_notification)rec->notify;
+	n->state = (enum mrpdhelper_state)rec->state;
+	n->app_state = (enum mrpdhelper_applicant_state)rec->app_state;
+	n->registrar = rec->registrar;
+
+	switch (rec->attrib) {
+	case MRPD_BIN_ATTRIB_MMRP:
+		n->attrib = mrpdhelper_attribtype_mmrp;
+		n->u.m.mac = rec->u.m.mac;
+		break;
+	case MRPD_BIN_ATTRIB_MVRP:
+		n->attrib = mrpdhelper_attribtype_mvrp;
+		n->u.v.vid = rec->u.v.vid;
+		break;
+	case MRPD_BIN_ATTRIB_MSRP_DOMAIN:
+		n->attrib = mrpdhelper_attribtype_msrp_domain;
+		n->u.sd.id = rec->u.sd.id;
+		n->u.sd.priority = rec->u.sd.priority;
+		n->u.sd.vid = rec->u.sd.vid;
+		n->u.sd.neighbor_priority = rec->u.sd.neighbor_priority;
+		break;
+	case MRPD_BIN_ATTRIB_MSRP_LISTENER:
+		n->attrib = mrpdhelper_attribtype_msrp_listener;
+		n->u.sl.substate = rec->u.sl.substate;
+		n->u.sl.id = rec->u.sl.id;
+		break;
+	case MRPD_BIN_ATTRIB_MSRP_TALKER:
+	case MRPD_BIN_ATTRIB_MSRP_TALKER_FAIL:
+		n->attrib = (rec->attrib == MRPD_BIN_ATTRIB_MSRP_TALKER) ?
+		    mrpdhelper_attribtype_msrp_talker :
+		    mrpdhelper_attribtype_msrp_talker_fail;
+		n->u.st.id = rec->u.st.id;
+		n->u.st.dest_mac = rec->u.st.dest_mac;
+		n->u.st.vid = rec->u.st.vid;
+		n->u.st.max_frame_size = rec->u.st.max_frame_size;
+		n->u.st.max_interval_frames = rec->u.st.max_interval_frames;
+		n->u.st.priority_and_rank = rec->u.st.priority_and_rank;
+		n->u.st.accum_latency = rec->u.st.accum_latency;
+		n->u.st.bridge_id = rec->u.st.bridge_id;
+		n->u.st.failure_code = rec->u.st.failure_code;
+		break;
+	default:
+		return -1;
+	}
+	return 0;
+}
+
+static int parse_bin(char *sz, size_t len, struct mrpdhelper_notify *n)
+{
+	struct mrpd_bin_record rec;
+
+	if (mrpdhelper_bin_count(sz, len) < 1)
+		return -1;
+
+	/* copy, the receive buffer may not be aligned */
+	memcpy(&rec, sz + sizeof(struct mrpd_bin_hdr), sizeof(rec));
+	return mrpdhelper_bin_to_notify(&rec, n);
+}
+
 int mrpdhelper_parse_notification(char *sz, size_t len,
 				  struct mrpdhelper_notify *n)
 {
+	if ((uint8_t)sz[0] == MRPD_BIN_MAGIC)
+		return parse_bin(sz, len, n);
+
 	memset(n, 0, sizeof(*n));
 	switch (sz[0]) {
 	case 'V':
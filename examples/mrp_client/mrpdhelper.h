@@ -38,6 +38,9 @@
 This module provides helper functions for communicating with the MRPD daemon.
 ***************************************************************************/
 
+#include <stddef.h>
+#include "mrpd_binary.h"
+
 enum mrpdhelper_talkerfailed_codes {
 	mrpdhelper_talkerfailed_success,
 	mrpdhelper_talkerfailed_bandwidth,
@@ -156,9 +159,27 @@ struct mrpdhelper_notify {
 	} u;
 };
 
+/*
+ * Parse one notification, text or binary. Binary messages (after
+ * mrpdclient_set_binary()) are decoded without any string handling; only
+ * the first record is returned.
+ */
 int mrpdhelper_parse_notification(char *sz,
 				  size_t len, struct mrpdhelper_notify *n);
 
+/*
+ * Binary notifications, read in place. mrpdhelper_bin_count() returns the
+ * number of records in buf, 0 if buf is not a valid binary message.
+ * mrpdhelper_bin_record() returns a record of such a message, or NULL.
+ * buf must be 8 byte aligned, as a malloc()ed receive buffer is.
+ */
+unsigned int mrpdhelper_bin_count(const char *buf, size_t len);
+const struct mrpd_bin_record *mrpdhelper_bin_record(const char *buf,
+						    size_t len,
+						    unsigned int index);
+int mrpdhelper_bin_to_notify(const struct mrpd_bin_record *rec,
+			     struct mrpdhelper_notify *n);
+
 int mrpdhelper_notify_equal(struct mrpdhelper_notify *n1,
 			    struct mrpdhelper_notify *n2);
 
@@ -29,6 +29,9 @@
     #include <linux/ptp_clock.h>
 #endif
 
+#include <pcap.h>
+
+#include <algorithm>
 #include <iostream>
 #include <thread>
 #include <chrono>
@@ -36,6 +39,48 @@
 using namespace OpenAvnu::Services::MilanHardwareIntegration;
 using namespace OpenAvnu::Integration::Milan_IEEE;
 
+// ============================================================================
+// Transmit Frame Pool Implementation
+// ============================================================================
+
+TxFramePool::TxFramePool(size_t frame_count)
+    : frames_(new TxFrame[frame_count])
+    , frame_count_(frame_count)
+{
+    free_frames_.reserve(frame_count);
+    for (size_t i = frame_count; i > 0; --i) {
+        frames_[i - 1].length = 0;
+        frames_[i - 1].launch_time_ns = 0;
+        free_frames_.push_back(&frames_[i - 1]);
+    }
+}
+
+TxFrame* TxFramePool::acquire() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (free_frames_.empty()) {
+        return nullptr;
+    }
+    TxFrame* frame = free_frames_.back();
+    free_frames_.pop_back();
+    frame->length = 0;
+    frame->launch_time_ns = 0;
+    return frame;
+}
+
+void TxFramePool::release(TxFrame* frame) {
+    if (!frame) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Capacity was reserved up front, so this never reallocates
+    free_frames_.push_back(frame);
+}
+
+size_t TxFramePool::available() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return free_frames_.size();
+}
+
 // ============================================================================
 // Intel Hardware Integration Service Implementation
 // ============================================================================
@@ -44,6 +89,8 @@ IntelHardwareIntegrationService::IntelHardwareIntegrationService()
     : intel_hal_device_(nullptr)
     , hardware_initialized_(false)
     , active_interface_("")
+    , tx_frame_pool_(DEFAULT_TX_POOL_FRAMES)
+    , tx_handle_(nullptr)
 {
     std::cout << "INFO: Created Intel Hardware Integration Service" << std::endl;
 }
@@ -52,6 +99,7 @@ IntelHardwareIntegrationService::~IntelHardwareIntegrationService() {
     if (hardware_initialized_) {
         stop_milan_professional_audio_system();
     }
+    close_tx_handle();
 }
 
 bool IntelHardwareIntegrationService::initialize_intel_hardware() {
@@ -134,6 +182,8 @@ bool IntelHardwareIntegrationService::detect_intel_nics() {
 }
 
 bool IntelHardwareIntegrationService::select_interface(const std::string& interface_name) {
+    std::lock_guard<std::mutex> lock(tx_mutex_);
+    close_tx_handle();
     active_interface_ = interface_name;
     std::cout << "INFO: Selected interface: " << active_interface_ << std::endl;
     return true;
@@ -256,6 +306,11 @@ void IntelHardwareIntegrationService::setup_hardware_capabilities() {
         return transmit_intel_packet_with_timestamp(packet, timestamp);
     };
     
+    capabilities_.transmit_context = this;
+    capabilities_.transmit_frame = &IntelHardwareIntegrationService::transmit_frame_cb;
+    capabilities_.transmit_frames = &IntelHardwareIntegrationService::transmit_frames_cb;
+    capabilities_.tx_frame_pool = &tx_frame_pool_;
+    
     capabilities_.is_hardware_available = [this]() {
         return hardware_initialized_;
     };
@@ -285,7 +340,11 @@ double IntelHardwareIntegrationService::get_intel_sync_accuracy() {
     return 80.0; // nanoseconds
 }
 
-bool IntelHardwareIntegrationService::transmit_intel_packet(const std::vector<uint8_t>& packet) {
+bool IntelHardwareIntegrationService::open_tx_handle() {
+    if (tx_handle_) {
+        return true;
+    }
+    
     if (active_interface_.empty()) {
         std::cerr << "ERROR: No active interface for packet transmission" << std::endl;
         return false;
@@ -294,33 +353,75 @@ bool IntelHardwareIntegrationService::transmit_intel_packet(const std::vector<ui
     // In a real implementation, this would use intel-ethernet-hal for transmission
     // For testing, use PCAP to transmit on selected interface
     char errbuf[PCAP_ERRBUF_SIZE];
-    pcap_t* handle = pcap_open_live(active_interface_.c_str(), 65536, 1, 1000, errbuf);
+    tx_handle_ = pcap_open_live(active_interface_.c_str(), 65536, 1, 1000, errbuf);
     
-    if (!handle) {
+    if (!tx_handle_) {
         std::cerr << "ERROR: Failed to open interface for transmission: " << errbuf << std::endl;
         return false;
     }
+    return true;
+}
+
+void IntelHardwareIntegrationService::close_tx_handle() {
+    if (tx_handle_) {
+        pcap_close(tx_handle_);
+        tx_handle_ = nullptr;
+    }
+}
+
+bool IntelHardwareIntegrationService::transmit_frame(const uint8_t* data, size_t length, uint64_t launch_time_ns) {
+    // The pcap path can't hold a frame until its launch time, so it's sent now.
+    (void)launch_time_ns;
     
-    // Transmit packet
-    int result = pcap_sendpacket(handle, packet.data(), static_cast<int>(packet.size()));
-    pcap_close(handle);
-    
-    if (result != 0) {
-        std::cerr << "ERROR: Failed to transmit packet" << std::endl;
+    std::lock_guard<std::mutex> lock(tx_mutex_);
+    if (!open_tx_handle()) {
         return false;
     }
     
-    std::cout << "PASS: Transmitted packet (" << packet.size() << " bytes)" << std::endl;
+    if (pcap_sendpacket(tx_handle_, data, static_cast<int>(length)) != 0) {
+        std::cerr << "ERROR: Failed to transmit packet: " << pcap_geterr(tx_handle_) << std::endl;
+        return false;
+    }
     return true;
 }
 
+size_t IntelHardwareIntegrationService::transmit_frames(TxFrame* const* frames, size_t count) {
+    std::lock_guard<std::mutex> lock(tx_mutex_);
+    if (!open_tx_handle()) {
+        return 0;
+    }
+    
+    // One lock and one handle lookup for the whole batch
+    size_t sent = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const TxFrame* frame = frames[i];
+        if (pcap_sendpacket(tx_handle_, frame->data, static_cast<int>(frame->length)) == 0) {
+            ++sent;
+        }
+    }
+    
+    if (sent != count) {
+        std::cerr << "ERROR: Failed to transmit " << (count - sent) << " of " << count << " packets" << std::endl;
+    }
+    return sent;
+}
+
+bool IntelHardwareIntegrationService::transmit_frame_cb(void* context, const uint8_t* data, size_t length, uint64_t launch_time_ns) {
+    return static_cast<IntelHardwareIntegrationService*>(context)->transmit_frame(data, length, launch_time_ns);
+}
+
+size_t IntelHardwareIntegrationService::transmit_frames_cb(void* context, TxFrame* const* frames, size_t count) {
+    return static_cast<IntelHardwareIntegrationService*>(context)->transmit_frames(frames, count);
+}
+
+bool IntelHardwareIntegrationService::transmit_intel_packet(const std::vector<uint8_t>& packet) {
+    return transmit_frame(packet.data(), packet.size());
+}
+
 bool IntelHardwareIntegrationService::transmit_intel_packet_with_timestamp(
     const std::vector<uint8_t>& packet, uint64_t timestamp) {
     
-    // In a real implementation with Intel NICs, this would use hardware timestamping
-    // For now, transmit immediately and log the requested timestamp
-    std::cout << "INFO: Transmitting packet with timestamp: " << timestamp << "ns" << std::endl;
-    return transmit_intel_packet(packet);
+    return transmit_frame(packet.data(), packet.size(), timestamp);
 }
 
 std::string IntelHardwareIntegrationService::get_hardware_status() const {
@@ -18,8 +18,10 @@
 
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
+#include <cstddef>
 #include <cstdint>
 
 // Standards Layer (hardware agnostic) - forward declarations
@@ -37,11 +39,55 @@ namespace Milan_IEEE {
 // CORRECT CHAIN: intel-ethernet-hal → intel_avb → NDISIntelFilterDriver
 struct intel_hal_device;
 typedef struct intel_hal_device intel_hal_device_t;
+struct pcap;
+typedef struct pcap pcap_t;
 
 namespace OpenAvnu {
 namespace Services {
 namespace MilanHardwareIntegration {
 
+/**
+ * @brief Preallocated transmit frame
+ * 
+ * Frames come from a TxFramePool and are filled in place by the caller,
+ * so the packet path never allocates.
+ */
+struct TxFrame {
+    static constexpr size_t MAX_FRAME_SIZE = 1522;  // VLAN tagged Ethernet frame
+    
+    uint8_t data[MAX_FRAME_SIZE];
+    size_t length;                  // Bytes used in data
+    uint64_t launch_time_ns;        // Requested transmit time, 0 = send now
+};
+
+/**
+ * @brief Fixed pool of transmit frames
+ * 
+ * All frames and the free list are allocated in the constructor. acquire()
+ * and release() only move pointers and are safe to call from several
+ * stream threads.
+ */
+class TxFramePool {
+private:
+    std::unique_ptr<TxFrame[]> frames_;
+    std::vector<TxFrame*> free_frames_;
+    size_t frame_count_;
+    mutable std::mutex mutex_;
+    
+public:
+    explicit TxFramePool(size_t frame_count);
+    
+    TxFramePool(const TxFramePool&) = delete;
+    TxFramePool& operator=(const TxFramePool&) = delete;
+    
+    // Returns nullptr when every frame is in use
+    TxFrame* acquire();
+    void release(TxFrame* frame);
+    
+    size_t capacity() const { return frame_count_; }
+    size_t available() const;
+};
+
 /**
  * @brief Hardware abstraction callbacks for Standards layer
  * 
@@ -58,6 +104,13 @@ struct HardwareCapabilities {
     std::function<bool(const std::vector<uint8_t>&)> transmit_packet;
     std::function<bool(const std::vector<uint8_t>&, uint64_t)> transmit_packet_with_timestamp;
     
+    // Allocation-free packet transmission for streaming rates. Plain function
+    // pointers called with transmit_context; the frame memory stays with the caller.
+    void* transmit_context = nullptr;
+    bool (*transmit_frame)(void* context, const uint8_t* data, size_t length, uint64_t launch_time_ns) = nullptr;
+    size_t (*transmit_frames)(void* context, TxFrame* const* frames, size_t count) = nullptr;
+    TxFramePool* tx_frame_pool = nullptr;
+    
     // Hardware status callbacks
     std::function<bool()> is_hardware_available;
     std::function<std::string()> get_hardware_info;
@@ -77,12 +130,20 @@ private:
     std::string active_interface_;
     HardwareCapabilities capabilities_;
     
+    // Transmit path, set up once so nothing is opened or allocated per packet
+    TxFramePool tx_frame_pool_;
+    pcap_t* tx_handle_;
+    std::mutex tx_mutex_;
+    
     // Standards providers (injected)
     std::unique_ptr<OpenAvnu::Integration::Milan_IEEE::IEEE802_1AS_2021_Provider> gptp_provider_;
     std::unique_ptr<OpenAvnu::Integration::Milan_IEEE::IEEE1722_1_2021_Provider> avdecc_provider_;
     std::unique_ptr<OpenAvnu::Integration::Milan_IEEE::IEEE1722_2016_Provider> avtp_provider_;
     
 public:
+    // Enough for 64 class A streams at 8000 packets/s with a 1 ms batch
+    static constexpr size_t DEFAULT_TX_POOL_FRAMES = 512;
+    
     IntelHardwareIntegrationService();
     ~IntelHardwareIntegrationService();
     
@@ -106,6 +167,12 @@ public:
     // Hardware status
     bool is_hardware_ready() const { return hardware_initialized_; }
     std::string get_hardware_status() const;
+    const HardwareCapabilities& get_hardware_capabilities() const { return capabilities_; }
+    
+    // Allocation-free transmit API
+    TxFramePool& tx_frame_pool() { return tx_frame_pool_; }
+    bool transmit_frame(const uint8_t* data, size_t length, uint64_t launch_time_ns = 0);
+    size_t transmit_frames(TxFrame* const* frames, size_t count);
     
 private:
     // Hardware capability implementations
@@ -114,6 +181,12 @@ private:
     double get_intel_sync_accuracy();
     bool transmit_intel_packet(const std::vector<uint8_t>& packet);
     bool transmit_intel_packet_with_timestamp(const std::vector<uint8_t>& packet, uint64_t timestamp);
+    bool open_tx_handle();
+    void close_tx_handle();
+    
+    // Trampolines for the HardwareCapabilities function pointers
+    static bool transmit_frame_cb(void* context, const uint8_t* data, size_t length, uint64_t launch_time_ns);
+    static size_t transmit_frames_cb(void* context, TxFrame* const* frames, size_t count);
     
     // Hardware setup helpers
     void setup_hardware_capabilities();
@@ -164,7 +237,6 @@ public:
     
 private:
     void setup_packet_transmission_callbacks();
-    bool transmit_avdecc_packet(const std::vector<uint8_t>& packet);
 };
 
 /**
@@ -187,7 +259,6 @@ public:
     
 private:
     void setup_media_streaming_callbacks();
-    bool transmit_avtp_packet(const std::vector<uint8_t>& packet, uint64_t presentation_time);
     bool configure_hardware_queues_for_milan();
 };
 
@@ -0,0 +1,181 @@
+/**
+ * @file ieee_1722_1_2021_entity_table.cpp
+ * @brief Epoch reclamation and timer wheel behind EntityTable
+ *
+ * @copyright
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "ieee_1722_1_2021_entity_table.h"
+#include <functional>
+#include <thread>
+
+namespace IEEE {
+namespace _1722_1 {
+namespace _2021 {
+namespace StateMachines {
+
+//=============================================================================
+// EpochDomain Implementation
+//=============================================================================
+
+EpochDomain::~EpochDomain() {
+    // No reader may outlive the domain; everything left is unreachable
+    for (const Retired& r : _retired) {
+        r.deleter(r.object);
+    }
+}
+
+EpochDomain::ReadGuard::ReadGuard(const EpochDomain& domain) {
+    // Start at a per-thread position so concurrent readers rarely collide
+    size_t start = std::hash<std::thread::id>()(std::this_thread::get_id()) % MAX_READERS;
+    for (size_t n = 0;; ++n) {
+        ReaderSlot& slot = domain._readers[(start + n) % MAX_READERS];
+        bool expected = false;
+        if (!slot.inUse.load(std::memory_order_relaxed) &&
+            slot.inUse.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+            _slot = &slot;
+            break;
+        }
+        if ((n + 1) % MAX_READERS == 0) {
+            std::this_thread::yield();  // More than MAX_READERS readers at once
+        }
+    }
+    _slot->epoch.store(domain._globalEpoch.load(std::memory_order_acquire), std::memory_order_relaxed);
+    // Pairs with the fence in collect(): either the writer sees this epoch
+    // or this reader sees the writer's unlink.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+EpochDomain::ReadGuard::~ReadGuard() {
+    if (_slot) {
+        _slot->epoch.store(UINT64_MAX, std::memory_order_release);
+        _slot->inUse.store(false, std::memory_order_release);
+    }
+}
+
+void EpochDomain::retire(const void* object, void (*deleter)(const void*)) {
+    uint64_t epoch = _globalEpoch.fetch_add(1, std::memory_order_seq_cst);
+    _retired.push_back(Retired{object, deleter, epoch});
+    collect();
+}
+
+void EpochDomain::collect() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    uint64_t oldest = UINT64_MAX;
+    for (const ReaderSlot& slot : _readers) {
+        oldest = std::min(oldest, slot.epoch.load(std::memory_order_acquire));
+    }
+
+    // A reader that entered at epoch e may hold anything retired at e or later
+    size_t kept = 0;
+    for (size_t i = 0; i < _retired.size(); ++i) {
+        if (_retired[i].epoch < oldest) {
+            _retired[i].deleter(_retired[i].object);
+        } else {
+            _retired[kept++] = _retired[i];
+        }
+    }
+    _retired.resize(kept);
+}
+
+//=============================================================================
+// TimerWheel Implementation
+//=============================================================================
+
+TimerWheel::TimerWheel(std::chrono::milliseconds tick, size_t buckets)
+    : _tick(tick.count() > 0 ? tick : std::chrono::milliseconds(1)) {
+    size_t size = 1;
+    while (size < buckets) size <<= 1;
+    _buckets.assign(size, nullptr);
+    _mask = size - 1;
+}
+
+TimerWheel::~TimerWheel() = default;
+
+uint64_t TimerWheel::toTick(Clock::time_point t, bool roundUp) const {
+    auto since = t.time_since_epoch();
+    if (since.count() <= 0) {
+        return 0;
+    }
+    uint64_t ticks = static_cast<uint64_t>(since / _tick);
+    if (roundUp && since % _tick != Clock::duration::zero()) {
+        ticks++;
+    }
+    return ticks;
+}
+
+void TimerWheel::link(Entry* entry) {
+    // Anything already due goes into the bucket processed next
+    uint64_t tick = std::max(entry->deadlineTick, _currentTick);
+    entry->bucket = static_cast<size_t>(tick & _mask);
+    entry->prev = nullptr;
+    entry->next = _buckets[entry->bucket];
+    if (entry->next) entry->next->prev = entry;
+    _buckets[entry->bucket] = entry;
+}
+
+void TimerWheel::unlink(Entry* entry) {
+    if (entry->prev) entry->prev->next = entry->next;
+    else _buckets[entry->bucket] = entry->next;
+    if (entry->next) entry->next->prev = entry->prev;
+    entry->prev = entry->next = nullptr;
+}
+
+void TimerWheel::schedule(uint64_t id, Clock::time_point deadline) {
+    auto result = _entries.try_emplace(id, Entry{id, 0, nullptr, nullptr, 0});
+    Entry* entry = &result.first->second;
+    if (!result.second) {
+        unlink(entry);
+    }
+    entry->deadlineTick = toTick(deadline, true);
+    link(entry);
+}
+
+bool TimerWheel::cancel(uint64_t id) {
+    auto it = _entries.find(id);
+    if (it == _entries.end()) {
+        return false;
+    }
+    unlink(&it->second);
+    _entries.erase(it);
+    return true;
+}
+
+void TimerWheel::clear() {
+    std::fill(_buckets.begin(), _buckets.end(), nullptr);
+    _entries.clear();
+}
+
+size_t TimerWheel::advance(Clock::time_point now, std::vector<uint64_t>& expired) {
+    uint64_t target = toTick(now, false);
+    if (target < _currentTick) {
+        return 0;
+    }
+
+    size_t before = expired.size();
+    // Beyond one revolution every bucket is visited once
+    uint64_t last = std::min(target, _currentTick + _mask);
+    for (uint64_t tick = _currentTick; tick <= last; ++tick) {
+        Entry* entry = _buckets[tick & _mask];
+        while (entry) {
+            Entry* next = entry->next;
+            if (entry->deadlineTick <= target) {
+                unlink(entry);
+                expired.push_back(entry->id);
+            }
+            entry = next;
+        }
+    }
+    _currentTick = target + 1;
+
+    for (size_t i = before; i < expired.size(); ++i) {
+        _entries.erase(expired[i]);
+    }
+    return expired.size() - before;
+}
+
+} // namespace StateMachines
+} // namespace _2021
+} // namespace _1722_1
+} // namespace IEEE
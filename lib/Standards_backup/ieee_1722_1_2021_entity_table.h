@@ -0,0 +1,336 @@
+/**
+ * @file ieee_1722_1_2021_entity_table.h
+ * @brief Read-mostly table of discovered entities with lock-free snapshot reads
+ * @details ADP refreshes every entity every couple of seconds while UI and API
+ * threads list the table. EntityTable publishes each entity as an immutable
+ * record behind an atomic pointer and retires replaced records through an
+ * epoch domain, so readers never take a lock and never block the ADP thread.
+ * Entity timeouts are kept in a hashed timer wheel so the periodic sweep only
+ * touches the entities that are actually due.
+ *
+ * - Readers: snapshot(), get(), copy(), size(). Any thread, wait-free apart
+ *   from claiming an epoch slot.
+ * - Writers: upsert(), erase(), clear(). Serialized internally; meant to be
+ *   driven by the single ADP/worker thread.
+ *
+ * A Snapshot pins the set of entities present when it was taken; each record
+ * read through it is one complete ADP update. Holding a snapshot defers
+ * reclamation, so keep it short-lived.
+ *
+ * @copyright
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace IEEE {
+namespace _1722_1 {
+namespace _2021 {
+namespace StateMachines {
+
+// ============================================================================
+// EPOCH-BASED RECLAMATION
+// ============================================================================
+
+/**
+ * @brief Defers freeing of unlinked objects until no reader can still see them
+ *
+ * Readers announce the global epoch they entered in; a writer tags each
+ * retired object with the epoch it was unlinked in and frees it once every
+ * active reader has entered a later epoch.
+ */
+class EpochDomain {
+    struct ReaderSlot;
+
+public:
+    static constexpr size_t MAX_READERS = 64;
+
+    EpochDomain() = default;
+    ~EpochDomain();
+    EpochDomain(const EpochDomain&) = delete;
+    EpochDomain& operator=(const EpochDomain&) = delete;
+
+    /** RAII read-side critical section */
+    class ReadGuard {
+    public:
+        explicit ReadGuard(const EpochDomain& domain);
+        ~ReadGuard();
+        ReadGuard(ReadGuard&& other) noexcept : _slot(other._slot) { other._slot = nullptr; }
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+        ReadGuard& operator=(ReadGuard&&) = delete;
+
+    private:
+        ReaderSlot* _slot;
+    };
+
+    /** Hand an unlinked object to the domain. Writer side, externally serialized. */
+    void retire(const void* object, void (*deleter)(const void*));
+
+    /** Free whatever no reader can reach any more; called by retire() */
+    void collect();
+
+    size_t pendingCount() const { return _retired.size(); }
+
+private:
+    struct Retired {
+        const void* object;
+        void (*deleter)(const void*);
+        uint64_t epoch;
+    };
+
+    struct alignas(64) ReaderSlot {
+        std::atomic<bool> inUse{false};
+        std::atomic<uint64_t> epoch{UINT64_MAX};  // UINT64_MAX = not reading
+    };
+
+    mutable std::atomic<uint64_t> _globalEpoch{1};
+    mutable ReaderSlot _readers[MAX_READERS];
+    std::vector<Retired> _retired;
+};
+
+// ============================================================================
+// TIMER WHEEL
+// ============================================================================
+
+/**
+ * @brief Hashed timer wheel keyed by entity ID
+ *
+ * schedule() and cancel() are O(1); advance() visits only the buckets for
+ * the elapsed ticks. Deadlines are rounded up to the tick, so nothing ever
+ * expires early. Not thread-safe; owned by the writer.
+ */
+class TimerWheel {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit TimerWheel(std::chrono::milliseconds tick = std::chrono::milliseconds(100),
+                        size_t buckets = 1024);
+    ~TimerWheel();
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    /** Arm or re-arm the timer of an id */
+    void schedule(uint64_t id, Clock::time_point deadline);
+    bool cancel(uint64_t id);
+    void clear();
+
+    /** Expire everything due at now; returns the number of ids appended */
+    size_t advance(Clock::time_point now, std::vector<uint64_t>& expired);
+
+    size_t size() const { return _entries.size(); }
+
+private:
+    struct Entry {
+        uint64_t id;
+        uint64_t deadlineTick;
+        Entry* prev;
+        Entry* next;
+        size_t bucket;
+    };
+
+    uint64_t toTick(Clock::time_point t, bool roundUp) const;
+    void link(Entry* entry);
+    void unlink(Entry* entry);
+
+    Clock::duration _tick;
+    std::vector<Entry*> _buckets;
+    size_t _mask;
+    uint64_t _currentTick{0};  // next tick advance() has to process
+    std::unordered_map<uint64_t, Entry> _entries;
+};
+
+// ============================================================================
+// ENTITY TABLE
+// ============================================================================
+
+/**
+ * @brief RCU-style map from entity ID to immutable records
+ * @tparam Record Copyable value published per entity (e.g. DiscoveredEntity)
+ */
+template <typename Record>
+class EntityTable {
+    struct Node {
+        uint64_t id;
+        Record record;
+    };
+    struct Slot {
+        uint64_t id;
+        std::atomic<const Node*> node;
+    };
+    struct Index {
+        std::vector<Slot*> slots;  // sorted by id
+    };
+
+public:
+    EntityTable() : _index(new Index()) {}
+    ~EntityTable() {
+        const Index* index = _index.load(std::memory_order_relaxed);
+        for (Slot* slot : index->slots) {
+            delete slot->node.load(std::memory_order_relaxed);
+            delete slot;
+        }
+        delete index;
+    }
+    EntityTable(const EntityTable&) = delete;
+    EntityTable& operator=(const EntityTable&) = delete;
+
+    /** Consistent, lock-free view of the table */
+    class Snapshot {
+    public:
+        class Iterator {
+        public:
+            explicit Iterator(typename std::vector<Slot*>::const_iterator it) : _it(it) {}
+            const Record& operator*() const { return (*_it)->node.load(std::memory_order_acquire)->record; }
+            const Record* operator->() const { return &**this; }
+            Iterator& operator++() { ++_it; return *this; }
+            bool operator!=(const Iterator& other) const { return _it != other._it; }
+            bool operator==(const Iterator& other) const { return _it == other._it; }
+        private:
+            typename std::vector<Slot*>::const_iterator _it;
+        };
+
+        Iterator begin() const { return Iterator(_index->slots.begin()); }
+        Iterator end() const { return Iterator(_index->slots.end()); }
+        size_t size() const { return _index->slots.size(); }
+        bool empty() const { return _index->slots.empty(); }
+
+        /** Record of an entity in this snapshot, nullptr if absent */
+        const Record* find(uint64_t id) const {
+            const Slot* slot = EntityTable::lookup(*_index, id);
+            return slot ? &slot->node.load(std::memory_order_acquire)->record : nullptr;
+        }
+
+    private:
+        friend class EntityTable;
+        Snapshot(const EpochDomain& domain, const std::atomic<const Index*>& index)
+            : _guard(domain), _index(index.load(std::memory_order_acquire)) {}
+
+        EpochDomain::ReadGuard _guard;
+        const Index* _index;
+    };
+
+    Snapshot snapshot() const { return Snapshot(_epochs, _index); }
+
+    bool get(uint64_t id, Record& out) const {
+        Snapshot snap = snapshot();
+        const Record* record = snap.find(id);
+        if (!record) {
+            return false;
+        }
+        out = *record;
+        return true;
+    }
+
+    std::vector<Record> copy() const {
+        Snapshot snap = snapshot();
+        std::vector<Record> records;
+        records.reserve(snap.size());
+        for (const Record& record : snap) {
+            records.push_back(record);
+        }
+        return records;
+    }
+
+    size_t size() const { return snapshot().size(); }
+
+    /**
+     * @brief Publish a new record for an entity
+     * @return true if the entity was not in the table before
+     */
+    bool upsert(uint64_t id, const Record& record) {
+        std::lock_guard<std::mutex> lock(_writerMutex);
+        const Node* node = new Node{id, record};
+
+        auto it = _slots.find(id);
+        if (it != _slots.end()) {
+            // Refresh: O(1), membership unchanged
+            const Node* old = it->second->node.exchange(node, std::memory_order_acq_rel);
+            _epochs.retire(old, &deleteNode);
+            return false;
+        }
+
+        Slot* slot = new Slot{id, {node}};
+        const Index* oldIndex = _index.load(std::memory_order_relaxed);
+        Index* index = new Index();
+        index->slots.reserve(oldIndex->slots.size() + 1);
+        auto pos = std::lower_bound(oldIndex->slots.begin(), oldIndex->slots.end(), id,
+                                    [](const Slot* s, uint64_t key) { return s->id < key; });
+        index->slots.insert(index->slots.end(), oldIndex->slots.begin(), pos);
+        index->slots.push_back(slot);
+        index->slots.insert(index->slots.end(), pos, oldIndex->slots.end());
+        _index.store(index, std::memory_order_release);
+        _slots.emplace(id, slot);
+        _epochs.retire(oldIndex, &deleteIndex);
+        return true;
+    }
+
+    bool erase(uint64_t id) {
+        std::lock_guard<std::mutex> lock(_writerMutex);
+        auto it = _slots.find(id);
+        if (it == _slots.end()) {
+            return false;
+        }
+        Slot* slot = it->second;
+        _slots.erase(it);
+
+        const Index* oldIndex = _index.load(std::memory_order_relaxed);
+        Index* index = new Index();
+        index->slots.reserve(oldIndex->slots.size() - 1);
+        for (Slot* s : oldIndex->slots) {
+            if (s != slot) index->slots.push_back(s);
+        }
+        _index.store(index, std::memory_order_release);
+        _epochs.retire(oldIndex, &deleteIndex);
+        _epochs.retire(slot, &deleteSlot);
+        return true;
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(_writerMutex);
+        const Index* oldIndex = _index.exchange(new Index(), std::memory_order_acq_rel);
+        _slots.clear();
+        _epochs.retire(oldIndex, &deleteIndexAndSlots);
+    }
+
+private:
+    static const Slot* lookup(const Index& index, uint64_t id) {
+        auto pos = std::lower_bound(index.slots.begin(), index.slots.end(), id,
+                                    [](const Slot* s, uint64_t key) { return s->id < key; });
+        return (pos != index.slots.end() && (*pos)->id == id) ? *pos : nullptr;
+    }
+
+    static void deleteNode(const void* p) { delete static_cast<const Node*>(p); }
+    static void deleteIndex(const void* p) { delete static_cast<const Index*>(p); }
+    static void deleteSlot(const void* p) {
+        const Slot* slot = static_cast<const Slot*>(p);
+        delete slot->node.load(std::memory_order_relaxed);
+        delete slot;
+    }
+    static void deleteIndexAndSlots(const void* p) {
+        const Index* index = static_cast<const Index*>(p);
+        for (const Slot* slot : index->slots) {
+            deleteSlot(slot);
+        }
+        delete index;
+    }
+
+    std::atomic<const Index*> _index;
+    mutable EpochDomain _epochs;
+    std::mutex _writerMutex;
+    std::unordered_map<uint64_t, Slot*> _slots;  // writer-side lookup
+};
+
+} // namespace StateMachines
+} // namespace _2021
+} // namespace _1722_1
+} // namespace IEEE
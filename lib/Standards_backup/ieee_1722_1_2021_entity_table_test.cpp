@@ -0,0 +1,228 @@
+/**
+ * @file ieee_1722_1_2021_entity_table_test.cpp
+ * @brief Tests for EntityTable, EpochDomain and TimerWheel
+ *
+ * The concurrency test runs ADP-style refreshes and membership churn on one
+ * thread while several readers iterate snapshots and check every record they
+ * see is internally consistent. Build with -fsanitize=address to catch
+ * records freed while still visible to a reader.
+ */
+
+#include "ieee_1722_1_2021_entity_table.h"
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace IEEE::_1722_1::_2021::StateMachines;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+// Stand-in for DiscoveredEntity: check == ~id and every word equals
+// availableIndex, so a torn or freed record is detectable
+struct TestRecord {
+    uint64_t entityID;
+    uint64_t check;
+    uint32_t availableIndex;
+    uint32_t words[16];
+};
+
+TestRecord make_record(uint64_t id, uint32_t availableIndex) {
+    TestRecord r;
+    r.entityID = id;
+    r.check = ~id;
+    r.availableIndex = availableIndex;
+    for (uint32_t& w : r.words) w = availableIndex;
+    return r;
+}
+
+bool record_ok(const TestRecord& r) {
+    if (r.check != ~r.entityID) return false;
+    for (uint32_t w : r.words) {
+        if (w != r.availableIndex) return false;
+    }
+    return true;
+}
+
+Clock::time_point at_ms(int64_t ms) {
+    return Clock::time_point(std::chrono::milliseconds(ms));
+}
+
+} // anonymous namespace
+
+bool test_table_basic() {
+    std::cout << "Test 1: EntityTable upsert/get/erase/snapshot\n";
+    EntityTable<TestRecord> table;
+
+    bool ok = true;
+    ok &= table.upsert(3, make_record(3, 1));
+    ok &= table.upsert(1, make_record(1, 1));
+    ok &= table.upsert(2, make_record(2, 1));
+    ok &= !table.upsert(2, make_record(2, 7));  // refresh, not new
+    ok &= table.size() == 3;
+
+    TestRecord r{};
+    ok &= table.get(2, r) && r.availableIndex == 7;
+    ok &= !table.get(4, r);
+
+    {
+        auto snap = table.snapshot();
+        uint64_t previous = 0;
+        for (const TestRecord& rec : snap) {
+            ok &= rec.entityID > previous;  // sorted by entity ID
+            previous = rec.entityID;
+        }
+        // Later writes do not change the membership of a held snapshot
+        table.erase(1);
+        table.upsert(9, make_record(9, 1));
+        ok &= snap.size() == 3 && snap.find(1) != nullptr && snap.find(9) == nullptr;
+    }
+
+    ok &= table.size() == 3 && !table.get(1, r) && table.get(9, r);
+    ok &= !table.erase(1);
+
+    auto all = table.copy();
+    ok &= all.size() == 3;
+
+    table.clear();
+    ok &= table.size() == 0 && table.copy().empty();
+
+    std::cout << (ok ? "  ✓ PASSED\n" : "  ✗ FAILED\n");
+    return ok;
+}
+
+bool test_epoch_reclamation() {
+    std::cout << "Test 2: EpochDomain defers frees while a reader is active\n";
+    static int freed = 0;
+    freed = 0;
+    auto deleter = [](const void* p) { delete static_cast<const int*>(p); freed++; };
+
+    bool ok = true;
+    {
+        EpochDomain domain;
+        {
+            EpochDomain::ReadGuard guard(domain);
+            domain.retire(new int(1), deleter);
+            domain.retire(new int(2), deleter);
+            ok &= freed == 0 && domain.pendingCount() == 2;
+        }
+        domain.collect();
+        ok &= freed == 2 && domain.pendingCount() == 0;
+
+        // Readers entering after the retire do not hold it back
+        domain.retire(new int(3), deleter);
+        EpochDomain::ReadGuard late(domain);
+        domain.collect();
+        ok &= freed == 3;
+
+        domain.retire(new int(4), deleter);
+    }
+    ok &= freed == 4;  // domain destructor frees the rest
+
+    std::cout << (ok ? "  ✓ PASSED\n" : "  ✗ FAILED\n");
+    return ok;
+}
+
+bool test_timer_wheel() {
+    std::cout << "Test 3: TimerWheel expiry, refresh and cancel\n";
+    TimerWheel wheel(std::chrono::milliseconds(100), 64);  // 6.4 s per revolution
+    std::vector<uint64_t> expired;
+    bool ok = true;
+
+    int64_t base = 1000000;
+    wheel.schedule(1, at_ms(base + 2000));
+    wheel.schedule(2, at_ms(base + 62000));   // several revolutions out
+    wheel.schedule(3, at_ms(base + 2050));    // rounds up to the next tick
+    wheel.schedule(4, at_ms(base + 5000));
+    ok &= wheel.size() == 4;
+
+    ok &= wheel.advance(at_ms(base + 1999), expired) == 0;
+    ok &= wheel.advance(at_ms(base + 2000), expired) == 1 && expired.back() == 1;
+    ok &= wheel.advance(at_ms(base + 2099), expired) == 0;
+    ok &= wheel.advance(at_ms(base + 2100), expired) == 1 && expired.back() == 3;
+
+    // ADP refresh pushes the deadline out; cancel removes it
+    wheel.schedule(4, at_ms(base + 9000));
+    ok &= wheel.advance(at_ms(base + 6000), expired) == 0;
+    ok &= wheel.cancel(4) && !wheel.cancel(4);
+
+    // Jumping far ahead still finds the long timer exactly once
+    ok &= wheel.advance(at_ms(base + 61900), expired) == 0;
+    ok &= wheel.advance(at_ms(base + 100000), expired) == 1 && expired.back() == 2;
+    ok &= wheel.size() == 0;
+
+    // Deadline already in the past fires on the next advance
+    wheel.schedule(5, at_ms(base));
+    ok &= wheel.advance(at_ms(base + 100100), expired) == 1 && expired.back() == 5;
+
+    std::cout << (ok ? "  ✓ PASSED\n" : "  ✗ FAILED\n");
+    return ok;
+}
+
+bool test_concurrent_readers() {
+    std::cout << "Test 4: Lock-free readers against ADP refresh and churn\n";
+    const uint64_t ENTITIES = 256;
+    EntityTable<TestRecord> table;
+    for (uint64_t id = 1; id <= ENTITIES; ++id) {
+        table.upsert(id, make_record(id, 0));
+    }
+
+    std::atomic<bool> stop{false};
+    std::atomic<bool> corrupt{false};
+    std::atomic<uint64_t> snapshots{0};
+
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&]() {
+            while (!stop.load(std::memory_order_relaxed)) {
+                auto snap = table.snapshot();
+                uint64_t previous = 0;
+                for (const TestRecord& rec : snap) {
+                    if (!record_ok(rec) || rec.entityID <= previous) corrupt = true;
+                    previous = rec.entityID;
+                }
+                TestRecord r;
+                if (table.get(7, r) && !record_ok(r)) corrupt = true;
+                snapshots.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+
+    auto start = Clock::now();
+    uint32_t round = 0;
+    while (Clock::now() - start < std::chrono::milliseconds(500)) {
+        ++round;
+        for (uint64_t id = 1; id <= ENTITIES; ++id) {
+            table.upsert(id, make_record(id, round));
+        }
+        // An entity departs and a new one arrives every round
+        table.upsert(ENTITIES + round, make_record(ENTITIES + round, round));
+        if (round > 1) {
+            table.erase(ENTITIES + round - 1);
+        }
+    }
+    stop = true;
+    for (auto& t : readers) t.join();
+
+    bool ok = !corrupt && table.size() == ENTITIES + 1 && snapshots.load() > 0;
+    std::cout << "  " << round << " refresh rounds, " << snapshots.load() << " reader snapshots\n";
+    std::cout << (ok ? "  ✓ PASSED\n" : "  ✗ FAILED\n");
+    return ok;
+}
+
+int main() {
+    std::cout << "=== IEEE 1722.1-2021 Entity Table Tests ===\n";
+
+    int passed = 0;
+    int total = 4;
+
+    if (test_table_basic()) passed++;
+    if (test_epoch_reclamation()) passed++;
+    if (test_timer_wheel()) passed++;
+    if (test_concurrent_readers()) passed++;
+
+    std::cout << "=== Test Results: " << passed << "/" << total << " Tests Passed ===\n";
+    return passed == total ? 0 : 1;
+}
@@ -0,0 +1,280 @@
+/**
+ * @file ieee_1722_1_2021_enumeration_bench.cpp
+ * @brief EnumerationEngine against simulated ATDECC entities
+ *
+ * Every simulated entity answers READ_DESCRIPTOR one command at a time with
+ * a fixed service time behind a fixed one-way network latency, so the run is
+ * deterministic and measured in virtual time. Commands and responses go
+ * through the real AECP serialize/deserialize path.
+ *
+ * For 1, 100 and 1000 entities three controllers are compared:
+ *   sequential - one command in flight, one entity at a time
+ *   pipelined  - windowed, many entities interleaved, every model distinct
+ *   cached     - pipelined, entities drawn from a handful of product models
+ * plus a pipelined run with frame loss to exercise the retry path.
+ *
+ * Exits non-zero if any entity is not enumerated completely.
+ *
+ * Usage: ieee_1722_1_2021_enumeration_bench [service_us] [one_way_latency_us]
+ */
+
+#include "ieee_1722_1_2021_enumeration_engine.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <queue>
+#include <random>
+#include <vector>
+
+using namespace IEEE::_1722_1::_2021;
+using Enumeration::EnumerationConfig;
+using Enumeration::EnumerationEngine;
+using Enumeration::EntityModelData;
+
+namespace {
+
+const uint64_t CONTROLLER_ID = 0x0011223344556677ULL;
+const uint64_t ENTITY_ID_BASE = 0x001B92FFFE000000ULL;
+const uint32_t TICK_US = 10000;
+
+struct DescriptorCount {
+    uint16_t type;
+    uint16_t count;
+};
+
+// A modest Milan-style talker/listener: 41 descriptors below CONFIGURATION
+const DescriptorCount MODEL_COUNTS[] = {
+    {AEM::DESCRIPTOR_AUDIO_UNIT, 1},         {AEM::DESCRIPTOR_STREAM_INPUT, 4},
+    {AEM::DESCRIPTOR_STREAM_OUTPUT, 4},      {AEM::DESCRIPTOR_JACK_INPUT, 2},
+    {AEM::DESCRIPTOR_JACK_OUTPUT, 2},        {AEM::DESCRIPTOR_AVB_INTERFACE, 1},
+    {AEM::DESCRIPTOR_CLOCK_SOURCE, 3},       {AEM::DESCRIPTOR_LOCALE, 1},
+    {AEM::DESCRIPTOR_STRINGS, 2},            {AEM::DESCRIPTOR_STREAM_PORT_INPUT, 1},
+    {AEM::DESCRIPTOR_STREAM_PORT_OUTPUT, 1}, {AEM::DESCRIPTOR_AUDIO_CLUSTER, 16},
+    {AEM::DESCRIPTOR_AUDIO_MAP, 2},          {AEM::DESCRIPTOR_CLOCK_DOMAIN, 1},
+};
+const size_t MODEL_COUNT_TYPES = sizeof(MODEL_COUNTS) / sizeof(MODEL_COUNTS[0]);
+
+size_t expected_descriptors() {
+    size_t n = 2; // ENTITY + CONFIGURATION
+    for (const DescriptorCount& c : MODEL_COUNTS) n += c.count;
+    return n;
+}
+
+void put_be16(uint8_t* p, uint16_t v) {
+    p[0] = static_cast<uint8_t>(v >> 8);
+    p[1] = static_cast<uint8_t>(v);
+}
+
+void put_be64(uint8_t* p, uint64_t v) {
+    for (int i = 7; i >= 0; --i, v >>= 8) p[i] = static_cast<uint8_t>(v);
+}
+
+struct Event {
+    uint64_t time_us;
+    uint64_t order;
+    std::vector<uint8_t> frame;
+    bool operator>(const Event& other) const {
+        return time_us != other.time_us ? time_us > other.time_us : order > other.order;
+    }
+};
+
+struct Scenario {
+    const char* name;
+    EnumerationConfig config;
+    size_t entities;
+    size_t models;          ///< distinct entity_model_ids, 0 = one per entity
+    double loss;            ///< probability of dropping a command or response
+};
+
+struct Result {
+    uint64_t virtual_us = 0;
+    double host_ms = 0;
+    size_t completed = 0;
+    size_t complete_models = 0;
+    Enumeration::EnumerationStats stats;
+};
+
+class SimulatedNetwork {
+public:
+    SimulatedNetwork(const Scenario& scenario, uint32_t service_us, uint32_t latency_us)
+        : scenario_(scenario), service_us_(service_us), latency_us_(latency_us),
+          busy_until_(scenario.entities, 0), rng_(12345) {}
+
+    uint64_t model_id_of(size_t entity) const {
+        size_t model = scenario_.models ? entity % scenario_.models : entity;
+        return 0x001B920000000000ULL | model;
+    }
+
+    void set_now(uint64_t now_us) { now_us_ = now_us; }
+
+    bool send(const EnumerationEngine::Pdu& command) {
+        if (lost()) return true;
+        size_t entity = static_cast<size_t>(command.target_entity_id - ENTITY_ID_BASE);
+        if (entity >= busy_until_.size()) return false;
+
+        // The entity serves its AECP queue in order
+        uint64_t arrival = now_us_ + latency_us_;
+        uint64_t done = std::max(arrival, busy_until_[entity]) + service_us_;
+        busy_until_[entity] = done;
+        if (lost()) return true;
+
+        EnumerationEngine::Pdu response = respond(command, entity);
+        const uint8_t* raw = response.get_raw_octets();
+        events_.push(Event{done + latency_us_, order_++,
+                           std::vector<uint8_t>(raw, raw + response.get_size())});
+        return true;
+    }
+
+    bool has_event() const { return !events_.empty(); }
+    uint64_t next_event_time() const { return events_.top().time_us; }
+    Event pop() {
+        Event e = events_.top();
+        events_.pop();
+        return e;
+    }
+
+private:
+    bool lost() { return scenario_.loss > 0 && std::uniform_real_distribution<double>(0, 1)(rng_) < scenario_.loss; }
+
+    EnumerationEngine::Pdu respond(EnumerationEngine::Pdu command, size_t entity) {
+        uint16_t config_index = 0, type = 0, index = 0;
+        command.get_read_descriptor_command(config_index, type, index);
+
+        uint8_t desc[400];
+        size_t len = 0;
+        memset(desc, 0, sizeof(desc));
+        put_be16(desc, type);
+        put_be16(desc + 2, index);
+
+        if (type == AEM::DESCRIPTOR_ENTITY && index == 0) {
+            put_be64(desc + 4, ENTITY_ID_BASE + entity);
+            put_be64(desc + 12, model_id_of(entity));
+            put_be16(desc + 308, 1);  // configurations_count
+            put_be16(desc + 310, 0);  // current_configuration
+            len = 312;
+        } else if (type == AEM::DESCRIPTOR_CONFIGURATION && index == 0) {
+            put_be16(desc + 70, static_cast<uint16_t>(MODEL_COUNT_TYPES));
+            put_be16(desc + 72, 74);
+            for (size_t i = 0; i < MODEL_COUNT_TYPES; ++i) {
+                put_be16(desc + 74 + 4 * i, MODEL_COUNTS[i].type);
+                put_be16(desc + 76 + 4 * i, MODEL_COUNTS[i].count);
+            }
+            len = 74 + 4 * MODEL_COUNT_TYPES;
+        } else {
+            for (const DescriptorCount& c : MODEL_COUNTS) {
+                if (c.type == type && index < c.count) len = 96 + (type * 7 + index) % 160;
+            }
+        }
+
+        EnumerationEngine::Pdu response = command;
+        if (len == 0) {
+            response.create_response(AECP::AECP_Status::NO_SUCH_DESCRIPTOR);
+        } else {
+            response.status = AECP::AECP_Status::SUCCESS;
+            response.set_read_descriptor_response(config_index, type, index, desc, len);
+        }
+        return response;
+    }
+
+    const Scenario& scenario_;
+    uint32_t service_us_;
+    uint32_t latency_us_;
+    std::vector<uint64_t> busy_until_;
+    std::priority_queue<Event, std::vector<Event>, std::greater<Event>> events_;
+    uint64_t order_ = 0;
+    uint64_t now_us_ = 0;
+    std::mt19937 rng_;
+};
+
+Result run(const Scenario& scenario, uint32_t service_us, uint32_t latency_us) {
+    SimulatedNetwork net(scenario, service_us, latency_us);
+    EnumerationEngine engine(CONTROLLER_ID,
+                             [&net](const EnumerationEngine::Pdu& pdu) { return net.send(pdu); },
+                             scenario.config);
+    Result result;
+    engine.set_completion_callback([&](uint64_t, std::shared_ptr<const EntityModelData> model) {
+        if (!model) return;
+        result.completed++;
+        if (model->descriptors.size() == expected_descriptors()) result.complete_models++;
+    });
+
+    auto start = std::chrono::steady_clock::now();
+    uint64_t now_us = 0;
+    uint64_t next_tick = TICK_US;
+    net.set_now(now_us);
+    for (size_t i = 0; i < scenario.entities; ++i) {
+        engine.enumerate(ENTITY_ID_BASE + i, net.model_id_of(i), now_us / 1000);
+    }
+
+    while (!engine.idle()) {
+        if (net.has_event() && net.next_event_time() <= next_tick) {
+            Event e = net.pop();
+            now_us = e.time_us;
+            net.set_now(now_us);
+            EnumerationEngine::Pdu response(e.frame.data(), e.frame.size());
+            engine.on_response(response, now_us / 1000);
+        } else {
+            now_us = next_tick;
+            next_tick += TICK_US;
+            net.set_now(now_us);
+            engine.tick(now_us / 1000);
+        }
+    }
+    auto stop = std::chrono::steady_clock::now();
+
+    result.virtual_us = now_us;
+    result.host_ms = std::chrono::duration<double, std::milli>(stop - start).count();
+    result.stats = engine.stats();
+    return result;
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv) {
+    uint32_t service_us = argc > 1 ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 0)) : 500;
+    uint32_t latency_us = argc > 2 ? static_cast<uint32_t>(std::strtoul(argv[2], nullptr, 0)) : 250;
+
+    EnumerationConfig sequential;
+    sequential.window_per_entity = 1;
+    sequential.max_concurrent_entities = 1;
+    EnumerationConfig pipelined;
+    pipelined.window_per_entity = 8;
+    pipelined.max_concurrent_entities = 64;
+
+    std::vector<Scenario> scenarios;
+    for (size_t n : {size_t(1), size_t(100), size_t(1000)}) {
+        scenarios.push_back({"sequential", sequential, n, 0, 0.0});
+        scenarios.push_back({"pipelined", pipelined, n, 0, 0.0});
+        scenarios.push_back({"cached", pipelined, n, 4, 0.0});
+    }
+    scenarios.push_back({"pipelined 1% loss", pipelined, 100, 0, 0.01});
+
+    std::cout << "Simulated entities: " << expected_descriptors() << " descriptors each, "
+              << service_us << " us service time, " << latency_us << " us one-way latency\n\n";
+    std::cout << std::left << std::setw(20) << "controller" << std::right
+              << std::setw(9) << "entities" << std::setw(14) << "virtual ms"
+              << std::setw(10) << "commands" << std::setw(9) << "retries"
+              << std::setw(11) << "cache hits" << std::setw(10) << "peak inf"
+              << std::setw(10) << "host ms" << "\n";
+
+    bool ok = true;
+    for (const Scenario& s : scenarios) {
+        Result r = run(s, service_us, latency_us);
+        std::cout << std::left << std::setw(20) << s.name << std::right
+                  << std::setw(9) << s.entities
+                  << std::setw(14) << std::fixed << std::setprecision(1) << r.virtual_us / 1000.0
+                  << std::setw(10) << r.stats.commands_sent
+                  << std::setw(9) << r.stats.retries
+                  << std::setw(11) << r.stats.model_cache_hits
+                  << std::setw(10) << r.stats.peak_inflight
+                  << std::setw(10) << std::setprecision(2) << r.host_ms << "\n";
+        if (r.completed != s.entities || r.complete_models != s.entities) {
+            std::cout << "  FAILED: " << r.completed << " enumerated, " << r.complete_models
+                      << " complete models\n";
+            ok = false;
+        }
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,394 @@
+/**
+ * @file ieee_1722_1_2021_enumeration_engine.cpp
+ * @brief Pipelined AEM enumeration of many ATDECC entities at once
+ *
+ * @copyright
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "ieee_1722_1_2021_enumeration_engine.h"
+#include <algorithm>
+
+namespace IEEE {
+namespace _1722_1 {
+namespace _2021 {
+namespace Enumeration {
+
+namespace {
+
+// ENTITY descriptor field offsets (IEEE 1722.1-2021 7.2.1)
+const size_t ENTITY_MODEL_ID_OFFSET = 12;
+const size_t CURRENT_CONFIGURATION_OFFSET = 310;
+const size_t ENTITY_DESCRIPTOR_MIN_SIZE = 312;
+
+// CONFIGURATION descriptor field offsets (IEEE 1722.1-2021 7.2.2)
+const size_t DESCRIPTOR_COUNTS_COUNT_OFFSET = 70;
+const size_t DESCRIPTOR_COUNTS_OFFSET_OFFSET = 72;
+const size_t CONFIGURATION_DESCRIPTOR_MIN_SIZE = 74;
+
+uint16_t read_be16(const uint8_t* p) {
+    return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+uint64_t read_be64(const uint8_t* p) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; ++i) v = (v << 8) | p[i];
+    return v;
+}
+
+uint16_t table_size_for(size_t max_inflight) {
+    // Twice the worst case keeps probing short; sequence_id is 16 bits so
+    // the table must divide 65536.
+    size_t size = 16;
+    while (size < max_inflight * 2 && size < 0x8000) size <<= 1;
+    return static_cast<uint16_t>(size);
+}
+
+} // anonymous namespace
+
+const std::vector<uint8_t>* EntityModelData::find(uint16_t type, uint16_t index) const {
+    auto it = descriptors.find(descriptor_key(type, index));
+    return it == descriptors.end() ? nullptr : &it->second;
+}
+
+EnumerationEngine::EnumerationEngine(uint64_t controller_entity_id, SendCallback send,
+                                     const EnumerationConfig& config)
+    : controller_entity_id_(controller_entity_id),
+      send_(std::move(send)),
+      config_(config) {
+    if (config_.window_per_entity == 0) config_.window_per_entity = 1;
+    if (config_.max_concurrent_entities == 0) config_.max_concurrent_entities = 1;
+
+    size_t max_inflight = static_cast<size_t>(config_.window_per_entity) * config_.max_concurrent_entities;
+    if (max_inflight > 0x4000) {
+        // Keep the table at most half full so a free slot is always near
+        config_.max_concurrent_entities = static_cast<uint16_t>(
+            std::max<size_t>(1, 0x4000 / config_.window_per_entity));
+        max_inflight = static_cast<size_t>(config_.window_per_entity) * config_.max_concurrent_entities;
+    }
+    uint16_t size = table_size_for(max_inflight);
+    slots_.resize(size);
+    slot_mask_ = static_cast<uint16_t>(size - 1);
+}
+
+bool EnumerationEngine::enumerate(uint64_t entity_id, uint64_t entity_model_id, uint64_t now_ms) {
+    if (!known_entities_.insert(entity_id).second) {
+        return false;
+    }
+    Job job;
+    job.entity_id = entity_id;
+    job.entity_model_id = entity_model_id;
+    pending_.push_back(std::move(job));
+    start_pending(now_ms);
+    return true;
+}
+
+std::shared_ptr<const EntityModelData> EnumerationEngine::cached_model(uint64_t entity_model_id) const {
+    auto it = model_cache_.find(entity_model_id);
+    return it == model_cache_.end() ? nullptr : it->second;
+}
+
+void EnumerationEngine::start_pending(uint64_t now_ms) {
+    while (!pending_.empty() && active_.size() < config_.max_concurrent_entities) {
+        Job job = std::move(pending_.front());
+        pending_.pop_front();
+
+        if (job.entity_model_id != 0) {
+            auto cached = model_cache_.find(job.entity_model_id);
+            if (cached != model_cache_.end()) {
+                stats_.model_cache_hits++;
+                known_entities_.erase(job.entity_id);
+                complete(job.entity_id, cached->second);
+                continue;
+            }
+            auto waiting = model_waiters_.find(job.entity_model_id);
+            if (waiting != model_waiters_.end()) {
+                waiting->second.push_back(job.entity_id);
+                parked_count_++;
+                continue;
+            }
+            model_waiters_.emplace(job.entity_model_id, std::vector<uint64_t>());
+        }
+
+        job.phase = Phase::Entity;
+        job.model = std::make_shared<EntityModelData>();
+        job.model->entity_model_id = job.entity_model_id;
+        uint64_t entity_id = job.entity_id;
+        Job& active = active_.emplace(entity_id, std::move(job)).first->second;
+        send_read(active, 0, AEM::DESCRIPTOR_ENTITY, 0, now_ms);
+    }
+}
+
+bool EnumerationEngine::send_read(Job& job, uint16_t config_index, uint16_t type, uint16_t index,
+                                  uint64_t now_ms) {
+    if (inflight_count_ >= slots_.size()) {
+        return false;
+    }
+    while (slots_[next_sequence_id_ & slot_mask_].used) {
+        next_sequence_id_++;
+    }
+    uint16_t sequence_id = next_sequence_id_++;
+    Slot& slot = slots_[sequence_id & slot_mask_];
+    slot.used = true;
+    slot.command.sequence_id = sequence_id;
+    slot.command.send_time_ms = now_ms;
+    slot.command.retry_count = 0;
+    slot.command.max_retries = config_.max_retries;
+    slot.command.timeout_ms = config_.command_timeout_ms;
+    slot.command.command_type = static_cast<uint16_t>(AECP::AEM_Command_type::READ_DESCRIPTOR);
+    slot.command.target_entity_id = job.entity_id;
+    slot.configuration_index = config_index;
+    slot.descriptor_type = type;
+    slot.descriptor_index = index;
+
+    job.inflight++;
+    inflight_count_++;
+    stats_.peak_inflight = std::max<uint32_t>(stats_.peak_inflight, static_cast<uint32_t>(inflight_count_));
+    transmit(slot);
+    return true;
+}
+
+void EnumerationEngine::transmit(const Slot& slot) {
+    Pdu command;
+    command.target_entity_id = slot.command.target_entity_id;
+    command.controller_entity_id = controller_entity_id_;
+    command.sequence_id = slot.command.sequence_id;
+    command.set_read_descriptor_command(slot.configuration_index, slot.descriptor_type, slot.descriptor_index);
+    stats_.commands_sent++;
+    if (send_) {
+        send_(command);  // A failed send is recovered by the timeout path
+    }
+}
+
+void EnumerationEngine::fill_window(Job& job, uint64_t now_ms) {
+    while (job.inflight < config_.window_per_entity && job.next < job.todo.size()) {
+        uint32_t key = job.todo[job.next];
+        if (!send_read(job, job.model->configuration_index, static_cast<uint16_t>(key >> 16),
+                       static_cast<uint16_t>(key & 0xFFFF), now_ms)) {
+            break;
+        }
+        job.next++;
+    }
+}
+
+void EnumerationEngine::on_response(const Pdu& response, uint64_t now_ms) {
+    if (response.message_type != AECP::AECP_Message_type::AEM_RESPONSE ||
+        response.command_type != AECP::AEM_Command_type::READ_DESCRIPTOR ||
+        response.controller_entity_id != controller_entity_id_) {
+        return;
+    }
+
+    Slot& slot = slots_[response.sequence_id & slot_mask_];
+    if (!slot.used || slot.command.sequence_id != response.sequence_id ||
+        slot.command.target_entity_id != response.target_entity_id) {
+        stats_.responses_ignored++;
+        return;
+    }
+    auto it = active_.find(response.target_entity_id);
+    if (it == active_.end()) {
+        stats_.responses_ignored++;
+        return;
+    }
+    Job& job = it->second;
+
+    if (response.status == AECP::AECP_Status::IN_PROGRESS) {
+        // The entity is working on it; restart the timer (9.2.1.2.5)
+        slot.command.send_time_ms = now_ms;
+        return;
+    }
+
+    const uint8_t* data = nullptr;
+    size_t length = 0;
+    if (response.status == AECP::AECP_Status::SUCCESS) {
+        uint16_t config_index = 0, type = 0, index = 0;
+        response.get_read_descriptor_response(config_index, type, index, data, length);
+        if (length < 4 || type != slot.descriptor_type || index != slot.descriptor_index) {
+            stats_.responses_ignored++;
+            return;
+        }
+    }
+
+    Slot answered = slot;
+    slot.used = false;
+    inflight_count_--;
+    job.inflight--;
+    stats_.responses_matched++;
+    handle_descriptor(job, answered, data, length, now_ms);
+}
+
+void EnumerationEngine::handle_descriptor(Job& job, const Slot& slot, const uint8_t* data, size_t length,
+                                          uint64_t now_ms) {
+    if (data == nullptr) {
+        // Error status. Without ENTITY and CONFIGURATION there is nothing to
+        // enumerate; a missing leaf descriptor is skipped.
+        if (job.phase != Phase::Descriptors) {
+            finish(job.entity_id, false, now_ms);
+            return;
+        }
+        maybe_finish(job, now_ms);
+        return;
+    }
+
+    job.model->descriptors[EntityModelData::descriptor_key(slot.descriptor_type, slot.descriptor_index)]
+        .assign(data, data + length);
+
+    switch (job.phase) {
+    case Phase::Entity: {
+        if (length < ENTITY_DESCRIPTOR_MIN_SIZE) {
+            finish(job.entity_id, false, now_ms);
+            return;
+        }
+        uint64_t model_id = read_be64(data + ENTITY_MODEL_ID_OFFSET);
+        if (job.entity_model_id == 0 && model_id != 0) {
+            // Not advertised up front; the descriptor tells us now
+            auto cached = model_cache_.find(model_id);
+            if (cached != model_cache_.end()) {
+                uint64_t entity_id = job.entity_id;
+                stats_.model_cache_hits++;
+                active_.erase(entity_id);
+                known_entities_.erase(entity_id);
+                complete(entity_id, cached->second);
+                start_pending(now_ms);
+                return;
+            }
+            auto waiting = model_waiters_.find(model_id);
+            if (waiting != model_waiters_.end()) {
+                uint64_t entity_id = job.entity_id;
+                waiting->second.push_back(entity_id);
+                parked_count_++;
+                active_.erase(entity_id);
+                start_pending(now_ms);
+                return;
+            }
+            model_waiters_.emplace(model_id, std::vector<uint64_t>());
+            job.entity_model_id = model_id;
+        }
+        job.model->entity_model_id = job.entity_model_id;
+        job.model->configuration_index = read_be16(data + CURRENT_CONFIGURATION_OFFSET);
+        job.phase = Phase::Configuration;
+        send_read(job, job.model->configuration_index, AEM::DESCRIPTOR_CONFIGURATION,
+                  job.model->configuration_index, now_ms);
+        return;
+    }
+
+    case Phase::Configuration: {
+        if (length < CONFIGURATION_DESCRIPTOR_MIN_SIZE) {
+            finish(job.entity_id, false, now_ms);
+            return;
+        }
+        uint16_t count = read_be16(data + DESCRIPTOR_COUNTS_COUNT_OFFSET);
+        size_t offset = read_be16(data + DESCRIPTOR_COUNTS_OFFSET_OFFSET);
+        for (uint16_t i = 0; i < count && offset + 4 <= length; ++i, offset += 4) {
+            uint16_t type = read_be16(data + offset);
+            uint16_t n = read_be16(data + offset + 2);
+            if (type == AEM::DESCRIPTOR_ENTITY || type == AEM::DESCRIPTOR_CONFIGURATION) {
+                continue;
+            }
+            for (uint16_t index = 0; index < n; ++index) {
+                job.todo.push_back(EntityModelData::descriptor_key(type, index));
+            }
+        }
+        job.phase = Phase::Descriptors;
+        fill_window(job, now_ms);
+        maybe_finish(job, now_ms);
+        return;
+    }
+
+    case Phase::Descriptors:
+        maybe_finish(job, now_ms);
+        return;
+    }
+}
+
+void EnumerationEngine::maybe_finish(Job& job, uint64_t now_ms) {
+    fill_window(job, now_ms);
+    if (job.inflight == 0 && job.next >= job.todo.size()) {
+        finish(job.entity_id, true, now_ms);
+    }
+}
+
+void EnumerationEngine::tick(uint64_t now_ms) {
+    if (inflight_count_ != 0) {
+        for (Slot& slot : slots_) {
+            if (!slot.used || now_ms - slot.command.send_time_ms < slot.command.timeout_ms) {
+                continue;
+            }
+            if (slot.command.retry_count < slot.command.max_retries) {
+                slot.command.retry_count++;
+                slot.command.send_time_ms = now_ms;
+                stats_.retries++;
+                transmit(slot);
+            } else {
+                finish(slot.command.target_entity_id, false, now_ms);
+            }
+        }
+    }
+    start_pending(now_ms);
+}
+
+void EnumerationEngine::release_slots(uint64_t entity_id) {
+    for (Slot& slot : slots_) {
+        if (slot.used && slot.command.target_entity_id == entity_id) {
+            slot.used = false;
+            inflight_count_--;
+        }
+    }
+}
+
+void EnumerationEngine::finish(uint64_t entity_id, bool success, uint64_t now_ms) {
+    auto it = active_.find(entity_id);
+    if (it == active_.end()) {
+        return;
+    }
+    Job job = std::move(it->second);
+    active_.erase(it);
+    known_entities_.erase(entity_id);
+    if (job.inflight != 0) {
+        release_slots(entity_id);
+    }
+
+    std::vector<uint64_t> waiters;
+    if (job.entity_model_id != 0) {
+        auto waiting = model_waiters_.find(job.entity_model_id);
+        if (waiting != model_waiters_.end()) {
+            waiters.swap(waiting->second);
+            model_waiters_.erase(waiting);
+            parked_count_ -= waiters.size();
+        }
+        if (success) {
+            model_cache_[job.entity_model_id] = job.model;
+        }
+    }
+
+    if (success) {
+        stats_.entities_completed++;
+        complete(entity_id, job.model);
+        for (uint64_t waiter : waiters) {
+            stats_.model_cache_hits++;
+            known_entities_.erase(waiter);
+            complete(waiter, job.model);
+        }
+    } else {
+        stats_.entities_failed++;
+        complete(entity_id, nullptr);
+        // Someone else has to read the model the hard way
+        for (auto w = waiters.rbegin(); w != waiters.rend(); ++w) {
+            Job retry;
+            retry.entity_id = *w;
+            retry.entity_model_id = job.entity_model_id;
+            pending_.push_front(std::move(retry));
+        }
+    }
+    start_pending(now_ms);
+}
+
+void EnumerationEngine::complete(uint64_t entity_id, std::shared_ptr<const EntityModelData> model) {
+    if (on_complete_) {
+        on_complete_(entity_id, std::move(model));
+    }
+}
+
+} // namespace Enumeration
+} // namespace _2021
+} // namespace _1722_1
+} // namespace IEEE
@@ -0,0 +1,181 @@
+/**
+ * @file ieee_1722_1_2021_enumeration_engine.h
+ * @brief Pipelined AEM enumeration of many ATDECC entities at once
+ * @details A controller that reads one descriptor at a time and finishes one
+ * entity before starting the next pays a full AECP round trip per
+ * descriptor. The engine below keeps a bounded window of READ_DESCRIPTOR
+ * commands outstanding per entity, interleaves a bounded number of entities,
+ * and reuses the static model of any entity_model_id it has already read.
+ *
+ * Enumeration of one entity:
+ *   1. READ_DESCRIPTOR ENTITY(0) -> entity_model_id, current_configuration
+ *   2. READ_DESCRIPTOR CONFIGURATION(current_configuration) -> descriptor_counts
+ *   3. READ_DESCRIPTOR for every (type, index) named by descriptor_counts,
+ *      up to window_per_entity in flight at a time
+ *
+ * The engine owns no socket and no thread: commands leave through the send
+ * callback, responses are fed to on_response() and time advances through
+ * tick(). All calls must come from the same thread.
+ *
+ * @copyright
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include "ieee_1722_1_2021_core.h"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace IEEE {
+namespace _1722_1 {
+namespace _2021 {
+namespace Enumeration {
+
+/**
+ * @brief Tuning knobs for EnumerationEngine
+ */
+struct EnumerationConfig {
+    uint16_t window_per_entity = 8;         ///< READ_DESCRIPTOR commands in flight per entity
+    uint16_t max_concurrent_entities = 64;  ///< Entities being enumerated at the same time
+    uint32_t command_timeout_ms = 250;      ///< AECP command timeout (IEEE 1722.1-2021 9.2.1)
+    uint8_t max_retries = 2;                ///< Resends before an entity is given up
+};
+
+/**
+ * @brief Static entity model as read from one entity
+ *
+ * Descriptors are stored raw (descriptor_type and descriptor_index
+ * included), keyed by descriptor_key(). Entities sharing an entity_model_id
+ * share one instance.
+ */
+struct EntityModelData {
+    uint64_t entity_model_id = 0;
+    uint16_t configuration_index = 0;
+    std::unordered_map<uint32_t, std::vector<uint8_t>> descriptors;
+
+    static constexpr uint32_t descriptor_key(uint16_t type, uint16_t index) {
+        return (static_cast<uint32_t>(type) << 16) | index;
+    }
+    const std::vector<uint8_t>* find(uint16_t type, uint16_t index) const;
+};
+
+/**
+ * @brief Counters for monitoring and benchmarking
+ */
+struct EnumerationStats {
+    uint64_t commands_sent = 0;
+    uint64_t responses_matched = 0;
+    uint64_t responses_ignored = 0;     ///< Unknown, stale or duplicate sequence_id
+    uint64_t retries = 0;
+    uint64_t model_cache_hits = 0;
+    uint64_t entities_completed = 0;
+    uint64_t entities_failed = 0;
+    uint32_t peak_inflight = 0;
+};
+
+/**
+ * @brief Multi-entity, windowed AEM enumeration state machine
+ */
+class EnumerationEngine {
+public:
+    using Pdu = AECP::ATDECCEnumerationControlProtocolPDU;
+    /// Transmit a serialized AECP command. Returning false counts as a lost frame.
+    using SendCallback = std::function<bool(const Pdu& command)>;
+    /// Called once per enumerate() request; model is null on failure.
+    using CompletionCallback = std::function<void(uint64_t entity_id,
+                                                  std::shared_ptr<const EntityModelData> model)>;
+
+    EnumerationEngine(uint64_t controller_entity_id, SendCallback send,
+                      const EnumerationConfig& config = EnumerationConfig());
+
+    void set_completion_callback(CompletionCallback callback) { on_complete_ = std::move(callback); }
+
+    /**
+     * @brief Queue an entity for enumeration
+     * @param entity_model_id Value from the entity's ADPDU, 0 if unknown.
+     *        A model already in the cache completes the entity without
+     *        sending anything.
+     * @return false if the entity is already queued or being enumerated
+     */
+    bool enumerate(uint64_t entity_id, uint64_t entity_model_id, uint64_t now_ms);
+
+    /// Feed an AEM_RESPONSE received from the network.
+    void on_response(const Pdu& response, uint64_t now_ms);
+
+    /// Resend or give up on timed-out commands and start queued entities.
+    void tick(uint64_t now_ms);
+
+    /// Cached model for an entity_model_id, null if not (yet) known.
+    std::shared_ptr<const EntityModelData> cached_model(uint64_t entity_model_id) const;
+
+    bool idle() const { return active_.empty() && pending_.empty() && parked_count_ == 0; }
+    size_t inflight() const { return inflight_count_; }
+    size_t active_entities() const { return active_.size(); }
+    const EnumerationStats& stats() const { return stats_; }
+    const EnumerationConfig& config() const { return config_; }
+
+private:
+    enum class Phase : uint8_t { Entity, Configuration, Descriptors };
+
+    struct Job {
+        uint64_t entity_id = 0;
+        uint64_t entity_model_id = 0;
+        Phase phase = Phase::Entity;
+        std::shared_ptr<EntityModelData> model;
+        std::vector<uint32_t> todo;     ///< descriptor keys still to request
+        size_t next = 0;                ///< first entry of todo not yet sent
+        uint16_t inflight = 0;
+    };
+
+    struct Slot {
+        bool used = false;
+        AEM::InflightCommand command{};
+        uint16_t configuration_index = 0;
+        uint16_t descriptor_type = 0;
+        uint16_t descriptor_index = 0;
+    };
+
+    void start_pending(uint64_t now_ms);
+    void fill_window(Job& job, uint64_t now_ms);
+    bool send_read(Job& job, uint16_t config_index, uint16_t type, uint16_t index, uint64_t now_ms);
+    void transmit(const Slot& slot);
+    void handle_descriptor(Job& job, const Slot& slot, const uint8_t* data, size_t length, uint64_t now_ms);
+    void maybe_finish(Job& job, uint64_t now_ms);
+    void finish(uint64_t entity_id, bool success, uint64_t now_ms);
+    void release_slots(uint64_t entity_id);
+    void complete(uint64_t entity_id, std::shared_ptr<const EntityModelData> model);
+
+    uint64_t controller_entity_id_;
+    SendCallback send_;
+    CompletionCallback on_complete_;
+    EnumerationConfig config_;
+
+    // Inflight table: sequence_id & mask -> slot, O(1) response matching
+    std::vector<Slot> slots_;
+    uint16_t slot_mask_;
+    uint16_t next_sequence_id_ = 0;
+    size_t inflight_count_ = 0;
+
+    std::deque<Job> pending_;
+    std::unordered_map<uint64_t, Job> active_;
+    std::unordered_set<uint64_t> known_entities_;
+
+    std::unordered_map<uint64_t, std::shared_ptr<EntityModelData>> model_cache_;
+    // entity_model_id being read by an active job -> entities waiting for it
+    std::unordered_map<uint64_t, std::vector<uint64_t>> model_waiters_;
+    size_t parked_count_ = 0;
+
+    EnumerationStats stats_;
+};
+
+} // namespace Enumeration
+} // namespace _2021
+} // namespace _1722_1
+} // namespace IEEE
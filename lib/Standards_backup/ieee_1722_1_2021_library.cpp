@@ -12,6 +12,7 @@
  */
 
 #include "ieee_1722_1_2021_library.h"
+#include "ieee_1722_1_2021_entity_table.h"
 #include <stdexcept>
 #include <cstring>
 
@@ -167,9 +168,9 @@ public:
             _workerThread.join();
         }
         
-        // Clear discovered entities
-        std::lock_guard<std::mutex> lock(_entitiesMutex);
+        // Clear discovered entities (worker is gone, the wheel is ours)
         _discoveredEntities.clear();
+        _entityTimeouts.clear();
     }
     
     bool isRunning() const {
@@ -194,15 +195,13 @@ public:
     }
     
     std::vector<DiscoveredEntity> getDiscoveredEntities() const {
-        std::lock_guard<std::mutex> lock(_entitiesMutex);
-        std::vector<DiscoveredEntity> entities;
-        entities.reserve(_discoveredEntities.size());
-        
-        for (const auto& pair : _discoveredEntities) {
-            entities.push_back(pair.second);
+        return _discoveredEntities.copy();
+    }
+    
+    void forEachDiscoveredEntity(const std::function<void(const DiscoveredEntity&)>& visitor) const {
+        for (const DiscoveredEntity& entity : _discoveredEntities.snapshot()) {
+            visitor(entity);
         }
-        
-        return entities;
     }
     
     bool connectStream(EntityID talkerEntityID, uint16_t talkerUniqueID,
@@ -284,9 +283,11 @@ private:
     std::chrono::seconds _entityTimeout;
     std::chrono::milliseconds _commandTimeout;
     
-    // State management
-    std::unordered_map<EntityID, DiscoveredEntity> _discoveredEntities;
-    mutable std::mutex _entitiesMutex;
+    // State management: readers snapshot the table lock-free, the worker
+    // thread is the only writer and owns the timeout wheel
+    EntityTable<DiscoveredEntity> _discoveredEntities;
+    TimerWheel _entityTimeouts;
+    std::vector<uint64_t> _expiredEntities;
     
     // Sequence ID management
     std::atomic<uint16_t> _sequenceID{1};
@@ -362,20 +363,14 @@ private:
     }
     
     void removeTimedOutEntities(std::chrono::steady_clock::time_point now) {
-        std::lock_guard<std::mutex> lock(_entitiesMutex);
+        // Only the wheel buckets due since the last call are visited
+        _expiredEntities.clear();
+        _entityTimeouts.advance(now, _expiredEntities);
         
-        auto it = _discoveredEntities.begin();
-        while (it != _discoveredEntities.end()) {
-            if (now >= it->second.timeout) {
-                EntityID entityID = it->first;
-                it = _discoveredEntities.erase(it);
-                
+        for (uint64_t entityID : _expiredEntities) {
+            if (_discoveredEntities.erase(entityID) && _libraryDelegate) {
                 // Notify application of entity departure
-                if (_libraryDelegate) {
-                    _libraryDelegate->onEntityDeparted(entityID);
-                }
-            } else {
-                ++it;
+                _libraryDelegate->onEntityDeparted(entityID);
             }
         }
     }
@@ -430,6 +425,10 @@ std::vector<DiscoveredEntity> AVDECCLibrary::getDiscoveredEntities() const {
     return _impl->getDiscoveredEntities();
 }
 
+void AVDECCLibrary::forEachDiscoveredEntity(const std::function<void(const DiscoveredEntity&)>& visitor) const {
+    _impl->forEachDiscoveredEntity(visitor);
+}
+
 bool AVDECCLibrary::connectStream(EntityID talkerEntityID, uint16_t talkerUniqueID,
                                  EntityID listenerEntityID, uint16_t listenerUniqueID) {
     return _impl->connectStream(talkerEntityID, talkerUniqueID, listenerEntityID, listenerUniqueID);
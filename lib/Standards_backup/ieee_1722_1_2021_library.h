@@ -471,6 +471,8 @@ public:
     void discoverAllEntities();
     void discoverEntity(EntityID entityID);
     std::vector<DiscoveredEntity> getDiscoveredEntities() const;
+    /** Visit the discovered entities in place, without copying or locking */
+    void forEachDiscoveredEntity(const std::function<void(const DiscoveredEntity&)>& visitor) const;
     
     // High-level connection operations
     bool connectStream(EntityID talkerEntityID, uint16_t talkerUniqueID,
@@ -184,12 +184,61 @@ void ADPDiscoveryStateMachine::sendDiscoveryMessage(EntityID entityID) {
     }
 }
 
+void ADPDiscoveryStateMachine::processAvailableMessage(const ADPEntityAvailableMessage& message) {
+    DiscoveredEntity entity{};
+    entity.entityID = message.entityID;
+    entity.entityModelID = message.entityModelID;
+    entity.entityCapabilities = message.entityCapabilities;
+    entity.talkerStreamSources = message.talkerStreamSources;
+    entity.talkerCapabilities = message.talkerCapabilities;
+    entity.listenerStreamSinks = message.listenerStreamSinks;
+    entity.listenerCapabilities = message.listenerCapabilities;
+    entity.controllerCapabilities = message.controllerCapabilities;
+    entity.macAddress = message.sourceMac;
+    entity.availableIndex = message.availableIndex;
+    entity.gptpGrandmasterID = message.gptpGrandmasterID;
+    entity.gptpDomainNumber = message.gptpDomainNumber;
+    entity.identifyControlIndex = message.identifyControlIndex;
+    entity.interfaceIndex = message.interfaceIndex;
+    entity.associationID = message.associationID;
+    entity.lastSeen = message.timestamp;
+    // valid_time is in 2 second units (IEEE 1722.1-2021 6.2.1.6)
+    entity.timeout = message.timestamp + (message.validTime != 0
+        ? std::chrono::steady_clock::duration(std::chrono::seconds(2 * message.validTime))
+        : std::chrono::steady_clock::duration(_entityTimeout));
+    
+    std::lock_guard<std::mutex> lock(_entityTimeoutsMutex);
+    bool isNew = _discoveredEntities.upsert(entity.entityID, entity);
+    _entityTimeouts.schedule(entity.entityID, entity.timeout);
+    
+    if (isNew) {
+        _entitiesDiscovered++;
+        if (onEntityDiscovered) {
+            onEntityDiscovered(entity);
+        }
+    }
+}
+
+void ADPDiscoveryStateMachine::processDepartingMessage(const ADPEntityDepartingMessage& message) {
+    std::lock_guard<std::mutex> lock(_entityTimeoutsMutex);
+    _entityTimeouts.cancel(message.entityID);
+    if (_discoveredEntities.erase(message.entityID) && onEntityDeparted) {
+        onEntityDeparted(message.entityID);
+    }
+}
+
 void ADPDiscoveryStateMachine::cleanupExpiredEntities() {
-    std::lock_guard<std::mutex> lock(_entitiesMutex);
-    auto now = std::chrono::steady_clock::now();
+    // Only the wheel buckets due since the last sweep are visited. Holding the
+    // lock from advance() to erase() keeps a refresh from landing in between.
+    std::lock_guard<std::mutex> lock(_entityTimeoutsMutex);
+    _expiredEntities.clear();
+    _entityTimeouts.advance(std::chrono::steady_clock::now(), _expiredEntities);
     
-    // Placeholder for entity cleanup logic
-    // Full implementation will track discovered entities with timeouts
+    for (uint64_t entityID : _expiredEntities) {
+        if (_discoveredEntities.erase(entityID) && onEntityDeparted) {
+            onEntityDeparted(entityID);
+        }
+    }
 }
 
 void ADPDiscoveryStateMachine::setDiscoveryInterval(std::chrono::milliseconds interval) {
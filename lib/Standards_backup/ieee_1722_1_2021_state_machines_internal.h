@@ -17,6 +17,7 @@
 #pragma once
 
 #include "ieee_1722_1_2021_library.h"
+#include "ieee_1722_1_2021_entity_table.h"
 #include <chrono>
 #include <queue>
 #include <unordered_map>
@@ -115,6 +116,10 @@ public:
     void processAvailableMessage(const ADPEntityAvailableMessage& message);
     void processDepartingMessage(const ADPEntityDepartingMessage& message);
     
+    // Lock-free read access for API/UI threads
+    std::vector<DiscoveredEntity> getDiscoveredEntities() const { return _discoveredEntities.copy(); }
+    EntityTable<DiscoveredEntity>::Snapshot snapshotDiscoveredEntities() const { return _discoveredEntities.snapshot(); }
+    
     // Event callbacks
     std::function<void(const DiscoveredEntity&)> onEntityDiscovered;
     std::function<void(EntityID)> onEntityDeparted;
@@ -144,9 +149,15 @@ private:
     std::chrono::milliseconds _discoveryInterval{2000};  // 2 seconds default
     std::chrono::seconds _entityTimeout{62};              // 62 seconds per IEEE standard
     
-    // Discovered entities
-    std::unordered_map<EntityID, DiscoveredEntity> _discoveredEntities;
-    std::mutex _entitiesMutex;
+    // Discovered entities: immutable records published per ADP update,
+    // expired through the timer wheel instead of a full scan. ADP messages
+    // and the timeout sweep run on different threads; _entityTimeoutsMutex
+    // covers the wheel and each table update that goes with it. Readers
+    // still take snapshots without it.
+    EntityTable<DiscoveredEntity> _discoveredEntities;
+    TimerWheel _entityTimeouts;
+    std::vector<uint64_t> _expiredEntities;
+    std::mutex _entityTimeoutsMutex;
     
     // Statistics
     std::atomic<uint32_t> _discoveryMessagesSent{0};
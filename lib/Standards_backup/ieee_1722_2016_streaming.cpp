@@ -14,49 +14,59 @@ namespace ieee_1722_2016 {
 
 // ====== AVTPDU Base Class Implementation ======
 
+static void reset_header(AVTPDU& pdu) {
+    pdu.subtype = static_cast<uint8_t>(Subtype::IEC61883_IIDC);
+    pdu.stream_valid = true;
+    pdu.version = AVTP_VERSION_2016;
+    pdu.mr = false;
+    pdu.gv = false;
+    pdu.tv = true;
+    pdu.sequence_num = 0;
+    pdu.tu = false;
+    std::memset(pdu.stream_id, 0, sizeof(pdu.stream_id));
+    pdu.avtp_timestamp = 0;
+    pdu.stream_data_length = 0;
+    pdu.format_specific_data = 0;
+}
+
 AVTPDU::AVTPDU() {
-    subtype = static_cast<uint8_t>(Subtype::IEC61883_IIDC);
-    stream_valid = true;
-    version = AVTP_VERSION_2016;
-    mr = false;
-    gv = false;
-    tv = true;
-    sequence_num = 0;
-    tu = false;
-    std::memset(stream_id, 0, sizeof(stream_id));
-    avtp_timestamp = 0;
-    stream_data_length = 0;
-    format_specific_data = 0;
+    reset_header(*this);
     payload.fill(0);
 }
 
-AVTPDU::AVTPDU(const uint8_t* data, size_t length) : AVTPDU() {
-    deserialize(data, length);
+AVTPDU::AVTPDU(const uint8_t* data, size_t length) : AVTPDU(AVTPDUView(data, length)) {
+}
+
+AVTPDU::AVTPDU(const AVTPDUView& view) {
+    reset_header(*this);
+
+    // Only clear the part of the payload the frame doesn't fill
+    size_t copied = deserialize(view) ? std::min(view.payload_size(), payload.size()) : 0;
+    std::fill(payload.begin() + copied, payload.end(), 0);
+}
+
+size_t AVTPDU::serialize_header(const AVTPDUBuilder& out) const {
+    if (!out.has_header()) return 0;
+
+    out.clear_header()
+       .set_subtype(subtype)
+       .set_stream_valid(stream_valid)
+       .set_version(version)
+       .set_mr(mr)
+       .set_gv(gv)
+       .set_tv(tv)
+       .set_sequence_num(sequence_num)
+       .set_tu(tu)
+       .set_stream_id(stream_id)
+       .set_avtp_timestamp(avtp_timestamp)
+       .set_stream_data_length(stream_data_length)
+       .set_format_specific_data(format_specific_data);
+    return get_header_size();
 }
 
 void AVTPDU::serialize(uint8_t* buffer, size_t& size) const {
     size = get_header_size() + stream_data_length;
-    
-    // Serialize AVTP header
-    buffer[0] = (subtype & 0x7F) | (stream_valid ? 0x80 : 0);
-    buffer[1] = (version << 3) | (mr ? 0x04 : 0) | (gv ? 0x02 : 0) | (tv ? 0x01 : 0);
-    buffer[2] = sequence_num;
-    buffer[3] = tu ? 0x01 : 0;
-    
-    // Stream ID (8 bytes)
-    std::memcpy(&buffer[4], stream_id, 8);
-    
-    // Timestamp (4 bytes, network order)
-    buffer[12] = (avtp_timestamp >> 24) & 0xFF;
-    buffer[13] = (avtp_timestamp >> 16) & 0xFF;
-    buffer[14] = (avtp_timestamp >> 8) & 0xFF;
-    buffer[15] = avtp_timestamp & 0xFF;
-    
-    // Stream data length and format specific data (4 bytes)
-    buffer[16] = (stream_data_length >> 8) & 0xFF;
-    buffer[17] = stream_data_length & 0xFF;
-    buffer[18] = (format_specific_data >> 8) & 0xFF;
-    buffer[19] = format_specific_data & 0xFF;
+    serialize_header(AVTPDUBuilder(buffer, size));
     
     // Copy payload data
     if (stream_data_length > 0) {
@@ -65,43 +75,35 @@ void AVTPDU::serialize(uint8_t* buffer, size_t& size) const {
     }
 }
 
-bool AVTPDU::deserialize(const uint8_t* data, size_t size) {
-    if (size < get_header_size()) return false;
-    
-    // Parse AVTP header
-    subtype = data[0] & 0x7F;
-    stream_valid = (data[0] & 0x80) != 0;
-    version = (data[1] >> 3) & 0x07;
-    mr = (data[1] & 0x04) != 0;
-    gv = (data[1] & 0x02) != 0;
-    tv = (data[1] & 0x01) != 0;
-    sequence_num = data[2];
-    tu = (data[3] & 0x01) != 0;
+bool AVTPDU::deserialize(const AVTPDUView& in) {
+    if (!in.has_header()) return false;
     
-    // Stream ID
-    std::memcpy(stream_id, &data[4], 8);
-    
-    // Timestamp
-    avtp_timestamp = (static_cast<uint32_t>(data[12]) << 24) |
-                    (static_cast<uint32_t>(data[13]) << 16) |
-                    (static_cast<uint32_t>(data[14]) << 8) |
-                    static_cast<uint32_t>(data[15]);
-    
-    // Stream data length and format specific data
-    stream_data_length = (static_cast<uint16_t>(data[16]) << 8) | data[17];
-    format_specific_data = (static_cast<uint16_t>(data[18]) << 8) | data[19];
+    subtype = in.subtype();
+    stream_valid = in.stream_valid();
+    version = in.version();
+    mr = in.mr();
+    gv = in.gv();
+    tv = in.tv();
+    sequence_num = in.sequence_num();
+    tu = in.tu();
+    std::memcpy(stream_id, in.stream_id_bytes(), 8);
+    avtp_timestamp = in.avtp_timestamp();
+    stream_data_length = in.stream_data_length();
+    format_specific_data = in.format_specific_data();
     
     // Copy payload
-    if (size > get_header_size() && stream_data_length > 0) {
-        size_t payload_size = std::min(static_cast<size_t>(stream_data_length), 
-                                     size - get_header_size());
-        payload_size = std::min(payload_size, payload.size());
-        std::memcpy(payload.data(), &data[get_header_size()], payload_size);
+    size_t payload_size = std::min(in.payload_size(), payload.size());
+    if (payload_size > 0) {
+        std::memcpy(payload.data(), in.payload(), payload_size);
     }
     
     return true;
 }
 
+bool AVTPDU::deserialize(const uint8_t* data, size_t size) {
+    return deserialize(AVTPDUView(data, size));
+}
+
 // ====== Audio AVTPDU Implementation ======
 
 AudioAVTPDU::AudioAVTPDU() : AVTPDU() {
@@ -9,8 +9,10 @@
 #define IEEE_1722_2016_STREAMING_H
 
 #include <cstdint>
+#include <cstddef>
 #include <array>
 #include <string>
+#include <type_traits>
 
 namespace avtp_protocol {
 namespace ieee_1722_2016 {
@@ -72,6 +74,134 @@ enum class Subtype : uint8_t {
     CRF_VIDEO = 0x07,           // Legacy - now mapped to RVF
     AES_ENCRYPTED = AEF_CONTINUOUS // Alias for AES Encrypted
 };
+
+// =============================
+// Zero-copy AVTPDU views
+// =============================
+// Non-owning accessors for the AVTPDU header over a caller-owned frame buffer.
+// Nothing is copied: getters decode the wire bytes and setters encode straight
+// into them. AVTPDUView (const bytes) is for parsing received frames,
+// AVTPDUBuilder (mutable bytes) for filling a TX frame in place. The field
+// layout is the one AVTPDU::serialize()/deserialize() use.
+template <typename Byte>
+class BasicAVTPDUView {
+    static_assert(std::is_same<typename std::remove_const<Byte>::type, uint8_t>::value,
+                  "BasicAVTPDUView works on uint8_t or const uint8_t");
+
+    template <typename B>
+    using if_mutable = typename std::enable_if<!std::is_const<B>::value, const BasicAVTPDUView&>::type;
+
+public:
+    static constexpr size_t HEADER_SIZE = 20;
+
+    constexpr BasicAVTPDUView() noexcept : data_(nullptr), size_(0) {}
+    constexpr BasicAVTPDUView(Byte* data, size_t size) noexcept : data_(data), size_(size) {}
+
+    // A builder can always be looked at as a read-only view
+    template <typename Other,
+              typename = typename std::enable_if<std::is_const<Byte>::value && !std::is_const<Other>::value>::type>
+    constexpr BasicAVTPDUView(const BasicAVTPDUView<Other>& other) noexcept
+        : data_(other.data()), size_(other.size()) {}
+
+    constexpr Byte* data() const { return data_; }
+    constexpr size_t size() const { return size_; }
+
+    // True if the buffer holds at least a full header
+    constexpr bool has_header() const { return data_ != nullptr && size_ >= HEADER_SIZE; }
+
+    // Header fields. Only valid if has_header().
+    constexpr uint8_t subtype() const { return data_[0] & 0x7F; }
+    constexpr bool stream_valid() const { return (data_[0] & 0x80) != 0; }
+    constexpr uint8_t version() const { return (data_[1] >> 3) & 0x07; }
+    constexpr bool mr() const { return (data_[1] & 0x04) != 0; }
+    constexpr bool gv() const { return (data_[1] & 0x02) != 0; }
+    constexpr bool tv() const { return (data_[1] & 0x01) != 0; }
+    constexpr uint8_t sequence_num() const { return data_[2]; }
+    constexpr bool tu() const { return (data_[3] & 0x01) != 0; }
+    constexpr Byte* stream_id_bytes() const { return data_ + 4; }
+    constexpr uint64_t stream_id() const { return get_be(4, 8); }
+    constexpr uint32_t avtp_timestamp() const { return static_cast<uint32_t>(get_be(12, 4)); }
+    constexpr uint16_t stream_data_length() const { return static_cast<uint16_t>(get_be(16, 2)); }
+    constexpr uint16_t format_specific_data() const { return static_cast<uint16_t>(get_be(18, 2)); }
+
+    // Payload in place, clipped to what the buffer actually holds
+    constexpr Byte* payload() const { return data_ + HEADER_SIZE; }
+    constexpr size_t payload_size() const {
+        return size_ - HEADER_SIZE < stream_data_length() ? size_ - HEADER_SIZE : stream_data_length();
+    }
+
+    // Setters, builders only. They return the view so calls can be chained.
+    template <typename B = Byte>
+    constexpr if_mutable<B> clear_header() const {
+        for (size_t i = 0; i < HEADER_SIZE; ++i) data_[i] = 0;
+        return *this;
+    }
+    template <typename B = Byte>
+    constexpr if_mutable<B> set_subtype(uint8_t value) const {
+        data_[0] = static_cast<uint8_t>((data_[0] & 0x80) | (value & 0x7F));
+        return *this;
+    }
+    template <typename B = Byte>
+    constexpr if_mutable<B> set_stream_valid(bool value) const { return set_bit(0, 0x80, value); }
+    template <typename B = Byte>
+    constexpr if_mutable<B> set_version(uint8_t value) const {
+        data_[1] = static_cast<uint8_t>((data_[1] & ~0x38) | ((value & 0x07) << 3));
+        return *this;
+    }
+    template <typename B = Byte>
+    constexpr if_mutable<B> set_mr(bool value) const { return set_bit(1, 0x04, value); }
+    template <typename B = Byte>
+    constexpr if_mutable<B> set_gv(bool value) const { return set_bit(1, 0x02, value); }
+    template <typename B = Byte>
+    constexpr if_mutable<B> set_tv(bool value) const { return set_bit(1, 0x01, value); }
+    template <typename B = Byte>
+    constexpr if_mutable<B> set_sequence_num(uint8_t value) const {
+        data_[2] = value;
+        return *this;
+    }
+    template <typename B = Byte>
+    constexpr if_mutable<B> set_tu(bool value) const { return set_bit(3, 0x01, value); }
+    template <typename B = Byte>
+    constexpr if_mutable<B> set_stream_id(uint64_t value) const { return set_be(4, 8, value); }
+    template <typename B = Byte>
+    constexpr if_mutable<B> set_stream_id(const uint8_t* bytes) const {
+        for (size_t i = 0; i < 8; ++i) data_[4 + i] = bytes[i];
+        return *this;
+    }
+    template <typename B = Byte>
+    constexpr if_mutable<B> set_avtp_timestamp(uint32_t value) const { return set_be(12, 4, value); }
+    template <typename B = Byte>
+    constexpr if_mutable<B> set_stream_data_length(uint16_t value) const { return set_be(16, 2, value); }
+    template <typename B = Byte>
+    constexpr if_mutable<B> set_format_specific_data(uint16_t value) const { return set_be(18, 2, value); }
+
+private:
+    constexpr uint64_t get_be(size_t offset, size_t bytes) const {
+        uint64_t value = 0;
+        for (size_t i = 0; i < bytes; ++i) value = (value << 8) | data_[offset + i];
+        return value;
+    }
+    template <typename B = Byte>
+    constexpr if_mutable<B> set_be(size_t offset, size_t bytes, uint64_t value) const {
+        for (size_t i = bytes; i > 0; --i) {
+            data_[offset + i - 1] = static_cast<uint8_t>(value);
+            value >>= 8;
+        }
+        return *this;
+    }
+    template <typename B = Byte>
+    constexpr if_mutable<B> set_bit(size_t offset, uint8_t mask, bool value) const {
+        data_[offset] = static_cast<uint8_t>(value ? (data_[offset] | mask) : (data_[offset] & ~mask));
+        return *this;
+    }
+
+    Byte* data_;
+    size_t size_;
+};
+
+using AVTPDUView = BasicAVTPDUView<const uint8_t>;
+using AVTPDUBuilder = BasicAVTPDUView<uint8_t>;
+
 struct AVTPDU {
     // AVTP Common Header (per 2016 spec)
     uint8_t subtype;              // AVTP subtype (audio, video, etc.)
@@ -91,13 +221,19 @@ struct AVTPDU {
     // Constructors
     AVTPDU();
     AVTPDU(const uint8_t* data, size_t length);
+    explicit AVTPDU(const AVTPDUView& view);
     
     // Serialization methods
     void serialize(uint8_t* buffer, size_t& length) const;
     bool deserialize(const uint8_t* data, size_t length);
     
+    // Header only, through the views. serialize_header() returns the bytes
+    // written (0 if the buffer is too small); the payload is left to the caller.
+    size_t serialize_header(const AVTPDUBuilder& out) const;
+    bool deserialize(const AVTPDUView& in);
+    
     // Utility methods
-    static constexpr size_t get_header_size() { return 20; } // AVTP header size
+    static constexpr size_t get_header_size() { return AVTPDUView::HEADER_SIZE; } // AVTP header size
     bool is_valid() const { return version == AVTP_VERSION_2016; }
 };
 
@@ -353,6 +353,94 @@ bool test_new_subtypes() {
     }
 }
 
+// Header-only views must be usable at compile time
+constexpr uint8_t const_frame[] = {
+    0x82, 0x01, 0x05, 0x01, 0x00, 0x1B, 0x21, 0xFF, 0xFE, 0x00, 0x00, 0x01,
+    0x12, 0x34, 0x56, 0x78, 0x00, 0x04, 0xBE, 0xEF, 0x11, 0x22, 0x33, 0x44
+};
+static_assert(AVTPDUView(const_frame, sizeof(const_frame)).has_header(), "header fits");
+static_assert(AVTPDUView(const_frame, sizeof(const_frame)).subtype() == 0x02, "subtype");
+static_assert(AVTPDUView(const_frame, sizeof(const_frame)).sequence_num() == 5, "sequence_num");
+static_assert(AVTPDUView(const_frame, sizeof(const_frame)).stream_id() == 0x001B21FFFE000001ULL, "stream_id");
+static_assert(AVTPDUView(const_frame, sizeof(const_frame)).avtp_timestamp() == 0x12345678, "timestamp");
+static_assert(AVTPDUView(const_frame, sizeof(const_frame)).payload_size() == 4, "payload_size");
+static_assert(!AVTPDUView(const_frame, 19).has_header(), "short frame");
+
+bool test_zero_copy_views() {
+    std::cout << "Test 10: Zero-copy AVTPDU Views\n";
+    
+    AVTPDU original;
+    original.subtype = static_cast<uint8_t>(Subtype::AVTP_AUDIO);
+    original.mr = true;
+    original.tu = true;
+    original.sequence_num = 200;
+    original.avtp_timestamp = 0x01020304;
+    original.stream_data_length = 64;
+    original.format_specific_data = 0xCAFE;
+    for (int i = 0; i < 8; ++i) {
+        original.stream_id[i] = static_cast<uint8_t>(0x10 + i);
+    }
+    for (size_t i = 0; i < 64; ++i) {
+        original.payload[i] = static_cast<uint8_t>(0xFF - i);
+    }
+    
+    std::vector<uint8_t> expected(AVTPDU_MAX_SIZE);
+    size_t expected_length = expected.size();
+    original.serialize(expected.data(), expected_length);
+    
+    // Build the same frame in place, on top of stale bytes
+    std::vector<uint8_t> frame(AVTPDU_MAX_SIZE, 0xA5);
+    AVTPDUBuilder builder(frame.data(), expected_length);
+    builder.clear_header()
+           .set_subtype(original.subtype)
+           .set_stream_valid(true)
+           .set_version(AVTP_VERSION_2016)
+           .set_mr(true)
+           .set_tv(true)
+           .set_tu(true)
+           .set_sequence_num(200)
+           .set_stream_id(0x1011121314151617ULL)
+           .set_avtp_timestamp(0x01020304)
+           .set_stream_data_length(64)
+           .set_format_specific_data(0xCAFE);
+    std::memcpy(builder.payload(), original.payload.data(), 64);
+    bool build_ok = std::memcmp(frame.data(), expected.data(), expected_length) == 0;
+    std::cout << "  Builder output matches serialize(): " << (build_ok ? "PASS" : "FAIL") << "\n";
+    
+    // Parse it back without copying
+    AVTPDUView view = builder;
+    bool parse_ok = view.has_header() &&
+        view.subtype() == original.subtype &&
+        view.stream_valid() && view.mr() && !view.gv() && view.tv() && view.tu() &&
+        view.version() == AVTP_VERSION_2016 &&
+        view.sequence_num() == 200 &&
+        view.avtp_timestamp() == 0x01020304 &&
+        view.stream_data_length() == 64 &&
+        view.format_specific_data() == 0xCAFE &&
+        view.payload() == frame.data() + AVTPDU::get_header_size() &&
+        view.payload_size() == 64;
+    std::cout << "  View reads fields in place: " << (parse_ok ? "PASS" : "FAIL") << "\n";
+    
+    // Truncated frame: payload clipped to the buffer
+    AVTPDUView truncated(frame.data(), AVTPDU::get_header_size() + 10);
+    bool clip_ok = truncated.payload_size() == 10;
+    std::cout << "  Truncated payload clipped: " << (clip_ok ? "PASS" : "FAIL") << "\n";
+    
+    // Owning struct built from a view
+    AVTPDU copy(view);
+    bool copy_ok = copy.sequence_num == 200 &&
+        std::memcmp(copy.payload.data(), original.payload.data(), copy.payload.size()) == 0;
+    std::cout << "  AVTPDU from view: " << (copy_ok ? "PASS" : "FAIL") << "\n";
+    
+    if (build_ok && parse_ok && clip_ok && copy_ok) {
+        std::cout << "  ✓ Zero-copy views working correctly\n";
+        return true;
+    } else {
+        std::cout << "  ✗ Zero-copy view test failed\n";
+        return false;
+    }
+}
+
 // Test 10: SDI Video Format AVTPDU
 bool test_sdi_avtpdu() {
     std::cout << "Test 10: SDI Video Format AVTPDU\n";
@@ -660,7 +748,7 @@ int main() {
     std::cout << "=== IEEE 1722-2016 Standard Implementation Tests ===\n";
     
     int passed = 0;
-    int total = 9;
+    int total = 10;
     
     if (test_avtpdu_creation()) passed++;
     if (test_serialization()) passed++;
@@ -671,6 +759,7 @@ int main() {
     if (test_crf_avtpdu()) passed++;
     if (test_control_avtpdu()) passed++;
     if (test_new_subtypes()) passed++;
+    if (test_zero_copy_views()) passed++;
     
     std::cout << "=== Test Results: " << passed << "/" << total << " Tests Passed ===\n";
     
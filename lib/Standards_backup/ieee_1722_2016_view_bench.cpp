@@ -0,0 +1,102 @@
+/**
+ * @file ieee_1722_2016_view_bench.cpp
+ * @brief Parse + build cost per packet: owning AVTPDU vs zero-copy views
+ *
+ * Each iteration parses a received AVTPDU, reads its header fields and builds
+ * an outgoing frame with the next sequence number and a fresh payload, once
+ * with AVTPDU (deserialize + serialize) and once with AVTPDUView/AVTPDUBuilder
+ * working on the frame buffers directly.
+ *
+ * Usage: ieee_1722_2016_view_bench [iterations]
+ */
+
+#include "ieee_1722_2016_streaming.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+using namespace avtp_protocol::ieee_1722_2016;
+
+namespace {
+
+volatile uint32_t sink;
+
+std::vector<uint8_t> make_rx_frame(uint16_t payload_len) {
+    AVTPDU pdu;
+    pdu.subtype = static_cast<uint8_t>(Subtype::AAF);
+    pdu.sequence_num = 1;
+    pdu.avtp_timestamp = 0x12345678;
+    pdu.stream_data_length = payload_len;
+    for (int i = 0; i < 8; ++i) pdu.stream_id[i] = static_cast<uint8_t>(i);
+    for (size_t i = 0; i < payload_len; ++i) pdu.payload[i] = static_cast<uint8_t>(i);
+
+    std::vector<uint8_t> frame(AVTPDU_MAX_SIZE);
+    size_t len = 0;
+    pdu.serialize(frame.data(), len);
+    frame.resize(len);
+    return frame;
+}
+
+template <typename Fn>
+double ns_per_packet(size_t iterations, Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) fn(i);
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+}
+
+void run(uint16_t payload_len, size_t iterations) {
+    std::vector<uint8_t> rx = make_rx_frame(payload_len);
+    std::vector<uint8_t> samples(payload_len, 0x5A);
+    std::vector<uint8_t> tx(AVTPDU_MAX_SIZE);
+
+    double owning = ns_per_packet(iterations, [&](size_t i) {
+        AVTPDU in(rx.data(), rx.size());
+        AVTPDU out;
+        out.subtype = in.subtype;
+        std::memcpy(out.stream_id, in.stream_id, 8);
+        out.sequence_num = static_cast<uint8_t>(in.sequence_num + i);
+        out.avtp_timestamp = in.avtp_timestamp + 125000;
+        out.stream_data_length = in.stream_data_length;
+        std::memcpy(out.payload.data(), samples.data(), payload_len);
+        size_t len = 0;
+        out.serialize(tx.data(), len);
+        sink = tx[2] + static_cast<uint32_t>(len);
+    });
+
+    double views = ns_per_packet(iterations, [&](size_t i) {
+        AVTPDUView in(rx.data(), rx.size());
+        AVTPDUBuilder out(tx.data(), AVTPDU::get_header_size() + in.stream_data_length());
+        out.clear_header()
+           .set_subtype(in.subtype())
+           .set_stream_valid(true)
+           .set_tv(true)
+           .set_stream_id(in.stream_id_bytes())
+           .set_sequence_num(static_cast<uint8_t>(in.sequence_num() + i))
+           .set_avtp_timestamp(in.avtp_timestamp() + 125000)
+           .set_stream_data_length(in.stream_data_length());
+        std::memcpy(out.payload(), samples.data(), payload_len);
+        sink = tx[2] + static_cast<uint32_t>(out.size());
+    });
+
+    std::cout << std::setw(8) << payload_len
+              << std::setw(14) << std::fixed << std::setprecision(1) << owning
+              << std::setw(14) << views
+              << std::setw(10) << std::setprecision(1) << (owning / views) << "x\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t iterations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000000;
+
+    std::cout << "IEEE 1722-2016 parse + build, ns/packet over " << iterations << " packets\n";
+    std::cout << std::setw(8) << "payload" << std::setw(14) << "AVTPDU" << std::setw(14) << "views" << std::setw(11) << "speedup\n";
+    for (uint16_t len : {48, 192, 1024, 1476}) {
+        run(len, iterations);
+    }
+    return 0;
+}
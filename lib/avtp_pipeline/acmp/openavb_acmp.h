@@ -150,12 +150,15 @@ typedef struct {
 	U16 listener_unique_id;
 } openavb_acmp_ListenerPair_t;
 
+// Connected ListenerPairs of a talker, keyed on the listener. See openavb_acmp_index.h
+typedef struct openavb_acmp_listener_pairs * openavb_acmp_listener_pairs_t;
+
 // TalkerStreamInfo type IEEE Std 1722.1-2013 clause 8.2.2.2.4
 typedef struct {
 	U8 stream_id[8];
 	U8 stream_dest_mac[6];
 	U16 connection_count;
-	openavb_list_t connected_listeners;
+	openavb_acmp_listener_pairs_t connected_listeners;
 	U16 stream_vlan_id;
 
 	// Extra information indicating a GET_TX_CONNECTION_RESPONSE command is needed.
@@ -163,13 +166,20 @@ typedef struct {
 } openavb_acmp_TalkerStreamInfo_t;
 
 // InflightCommand type IEEE Std 1722.1-2013 clause 8.2.2.2.5
-typedef struct {
-	struct timespec timer;
+typedef struct openavb_acmp_InflightCommand {
+	struct timespec timer;		// OPENAVB_CLOCK_MONOTONIC
 	U8 retried;
 	openavb_acmp_ACMPCommandResponse_t command;
 	U16 original_sequence_id;
+
+	// Not part of spec. Maintained by the inflight table.
+	struct openavb_acmp_InflightCommand *next;	// Next in the same sequence_id bucket
+	U32 heapIdx;								// Position in the timer heap
 } openavb_acmp_InflightCommand_t;
 
+// Inflight commands hashed on sequence_id and ordered by timer. See openavb_acmp_index.h
+typedef struct openavb_acmp_inflight * openavb_acmp_inflight_t;
+
 // ACMPCommandParams type IEEE Std 1722.1-2013 clause 8.2.2.2.6
 typedef struct {
 	U8 message_type;
@@ -0,0 +1,440 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+ ******************************************************************
+ * MODULE : ACMP - AVDECC Connection Management Protocol : Keyed Indexes
+ * MODULE SUMMARY : Implements the inflight command table and the connected listener index
+ * used by the ACMP state machines.
+ ******************************************************************
+ */
+
+#include "openavb_platform.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define	AVB_LOG_COMPONENT	"ACMP"
+#include "openavb_log.h"
+
+#include "openavb_time.h"
+#include "openavb_acmp_index.h"
+
+#define INFLIGHT_BUCKET(sequence_id)	((sequence_id) & (OPENAVB_ACMP_INFLIGHT_BUCKETS - 1))
+
+#define LISTENER_PAIRS_MIN_SIZE		4
+#define LISTENER_PAIRS_NONE			0xFFFFFFFF
+
+struct openavb_acmp_inflight {
+	openavb_acmp_InflightCommand_t *bucket[OPENAVB_ACMP_INFLIGHT_BUCKETS];
+
+	// Min-heap on timer
+	openavb_acmp_InflightCommand_t **heap;
+	U32 count;
+	U32 size;
+};
+
+struct openavb_acmp_listener_pairs {
+	openavb_acmp_ListenerPair_t *pair;	// Indexed by connection index
+	U32 *next;							// Next pair index in the same bucket
+	U32 *bucket;						// First pair index of each bucket
+	U32 count;
+	U32 size;							// Allocated pairs, also the number of buckets
+};
+
+
+static void inflightHeapSet(openavb_acmp_inflight_t inflight, U32 idx, openavb_acmp_InflightCommand_t *pInflight)
+{
+	inflight->heap[idx] = pInflight;
+	pInflight->heapIdx = idx;
+}
+
+static void inflightSiftUp(openavb_acmp_inflight_t inflight, U32 idx)
+{
+	openavb_acmp_InflightCommand_t *pInflight = inflight->heap[idx];
+	while (idx > 0) {
+		U32 parent = (idx - 1) / 2;
+		if (openavbTimeTimespecCmp(&inflight->heap[parent]->timer, &pInflight->timer) <= 0) {
+			break;
+		}
+		inflightHeapSet(inflight, idx, inflight->heap[parent]);
+		idx = parent;
+	}
+	inflightHeapSet(inflight, idx, pInflight);
+}
+
+static void inflightSiftDown(openavb_acmp_inflight_t inflight, U32 idx)
+{
+	openavb_acmp_InflightCommand_t *pInflight = inflight->heap[idx];
+	while (TRUE) {
+		U32 child = idx * 2 + 1;
+		if (child >= inflight->count) {
+			break;
+		}
+		if (child + 1 < inflight->count &&
+				openavbTimeTimespecCmp(&inflight->heap[child + 1]->timer, &inflight->heap[child]->timer) < 0) {
+			child++;
+		}
+		if (openavbTimeTimespecCmp(&pInflight->timer, &inflight->heap[child]->timer) <= 0) {
+			break;
+		}
+		inflightHeapSet(inflight, idx, inflight->heap[child]);
+		idx = child;
+	}
+	inflightHeapSet(inflight, idx, pInflight);
+}
+
+static void inflightSetTimer(openavb_acmp_InflightCommand_t *pInflight, U32 timeoutMSec)
+{
+	CLOCK_GETTIME(OPENAVB_CLOCK_MONOTONIC, &pInflight->timer);
+	openavbTimeTimespecAddUsec(&pInflight->timer, timeoutMSec * MICROSECONDS_PER_MSEC);
+}
+
+openavb_acmp_inflight_t openavbAcmpInflightNew(void)
+{
+	return calloc(1, sizeof(struct openavb_acmp_inflight));
+}
+
+void openavbAcmpInflightDelete(openavb_acmp_inflight_t inflight)
+{
+	if (inflight) {
+		U32 i;
+		for (i = 0; i < inflight->count; i++) {
+			free(inflight->heap[i]);
+		}
+		free(inflight->heap);
+		free(inflight);
+	}
+}
+
+openavb_acmp_InflightCommand_t *openavbAcmpInflightAdd(openavb_acmp_inflight_t inflight, openavb_acmp_ACMPCommandResponse_t *command, U32 timeoutMSec)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_ACMP);
+
+	if (!inflight || !command) {
+		AVB_TRACE_EXIT(AVB_TRACE_ACMP);
+		return NULL;
+	}
+
+	if (inflight->count == inflight->size) {
+		U32 size = inflight->size ? inflight->size * 2 : 16;
+		openavb_acmp_InflightCommand_t **heap = realloc(inflight->heap, size * sizeof(*heap));
+		if (!heap) {
+			AVB_LOG_ERROR("Unable to grow inflight command heap");
+			AVB_TRACE_EXIT(AVB_TRACE_ACMP);
+			return NULL;
+		}
+		inflight->heap = heap;
+		inflight->size = size;
+	}
+
+	openavb_acmp_InflightCommand_t *pInflight = calloc(1, sizeof(*pInflight));
+	if (!pInflight) {
+		AVB_TRACE_EXIT(AVB_TRACE_ACMP);
+		return NULL;
+	}
+	memcpy(&pInflight->command, command, sizeof(pInflight->command));
+	inflightSetTimer(pInflight, timeoutMSec);
+
+	U32 bucket = INFLIGHT_BUCKET(command->sequence_id);
+	pInflight->next = inflight->bucket[bucket];
+	inflight->bucket[bucket] = pInflight;
+
+	inflight->heap[inflight->count] = pInflight;
+	inflightSiftUp(inflight, inflight->count++);
+
+	AVB_TRACE_EXIT(AVB_TRACE_ACMP);
+	return pInflight;
+}
+
+void openavbAcmpInflightRestart(openavb_acmp_inflight_t inflight, openavb_acmp_InflightCommand_t *pInflight, U32 timeoutMSec)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_ACMP);
+
+	if (inflight && pInflight) {
+		struct timespec previous = pInflight->timer;
+		inflightSetTimer(pInflight, timeoutMSec);
+		if (openavbTimeTimespecCmp(&pInflight->timer, &previous) < 0) {
+			inflightSiftUp(inflight, pInflight->heapIdx);
+		}
+		else {
+			inflightSiftDown(inflight, pInflight->heapIdx);
+		}
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_ACMP);
+}
+
+void openavbAcmpInflightRemove(openavb_acmp_inflight_t inflight, openavb_acmp_InflightCommand_t *pInflight)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_ACMP);
+
+	if (!inflight || !pInflight) {
+		AVB_TRACE_EXIT(AVB_TRACE_ACMP);
+		return;
+	}
+
+	// Unlink from the sequence_id bucket
+	openavb_acmp_InflightCommand_t **ppLink = &inflight->bucket[INFLIGHT_BUCKET(pInflight->command.sequence_id)];
+	while (*ppLink && *ppLink != pInflight) {
+		ppLink = &(*ppLink)->next;
+	}
+	if (*ppLink) {
+		*ppLink = pInflight->next;
+	}
+
+	// Replace with the last heap entry and restore the heap order
+	U32 idx = pInflight->heapIdx;
+	if (idx < inflight->count && inflight->heap[idx] == pInflight) {
+		openavb_acmp_InflightCommand_t *pLast = inflight->heap[--inflight->count];
+		if (idx < inflight->count) {
+			inflightHeapSet(inflight, idx, pLast);
+			if (idx > 0 && openavbTimeTimespecCmp(&pLast->timer, &inflight->heap[(idx - 1) / 2]->timer) < 0) {
+				inflightSiftUp(inflight, idx);
+			}
+			else {
+				inflightSiftDown(inflight, idx);
+			}
+		}
+	}
+
+	free(pInflight);
+
+	AVB_TRACE_EXIT(AVB_TRACE_ACMP);
+}
+
+openavb_acmp_InflightCommand_t *openavbAcmpInflightFirst(openavb_acmp_inflight_t inflight, U16 sequence_id)
+{
+	if (!inflight) {
+		return NULL;
+	}
+
+	openavb_acmp_InflightCommand_t *pInflight = inflight->bucket[INFLIGHT_BUCKET(sequence_id)];
+	while (pInflight && pInflight->command.sequence_id != sequence_id) {
+		pInflight = pInflight->next;
+	}
+	return pInflight;
+}
+
+openavb_acmp_InflightCommand_t *openavbAcmpInflightNext(openavb_acmp_InflightCommand_t *pInflight)
+{
+	if (!pInflight) {
+		return NULL;
+	}
+
+	U16 sequence_id = pInflight->command.sequence_id;
+	pInflight = pInflight->next;
+	while (pInflight && pInflight->command.sequence_id != sequence_id) {
+		pInflight = pInflight->next;
+	}
+	return pInflight;
+}
+
+openavb_acmp_InflightCommand_t *openavbAcmpInflightExpired(openavb_acmp_inflight_t inflight)
+{
+	if (!inflight || inflight->count == 0) {
+		return NULL;
+	}
+
+	struct timespec now;
+	CLOCK_GETTIME(OPENAVB_CLOCK_MONOTONIC, &now);
+	if (openavbTimeTimespecCmp(&now, &inflight->heap[0]->timer) >= 0) {
+		return inflight->heap[0];
+	}
+	return NULL;
+}
+
+U32 openavbAcmpInflightWaitMSec(openavb_acmp_inflight_t inflight, U32 maxMSec)
+{
+	if (!inflight || inflight->count == 0) {
+		return maxMSec;
+	}
+
+	struct timespec now;
+	CLOCK_GETTIME(OPENAVB_CLOCK_MONOTONIC, &now);
+	U64 waitUSec = openavbTimeUntilUSec(&now, &inflight->heap[0]->timer);
+
+	// Round up so the wait does not end just before the timer expires
+	U64 waitMSec = (waitUSec + MICROSECONDS_PER_MSEC - 1) / MICROSECONDS_PER_MSEC;
+	return waitMSec < maxMSec ? (U32)waitMSec : maxMSec;
+}
+
+U32 openavbAcmpInflightCount(openavb_acmp_inflight_t inflight)
+{
+	return inflight ? inflight->count : 0;
+}
+
+
+static U32 listenerPairsHash(openavb_acmp_listener_pairs_t pairs, U8 listener_entity_id[8], U16 listener_unique_id)
+{
+	// FNV-1a
+	U32 hash = 2166136261u;
+	int i;
+	for (i = 0; i < 8; i++) {
+		hash = (hash ^ listener_entity_id[i]) * 16777619u;
+	}
+	hash = (hash ^ (listener_unique_id & 0xFF)) * 16777619u;
+	hash = (hash ^ (listener_unique_id >> 8)) * 16777619u;
+	return hash & (pairs->size - 1);
+}
+
+static void listenerPairsLink(openavb_acmp_listener_pairs_t pairs, U32 idx)
+{
+	U32 bucket = listenerPairsHash(pairs, pairs->pair[idx].listener_entity_id, pairs->pair[idx].listener_unique_id);
+	pairs->next[idx] = pairs->bucket[bucket];
+	pairs->bucket[bucket] = idx;
+}
+
+static void listenerPairsRehash(openavb_acmp_listener_pairs_t pairs)
+{
+	memset(pairs->bucket, 0xFF, pairs->size * sizeof(*pairs->bucket));
+	U32 idx;
+	for (idx = 0; idx < pairs->count; idx++) {
+		listenerPairsLink(pairs, idx);
+	}
+}
+
+static bool listenerPairsGrow(openavb_acmp_listener_pairs_t pairs)
+{
+	U32 size = pairs->size ? pairs->size * 2 : LISTENER_PAIRS_MIN_SIZE;
+
+	openavb_acmp_ListenerPair_t *pair = realloc(pairs->pair, size * sizeof(*pair));
+	if (!pair) {
+		return FALSE;
+	}
+	pairs->pair = pair;
+
+	U32 *next = realloc(pairs->next, size * sizeof(*next));
+	if (!next) {
+		return FALSE;
+	}
+	pairs->next = next;
+
+	U32 *bucket = malloc(size * sizeof(*bucket));
+	if (!bucket) {
+		return FALSE;
+	}
+	free(pairs->bucket);
+	pairs->bucket = bucket;
+	pairs->size = size;
+
+	// Rehash into the new buckets
+	listenerPairsRehash(pairs);
+	return TRUE;
+}
+
+openavb_acmp_listener_pairs_t openavbAcmpListenerPairsNew(void)
+{
+	return calloc(1, sizeof(struct openavb_acmp_listener_pairs));
+}
+
+void openavbAcmpListenerPairsDelete(openavb_acmp_listener_pairs_t pairs)
+{
+	if (pairs) {
+		free(pairs->pair);
+		free(pairs->next);
+		free(pairs->bucket);
+		free(pairs);
+	}
+}
+
+openavb_acmp_ListenerPair_t *openavbAcmpListenerPairsAdd(openavb_acmp_listener_pairs_t pairs, U8 listener_entity_id[8], U16 listener_unique_id)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_ACMP);
+
+	if (!pairs) {
+		AVB_TRACE_EXIT(AVB_TRACE_ACMP);
+		return NULL;
+	}
+	if (pairs->count == pairs->size && !listenerPairsGrow(pairs)) {
+		AVB_LOG_ERROR("Unable to grow connected listener index");
+		AVB_TRACE_EXIT(AVB_TRACE_ACMP);
+		return NULL;
+	}
+
+	U32 idx = pairs->count++;
+	memcpy(pairs->pair[idx].listener_entity_id, listener_entity_id, sizeof(pairs->pair[idx].listener_entity_id));
+	pairs->pair[idx].listener_unique_id = listener_unique_id;
+	listenerPairsLink(pairs, idx);
+
+	AVB_TRACE_EXIT(AVB_TRACE_ACMP);
+	return &pairs->pair[idx];
+}
+
+openavb_acmp_ListenerPair_t *openavbAcmpListenerPairsFind(openavb_acmp_listener_pairs_t pairs, U8 listener_entity_id[8], U16 listener_unique_id)
+{
+	if (!pairs || pairs->count == 0) {
+		return NULL;
+	}
+
+	U32 idx = pairs->bucket[listenerPairsHash(pairs, listener_entity_id, listener_unique_id)];
+	while (idx != LISTENER_PAIRS_NONE) {
+		openavb_acmp_ListenerPair_t *pPair = &pairs->pair[idx];
+		if (pPair->listener_unique_id == listener_unique_id &&
+				memcmp(pPair->listener_entity_id, listener_entity_id, sizeof(pPair->listener_entity_id)) == 0) {
+			return pPair;
+		}
+		idx = pairs->next[idx];
+	}
+	return NULL;
+}
+
+openavb_acmp_ListenerPair_t *openavbAcmpListenerPairsAt(openavb_acmp_listener_pairs_t pairs, U32 idx)
+{
+	if (!pairs || idx >= pairs->count) {
+		return NULL;
+	}
+	return &pairs->pair[idx];
+}
+
+void openavbAcmpListenerPairsRemove(openavb_acmp_listener_pairs_t pairs, openavb_acmp_ListenerPair_t *pPair)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_ACMP);
+
+	if (!pairs || !pPair || pPair < pairs->pair || pPair >= pairs->pair + pairs->count) {
+		AVB_TRACE_EXIT(AVB_TRACE_ACMP);
+		return;
+	}
+
+	// Close the gap so the listeners after it keep their order; their
+	// connection indexes all change, so rehash them
+	U32 idx = pPair - pairs->pair;
+	memmove(&pairs->pair[idx], &pairs->pair[idx + 1], (pairs->count - idx - 1) * sizeof(*pairs->pair));
+	pairs->count--;
+	listenerPairsRehash(pairs);
+
+	AVB_TRACE_EXIT(AVB_TRACE_ACMP);
+}
+
+U32 openavbAcmpListenerPairsCount(openavb_acmp_listener_pairs_t pairs)
+{
+	return pairs ? pairs->count : 0;
+}
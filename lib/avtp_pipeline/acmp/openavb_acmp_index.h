@@ -0,0 +1,114 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+ ******************************************************************
+ * MODULE : ACMP - AVDECC Connection Management Protocol : Keyed Indexes
+ * MODULE SUMMARY : Interface for the inflight command table and the connected listener index
+ * used by the ACMP state machines.
+ *
+ * Inflight commands (IEEE Std 1722.1-2013 clause 8.2.2.2.5) are hashed on
+ * sequence_id and kept in a min-heap ordered by their timeout, so matching a
+ * response, finding the next timeout and finding an expired command do not
+ * scan all inflight commands. Timeouts use OPENAVB_CLOCK_MONOTONIC, so a step
+ * of the wall clock neither fires nor delays them.
+ *
+ * A talker's connected listeners (clause 8.2.2.2.3) are kept in an array
+ * addressed by connection index, for GET_TX_CONNECTION, with a hash on
+ * listener_entity_id and listener_unique_id for CONNECT_TX and DISCONNECT_TX.
+ * Removing a listener moves the listeners after it down one index, so
+ * connection indexes keep the order in which listeners connected.
+ *
+ * Neither is thread safe; the owning state machine's lock protects them.
+ ******************************************************************
+ */
+
+#ifndef OPENAVB_ACMP_INDEX_H
+#define OPENAVB_ACMP_INDEX_H 1
+
+#include "openavb_acmp.h"
+
+// Sequence id hash buckets of an inflight table. Power of 2.
+#define OPENAVB_ACMP_INFLIGHT_BUCKETS	1024
+
+// Create an inflight table. Returns NULL on failure.
+openavb_acmp_inflight_t openavbAcmpInflightNew(void);
+
+// Delete an inflight table and all commands in it.
+void openavbAcmpInflightDelete(openavb_acmp_inflight_t inflight);
+
+// Add a copy of command that times out timeoutMSec from now. The caller fills
+// in the remaining fields of the returned entry. Returns NULL on failure.
+openavb_acmp_InflightCommand_t *openavbAcmpInflightAdd(openavb_acmp_inflight_t inflight, openavb_acmp_ACMPCommandResponse_t *command, U32 timeoutMSec);
+
+// Restart the timer of an inflight command to expire timeoutMSec from now.
+void openavbAcmpInflightRestart(openavb_acmp_inflight_t inflight, openavb_acmp_InflightCommand_t *pInflight, U32 timeoutMSec);
+
+// Remove and free an inflight command.
+void openavbAcmpInflightRemove(openavb_acmp_inflight_t inflight, openavb_acmp_InflightCommand_t *pInflight);
+
+// First and next inflight command with the given sequence_id, NULL at the end.
+// The caller matches the remaining fields.
+openavb_acmp_InflightCommand_t *openavbAcmpInflightFirst(openavb_acmp_inflight_t inflight, U16 sequence_id);
+openavb_acmp_InflightCommand_t *openavbAcmpInflightNext(openavb_acmp_InflightCommand_t *pInflight);
+
+// Inflight command whose timer expired, soonest first. NULL if none.
+openavb_acmp_InflightCommand_t *openavbAcmpInflightExpired(openavb_acmp_inflight_t inflight);
+
+// Milliseconds until the soonest timer expires, rounded up, at most maxMSec.
+U32 openavbAcmpInflightWaitMSec(openavb_acmp_inflight_t inflight, U32 maxMSec);
+
+// Number of inflight commands.
+U32 openavbAcmpInflightCount(openavb_acmp_inflight_t inflight);
+
+
+// Create a connected listener index. Returns NULL on failure.
+openavb_acmp_listener_pairs_t openavbAcmpListenerPairsNew(void);
+
+// Delete a connected listener index.
+void openavbAcmpListenerPairsDelete(openavb_acmp_listener_pairs_t pairs);
+
+// Add a listener. Returns NULL on failure. Does not check for duplicates.
+openavb_acmp_ListenerPair_t *openavbAcmpListenerPairsAdd(openavb_acmp_listener_pairs_t pairs, U8 listener_entity_id[8], U16 listener_unique_id);
+
+// Find a listener. Returns NULL if it is not connected or pairs is NULL.
+openavb_acmp_ListenerPair_t *openavbAcmpListenerPairsFind(openavb_acmp_listener_pairs_t pairs, U8 listener_entity_id[8], U16 listener_unique_id);
+
+// Listener at connection index idx. Returns NULL past the end or if pairs is NULL.
+openavb_acmp_ListenerPair_t *openavbAcmpListenerPairsAt(openavb_acmp_listener_pairs_t pairs, U32 idx);
+
+// Remove a listener returned by Add, Find or At.
+void openavbAcmpListenerPairsRemove(openavb_acmp_listener_pairs_t pairs, openavb_acmp_ListenerPair_t *pPair);
+
+// Number of connected listeners. 0 if pairs is NULL.
+U32 openavbAcmpListenerPairsCount(openavb_acmp_listener_pairs_t pairs);
+
+#endif // OPENAVB_ACMP_INDEX_H
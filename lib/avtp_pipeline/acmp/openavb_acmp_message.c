@@ -47,6 +47,7 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 
 #include "openavb_debug.h"
 #include "openavb_rawsock.h"
+#include "openavb_avdecc_engine.h"
 #include "openavb_avtp.h"
 #include "openavb_srp.h"
 #include "openavb_acmp.h"
@@ -89,10 +90,21 @@ THREAD_DEFINITON(openavbAcmpMessageRxThread);
 
 static bool bRunning = FALSE;
 
+// Using the AVDECC engine's socket rather than our own
+static bool bEngine = FALSE;
+
 void openavbAcmpCloseSocket()
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_ACMP);
 
+	if (bEngine) {
+		// The socket belongs to the engine
+		txSock = NULL;
+		bEngine = FALSE;
+		AVB_TRACE_EXIT(AVB_TRACE_ACMP);
+		return;
+	}
+
 	if (rxSock) {
 		openavbRawsockClose(rxSock);
 		rxSock = NULL;
@@ -111,6 +123,21 @@ bool openavbAcmpOpenSocket(const char* ifname, U16 vlanID, U8 vlanPCP)
 
 	hdr_info_t hdr;
 
+	if (openavbAvdeccEngineIsRunning()) {
+		// Send on the AVDECC engine's socket. It receives for us as well.
+		bEngine = TRUE;
+		txSock = openavbAvdeccEngineTxSock();
+		if (txSock && openavbAvdeccEngineGetAddr(ADDR_PTR(&intfAddr))) {
+			AVB_TRACE_EXIT(AVB_TRACE_ACMP);
+			return true;
+		}
+
+		AVB_LOG_ERROR("AVDECC engine socket not available");
+		openavbAcmpCloseSocket();
+		AVB_TRACE_EXIT(AVB_TRACE_ACMP);
+		return false;
+	}
+
 	rxSock = openavbRawsockOpen(ifname, TRUE, FALSE, ETHERTYPE_AVTP, ACMP_FRAME_LEN, ACMP_NUM_RX_BUFFERS);
 	txSock = openavbRawsockOpen(ifname, FALSE, TRUE, ETHERTYPE_AVTP, ACMP_FRAME_LEN, ACMP_NUM_TX_BUFFERS);
 
@@ -302,10 +329,12 @@ void openavbAcmpMessageTxFrame(U8 messageType, openavb_acmp_ACMPCommandResponse_
 	U32 size;
 	unsigned int hdrlen = 0;
 
+	openavbAvdeccEngineTxLock();
 	pBuf = openavbRawsockGetTxFrame(txSock, TRUE, &size);
 
 	if (!pBuf) {
 		AVB_LOG_ERROR("No TX buffer");
+		openavbAvdeccEngineTxUnlock();
 		AVB_TRACE_EXIT(AVB_TRACE_ACMP);
 		return;		// AVDECC_TODO - return error result
 	}
@@ -313,6 +342,7 @@ void openavbAcmpMessageTxFrame(U8 messageType, openavb_acmp_ACMPCommandResponse_
 	if (size < ACMP_FRAME_LEN) {
 		AVB_LOG_ERROR("TX buffer too small");
 		openavbRawsockRelTxFrame(txSock, pBuf);
+		openavbAvdeccEngineTxUnlock();
 		pBuf = NULL;
 		AVB_TRACE_EXIT(AVB_TRACE_ACMP);
 		return;		// AVDECC_TODO - return error result
@@ -358,10 +388,16 @@ void openavbAcmpMessageTxFrame(U8 messageType, openavb_acmp_ACMPCommandResponse_
 
 	openavbRawsockTxFrameReady(txSock, pBuf, hdrlen + AVTP_HDR_LEN + ACMP_DATA_LEN, 0);
 	openavbRawsockSend(txSock);
+	openavbAvdeccEngineTxUnlock();
 
 	AVB_TRACE_EXIT(AVB_TRACE_ACMP);
 }
 
+static void openavbAcmpMessageRxEngineCb(void *pv, U8 *payload, int payload_len, hdr_info_t *hdr)
+{
+	openavbAcmpMessageRxFrameParse(payload, payload_len, hdr);
+}
+
 void* openavbAcmpMessageRxThreadFn(void *pv)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_ACMP);
@@ -385,6 +421,16 @@ openavbRC openavbAcmpMessageHandlerStart()
 
 	if (openavbAcmpOpenSocket((const char *)gAvdeccCfg.ifname, gAvdeccCfg.vlanID, gAvdeccCfg.vlanPCP)) {
 
+		if (bEngine) {
+			// No RX thread; the engine hands us our PDUs
+			if (!openavbAvdeccEngineRegister(OPENAVB_ACMP_AVTP_SUBTYPE, openavbAcmpMessageRxEngineCb, NULL)) {
+				bRunning = FALSE;
+				openavbAcmpCloseSocket();
+				AVB_RC_TRACE_RET(OPENAVB_AVDECC_FAILURE, AVB_TRACE_ACMP);
+			}
+			AVB_RC_TRACE_RET(OPENAVB_AVDECC_SUCCESS, AVB_TRACE_ACMP);
+		}
+
 		// Start the RX thread
 		bool errResult;
 		THREAD_CREATE(openavbAcmpMessageRxThread, openavbAcmpMessageRxThread, NULL, openavbAcmpMessageRxThreadFn, NULL);
@@ -408,7 +454,12 @@ void openavbAcmpMessageHandlerStop()
 
 	if (bRunning) {
 		bRunning = FALSE;
-		THREAD_JOIN(openavbAcmpMessageRxThread, NULL);
+		if (bEngine) {
+			openavbAvdeccEngineUnregister(OPENAVB_ACMP_AVTP_SUBTYPE, openavbAcmpMessageRxEngineCb, NULL);
+		}
+		else {
+			THREAD_JOIN(openavbAcmpMessageRxThread, NULL);
+		}
 		openavbAcmpCloseSocket();
 	}
 
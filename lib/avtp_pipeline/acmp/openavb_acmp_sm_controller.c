@@ -43,8 +43,10 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #include "openavb_debug.h"
 #include "openavb_time.h"
 #include "openavb_acmp_sm_controller.h"
+#include "openavb_acmp_index.h"
 #include "openavb_acmp_message.h"
 #include "openavb_avdecc_pipeline_interaction_pub.h"
+#include "openavb_avdecc_engine.h"
 
 typedef enum {
 	OPENAVB_ACMP_SM_CONTROLLER_STATE_WAITING,
@@ -67,106 +69,68 @@ static MUTEX_HANDLE(openavbAcmpSMControllerMutex);
 #define ACMP_SM_LOCK() { MUTEX_CREATE_ERR(); MUTEX_LOCK(openavbAcmpSMControllerMutex); MUTEX_LOG_ERR("Mutex lock failure"); }
 #define ACMP_SM_UNLOCK() { MUTEX_CREATE_ERR(); MUTEX_UNLOCK(openavbAcmpSMControllerMutex); MUTEX_LOG_ERR("Mutex unlock failure"); }
 
-SEM_T(openavbAcmpSMControllerSemaphore);
+openavb_avdecc_task_t openavbAcmpSMControllerTask;
 THREAD_TYPE(openavbAcmpSmControllerThread);
 THREAD_DEFINITON(openavbAcmpSmControllerThread);
 
 
-static openavb_list_node_t openavbAcmpSMController_findInflightNodeFromCommand(openavb_acmp_ACMPCommandResponse_t *command)
+static openavb_acmp_InflightCommand_t *openavbAcmpSMController_findInflightFromCommand(openavb_acmp_ACMPCommandResponse_t *command)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_ACMP);
 
-	openavb_list_node_t node = openavbListIterFirst(openavbAcmpSMControllerVars.inflight);
-	while (node) {
-		openavb_acmp_InflightCommand_t *pInFlightCommand = openavbListData(node);
-		if (pInFlightCommand) {
-			if (memcmp(pInFlightCommand->command.controller_entity_id, command->controller_entity_id, sizeof(pInFlightCommand->command.controller_entity_id)) == 0 &&
-					pInFlightCommand->command.sequence_id == command->sequence_id) {
-				break;
-			}
+	openavb_acmp_InflightCommand_t *pInFlightCommand = openavbAcmpInflightFirst(openavbAcmpSMControllerVars.inflight, command->sequence_id);
+	while (pInFlightCommand) {
+		if (memcmp(pInFlightCommand->command.controller_entity_id, command->controller_entity_id, sizeof(pInFlightCommand->command.controller_entity_id)) == 0) {
+			break;
 		}
-		node = openavbListIterNext(openavbAcmpSMControllerVars.inflight);
+		pInFlightCommand = openavbAcmpInflightNext(pInFlightCommand);
 	}
 
 	AVB_TRACE_EXIT(AVB_TRACE_ACMP);
-	return node;
+	return pInFlightCommand;
+}
+
+static U32 openavbAcmpSMController_commandTimeoutMSec(U8 messageType)
+{
+	switch (messageType) {
+		case OPENAVB_ACMP_MESSAGE_TYPE_GET_TX_STATE_RESPONSE:
+			return OPENAVB_ACMP_COMMAND_TIMEOUT_GET_TX_STATE_COMMAND;
+		case OPENAVB_ACMP_MESSAGE_TYPE_CONNECT_RX_RESPONSE:
+			return OPENAVB_ACMP_COMMAND_TIMEOUT_CONNECT_RX_COMMAND;
+		case OPENAVB_ACMP_MESSAGE_TYPE_DISCONNECT_RX_RESPONSE:
+			return OPENAVB_ACMP_COMMAND_TIMEOUT_DISCONNECT_RX_COMMAND;
+		case OPENAVB_ACMP_MESSAGE_TYPE_GET_RX_STATE_RESPONSE:
+			return OPENAVB_ACMP_COMMAND_TIMEOUT_GET_RX_STATE_COMMAND;
+		case OPENAVB_ACMP_MESSAGE_TYPE_GET_TX_CONNECTION_RESPONSE:
+			return OPENAVB_ACMP_COMMAND_TIMEOUT_GET_TX_CONNECTION_COMMAND;
+		default:
+			AVB_LOGF_ERROR("Unsupported command %u in openavbAcmpSMController_txCommand", messageType);
+			return OPENAVB_ACMP_COMMAND_TIMEOUT_CONNECT_RX_COMMAND;
+	}
 }
 
 
 void openavbAcmpSMController_txCommand(U8 messageType, openavb_acmp_ACMPCommandResponse_t *command, bool retry)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_ACMP);
-	openavb_list_node_t node = NULL;
+	openavb_acmp_InflightCommand_t *pInFlightCommand = NULL;
 
 	openavbRC rc = openavbAcmpMessageSend(messageType, command, OPENAVB_ACMP_STATUS_SUCCESS);
 	if (IS_OPENAVB_SUCCESS(rc)) {
 		if (!retry) {
-			node = openavbListNew(openavbAcmpSMControllerVars.inflight, sizeof(openavb_acmp_InflightCommand_t));
-			if (node) {
-				openavb_acmp_InflightCommand_t *pInFlightCommand = openavbListData(node);
-				if (pInFlightCommand) {
-
-					memcpy(&pInFlightCommand->command, command, sizeof(pInFlightCommand->command));
-					pInFlightCommand->command.message_type = messageType;
-					pInFlightCommand->retried = FALSE;
-					pInFlightCommand->original_sequence_id = command->sequence_id;	// AVDECC_TODO - is this correct?
-
-					CLOCK_GETTIME(OPENAVB_CLOCK_REALTIME, &pInFlightCommand->timer);
-					switch (messageType) {
-						case OPENAVB_ACMP_MESSAGE_TYPE_GET_TX_STATE_RESPONSE:
-							openavbTimeTimespecAddUsec(&pInFlightCommand->timer, OPENAVB_ACMP_COMMAND_TIMEOUT_GET_TX_STATE_COMMAND * MICROSECONDS_PER_MSEC);
-							break;
-						case OPENAVB_ACMP_MESSAGE_TYPE_CONNECT_RX_RESPONSE:
-							openavbTimeTimespecAddUsec(&pInFlightCommand->timer, OPENAVB_ACMP_COMMAND_TIMEOUT_CONNECT_RX_COMMAND * MICROSECONDS_PER_MSEC);
-							break;
-						case OPENAVB_ACMP_MESSAGE_TYPE_DISCONNECT_RX_RESPONSE:
-							openavbTimeTimespecAddUsec(&pInFlightCommand->timer, OPENAVB_ACMP_COMMAND_TIMEOUT_DISCONNECT_RX_COMMAND * MICROSECONDS_PER_MSEC);
-							break;
-						case OPENAVB_ACMP_MESSAGE_TYPE_GET_RX_STATE_RESPONSE:
-							openavbTimeTimespecAddUsec(&pInFlightCommand->timer, OPENAVB_ACMP_COMMAND_TIMEOUT_GET_RX_STATE_COMMAND * MICROSECONDS_PER_MSEC);
-							break;
-						case OPENAVB_ACMP_MESSAGE_TYPE_GET_TX_CONNECTION_RESPONSE:
-							openavbTimeTimespecAddUsec(&pInFlightCommand->timer, OPENAVB_ACMP_COMMAND_TIMEOUT_GET_TX_CONNECTION_COMMAND * MICROSECONDS_PER_MSEC);
-							break;
-						default:
-							AVB_LOGF_ERROR("Unsupported command %u in openavbAcmpSMController_txCommand", messageType);
-							openavbTimeTimespecAddUsec(&pInFlightCommand->timer, OPENAVB_ACMP_COMMAND_TIMEOUT_CONNECT_RX_COMMAND * MICROSECONDS_PER_MSEC);
-							break;
-					}
-				}
+			pInFlightCommand = openavbAcmpInflightAdd(openavbAcmpSMControllerVars.inflight, command, openavbAcmpSMController_commandTimeoutMSec(messageType));
+			if (pInFlightCommand) {
+				pInFlightCommand->command.message_type = messageType;
+				pInFlightCommand->retried = FALSE;
+				pInFlightCommand->original_sequence_id = command->sequence_id;	// AVDECC_TODO - is this correct?
 			}
 		}
 		else {
 			// Retry case
-			node = openavbAcmpSMController_findInflightNodeFromCommand(command);
-			if (node) {
-				openavb_acmp_InflightCommand_t *pInFlightCommand = openavbListData(node);
-				if (pInFlightCommand) {
-					pInFlightCommand->retried = TRUE;
-
-					CLOCK_GETTIME(OPENAVB_CLOCK_REALTIME, &pInFlightCommand->timer);
-					switch (messageType) {
-						case OPENAVB_ACMP_MESSAGE_TYPE_GET_TX_STATE_RESPONSE:
-							openavbTimeTimespecAddUsec(&pInFlightCommand->timer, OPENAVB_ACMP_COMMAND_TIMEOUT_GET_TX_STATE_COMMAND * MICROSECONDS_PER_MSEC);
-							break;
-						case OPENAVB_ACMP_MESSAGE_TYPE_CONNECT_RX_RESPONSE:
-							openavbTimeTimespecAddUsec(&pInFlightCommand->timer, OPENAVB_ACMP_COMMAND_TIMEOUT_CONNECT_RX_COMMAND * MICROSECONDS_PER_MSEC);
-							break;
-						case OPENAVB_ACMP_MESSAGE_TYPE_DISCONNECT_RX_RESPONSE:
-							openavbTimeTimespecAddUsec(&pInFlightCommand->timer, OPENAVB_ACMP_COMMAND_TIMEOUT_DISCONNECT_RX_COMMAND * MICROSECONDS_PER_MSEC);
-							break;
-						case OPENAVB_ACMP_MESSAGE_TYPE_GET_RX_STATE_RESPONSE:
-							openavbTimeTimespecAddUsec(&pInFlightCommand->timer, OPENAVB_ACMP_COMMAND_TIMEOUT_GET_RX_STATE_COMMAND * MICROSECONDS_PER_MSEC);
-							break;
-						case OPENAVB_ACMP_MESSAGE_TYPE_GET_TX_CONNECTION_RESPONSE:
-							openavbTimeTimespecAddUsec(&pInFlightCommand->timer, OPENAVB_ACMP_COMMAND_TIMEOUT_GET_TX_CONNECTION_COMMAND * MICROSECONDS_PER_MSEC);
-							break;
-						default:
-							AVB_LOGF_ERROR("Unsupported command %u in openavbAcmpSMController_txCommand", messageType);
-							openavbTimeTimespecAddUsec(&pInFlightCommand->timer, OPENAVB_ACMP_COMMAND_TIMEOUT_CONNECT_RX_COMMAND * MICROSECONDS_PER_MSEC);
-							break;
-					}
-				}
+			pInFlightCommand = openavbAcmpSMController_findInflightFromCommand(command);
+			if (pInFlightCommand) {
+				pInFlightCommand->retried = TRUE;
+				openavbAcmpInflightRestart(openavbAcmpSMControllerVars.inflight, pInFlightCommand, openavbAcmpSMController_commandTimeoutMSec(messageType));
 			}
 		}
 	}
@@ -174,9 +138,9 @@ void openavbAcmpSMController_txCommand(U8 messageType, openavb_acmp_ACMPCommandR
 		// Failed to send command
 		openavbAcmpMessageSend(messageType, command, OPENAVB_ACMP_STATUS_COULD_NOT_SEND_MESSAGE);
 		if (retry) {
-			node = openavbAcmpSMController_findInflightNodeFromCommand(command);
-			if (node) {
-				openavbListDelete(openavbAcmpSMControllerVars.inflight, node);
+			pInFlightCommand = openavbAcmpSMController_findInflightFromCommand(command);
+			if (pInFlightCommand) {
+				openavbAcmpInflightRemove(openavbAcmpSMControllerVars.inflight, pInFlightCommand);
 			}
 		}
 	}
@@ -195,9 +159,9 @@ void openavbAcmpSMController_removeInflight(openavb_acmp_ACMPCommandResponse_t *
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_ACMP);
 
-	openavb_list_node_t node = openavbAcmpSMController_findInflightNodeFromCommand(commandResponse);
-	if (node) {
-		openavbListDelete(openavbAcmpSMControllerVars.inflight, node);
+	openavb_acmp_InflightCommand_t *pInFlightCommand = openavbAcmpSMController_findInflightFromCommand(commandResponse);
+	if (pInFlightCommand) {
+		openavbAcmpInflightRemove(openavbAcmpSMControllerVars.inflight, pInFlightCommand);
 	}
 
 	AVB_TRACE_EXIT(AVB_TRACE_ACMP);
@@ -222,6 +186,8 @@ void openavbAcmpSMControllerStateMachine()
 	AVB_TRACE_ENTRY(AVB_TRACE_ACMP);
 
 	openavb_acmp_InflightCommand_t *pInflightActive = NULL;		// The inflight command for the current state
+	// The engine re-enters the state machine in the state it yielded from
+	bool bResume = openavbAvdeccTaskResumed(&openavbAcmpSMControllerTask);
 	openavb_acmp_sm_controller_state_t state = OPENAVB_ACMP_SM_CONTROLLER_STATE_WAITING;
 
 	// Lock such that the mutex is held unless waiting for a semaphore. Synchronous processing of command responses.
@@ -230,52 +196,32 @@ void openavbAcmpSMControllerStateMachine()
 		switch (state) {
 			case OPENAVB_ACMP_SM_CONTROLLER_STATE_WAITING:
 				AVB_TRACE_LINE(AVB_TRACE_ACMP);
-				AVB_LOG_DEBUG("State:  OPENAVB_ACMP_SM_CONTROLLER_STATE_WAITING");
-
-				openavbAcmpSMControllerVars.rcvdResponse = FALSE;
-
-				// Calculate timeout for inflight commands
-				// Start is a arbitrary large time out.
-				struct timespec timeout;
-				CLOCK_GETTIME(OPENAVB_CLOCK_REALTIME, &timeout);
-				timeout.tv_sec += 60;	// At most will timeout after 60 seconds
-
-				// Look for soonest inflight command timeout
-				openavb_list_node_t node = openavbListIterFirst(openavbAcmpSMControllerVars.inflight);
-				while (node) {
-					openavb_acmp_InflightCommand_t *pInflight = openavbListData(node);
-					if ((openavbTimeTimespecCmp(&pInflight->timer, &timeout) < 0)) {
-						timeout.tv_sec = pInflight->timer.tv_sec;
-						timeout.tv_nsec = pInflight->timer.tv_nsec;
-					}
-					node = openavbListIterNext(openavbAcmpSMControllerVars.inflight);
+
+				if (!bResume) {
+					AVB_LOG_DEBUG("State:  OPENAVB_ACMP_SM_CONTROLLER_STATE_WAITING");
+
+					openavbAcmpSMControllerVars.rcvdResponse = FALSE;
 				}
+				bResume = FALSE;
 
+				// Wait until the soonest inflight command timeout, at most 60 seconds
+				U32 timeoutMSec = openavbAcmpInflightWaitMSec(openavbAcmpSMControllerVars.inflight, 60 * 1000);
 				ACMP_SM_UNLOCK();
-				U32 timeoutMSec = 0;
-				struct timespec now;
-				CLOCK_GETTIME(OPENAVB_CLOCK_REALTIME, &now);
-				timeoutMSec = openavbTimeUntilMSec(&now, &timeout);
-				SEM_ERR_T(err);
-				SEM_TIMEDWAIT(openavbAcmpSMControllerSemaphore, timeoutMSec, err);
+				openavb_avdecc_task_wait_t wait = openavbAvdeccTaskWait(&openavbAcmpSMControllerTask, timeoutMSec);
+				if (wait == OPENAVB_AVDECC_TASK_YIELD) {
+					AVB_TRACE_EXIT(AVB_TRACE_ACMP);
+					return;
+				}
 				ACMP_SM_LOCK();
 
-				if (!SEM_IS_ERR_NONE(err)) {
-					if (SEM_IS_ERR_TIMEOUT(err)) {
-						struct timespec now;
-						CLOCK_GETTIME(OPENAVB_CLOCK_REALTIME, &now);
-
+				if (wait != OPENAVB_AVDECC_TASK_WOKEN) {
+					if (wait == OPENAVB_AVDECC_TASK_TIMEOUT) {
 						// Look for a timed out inflight command
-						openavb_list_node_t node = openavbListIterFirst(openavbAcmpSMControllerVars.inflight);
-						while (node) {
-							openavb_acmp_InflightCommand_t *pInflight = openavbListData(node);
-							if ((openavbTimeTimespecCmp(&now, &pInflight->timer) >= 0)) {
-								// Found a timed out command
-								state = OPENAVB_ACMP_SM_CONTROLLER_STATE_TIMEOUT;
-								pInflightActive = pInflight;
-								break;
-							}
-							node = openavbListIterNext(openavbAcmpSMControllerVars.inflight);
+						openavb_acmp_InflightCommand_t *pInflight = openavbAcmpInflightExpired(openavbAcmpSMControllerVars.inflight);
+						if (pInflight) {
+							// Found a timed out command
+							state = OPENAVB_ACMP_SM_CONTROLLER_STATE_TIMEOUT;
+							pInflightActive = pInflight;
 						}
 					}
 				}
@@ -286,17 +232,15 @@ void openavbAcmpSMControllerStateMachine()
 					else if (openavbAcmpSMControllerVars.rcvdResponse &&
 							memcmp(pRcvdCmdResp->controller_entity_id, openavbAcmpSMGlobalVars.my_id, sizeof(openavbAcmpSMGlobalVars.my_id)) == 0) {
 						// Look for a corresponding inflight command
-						openavb_list_node_t node = openavbListIterFirst(openavbAcmpSMControllerVars.inflight);
-						while (node) {
-							openavb_acmp_InflightCommand_t *pInflight = openavbListData(node);
-							if (pRcvdCmdResp->sequence_id == pInflight->command.sequence_id &&
-									pRcvdCmdResp->message_type == pInflight->command.message_type + 1) {
+						openavb_acmp_InflightCommand_t *pInflight = openavbAcmpInflightFirst(openavbAcmpSMControllerVars.inflight, pRcvdCmdResp->sequence_id);
+						while (pInflight) {
+							if (pRcvdCmdResp->message_type == pInflight->command.message_type + 1) {
 								// Found a corresponding command
 								state = OPENAVB_ACMP_SM_CONTROLLER_STATE_RESPONSE;
 								pInflightActive = pInflight;
 								break;
 							}
-							node = openavbListIterNext(openavbAcmpSMControllerVars.inflight);
+							pInflight = openavbAcmpInflightNext(pInflight);
 						}
 					}
 				break;
@@ -353,9 +297,9 @@ bool openavbAcmpSMControllerStart()
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_ACMP);
 
-	openavbAcmpSMControllerVars.inflight = openavbListNewList();
+	openavbAcmpSMControllerVars.inflight = openavbAcmpInflightNew();
 	if (!openavbAcmpSMControllerVars.inflight) {
-		AVB_LOG_ERROR("Unable to create inflight list. ACMP protocol not started.");
+		AVB_LOG_ERROR("Unable to create inflight table. ACMP protocol not started.");
 		AVB_TRACE_EXIT(AVB_TRACE_ACMP);
 		return FALSE;
 	}
@@ -368,19 +312,19 @@ bool openavbAcmpSMControllerStart()
 	MUTEX_CREATE(openavbAcmpSMControllerMutex, mta);
 	MUTEX_LOG_ERR("Could not create/initialize 'openavbAcmpSMControllerMutex' mutex");
 
-	SEM_ERR_T(err);
-	SEM_INIT(openavbAcmpSMControllerSemaphore, 1, err);
-	SEM_LOG_ERR(err);
+	openavbAvdeccTaskInit(&openavbAcmpSMControllerTask, "ACMP Controller", openavbAcmpSMControllerThreadFn, NULL, 1);
 
 	// Start the State Machine
-	bool errResult;
 	bRunning = TRUE;
-	THREAD_CREATE(openavbAcmpSmControllerThread, openavbAcmpSmControllerThread, NULL, openavbAcmpSMControllerThreadFn, NULL);
-	THREAD_CHECK_ERROR(openavbAcmpSmControllerThread, "Thread / task creation failed", errResult);
-	if (errResult) {
-		bRunning = FALSE;
-		AVB_TRACE_EXIT(AVB_TRACE_ACMP);
-		return FALSE;
+	if (!openavbAvdeccEngineAddTask(&openavbAcmpSMControllerTask)) {
+		bool errResult;
+		THREAD_CREATE(openavbAcmpSmControllerThread, openavbAcmpSmControllerThread, NULL, openavbAcmpSMControllerThreadFn, NULL);
+		THREAD_CHECK_ERROR(openavbAcmpSmControllerThread, "Thread / task creation failed", errResult);
+		if (errResult) {
+			bRunning = FALSE;
+			AVB_TRACE_EXIT(AVB_TRACE_ACMP);
+			return FALSE;
+		}
 	}
 
 	AVB_TRACE_EXIT(AVB_TRACE_ACMP);
@@ -394,14 +338,15 @@ void openavbAcmpSMControllerStop()
 	if (bRunning) {
 		openavbAcmpSMControllerSet_doTerminate(TRUE);
 
-		THREAD_JOIN(openavbAcmpSmControllerThread, NULL);
+		if (!openavbAvdeccEngineRemoveTask(&openavbAcmpSMControllerTask)) {
+			THREAD_JOIN(openavbAcmpSmControllerThread, NULL);
+		}
 	}
 
-	SEM_ERR_T(err);
-	SEM_DESTROY(openavbAcmpSMControllerSemaphore, err);
-	SEM_LOG_ERR(err);
+	openavbAvdeccTaskDestroy(&openavbAcmpSMControllerTask);
 
-	openavbListDeleteList(openavbAcmpSMControllerVars.inflight);
+	openavbAcmpInflightDelete(openavbAcmpSMControllerVars.inflight);
+	openavbAcmpSMControllerVars.inflight = NULL;
 
 	AVB_TRACE_EXIT(AVB_TRACE_ACMP);
 }
@@ -414,9 +359,7 @@ void openavbAcmpSMControllerSet_rcvdResponse(openavb_acmp_ACMPCommandResponse_t
 	memcpy(pRcvdCmdResp, command, sizeof(*command));
 	openavbAcmpSMControllerVars.rcvdResponse = TRUE;
 
-	SEM_ERR_T(err);
-	SEM_POST(openavbAcmpSMControllerSemaphore, err);
-	SEM_LOG_ERR(err);
+	openavbAvdeccTaskSignal(&openavbAcmpSMControllerTask);
 
 	ACMP_SM_UNLOCK();
 	AVB_TRACE_EXIT(AVB_TRACE_ACMP);
@@ -427,9 +370,7 @@ void openavbAcmpSMControllerSet_doTerminate(bool value)
 	AVB_TRACE_ENTRY(AVB_TRACE_ACMP);
 	openavbAcmpSMControllerVars.doTerminate = value;
 
-	SEM_ERR_T(err);
-	SEM_POST(openavbAcmpSMControllerSemaphore, err);
-	SEM_LOG_ERR(err);
+	openavbAvdeccTaskSignal(&openavbAcmpSMControllerTask);
 
 	AVB_TRACE_EXIT(AVB_TRACE_ACMP);
 }
@@ -51,7 +51,9 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #include "openavb_acmp_message.h"
 #include "openavb_acmp_sm_talker.h"
 #include "openavb_acmp_sm_listener.h"
+#include "openavb_acmp_index.h"
 #include "openavb_avdecc_pipeline_interaction_pub.h"
+#include "openavb_avdecc_engine.h"
 #include "openavb_time.h"
 
 typedef enum {
@@ -81,33 +83,39 @@ static MUTEX_HANDLE(openavbAcmpSMListenerMutex);
 #define ACMP_SM_LOCK() { MUTEX_CREATE_ERR(); MUTEX_LOCK(openavbAcmpSMListenerMutex); MUTEX_LOG_ERR("Mutex lock failure"); }
 #define ACMP_SM_UNLOCK() { MUTEX_CREATE_ERR(); MUTEX_UNLOCK(openavbAcmpSMListenerMutex); MUTEX_LOG_ERR("Mutex unlock failure"); }
 
-SEM_T(openavbAcmpSMListenerSemaphore);
+openavb_avdecc_task_t openavbAcmpSMListenerTask;
 THREAD_TYPE(openavbAcmpSmListenerThread);
 THREAD_DEFINITON(openavbAcmpSmListenerThread);
 
-openavb_list_node_t openavbAcmpSMListener_findInflightNodeFromCommand(openavb_acmp_ACMPCommandResponse_t *command)
+static openavb_acmp_InflightCommand_t *openavbAcmpSMListener_findInflightFromCommand(openavb_acmp_ACMPCommandResponse_t *command)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_ACMP);
 
-	openavb_list_node_t node = NULL;
-
-	node = openavbListIterFirst(openavbAcmpSMListenerVars.inflight);
-	while (node) {
-		openavb_acmp_InflightCommand_t *pInFlightCommand = openavbListData(node);
-		if (pInFlightCommand) {
-			if (memcmp(pInFlightCommand->command.talker_entity_id, command->talker_entity_id, sizeof(pInFlightCommand->command.talker_entity_id)) == 0) {
-				if (pInFlightCommand->command.talker_unique_id == command->talker_unique_id ) {
-					if (pInFlightCommand->command.sequence_id == command->sequence_id) {
-						break;
-					}
-				}
+	openavb_acmp_InflightCommand_t *pInFlightCommand = openavbAcmpInflightFirst(openavbAcmpSMListenerVars.inflight, command->sequence_id);
+	while (pInFlightCommand) {
+		if (memcmp(pInFlightCommand->command.talker_entity_id, command->talker_entity_id, sizeof(pInFlightCommand->command.talker_entity_id)) == 0) {
+			if (pInFlightCommand->command.talker_unique_id == command->talker_unique_id ) {
+				break;
 			}
 		}
-		node = openavbListIterNext(openavbAcmpSMListenerVars.inflight);
+		pInFlightCommand = openavbAcmpInflightNext(pInFlightCommand);
 	}
 
 	AVB_TRACE_EXIT(AVB_TRACE_ACMP);
-	return node;
+	return pInFlightCommand;
+}
+
+static U32 openavbAcmpSMListener_commandTimeoutMSec(U8 messageType)
+{
+	switch (messageType) {
+		case OPENAVB_ACMP_MESSAGE_TYPE_CONNECT_TX_COMMAND:
+			return OPENAVB_ACMP_COMMAND_TIMEOUT_CONNECT_TX_COMMAND;
+		case OPENAVB_ACMP_MESSAGE_TYPE_DISCONNECT_TX_COMMAND:
+			return OPENAVB_ACMP_COMMAND_TIMEOUT_DISCONNECT_TX_COMMAND;
+		default:
+			AVB_LOGF_ERROR("Unsupported command %u in openavbAcmpSMListener_txCommand", messageType);
+			return OPENAVB_ACMP_COMMAND_TIMEOUT_CONNECT_RX_COMMAND;
+	}
 }
 
 bool openavbAcmpSMListener_validListenerUnique(U16 listenerUniqueId)
@@ -169,59 +177,24 @@ bool openavbAcmpSMListener_listenerIsConnectedTo(openavb_acmp_ACMPCommandRespons
 void openavbAcmpSMListener_txCommand(U8 messageType, openavb_acmp_ACMPCommandResponse_t *command, bool retry)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_ACMP);
-	openavb_list_node_t node = NULL;
+	openavb_acmp_InflightCommand_t *pInFlightCommand = NULL;
 
 	openavbRC rc = openavbAcmpMessageSend(messageType, command, OPENAVB_ACMP_STATUS_SUCCESS);
 	if (IS_OPENAVB_SUCCESS(rc)) {
 		if (!retry) {
-			node = openavbListNew(openavbAcmpSMListenerVars.inflight, sizeof(openavb_acmp_InflightCommand_t));
-			if (node) {
-				openavb_acmp_InflightCommand_t *pInFlightCommand = openavbListData(node);
-				if (pInFlightCommand) {
-
-					memcpy(&pInFlightCommand->command, command, sizeof(pInFlightCommand->command));
-					pInFlightCommand->command.message_type = messageType;
-					pInFlightCommand->retried = FALSE;
-					pInFlightCommand->original_sequence_id = command->sequence_id;	// AVDECC_TODO - is this correct?
-
-					CLOCK_GETTIME(OPENAVB_CLOCK_REALTIME, &pInFlightCommand->timer);
-					switch (messageType) {
-						case OPENAVB_ACMP_MESSAGE_TYPE_CONNECT_TX_COMMAND:
-							openavbTimeTimespecAddUsec(&pInFlightCommand->timer, OPENAVB_ACMP_COMMAND_TIMEOUT_CONNECT_TX_COMMAND * MICROSECONDS_PER_MSEC);
-							break;
-						case OPENAVB_ACMP_MESSAGE_TYPE_DISCONNECT_TX_COMMAND:
-							openavbTimeTimespecAddUsec(&pInFlightCommand->timer, OPENAVB_ACMP_COMMAND_TIMEOUT_DISCONNECT_TX_COMMAND * MICROSECONDS_PER_MSEC);
-							break;
-						default:
-							AVB_LOGF_ERROR("Unsupported command %u in openavbAcmpSMListener_txCommand", messageType);
-							openavbTimeTimespecAddUsec(&pInFlightCommand->timer, OPENAVB_ACMP_COMMAND_TIMEOUT_CONNECT_RX_COMMAND * MICROSECONDS_PER_MSEC);
-							break;
-					}
-				}
+			pInFlightCommand = openavbAcmpInflightAdd(openavbAcmpSMListenerVars.inflight, command, openavbAcmpSMListener_commandTimeoutMSec(messageType));
+			if (pInFlightCommand) {
+				pInFlightCommand->command.message_type = messageType;
+				pInFlightCommand->retried = FALSE;
+				pInFlightCommand->original_sequence_id = command->sequence_id;	// AVDECC_TODO - is this correct?
 			}
 		}
 		else {
 			// Retry case
-			node = openavbAcmpSMListener_findInflightNodeFromCommand(command);
-			if (node) {
-				openavb_acmp_InflightCommand_t *pInFlightCommand = openavbListData(node);
-				if (pInFlightCommand) {
-					pInFlightCommand->retried = TRUE;
-
-					CLOCK_GETTIME(OPENAVB_CLOCK_REALTIME, &pInFlightCommand->timer);
-					switch (messageType) {
-						case OPENAVB_ACMP_MESSAGE_TYPE_CONNECT_TX_COMMAND:
-							openavbTimeTimespecAddUsec(&pInFlightCommand->timer, OPENAVB_ACMP_COMMAND_TIMEOUT_CONNECT_TX_COMMAND * MICROSECONDS_PER_MSEC);
-							break;
-						case OPENAVB_ACMP_MESSAGE_TYPE_DISCONNECT_TX_COMMAND:
-							openavbTimeTimespecAddUsec(&pInFlightCommand->timer, OPENAVB_ACMP_COMMAND_TIMEOUT_DISCONNECT_TX_COMMAND * MICROSECONDS_PER_MSEC);
-							break;
-						default:
-							AVB_LOGF_ERROR("Unsupported command %u in openavbAcmpSMListener_txCommand", messageType);
-							openavbTimeTimespecAddUsec(&pInFlightCommand->timer, OPENAVB_ACMP_COMMAND_TIMEOUT_CONNECT_RX_COMMAND * MICROSECONDS_PER_MSEC);
-							break;
-					}
-				}
+			pInFlightCommand = openavbAcmpSMListener_findInflightFromCommand(command);
+			if (pInFlightCommand) {
+				pInFlightCommand->retried = TRUE;
+				openavbAcmpInflightRestart(openavbAcmpSMListenerVars.inflight, pInFlightCommand, openavbAcmpSMListener_commandTimeoutMSec(messageType));
 			}
 		}
 	}
@@ -229,9 +202,9 @@ void openavbAcmpSMListener_txCommand(U8 messageType, openavb_acmp_ACMPCommandRes
 		// Failed to send command
 		openavbAcmpSMListener_txResponse(messageType + 1, command, OPENAVB_ACMP_STATUS_COULD_NOT_SEND_MESSAGE);
 		if (retry) {
-			node = openavbAcmpSMListener_findInflightNodeFromCommand(command);
-			if (node) {
-				openavbListDelete(openavbAcmpSMListenerVars.inflight, node);
+			pInFlightCommand = openavbAcmpSMListener_findInflightFromCommand(command);
+			if (pInFlightCommand) {
+				openavbAcmpInflightRemove(openavbAcmpSMListenerVars.inflight, pInFlightCommand);
 			}
 		}
 	}
@@ -332,9 +305,9 @@ void openavbAcmpSMListener_cancelTimeout(openavb_acmp_ACMPCommandResponse_t *com
 void openavbAcmpSMListener_removeInflight(openavb_acmp_ACMPCommandResponse_t *commandResponse)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_ACMP);
-	openavb_list_node_t node = openavbAcmpSMListener_findInflightNodeFromCommand(commandResponse);
-	if (node) {
-		openavbListDelete(openavbAcmpSMListenerVars.inflight, node);
+	openavb_acmp_InflightCommand_t *pInFlightCommand = openavbAcmpSMListener_findInflightFromCommand(commandResponse);
+	if (pInFlightCommand) {
+		openavbAcmpInflightRemove(openavbAcmpSMListenerVars.inflight, pInFlightCommand);
 	}
 
 	AVB_TRACE_EXIT(AVB_TRACE_ACMP);
@@ -368,6 +341,8 @@ void openavbAcmpSMListenerStateMachine()
 	AVB_TRACE_ENTRY(AVB_TRACE_ACMP);
 
 	openavb_acmp_InflightCommand_t *pInflightActive = NULL;		// The inflight command for the current state
+	// The engine re-enters the state machine in the state it yielded from
+	bool bResume = openavbAvdeccTaskResumed(&openavbAcmpSMListenerTask);
 	openavb_acmp_sm_listener_state_t state = OPENAVB_ACMP_SM_LISTENER_STATE_WAITING;
 
 	// Lock such that the mutex is held unless waiting for a semaphore. Synchronous processing of command responses.
@@ -376,70 +351,50 @@ void openavbAcmpSMListenerStateMachine()
 		switch (state) {
 			case OPENAVB_ACMP_SM_LISTENER_STATE_WAITING:
 				AVB_TRACE_LINE(AVB_TRACE_ACMP);
-				AVB_LOG_DEBUG("State:  OPENAVB_ACMP_SM_LISTENER_STATE_WAITING");
 
-				openavbAcmpSMListenerVars.rcvdConnectRXCmd = FALSE;
-				openavbAcmpSMListenerVars.rcvdDisconnectRXCmd = FALSE;
-				openavbAcmpSMListenerVars.rcvdConnectTXResp = FALSE;
-				openavbAcmpSMListenerVars.rcvdDisconnectTXResp = FALSE;
-				openavbAcmpSMListenerVars.rcvdGetRXState = FALSE;
+				if (!bResume) {
+					AVB_LOG_DEBUG("State:  OPENAVB_ACMP_SM_LISTENER_STATE_WAITING");
+
+					openavbAcmpSMListenerVars.rcvdConnectRXCmd = FALSE;
+					openavbAcmpSMListenerVars.rcvdDisconnectRXCmd = FALSE;
+					openavbAcmpSMListenerVars.rcvdConnectTXResp = FALSE;
+					openavbAcmpSMListenerVars.rcvdDisconnectTXResp = FALSE;
+					openavbAcmpSMListenerVars.rcvdGetRXState = FALSE;
+				}
+				bResume = FALSE;
 
 				// Wait for a change in state
 				while (state == OPENAVB_ACMP_SM_LISTENER_STATE_WAITING && bRunning) {
 					AVB_TRACE_LINE(AVB_TRACE_ACMP);
 
-					// Calculate timeout for inflight commands
-					// Start is a arbitrary large time out.
-					struct timespec timeout;
-					CLOCK_GETTIME(OPENAVB_CLOCK_REALTIME, &timeout);
-					timeout.tv_sec += 60;	// At most will timeout after 60 seconds
-
-					// Look for soonest inflight command timeout
-					openavb_list_node_t node = openavbListIterFirst(openavbAcmpSMListenerVars.inflight);
-					while (node) {
-						openavb_acmp_InflightCommand_t *pInflight = openavbListData(node);
-						if ((openavbTimeTimespecCmp(&pInflight->timer, &timeout) < 0)) {
-							timeout.tv_sec = pInflight->timer.tv_sec;
-							timeout.tv_nsec = pInflight->timer.tv_nsec;
-						}
-						node = openavbListIterNext(openavbAcmpSMListenerVars.inflight);
-					}
-
+					// Wait until the soonest inflight command timeout, at most 60 seconds
+					U32 timeoutMSec = openavbAcmpInflightWaitMSec(openavbAcmpSMListenerVars.inflight, 60 * 1000);
 					ACMP_SM_UNLOCK();
-					U32 timeoutMSec = 0;
-					struct timespec now;
-					CLOCK_GETTIME(OPENAVB_CLOCK_REALTIME, &now);
-					timeoutMSec = openavbTimeUntilMSec(&now, &timeout);
-					SEM_ERR_T(err);
-					SEM_TIMEDWAIT(openavbAcmpSMListenerSemaphore, timeoutMSec, err);
+					openavb_avdecc_task_wait_t wait = openavbAvdeccTaskWait(&openavbAcmpSMListenerTask, timeoutMSec);
+					if (wait == OPENAVB_AVDECC_TASK_YIELD) {
+						AVB_TRACE_EXIT(AVB_TRACE_ACMP);
+						return;
+					}
 					ACMP_SM_LOCK();
 
-					if (!SEM_IS_ERR_NONE(err)) {
-						if (SEM_IS_ERR_TIMEOUT(err)) {
-							struct timespec now;
-							CLOCK_GETTIME(OPENAVB_CLOCK_REALTIME, &now);
-
+					if (wait != OPENAVB_AVDECC_TASK_WOKEN) {
+						if (wait == OPENAVB_AVDECC_TASK_TIMEOUT) {
 							// Look for a timed out inflight command
-							openavb_list_node_t node = openavbListIterFirst(openavbAcmpSMListenerVars.inflight);
-							while (node) {
-								openavb_acmp_InflightCommand_t *pInflight = openavbListData(node);
-								if ((openavbTimeTimespecCmp(&now, &pInflight->timer) >= 0)) {
-									// Found a timed out command
-									if (pInflight->command.message_type == OPENAVB_ACMP_MESSAGE_TYPE_CONNECT_TX_COMMAND) {
-										state = OPENAVB_ACMP_SM_LISTENER_STATE_CONNECT_TX_TIMEOUT;
-										pInflightActive = pInflight;
-									}
-									else if (pInflight->command.message_type == OPENAVB_ACMP_MESSAGE_TYPE_DISCONNECT_TX_COMMAND) {
-										state = OPENAVB_ACMP_SM_LISTENER_STATE_DISCONNECT_TX_TIMEOUT;
-										pInflightActive = pInflight;
-									}
-									else {
-										AVB_LOGF_ERROR("Unrecognized listener timeout command %u", pInflight->command.message_type);
-										bRunning = FALSE;
-									}
-									break;
+							openavb_acmp_InflightCommand_t *pInflight = openavbAcmpInflightExpired(openavbAcmpSMListenerVars.inflight);
+							if (pInflight) {
+								// Found a timed out command
+								if (pInflight->command.message_type == OPENAVB_ACMP_MESSAGE_TYPE_CONNECT_TX_COMMAND) {
+									state = OPENAVB_ACMP_SM_LISTENER_STATE_CONNECT_TX_TIMEOUT;
+									pInflightActive = pInflight;
+								}
+								else if (pInflight->command.message_type == OPENAVB_ACMP_MESSAGE_TYPE_DISCONNECT_TX_COMMAND) {
+									state = OPENAVB_ACMP_SM_LISTENER_STATE_DISCONNECT_TX_TIMEOUT;
+									pInflightActive = pInflight;
+								}
+								else {
+									AVB_LOGF_ERROR("Unrecognized listener timeout command %u", pInflight->command.message_type);
+									bRunning = FALSE;
 								}
-								node = openavbListIterNext(openavbAcmpSMListenerVars.inflight);
 							}
 						}
 					}
@@ -534,12 +489,9 @@ void openavbAcmpSMListenerStateMachine()
 							}
 						}
 
-						openavb_list_node_t node = openavbAcmpSMListener_findInflightNodeFromCommand(pRcvdCmdResp);
-						if (node) {
-							openavb_acmp_InflightCommand_t *pInFlightCommand = openavbListData(node);
-							if (pInFlightCommand) {
-								response.sequence_id = pInFlightCommand->original_sequence_id;
-							}
+						openavb_acmp_InflightCommand_t *pInFlightCommand = openavbAcmpSMListener_findInflightFromCommand(pRcvdCmdResp);
+						if (pInFlightCommand) {
+							response.sequence_id = pInFlightCommand->original_sequence_id;
 						}
 						openavbAcmpSMListener_cancelTimeout(pRcvdCmdResp);
 						openavbAcmpSMListener_removeInflight(pRcvdCmdResp);
@@ -611,12 +563,9 @@ void openavbAcmpSMListenerStateMachine()
 						memcpy(&response, pRcvdCmdResp, sizeof(response));
 						U8 status = pRcvdCmdResp->status;
 
-						openavb_list_node_t node = openavbAcmpSMListener_findInflightNodeFromCommand(pRcvdCmdResp);
-						if (node) {
-							openavb_acmp_InflightCommand_t *pInFlightCommand = openavbListData(node);
-							if (pInFlightCommand) {
-								response.sequence_id = pInFlightCommand->original_sequence_id;
-							}
+						openavb_acmp_InflightCommand_t *pInFlightCommand = openavbAcmpSMListener_findInflightFromCommand(pRcvdCmdResp);
+						if (pInFlightCommand) {
+							response.sequence_id = pInFlightCommand->original_sequence_id;
 						}
 						openavbAcmpSMListener_cancelTimeout(pRcvdCmdResp);
 						openavbAcmpSMListener_removeInflight(pRcvdCmdResp);
@@ -651,7 +600,7 @@ void openavbAcmpSMListenerStateMachine()
 								// or of using the state machine to allow retries indefinitely.
 								//
 								pInflightActive->retried = FALSE;
-								openavbTimeTimespecAddUsec(&pInflightActive->timer, OPENAVB_ACMP_COMMAND_TIMEOUT_CONNECT_TX_COMMAND * MICROSECONDS_PER_MSEC);
+								openavbAcmpInflightRestart(openavbAcmpSMListenerVars.inflight, pInflightActive, OPENAVB_ACMP_COMMAND_TIMEOUT_CONNECT_TX_COMMAND);
 #else
 								// Abort this attempt without sending a message the Controller.
 								openavbAcmpSMListener_removeInflight(&pInflightActive->command);
@@ -712,9 +661,9 @@ bool openavbAcmpSMListenerStart()
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_ACMP);
 
-	openavbAcmpSMListenerVars.inflight = openavbListNewList();
+	openavbAcmpSMListenerVars.inflight = openavbAcmpInflightNew();
 	if (!openavbAcmpSMListenerVars.inflight) {
-		AVB_LOG_ERROR("Unable to create inflight list. ACMP protocol not started.");
+		AVB_LOG_ERROR("Unable to create inflight table. ACMP protocol not started.");
 		AVB_TRACE_EXIT(AVB_TRACE_ACMP);
 		return FALSE;
 	}
@@ -737,19 +686,19 @@ bool openavbAcmpSMListenerStart()
 	MUTEX_CREATE(openavbAcmpSMListenerMutex, mta);
 	MUTEX_LOG_ERR("Could not create/initialize 'openavbAcmpSMListenerMutex' mutex");
 
-	SEM_ERR_T(err);
-	SEM_INIT(openavbAcmpSMListenerSemaphore, 1, err);
-	SEM_LOG_ERR(err);
+	openavbAvdeccTaskInit(&openavbAcmpSMListenerTask, "ACMP Listener", openavbAcmpSmListenerThreadFn, NULL, 1);
 
 	// Start the State Machine
-	bool errResult;
 	bRunning = TRUE;
-	THREAD_CREATE(openavbAcmpSmListenerThread, openavbAcmpSmListenerThread, NULL, openavbAcmpSmListenerThreadFn, NULL);
-	THREAD_CHECK_ERROR(openavbAcmpSmListenerThread, "Thread / task creation failed", errResult);
-	if (errResult) {
-		bRunning = FALSE;
-		AVB_TRACE_EXIT(AVB_TRACE_ACMP);
-		return FALSE;
+	if (!openavbAvdeccEngineAddTask(&openavbAcmpSMListenerTask)) {
+		bool errResult;
+		THREAD_CREATE(openavbAcmpSmListenerThread, openavbAcmpSmListenerThread, NULL, openavbAcmpSmListenerThreadFn, NULL);
+		THREAD_CHECK_ERROR(openavbAcmpSmListenerThread, "Thread / task creation failed", errResult);
+		if (errResult) {
+			bRunning = FALSE;
+			AVB_TRACE_EXIT(AVB_TRACE_ACMP);
+			return FALSE;
+		}
 	}
 
 	AVB_TRACE_EXIT(AVB_TRACE_ACMP);
@@ -763,14 +712,15 @@ void openavbAcmpSMListenerStop()
 	if (bRunning) {
 		openavbAcmpSMListenerSet_doTerminate(TRUE);
 
-		THREAD_JOIN(openavbAcmpSmListenerThread, NULL);
+		if (!openavbAvdeccEngineRemoveTask(&openavbAcmpSMListenerTask)) {
+			THREAD_JOIN(openavbAcmpSmListenerThread, NULL);
+		}
 	}
 
-	SEM_ERR_T(err);
-	SEM_DESTROY(openavbAcmpSMListenerSemaphore, err);
-	SEM_LOG_ERR(err);
+	openavbAvdeccTaskDestroy(&openavbAcmpSMListenerTask);
 
-	openavbListDeleteList(openavbAcmpSMListenerVars.inflight);
+	openavbAcmpInflightDelete(openavbAcmpSMListenerVars.inflight);
+	openavbAcmpSMListenerVars.inflight = NULL;
 	openavbArrayDeleteArray(openavbAcmpSMListenerVars.listenerStreamInfos);
 
 	AVB_TRACE_EXIT(AVB_TRACE_ACMP);
@@ -784,9 +734,7 @@ void openavbAcmpSMListenerSet_rcvdConnectRXCmd(openavb_acmp_ACMPCommandResponse_
 	memcpy(pRcvdCmdResp, command, sizeof(*command));
 	openavbAcmpSMListenerVars.rcvdConnectRXCmd = TRUE;
 
-	SEM_ERR_T(err);
-	SEM_POST(openavbAcmpSMListenerSemaphore, err);
-	SEM_LOG_ERR(err);
+	openavbAvdeccTaskSignal(&openavbAcmpSMListenerTask);
 
 	ACMP_SM_UNLOCK();
 	AVB_TRACE_EXIT(AVB_TRACE_ACMP);
@@ -800,9 +748,7 @@ void openavbAcmpSMListenerSet_rcvdDisconnectRXCmd(openavb_acmp_ACMPCommandRespon
 	memcpy(pRcvdCmdResp, command, sizeof(*command));
 	openavbAcmpSMListenerVars.rcvdDisconnectRXCmd = TRUE;
 
-	SEM_ERR_T(err);
-	SEM_POST(openavbAcmpSMListenerSemaphore, err);
-	SEM_LOG_ERR(err);
+	openavbAvdeccTaskSignal(&openavbAcmpSMListenerTask);
 
 	ACMP_SM_UNLOCK();
 	AVB_TRACE_EXIT(AVB_TRACE_ACMP);
@@ -816,9 +762,7 @@ void openavbAcmpSMListenerSet_rcvdConnectTXResp(openavb_acmp_ACMPCommandResponse
 	memcpy(pRcvdCmdResp, command, sizeof(*command));
 	openavbAcmpSMListenerVars.rcvdConnectTXResp = TRUE;
 
-	SEM_ERR_T(err);
-	SEM_POST(openavbAcmpSMListenerSemaphore, err);
-	SEM_LOG_ERR(err);
+	openavbAvdeccTaskSignal(&openavbAcmpSMListenerTask);
 
 	ACMP_SM_UNLOCK();
 	AVB_TRACE_EXIT(AVB_TRACE_ACMP);
@@ -832,9 +776,7 @@ void openavbAcmpSMListenerSet_rcvdDisconnectTXResp(openavb_acmp_ACMPCommandRespo
 	memcpy(pRcvdCmdResp, command, sizeof(*command));
 	openavbAcmpSMListenerVars.rcvdDisconnectTXResp = TRUE;
 
-	SEM_ERR_T(err);
-	SEM_POST(openavbAcmpSMListenerSemaphore, err);
-	SEM_LOG_ERR(err);
+	openavbAvdeccTaskSignal(&openavbAcmpSMListenerTask);
 
 	ACMP_SM_UNLOCK();
 	AVB_TRACE_EXIT(AVB_TRACE_ACMP);
@@ -848,9 +790,7 @@ void openavbAcmpSMListenerSet_rcvdGetRXState(openavb_acmp_ACMPCommandResponse_t
 	memcpy(pRcvdCmdResp, command, sizeof(*command));
 	openavbAcmpSMListenerVars.rcvdGetRXState = TRUE;
 
-	SEM_ERR_T(err);
-	SEM_POST(openavbAcmpSMListenerSemaphore, err);
-	SEM_LOG_ERR(err);
+	openavbAvdeccTaskSignal(&openavbAcmpSMListenerTask);
 
 	ACMP_SM_UNLOCK();
 	AVB_TRACE_EXIT(AVB_TRACE_ACMP);
@@ -860,9 +800,7 @@ void openavbAcmpSMListenerSet_doTerminate(bool value)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_ACMP);
 	openavbAcmpSMListenerVars.doTerminate = value;
-	SEM_ERR_T(err);
-	SEM_POST(openavbAcmpSMListenerSemaphore, err);
-	SEM_LOG_ERR(err);
+	openavbAvdeccTaskSignal(&openavbAcmpSMListenerTask);
 
 	AVB_TRACE_EXIT(AVB_TRACE_ACMP);
 }
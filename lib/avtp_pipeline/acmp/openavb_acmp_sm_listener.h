@@ -45,7 +45,7 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 
 // State machine vars IEEE Std 1722.1-2013 clause 8.2.2.5.1
 typedef struct {
-	openavb_list_t inflight;
+	openavb_acmp_inflight_t inflight;
 	openavb_array_t listenerStreamInfos;
 	bool rcvdConnectRXCmd;
 	bool rcvdDisconnectRXCmd;
@@ -47,8 +47,10 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #include "openavb_aem.h"
 #include "openavb_acmp_sm_talker.h"
 #include "openavb_acmp_sm_listener.h"
+#include "openavb_acmp_index.h"
 #include "openavb_acmp_message.h"
 #include "openavb_avdecc_pipeline_interaction_pub.h"
+#include "openavb_avdecc_engine.h"
 
 typedef enum {
 	OPENAVB_ACMP_SM_TALKER_STATE_WAITING,
@@ -73,35 +75,24 @@ static MUTEX_HANDLE(openavbAcmpSMTalkerMutex);
 #define ACMP_SM_LOCK() { MUTEX_CREATE_ERR(); MUTEX_LOCK(openavbAcmpSMTalkerMutex); MUTEX_LOG_ERR("Mutex lock failure"); }
 #define ACMP_SM_UNLOCK() { MUTEX_CREATE_ERR(); MUTEX_UNLOCK(openavbAcmpSMTalkerMutex); MUTEX_LOG_ERR("Mutex unlock failure"); }
 
-SEM_T(openavbAcmpSMTalkerSemaphore);
+openavb_avdecc_task_t openavbAcmpSMTalkerTask;
 THREAD_TYPE(openavbAcmpSmTalkerThread);
 THREAD_DEFINITON(openavbAcmpSmTalkerThread);
 
 
-openavb_list_node_t openavbAcmpSMTalker_findListenerPairNodeFromCommand(openavb_acmp_ACMPCommandResponse_t *command)
+static openavb_acmp_ListenerPair_t *openavbAcmpSMTalker_findListenerPairFromCommand(openavb_acmp_ACMPCommandResponse_t *command)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_ACMP);
 
-	openavb_list_node_t node = NULL;
+	openavb_acmp_ListenerPair_t *pListenerPair = NULL;
 
 	openavb_acmp_TalkerStreamInfo_t *pTalkerStreamInfo = openavbArrayDataIdx(openavbAcmpSMTalkerVars.talkerStreamInfos, command->talker_unique_id);
 	if (pTalkerStreamInfo) {
-		node = openavbListIterFirst(pTalkerStreamInfo->connected_listeners);
-		while (node) {
-			openavb_acmp_ListenerPair_t *pListenerPair = openavbListData(node);
-			if (pListenerPair) {
-				if (memcmp(pListenerPair->listener_entity_id, command->listener_entity_id, sizeof(pListenerPair->listener_entity_id)) == 0) {
-					if (pListenerPair->listener_unique_id == command->listener_unique_id) {
-						break;
-					}
-				}
-			}
-			node = openavbListIterNext(pTalkerStreamInfo->connected_listeners);
-		}
+		pListenerPair = openavbAcmpListenerPairsFind(pTalkerStreamInfo->connected_listeners, command->listener_entity_id, command->listener_unique_id);
 	}
 
 	AVB_TRACE_EXIT(AVB_TRACE_ACMP);
-	return node;
+	return pListenerPair;
 }
 
 
@@ -125,8 +116,8 @@ U8 openavbAcmpSMTalker_connectTalker(openavb_acmp_ACMPCommandResponse_t *command
 
 	openavb_acmp_TalkerStreamInfo_t *pTalkerStreamInfo = openavbArrayDataIdx(openavbAcmpSMTalkerVars.talkerStreamInfos, command->talker_unique_id);
 	if (pTalkerStreamInfo) {
-		openavb_list_node_t node = openavbAcmpSMTalker_findListenerPairNodeFromCommand(command);
-		if (node) {
+		openavb_acmp_ListenerPair_t *pListenerPair = openavbAcmpSMTalker_findListenerPairFromCommand(command);
+		if (pListenerPair) {
 			if (memcmp(pTalkerStreamInfo->stream_id, "\x00\x00\x00\x00\x00\x00\x00\x00", 8) == 0 ||
 					memcmp(pTalkerStreamInfo->stream_dest_mac, "\x00\x00\x00\x00\x00\x00", 6) == 0) {
 				// In the process of connecting.  Ignore this, as we don't yet have a response.
@@ -156,13 +147,10 @@ U8 openavbAcmpSMTalker_connectTalker(openavb_acmp_ACMPCommandResponse_t *command
 		}
 		else {
 			if (!pTalkerStreamInfo->connected_listeners) {
-				pTalkerStreamInfo->connected_listeners = openavbListNewList();
+				pTalkerStreamInfo->connected_listeners = openavbAcmpListenerPairsNew();
 			}
-			node = openavbListNew(pTalkerStreamInfo->connected_listeners, sizeof(openavb_acmp_ListenerPair_t));
-			if (node) {
-				openavb_acmp_ListenerPair_t *pListenerPair = openavbListData(node);
-				memcpy(pListenerPair->listener_entity_id, command->listener_entity_id, sizeof(pListenerPair->listener_entity_id));
-				pListenerPair->listener_unique_id = command->listener_unique_id;
+			pListenerPair = openavbAcmpListenerPairsAdd(pTalkerStreamInfo->connected_listeners, command->listener_entity_id, command->listener_unique_id);
+			if (pListenerPair) {
 				pTalkerStreamInfo->connection_count++;
 
 				U16 configIdx = openavbAemGetConfigIdx();
@@ -212,8 +200,8 @@ U8 openavbAcmpSMTalker_disconnectTalker(openavb_acmp_ACMPCommandResponse_t *comm
 
 	openavb_acmp_TalkerStreamInfo_t *pTalkerStreamInfo = openavbArrayDataIdx(openavbAcmpSMTalkerVars.talkerStreamInfos, command->talker_unique_id);
 	if (pTalkerStreamInfo) {
-		openavb_list_node_t node = openavbAcmpSMTalker_findListenerPairNodeFromCommand(command);
-		if (!node) {
+		openavb_acmp_ListenerPair_t *pListenerPair = openavbAcmpSMTalker_findListenerPairFromCommand(command);
+		if (!pListenerPair) {
 			// Already disconnected, so return the current status.
 			memcpy(command->stream_id, pTalkerStreamInfo->stream_id, sizeof(command->stream_id));
 			memcpy(command->stream_dest_mac, pTalkerStreamInfo->stream_dest_mac, sizeof(command->stream_dest_mac));
@@ -221,7 +209,7 @@ U8 openavbAcmpSMTalker_disconnectTalker(openavb_acmp_ACMPCommandResponse_t *comm
 			retStatus = OPENAVB_ACMP_STATUS_SUCCESS;
 		}
 		else {
-			openavbListDelete(pTalkerStreamInfo->connected_listeners, node);
+			openavbAcmpListenerPairsRemove(pTalkerStreamInfo->connected_listeners, pListenerPair);
 			pTalkerStreamInfo->connection_count--;
 
 			U16 configIdx = openavbAemGetConfigIdx();
@@ -283,14 +271,7 @@ U8 openavbAcmpSMTalker_getConnection(openavb_acmp_ACMPCommandResponse_t *command
 
 	openavb_acmp_TalkerStreamInfo_t *pTalkerStreamInfo = openavbArrayDataIdx(openavbAcmpSMTalkerVars.talkerStreamInfos, command->talker_unique_id);
 	if (pTalkerStreamInfo) {
-		int count = command->connection_count;
-
-		openavb_list_node_t node = openavbListIterFirst(pTalkerStreamInfo->connected_listeners);
-		while (node && count-- > 0) {
-			node = openavbListIterNext(pTalkerStreamInfo->connected_listeners);
-		}
-
-		openavb_acmp_ListenerPair_t *pListenerPair = openavbListData(node);
+		openavb_acmp_ListenerPair_t *pListenerPair = openavbAcmpListenerPairsAt(pTalkerStreamInfo->connected_listeners, command->connection_count);
 		if (pListenerPair) {
 			memcpy(command->stream_id, pTalkerStreamInfo->stream_id, sizeof(command->stream_id));
 			memcpy(command->stream_dest_mac, pTalkerStreamInfo->stream_dest_mac, sizeof(command->stream_dest_mac));
@@ -314,6 +295,8 @@ void openavbAcmpSMTalkerStateMachine()
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_ACMP);
 
+	// The engine re-enters the state machine in the state it yielded from
+	bool bResume = openavbAvdeccTaskResumed(&openavbAcmpSMTalkerTask);
 	openavb_acmp_sm_talker_state_t state = OPENAVB_ACMP_SM_TALKER_STATE_WAITING;
 
 	// Lock such that the mutex is held unless waiting for a semaphore. Synchronous processing of command responses.
@@ -322,23 +305,30 @@ void openavbAcmpSMTalkerStateMachine()
 		switch (state) {
 			case OPENAVB_ACMP_SM_TALKER_STATE_WAITING:
 				AVB_TRACE_LINE(AVB_TRACE_ACMP);
-				AVB_LOG_DEBUG("State:  OPENAVB_ACMP_SM_TALKER_STATE_WAITING");
 
-				openavbAcmpSMTalkerVars.rcvdConnectTX = FALSE;
-				openavbAcmpSMTalkerVars.rcvdDisconnectTX = FALSE;
-				openavbAcmpSMTalkerVars.rcvdGetTXState = FALSE;
-				openavbAcmpSMTalkerVars.rcvdGetTXConnection = FALSE;
+				if (!bResume) {
+					AVB_LOG_DEBUG("State:  OPENAVB_ACMP_SM_TALKER_STATE_WAITING");
+
+					openavbAcmpSMTalkerVars.rcvdConnectTX = FALSE;
+					openavbAcmpSMTalkerVars.rcvdDisconnectTX = FALSE;
+					openavbAcmpSMTalkerVars.rcvdGetTXState = FALSE;
+					openavbAcmpSMTalkerVars.rcvdGetTXConnection = FALSE;
+				}
+				bResume = FALSE;
 
 				// Wait for a change in state
 				while (state == OPENAVB_ACMP_SM_TALKER_STATE_WAITING && bRunning) {
 					AVB_TRACE_LINE(AVB_TRACE_ACMP);
 
 					ACMP_SM_UNLOCK();
-					SEM_ERR_T(err);
-					SEM_WAIT(openavbAcmpSMTalkerSemaphore, err);
+					openavb_avdecc_task_wait_t wait = openavbAvdeccTaskWait(&openavbAcmpSMTalkerTask, OPENAVB_AVDECC_TASK_WAIT_FOREVER);
+					if (wait == OPENAVB_AVDECC_TASK_YIELD) {
+						AVB_TRACE_EXIT(AVB_TRACE_ACMP);
+						return;
+					}
 					ACMP_SM_LOCK();
 
-					if (SEM_IS_ERR_NONE(err)) {
+					if (wait == OPENAVB_AVDECC_TASK_WOKEN) {
 						if (openavbAcmpSMTalkerVars.doTerminate) {
 							bRunning = FALSE;
 						}
@@ -487,19 +477,19 @@ bool openavbAcmpSMTalkerStart()
 	MUTEX_CREATE(openavbAcmpSMTalkerMutex, mta);
 	MUTEX_LOG_ERR("Could not create/initialize 'openavbAcmpSMTalkerMutex' mutex");
 
-	SEM_ERR_T(err);
-	SEM_INIT(openavbAcmpSMTalkerSemaphore, 1, err);
-	SEM_LOG_ERR(err);
+	openavbAvdeccTaskInit(&openavbAcmpSMTalkerTask, "ACMP Talker", openavbAcmpSMTalkerThreadFn, NULL, 1);
 
 	// Start the State Machine
-	bool errResult;
 	bRunning = TRUE;
-	THREAD_CREATE(openavbAcmpSmTalkerThread, openavbAcmpSmTalkerThread, NULL, openavbAcmpSMTalkerThreadFn, NULL);
-	THREAD_CHECK_ERROR(openavbAcmpSmTalkerThread, "Thread / task creation failed", errResult);
-	if (errResult) {
-		bRunning = FALSE;
-		AVB_TRACE_EXIT(AVB_TRACE_ACMP);
-		return FALSE;
+	if (!openavbAvdeccEngineAddTask(&openavbAcmpSMTalkerTask)) {
+		bool errResult;
+		THREAD_CREATE(openavbAcmpSmTalkerThread, openavbAcmpSmTalkerThread, NULL, openavbAcmpSMTalkerThreadFn, NULL);
+		THREAD_CHECK_ERROR(openavbAcmpSmTalkerThread, "Thread / task creation failed", errResult);
+		if (errResult) {
+			bRunning = FALSE;
+			AVB_TRACE_EXIT(AVB_TRACE_ACMP);
+			return FALSE;
+		}
 	}
 
 	AVB_TRACE_EXIT(AVB_TRACE_ACMP);
@@ -513,18 +503,19 @@ void openavbAcmpSMTalkerStop()
 	if (bRunning) {
 		openavbAcmpSMTalkerSet_doTerminate(TRUE);
 
-		THREAD_JOIN(openavbAcmpSmTalkerThread, NULL);
+		if (!openavbAvdeccEngineRemoveTask(&openavbAcmpSMTalkerTask)) {
+			THREAD_JOIN(openavbAcmpSmTalkerThread, NULL);
+		}
 	}
 
-	SEM_ERR_T(err);
-	SEM_DESTROY(openavbAcmpSMTalkerSemaphore, err);
-	SEM_LOG_ERR(err);
+	openavbAvdeccTaskDestroy(&openavbAcmpSMTalkerTask);
 
 	openavb_array_elem_t node = openavbArrayIterFirst(openavbAcmpSMTalkerVars.talkerStreamInfos);
 	while (node) {
 		openavb_acmp_TalkerStreamInfo_t *pTalkerStreamInfo = openavbArrayData(node);
 		if (pTalkerStreamInfo != NULL) {
-			openavbListDeleteList(pTalkerStreamInfo->connected_listeners);
+			openavbAcmpListenerPairsDelete(pTalkerStreamInfo->connected_listeners);
+			pTalkerStreamInfo->connected_listeners = NULL;
 			if (pTalkerStreamInfo->waiting_on_talker) {
 				free(pTalkerStreamInfo->waiting_on_talker);
 				pTalkerStreamInfo->waiting_on_talker = NULL;
@@ -545,9 +536,7 @@ void openavbAcmpSMTalkerSet_rcvdConnectTXCmd(openavb_acmp_ACMPCommandResponse_t
 	memcpy(pRcvdCmdResp, command, sizeof(*command));
 	openavbAcmpSMTalkerVars.rcvdConnectTX = TRUE;
 
-	SEM_ERR_T(err);
-	SEM_POST(openavbAcmpSMTalkerSemaphore, err);
-	SEM_LOG_ERR(err);
+	openavbAvdeccTaskSignal(&openavbAcmpSMTalkerTask);
 
 	ACMP_SM_UNLOCK();
 	AVB_TRACE_EXIT(AVB_TRACE_ACMP);
@@ -561,9 +550,7 @@ void openavbAcmpSMTalkerSet_rcvdDisconnectTXCmd(openavb_acmp_ACMPCommandResponse
 	memcpy(pRcvdCmdResp, command, sizeof(*command));
 	openavbAcmpSMTalkerVars.rcvdDisconnectTX = TRUE;
 
-	SEM_ERR_T(err);
-	SEM_POST(openavbAcmpSMTalkerSemaphore, err);
-	SEM_LOG_ERR(err);
+	openavbAvdeccTaskSignal(&openavbAcmpSMTalkerTask);
 
 	ACMP_SM_UNLOCK();
 	AVB_TRACE_EXIT(AVB_TRACE_ACMP);
@@ -577,9 +564,7 @@ void openavbAcmpSMTalkerSet_rcvdGetTXState(openavb_acmp_ACMPCommandResponse_t *c
 	memcpy(pRcvdCmdResp, command, sizeof(*command));
 	openavbAcmpSMTalkerVars.rcvdGetTXState = TRUE;
 
-	SEM_ERR_T(err);
-	SEM_POST(openavbAcmpSMTalkerSemaphore, err);
-	SEM_LOG_ERR(err);
+	openavbAvdeccTaskSignal(&openavbAcmpSMTalkerTask);
 
 	ACMP_SM_UNLOCK();
 	AVB_TRACE_EXIT(AVB_TRACE_ACMP);
@@ -593,9 +578,7 @@ void openavbAcmpSMTalkerSet_rcvdGetTXConnectionCmd(openavb_acmp_ACMPCommandRespo
 	memcpy(pRcvdCmdResp, command, sizeof(*command));
 	openavbAcmpSMTalkerVars.rcvdGetTXConnection = TRUE;
 
-	SEM_ERR_T(err);
-	SEM_POST(openavbAcmpSMTalkerSemaphore, err);
-	SEM_LOG_ERR(err);
+	openavbAvdeccTaskSignal(&openavbAcmpSMTalkerTask);
 
 	ACMP_SM_UNLOCK();
 	AVB_TRACE_EXIT(AVB_TRACE_ACMP);
@@ -606,9 +589,7 @@ void openavbAcmpSMTalkerSet_doTerminate(bool value)
 	AVB_TRACE_ENTRY(AVB_TRACE_ACMP);
 	openavbAcmpSMTalkerVars.doTerminate = value;
 
-	SEM_ERR_T(err);
-	SEM_POST(openavbAcmpSMTalkerSemaphore, err);
-	SEM_LOG_ERR(err);
+	openavbAvdeccTaskSignal(&openavbAcmpSMTalkerTask);
 
 	AVB_TRACE_EXIT(AVB_TRACE_ACMP);
 }
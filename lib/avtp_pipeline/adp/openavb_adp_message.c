@@ -47,6 +47,7 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 
 #include "openavb_debug.h"
 #include "openavb_rawsock.h"
+#include "openavb_avdecc_engine.h"
 #include "openavb_avtp.h"
 #include "openavb_srp.h"
 #include "openavb_adp.h"
@@ -101,10 +102,21 @@ THREAD_DEFINITON(openavbAdpMessageRxThread);
 
 static bool bRunning = FALSE;
 
+// Using the AVDECC engine's socket rather than our own
+static bool bEngine = FALSE;
+
 void openavbAdpCloseSocket()
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_ADP);
 
+	if (bEngine) {
+		// The socket belongs to the engine
+		txSock = NULL;
+		bEngine = FALSE;
+		AVB_TRACE_EXIT(AVB_TRACE_ADP);
+		return;
+	}
+
 	if (rxSock) {
 		openavbRawsockClose(rxSock);
 		rxSock = NULL;
@@ -123,6 +135,21 @@ bool openavbAdpOpenSocket(const char* ifname, U16 vlanID, U8 vlanPCP)
 
 	hdr_info_t hdr;
 
+	if (openavbAvdeccEngineIsRunning()) {
+		// Send on the AVDECC engine's socket. It receives for us as well.
+		bEngine = TRUE;
+		txSock = openavbAvdeccEngineTxSock();
+		if (txSock && openavbAvdeccEngineGetAddr(ADDR_PTR(&intfAddr))) {
+			AVB_TRACE_EXIT(AVB_TRACE_ADP);
+			return true;
+		}
+
+		AVB_LOG_ERROR("AVDECC engine socket not available");
+		openavbAdpCloseSocket();
+		AVB_TRACE_EXIT(AVB_TRACE_ADP);
+		return false;
+	}
+
 #ifndef UBUNTU
 	// This is the normal case for most of our supported platforms
 	rxSock = openavbRawsockOpen(ifname, TRUE, FALSE, ETHERTYPE_8021Q, ADP_FRAME_LEN, ADP_NUM_BUFFERS);
@@ -295,10 +322,12 @@ void openavbAdpMessageTxFrame(U8 msgType, U8 *destAddr)
 	U32 size;
 	unsigned int hdrlen = 0;
 
+	openavbAvdeccEngineTxLock();
 	pBuf = openavbRawsockGetTxFrame(txSock, TRUE, &size);
 
 	if (!pBuf) {
 		AVB_LOG_ERROR("No TX buffer");
+		openavbAvdeccEngineTxUnlock();
 		AVB_TRACE_EXIT(AVB_TRACE_ADP);
 		return;
 	}
@@ -306,6 +335,7 @@ void openavbAdpMessageTxFrame(U8 msgType, U8 *destAddr)
 	if (size < ADP_FRAME_LEN) {
 		AVB_LOG_ERROR("TX buffer too small");
 		openavbRawsockRelTxFrame(txSock, pBuf);
+		openavbAvdeccEngineTxUnlock();
 		pBuf = NULL;
 		AVB_TRACE_EXIT(AVB_TRACE_ADP);
 		return;
@@ -360,10 +390,16 @@ void openavbAdpMessageTxFrame(U8 msgType, U8 *destAddr)
 
 	openavbRawsockTxFrameReady(txSock, pBuf, hdrlen + AVTP_HDR_LEN + ADP_DATA_LEN, 0);
 	openavbRawsockSend(txSock);
+	openavbAvdeccEngineTxUnlock();
 
 	AVB_TRACE_EXIT(AVB_TRACE_ADP);
 }
 
+static void openavbAdpMessageRxEngineCb(void *pv, U8 *payload, int payload_len, hdr_info_t *hdr)
+{
+	openavbAdpMessageRxFrameParse(payload, payload_len, hdr);
+}
+
 void* openavbAdpMessageRxThreadFn(void *pv)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_ADP);
@@ -387,6 +423,16 @@ openavbRC openavbAdpMessageHandlerStart()
 
 	if (openavbAdpOpenSocket((const char *)gAvdeccCfg.ifname, gAvdeccCfg.vlanID, gAvdeccCfg.vlanPCP)) {
 
+		if (bEngine) {
+			// No RX thread; the engine hands us our PDUs
+			if (!openavbAvdeccEngineRegister(OPENAVB_ADP_AVTP_SUBTYPE, openavbAdpMessageRxEngineCb, NULL)) {
+				bRunning = FALSE;
+				openavbAdpCloseSocket();
+				AVB_RC_TRACE_RET(OPENAVB_AVDECC_FAILURE, AVB_TRACE_ADP);
+			}
+			AVB_RC_TRACE_RET(OPENAVB_AVDECC_SUCCESS, AVB_TRACE_ADP);
+		}
+
 		// Start the RX thread
 		bool errResult;
 		THREAD_CREATE(openavbAdpMessageRxThread, openavbAdpMessageRxThread, NULL, openavbAdpMessageRxThreadFn, NULL);
@@ -410,7 +456,12 @@ void openavbAdpMessageHandlerStop()
 
 	if (bRunning) {
 		bRunning = FALSE;
-		THREAD_JOIN(openavbAdpMessageRxThread, NULL);
+		if (bEngine) {
+			openavbAvdeccEngineUnregister(OPENAVB_ADP_AVTP_SUBTYPE, openavbAdpMessageRxEngineCb, NULL);
+		}
+		else {
+			THREAD_JOIN(openavbAdpMessageRxThread, NULL);
+		}
 		openavbAdpCloseSocket();
 	}
 
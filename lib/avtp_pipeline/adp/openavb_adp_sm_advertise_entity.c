@@ -48,6 +48,7 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #include "openavb_adp.h"
 #include "openavb_adp_sm_advertise_interface.h"
 #include "openavb_adp_sm_advertise_entity.h"
+#include "openavb_avdecc_engine.h"
 
 typedef enum {
 	OPENAVB_ADP_SM_ADVERTISE_ENTITY_STATE_INITIALIZE,
@@ -65,7 +66,7 @@ extern MUTEX_HANDLE(openavbAdpMutex);
 #define ADP_LOCK() { MUTEX_CREATE_ERR(); MUTEX_LOCK(openavbAdpMutex); MUTEX_LOG_ERR("Mutex lock failure"); }
 #define ADP_UNLOCK() { MUTEX_CREATE_ERR(); MUTEX_UNLOCK(openavbAdpMutex); MUTEX_LOG_ERR("Mutex unlock failure"); }
 
-SEM_T(openavbAdpSMAdvertiseEntitySemaphore);
+openavb_avdecc_task_t openavbAdpSMAdvertiseEntityTask;
 THREAD_TYPE(openavbAdpSmAdvertiseEntityThread);
 THREAD_DEFINITON(openavbAdpSmAdvertiseEntityThread);
 
@@ -81,7 +82,10 @@ void openavbAdpSMAdvertiseEntityStateMachine()
 	AVB_TRACE_ENTRY(AVB_TRACE_ADP);
 	bool bRunning = TRUE;
 
-	openavb_adp_sm_advertise_entity_state_t state = OPENAVB_ADP_SM_ADVERTISE_ENTITY_STATE_INITIALIZE;
+	// The engine re-enters the state machine in the state it yielded from
+	bool bResume = openavbAvdeccTaskResumed(&openavbAdpSMAdvertiseEntityTask);
+	openavb_adp_sm_advertise_entity_state_t state = bResume ?
+		OPENAVB_ADP_SM_ADVERTISE_ENTITY_STATE_WAITING : OPENAVB_ADP_SM_ADVERTISE_ENTITY_STATE_INITIALIZE;
 
 	while (bRunning) {
 		switch (state) {
@@ -133,12 +137,16 @@ void openavbAdpSMAdvertiseEntityStateMachine()
 			case OPENAVB_ADP_SM_ADVERTISE_ENTITY_STATE_WAITING:
 				{
 					AVB_TRACE_LINE(AVB_TRACE_ADP);
-					AVB_LOG_DEBUG("State:  OPENAVB_ADP_SM_ADVERTISE_ENTITY_STATE_WAITING");
 
-					ADP_LOCK();
-					openavbAdpSMAdvertiseInterfaceSet_rcvdDiscover(FALSE);
-					openavbAdpSMGlobalVars.entityInfo.pdu.available_index++;
-					ADP_UNLOCK();
+					if (!bResume) {
+						AVB_LOG_DEBUG("State:  OPENAVB_ADP_SM_ADVERTISE_ENTITY_STATE_WAITING");
+
+						ADP_LOCK();
+						openavbAdpSMAdvertiseInterfaceSet_rcvdDiscover(FALSE);
+						openavbAdpSMGlobalVars.entityInfo.pdu.available_index++;
+						ADP_UNLOCK();
+					}
+					bResume = FALSE;
 
 					// Wait for change in state
 					while (state == OPENAVB_ADP_SM_ADVERTISE_ENTITY_STATE_WAITING && bRunning) {
@@ -152,13 +160,15 @@ void openavbAdpSMAdvertiseEntityStateMachine()
 							state = OPENAVB_ADP_SM_ADVERTISE_ENTITY_STATE_ADVERTISE;
 						}
 						else {
-							SEM_ERR_T(err);
-							SEM_TIMEDWAIT(openavbAdpSMAdvertiseEntitySemaphore, timeoutMSec, err);
-							if (!SEM_IS_ERR_NONE(err) && !SEM_IS_ERR_TIMEOUT(err)) { AVB_LOGF_WARNING("Semaphore error %d", err); }
+							openavb_avdecc_task_wait_t wait = openavbAvdeccTaskWait(&openavbAdpSMAdvertiseEntityTask, timeoutMSec);
+							if (wait == OPENAVB_AVDECC_TASK_YIELD) {
+								AVB_TRACE_EXIT(AVB_TRACE_ADP);
+								return;
+							}
 
 							if (openavbAdpSMAdvertiseEntityVars.doTerminate) {
 								bRunning = FALSE;
-							} else if (SEM_IS_ERR_TIMEOUT(err) ||
+							} else if (wait == OPENAVB_AVDECC_TASK_TIMEOUT ||
 								openavbAdpSMAdvertiseEntityVars.needsAdvertise) {
 								state = OPENAVB_ADP_SM_ADVERTISE_ENTITY_STATE_ADVERTISE;
 							}
@@ -188,9 +198,7 @@ void openavbAdpSMAdvertiseEntityStart()
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_ADP);
 
-	SEM_ERR_T(err);
-	SEM_INIT(openavbAdpSMAdvertiseEntitySemaphore, 1, err);
-	SEM_LOG_ERR(err);
+	openavbAvdeccTaskInit(&openavbAdpSMAdvertiseEntityTask, "ADP Advertise Entity", openavbAdpSMAdvertiseEntityThreadFn, NULL, 1);
 
 	ADP_LOCK();
 	openavbAdpSMAdvertiseEntityVars.needsAdvertise = FALSE;
@@ -198,10 +206,12 @@ void openavbAdpSMAdvertiseEntityStart()
 	ADP_UNLOCK();
 
 	// Start the Advertise Entity State Machine
-	bool errResult;
-	THREAD_CREATE(openavbAdpSmAdvertiseEntityThread, openavbAdpSmAdvertiseEntityThread, NULL, openavbAdpSMAdvertiseEntityThreadFn, NULL);
-	THREAD_CHECK_ERROR(openavbAdpSmAdvertiseEntityThread, "Thread / task creation failed", errResult);
-	if (errResult);		// Already reported
+	if (!openavbAvdeccEngineAddTask(&openavbAdpSMAdvertiseEntityTask)) {
+		bool errResult;
+		THREAD_CREATE(openavbAdpSmAdvertiseEntityThread, openavbAdpSmAdvertiseEntityThread, NULL, openavbAdpSMAdvertiseEntityThreadFn, NULL);
+		THREAD_CHECK_ERROR(openavbAdpSmAdvertiseEntityThread, "Thread / task creation failed", errResult);
+		if (errResult);		// Already reported
+	}
 
 	AVB_TRACE_EXIT(AVB_TRACE_ADP);
 }
@@ -211,11 +221,11 @@ void openavbAdpSMAdvertiseEntityStop()
 	AVB_TRACE_ENTRY(AVB_TRACE_ADP);
 
 	openavbAdpSMAdvertiseEntitySet_doTerminate(TRUE);
-	THREAD_JOIN(openavbAdpSmAdvertiseEntityThread, NULL);
+	if (!openavbAvdeccEngineRemoveTask(&openavbAdpSMAdvertiseEntityTask)) {
+		THREAD_JOIN(openavbAdpSmAdvertiseEntityThread, NULL);
+	}
 
-	SEM_ERR_T(err);
-	SEM_DESTROY(openavbAdpSMAdvertiseEntitySemaphore, err);
-	SEM_LOG_ERR(err);
+	openavbAvdeccTaskDestroy(&openavbAdpSMAdvertiseEntityTask);
 
 	AVB_TRACE_EXIT(AVB_TRACE_ADP);
 }
@@ -226,9 +236,7 @@ void openavbAdpSMAdvertiseEntitySet_needsAdvertise(bool value)
 
 	openavbAdpSMAdvertiseEntityVars.needsAdvertise = value;
 
-	SEM_ERR_T(err);
-	SEM_POST(openavbAdpSMAdvertiseEntitySemaphore, err);
-	SEM_LOG_ERR(err);
+	openavbAvdeccTaskSignal(&openavbAdpSMAdvertiseEntityTask);
 
 	AVB_TRACE_EXIT(AVB_TRACE_ADP);
 }
@@ -239,9 +247,7 @@ void openavbAdpSMAdvertiseEntitySet_doTerminate(bool value)
 
 	openavbAdpSMAdvertiseEntityVars.doTerminate = value;
 
-	SEM_ERR_T(err);
-	SEM_POST(openavbAdpSMAdvertiseEntitySemaphore, err);
-	SEM_LOG_ERR(err);
+	openavbAvdeccTaskSignal(&openavbAdpSMAdvertiseEntityTask);
 
 	AVB_TRACE_EXIT(AVB_TRACE_ADP);
 }
@@ -51,6 +51,7 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #include "openavb_adp_sm_advertise_interface.h"
 #include "openavb_adp_sm_advertise_entity.h"
 #include "openavb_adp_message.h"
+#include "openavb_avdecc_engine.h"
 
 #define OPENAVB_ADP_SM_ADVERTISE_INTERFACE_WAIT_TIME_USEC 10000
 
@@ -73,7 +74,7 @@ extern MUTEX_HANDLE(openavbAdpMutex);
 #define ADP_LOCK() { MUTEX_CREATE_ERR(); MUTEX_LOCK(openavbAdpMutex); MUTEX_LOG_ERR("Mutex lock failure"); }
 #define ADP_UNLOCK() { MUTEX_CREATE_ERR(); MUTEX_UNLOCK(openavbAdpMutex); MUTEX_LOG_ERR("Mutex unlock failure"); }
 
-SEM_T(openavbAdpSMAdvertiseInterfaceSemaphore);
+openavb_avdecc_task_t openavbAdpSMAdvertiseInterfaceTask;
 THREAD_TYPE(openavbAdpSmAdvertiseInterfaceThread);
 THREAD_DEFINITON(openavbAdpSmAdvertiseInterfaceThread);
 
@@ -102,7 +103,10 @@ void openavbAdpSMAdvertiseInterfaceStateMachine()
 	AVB_TRACE_ENTRY(AVB_TRACE_ADP);
 	bool bRunning = TRUE;
 
-	openavb_adp_sm_advertise_interface_state_t state = OPENAVB_ADP_SM_ADVERTISE_INTERFACE_STATE_INITIALIZE;
+	// The engine re-enters the state machine in the state it yielded from
+	bool bResume = openavbAvdeccTaskResumed(&openavbAdpSMAdvertiseInterfaceTask);
+	openavb_adp_sm_advertise_interface_state_t state = bResume ?
+		OPENAVB_ADP_SM_ADVERTISE_INTERFACE_STATE_WAITING : OPENAVB_ADP_SM_ADVERTISE_INTERFACE_STATE_INITIALIZE;
 
 	while (bRunning) {
 		switch (state) {
@@ -128,16 +132,20 @@ void openavbAdpSMAdvertiseInterfaceStateMachine()
 			case OPENAVB_ADP_SM_ADVERTISE_INTERFACE_STATE_WAITING:
 				{
 					AVB_TRACE_LINE(AVB_TRACE_ADP);
-					AVB_LOG_DEBUG("State:  OPENAVB_ADP_SM_ADVERTISE_INTERFACE_STATE_WAITING");
+					if (!bResume) {
+						AVB_LOG_DEBUG("State:  OPENAVB_ADP_SM_ADVERTISE_INTERFACE_STATE_WAITING");
+					}
+					bResume = FALSE;
 
 					// openavbAdpSMAdvertiseInterfaceVars.rcvdDiscover = FALSE;		// Per 1722.1 What's next notes. Note: setting this elsewhere otherwise incorrect behavior.
 					// openavbAdpSMGlobalVars.entityInfo.pdu.available_index++;		// Per 1722.1 What's next notes
 
 					// Wait for a change in state
 					while (state == OPENAVB_ADP_SM_ADVERTISE_INTERFACE_STATE_WAITING && bRunning) {
-						SEM_ERR_T(err);
-						SEM_WAIT(openavbAdpSMAdvertiseInterfaceSemaphore, err);
-						if (!SEM_IS_ERR_NONE(err)) { AVB_LOGF_WARNING("Semaphore error %d", err); }
+						if (openavbAvdeccTaskWait(&openavbAdpSMAdvertiseInterfaceTask, OPENAVB_AVDECC_TASK_WAIT_FOREVER) == OPENAVB_AVDECC_TASK_YIELD) {
+							AVB_TRACE_EXIT(AVB_TRACE_ADP);
+							return;
+						}
 
 						ADP_LOCK();
 						if (openavbAdpSMAdvertiseInterfaceVars.doTerminate)
@@ -235,19 +243,19 @@ void openavbAdpSMAdvertiseInterfaceStart()
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_ADP);
 
-	SEM_ERR_T(err);
-	SEM_INIT(openavbAdpSMAdvertiseInterfaceSemaphore, 1, err);
-	SEM_LOG_ERR(err);
+	openavbAvdeccTaskInit(&openavbAdpSMAdvertiseInterfaceTask, "ADP Advertise Interface", openavbAdpSMAdvertiseInterfaceThreadFn, NULL, 1);
 
 	ADP_LOCK();
 	memset(&openavbAdpSMAdvertiseInterfaceVars, 0, sizeof(openavbAdpSMAdvertiseInterfaceVars));
 	ADP_UNLOCK();
 
 	// Start the Advertise Entity State Machine
-	bool errResult;
-	THREAD_CREATE(openavbAdpSmAdvertiseInterfaceThread, openavbAdpSmAdvertiseInterfaceThread, NULL, openavbAdpSMAdvertiseInterfaceThreadFn, NULL);
-	THREAD_CHECK_ERROR(openavbAdpSmAdvertiseInterfaceThread, "Thread / task creation failed", errResult);
-	if (errResult);		// Already reported
+	if (!openavbAvdeccEngineAddTask(&openavbAdpSMAdvertiseInterfaceTask)) {
+		bool errResult;
+		THREAD_CREATE(openavbAdpSmAdvertiseInterfaceThread, openavbAdpSmAdvertiseInterfaceThread, NULL, openavbAdpSMAdvertiseInterfaceThreadFn, NULL);
+		THREAD_CHECK_ERROR(openavbAdpSmAdvertiseInterfaceThread, "Thread / task creation failed", errResult);
+		if (errResult);		// Already reported
+	}
 
 	AVB_TRACE_EXIT(AVB_TRACE_ADP);
 }
@@ -257,11 +265,11 @@ void openavbAdpSMAdvertiseInterfaceStop()
 	AVB_TRACE_ENTRY(AVB_TRACE_ADP);
 
 	openavbAdpSMAdvertiseInterfaceSet_doTerminate(TRUE);
-	THREAD_JOIN(openavbAdpSmAdvertiseInterfaceThread, NULL);
+	if (!openavbAvdeccEngineRemoveTask(&openavbAdpSMAdvertiseInterfaceTask)) {
+		THREAD_JOIN(openavbAdpSmAdvertiseInterfaceThread, NULL);
+	}
 
-	SEM_ERR_T(err);
-	SEM_DESTROY(openavbAdpSMAdvertiseInterfaceSemaphore, err);
-	SEM_LOG_ERR(err);
+	openavbAvdeccTaskDestroy(&openavbAdpSMAdvertiseInterfaceTask);
 
 	AVB_TRACE_EXIT(AVB_TRACE_ADP);
 }
@@ -273,9 +281,7 @@ void openavbAdpSMAdvertiseInterfaceSet_advertisedGrandmasterID(U8 *pValue)
 		memcpy(openavbAdpSMAdvertiseInterfaceVars.advertisedGrandmasterID, pValue, sizeof(openavbAdpSMAdvertiseInterfaceVars.advertisedGrandmasterID));
 	}
 
-	SEM_ERR_T(err);
-	SEM_POST(openavbAdpSMAdvertiseInterfaceSemaphore, err);
-	SEM_LOG_ERR(err);
+	openavbAvdeccTaskSignal(&openavbAdpSMAdvertiseInterfaceTask);
 
 	AVB_TRACE_EXIT(AVB_TRACE_ADP);
 }
@@ -285,9 +291,7 @@ void openavbAdpSMAdvertiseInterfaceSet_rcvdDiscover(bool value)
 	AVB_TRACE_ENTRY(AVB_TRACE_ADP);
 	openavbAdpSMAdvertiseInterfaceVars.rcvdDiscover = value;
 
-	SEM_ERR_T(err);
-	SEM_POST(openavbAdpSMAdvertiseInterfaceSemaphore, err);
-	SEM_LOG_ERR(err);
+	openavbAvdeccTaskSignal(&openavbAdpSMAdvertiseInterfaceTask);
 
 	AVB_TRACE_EXIT(AVB_TRACE_ADP);
 }
@@ -307,9 +311,7 @@ void openavbAdpSMAdvertiseInterfaceSet_doTerminate(bool value)
 	AVB_TRACE_ENTRY(AVB_TRACE_ADP);
 	openavbAdpSMAdvertiseInterfaceVars.doTerminate = value;
 
-	SEM_ERR_T(err);
-	SEM_POST(openavbAdpSMAdvertiseInterfaceSemaphore, err);
-	SEM_LOG_ERR(err);
+	openavbAvdeccTaskSignal(&openavbAdpSMAdvertiseInterfaceTask);
 
 	AVB_TRACE_EXIT(AVB_TRACE_ADP);
 }
@@ -319,9 +321,7 @@ void openavbAdpSMAdvertiseInterfaceSet_doAdvertise(bool value)
 	AVB_TRACE_ENTRY(AVB_TRACE_ADP);
 	openavbAdpSMAdvertiseInterfaceVars.doAdvertise = value;
 
-	SEM_ERR_T(err);
-	SEM_POST(openavbAdpSMAdvertiseInterfaceSemaphore, err);
-	SEM_LOG_ERR(err);
+	openavbAvdeccTaskSignal(&openavbAdpSMAdvertiseInterfaceTask);
 
 	AVB_TRACE_EXIT(AVB_TRACE_ADP);
 }
@@ -331,9 +331,7 @@ void openavbAdpSMAdvertiseInterfaceSet_linkIsUp(bool value)
 	AVB_TRACE_ENTRY(AVB_TRACE_ADP);
 	openavbAdpSMAdvertiseInterfaceVars.linkIsUp = value;
 
-	SEM_ERR_T(err);
-	SEM_POST(openavbAdpSMAdvertiseInterfaceSemaphore, err);
-	SEM_LOG_ERR(err);
+	openavbAvdeccTaskSignal(&openavbAdpSMAdvertiseInterfaceTask);
 
 	AVB_TRACE_EXIT(AVB_TRACE_ADP);
 }
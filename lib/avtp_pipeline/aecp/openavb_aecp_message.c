@@ -47,6 +47,7 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 
 #include "openavb_debug.h"
 #include "openavb_rawsock.h"
+#include "openavb_avdecc_engine.h"
 #include "openavb_avtp.h"
 #include "openavb_srp.h"
 #include "openavb_aecp.h"
@@ -78,10 +79,21 @@ THREAD_DEFINITON(openavbAecpMessageRxThread);
 
 static bool bRunning = FALSE;
 
+// Using the AVDECC engine's socket rather than our own
+static bool bEngine = FALSE;
+
 void openavbAecpCloseSocket()
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_AECP);
 
+	if (bEngine) {
+		// The socket belongs to the engine
+		txSock = NULL;
+		bEngine = FALSE;
+		AVB_TRACE_EXIT(AVB_TRACE_AECP);
+		return;
+	}
+
 	if (rxSock) {
 		openavbRawsockClose(rxSock);
 		rxSock = NULL;
@@ -100,6 +112,21 @@ bool openavbAecpOpenSocket(const char* ifname, U16 vlanID, U8 vlanPCP)
 
 	hdr_info_t hdr;
 
+	if (openavbAvdeccEngineIsRunning()) {
+		// Send on the AVDECC engine's socket. It receives for us as well.
+		bEngine = TRUE;
+		txSock = openavbAvdeccEngineTxSock();
+		if (txSock && openavbAvdeccEngineGetAddr(ADDR_PTR(&intfAddr))) {
+			AVB_TRACE_EXIT(AVB_TRACE_AECP);
+			return true;
+		}
+
+		AVB_LOG_ERROR("AVDECC engine socket not available");
+		openavbAecpCloseSocket();
+		AVB_TRACE_EXIT(AVB_TRACE_AECP);
+		return false;
+	}
+
 #ifndef UBUNTU
 	// This is the normal case for most of our supported platforms
 	rxSock = openavbRawsockOpen(ifname, TRUE, FALSE, ETHERTYPE_8021Q, AECP_FRAME_LEN, AECP_NUM_BUFFERS);
@@ -583,10 +610,12 @@ void openavbAecpMessageTxFrame(openavb_aecp_AEMCommandResponse_t *AEMCommandResp
 	U32 size;
 	unsigned int hdrlen = 0;
 
+	openavbAvdeccEngineTxLock();
 	pBuf = openavbRawsockGetTxFrame(txSock, TRUE, &size);
 
 	if (!pBuf) {
 		AVB_LOG_ERROR("No TX buffer");
+		openavbAvdeccEngineTxUnlock();
 		AVB_TRACE_EXIT(AVB_TRACE_AECP);
 		return;
 	}
@@ -594,6 +623,7 @@ void openavbAecpMessageTxFrame(openavb_aecp_AEMCommandResponse_t *AEMCommandResp
 	if (size < AECP_FRAME_LEN) {
 		AVB_LOG_ERROR("TX buffer too small");
 		openavbRawsockRelTxFrame(txSock, pBuf);
+		openavbAvdeccEngineTxUnlock();
 		pBuf = NULL;
 		AVB_TRACE_EXIT(AVB_TRACE_AECP);
 		return;
@@ -972,10 +1002,16 @@ void openavbAecpMessageTxFrame(openavb_aecp_AEMCommandResponse_t *AEMCommandResp
 
 	openavbRawsockTxFrameReady(txSock, pBuf, pDst - pBuf, 0);
 	openavbRawsockSend(txSock);
+	openavbAvdeccEngineTxUnlock();
 
 	AVB_TRACE_EXIT(AVB_TRACE_AECP);
 }
 
+static void openavbAecpMessageRxEngineCb(void *pv, U8 *payload, int payload_len, hdr_info_t *hdr)
+{
+	openavbAecpMessageRxFrameParse(payload, payload_len, hdr);
+}
+
 void* openavbAecpMessageRxThreadFn(void *pv)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_AECP);
@@ -999,6 +1035,16 @@ openavbRC openavbAecpMessageHandlerStart()
 
 	if (openavbAecpOpenSocket((const char *)gAvdeccCfg.ifname, gAvdeccCfg.vlanID, gAvdeccCfg.vlanPCP)) {
 
+		if (bEngine) {
+			// No RX thread; the engine hands us our PDUs
+			if (!openavbAvdeccEngineRegister(OPENAVB_AECP_AVTP_SUBTYPE, openavbAecpMessageRxEngineCb, NULL)) {
+				bRunning = FALSE;
+				openavbAecpCloseSocket();
+				AVB_RC_TRACE_RET(OPENAVB_AVDECC_FAILURE, AVB_TRACE_AECP);
+			}
+			AVB_RC_TRACE_RET(OPENAVB_AVDECC_SUCCESS, AVB_TRACE_AECP);
+		}
+
 		// Start the RX thread
 		bool errResult;
 		THREAD_CREATE(openavbAecpMessageRxThread, openavbAecpMessageRxThread, NULL, openavbAecpMessageRxThreadFn, NULL);
@@ -1022,7 +1068,12 @@ void openavbAecpMessageHandlerStop()
 
 	if (bRunning) {
 		bRunning = FALSE;
-		THREAD_JOIN(openavbAecpMessageRxThread, NULL);
+		if (bEngine) {
+			openavbAvdeccEngineUnregister(OPENAVB_AECP_AVTP_SUBTYPE, openavbAecpMessageRxEngineCb, NULL);
+		}
+		else {
+			THREAD_JOIN(openavbAecpMessageRxThread, NULL);
+		}
 		openavbAecpCloseSocket();
 	}
 
@@ -51,6 +51,7 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #include "openavb_list.h"
 
 #include "openavb_avdecc_pipeline_interaction_pub.h"
+#include "openavb_avdecc_engine.h"
 #include "openavb_aecp_cmd_get_counters.h"
 
 typedef enum {
@@ -74,7 +75,7 @@ MUTEX_HANDLE(openavbAecpSMMutex);
 #define AECP_SM_LOCK() { MUTEX_CREATE_ERR(); MUTEX_LOCK(openavbAecpSMMutex); MUTEX_LOG_ERR("Mutex lock failure"); }
 #define AECP_SM_UNLOCK() { MUTEX_CREATE_ERR(); MUTEX_UNLOCK(openavbAecpSMMutex); MUTEX_LOG_ERR("Mutex unlock failure"); }
 
-SEM_T(openavbAecpSMEntityModelEntityWaitingSemaphore);
+openavb_avdecc_task_t openavbAecpSMEntityModelEntityTask;
 THREAD_TYPE(openavbAecpSMEntityModelEntityThread);
 THREAD_DEFINITON(openavbAecpSMEntityModelEntityThread);
 
@@ -1153,6 +1154,8 @@ void openavbAecpSMEntityModelEntityStateMachine()
 	AVB_TRACE_ENTRY(AVB_TRACE_AECP);
 	bool bRunning = TRUE;
 
+	// The engine re-enters the state machine in the state it yielded from
+	bool bResume = openavbAvdeccTaskResumed(&openavbAecpSMEntityModelEntityTask);
 	openavb_aecp_sm_entity_model_entity_state_t state = OPENAVB_AECP_SM_ENTITY_MODEL_ENTITY_STATE_WAITING;
 
 	// Lock such that the mutex is held unless waiting for a semaphore. Synchronous processing of command responses.
@@ -1160,18 +1163,24 @@ void openavbAecpSMEntityModelEntityStateMachine()
 	while (bRunning) {
 		switch (state) {
 			case OPENAVB_AECP_SM_ENTITY_MODEL_ENTITY_STATE_WAITING:
-				AVB_LOG_DEBUG("State:  OPENAVB_AECP_SM_ENTITY_MODEL_ENTITY_STATE_WAITING");
-				openavbAecpSMEntityModelEntityVars.rcvdAEMCommand = FALSE;
-				openavbAecpSMEntityModelEntityVars.doUnsolicited = FALSE;
+				if (!bResume) {
+					AVB_LOG_DEBUG("State:  OPENAVB_AECP_SM_ENTITY_MODEL_ENTITY_STATE_WAITING");
+					openavbAecpSMEntityModelEntityVars.rcvdAEMCommand = FALSE;
+					openavbAecpSMEntityModelEntityVars.doUnsolicited = FALSE;
+				}
+				bResume = FALSE;
 
 				// Wait for a change in state
 				while (state == OPENAVB_AECP_SM_ENTITY_MODEL_ENTITY_STATE_WAITING && bRunning) {
 					AECP_SM_UNLOCK();
-					SEM_ERR_T(err);
-					SEM_WAIT(openavbAecpSMEntityModelEntityWaitingSemaphore, err);
+					openavb_avdecc_task_wait_t wait = openavbAvdeccTaskWait(&openavbAecpSMEntityModelEntityTask, OPENAVB_AVDECC_TASK_WAIT_FOREVER);
+					if (wait == OPENAVB_AVDECC_TASK_YIELD) {
+						AVB_TRACE_EXIT(AVB_TRACE_AECP);
+						return;
+					}
 					AECP_SM_LOCK();
 
-					if (SEM_IS_ERR_NONE(err)) {
+					if (wait == OPENAVB_AVDECC_TASK_WOKEN) {
 						if (openavbAecpSMEntityModelEntityVars.doTerminate) {
 							bRunning = FALSE;
 						}
@@ -1268,18 +1277,18 @@ void openavbAecpSMEntityModelEntityStart()
 	MUTEX_CREATE(openavbAecpSMMutex, mta);
 	MUTEX_LOG_ERR("Could not create/initialize 'openavbAecpSMMutex' mutex");
 
-	SEM_ERR_T(err);
-	SEM_INIT(openavbAecpSMEntityModelEntityWaitingSemaphore, 1, err);
-	SEM_LOG_ERR(err);
+	openavbAvdeccTaskInit(&openavbAecpSMEntityModelEntityTask, "AECP Entity Model Entity", openavbAecpSMEntityModelEntityThreadFn, NULL, 1);
 
 	// Initialize the linked list (queue).
 	s_commandQueue = openavbListNewList();
 
 	// Start the Advertise Entity State Machine
-	bool errResult;
-	THREAD_CREATE(openavbAecpSMEntityModelEntityThread, openavbAecpSMEntityModelEntityThread, NULL, openavbAecpSMEntityModelEntityThreadFn, NULL);
-	THREAD_CHECK_ERROR(openavbAecpSMEntityModelEntityThread, "Thread / task creation failed", errResult);
-	if (errResult);		// Already reported
+	if (!openavbAvdeccEngineAddTask(&openavbAecpSMEntityModelEntityTask)) {
+		bool errResult;
+		THREAD_CREATE(openavbAecpSMEntityModelEntityThread, openavbAecpSMEntityModelEntityThread, NULL, openavbAecpSMEntityModelEntityThreadFn, NULL);
+		THREAD_CHECK_ERROR(openavbAecpSMEntityModelEntityThread, "Thread / task creation failed", errResult);
+		if (errResult);		// Already reported
+	}
 
 	AVB_TRACE_EXIT(AVB_TRACE_AECP);
 }
@@ -1290,7 +1299,9 @@ void openavbAecpSMEntityModelEntityStop()
 
 	openavbAecpSMEntityModelEntitySet_doTerminate(TRUE);
 
-	THREAD_JOIN(openavbAecpSMEntityModelEntityThread, NULL);
+	if (!openavbAvdeccEngineRemoveTask(&openavbAecpSMEntityModelEntityTask)) {
+		THREAD_JOIN(openavbAecpSMEntityModelEntityThread, NULL);
+	}
 
 	// Delete the linked list (queue).
 	openavb_aecp_AEMCommandResponse_t *item;
@@ -1299,9 +1310,7 @@ void openavbAecpSMEntityModelEntityStop()
 	}
 	openavbListDeleteList(s_commandQueue);
 
-	SEM_ERR_T(err);
-	SEM_DESTROY(openavbAecpSMEntityModelEntityWaitingSemaphore, err);
-	SEM_LOG_ERR(err);
+	openavbAvdeccTaskDestroy(&openavbAecpSMEntityModelEntityTask);
 
 	MUTEX_CREATE_ERR();
 	MUTEX_DESTROY(openavbAecpQueueMutex);
@@ -1335,9 +1344,7 @@ void openavbAecpSMEntityModelEntitySet_rcvdCommand(openavb_aecp_AEMCommandRespon
 		AECP_SM_LOCK();
 		openavbAecpSMEntityModelEntityVars.rcvdAEMCommand = TRUE;
 
-		SEM_ERR_T(err);
-		SEM_POST(openavbAecpSMEntityModelEntityWaitingSemaphore, err);
-		SEM_LOG_ERR(err);
+		openavbAvdeccTaskSignal(&openavbAecpSMEntityModelEntityTask);
 		AECP_SM_UNLOCK();
 	}
 	else {
@@ -1355,9 +1362,7 @@ void openavbAecpSMEntityModelEntitySet_unsolicited(openavb_aecp_AEMCommandRespon
 	memcpy(&openavbAecpSMEntityModelEntityVars.unsolicited, unsolicited, sizeof(*unsolicited));
 	openavbAecpSMEntityModelEntityVars.doUnsolicited = TRUE;
 
-	SEM_ERR_T(err);
-	SEM_POST(openavbAecpSMEntityModelEntityWaitingSemaphore, err);
-	SEM_LOG_ERR(err);
+	openavbAvdeccTaskSignal(&openavbAecpSMEntityModelEntityTask);
 
 	AECP_SM_UNLOCK();
 	AVB_TRACE_EXIT(AVB_TRACE_AECP);
@@ -1369,9 +1374,7 @@ void openavbAecpSMEntityModelEntitySet_doTerminate(bool value)
 	AECP_SM_LOCK();
 	openavbAecpSMEntityModelEntityVars.doTerminate = value;
 
-	SEM_ERR_T(err);
-	SEM_POST(openavbAecpSMEntityModelEntityWaitingSemaphore, err);
-	SEM_LOG_ERR(err);
+	openavbAvdeccTaskSignal(&openavbAecpSMEntityModelEntityTask);
 
 	AECP_SM_UNLOCK();
 	AVB_TRACE_EXIT(AVB_TRACE_AECP);
@@ -46,6 +46,7 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #include "openavb_adp.h"
 #include "openavb_acmp.h"
 #include "openavb_aecp.h"
+#include "openavb_avdecc_engine.h"
 
 #include "openavb_endpoint.h"
 
@@ -463,16 +464,30 @@ extern DLL_EXPORT bool openavbAvdeccInitialize()
 // Start the AVDECC protocols.
 extern DLL_EXPORT bool openavbAvdeccStart()
 {
+	if (gAvdeccCfg.bSingleThreadEngine) {
+		// Must be running before the protocols open their sockets
+		if (!openavbAvdeccEngineStart(gAvdeccCfg.ifname, gAvdeccCfg.vlanID, gAvdeccCfg.vlanPCP)) {
+			AVB_LOG_ERROR("openavbAvdeccEngineStart() failure!");
+			return FALSE;
+		}
+	}
 	if (!openavbAvdeccStartCmp()) {
 		AVB_LOG_ERROR("openavbAvdeccStartCmp() failure!");
+		openavbAvdeccEngineStop();
 		return FALSE;
 	}
 	if (!openavbAvdeccStartEcp()) {
 		AVB_LOG_ERROR("openavbAvdeccStartEcp() failure!");
+		// The engine stops once the protocols using it are gone
+		openavbAvdeccStopCmp();
+		openavbAvdeccEngineStop();
 		return FALSE;
 	}
 	if (!openavbAvdeccStartAdp()) {
 		AVB_LOG_ERROR("openavbAvdeccStartAdp() failure!");
+		openavbAvdeccStopCmp();
+		openavbAvdeccStopEcp();
+		openavbAvdeccEngineStop();
 		return FALSE;
 	}
 
@@ -485,6 +500,7 @@ extern DLL_EXPORT void openavbAvdeccStop(void)
 	openavbAvdeccStopCmp();
 	openavbAvdeccStopEcp();
 	openavbAvdeccStopAdp();
+	openavbAvdeccEngineStop();
 }
 
 extern DLL_EXPORT bool openavbAvdeccCleanup(void)
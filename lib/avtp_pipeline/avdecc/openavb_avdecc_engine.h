@@ -0,0 +1,160 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* HEADER SUMMARY : Single-thread AVDECC protocol engine
+*
+* The engine owns one AVTP socket for ADP, ACMP and AECP. Its thread waits on
+* that socket and on a timer, hands each received AVDECC PDU to the handlers
+* registered for its subtype, and runs the protocol state machines as tasks.
+*
+* A task is a state machine function that, in its waiting state, calls
+* openavbAvdeccTaskWait() instead of blocking on a semaphore. Without the
+* engine the task has its own thread and the wait blocks, as before. With the
+* engine the wait returns OPENAVB_AVDECC_TASK_YIELD when nothing is pending;
+* the state machine then returns, and the engine calls it again when the task
+* is signalled or its timeout expires. openavbAvdeccTaskResumed() tells the
+* state machine it is being re-entered in its waiting state, so it can skip
+* the state's entry actions.
+*
+* Handlers and tasks take a context pointer, so several virtual entities can
+* share one engine.
+*/
+
+#ifndef OPENAVB_AVDECC_ENGINE_H
+#define OPENAVB_AVDECC_ENGINE_H 1
+
+#include "openavb_platform.h"
+#include "openavb_types.h"
+#include "openavb_rawsock.h"
+
+// Most subtype handlers registered at once
+#define OPENAVB_AVDECC_ENGINE_MAX_HANDLERS	16
+
+// Timeout for openavbAvdeccTaskWait() that never expires
+#define OPENAVB_AVDECC_TASK_WAIT_FOREVER	0xFFFFFFFF
+
+typedef enum {
+	OPENAVB_AVDECC_TASK_WOKEN,		// Signalled
+	OPENAVB_AVDECC_TASK_TIMEOUT,	// Timeout expired
+	OPENAVB_AVDECC_TASK_YIELD,		// Engine mode: return now, the engine resumes the task
+	OPENAVB_AVDECC_TASK_ERROR,
+} openavb_avdecc_task_wait_t;
+
+// Handler for a received AVDECC PDU. payload starts at the AVTP control header.
+typedef void (*openavb_avdecc_engine_rx_cb_t)(void *pv, U8 *payload, int payload_len, hdr_info_t *hdr);
+
+// State machine function of a task. Same signature as a thread function.
+typedef void *(*openavb_avdecc_task_fn_t)(void *pv);
+
+typedef struct openavb_avdecc_task {
+	const char *name;
+	openavb_avdecc_task_fn_t fn;
+	void *pv;
+
+	// Set at init: TRUE if the engine drives the task, FALSE for a thread
+	bool bEngine;
+
+	// Thread mode
+	SEM_T(sem)
+
+	// Engine mode, owned by the engine
+	U32 signals;
+	bool bStarted;
+	bool bYielded;
+	bool bResume;
+	bool bTimedOut;
+	bool bDeadline;
+	struct timespec deadline;
+	bool bDone;
+	SEM_T(doneSem)
+	struct openavb_avdecc_task *next;
+} openavb_avdecc_task_t;
+
+typedef struct {
+	U64 rxFrames;		// AVDECC PDUs received
+	U64 rxUnhandled;	// ... with no handler for the subtype
+	U64 wakeups;		// Times the engine thread woke up
+	U64 taskRuns;		// State machine calls
+} openavb_avdecc_engine_stats_t;
+
+// Open the socket on ifname and start the engine thread.
+bool openavbAvdeccEngineStart(const char *ifname, U16 vlanID, U8 vlanPCP);
+
+// Stop the engine thread and close the socket. Tasks and handlers must be removed first.
+void openavbAvdeccEngineStop(void);
+
+bool openavbAvdeccEngineIsRunning(void);
+
+// Address of the engine's interface.
+bool openavbAvdeccEngineGetAddr(U8 addr[ETH_ALEN]);
+
+// Deliver PDUs of an AVTP subtype to cb. Several handlers may share a subtype.
+bool openavbAvdeccEngineRegister(U8 subtype, openavb_avdecc_engine_rx_cb_t cb, void *pv);
+
+// Remove a handler. It is not running and will not be called once this returns.
+void openavbAvdeccEngineUnregister(U8 subtype, openavb_avdecc_engine_rx_cb_t cb, void *pv);
+
+// The shared TX rawsock. Its Ethernet header is set up for the AVDECC
+// multicast address; unicast senders overwrite the destination in the frame.
+void *openavbAvdeccEngineTxSock(void);
+
+// Serialize use of the shared TX rawsock. No-ops when the engine is not running.
+void openavbAvdeccEngineTxLock(void);
+void openavbAvdeccEngineTxUnlock(void);
+
+void openavbAvdeccEngineGetStats(openavb_avdecc_engine_stats_t *pStats);
+
+// Prepare a task. It is engine driven if the engine is running at this point.
+// initialSignals has the meaning of the initial semaphore count.
+void openavbAvdeccTaskInit(openavb_avdecc_task_t *pTask, const char *name, openavb_avdecc_task_fn_t fn, void *pv, U32 initialSignals);
+void openavbAvdeccTaskDestroy(openavb_avdecc_task_t *pTask);
+
+// Hand an engine mode task to the engine, which calls it right away.
+// Returns FALSE for a thread mode task; the caller starts its thread.
+bool openavbAvdeccEngineAddTask(openavb_avdecc_task_t *pTask);
+
+// Wait until an engine mode task has returned without yielding, after the
+// caller told it to terminate. Returns FALSE for a thread mode task; the
+// caller joins its thread.
+bool openavbAvdeccEngineRemoveTask(openavb_avdecc_task_t *pTask);
+
+// Wake the task. Counts like a semaphore post.
+void openavbAvdeccTaskSignal(openavb_avdecc_task_t *pTask);
+
+// Wait up to timeoutMSec for a signal. Thread mode blocks. Engine mode never
+// blocks; on OPENAVB_AVDECC_TASK_YIELD the state machine must return at once.
+openavb_avdecc_task_wait_t openavbAvdeccTaskWait(openavb_avdecc_task_t *pTask, U32 timeoutMSec);
+
+// TRUE if the engine is re-entering the task in the state it yielded from.
+bool openavbAvdeccTaskResumed(openavb_avdecc_task_t *pTask);
+
+#endif // OPENAVB_AVDECC_ENGINE_H
@@ -87,6 +87,8 @@ typedef struct {
 	char ifname[IFNAMSIZ + 10]; // Include space for the socket type prefix (e.g. "simple:eth0")
 	U8 ifmac[ETH_ALEN];
 
+	bool bSingleThreadEngine; // Run ADP, ACMP and AECP on one engine thread and socket
+
 	bool bListener;
 	bool bTalker;
 	bool bClassASupported;
@@ -75,9 +75,27 @@ static openavbRC openAvtpSock(avtp_stream_t *pStream)
 	if (pStream->rawsock != NULL) {
 		openavbSetRxSignalMode(pStream->rawsock, pStream->bRxSignalMode);
 
+		if (!pStream->tx && pStream->rxBusyPollUsec) {
+			// Let the kernel busy poll the device too; not fatal if not permitted
+			openavbRawsockSetRxBusyPoll(pStream->rawsock, pStream->rxBusyPollUsec);
+		}
+
+		if (pStream->tx && pStream->txLaunchTime) {
+			if (!openavbRawsockTxSetLaunchTime(pStream->rawsock, TRUE)) {
+				AVB_LOG_WARNING("TX launch time not supported by rawsock; sending frames immediately");
+				pStream->txLaunchTime = FALSE;
+			}
+		}
+
 		if (!pStream->tx) {
 			// Set the multicast address that we want to receive
 			openavbRawsockRxMulticast(pStream->rawsock, TRUE, pStream->dest_addr.ether_addr_octet);
+
+			if (pStream->rxStreamFilter
+				&& !openavbRawsockRxStreamID(pStream->rawsock, TRUE, pStream->streamIDnet)) {
+				AVB_LOG_WARNING("RX stream filter not supported by rawsock; filtering by address only");
+				pStream->rxStreamFilter = FALSE;
+			}
 		}
 		AVB_RC_RET(OPENAVB_AVTP_SUCCESS);
 	}
@@ -88,6 +106,7 @@ static openavbRC openAvtpSock(avtp_stream_t *pStream)
 
 // Evaluate the AVTP timestamp. Only valid for common AVTP stream subtypes
 #define HIDX_AVTP_HIDE7_TV1			1
+#define HIDX_AVTP_SEQ_NUM8			2
 #define HIDX_AVTP_HIDE7_TU1			3
 #define HIDX_AVTP_TIMESPAMP32		12
 static void processTimestampEval(avtp_stream_t *pStream, U8 *pHdr)
@@ -111,6 +130,41 @@ static void processTimestampEval(avtp_stream_t *pStream, U8 *pHdr)
 }
 
 
+// Fill the constant AVTP common header. Done once at TX init; the sequence
+// number is stamped per frame.
+static openavbRC fillAvtpHdr(avtp_stream_t *pStream, U8 *pFill)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_AVTP_DETAIL);
+
+	switch (pStream->pMapCB->map_avtp_version_cb()) {
+		default:
+			AVB_RC_LOG_RET(AVB_RC(OPENAVB_AVTP_FAILURE | OPENAVBAVTP_RC_INVALID_AVTP_VERSION));
+		case 0:
+			//
+			// - 1 bit 		cd (control/data indicator)	= 0 (stream data)
+			// - 7 bits 	subtype  					= as configured
+			*pFill++ = pStream->subtype & 0x7F;
+			// - 1 bit 		sv (stream valid)			= 1
+			// - 3 bits 	AVTP version				= binary 000
+			// - 1 bit		mr (media restart)			= toggled when clock changes
+			// - 1 bit		r (reserved)				= 0
+			// - 1 bit		gv (gateway valid)			= 0
+			// - 1 bit		tv (timestamp valid)		= 1
+			// TODO: set mr correctly
+			*pFill++ = 0x81;
+			// - 8 bits		sequence num				= stamped per frame
+			*pFill++ = 0;
+			// - 7 bits		reserved					= 0;
+			// - 1 bit		tu (timestamp uncertain)	= 1 when no PTP sync
+			// TODO: set tu correctly
+			*pFill++ = 0;
+			// - 8 bytes    stream_id
+			memcpy(pFill, (U8 *)&pStream->streamIDnet, 8);
+			break;
+	}
+	AVB_RC_TRACE_RET(OPENAVB_AVTP_SUCCESS, AVB_TRACE_AVTP_DETAIL);
+}
+
 /* Initialize AVTP for talking
  */
 openavbRC openavbAvtpTxInit(
@@ -199,6 +253,16 @@ openavbRC openavbAvtpTxInit(
         U16 *pStreamUID = (U16 *)((U8 *)(pStream->streamIDnet) + ETH_ALEN);
        *pStreamUID = htons(streamID->uniqueID);
 
+	// Build the header template copied into every frame we send
+	openavbRawsockTxFillHdr(pStream->rawsock, pStream->txHdrTemplate, &pStream->ethHdrLen);
+	rc = fillAvtpHdr(pStream, pStream->txHdrTemplate + pStream->ethHdrLen);
+	if (IS_OPENAVB_FAILURE(rc)) {
+		openavbRawsockClose(pStream->rawsock);
+		free(pStream);
+		AVB_RC_TRACE_RET(rc, AVB_TRACE_AVTP);
+	}
+	pStream->txHdrTemplateLen = pStream->ethHdrLen + AVTP_V0_HDR_LEN;
+
 	// Set the fwmark - used to steer packets into the right traffic control queue
 	openavbRawsockTxSetMark(pStream->rawsock, fwmark);
 
@@ -253,37 +317,22 @@ static void inline rxDeliveryStats(avtp_rx_info_t *rxInfo,
 }
 #endif
 
-static openavbRC fillAvtpHdr(avtp_stream_t *pStream, U8 *pFill)
+// Launch time for a TX frame: the presentation time in its AVTP timestamp less
+// max transit time. The 32 bit timestamp is extended against the current time.
+// Frames without a valid timestamp go with the last timestamped one. The time
+// is gPTP wall time; the rawsock converts it to the clock of its interface.
+static U64 txLaunchTimeNsec(avtp_stream_t *pStream, U8 *pHdr)
 {
-	AVB_TRACE_ENTRY(AVB_TRACE_AVTP_DETAIL);
+	if (pHdr[HIDX_AVTP_HIDE7_TV1] & 0x01) {
+		U32 ts = ntohl(*(U32 *)(&pHdr[HIDX_AVTP_TIMESPAMP32]));
+		U64 nowNS;
 
-	switch (pStream->pMapCB->map_avtp_version_cb()) {
-		default:
-			AVB_RC_LOG_RET(AVB_RC(OPENAVB_AVTP_FAILURE | OPENAVBAVTP_RC_INVALID_AVTP_VERSION));
-		case 0:
-			//
-			// - 1 bit 		cd (control/data indicator)	= 0 (stream data)
-			// - 7 bits 	subtype  					= as configured
-			*pFill++ = pStream->subtype & 0x7F;
-			// - 1 bit 		sv (stream valid)			= 1
-			// - 3 bits 	AVTP version				= binary 000
-			// - 1 bit		mr (media restart)			= toggled when clock changes
-			// - 1 bit		r (reserved)				= 0
-			// - 1 bit		gv (gateway valid)			= 0
-			// - 1 bit		tv (timestamp valid)		= 1
-			// TODO: set mr correctly
-			*pFill++ = 0x81;
-			// - 8 bits		sequence num				= increments with each frame
-			*pFill++ = pStream->avtp_sequence_num;
-			// - 7 bits		reserved					= 0;
-			// - 1 bit		tu (timestamp uncertain)	= 1 when no PTP sync
-			// TODO: set tu correctly
-			*pFill++ = 0;
-			// - 8 bytes    stream_id
-			memcpy(pFill, (U8 *)&pStream->streamIDnet, 8);
-			break;
+		if (CLOCK_GETTIME64(OPENAVB_CLOCK_WALLTIME, &nowNS)) {
+			U64 presentNS = nowNS + (S64)(S32)(ts - (U32)nowNS);
+			pStream->lastLaunchNS = presentNS - pStream->max_transit_usec * 1000;
+		}
 	}
-	AVB_RC_TRACE_RET(OPENAVB_AVTP_SUCCESS, AVB_TRACE_AVTP_DETAIL);
+	return pStream->lastLaunchNS;
 }
 
 /* Send a frame
@@ -297,7 +346,7 @@ openavbRC openavbAvtpTx(void *pv, bool bSend, bool txBlockingInIntf)
 		AVB_RC_LOG_TRACE_RET(AVB_RC(OPENAVB_AVTP_FAILURE | OPENAVB_RC_INVALID_ARGUMENT), AVB_TRACE_AVTP_DETAIL);
 	}
 
-	U8 * pAvtpFrame,*pFill;
+	U8 * pAvtpFrame;
 	U32 avtpFrameLen, frameLen;
 	tx_cb_ret_t txCBResult = TX_CB_RET_PACKET_NOT_READY;
 
@@ -309,21 +358,17 @@ openavbRC openavbAvtpTx(void *pv, bool bSend, bool txBlockingInIntf)
 		pStream->pBuf = (U8 *)openavbRawsockGetTxFrame(pStream->rawsock, TRUE, &frameLen);
 		if (pStream->pBuf) {
 			assert(frameLen >= pStream->frameLen);
-			// Fill in the Ethernet header
-			openavbRawsockTxFillHdr(pStream->rawsock, pStream->pBuf, &pStream->ethHdrLen);
 		}
 	}
 
 	if (pStream->pBuf) {
 		// AVTP frame starts right after the Ethernet header
-		pAvtpFrame = pFill = pStream->pBuf + pStream->ethHdrLen;
+		pAvtpFrame = pStream->pBuf + pStream->ethHdrLen;
 		avtpFrameLen = pStream->frameLen - pStream->ethHdrLen;
 
-		// Fill the AVTP Header. This must be done before calling the interface and mapping modules.
-		openavbRC rc = fillAvtpHdr(pStream, pFill);
-		if (IS_OPENAVB_FAILURE(rc)) {
-			AVB_RC_LOG_TRACE_RET(rc, AVB_TRACE_AVTP_DETAIL);
-		}
+		// Fill the Ethernet and AVTP headers from the template. This must be done before calling the interface and mapping modules.
+		memcpy(pStream->pBuf, pStream->txHdrTemplate, pStream->txHdrTemplateLen);
+		pAvtpFrame[HIDX_AVTP_SEQ_NUM8] = pStream->avtp_sequence_num;
 
 		U64 timeNsec = 0;
 
@@ -382,6 +427,10 @@ openavbRC openavbAvtpTx(void *pv, bool bSend, bool txBlockingInIntf)
 				processTimestampEval(pStream, pAvtpFrame);
 			}
 
+			if (pStream->txLaunchTime) {
+				timeNsec = txLaunchTimeNsec(pStream, pAvtpFrame);
+			}
+
 			// Increment the sequence number now that we are sure this is a good packet.
 			pStream->avtp_sequence_num++;
 			// Mark the frame "ready to send".
@@ -544,6 +593,65 @@ static void x_avtpRxFrame(avtp_stream_t *pStream, U8 *pFrame, U32 frameLen)
 	AVB_TRACE_EXIT(AVB_TRACE_AVTP_DETAIL);
 }
 
+/*
+ * Get a frame from the rawsock, waiting up to timeout usec.
+ *
+ * With busy polling configured, spin on the RX ring for up to rxBusyPollUsec
+ * before falling back to a blocking poll for the rest of the timeout. This
+ * trades CPU time for the scheduler wakeup latency of the blocking path.
+ */
+static U8 *x_avtpGetRxFrame(avtp_stream_t *pStream, U32 timeout, U32 *offsetToFrame, U32 *frameLen)
+{
+	if (pStream->rxBusyPollUsec) {
+		U64 startNS, nowNS, endNS;
+		U32 spinUsec = (timeout < pStream->rxBusyPollUsec) ? timeout : pStream->rxBusyPollUsec;
+
+		CLOCK_GETTIME64(OPENAVB_TIMER_CLOCK, &startNS);
+		nowNS = startNS;
+		endNS = startNS + ((U64)spinUsec * NANOSECONDS_PER_USEC);
+
+		bool bPending;
+		while (!(bPending = openavbRawsockRxFramePending(pStream->rawsock)) && nowNS < endNS) {
+			CLOCK_GETTIME64(OPENAVB_TIMER_CLOCK, &nowNS);
+		}
+
+		if (bPending) {
+			U8 *pBuf = (U8 *)openavbRawsockGetRxFrame(pStream->rawsock, OPENAVB_RAWSOCK_NONBLOCK, offsetToFrame, frameLen);
+			if (pBuf)
+				return pBuf;
+			CLOCK_GETTIME64(OPENAVB_TIMER_CLOCK, &nowNS);
+		}
+
+		U32 spentUsec = (U32)((nowNS - startNS) / NANOSECONDS_PER_USEC);
+		if (spentUsec >= timeout)
+			return NULL;
+		timeout -= spentUsec;
+		if (timeout < RAWSOCK_MIN_TIMEOUT_USEC)
+			timeout = RAWSOCK_MIN_TIMEOUT_USEC;
+	}
+
+	return (U8 *)openavbRawsockGetRxFrame(pStream->rawsock, timeout, offsetToFrame, frameLen);
+}
+
+// Record the time from frame arrival, as stamped by the rawsock, to now.
+static void x_avtpRxWakeLatency(avtp_stream_t *pStream, struct timespec *pRxTs)
+{
+	U64 nowNS, rxNS = ((U64)pRxTs->tv_sec * NANOSECONDS_PER_SECOND) + pRxTs->tv_nsec;
+	CLOCK_GETTIME64(OPENAVB_CLOCK_REALTIME, &nowNS);
+
+	// Ignore timestamps from another clock (or the future) rather than skew the stats
+	if (nowNS < rxNS || nowNS - rxNS >= NANOSECONDS_PER_SECOND)
+		return;
+
+	U32 usec = (U32)((nowNS - rxNS) / NANOSECONDS_PER_USEC);
+	if (pStream->rxWakeCount == 0 || usec < pStream->rxWakeMin)
+		pStream->rxWakeMin = usec;
+	if (usec > pStream->rxWakeMax)
+		pStream->rxWakeMax = usec;
+	pStream->rxWakeCount++;
+	pStream->rxWakeHist[(usec < AVTP_RX_WAKE_HIST_USEC) ? usec : AVTP_RX_WAKE_HIST_USEC]++;
+}
+
 /*
  * Try to receive some data.
  *
@@ -567,7 +675,7 @@ static void avtpTryRx(avtp_stream_t *pStream)
 		if (!openavbMediaQUsecTillTail(pStream->pMediaQ, &timeout)) {
 			// No mediaQ item available therefore wait for a new packet
 			timeout = AVTP_MAX_BLOCK_USEC;
-			pBuf = (U8 *)openavbRawsockGetRxFrame(pStream->rawsock, timeout, &offsetToFrame, &frameLen);
+			pBuf = x_avtpGetRxFrame(pStream, timeout, &offsetToFrame, &frameLen);
 			if (!pBuf) {
 				AVB_TRACE_EXIT(AVB_TRACE_AVTP_DETAIL);
 				return;
@@ -586,17 +694,22 @@ static void avtpTryRx(avtp_stream_t *pStream)
 			if (timeout < RAWSOCK_MIN_TIMEOUT_USEC)
 				timeout = RAWSOCK_MIN_TIMEOUT_USEC;
 
-			pBuf = (U8 *)openavbRawsockGetRxFrame(pStream->rawsock, timeout, &offsetToFrame, &frameLen);
+			pBuf = x_avtpGetRxFrame(pStream, timeout, &offsetToFrame, &frameLen);
 			if (!pBuf)
 				pStream->pIntfCB->intf_rx_cb(pStream->pMediaQ);
 		}
 	}
 
+	hdrInfo.ts.tv_sec = 0;
+	hdrInfo.ts.tv_nsec = 0;
 	hdrLen = openavbRawsockRxParseHdr(pStream->rawsock, pBuf, &hdrInfo);
 	if (hdrLen < 0) {
 		AVB_RC_LOG(AVB_RC(OPENAVB_AVTP_FAILURE | OPENAVBAVTP_RC_PARSING_FRAME_HEADER));
 	}
 	else {
+		if (hdrInfo.ts.tv_sec)
+			x_avtpRxWakeLatency(pStream, &hdrInfo.ts);
+
 		pAvtpPdu = pBuf + offsetToFrame + hdrLen;
 		avtpPduLen = frameLen - hdrLen;
 		x_avtpRxFrame(pStream, pAvtpPdu, avtpPduLen);
@@ -651,6 +764,63 @@ U64 openavbAvtpBytes(void *pv)
 	return bytes;
 }
 
+U32 openavbAvtpRxWakeLatency(void *pv, U32 *pMin, U32 *pP50, U32 *pP99, U32 *pMax)
+{
+	avtp_stream_t *pStream = (avtp_stream_t *)pv;
+	if (!pStream || pStream->rxWakeCount == 0) {
+		// Quietly return. Since this can be called before a stream is available.
+		return 0;
+	}
+
+	U32 count = pStream->rxWakeCount;
+	U32 p50Rank = (count + 1) / 2, p99Rank = count - (count / 100);
+	U32 seen = 0, i;
+
+	*pP50 = *pP99 = pStream->rxWakeMax;
+	for (i = 0; i < AVTP_RX_WAKE_HIST_USEC; i++) {
+		if (seen < p50Rank && seen + pStream->rxWakeHist[i] >= p50Rank)
+			*pP50 = i;
+		seen += pStream->rxWakeHist[i];
+		if (seen >= p99Rank) {
+			*pP99 = i;
+			break;
+		}
+	}
+	*pMin = pStream->rxWakeMin;
+	*pMax = pStream->rxWakeMax;
+
+	pStream->rxWakeMin = 0;
+	pStream->rxWakeMax = 0;
+	pStream->rxWakeCount = 0;
+	memset(pStream->rxWakeHist, 0, sizeof(pStream->rxWakeHist));
+	return count;
+}
+
+bool openavbAvtpRxFilterCounts(void *pv, U64 *pAccepted, U64 *pDropped, U32 *pDropStreams)
+{
+	avtp_stream_t *pStream = (avtp_stream_t *)pv;
+	if (!pStream || !pStream->rxStreamFilter || !pStream->rawsock) {
+		return FALSE;
+	}
+
+	rawsock_stream_count_t counts[AVTP_RX_FILTER_COUNTS];
+	int i, n;
+
+	*pAccepted = 0;
+	n = openavbRawsockRxStreamCounts(pStream->rawsock, FALSE, counts, AVTP_RX_FILTER_COUNTS);
+	for (i = 0; i < n; i++)
+		*pAccepted += counts[i].frames;
+
+	// Only the first AVTP_RX_FILTER_COUNTS stream_ids are summed; enough for a report
+	*pDropped = 0;
+	n = openavbRawsockRxStreamCounts(pStream->rawsock, TRUE, counts, AVTP_RX_FILTER_COUNTS);
+	for (i = 0; i < n; i++)
+		*pDropped += counts[i].frames;
+	*pDropStreams = n;
+
+	return TRUE;
+}
+
 openavbRC openavbAvtpRx(void *pv)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_AVTP_DETAIL);
@@ -693,6 +863,76 @@ void openavbAvtpConfigTimsstampEval(void *handle, U32 tsInterval, U32 reportInte
 	AVB_TRACE_EXIT(AVB_TRACE_AVTP);
 }
 
+void openavbAvtpConfigRxBusyPoll(void *handle, U32 busyPollUsec)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_AVTP);
+
+	avtp_stream_t *pStream = (avtp_stream_t *)handle;
+	if (!pStream) {
+		AVB_RC_LOG(AVB_RC(OPENAVB_AVTP_FAILURE | OPENAVB_RC_INVALID_ARGUMENT));
+		AVB_TRACE_EXIT(AVB_TRACE_AVTP);
+		return;
+	}
+
+	pStream->rxBusyPollUsec = busyPollUsec;
+	if (busyPollUsec && pStream->rawsock && !pStream->tx) {
+		openavbRawsockSetRxBusyPoll(pStream->rawsock, busyPollUsec);
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_AVTP);
+}
+
+void openavbAvtpConfigRxStreamFilter(void *handle, bool enable)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_AVTP);
+
+	avtp_stream_t *pStream = (avtp_stream_t *)handle;
+	if (!pStream || pStream->tx) {
+		AVB_RC_LOG(AVB_RC(OPENAVB_AVTP_FAILURE | OPENAVB_RC_INVALID_ARGUMENT));
+		AVB_TRACE_EXIT(AVB_TRACE_AVTP);
+		return;
+	}
+
+	// Turning it off takes effect when the socket is next opened
+	pStream->rxStreamFilter = enable;
+	if (enable && pStream->rawsock && !openavbRawsockRxStreamID(pStream->rawsock, TRUE, pStream->streamIDnet)) {
+		AVB_LOG_WARNING("RX stream filter not supported by rawsock; filtering by address only");
+		pStream->rxStreamFilter = FALSE;
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_AVTP);
+}
+
+void openavbAvtpConfigTxLaunchTime(void *handle, bool enable)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_AVTP);
+
+	avtp_stream_t *pStream = (avtp_stream_t *)handle;
+	if (!pStream || !pStream->tx) {
+		AVB_RC_LOG(AVB_RC(OPENAVB_AVTP_FAILURE | OPENAVB_RC_INVALID_ARGUMENT));
+		AVB_TRACE_EXIT(AVB_TRACE_AVTP);
+		return;
+	}
+
+	pStream->txLaunchTime = enable;
+	pStream->lastLaunchNS = 0;
+	if (pStream->rawsock && !openavbRawsockTxSetLaunchTime(pStream->rawsock, enable) && enable) {
+		AVB_LOG_WARNING("TX launch time not supported by rawsock; sending frames immediately");
+		pStream->txLaunchTime = FALSE;
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_AVTP);
+}
+
+unsigned long openavbAvtpTxLaunchMissed(void *handle)
+{
+	avtp_stream_t *pStream = (avtp_stream_t *)handle;
+	if (!pStream || !pStream->rawsock) {
+		return 0;
+	}
+	return openavbRawsockGetTXLaunchMissed(pStream->rawsock);
+}
+
 void openavbAvtpPause(void *handle, bool bPause)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_AVTP);
@@ -56,6 +56,7 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #define ETH_HDR_LEN_VLAN	18
 
 // AVTP Headers
+#define AVTP_V0_HDR_LEN					12
 #define AVTP_COMMON_STREAM_DATA_HDR_LEN	24
 
 //#define OPENAVB_AVTP_REPORT_RX_STATS 1
@@ -91,6 +92,12 @@ typedef struct {
  * now seen by the talker / listern module.
  * 
  */
+// Number of 1 usec buckets in the RX wake latency histogram
+#define AVTP_RX_WAKE_HIST_USEC 128
+
+// Other stream_ids summed in the stream filter report
+#define AVTP_RX_FILTER_COUNTS 64
+
 typedef struct
 {
 	// TX socket?
@@ -126,11 +133,22 @@ typedef struct
 	// MediaQ
 	media_q_t *pMediaQ;
 	bool bRxSignalMode;
+	// Time to spin on the RX ring before blocking in poll (usec); 0 to always block
+	U32 rxBusyPollUsec;
+	// Drop frames of other streams in the kernel (eBPF stream filter)
+	bool rxStreamFilter;
+	// Queue TX frames with a launch time (SO_TXTIME) derived from the AVTP timestamp
+	bool txLaunchTime;
+	// Launch time of the last timestamped frame; used for frames without one
+	U64 lastLaunchNS;
 
 	// TX frame buffer
 	U8* pBuf;
 	// Ethernet header length
 	U32 ethHdrLen;
+	// Ethernet and AVTP header built at TX init; copied into each frame before the sequence number is stamped
+	U8 txHdrTemplate[ETH_HDR_LEN_VLAN + AVTP_V0_HDR_LEN];
+	U32 txHdrTemplateLen;
 	
 	// Timestamp evaluation related
 	openavb_timestamp_eval_t tsEval;
@@ -140,6 +158,12 @@ typedef struct
 	int nLost;
 	// Bytes sent or recieved
 	U64 bytes;
+	// RX wake latency: frame arrival (rawsock RX timestamp) to processing, in usec
+	U32 rxWakeMin;
+	U32 rxWakeMax;
+	U32 rxWakeCount;
+	// Last bucket counts everything at or above AVTP_RX_WAKE_HIST_USEC
+	U32 rxWakeHist[AVTP_RX_WAKE_HIST_USEC + 1];
 	
 } avtp_stream_t;
 
@@ -176,6 +200,14 @@ openavbRC openavbAvtpRx(void *handle);
 
 void openavbAvtpConfigTimsstampEval(void *handle, U32 tsInterval, U32 reportInterval, bool smoothing, U32 tsMaxJitter, U32 tsMaxDrift);
 
+void openavbAvtpConfigRxBusyPoll(void *handle, U32 busyPollUsec);
+
+void openavbAvtpConfigTxLaunchTime(void *handle, bool enable);
+
+void openavbAvtpConfigRxStreamFilter(void *handle, bool enable);
+
+unsigned long openavbAvtpTxLaunchMissed(void *handle);
+
 void openavbAvtpPause(void *handle, bool bPause);
 
 void openavbAvtpShutdownTalker(void *handle);
@@ -189,4 +221,11 @@ int openavbAvtpLost(void *handle);
 
 U64 openavbAvtpBytes(void *handle);
 
+// RX wake latency since the last call, in usec. Returns the number of samples; 0 if none.
+U32 openavbAvtpRxWakeLatency(void *handle, U32 *pMin, U32 *pP50, U32 *pP99, U32 *pMax);
+
+// Frames passed and dropped by the kernel stream filter since the stream was opened,
+// and the number of other stream_ids seen. Returns FALSE if the filter is not in use.
+bool openavbAvtpRxFilterCounts(void *handle, U64 *pAccepted, U64 *pDropped, U32 *pDropStreams);
+
 #endif //AVB_AVTP_H
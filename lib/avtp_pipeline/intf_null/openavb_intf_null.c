@@ -39,9 +39,12 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include "openavb_types_pub.h"
 #include "openavb_trace_pub.h"
 #include "openavb_mediaq_pub.h"
+#include "openavb_map_uncmp_audio_pub.h"
+#include "openavb_map_aaf_audio_pub.h"
 #include "openavb_intf_pub.h"
 
 #define	AVB_LOG_COMPONENT	"Null Interface"
@@ -59,6 +62,21 @@ typedef struct {
 	/////////////
 } pvt_data_t;
 
+// Audio mapping modules size their media queue items from the audio
+// parameters the interface hands them, so a null sink on an audio stream
+// needs to be told what the stream carries.
+static bool xSupportedMappingFormat(media_q_t *pMediaQ)
+{
+	if (pMediaQ) {
+		if (pMediaQ->pMediaQDataFormat) {
+			if (strcmp(pMediaQ->pMediaQDataFormat, MapUncmpAudioMediaQDataFormat) == 0 || strcmp(pMediaQ->pMediaQDataFormat, MapAVTPAudioMediaQDataFormat) == 0) {
+				return TRUE;
+			}
+		}
+	}
+	return FALSE;
+}
+
 
 // Each configuration name value pair for this mapping will result in this callback being called.
 void openavbIntfNullCfgCB(media_q_t *pMediaQ, const char *name, const char *value) 
@@ -81,6 +99,60 @@ void openavbIntfNullCfgCB(media_q_t *pMediaQ, const char *name, const char *valu
 				pPvtData->ignoreTimestamp = (tmp == 1);
 			}
 		}
+		else if (xSupportedMappingFormat(pMediaQ)) {
+			media_q_pub_map_uncmp_audio_info_t *pPubMapUncmpAudioInfo;
+			pPubMapUncmpAudioInfo = (media_q_pub_map_uncmp_audio_info_t *)pMediaQ->pPubMapInfo;
+			if (!pPubMapUncmpAudioInfo) {
+				AVB_LOG_ERROR("Public map data for audio info not allocated.");
+				return;
+			}
+
+			if (strcmp(name, "intf_nv_audio_rate") == 0) {
+				tmp = strtol(value, &pEnd, 10);
+				if (*pEnd == '\0' && tmp >= AVB_AUDIO_RATE_8KHZ && tmp <= AVB_AUDIO_RATE_192KHZ) {
+					pPubMapUncmpAudioInfo->audioRate = (avb_audio_rate_t)tmp;
+				}
+				else {
+					AVB_LOG_ERROR("Invalid audio rate configured for intf_nv_audio_rate.");
+				}
+			}
+			else if (strcmp(name, "intf_nv_audio_bit_depth") == 0) {
+				tmp = strtol(value, &pEnd, 10);
+				if (*pEnd == '\0' && tmp >= AVB_AUDIO_BIT_DEPTH_1BIT && tmp <= AVB_AUDIO_BIT_DEPTH_64BIT) {
+					pPubMapUncmpAudioInfo->audioBitDepth = (avb_audio_bit_depth_t)tmp;
+				}
+				else {
+					AVB_LOG_ERROR("Invalid audio bit depth configured for intf_nv_audio_bit_depth.");
+				}
+			}
+			else if (strcmp(name, "intf_nv_audio_channels") == 0) {
+				tmp = strtol(value, &pEnd, 10);
+				if (*pEnd == '\0' && tmp >= AVB_AUDIO_CHANNELS_1) {
+					pPubMapUncmpAudioInfo->audioChannels = (avb_audio_channels_t)tmp;
+				}
+				else {
+					AVB_LOG_ERROR("Invalid audio channels configured for intf_nv_audio_channels.");
+				}
+			}
+			else if (strcmp(name, "intf_nv_audio_type") == 0) {
+				if (strncasecmp(value, "float", 5) == 0)
+					pPubMapUncmpAudioInfo->audioType = AVB_AUDIO_TYPE_FLOAT;
+				else if (strncasecmp(value, "sign", 4) == 0 || strncasecmp(value, "int", 4) == 0)
+					pPubMapUncmpAudioInfo->audioType = AVB_AUDIO_TYPE_INT;
+				else if (strncasecmp(value, "unsign", 6) == 0 || strncasecmp(value, "uint", 4) == 0)
+					pPubMapUncmpAudioInfo->audioType = AVB_AUDIO_TYPE_UINT;
+				else
+					AVB_LOG_ERROR("Invalid audio type configured for intf_nv_audio_type.");
+			}
+			else if (strcmp(name, "intf_nv_audio_endian") == 0) {
+				if (strncasecmp(value, "big", 3) == 0)
+					pPubMapUncmpAudioInfo->audioEndian = AVB_AUDIO_ENDIAN_BIG;
+				else if (strncasecmp(value, "little", 6) == 0)
+					pPubMapUncmpAudioInfo->audioEndian = AVB_AUDIO_ENDIAN_LITTLE;
+				else
+					AVB_LOG_ERROR("Invalid audio endian configured for intf_nv_audio_endian.");
+			}
+		}
 	}
 
 	AVB_TRACE_EXIT(AVB_TRACE_INTF);
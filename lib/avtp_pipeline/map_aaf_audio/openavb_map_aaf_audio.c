@@ -64,6 +64,15 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 // - 1 Byte - TU bit (timestamp uncertain)
 #define HIDX_AVTP_HIDE7_TU1			3
 
+// - 4 bytes	avtp_timestamp
+#define HIDX_AVTP_TIMESTAMP32		12
+
+// - 4 bytes	format info (format, sample rate, channels per frame, bit depth)
+#define HIDX_FORMAT_INFO32			16
+
+// - 4 bytes	packet info (data length, evt field)
+#define HIDX_PACKET_INFO32			20
+
 // - 2 bytes	Stream data length
 #define HIDX_STREAM_DATA_LEN16		20
 
@@ -155,6 +164,9 @@ typedef struct {
 
 	bool mediaQItemSyncTS;
 
+	// Header built at TX init. Only the bytes after the AVTP common header are used.
+	U8 txHdrTemplate[TOTAL_HEADER_SIZE];
+
 } pvt_data_t;
 
 static void x_calculateSizes(media_q_t *pMediaQ)
@@ -448,9 +460,30 @@ void openavbMapAVTPAudioTxInitCB(media_q_t *pMediaQ)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_MAP);
 	if (pMediaQ) {
+		media_q_pub_map_aaf_audio_info_t *pPubMapInfo = pMediaQ->pPubMapInfo;
 		pvt_data_t *pPvtData = pMediaQ->pPvtMapInfo;
 		if (pPvtData) {
 			pPvtData->isTalker = TRUE;
+
+			// Build the constant part of the AAF header once. The TX callback copies
+			// it into each packet and only sets the timestamp and TV/TU bits.
+			U8 *pHdr = pPvtData->txHdrTemplate;
+			U32 tmp32;
+			memset(pHdr, 0, sizeof(pPvtData->txHdrTemplate));
+
+			tmp32 = pPvtData->aaf_format << 24;
+			tmp32 |= pPvtData->aaf_rate  << 20;
+			tmp32 |= pPubMapInfo->audioChannels << 8;
+			tmp32 |= pPvtData->aaf_bit_depth;
+			*(U32 *)(&pHdr[HIDX_FORMAT_INFO32]) = htonl(tmp32);
+
+			tmp32 = pPvtData->payloadSize << 16;
+			tmp32 |= pPvtData->aaf_event_field << 8;
+			*(U32 *)(&pHdr[HIDX_PACKET_INFO32]) = htonl(tmp32);
+
+			if (pPvtData->sparseMode == TS_SPARSE_MODE_ENABLED) {
+				pHdr[HIDX_AVTP_HIDE7_SP] |= SP_M0_BIT;
+			}
 		}
 	}
 	AVB_TRACE_EXIT(AVB_TRACE_MAP);
@@ -501,11 +534,12 @@ tx_cb_ret_t openavbMapAVTPAudioTxCB(media_q_t *pMediaQ, U8 *pData, U32 *dataLen)
 		return TX_CB_RET_PACKET_NOT_READY;
 	}
 
-	U32 tmp32;
 	U8 *pHdrV0 = pData;
-	U32 *pHdr = (U32 *)(pData + AVTP_V0_HEADER_SIZE);
 	U8  *pPayload = pData + TOTAL_HEADER_SIZE;
 
+	// AAF header from the template; the timestamp is set below.
+	memcpy(&pHdrV0[AVTP_V0_HEADER_SIZE], &pPvtData->txHdrTemplate[AVTP_V0_HEADER_SIZE], AAF_HEADER_SIZE);
+
 	U32 bytesProcessed = 0;
 	while (bytesProcessed < bytesNeeded) {
 		pMediaQItem = openavbMediaQTailLock(pMediaQ, TRUE);
@@ -517,14 +551,12 @@ tx_cb_ret_t openavbMapAVTPAudioTxCB(media_q_t *pMediaQ, U8 *pData, U32 *dataLen)
 				// Skip over this timestamp, as using sparse mode.
 				pHdrV0[HIDX_AVTP_HIDE7_TV1] &= ~0x01;
 				pHdrV0[HIDX_AVTP_HIDE7_TU1] &= ~0x01;
-				*pHdr++ = 0; // Clear the timestamp field
 			}
 			else if (!openavbAvtpTimeTimestampIsValid(pMediaQItem->pAvtpTime)) {
 				// Error getting the timestamp.  Clear timestamp valid flag.
 				AVB_LOG_ERROR("Unable to get the timestamp value");
 				pHdrV0[HIDX_AVTP_HIDE7_TV1] &= ~0x01;
 				pHdrV0[HIDX_AVTP_HIDE7_TU1] &= ~0x01;
-				*pHdr++ = 0; // Clear the timestamp field
 			}
 			else {
 				// Add the max transit time.
@@ -539,30 +571,11 @@ tx_cb_ret_t openavbMapAVTPAudioTxCB(media_q_t *pMediaQ, U8 *pData, U32 *dataLen)
 				else pHdrV0[HIDX_AVTP_HIDE7_TU1] &= ~0x01;
 
 				// - 4 bytes	avtp_timestamp
-				*pHdr++ = htonl(openavbAvtpTimeGetAvtpTimestamp(pMediaQItem->pAvtpTime));
+				*(U32 *)(&pHdrV0[HIDX_AVTP_TIMESTAMP32]) = htonl(openavbAvtpTimeGetAvtpTimestamp(pMediaQItem->pAvtpTime));
 
 				openavbAvtpTimeSetTimestampValid(pMediaQItem->pAvtpTime, FALSE);
 			}
 
-			// - 4 bytes	format info (format, sample rate, channels per frame, bit depth)
-			tmp32 = pPvtData->aaf_format << 24;
-			tmp32 |= pPvtData->aaf_rate  << 20;
-			tmp32 |= pPubMapInfo->audioChannels << 8;
-			tmp32 |= pPvtData->aaf_bit_depth;
-			*pHdr++ = htonl(tmp32);
-
-			// - 4 bytes	packet info (data length, evt field)
-			tmp32 = pPvtData->payloadSize << 16;
-			tmp32 |= pPvtData->aaf_event_field << 8;
-			*pHdr++ = htonl(tmp32);
-
-			// Set (clear) sparse mode flag
-			if (pPvtData->sparseMode == TS_SPARSE_MODE_ENABLED) {
-				pHdrV0[HIDX_AVTP_HIDE7_SP] |= SP_M0_BIT;
-			} else {
-				pHdrV0[HIDX_AVTP_HIDE7_SP] &= ~SP_M0_BIT;
-			}
-
 			if ((pMediaQItem->dataLen - pMediaQItem->readIdx) < pPvtData->payloadSize) {
 				// This should not happen so we will just toss it away.
 				AVB_LOG_ERROR("Not enough data in media queue item for packet");
@@ -0,0 +1,351 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* MODULE SUMMARY : H.264 access unit packetization (RFC 6184 single NAL unit,
+* STAP-A and FU-A payloads) for the H.264 mapping.
+*
+* The packetizer finds the NAL units of an Annex B access unit one at a time:
+* when a NAL unit is started, the following start code is located with memchr()
+* on its 0x01 byte, so each byte of the access unit is looked at once however
+* many fragments the NAL unit is split into.
+*/
+
+#include <string.h>
+#include "openavb_h264_fua.h"
+
+// Find the next start code (0x000001) at or after from + 2. Returns the offset
+// just past it, auLen if there is none. *pCodeStart gets the offset of its first
+// byte, with any zero bytes in front of it (zero_byte, trailing_zero_8bits)
+// counted as part of the start code; auLen if there is none.
+static U32 findStartCode(const U8 *pAu, U32 auLen, U32 from, U32 *pCodeStart)
+{
+	U32 pos = from + 2;
+
+	while (pos < auLen) {
+		// memchr() is vectorized in any current libc, and 0x01 bytes are rare
+		// enough in slice data that it runs in long strides.
+		const U8 *pOne = memchr(pAu + pos, 0x01, auLen - pos);
+		if (!pOne) {
+			break;
+		}
+		pos = pOne - pAu;
+		if (pAu[pos - 1] == 0x00 && pAu[pos - 2] == 0x00) {
+			U32 start = pos - 2;
+			while (start > from && pAu[start - 1] == 0x00) {
+				start--;
+			}
+			*pCodeStart = start;
+			return pos + 1;
+		}
+		pos++;
+	}
+
+	*pCodeStart = auLen;
+	return auLen;
+}
+
+// Make the NAL unit starting at offset the current one
+static void txSetNal(openavb_h264_fua_tx_t *pTx, U32 offset)
+{
+	U32 end;
+
+	pTx->nalOffset = offset;
+	pTx->nextOffset = findStartCode(pTx->pAu, pTx->auLen, offset, &end);
+	// A NAL unit never ends in a zero byte, so zeros at the end of the access
+	// unit are trailing_zero_8bits
+	while (end > offset && pTx->pAu[end - 1] == 0x00) {
+		end--;
+	}
+	pTx->nalLen = end - offset;
+	pTx->nalSent = 0;
+}
+
+// Move to the next non-empty NAL unit, or finish the access unit
+static void txNextNal(openavb_h264_fua_tx_t *pTx)
+{
+	while (pTx->nextOffset < pTx->auLen) {
+		txSetNal(pTx, pTx->nextOffset);
+		if (pTx->nalLen > 0) {
+			return;
+		}
+	}
+	pTx->done = TRUE;
+}
+
+void openavbH264FuaTxStart(openavb_h264_fua_tx_t *pTx, const U8 *pAu, U32 auLen)
+{
+	U32 codeStart;
+	U32 first;
+
+	memset(pTx, 0, sizeof(*pTx));
+	pTx->pAu = pAu;
+	pTx->auLen = auLen;
+
+	if (!pAu || auLen == 0) {
+		pTx->done = TRUE;
+		return;
+	}
+
+	first = findStartCode(pAu, auLen, 0, &codeStart);
+	if (codeStart >= auLen) {
+		// No start code, the whole buffer is one NAL unit
+		pTx->nalLen = auLen;
+		pTx->nextOffset = auLen;
+		return;
+	}
+
+	// Anything in front of the first start code is not part of a NAL unit
+	pTx->nextOffset = first;
+	txNextNal(pTx);
+}
+
+U32 openavbH264FuaTxNext(openavb_h264_fua_tx_t *pTx, U8 *pDst, U32 maxLen, bool *pLast)
+{
+	const U8 *pNal;
+	U32 len;
+
+	if (pTx->done || maxLen <= H264_FU_A_HEADER_SIZE) {
+		if (pLast) {
+			*pLast = pTx->done;
+		}
+		return 0;
+	}
+
+	pNal = pTx->pAu + pTx->nalOffset;
+	if (pTx->nalSent == 0 && pTx->nalLen <= maxLen) {
+		// Single NAL unit packet
+		memcpy(pDst, pNal, pTx->nalLen);
+		len = pTx->nalLen;
+		pTx->nalSent = pTx->nalLen;
+	}
+	else {
+		// FU-A. The NAL unit header is carried in the FU indicator (F, NRI)
+		// and FU header (type), so the first fragment starts after it.
+		bool start = (pTx->nalSent == 0);
+		U32 chunk;
+
+		if (start) {
+			pTx->nalSent = 1;
+		}
+		chunk = pTx->nalLen - pTx->nalSent;
+		if (chunk > maxLen - H264_FU_A_HEADER_SIZE) {
+			chunk = maxLen - H264_FU_A_HEADER_SIZE;
+		}
+
+		pDst[0] = (pNal[0] & 0xE0) | H264_NAL_TYPE_FU_A;
+		pDst[1] = (pNal[0] & 0x1F);
+		if (start) {
+			pDst[1] |= 0x80;
+		}
+		if (pTx->nalSent + chunk == pTx->nalLen) {
+			pDst[1] |= 0x40;
+		}
+		memcpy(pDst + H264_FU_A_HEADER_SIZE, pNal + pTx->nalSent, chunk);
+		pTx->nalSent += chunk;
+		len = chunk + H264_FU_A_HEADER_SIZE;
+	}
+
+	if (pTx->nalSent == pTx->nalLen) {
+		txNextNal(pTx);
+	}
+	if (pLast) {
+		*pLast = pTx->done;
+	}
+	return len;
+}
+
+bool openavbH264FuaTxDone(const openavb_h264_fua_tx_t *pTx)
+{
+	return pTx->done;
+}
+
+// Drop the partly written NAL unit of an unfinished FU-A
+static void rxAbortFu(openavb_h264_fua_rx_t *pRx)
+{
+	if (pRx->inFu) {
+		pRx->len = pRx->fuStart;
+		pRx->nalUnits--;
+		pRx->inFu = FALSE;
+		pRx->status |= H264_AU_FU_INCOMPLETE;
+	}
+}
+
+// Write a start code and the first len bytes of a NAL unit
+static bool rxPutNal(openavb_h264_fua_rx_t *pRx, U8 nalHdr, const U8 *pData, U32 len)
+{
+	U8 *pDst;
+
+	if (pRx->len + H264_START_CODE_SIZE + 1 + len > pRx->bufSize) {
+		pRx->status |= H264_AU_OVERFLOW;
+		return FALSE;
+	}
+
+	pDst = pRx->pBuf + pRx->len;
+	pDst[0] = 0x00;
+	pDst[1] = 0x00;
+	pDst[2] = 0x00;
+	pDst[3] = 0x01;
+	pDst[4] = nalHdr;
+	memcpy(pDst + H264_START_CODE_SIZE + 1, pData, len);
+	pRx->len += H264_START_CODE_SIZE + 1 + len;
+	pRx->nalUnits++;
+	return TRUE;
+}
+
+void openavbH264FuaRxStart(openavb_h264_fua_rx_t *pRx, U8 *pBuf, U32 bufSize)
+{
+	memset(pRx, 0, sizeof(*pRx));
+	pRx->pBuf = pBuf;
+	pRx->bufSize = pBuf ? bufSize : 0;
+}
+
+bool openavbH264FuaRxAdd(openavb_h264_fua_rx_t *pRx, const U8 *pPayload, U32 len)
+{
+	U8 type;
+
+	pRx->packets++;
+	if (!pPayload || len == 0) {
+		pRx->status |= H264_AU_BAD_PAYLOAD;
+		return FALSE;
+	}
+
+	type = pPayload[0] & 0x1F;
+
+	if (type >= 1 && type <= 23) {
+		// Single NAL unit packet
+		rxAbortFu(pRx);
+		pRx->skipFu = FALSE;
+		return rxPutNal(pRx, pPayload[0], pPayload + 1, len - 1);
+	}
+
+	if (type == H264_NAL_TYPE_STAP_A) {
+		U32 pos = 1;
+
+		rxAbortFu(pRx);
+		pRx->skipFu = FALSE;
+		while (pos < len) {
+			U32 size;
+
+			if (pos + 2 > len) {
+				pRx->status |= H264_AU_BAD_PAYLOAD;
+				return FALSE;
+			}
+			size = (pPayload[pos] << 8) | pPayload[pos + 1];
+			pos += 2;
+			if (size == 0 || pos + size > len) {
+				pRx->status |= H264_AU_BAD_PAYLOAD;
+				return FALSE;
+			}
+			if (!rxPutNal(pRx, pPayload[pos], pPayload + pos + 1, size - 1)) {
+				return FALSE;
+			}
+			pos += size;
+		}
+		return TRUE;
+	}
+
+	if (type == H264_NAL_TYPE_FU_A) {
+		bool start, end;
+		U32 dataLen;
+
+		if (len <= H264_FU_A_HEADER_SIZE) {
+			pRx->status |= H264_AU_BAD_PAYLOAD;
+			return FALSE;
+		}
+		start = (pPayload[1] & 0x80) ? TRUE : FALSE;
+		end = (pPayload[1] & 0x40) ? TRUE : FALSE;
+		dataLen = len - H264_FU_A_HEADER_SIZE;
+
+		if (start) {
+			rxAbortFu(pRx);
+			pRx->skipFu = FALSE;
+			pRx->fuStart = pRx->len;
+			if (!rxPutNal(pRx, (pPayload[0] & 0xE0) | (pPayload[1] & 0x1F), pPayload + H264_FU_A_HEADER_SIZE, dataLen)) {
+				pRx->skipFu = !end;
+				return FALSE;
+			}
+			pRx->inFu = !end;
+			return TRUE;
+		}
+
+		if (!pRx->inFu) {
+			// Start fragment missing. Flag it once and skip up to the end fragment.
+			if (!pRx->skipFu) {
+				pRx->status |= H264_AU_FU_INCOMPLETE;
+			}
+			pRx->skipFu = !end;
+			return FALSE;
+		}
+
+		if (pRx->len + dataLen > pRx->bufSize) {
+			pRx->len = pRx->fuStart;
+			pRx->nalUnits--;
+			pRx->inFu = FALSE;
+			pRx->skipFu = !end;
+			pRx->status |= H264_AU_OVERFLOW;
+			return FALSE;
+		}
+		memcpy(pRx->pBuf + pRx->len, pPayload + H264_FU_A_HEADER_SIZE, dataLen);
+		pRx->len += dataLen;
+		if (end) {
+			pRx->inFu = FALSE;
+		}
+		return TRUE;
+	}
+
+	// FU-B, MTAP and reserved types are not used for CVF H.264
+	rxAbortFu(pRx);
+	pRx->status |= H264_AU_BAD_PAYLOAD;
+	return FALSE;
+}
+
+void openavbH264FuaRxMarkLost(openavb_h264_fua_rx_t *pRx)
+{
+	if (pRx->inFu) {
+		// The rest of this NAL unit can't be trusted
+		pRx->len = pRx->fuStart;
+		pRx->nalUnits--;
+		pRx->inFu = FALSE;
+		pRx->skipFu = TRUE;
+	}
+	pRx->status |= H264_AU_PACKET_LOST;
+}
+
+U32 openavbH264FuaRxEnd(openavb_h264_fua_rx_t *pRx, U32 *pStatus)
+{
+	rxAbortFu(pRx);
+	pRx->skipFu = FALSE;
+	if (pStatus) {
+		*pStatus = pRx->status;
+	}
+	return pRx->len;
+}
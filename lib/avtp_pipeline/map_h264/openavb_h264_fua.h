@@ -0,0 +1,118 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* HEADER SUMMARY : H.264 access unit packetization for the H.264 mapping.
+*
+* Splits an H.264 access unit into RTP payloads as defined in RFC 6184 and
+* rebuilds access units from them. The TX side takes an Annex B byte stream
+* (start code prefixed NAL units) and writes one payload at a time directly
+* into the caller's buffer: a single NAL unit packet when the NAL unit fits,
+* FU-A fragments when it doesn't. The RX side accepts single NAL unit, STAP-A
+* and FU-A payloads and writes the NAL units back as one contiguous Annex B
+* access unit, tracking anything that leaves the access unit incomplete.
+*
+* Neither side allocates or keeps pointers past the access unit they were
+* started on, so the state can live in the mapping private data.
+*/
+
+#ifndef OPENAVB_H264_FUA_H
+#define OPENAVB_H264_FUA_H 1
+
+#include "openavb_types_pub.h"
+#include "openavb_map_h264_pub.h"
+
+// RFC 6184 NAL unit types used by the packetizer
+#define H264_NAL_TYPE_STAP_A		24
+#define H264_NAL_TYPE_FU_A			28
+
+// FU indicator and FU header bytes in front of each fragment
+#define H264_FU_A_HEADER_SIZE		2
+
+// Start code written in front of each reassembled NAL unit
+#define H264_START_CODE_SIZE		4
+
+typedef struct {
+	const U8 *pAu;
+	U32 auLen;
+	// Current NAL unit, without start code
+	U32 nalOffset;
+	U32 nalLen;
+	// Bytes of the current NAL unit already sent. 0 until its first packet.
+	U32 nalSent;
+	// Start of the NAL unit after the current one, auLen if none
+	U32 nextOffset;
+	bool done;
+} openavb_h264_fua_tx_t;
+
+typedef struct {
+	U8 *pBuf;
+	U32 bufSize;
+	U32 len;
+	// Inside a FU-A whose start fragment was written at fuStart
+	bool inFu;
+	U32 fuStart;
+	// Skipping the rest of a FU-A that couldn't be written
+	bool skipFu;
+	U32 packets;
+	U32 nalUnits;
+	// openavb_h264_au_status_t flags
+	U32 status;
+} openavb_h264_fua_rx_t;
+
+// Start packetizing the Annex B access unit at pAu. Data without a start code
+// is taken as a single NAL unit. The data must stay valid until the access
+// unit is done.
+void openavbH264FuaTxStart(openavb_h264_fua_tx_t *pTx, const U8 *pAu, U32 auLen);
+
+// Write the next RTP payload of the access unit into pDst, at most maxLen bytes
+// (maxLen > H264_FU_A_HEADER_SIZE). Returns the payload length, 0 once the
+// access unit is done. *pLast is set TRUE for the final payload.
+U32 openavbH264FuaTxNext(openavb_h264_fua_tx_t *pTx, U8 *pDst, U32 maxLen, bool *pLast);
+
+// TRUE once every NAL unit of the access unit was returned
+bool openavbH264FuaTxDone(const openavb_h264_fua_tx_t *pTx);
+
+// Start reassembling an access unit into pBuf
+void openavbH264FuaRxStart(openavb_h264_fua_rx_t *pRx, U8 *pBuf, U32 bufSize);
+
+// Append one RTP payload. Returns FALSE if the payload couldn't be used, in
+// which case the reason is added to the status flags.
+bool openavbH264FuaRxAdd(openavb_h264_fua_rx_t *pRx, const U8 *pPayload, U32 len);
+
+// Flag the access unit as damaged by a lost packet
+void openavbH264FuaRxMarkLost(openavb_h264_fua_rx_t *pRx);
+
+// Finish the access unit. Returns its length in the buffer; *pStatus gets the
+// openavb_h264_au_status_t flags, H264_AU_OK if it is complete.
+U32 openavbH264FuaRxEnd(openavb_h264_fua_rx_t *pRx, U32 *pStatus);
+
+#endif // OPENAVB_H264_FUA_H
@@ -53,6 +53,7 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #include "openavb_mediaq_pub.h"
 #include "openavb_map_pub.h"
 #include "openavb_map_h264_pub.h"
+#include "openavb_h264_fua.h"
 
 #define	AVB_LOG_COMPONENT	"H.264 Mapping"
 #include "openavb_log_pub.h"
@@ -65,6 +66,10 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 
 #define MAX_PAYLOAD_SIZE 1416
 
+// Default media queue item size in access unit mode. Large enough for intra
+// coded 4K frames at common bit rates.
+#define DEFAULT_AU_ITEM_SIZE		(1024 * 1024)
+
 //////
 // AVTP Version 0 Header
 //////
@@ -75,6 +80,9 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 // - 1 Byte - TV bit (timestamp valid)
 #define HIDX_AVTP_HIDE7_TV1			1
 
+// - 1 Byte - Sequence number
+#define HIDX_AVTP_SEQ_NUM8			2
+
 // - 1 Byte - TU bit (timestamp uncertain)
 #define HIDX_AVTP_HIDE7_TU1			3
 
@@ -128,6 +136,12 @@ typedef struct {
 	// Max payload size
 	U32 maxPayloadSize;
 
+	// map_nv_access_unit: media queue items hold whole access units
+	bool accessUnitMode;
+
+	// map_nv_item_size: media queue item size in access unit mode
+	U32 auItemSize;
+
 	/////////////
 	// Variable data
 	/////////////
@@ -140,6 +154,21 @@ typedef struct {
 	// Maximum media queue item size
 	U32 itemSize;
 
+	// Access unit mode TX: packetizer for the item at the tail of the media queue,
+	// working on the item data up to txSpanEnd
+	openavb_h264_fua_tx_t fuaTx;
+	bool txActive;
+	U32 txSpanEnd;
+
+	// Access unit mode RX: access unit being rebuilt in the item at the head of the media queue
+	openavb_h264_fua_rx_t fuaRx;
+	bool rxActive;
+	U8 rxNextSeq;
+	bool rxSeqValid;
+	// Packets of the next access unit were lost before it was started
+	bool rxLostPending;
+	U32 rxDamagedAUs;
+
 } pvt_data_t;
 
 
@@ -175,6 +204,18 @@ void openavbMapH264CfgCB(media_q_t *pMediaQ, const char *name, const char *value
 			pPvtData->maxDataSize = (pPvtData->maxPayloadSize + TOTAL_HEADER_SIZE);
 			pPvtData->itemSize =	pPvtData->maxPayloadSize;
 		}
+		else if (strcmp(name, "map_nv_access_unit") == 0) {
+			U32 tmp = strtol(value, &pEnd, 10);
+			if (*pEnd == '\0' && (tmp == 0 || tmp == 1)) {
+				pPvtData->accessUnitMode = (tmp == 1);
+			}
+			else {
+				AVB_LOGF_ERROR("Invalid map_nv_access_unit: %s", value);
+			}
+		}
+		else if (strcmp(name, "map_nv_item_size") == 0) {
+			pPvtData->auItemSize = strtol(value, &pEnd, 10);
+		}
 	}
 
 	AVB_TRACE_EXIT(AVB_TRACE_MAP);
@@ -240,7 +281,18 @@ void openavbMapH264GenInitCB(media_q_t *pMediaQ)
 			return;
 		}
 
-		openavbMediaQSetSize(pMediaQ, pPvtData->itemCount, pPvtData->itemSize);
+		if (pPvtData->accessUnitMode) {
+			pPvtData->itemSize = pPvtData->auItemSize;
+			AVB_LOGF_INFO("Access unit mode, media queue items of %u bytes", pPvtData->itemSize);
+		}
+
+		if (pPvtData->itemSize == 0) {
+			// Interface module only adds buffers by reference
+			openavbMediaQSetSizeByRef(pMediaQ, pPvtData->itemCount);
+		}
+		else {
+			openavbMediaQSetSize(pMediaQ, pPvtData->itemCount, pPvtData->itemSize);
+		}
 		openavbMediaQAllocItemMapData(pMediaQ, sizeof(media_q_item_map_h264_pub_data_t), 0);
 	}
 	AVB_TRACE_EXIT(AVB_TRACE_MAP);
@@ -254,6 +306,104 @@ void openavbMapH264TxInitCB(media_q_t *pMediaQ)
 	AVB_TRACE_EXIT(AVB_TRACE_MAP);
 }
 
+// Start the packetizer on the next contiguous part of the access unit that holds
+// NAL units. An item placed by reference can have several segments, each holding
+// whole NAL units. Returns FALSE at the end of the item.
+static bool x_txNextSpan(pvt_data_t *pPvtData, media_q_item_t *pMediaQItem)
+{
+	while (pPvtData->txSpanEnd < pMediaQItem->dataLen) {
+		U32 len;
+		const U8 *pSpan = openavbMediaQItemSpan(pMediaQItem, pPvtData->txSpanEnd, &len);
+		if (!pSpan) {
+			break;
+		}
+		pPvtData->txSpanEnd += len;
+		openavbH264FuaTxStart(&pPvtData->fuaTx, pSpan, len);
+		if (!openavbH264FuaTxDone(&pPvtData->fuaTx)) {
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+// Access unit mode. Packetize the access unit in the tail item straight into the
+// outgoing frame, one packet per call, and pull the item after its last packet.
+static tx_cb_ret_t x_txAccessUnit(media_q_t *pMediaQ, pvt_data_t *pPvtData, U8 *pHdr, U8 *pPayload, U32 *dataLen)
+{
+	media_q_item_t *pMediaQItem = openavbMediaQTailLock(pMediaQ, TRUE);
+	if (!pMediaQItem) {
+		*dataLen = 0;
+		return TX_CB_RET_PACKET_NOT_READY;
+	}
+
+	if (!pPvtData->txActive) {
+		if (pMediaQItem->dataLen == 0 || (openavbMediaQItemSegCount(pMediaQItem) == 0 && pMediaQItem->dataLen > pPvtData->itemSize)) {
+			if (pMediaQItem->dataLen > 0) {
+				AVB_LOGF_ERROR("Media queue data item size too large. Reported size: %d  Max Size: %d", pMediaQItem->dataLen, pPvtData->itemSize);
+			}
+			openavbMediaQTailPull(pMediaQ);
+			*dataLen = 0;
+			return TX_CB_RET_PACKET_NOT_READY;
+		}
+
+		// PTP walltime already set in the interface module. Just add the max transit time, once per access unit.
+		openavbAvtpTimeAddUSec(pMediaQItem->pAvtpTime, pPvtData->maxTransitUsec);
+
+		pPvtData->txSpanEnd = 0;
+		if (!x_txNextSpan(pPvtData, pMediaQItem)) {
+			// No NAL units in the item
+			openavbMediaQTailPull(pMediaQ);
+			*dataLen = 0;
+			return TX_CB_RET_PACKET_NOT_READY;
+		}
+		pPvtData->txActive = TRUE;
+	}
+
+	bool last = FALSE;
+	U32 payloadLen = openavbH264FuaTxNext(&pPvtData->fuaTx, pPayload, pPvtData->maxPayloadSize, &last);
+	if (payloadLen == 0) {
+		pPvtData->txActive = FALSE;
+		openavbMediaQTailPull(pMediaQ);
+		*dataLen = 0;
+		return TX_CB_RET_PACKET_NOT_READY;
+	}
+	if (last) {
+		last = !x_txNextSpan(pPvtData, pMediaQItem);
+	}
+
+	// Every packet of the access unit carries the same timestamps
+	if (openavbAvtpTimeTimestampIsValid(pMediaQItem->pAvtpTime))
+		pHdr[HIDX_AVTP_HIDE7_TV1] |= 0x01;      // Set
+	else {
+		pHdr[HIDX_AVTP_HIDE7_TV1] &= ~0x01;     // Clear
+	}
+
+	if (openavbAvtpTimeTimestampIsUncertain(pMediaQItem->pAvtpTime))
+		pHdr[HIDX_AVTP_HIDE7_TU1] |= 0x01;      // Set
+	else pHdr[HIDX_AVTP_HIDE7_TU1] &= ~0x01;    // Clear
+
+	*(U32 *)(&pHdr[HIDX_AVTP_TIMESTAMP32]) = htonl(openavbAvtpTimeGetAvtpTimestamp(pMediaQItem->pAvtpTime));
+
+	pHdr[HIDX_M31_M21_M11_M01_EVT2_RESV2] = last ? 0x10 : 0x00;
+
+	*(U32 *)(&pHdr[HIDX_H264_TIMESTAMP32]) =
+			htonl(((media_q_item_map_h264_pub_data_t *)pMediaQItem->pPubMapData)->timestamp);
+
+	*(U16 *)(&pHdr[HIDX_STREAM_DATA_LEN16]) = htons(payloadLen + HIDX_H264_TIMESTAMP_SIZE);
+	*dataLen = payloadLen + TOTAL_HEADER_SIZE;
+
+	if (last) {
+		pPvtData->txActive = FALSE;
+		openavbMediaQTailPull(pMediaQ);
+	}
+	else {
+		openavbMediaQTailUnlock(pMediaQ);
+	}
+
+	AVB_TRACE_LINE(AVB_TRACE_MAP_LINE);
+	return TX_CB_RET_PACKET_READY;
+}
+
 // This talker callback will be called for each AVB observation interval.
 tx_cb_ret_t openavbMapH264TxCB(media_q_t *pMediaQ, U8 *pData, U32 *dataLen)
 {
@@ -275,6 +425,11 @@ tx_cb_ret_t openavbMapH264TxCB(media_q_t *pMediaQ, U8 *pData, U32 *dataLen)
 		//pHdr[HIDX_M31_M21_M11_M01_EVT2_RESV2] = 0x00;		// M0 set later
 		pHdr[HIDX_RESV8] = 0x00;
 
+		if (pPvtData->accessUnitMode) {
+			AVB_TRACE_EXIT(AVB_TRACE_MAP_DETAIL);
+			return x_txAccessUnit(pMediaQ, pPvtData, pHdr, pPayload, dataLen);
+		}
+
 		media_q_item_t *pMediaQItem = openavbMediaQTailLock(pMediaQ, TRUE);
 		if (pMediaQItem) {
 			if (pMediaQItem->dataLen > 0) {
@@ -314,8 +469,8 @@ tx_cb_ret_t openavbMapH264TxCB(media_q_t *pMediaQ, U8 *pData, U32 *dataLen)
 				*(U32 *)(&pHdr[HIDX_H264_TIMESTAMP32]) =
 						htonl(((media_q_item_map_h264_pub_data_t *)pMediaQItem->pPubMapData)->timestamp);
 
-				// Copy the h264 rtp payload into the outgoing avtp packet.
-				memcpy(pPayload, pMediaQItem->pPubData, pMediaQItem->dataLen);
+				// Copy the h264 rtp payload into the outgoing avtp packet. The interface may have placed it in the item by reference.
+				openavbMediaQItemCopy(pMediaQItem, 0, pPayload, pMediaQItem->dataLen);
 
 				// Add h264_timestamp size into the H264 data length
 				*(U16 *)(&pHdr[HIDX_STREAM_DATA_LEN16]) = htons(pMediaQItem->dataLen + HIDX_H264_TIMESTAMP_SIZE);
@@ -349,6 +504,92 @@ void openavbMapH264RxInitCB(media_q_t *pMediaQ)
 	AVB_TRACE_EXIT(AVB_TRACE_MAP);
 }
 
+// Hand the rebuilt access unit in the head item to the interface module
+static void x_rxPushAccessUnit(media_q_t *pMediaQ, pvt_data_t *pPvtData, media_q_item_t *pMediaQItem)
+{
+	media_q_item_map_h264_pub_data_t *pPubMapData = pMediaQItem->pPubMapData;
+	U32 status;
+
+	pMediaQItem->dataLen = openavbH264FuaRxEnd(&pPvtData->fuaRx, &status);
+	pPubMapData->lastPacket = TRUE;
+	pPubMapData->nalUnits = pPvtData->fuaRx.nalUnits;
+	pPubMapData->auStatus = status;
+	pPvtData->rxActive = FALSE;
+
+	if (status != H264_AU_OK) {
+		pPvtData->rxDamagedAUs++;
+		IF_LOG_INTERVAL(1000) AVB_LOGF_WARNING("Incomplete access unit (status 0x%x, %u damaged so far)", status, pPvtData->rxDamagedAUs);
+	}
+
+	openavbMediaQHeadPush(pMediaQ);
+}
+
+// Access unit mode. Rebuild the access unit in the head item and push it on the
+// packet with M0 set.
+static bool x_rxAccessUnit(media_q_t *pMediaQ, pvt_data_t *pPvtData, U8 *pHdr, U8 *pPayload, U32 payloadLen)
+{
+	U8 seq = pHdr[HIDX_AVTP_SEQ_NUM8];
+	bool lastPacket = (pHdr[HIDX_M31_M21_M11_M01_EVT2_RESV2] & 0x10) ? TRUE : FALSE;
+	U32 h264Timestamp = ntohl(*(U32 *)(&pHdr[HIDX_H264_TIMESTAMP32]));
+	bool lost = (pPvtData->rxSeqValid && seq != pPvtData->rxNextSeq);
+
+	pPvtData->rxNextSeq = seq + 1;
+	pPvtData->rxSeqValid = TRUE;
+
+	media_q_item_t *pMediaQItem = openavbMediaQHeadLock(pMediaQ);
+	if (!pMediaQItem) {
+		// Whatever is left of this access unit can't be used. If this packet ended it the next one starts clean.
+		pPvtData->rxLostPending = !lastPacket;
+		IF_LOG_INTERVAL(1000) AVB_LOG_ERROR("Media queue full");
+		return FALSE;
+	}
+
+	if (pPvtData->rxActive
+		&& ((media_q_item_map_h264_pub_data_t *)pMediaQItem->pPubMapData)->timestamp != h264Timestamp) {
+		// The end of the previous access unit never arrived
+		openavbH264FuaRxMarkLost(&pPvtData->fuaRx);
+		x_rxPushAccessUnit(pMediaQ, pPvtData, pMediaQItem);
+
+		pMediaQItem = openavbMediaQHeadLock(pMediaQ);
+		if (!pMediaQItem) {
+			pPvtData->rxLostPending = !lastPacket;
+			IF_LOG_INTERVAL(1000) AVB_LOG_ERROR("Media queue full");
+			return FALSE;
+		}
+	}
+
+	if (!pPvtData->rxActive) {
+		// The first packet gives the presentation time of the access unit
+		U32 timestamp = ntohl(*(U32 *)(&pHdr[HIDX_AVTP_TIMESTAMP32]));
+		openavbAvtpTimeSetToTimestamp(pMediaQItem->pAvtpTime, timestamp);
+		openavbAvtpTimeSetTimestampValid(pMediaQItem->pAvtpTime, (pHdr[HIDX_AVTP_HIDE7_TV1] & 0x01) ? TRUE : FALSE);
+		openavbAvtpTimeSetTimestampUncertain(pMediaQItem->pAvtpTime, (pHdr[HIDX_AVTP_HIDE7_TU1] & 0x01) ? TRUE : FALSE);
+		((media_q_item_map_h264_pub_data_t *)pMediaQItem->pPubMapData)->timestamp = h264Timestamp;
+
+		openavbH264FuaRxStart(&pPvtData->fuaRx, pMediaQItem->pPubData, pMediaQItem->itemSize);
+		pPvtData->rxActive = TRUE;
+		if (pPvtData->rxLostPending) {
+			lost = TRUE;
+			pPvtData->rxLostPending = FALSE;
+		}
+	}
+
+	if (lost) {
+		openavbH264FuaRxMarkLost(&pPvtData->fuaRx);
+	}
+	openavbH264FuaRxAdd(&pPvtData->fuaRx, pPayload, payloadLen);
+
+	if (lastPacket) {
+		x_rxPushAccessUnit(pMediaQ, pPvtData, pMediaQItem);
+	}
+	else {
+		openavbMediaQHeadUnlock(pMediaQ);
+	}
+
+	AVB_TRACE_LINE(AVB_TRACE_MAP_LINE);
+	return TRUE;
+}
+
 // This callback occurs when running as a listener and data is available.
 bool openavbMapH264RxCB(media_q_t *pMediaQ, U8 *pData, U32 dataLen)
 {
@@ -368,12 +609,33 @@ bool openavbMapH264RxCB(media_q_t *pMediaQ, U8 *pData, U32 dataLen)
 		//pHdr[HIDX_RESV8]
 
 		// validate header
+		if (dataLen < TOTAL_HEADER_SIZE || payloadLen < HIDX_H264_TIMESTAMP_SIZE) {
+			IF_LOG_INTERVAL(1000) AVB_LOG_ERROR("Packet too short");
+			AVB_TRACE_EXIT(AVB_TRACE_MAP_DETAIL);
+			return FALSE;
+		}
+
+		// The stream data length includes the h264_timestamp
+		payloadLen -= HIDX_H264_TIMESTAMP_SIZE;
 		if (payloadLen  > dataLen - TOTAL_HEADER_SIZE) {
 			IF_LOG_INTERVAL(1000) AVB_LOG_ERROR("header data len > actual data len");
 			AVB_TRACE_EXIT(AVB_TRACE_MAP_DETAIL);
 			return FALSE;
 		}
 
+		pvt_data_t *pPvtData = pMediaQ->pPvtMapInfo;
+		if (!pPvtData) {
+			AVB_LOG_ERROR("Private mapping module data not allocated.");
+			AVB_TRACE_EXIT(AVB_TRACE_MAP_DETAIL);
+			return FALSE;
+		}
+
+		if (pPvtData->accessUnitMode) {
+			bool ret = x_rxAccessUnit(pMediaQ, pPvtData, pHdr, pPayload, payloadLen);
+			AVB_TRACE_EXIT(AVB_TRACE_MAP_DETAIL);
+			return ret;
+		}
+
 		// Get item pointer in media queue
 		media_q_item_t *pMediaQItem = openavbMediaQHeadLock(pMediaQ);
 		if (pMediaQItem) {
@@ -468,6 +730,9 @@ extern DLL_EXPORT bool openavbMapH264Initialize(media_q_t *pMediaQ, openavb_map_
 		pPvtData->maxDataSize = (pPvtData->maxPayloadSize + TOTAL_HEADER_SIZE);
 		pPvtData->itemSize = pPvtData->maxPayloadSize;
 
+		pPvtData->accessUnitMode = FALSE;
+		pPvtData->auItemSize = DEFAULT_AU_ITEM_SIZE;
+
 		openavbMediaQSetMaxLatency(pMediaQ, inMaxTransitUsec);
 	}
 
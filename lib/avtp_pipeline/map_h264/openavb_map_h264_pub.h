@@ -30,16 +30,20 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 *************************************************************************************************************/
 
 /*
-* HEADER SUMMARY : Motion JPEG mapping module public interface conforming to 1722A RTP payload encapsulation.
-* 
-* Refer to RFC 2435 for details of the fragment structure.
-* 
-* As defined 1722a the timestamp must be the same for each fragment of a JPEG frame. This means the interface module
-* must set this same timestamp in the media queue for each item tht is a JPEG fragment of the frame. In addition the
-* Interface module must set the lastFragment flag of the item public map data structure for each fragment placed into
-* the media queue (TRUE if not the last fragment of the frame, FALSE if it is the last fragment of a frame).
-* 
-* The payload will be as defined in RFC 2435 and will include the JPEG headers as well as the JPEG data.
+* HEADER SUMMARY : H.264 mapping module public interface conforming to 1722A RTP payload encapsulation.
+*
+* Refer to RFC 6184 for details of the payload formats.
+*
+* The mapping runs in one of two modes, selected with map_nv_access_unit:
+*
+* Fragment mode (default): each media queue item holds one RTP payload. The interface module does the
+* packetization and sets the same timestamp and the lastPacket flag (TRUE on the last packet of an access unit)
+* for every item. On RX each packet becomes one item with the same fields filled in.
+*
+* Access unit mode: each media queue item holds one whole access unit as an Annex B byte stream (start code
+* prefixed NAL units). On TX the mapping splits it into single NAL unit and FU-A packets, all carrying the
+* item's timestamp; lastPacket is not used. On RX the mapping rebuilds each access unit into one item as an Annex B
+* byte stream, sets lastPacket TRUE, and reports in auStatus whether anything was lost on the way.
 */
 
 #ifndef OPENAVB_MAP_H264_PUB_H
@@ -51,11 +55,28 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 // that is why a single static (static/extern pattern) definition can not be used.
 #define MapH264MediaQDataFormat "H.264"
 
+typedef enum {
+	H264_AU_OK = 0,
+	// A FU-A fragment arrived without its start fragment, or the access unit ended inside a FU-A.
+	// The incomplete NAL unit is left out of the item.
+	H264_AU_FU_INCOMPLETE = 0x01,
+	// Access unit larger than the media queue item, NAL units that didn't fit are left out
+	H264_AU_OVERFLOW = 0x02,
+	// Malformed payload or an unsupported packetization type (FU-B, MTAP)
+	H264_AU_BAD_PAYLOAD = 0x04,
+	// AVTP sequence number gap or packets dropped while the media queue was full
+	H264_AU_PACKET_LOST = 0x08,
+} openavb_h264_au_status_t;
+
 typedef struct {
 	// Last fragment of frame flag.
 	bool lastPacket;		// For details see 1722a 9.4.3.1.1 M0 field
 	// The timestamp of h.264 NAL unit fragment.
 	U32 timestamp;			// For details see 1722-2016 8.5.3.1 h264_timestamp field
+	// Access unit mode RX only: number of NAL units in the item.
+	U32 nalUnits;
+	// Access unit mode RX only: openavb_h264_au_status_t flags, H264_AU_OK if the access unit is complete.
+	U32 auStatus;
 } media_q_item_map_h264_pub_data_t;
 
 #endif  // OPENAVB_MAP_H264_PUB_H
@@ -286,8 +286,9 @@ tx_cb_ret_t openavbMapMjpegTxCB(media_q_t *pMediaQ, U8 *pData, U32 *dataLen)
 					pHdr[HIDX_M11_M01_EVT2_RESV2] = 0x00;
 				}
 
-				// Copy the JPEG fragment into the outgoing avtp packet.
-				memcpy(pPayload, pMediaQItem->pPubData, pMediaQItem->dataLen);
+				// Copy the JPEG fragment into the outgoing avtp packet. The interface
+				// may have placed it in the item by reference.
+				openavbMediaQItemCopy(pMediaQItem, 0, pPayload, pMediaQItem->dataLen);
 
 				*(U16 *)(&pHdr[HIDX_STREAM_DATA_LEN16]) = pMediaQItem->dataLen;
 
@@ -328,11 +328,11 @@ tx_cb_ret_t openavbMapPipeTxCB(media_q_t *pMediaQ, U8 *pData, U32 *dataLen)
 				*(U16 *)(&pHdr[HIDX_VENDOR2_EUI16]) = 0x0000;
 
 				if (pPvtData->pull_header) {
-					memcpy(pData, pMediaQItem->pPubData, pMediaQItem->dataLen);
+					openavbMediaQItemCopy(pMediaQItem, 0, pData, pMediaQItem->dataLen);
 					*dataLen = pMediaQItem->dataLen;
 				}
 				else {
-					memcpy(pPayload, pMediaQItem->pPubData, pMediaQItem->dataLen);
+					openavbMediaQItemCopy(pMediaQItem, 0, pPayload, pMediaQItem->dataLen);
 					*dataLen = pMediaQItem->dataLen + TOTAL_HEADER_SIZE;
 				}
 
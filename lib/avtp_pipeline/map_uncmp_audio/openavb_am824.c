@@ -0,0 +1,511 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* MODULE SUMMARY : AM824 sample packing kernels for IEC 61883-6 streams.
+*
+* Each kernel set implements the four contiguous conversions (pack and unpack
+* of 16 and 24 bit samples). Planar buffers are handled on top of these by
+* converting one channel at a time through a small bounce buffer, so they get
+* the same vector code as interleaved data.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "openavb_am824.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define AM824_HAVE_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) && defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define AM824_HAVE_NEON 1
+#include <arm_neon.h>
+#endif
+
+#define	AVB_LOG_COMPONENT	"AM824"
+#include "openavb_log_pub.h"
+
+// Samples converted per step when going through the planar bounce buffer
+#define AM824_PLANAR_BLOCK			64
+
+typedef void (*am824_pack_fn_t)(U8 *pDst, const U8 *pSrc, U32 count, U32 label);
+typedef void (*am824_unpack_fn_t)(U8 *pDst, const U8 *pSrc, U32 count);
+
+typedef struct {
+	am824_isa_t isa;
+	am824_pack_fn_t pack16;
+	am824_pack_fn_t pack24;
+	am824_unpack_fn_t unpack16;
+	am824_unpack_fn_t unpack24;
+} am824_kernels_t;
+
+//////
+// Scalar reference. The vector kernels must match these bit for bit.
+//////
+
+static void x_pack16Scalar(U8 *pDst, const U8 *pSrc, U32 count, U32 label)
+{
+	U32 i1;
+	for (i1 = 0; i1 < count; i1++) {
+		S16 s16;
+		memcpy(&s16, pSrc, 2);
+		U32 sample = (((U32)s16 & 0x0000ffff) << 8) | label;
+		pDst[0] = sample >> 24;
+		pDst[1] = sample >> 16;
+		pDst[2] = sample >> 8;
+		pDst[3] = sample;
+		pSrc += 2;
+		pDst += 4;
+	}
+}
+
+static void x_pack24Scalar(U8 *pDst, const U8 *pSrc, U32 count, U32 label)
+{
+	U32 i1;
+	for (i1 = 0; i1 < count; i1++) {
+		pDst[0] = label >> 24;
+		pDst[1] = pSrc[2];
+		pDst[2] = pSrc[1];
+		pDst[3] = pSrc[0];
+		pSrc += 3;
+		pDst += 4;
+	}
+}
+
+static void x_unpack16Scalar(U8 *pDst, const U8 *pSrc, U32 count)
+{
+	U32 i1;
+	for (i1 = 0; i1 < count; i1++) {
+		S16 s16 = (S16)(((U16)pSrc[1] << 8) | pSrc[2]);
+		memcpy(pDst, &s16, 2);
+		pSrc += 4;
+		pDst += 2;
+	}
+}
+
+static void x_unpack24Scalar(U8 *pDst, const U8 *pSrc, U32 count)
+{
+	U32 i1;
+	for (i1 = 0; i1 < count; i1++) {
+		pDst[0] = pSrc[3];
+		pDst[1] = pSrc[2];
+		pDst[2] = pSrc[1];
+		pSrc += 4;
+		pDst += 3;
+	}
+}
+
+static const am824_kernels_t x_scalarKernels = {
+	AM824_ISA_SCALAR, x_pack16Scalar, x_pack24Scalar, x_unpack16Scalar, x_unpack24Scalar
+};
+
+#ifdef AM824_HAVE_X86
+
+//////
+// SSSE3: one byte shuffle does the label slot, byte swap and 3 to 4 byte widening.
+//////
+
+__attribute__((target("ssse3")))
+static void x_pack16Ssse3(U8 *pDst, const U8 *pSrc, U32 count, U32 label)
+{
+	const __m128i lo = _mm_setr_epi8(-1, 1, 0, -1, -1, 3, 2, -1, -1, 5, 4, -1, -1, 7, 6, -1);
+	const __m128i hi = _mm_setr_epi8(-1, 9, 8, -1, -1, 11, 10, -1, -1, 13, 12, -1, -1, 15, 14, -1);
+	const __m128i lbl = _mm_set1_epi32(label >> 24);
+
+	for (; count >= 8; count -= 8) {
+		__m128i in = _mm_loadu_si128((const __m128i *)pSrc);
+		_mm_storeu_si128((__m128i *)pDst, _mm_or_si128(_mm_shuffle_epi8(in, lo), lbl));
+		_mm_storeu_si128((__m128i *)(pDst + 16), _mm_or_si128(_mm_shuffle_epi8(in, hi), lbl));
+		pSrc += 16;
+		pDst += 32;
+	}
+	x_pack16Scalar(pDst, pSrc, count, label);
+}
+
+__attribute__((target("ssse3")))
+static void x_pack24Ssse3(U8 *pDst, const U8 *pSrc, U32 count, U32 label)
+{
+	const __m128i shuf = _mm_setr_epi8(-1, 2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9);
+	const __m128i lbl = _mm_set1_epi32(label >> 24);
+
+	// 4 samples per step, but each load reads 16 bytes
+	for (; count >= 6; count -= 4) {
+		__m128i in = _mm_loadu_si128((const __m128i *)pSrc);
+		_mm_storeu_si128((__m128i *)pDst, _mm_or_si128(_mm_shuffle_epi8(in, shuf), lbl));
+		pSrc += 12;
+		pDst += 16;
+	}
+	x_pack24Scalar(pDst, pSrc, count, label);
+}
+
+__attribute__((target("ssse3")))
+static void x_unpack16Ssse3(U8 *pDst, const U8 *pSrc, U32 count)
+{
+	const __m128i lo = _mm_setr_epi8(2, 1, 6, 5, 10, 9, 14, 13, -1, -1, -1, -1, -1, -1, -1, -1);
+	const __m128i hi = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, 2, 1, 6, 5, 10, 9, 14, 13);
+
+	for (; count >= 8; count -= 8) {
+		__m128i a = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)pSrc), lo);
+		__m128i b = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(pSrc + 16)), hi);
+		_mm_storeu_si128((__m128i *)pDst, _mm_or_si128(a, b));
+		pSrc += 32;
+		pDst += 16;
+	}
+	x_unpack16Scalar(pDst, pSrc, count);
+}
+
+__attribute__((target("ssse3")))
+static void x_unpack24Ssse3(U8 *pDst, const U8 *pSrc, U32 count)
+{
+	const __m128i shuf = _mm_setr_epi8(3, 2, 1, 7, 6, 5, 11, 10, 9, 15, 14, 13, -1, -1, -1, -1);
+
+	for (; count >= 4; count -= 4) {
+		__m128i out = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)pSrc), shuf);
+		// 12 bytes out; don't touch the byte after the last sample
+		_mm_storel_epi64((__m128i *)pDst, out);
+		U32 tail = (U32)_mm_cvtsi128_si32(_mm_srli_si128(out, 8));
+		memcpy(pDst + 8, &tail, 4);
+		pSrc += 16;
+		pDst += 12;
+	}
+	x_unpack24Scalar(pDst, pSrc, count);
+}
+
+static const am824_kernels_t x_ssse3Kernels = {
+	AM824_ISA_SSSE3, x_pack16Ssse3, x_pack24Ssse3, x_unpack16Ssse3, x_unpack24Ssse3
+};
+
+//////
+// AVX2: as SSSE3 with two lanes per step. The tails go to the SSE code, so
+// clear the upper halves first to avoid the AVX to SSE transition penalty.
+//////
+
+__attribute__((target("avx2")))
+static void x_pack16Avx2(U8 *pDst, const U8 *pSrc, U32 count, U32 label)
+{
+	const __m256i bswap = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+										   3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+	const __m256i lbl = _mm256_set1_epi32(label);
+
+	for (; count >= 8; count -= 8) {
+		__m256i s = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)pSrc));
+		s = _mm256_or_si256(_mm256_slli_epi32(s, 8), lbl);
+		_mm256_storeu_si256((__m256i *)pDst, _mm256_shuffle_epi8(s, bswap));
+		pSrc += 16;
+		pDst += 32;
+	}
+	_mm256_zeroupper();
+	x_pack16Ssse3(pDst, pSrc, count, label);
+}
+
+__attribute__((target("avx2")))
+static void x_pack24Avx2(U8 *pDst, const U8 *pSrc, U32 count, U32 label)
+{
+	const __m256i shuf = _mm256_setr_epi8(-1, 2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9,
+										  -1, 2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9);
+	const __m256i lbl = _mm256_set1_epi32(label >> 24);
+
+	// 8 samples per step; the second load reads up to byte 28
+	for (; count >= 10; count -= 8) {
+		__m256i in = _mm256_inserti128_si256(
+			_mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)pSrc)),
+			_mm_loadu_si128((const __m128i *)(pSrc + 12)), 1);
+		_mm256_storeu_si256((__m256i *)pDst, _mm256_or_si256(_mm256_shuffle_epi8(in, shuf), lbl));
+		pSrc += 24;
+		pDst += 32;
+	}
+	_mm256_zeroupper();
+	x_pack24Ssse3(pDst, pSrc, count, label);
+}
+
+__attribute__((target("avx2")))
+static void x_unpack16Avx2(U8 *pDst, const U8 *pSrc, U32 count)
+{
+	const __m256i shuf = _mm256_setr_epi8(2, 1, 6, 5, 10, 9, 14, 13, -1, -1, -1, -1, -1, -1, -1, -1,
+										  2, 1, 6, 5, 10, 9, 14, 13, -1, -1, -1, -1, -1, -1, -1, -1);
+
+	for (; count >= 8; count -= 8) {
+		__m256i out = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i *)pSrc), shuf);
+		out = _mm256_permute4x64_epi64(out, 0x08);
+		_mm_storeu_si128((__m128i *)pDst, _mm256_castsi256_si128(out));
+		pSrc += 32;
+		pDst += 16;
+	}
+	_mm256_zeroupper();
+	x_unpack16Ssse3(pDst, pSrc, count);
+}
+
+__attribute__((target("avx2")))
+static void x_unpack24Avx2(U8 *pDst, const U8 *pSrc, U32 count)
+{
+	const __m256i shuf = _mm256_setr_epi8(3, 2, 1, 7, 6, 5, 11, 10, 9, 15, 14, 13, -1, -1, -1, -1,
+										  3, 2, 1, 7, 6, 5, 11, 10, 9, 15, 14, 13, -1, -1, -1, -1);
+	const __m256i pack = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7);
+
+	for (; count >= 8; count -= 8) {
+		__m256i out = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i *)pSrc), shuf);
+		out = _mm256_permutevar8x32_epi32(out, pack);
+		// 24 bytes out
+		_mm_storeu_si128((__m128i *)pDst, _mm256_castsi256_si128(out));
+		_mm_storel_epi64((__m128i *)(pDst + 16), _mm256_extracti128_si256(out, 1));
+		pSrc += 32;
+		pDst += 24;
+	}
+	_mm256_zeroupper();
+	x_unpack24Ssse3(pDst, pSrc, count);
+}
+
+static const am824_kernels_t x_avx2Kernels = {
+	AM824_ISA_AVX2, x_pack16Avx2, x_pack24Avx2, x_unpack16Avx2, x_unpack24Avx2
+};
+
+#endif // AM824_HAVE_X86
+
+#ifdef AM824_HAVE_NEON
+
+//////
+// NEON: the structure loads and stores do the (de)interleave of the sample bytes.
+//////
+
+static void x_pack16Neon(U8 *pDst, const U8 *pSrc, U32 count, U32 label)
+{
+	uint8x16x4_t out;
+	out.val[0] = vdupq_n_u8(label >> 24);
+	out.val[3] = vdupq_n_u8(0);
+
+	for (; count >= 16; count -= 16) {
+		uint8x16x2_t in = vld2q_u8(pSrc);
+		out.val[1] = in.val[1];
+		out.val[2] = in.val[0];
+		vst4q_u8(pDst, out);
+		pSrc += 32;
+		pDst += 64;
+	}
+	x_pack16Scalar(pDst, pSrc, count, label);
+}
+
+static void x_pack24Neon(U8 *pDst, const U8 *pSrc, U32 count, U32 label)
+{
+	uint8x16x4_t out;
+	out.val[0] = vdupq_n_u8(label >> 24);
+
+	for (; count >= 16; count -= 16) {
+		uint8x16x3_t in = vld3q_u8(pSrc);
+		out.val[1] = in.val[2];
+		out.val[2] = in.val[1];
+		out.val[3] = in.val[0];
+		vst4q_u8(pDst, out);
+		pSrc += 48;
+		pDst += 64;
+	}
+	x_pack24Scalar(pDst, pSrc, count, label);
+}
+
+static void x_unpack16Neon(U8 *pDst, const U8 *pSrc, U32 count)
+{
+	for (; count >= 16; count -= 16) {
+		uint8x16x4_t in = vld4q_u8(pSrc);
+		uint8x16x2_t out;
+		out.val[0] = in.val[2];
+		out.val[1] = in.val[1];
+		vst2q_u8(pDst, out);
+		pSrc += 64;
+		pDst += 32;
+	}
+	x_unpack16Scalar(pDst, pSrc, count);
+}
+
+static void x_unpack24Neon(U8 *pDst, const U8 *pSrc, U32 count)
+{
+	for (; count >= 16; count -= 16) {
+		uint8x16x4_t in = vld4q_u8(pSrc);
+		uint8x16x3_t out;
+		out.val[0] = in.val[3];
+		out.val[1] = in.val[2];
+		out.val[2] = in.val[1];
+		vst3q_u8(pDst, out);
+		pSrc += 64;
+		pDst += 48;
+	}
+	x_unpack24Scalar(pDst, pSrc, count);
+}
+
+static const am824_kernels_t x_neonKernels = {
+	AM824_ISA_NEON, x_pack16Neon, x_pack24Neon, x_unpack16Neon, x_unpack24Neon
+};
+
+#endif // AM824_HAVE_NEON
+
+static const am824_kernels_t *x_pKernels = &x_scalarKernels;
+
+static const am824_kernels_t *x_kernelsForIsa(am824_isa_t isa)
+{
+	switch (isa) {
+		case AM824_ISA_SCALAR:
+			return &x_scalarKernels;
+#ifdef AM824_HAVE_X86
+		case AM824_ISA_SSSE3:
+			return __builtin_cpu_supports("ssse3") ? &x_ssse3Kernels : NULL;
+		case AM824_ISA_AVX2:
+			return __builtin_cpu_supports("avx2") ? &x_avx2Kernels : NULL;
+#endif
+#ifdef AM824_HAVE_NEON
+		case AM824_ISA_NEON:
+			return &x_neonKernels;
+#endif
+		default:
+			return NULL;
+	}
+}
+
+const char *openavbAm824IsaName(am824_isa_t isa)
+{
+	switch (isa) {
+		case AM824_ISA_SCALAR:	return "scalar";
+		case AM824_ISA_SSSE3:	return "ssse3";
+		case AM824_ISA_AVX2:	return "avx2";
+		case AM824_ISA_NEON:	return "neon";
+	}
+	return "unknown";
+}
+
+void openavbAm824Init(void)
+{
+	static const am824_isa_t best[] = { AM824_ISA_AVX2, AM824_ISA_SSSE3, AM824_ISA_NEON, AM824_ISA_SCALAR };
+	const am824_kernels_t *pKernels = NULL;
+	unsigned i1;
+
+#ifdef AM824_HAVE_X86
+	__builtin_cpu_init();
+#endif
+
+	const char *pEnv = getenv("OPENAVB_AM824_ISA");
+	if (pEnv) {
+		for (i1 = 0; i1 < sizeof(best) / sizeof(best[0]); i1++) {
+			if (strcmp(pEnv, openavbAm824IsaName(best[i1])) == 0) {
+				pKernels = x_kernelsForIsa(best[i1]);
+				if (!pKernels) {
+					AVB_LOGF_WARNING("OPENAVB_AM824_ISA=%s not supported on this CPU", pEnv);
+				}
+				break;
+			}
+		}
+	}
+
+	for (i1 = 0; !pKernels && i1 < sizeof(best) / sizeof(best[0]); i1++) {
+		pKernels = x_kernelsForIsa(best[i1]);
+	}
+
+	if (pKernels != x_pKernels) {
+		x_pKernels = pKernels;
+		AVB_LOGF_INFO("Using %s kernels", openavbAm824IsaName(pKernels->isa));
+	}
+}
+
+bool openavbAm824SetIsa(am824_isa_t isa)
+{
+#ifdef AM824_HAVE_X86
+	__builtin_cpu_init();
+#endif
+	const am824_kernels_t *pKernels = x_kernelsForIsa(isa);
+	if (!pKernels) {
+		return FALSE;
+	}
+	x_pKernels = pKernels;
+	return TRUE;
+}
+
+am824_isa_t openavbAm824GetIsa(void)
+{
+	return x_pKernels->isa;
+}
+
+void openavbAm824Pack(U8 *pDst, const U8 *pSrc, U32 count, U32 sampleBytes, U32 label)
+{
+	if (sampleBytes == 2)
+		x_pKernels->pack16(pDst, pSrc, count, label);
+	else
+		x_pKernels->pack24(pDst, pSrc, count, label);
+}
+
+void openavbAm824Unpack(U8 *pDst, const U8 *pSrc, U32 count, U32 sampleBytes)
+{
+	if (sampleBytes == 2)
+		x_pKernels->unpack16(pDst, pSrc, count);
+	else
+		x_pKernels->unpack24(pDst, pSrc, count);
+}
+
+void openavbAm824PackPlanar(U8 *pDst, const U8 * const *ppSrc, U32 frames, U32 channels, U32 sampleBytes, U32 label)
+{
+	U32 quadlets[AM824_PLANAR_BLOCK];
+	U32 frame, block, ch, i1;
+
+	for (frame = 0; frame < frames; frame += block) {
+		block = frames - frame;
+		if (block > AM824_PLANAR_BLOCK)
+			block = AM824_PLANAR_BLOCK;
+
+		for (ch = 0; ch < channels; ch++) {
+			openavbAm824Pack((U8 *)quadlets, ppSrc[ch] + (frame * sampleBytes), block, sampleBytes, label);
+
+			U8 *pOut = pDst + (((frame * channels) + ch) * 4);
+			for (i1 = 0; i1 < block; i1++) {
+				memcpy(pOut, &quadlets[i1], 4);
+				pOut += channels * 4;
+			}
+		}
+	}
+}
+
+void openavbAm824UnpackPlanar(U8 * const *ppDst, const U8 *pSrc, U32 frames, U32 channels, U32 sampleBytes)
+{
+	U32 quadlets[AM824_PLANAR_BLOCK];
+	U32 frame, block, ch, i1;
+
+	for (frame = 0; frame < frames; frame += block) {
+		block = frames - frame;
+		if (block > AM824_PLANAR_BLOCK)
+			block = AM824_PLANAR_BLOCK;
+
+		for (ch = 0; ch < channels; ch++) {
+			const U8 *pIn = pSrc + (((frame * channels) + ch) * 4);
+			for (i1 = 0; i1 < block; i1++) {
+				memcpy(&quadlets[i1], pIn, 4);
+				pIn += channels * 4;
+			}
+
+			openavbAm824Unpack(ppDst[ch] + (frame * sampleBytes), (const U8 *)quadlets, block, sampleBytes);
+		}
+	}
+}
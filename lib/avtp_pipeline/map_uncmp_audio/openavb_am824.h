@@ -0,0 +1,87 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* HEADER SUMMARY : AM824 sample packing for IEC 61883-6 streams.
+*
+* Converts between media queue audio samples and the big-endian AM824
+* quadlets of a 61883-6 payload: label byte, then the sample left aligned
+* in the remaining 24 bits. Sources and destinations can be interleaved
+* (frame after frame, as in the media queue) or planar (one buffer per channel).
+*
+* Sample formats on the media queue side:
+*  2 bytes  host order signed 16 bit
+*  3 bytes  packed little endian 24 bit
+*
+* The kernels are picked at runtime for the CPU (AVX2, SSSE3 or NEON) and all
+* give the same output as the scalar version. For testing and comparison the
+* choice can be forced with OPENAVB_AM824_ISA=scalar|ssse3|avx2|neon.
+*/
+
+#ifndef OPENAVB_AM824_H
+#define OPENAVB_AM824_H 1
+
+#include "openavb_types_pub.h"
+
+// AM824 labels for multi-bit linear audio (IEC 61883-6 Table 6)
+#define AM824_LABEL_MBLA_24BIT		0x40000000
+#define AM824_LABEL_MBLA_16BIT		0x42000000
+
+typedef enum {
+	AM824_ISA_SCALAR = 0,
+	AM824_ISA_SSSE3,
+	AM824_ISA_AVX2,
+	AM824_ISA_NEON,
+} am824_isa_t;
+
+// Select the kernels for this CPU. Safe to call more than once.
+void openavbAm824Init(void);
+
+// Force a kernel set. Returns FALSE if the CPU or build doesn't support it.
+bool openavbAm824SetIsa(am824_isa_t isa);
+
+// Kernel set in use
+am824_isa_t openavbAm824GetIsa(void);
+const char *openavbAm824IsaName(am824_isa_t isa);
+
+// Pack count interleaved samples of sampleBytes (2 or 3) into AM824 quadlets at pDst.
+void openavbAm824Pack(U8 *pDst, const U8 *pSrc, U32 count, U32 sampleBytes, U32 label);
+
+// Pack frames from one buffer per channel, interleaving the channels into AM824 quadlets at pDst.
+void openavbAm824PackPlanar(U8 *pDst, const U8 * const *ppSrc, U32 frames, U32 channels, U32 sampleBytes, U32 label);
+
+// Strip the labels of count AM824 quadlets at pSrc into interleaved samples of sampleBytes (2 or 3).
+void openavbAm824Unpack(U8 *pDst, const U8 *pSrc, U32 count, U32 sampleBytes);
+
+// Strip the labels of frames of interleaved AM824 quadlets into one buffer per channel.
+void openavbAm824UnpackPlanar(U8 * const *ppDst, const U8 *pSrc, U32 frames, U32 channels, U32 sampleBytes);
+
+#endif // OPENAVB_AM824_H
@@ -41,6 +41,7 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #include "openavb_mediaq_pub.h"
 #include "openavb_map_pub.h"
 #include "openavb_map_uncmp_audio_pub.h"
+#include "openavb_am824.h"
 
 // DEBUG Uncomment to turn on logging for just this module.
 #define AVB_LOG_ON	1
@@ -148,6 +149,9 @@ typedef struct {
 	// Data block continuity counter
 	U8 DBC;
 
+	// Header built at TX init. Only the bytes after the AVTP common header are used.
+	U8 txHdrTemplate[TOTAL_HEADER_SIZE];
+
 	avb_audio_mcr_t audioMcr;
 #if ATL_LAUNCHTIME_ENABLED
 	// Transmit interval in nanoseconds.
@@ -269,21 +273,21 @@ static void x_calculateSizes(media_q_t *pMediaQ)
 
 		switch (pPubMapInfo->audioBitDepth) {
 			case AVB_AUDIO_BIT_DEPTH_16BIT:
-				pPvtData->AM824_label = 0x42000000;
+				pPvtData->AM824_label = AM824_LABEL_MBLA_16BIT;
 				break;
 
 			case AVB_AUDIO_BIT_DEPTH_20BIT:
 				AVB_LOG_ERROR("20 bit not currently supported. Downgraded to 16 bit.");
-				pPvtData->AM824_label = 0x42000000;
+				pPvtData->AM824_label = AM824_LABEL_MBLA_16BIT;
 				break;
 
 			case AVB_AUDIO_BIT_DEPTH_24BIT:
-				pPvtData->AM824_label = 0x40000000;
+				pPvtData->AM824_label = AM824_LABEL_MBLA_24BIT;
 				break;
 
 			default:
 				AVB_LOGF_ERROR("Invalid audio bit depth configured: %u", pPubMapInfo->audioBitDepth);
-				pPvtData->AM824_label = 0x40000000;
+				pPvtData->AM824_label = AM824_LABEL_MBLA_24BIT;
 				break;
 		}
 
@@ -391,6 +395,9 @@ void openavbMapUncmpAudioGenInitCB(media_q_t *pMediaQ)
 
 		x_calculateSizes(pMediaQ);
 		openavbMediaQSetSize(pMediaQ, pPvtData->itemCount, pPubMapInfo->itemSize);
+
+		// Pick the AM824 pack/unpack kernels for this CPU
+		openavbAm824Init();
 	}
 	AVB_TRACE_EXIT(AVB_TRACE_MAP);
 	}
@@ -465,6 +472,26 @@ void openavbMapUncmpAudioTxInitCB(media_q_t *pMediaQ)
 		return;
 	}
 
+	// Build the constant part of the mapping and CIP headers once. The TX callback
+	// copies it into each packet and only sets the timestamp, TV bit and DBC.
+	U8 *pHdr = pPvtData->txHdrTemplate;
+	memset(pHdr, 0, sizeof(pPvtData->txHdrTemplate));
+
+	//pHdr[HIDX_AVTP_TIMESTAMP32] = 0x00;			// Set per packet
+	*(U32 *)(&pHdr[HIDX_GATEWAY32]) = 0x00000000;
+	*(U16 *)(&pHdr[HIDX_DATALEN16]) = htons((pPubMapInfo->framesPerPacket * pPubMapInfo->packetFrameSizeBytes) + CIP_HEADER_SIZE);
+	pHdr[HIDX_TAG2_CHANNEL6] = (1 << 6) | 0x1f;
+	pHdr[HIDX_TCODE4_SY4] = (0x0a << 4) | 0;
+
+	pHdr[HIDX_CIP2_SID6] = (0x00 << 6) | 0x3f;
+	pHdr[HIDX_DBS8] = pPubMapInfo->audioChannels;
+
+	pHdr[HIDX_FN2_QPC3_SPH1_RSV2] = (0x00 << 6) | (0x00 << 3) | (0x00 << 2) | 0x00;
+	// pHdr[HIDX_DBC8] = 0; 						// Set per packet
+	pHdr[HIDX_CIP2_FMT6] = (0x02 << 6) | 0x10;
+	pHdr[HIDX_FDF5_SFC3] = 0x00 << 3 | pPvtData->cip_sfc;
+	*(U16 *)(&pHdr[HIDX_SYT16]) = 0xffff;
+
 	AVB_TRACE_EXIT(AVB_TRACE_MAP);
 }
 
@@ -492,21 +519,8 @@ tx_cb_ret_t openavbMapUncmpAudioTxCB(media_q_t *pMediaQ, U8 *pData, U32 *dataLen
 		U8 *pHdr = pData;
 		U8 *pPayload = pData + TOTAL_HEADER_SIZE;
 
-		//pHdr[HIDX_AVTP_TIMESTAMP32] = 0x00;			// Set later
-		*(U32 *)(&pHdr[HIDX_GATEWAY32]) = 0x00000000;
-		//pHdr[HIDX_DATALEN16] = 0x00;					// Set Later
-		pHdr[HIDX_TAG2_CHANNEL6] = (1 << 6) | 0x1f;
-		pHdr[HIDX_TCODE4_SY4] = (0x0a << 4) | 0;
-
-		// Set the majority of the CIP header now.
-		pHdr[HIDX_CIP2_SID6] = (0x00 << 6) | 0x3f;
-		pHdr[HIDX_DBS8] = pPubMapInfo->audioChannels;
-
-		pHdr[HIDX_FN2_QPC3_SPH1_RSV2] = (0x00 << 6) | (0x00 << 3) | (0x00 << 2) | 0x00;
-		// pHdr[HIDX_DBC8] = 0; 						// Set later
-		pHdr[HIDX_CIP2_FMT6] = (0x02 << 6) | 0x10;
-		pHdr[HIDX_FDF5_SFC3] = 0x00 << 3 | pPvtData->cip_sfc;
-		*(U16 *)(&pHdr[HIDX_SYT16]) = 0xffff;
+		// Mapping and CIP headers from the template; timestamp and DBC are set below.
+		memcpy(&pHdr[AVTP_V0_HEADER_SIZE], &pPvtData->txHdrTemplate[AVTP_V0_HEADER_SIZE], MAP_HEADER_SIZE + CIP_HEADER_SIZE);
 
 		U32 framesProcessed = 0;
 		U8 *pAVTPDataUnit = pPayload;
@@ -539,37 +553,25 @@ tx_cb_ret_t openavbMapUncmpAudioTxCB(media_q_t *pMediaQ, U8 *pData, U32 *dataLen
 
 				}
 
-				while (framesProcessed < pPubMapInfo->framesPerPacket && pMediaQItem->readIdx < pMediaQItem->dataLen) {
-					int i1;
-					for (i1 = 0; i1 < pPubMapInfo->audioChannels; i1++) {
-						if (pPubMapInfo->itemSampleSizeBytes == 2) {
-							S32 sample = *(S16 *)pItemData;
-							sample &= 0x0000ffff;
-							sample = sample << 8;
-							sample |= pPvtData->AM824_label;
-							sample = htonl(sample);
-							*(U32 *)(pAVTPDataUnit) = sample;
-							pAVTPDataUnit += 4;
-							pItemData += 2;
-						}
-						else {
-							S32 sample = *(S32 *)pItemData;
-							sample &= 0x00ffffff;
-							sample |= pPvtData->AM824_label;
-							sample = htonl(sample);
-							*(U32 *)(pAVTPDataUnit) = sample;
-							pAVTPDataUnit += 4;
-							pItemData += 3;
-						}
-					}
-					framesProcessed++;
-					if (dbc % sytInt == 0) {
+				if (pMediaQItem->readIdx < pMediaQItem->dataLen) {
+					// Take as many whole frames from this item as the packet still needs
+					U32 frames = (pMediaQItem->dataLen - pMediaQItem->readIdx + pPubMapInfo->itemFrameSizeBytes - 1) / pPubMapInfo->itemFrameSizeBytes;
+					if (frames > pPubMapInfo->framesPerPacket - framesProcessed)
+						frames = pPubMapInfo->framesPerPacket - framesProcessed;
+
+					U32 samples = frames * pPubMapInfo->audioChannels;
+					openavbAm824Pack(pAVTPDataUnit, pItemData, samples, pPubMapInfo->itemSampleSizeBytes, pPvtData->AM824_label);
+					pAVTPDataUnit += samples * 4;
+
+					// The timestamp goes with the frame whose DBC is a multiple of the SYT interval
+					if ((sytInt - (dbc % sytInt)) % sytInt < frames) {
 						*(U32 *)(&pHdr[HIDX_AVTP_TIMESTAMP32]) = htonl(openavbAvtpTimeGetAvtpTimestamp(pMediaQItem->pAvtpTime));
 
 						timestampSet = TRUE;
 					}
-					dbc++;
-					pMediaQItem->readIdx += pPubMapInfo->itemFrameSizeBytes;
+					dbc += frames;
+					framesProcessed += frames;
+					pMediaQItem->readIdx += frames * pPubMapInfo->itemFrameSizeBytes;
 				}
 
 				if (pMediaQItem->readIdx >= pMediaQItem->dataLen) {
@@ -592,12 +594,10 @@ tx_cb_ret_t openavbMapUncmpAudioTxCB(media_q_t *pMediaQ, U8 *pData, U32 *dataLen
 			pHdr[HIDX_AVTP_HIDE7_TV1] &= ~0x01;
 		}
 
-		// Set the block continutity and data length
+		// Set the block continutity
 		pHdr[HIDX_DBC8] = pPvtData->DBC;
 		pPvtData->DBC = dbc;
 
-		*(U16 *)(&pHdr[HIDX_DATALEN16]) = htons((pPubMapInfo->framesPerPacket * pPubMapInfo->packetFrameSizeBytes) + CIP_HEADER_SIZE);
-
 		// Set out bound data length (entire packet length)
 		*dataLen = (pPubMapInfo->framesPerPacket * pPubMapInfo->packetFrameSizeBytes) + TOTAL_HEADER_SIZE;
 
@@ -688,27 +688,16 @@ bool openavbMapUncmpAudioRxCB(media_q_t *pMediaQ, U8 *pData, U32 dataLen)
 					openavbAvtpTimeSetTimestampUncertain(pMediaQItem->pAvtpTime, tsUncertain);
 				}
 
-				while (((pAVTPDataUnit + pPubMapInfo->packetFrameSizeBytes) <= pAVTPDataUnitEnd) && ((pItemData + pPubMapInfo->itemFrameSizeBytes) <= pItemDataEnd)) {
-					int i1;
-					for (i1 = 0; i1 < pPubMapInfo->audioChannels; i1++) {
-						if (pPubMapInfo->itemSampleSizeBytes == 2) {
-							S32 sample = ntohl(*(S32 *)pAVTPDataUnit);
-							sample = sample * 1;
-							*(S16 *)(pItemData) = (sample & 0x00ffffff) >> 8;
-							pAVTPDataUnit += 4;
-							pItemData += 2;
-							itemSizeWritten += 2;
-						}
-						else {
-							S32 sample = ntohl(*(S32 *)pAVTPDataUnit);
-							sample = sample * 1;
-							*(S32 *)(pItemData) = sample & 0x00ffffff;
-							pAVTPDataUnit += 4;
-							pItemData += 3;
-							itemSizeWritten += 3;
-						}
-					}
-				}
+				// Whole frames that are both in the packet and still fit in the item
+				U32 frames = (pAVTPDataUnitEnd - pAVTPDataUnit) / pPubMapInfo->packetFrameSizeBytes;
+				U32 itemFrames = (pItemDataEnd - pItemData) / pPubMapInfo->itemFrameSizeBytes;
+				if (frames > itemFrames)
+					frames = itemFrames;
+
+				U32 samples = frames * pPubMapInfo->audioChannels;
+				openavbAm824Unpack(pItemData, pAVTPDataUnit, samples, pPubMapInfo->itemSampleSizeBytes);
+				pAVTPDataUnit += samples * 4;
+				itemSizeWritten = frames * pPubMapInfo->itemFrameSizeBytes;
 
 				pMediaQItem->dataLen += itemSizeWritten;
 
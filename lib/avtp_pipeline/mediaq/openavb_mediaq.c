@@ -36,10 +36,12 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #include "openavb_platform.h"
 
 #include <stdlib.h>
+#include <string.h>
 #include "openavb_types_pub.h"
 #include "openavb_trace.h"
 #include "openavb_mediaq.h"
 #include "openavb_avtp_time_pub.h"
+#include "openavb_arena.h"
 
 #define	AVB_LOG_COMPONENT	"Media Queue"
 #include "openavb_log.h"
@@ -58,6 +60,28 @@ FILE *pFileHeadPush = 0;
 FILE *pFileTailPull = 0;
 #endif
 
+// A segment of a media queue item: len bytes at offset in pBuf.
+typedef struct {
+	media_q_buf_t *pBuf;
+	U32 offset;
+	U32 len;
+} media_q_item_seg_t;
+
+// A media queue item with the properties only the media queue uses. The
+// public item comes first, so a media_q_item_t pointer handed out by the
+// queue is also a pointer to its media_q_item_pvt_t.
+typedef struct {
+	media_q_item_t item;
+
+	// Number of external data segments. When not zero the item data is in
+	// segs[] rather than pPubData and dataLen is the total of the segment
+	// lengths.
+	U32 segCount;
+
+	// External data segments, in order
+	media_q_item_seg_t segs[MEDIAQ_ITEM_MAX_SEGS];
+} media_q_item_pvt_t;
+
 typedef struct {
 	// Maximum number of items the queue can hold.
 	int itemCount;
@@ -66,7 +90,7 @@ typedef struct {
 	int itemSize;
 
 	// Pointer to the array of items.
-	media_q_item_t *pItems;
+	media_q_item_pvt_t *pItems;
 
 	// Next item to be filled
 	int head;	
@@ -89,8 +113,36 @@ typedef struct {
 	// Maximum stale tail
 	U32 maxStaleTailUsec;
 
+	// NUMA node item memory is allocated from
+	int arenaNode;
+
+	// Arena blocks holding the per item map and interface data. The item
+	// array and item data share the block at pItems.
+	U8 *pItemMapBlock;
+	U8 *pItemIntfBlock;
+
 } media_q_info_t;
 
+struct media_q_buf {
+	U32 refCount;
+	U32 size;
+	void *pData;
+	media_q_buf_release_cb_t releaseCb;
+	void *pCtx;
+};
+
+// Drop the segment references of an item
+static void x_openavbMediaQItemReleaseSegs(media_q_item_t *pItem)
+{
+	media_q_item_pvt_t *pPvtItem = (media_q_item_pvt_t *)pItem;
+	U32 i1;
+	for (i1 = 0; i1 < pPvtItem->segCount; i1++) {
+		openavbMediaQBufUnref(pPvtItem->segs[i1].pBuf);
+		pPvtItem->segs[i1].pBuf = NULL;
+	}
+	pPvtItem->segCount = 0;
+}
+
 static void x_openavbMediaQIncrementHead(media_q_info_t *pMediaQInfo)	
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_MEDIAQ_DETAIL);
@@ -109,7 +161,7 @@ static void x_openavbMediaQIncrementHead(media_q_info_t *pMediaQInfo)
 			break; // Set head to pMediaQInfo->head = -1;
 		}
 
-		if (!pMediaQInfo->pItems[pMediaQInfo->head].taken) {
+		if (!pMediaQInfo->pItems[pMediaQInfo->head].item.taken) {
 			// Found item
 			AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ_DETAIL);
 			return;
@@ -140,7 +192,7 @@ static void x_openavbMediaQIncrementTail(media_q_info_t *pMediaQInfo)
 			break; // Set head to pMediaQInfo->tail = -1;
 		}
 
-		if (!pMediaQInfo->pItems[pMediaQInfo->tail].taken) {
+		if (!pMediaQInfo->pItems[pMediaQInfo->tail].item.taken) {
 			// Found item
 			AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ_DETAIL);
 			return;
@@ -170,7 +222,7 @@ void x_openavbMediaQPurgeStaleTail(media_q_t *pMediaQ)
 					bMore = FALSE;
 					if (pMediaQInfo->itemCount > 0) {
 						if (pMediaQInfo->tail > -1) {
-							media_q_item_t *pTail = &pMediaQInfo->pItems[pMediaQInfo->tail];
+							media_q_item_t *pTail = &pMediaQInfo->pItems[pMediaQInfo->tail].item;
 	
 							if (pTail) {
 								pMediaQInfo->tailLocked = TRUE;
@@ -234,6 +286,7 @@ media_q_t* openavbMediaQCreate()
 			pMediaQInfo->maxLatencyUsec = 0;
 			pMediaQInfo->threadSafeOn = FALSE;
 			pMediaQInfo->maxStaleTailUsec = MICROSECONDS_PER_SECOND;
+			pMediaQInfo->arenaNode = OPENAVB_ARENA_NODE_ANY;
 		}
 		else {
 			openavbMediaQDelete(pMediaQ);
@@ -259,14 +312,27 @@ void openavbMediaQThreadSafeOn(media_q_t *pMediaQ)
 	AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ);
 }
 
+void openavbMediaQSetArenaNode(media_q_t *pMediaQ, int numaNode)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_MEDIAQ);
 
+	if (pMediaQ) {
+		if (pMediaQ->pPvtMediaQInfo) {
+			media_q_info_t *pMediaQInfo = (media_q_info_t *)(pMediaQ->pPvtMediaQInfo);
+			pMediaQInfo->arenaNode = numaNode;
+		}
+	}
 
-bool openavbMediaQSetSize(media_q_t *pMediaQ, int itemCount, int itemSize)
+	AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ);
+}
+
+// Allocate the items of a queue. An itemSize of 0 leaves pPubData NULL.
+static bool x_openavbMediaQAllocItems(media_q_t *pMediaQ, int itemCount, int itemSize)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_MEDIAQ);
 
 	if (pMediaQ) {
-		if (itemCount < 1 || itemSize < 1) {
+		if (itemCount < 1 || itemSize < 0) {
 			AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ);
 			return FALSE;
 		}
@@ -277,22 +343,22 @@ bool openavbMediaQSetSize(media_q_t *pMediaQ, int itemCount, int itemSize)
 			// Don't want to re-allocate new memory each time
 			if (!pMediaQInfo->pItems)
 			{
-				pMediaQInfo->pItems = calloc(itemCount, sizeof(media_q_item_t));
-				if (pMediaQInfo->pItems) {
+				// Item array followed by the item data, in one contiguous block
+				size_t itemsLen = OPENAVB_ARENA_ALIGN(itemCount * sizeof(media_q_item_pvt_t));
+				size_t dataStride = itemSize ? OPENAVB_ARENA_ALIGN(itemSize + 4 /* Just in case */) : 0;
+				U8 *pBlock = openavbArenaAlloc(itemsLen + (itemCount * dataStride), pMediaQInfo->arenaNode);
+				if (pBlock) {
+					pMediaQInfo->pItems = (media_q_item_pvt_t *)pBlock;
 					pMediaQInfo->itemCount = itemCount;
 					pMediaQInfo->itemSize = itemSize;
 
 					int i1;
 					for (i1 = 0; i1 < itemCount; i1++) {
-						pMediaQInfo->pItems[i1].pAvtpTime = openavbAvtpTimeCreate(pMediaQInfo->maxLatencyUsec);
-						pMediaQInfo->pItems[i1].pPubData = calloc(1, itemSize + 4 /* Just in case */);
-						pMediaQInfo->pItems[i1].dataLen = 0;
-						pMediaQInfo->pItems[i1].itemSize = itemSize;
-						if (!pMediaQInfo->pItems[i1].pPubData) {
-							AVB_LOG_ERROR("Out of memory creating MediaQ item");
-							AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ);
-							return FALSE;
-						}
+						pMediaQInfo->pItems[i1].item.pAvtpTime = openavbAvtpTimeCreate(pMediaQInfo->maxLatencyUsec);
+						pMediaQInfo->pItems[i1].item.pPubData = itemSize ? pBlock + itemsLen + (i1 * dataStride) : NULL;
+						pMediaQInfo->pItems[i1].item.dataLen = 0;
+						pMediaQInfo->pItems[i1].item.itemSize = itemSize;
+						pMediaQInfo->pItems[i1].segCount = 0;
 					}
 				}
 				else {
@@ -318,6 +384,20 @@ bool openavbMediaQSetSize(media_q_t *pMediaQ, int itemCount, int itemSize)
 	return TRUE;
 }
 
+bool openavbMediaQSetSize(media_q_t *pMediaQ, int itemCount, int itemSize)
+{
+	if (itemSize < 1) {
+		AVB_LOGF_ERROR("Invalid media queue item size %d", itemSize);
+		return FALSE;
+	}
+	return x_openavbMediaQAllocItems(pMediaQ, itemCount, itemSize);
+}
+
+bool openavbMediaQSetSizeByRef(media_q_t *pMediaQ, int itemCount)
+{
+	return x_openavbMediaQAllocItems(pMediaQ, itemCount, 0);
+}
+
 bool openavbMediaQAllocItemMapData(media_q_t *pMediaQ, int itemPubMapSize, int itemPvtMapSize)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_MEDIAQ);
@@ -326,35 +406,33 @@ bool openavbMediaQAllocItemMapData(media_q_t *pMediaQ, int itemPubMapSize, int i
 		if (pMediaQ->pPvtMediaQInfo) {
 			media_q_info_t *pMediaQInfo = (media_q_info_t *)(pMediaQ->pPvtMediaQInfo);
 			if (pMediaQInfo->pItems) {
+				if (pMediaQInfo->pItemMapBlock) {
+					AVB_LOG_ERROR("Attempting to reallocate map data");
+					AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ);
+					return FALSE;
+				}
+				if (!itemPubMapSize && !itemPvtMapSize) {
+					AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ);
+					return TRUE;
+				}
+
+				// Public and private map data of an item sit next to each other
+				size_t pubStride = itemPubMapSize ? OPENAVB_ARENA_ALIGN(itemPubMapSize) : 0;
+				size_t pvtStride = itemPvtMapSize ? OPENAVB_ARENA_ALIGN(itemPvtMapSize) : 0;
+				pMediaQInfo->pItemMapBlock = openavbArenaAlloc(pMediaQInfo->itemCount * (pubStride + pvtStride), pMediaQInfo->arenaNode);
+				if (!pMediaQInfo->pItemMapBlock) {
+					AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ);
+					return FALSE;
+				}
+
 				int i1;
 				for (i1 = 0; i1 < pMediaQInfo->itemCount; i1++) {
+					U8 *pItemMap = pMediaQInfo->pItemMapBlock + (i1 * (pubStride + pvtStride));
 					if (itemPubMapSize) {
-						if (!pMediaQInfo->pItems[i1].pPubMapData) {
-							pMediaQInfo->pItems[i1].pPubMapData = calloc(1, itemPubMapSize);
-							if (!pMediaQInfo->pItems[i1].pPubMapData) {
-								AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ);
-								return FALSE;
-							}
-						}
-						else {
-							AVB_LOG_ERROR("Attempting to reallocate public map data");
-							AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ);
-							return FALSE;
-						}
+						pMediaQInfo->pItems[i1].item.pPubMapData = pItemMap;
 					}
 					if (itemPvtMapSize) {
-						if (!pMediaQInfo->pItems[i1].pPvtMapData) {
-							pMediaQInfo->pItems[i1].pPvtMapData = calloc(1, itemPvtMapSize);
-							if (!pMediaQInfo->pItems[i1].pPvtMapData) {
-								AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ);
-								return FALSE;
-							}
-						}
-						else {
-							AVB_LOG_ERROR("Attempting to reallocate private map data");
-							AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ);
-							return FALSE;
-						}
+						pMediaQInfo->pItems[i1].item.pPvtMapData = pItemMap + pubStride;
 					}
 				}
 
@@ -377,20 +455,22 @@ bool openavbMediaQAllocItemIntfData(media_q_t *pMediaQ, int itemIntfSize)
 		if (pMediaQ->pPvtMediaQInfo) {
 			media_q_info_t *pMediaQInfo = (media_q_info_t *)(pMediaQ->pPvtMediaQInfo);
 			if (pMediaQInfo->pItems) {
+				if (pMediaQInfo->pItemIntfBlock) {
+					AVB_LOG_ERROR("Attempting to reallocate private interface data");
+					AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ);
+					return FALSE;
+				}
+
+				size_t intfStride = OPENAVB_ARENA_ALIGN(itemIntfSize);
+				pMediaQInfo->pItemIntfBlock = openavbArenaAlloc(pMediaQInfo->itemCount * intfStride, pMediaQInfo->arenaNode);
+				if (!pMediaQInfo->pItemIntfBlock) {
+					AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ);
+					return FALSE;
+				}
+
 				int i1;
 				for (i1 = 0; i1 < pMediaQInfo->itemCount; i1++) {
-					if (!pMediaQInfo->pItems[i1].pPvtIntfData) {
-						pMediaQInfo->pItems[i1].pPvtIntfData = calloc(1, itemIntfSize);
-						if (!pMediaQInfo->pItems[i1].pPvtIntfData) {
-							AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ);
-							return FALSE;
-						}
-					}
-					else {
-						AVB_LOG_ERROR("Attempting to reallocate private interface data");
-						AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ);
-						return FALSE;
-					}
+					pMediaQInfo->pItems[i1].item.pPvtIntfData = pMediaQInfo->pItemIntfBlock + (i1 * intfStride);
 				}
 				AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ);
 				return TRUE;
@@ -426,33 +506,30 @@ bool openavbMediaQDelete(media_q_t *pMediaQ)
 		if (pMediaQ->pPvtMediaQInfo) {
 			media_q_info_t *pMediaQInfo = (media_q_info_t *)(pMediaQ->pPvtMediaQInfo);
 			if (pMediaQInfo->pItems) {
+				bool orphaned = FALSE;
 				int i1;
 				for (i1 = 0; i1 < pMediaQInfo->itemCount; i1++) {
-					
-					if (pMediaQInfo->pItems[i1].taken) {
-						AVB_LOG_ERROR("Deleting MediaQ with an item TAKEN. The item will be orphaned.");
+					if (pMediaQInfo->pItems[i1].item.taken) {
+						orphaned = TRUE;
 					}
 					else {
-						openavbAvtpTimeDelete(pMediaQInfo->pItems[i1].pAvtpTime);
-						if (pMediaQInfo->pItems[i1].pPubData) {
-							free(pMediaQInfo->pItems[i1].pPubData);
-							pMediaQInfo->pItems[i1].pPubData = NULL;
-						}
-						if (pMediaQInfo->pItems[i1].pPubMapData) {
-							free(pMediaQInfo->pItems[i1].pPubMapData);
-							pMediaQInfo->pItems[i1].pPubMapData = NULL;
-						}
-						if (pMediaQInfo->pItems[i1].pPvtMapData) {
-							free(pMediaQInfo->pItems[i1].pPvtMapData);
-							pMediaQInfo->pItems[i1].pPvtMapData = NULL;
-						}
-						if (pMediaQInfo->pItems[i1].pPvtIntfData) {
-							free(pMediaQInfo->pItems[i1].pPvtIntfData);
-							pMediaQInfo->pItems[i1].pPvtIntfData = NULL;
-						}
+						x_openavbMediaQItemReleaseSegs(&pMediaQInfo->pItems[i1].item);
+						openavbAvtpTimeDelete(pMediaQInfo->pItems[i1].item.pAvtpTime);
 					}
 				}
-				free(pMediaQInfo->pItems);
+
+				// Item memory is allocated in blocks shared by all items, so a
+				// taken item keeps all of them alive.
+				if (orphaned) {
+					AVB_LOG_ERROR("Deleting MediaQ with an item TAKEN. The item memory will be orphaned.");
+				}
+				else {
+					openavbArenaFree(pMediaQInfo->pItemIntfBlock);
+					openavbArenaFree(pMediaQInfo->pItemMapBlock);
+					openavbArenaFree(pMediaQInfo->pItems);
+				}
+				pMediaQInfo->pItemIntfBlock = NULL;
+				pMediaQInfo->pItemMapBlock = NULL;
 				pMediaQInfo->pItems = NULL;
 			}
 			free(pMediaQ->pPvtMediaQInfo);
@@ -530,7 +607,7 @@ media_q_item_t *openavbMediaQHeadLock(media_q_t *pMediaQ)
 					pMediaQInfo->headLocked = TRUE;
 					AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ_DETAIL);
 					// Mutex (LOCK()) if acquired stays locked
-					return &pMediaQInfo->pItems[pMediaQInfo->head];
+					return &pMediaQInfo->pItems[pMediaQInfo->head].item;
 				}
 			}
 			if (pMediaQInfo->threadSafeOn) {
@@ -572,10 +649,10 @@ bool openavbMediaQHeadPush(media_q_t *pMediaQ)
 			media_q_info_t *pMediaQInfo = (media_q_info_t *)(pMediaQ->pPvtMediaQInfo);
 			if (pMediaQInfo->itemCount > 0) {
 				if (pMediaQInfo->head > -1) {
-					media_q_item_t *pHead = &pMediaQInfo->pItems[pMediaQInfo->head];
+					media_q_item_t *pHead = &pMediaQInfo->pItems[pMediaQInfo->head].item;
 
 #if DUMP_HEAD_PUSH
-					media_q_item_t *pMediaQItem = &pMediaQInfo->pItems[pMediaQInfo->head];
+					media_q_item_t *pMediaQItem = &pMediaQInfo->pItems[pMediaQInfo->head].item;
 					if (!pFileHeadPush) {
 						char filename[128];
 						sprintf(filename, "headpush_%5.5d.dat", GET_PID());
@@ -629,7 +706,7 @@ media_q_item_t* openavbMediaQTailLock(media_q_t *pMediaQ, bool ignoreTimestamp)
 			}
 			if (pMediaQInfo->itemCount > 0) {
 				if (pMediaQInfo->tail > -1) {
-					media_q_item_t *pTail = &pMediaQInfo->pItems[pMediaQInfo->tail];
+					media_q_item_t *pTail = &pMediaQInfo->pItems[pMediaQInfo->tail].item;
 
 					// Check if tail item is ready.
 					if (!ignoreTimestamp) {
@@ -687,10 +764,10 @@ bool openavbMediaQTailPull(media_q_t *pMediaQ)
 			media_q_info_t *pMediaQInfo = (media_q_info_t *)(pMediaQ->pPvtMediaQInfo);
 			if (pMediaQInfo->itemCount > 0) {
 				if (pMediaQInfo->tail > -1) {
-					media_q_item_t *pTail = &pMediaQInfo->pItems[pMediaQInfo->tail];
+					media_q_item_t *pTail = &pMediaQInfo->pItems[pMediaQInfo->tail].item;
 
 #if DUMP_TAIL_PULL
-					media_q_item_t *pMediaQItem = &pMediaQInfo->pItems[pMediaQInfo->tail];
+					media_q_item_t *pMediaQItem = &pMediaQInfo->pItems[pMediaQInfo->tail].item;
 					if (!pFileTailPull) {
 						char filename[128];
 						sprintf(filename, "tailpull_%5.5d.dat", GET_PID());
@@ -710,6 +787,7 @@ bool openavbMediaQTailPull(media_q_t *pMediaQ)
 
 					pTail->readIdx = 0;		// Reset read index
 					pTail->dataLen = 0;		// Clears out the data
+					x_openavbMediaQItemReleaseSegs(pTail);
 
 					x_openavbMediaQIncrementTail(pMediaQInfo);
 
@@ -766,6 +844,7 @@ bool openavbMediaQTailItemGive(media_q_t *pMediaQ, media_q_item_t* pItem)
 		pItem->taken = FALSE;
 		pItem->readIdx = 0;		// Reset read index
 		pItem->dataLen = 0;		// Clears out the data
+		x_openavbMediaQItemReleaseSegs(pItem);
 
 		if (pMediaQ) {
 			if (pMediaQ->pPvtMediaQInfo) {
@@ -779,7 +858,7 @@ bool openavbMediaQTailItemGive(media_q_t *pMediaQ, media_q_item_t* pItem)
 						int i1;
 						for (i1 = 0; i1 < pMediaQInfo->itemCount; i1++)
 						{
-							if (!pMediaQInfo->pItems[i1].taken) {
+							if (!pMediaQInfo->pItems[i1].item.taken) {
 								pMediaQInfo->head = i1;
 								break;
 							}
@@ -809,7 +888,7 @@ bool openavbMediaQUsecTillTail(media_q_t *pMediaQ, U32 *pUsecTill)
 			media_q_info_t *pMediaQInfo = (media_q_info_t *)(pMediaQ->pPvtMediaQInfo);
 			if (pMediaQInfo->itemCount > 0) {
 				if (pMediaQInfo->tail > -1) {
-					media_q_item_t *pTail = &pMediaQInfo->pItems[pMediaQInfo->tail];
+					media_q_item_t *pTail = &pMediaQInfo->pItems[pMediaQInfo->tail].item;
 
 					U32 usecTill;
 					
@@ -846,7 +925,7 @@ bool openavbMediaQIsAvailableBytes(media_q_t *pMediaQ, U32 bytes, bool ignoreTim
 					int endIdx = pMediaQInfo->head > -1 ? pMediaQInfo->head : pMediaQInfo->tail;
 					if (ignoreTimestamp) {
 						while (1) {
-							media_q_item_t *pTail = &pMediaQInfo->pItems[tailIdx];
+							media_q_item_t *pTail = &pMediaQInfo->pItems[tailIdx].item;
 							
 							if (!pTail->taken) {
 								byteCnt += pTail->dataLen - pTail->readIdx;
@@ -869,7 +948,7 @@ bool openavbMediaQIsAvailableBytes(media_q_t *pMediaQ, U32 bytes, bool ignoreTim
 						U64 nSecTime;
 						CLOCK_GETTIME64(OPENAVB_CLOCK_WALLTIME, &nSecTime);
 						while (1) {
-							media_q_item_t *pTail = &pMediaQInfo->pItems[tailIdx];
+							media_q_item_t *pTail = &pMediaQInfo->pItems[tailIdx].item;
 							assert(pTail);
 
 							if (!pTail->taken) {
@@ -920,7 +999,7 @@ U32 openavbMediaQCountItems(media_q_t *pMediaQ, bool ignoreTimestamp)
 					int tailIdx = pMediaQInfo->tail;
 					if (ignoreTimestamp) {
 						while (1) {
-							media_q_item_t *pTail = &pMediaQInfo->pItems[tailIdx];
+							media_q_item_t *pTail = &pMediaQInfo->pItems[tailIdx].item;
 
 							if (!pTail->taken) {
 								itemCnt++;
@@ -939,7 +1018,7 @@ U32 openavbMediaQCountItems(media_q_t *pMediaQ, bool ignoreTimestamp)
 						U64 nSecTime;
 						CLOCK_GETTIME64(OPENAVB_CLOCK_WALLTIME, &nSecTime);
 						while (1) {
-							media_q_item_t *pTail = &pMediaQInfo->pItems[tailIdx];
+							media_q_item_t *pTail = &pMediaQInfo->pItems[tailIdx].item;
 
 							if (!pTail->taken) {
 								if (!openavbAvtpTimeIsPastTime(pTail->pAvtpTime, nSecTime))
@@ -982,7 +1061,7 @@ bool openavbMediaQAnyReadyItems(media_q_t *pMediaQ, bool ignoreTimestamp)
 					// Check if tail item is ready.
 					int tailIdx = pMediaQInfo->tail;
 					if (ignoreTimestamp) {
-						media_q_item_t *pTail = &pMediaQInfo->pItems[tailIdx];
+						media_q_item_t *pTail = &pMediaQInfo->pItems[tailIdx].item;
 
 						if (!pTail->taken) {
 							AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ_DETAIL);
@@ -992,7 +1071,7 @@ bool openavbMediaQAnyReadyItems(media_q_t *pMediaQ, bool ignoreTimestamp)
 					else {
 						U64 nSecTime;
 						CLOCK_GETTIME64(OPENAVB_CLOCK_WALLTIME, &nSecTime);
-						media_q_item_t *pTail = &pMediaQInfo->pItems[tailIdx];
+						media_q_item_t *pTail = &pMediaQInfo->pItems[tailIdx].item;
 						assert(pTail);
 					
 						if (!pTail->taken) {
@@ -1011,3 +1090,214 @@ bool openavbMediaQAnyReadyItems(media_q_t *pMediaQ, bool ignoreTimestamp)
 	return FALSE;
 }
 
+media_q_buf_t *openavbMediaQBufAlloc(U32 size)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_MEDIAQ_DETAIL);
+
+	// Buffer data follows the header
+	media_q_buf_t *pBuf = malloc(sizeof(media_q_buf_t) + size);
+	if (pBuf) {
+		pBuf->refCount = 1;
+		pBuf->size = size;
+		pBuf->pData = pBuf + 1;
+		pBuf->releaseCb = NULL;
+		pBuf->pCtx = NULL;
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ_DETAIL);
+	return pBuf;
+}
+
+media_q_buf_t *openavbMediaQBufWrap(void *pData, U32 size, media_q_buf_release_cb_t releaseCb, void *pCtx)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_MEDIAQ_DETAIL);
+
+	media_q_buf_t *pBuf = NULL;
+	if (pData || size == 0) {
+		pBuf = malloc(sizeof(media_q_buf_t));
+		if (pBuf) {
+			pBuf->refCount = 1;
+			pBuf->size = size;
+			pBuf->pData = pData;
+			pBuf->releaseCb = releaseCb;
+			pBuf->pCtx = pCtx;
+		}
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ_DETAIL);
+	return pBuf;
+}
+
+void openavbMediaQBufRef(media_q_buf_t *pBuf)
+{
+	if (pBuf) {
+		__atomic_add_fetch(&pBuf->refCount, 1, __ATOMIC_RELAXED);
+	}
+}
+
+void openavbMediaQBufUnref(media_q_buf_t *pBuf)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_MEDIAQ_DETAIL);
+
+	if (pBuf && __atomic_sub_fetch(&pBuf->refCount, 1, __ATOMIC_ACQ_REL) == 0) {
+		if (pBuf->releaseCb) {
+			pBuf->releaseCb(pBuf->pData, pBuf->pCtx);
+		}
+		free(pBuf);
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ_DETAIL);
+}
+
+void *openavbMediaQBufData(media_q_buf_t *pBuf)
+{
+	return pBuf ? pBuf->pData : NULL;
+}
+
+U32 openavbMediaQBufSize(media_q_buf_t *pBuf)
+{
+	return pBuf ? pBuf->size : 0;
+}
+
+// Copy data into the storage of an item that has no segments
+static bool x_openavbMediaQItemCopyIn(media_q_item_t *pItem, const void *pData, U32 len)
+{
+	if (((media_q_item_pvt_t *)pItem)->segCount || !pItem->pPubData || len > pItem->itemSize) {
+		AVB_LOGF_ERROR("Media queue item can't take %u bytes", len);
+		pItem->dataLen = 0;
+		return FALSE;
+	}
+	memcpy(pItem->pPubData, pData, len);
+	pItem->dataLen = len;
+	return TRUE;
+}
+
+bool openavbMediaQItemAddSeg(media_q_item_t *pItem, media_q_buf_t *pBuf, U32 offset, U32 len)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_MEDIAQ_DETAIL);
+
+	if (!pItem || !pBuf || offset > pBuf->size || len > pBuf->size - offset) {
+		AVB_LOG_ERROR("Invalid media queue item segment");
+		AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ_DETAIL);
+		return FALSE;
+	}
+	media_q_item_pvt_t *pPvtItem = (media_q_item_pvt_t *)pItem;
+	if (pPvtItem->segCount >= MEDIAQ_ITEM_MAX_SEGS) {
+		AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ_DETAIL);
+		return FALSE;
+	}
+	if (pPvtItem->segCount == 0) {
+		// Any data in pPubData is replaced by the segments
+		pItem->dataLen = 0;
+	}
+
+	openavbMediaQBufRef(pBuf);
+	pPvtItem->segs[pPvtItem->segCount].pBuf = pBuf;
+	pPvtItem->segs[pPvtItem->segCount].offset = offset;
+	pPvtItem->segs[pPvtItem->segCount].len = len;
+	pPvtItem->segCount++;
+	pItem->dataLen += len;
+
+	AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ_DETAIL);
+	return TRUE;
+}
+
+bool openavbMediaQItemAddData(media_q_item_t *pItem, void *pData, U32 len, media_q_buf_release_cb_t releaseCb, void *pCtx)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_MEDIAQ_DETAIL);
+
+	if (!pItem || !pData) {
+		if (releaseCb) {
+			releaseCb(pData, pCtx);
+		}
+		AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ_DETAIL);
+		return FALSE;
+	}
+
+	bool bAdded = FALSE;
+	media_q_buf_t *pBuf = openavbMediaQBufWrap(pData, len, releaseCb, pCtx);
+	if (pBuf) {
+		bAdded = openavbMediaQItemAddSeg(pItem, pBuf, 0, len);
+		if (!bAdded) {
+			// Copy before the last reference goes, which releases pData
+			bAdded = x_openavbMediaQItemCopyIn(pItem, pData, len);
+		}
+		// The item holds its own reference
+		openavbMediaQBufUnref(pBuf);
+	}
+	else {
+		bAdded = x_openavbMediaQItemCopyIn(pItem, pData, len);
+		if (releaseCb) {
+			releaseCb(pData, pCtx);
+		}
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ_DETAIL);
+	return bAdded;
+}
+
+U32 openavbMediaQItemCopy(media_q_item_t *pItem, U32 offset, void *pDst, U32 len)
+{
+	U8 *pOut = pDst;
+	U32 copied = 0;
+
+	if (!pItem || offset >= pItem->dataLen) {
+		return 0;
+	}
+	if (len > pItem->dataLen - offset) {
+		len = pItem->dataLen - offset;
+	}
+
+	media_q_item_pvt_t *pPvtItem = (media_q_item_pvt_t *)pItem;
+	if (pPvtItem->segCount == 0) {
+		memcpy(pOut, (U8 *)pItem->pPubData + offset, len);
+		return len;
+	}
+
+	U32 i1;
+	for (i1 = 0; i1 < pPvtItem->segCount && copied < len; i1++) {
+		media_q_item_seg_t *pSeg = &pPvtItem->segs[i1];
+		if (offset >= pSeg->len) {
+			offset -= pSeg->len;
+			continue;
+		}
+		U32 chunk = pSeg->len - offset;
+		if (chunk > len - copied) {
+			chunk = len - copied;
+		}
+		memcpy(pOut + copied, (U8 *)pSeg->pBuf->pData + pSeg->offset + offset, chunk);
+		copied += chunk;
+		offset = 0;
+	}
+	return copied;
+}
+
+const U8 *openavbMediaQItemSpan(media_q_item_t *pItem, U32 offset, U32 *pLen)
+{
+	*pLen = 0;
+	if (!pItem || offset >= pItem->dataLen) {
+		return NULL;
+	}
+
+	media_q_item_pvt_t *pPvtItem = (media_q_item_pvt_t *)pItem;
+	if (pPvtItem->segCount == 0) {
+		*pLen = pItem->dataLen - offset;
+		return (U8 *)pItem->pPubData + offset;
+	}
+
+	U32 i1;
+	for (i1 = 0; i1 < pPvtItem->segCount; i1++) {
+		media_q_item_seg_t *pSeg = &pPvtItem->segs[i1];
+		if (offset < pSeg->len) {
+			*pLen = pSeg->len - offset;
+			return (U8 *)pSeg->pBuf->pData + pSeg->offset + offset;
+		}
+		offset -= pSeg->len;
+	}
+	return NULL;
+}
+
+U32 openavbMediaQItemSegCount(media_q_item_t *pItem)
+{
+	return pItem ? ((media_q_item_pvt_t *)pItem)->segCount : 0;
+}
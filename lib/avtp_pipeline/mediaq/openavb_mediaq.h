@@ -44,6 +44,7 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 media_q_t* openavbMediaQCreate();
 void openavbMediaQThreadSafeOn(media_q_t *pMediaQ);
 bool openavbMediaQSetSize(media_q_t *pMediaQ, int itemCount, int itemSize);
+bool openavbMediaQSetSizeByRef(media_q_t *pMediaQ, int itemCount);
 bool openavbMediaQAllocItemMapData(media_q_t *pMediaQ, int itemPubMapSize, int itemPvtMapSize);
 bool openavbMediaQAllocItemIntfData(media_q_t *pMediaQ, int itemIntfSize);
 bool openavbMediaQDelete(media_q_t *pMediaQ);
@@ -57,5 +58,19 @@ void openavbMediaQTailUnlock(media_q_t *pMediaQ);
 bool openavbMediaQTailPull(media_q_t *pMediaQ);
 bool openavbMediaQUsecTillTail(media_q_t *pMediaQ, U32 *pUsecTill);
 bool openavbMediaQIsAvailableBytes(media_q_t *pMediaQ, U32 bytes, bool ignoreTimestamp);
+media_q_buf_t *openavbMediaQBufAlloc(U32 size);
+media_q_buf_t *openavbMediaQBufWrap(void *pData, U32 size, media_q_buf_release_cb_t releaseCb, void *pCtx);
+void openavbMediaQBufRef(media_q_buf_t *pBuf);
+void openavbMediaQBufUnref(media_q_buf_t *pBuf);
+void *openavbMediaQBufData(media_q_buf_t *pBuf);
+U32 openavbMediaQBufSize(media_q_buf_t *pBuf);
+bool openavbMediaQItemAddSeg(media_q_item_t *pItem, media_q_buf_t *pBuf, U32 offset, U32 len);
+bool openavbMediaQItemAddData(media_q_item_t *pItem, void *pData, U32 len, media_q_buf_release_cb_t releaseCb, void *pCtx);
+U32 openavbMediaQItemCopy(media_q_item_t *pItem, U32 offset, void *pDst, U32 len);
+const U8 *openavbMediaQItemSpan(media_q_item_t *pItem, U32 offset, U32 *pLen);
+U32 openavbMediaQItemSegCount(media_q_item_t *pItem);
+
+// Internal: NUMA node to allocate item memory from. Must be set before openavbMediaQSetSize().
+void openavbMediaQSetArenaNode(media_q_t *pMediaQ, int numaNode);
 
 #endif  // OPENAVB_MEDIA_Q_H
@@ -45,6 +45,26 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
  * Circular queue for passing data between interfaces and mappers.
  */
 
+/** Most external data segments a media queue item can reference.
+ */
+#define MEDIAQ_ITEM_MAX_SEGS	8
+
+/** Reference counted buffer that media queue items can point into.
+ *
+ * An interface module can place data in a media queue item by reference
+ * instead of copying it into the item storage: wrap (or allocate) a buffer,
+ * then add one or more segments of it to the item with
+ * openavbMediaQItemAddSeg(). Each segment holds a reference to its buffer that
+ * is dropped when the item is pulled, so a single buffer, for example a whole
+ * video frame, can back many items.
+ * \see openavbMediaQBufWrap openavbMediaQBufAlloc
+ */
+typedef struct media_q_buf media_q_buf_t;
+
+/** Called when the last reference to a wrapped buffer is dropped.
+ */
+typedef void (*media_q_buf_release_cb_t)(void *pData, void *pCtx);
+
 /** Media Queue Item structure.
  */
 typedef struct {
@@ -145,13 +165,29 @@ void openavbMediaQThreadSafeOn(media_q_t *pMediaQ);
  * \param pMediaQ A pointer to the media_q_t structure
  * \param itemCount Maximum number of items that the queue will hold. These are
  *        pre-allocated
- * \param itemSize The pre-allocated size of a media queue item
+ * \param itemSize The pre-allocated size of a media queue item. Must be at
+ *        least 1, use openavbMediaQSetSizeByRef() for items without storage.
  * \return TRUE on success or FALSE on failure
  *
  * \warning This must be called before using the MediaQ
  */
 bool openavbMediaQSetSize(media_q_t *pMediaQ, int itemCount, int itemSize);
 
+/** Set size of media queue items that hold data by reference only.
+ *
+ * Like openavbMediaQSetSize() but without item storage: pPubData is NULL and
+ * the interface module may only place data in items with
+ * openavbMediaQItemAddSeg(). Only for talkers whose mapping module reads items
+ * with openavbMediaQItemCopy() or openavbMediaQItemSpan().
+ *
+ * \param pMediaQ A pointer to the media_q_t structure
+ * \param itemCount Maximum number of items that the queue will hold
+ * \return TRUE on success or FALSE on failure
+ *
+ * \warning This must be called before using the MediaQ
+ */
+bool openavbMediaQSetSizeByRef(media_q_t *pMediaQ, int itemCount);
+
 /** Alloc item map data.
  *
  * Items in the media queue may also have per-item data that is managed by the
@@ -363,4 +399,129 @@ U32 openavbMediaQCountItems(media_q_t *pMediaQ, bool ignoreTimestamp);
  */
 bool openavbMediaQAnyReadyItems(media_q_t *pMediaQ, bool ignoreTimestamp);
 
+/** Allocate a reference counted buffer.
+ *
+ * \param size Size of the buffer data in bytes
+ * \return The buffer with one reference held by the caller, NULL on failure.
+ */
+media_q_buf_t *openavbMediaQBufAlloc(U32 size);
+
+/** Wrap existing memory in a reference counted buffer.
+ *
+ * The memory must stay valid until releaseCb is called, which happens when the
+ * last reference is dropped. Typically an interface module wraps a buffer it
+ * got from its media framework and releases that buffer in the callback.
+ *
+ * \param pData Start of the memory
+ * \param size Size of the memory in bytes
+ * \param releaseCb Called with pData and pCtx once the buffer is no longer
+ *        used. May be NULL.
+ * \param pCtx Passed to releaseCb
+ * \return The buffer with one reference held by the caller, NULL on failure.
+ */
+media_q_buf_t *openavbMediaQBufWrap(void *pData, U32 size, media_q_buf_release_cb_t releaseCb, void *pCtx);
+
+/** Take an additional reference to a buffer.
+ *
+ * \param pBuf The buffer
+ */
+void openavbMediaQBufRef(media_q_buf_t *pBuf);
+
+/** Drop a reference to a buffer.
+ *
+ * The buffer is released when the last reference is dropped. Safe to call
+ * from any thread.
+ *
+ * \param pBuf The buffer
+ */
+void openavbMediaQBufUnref(media_q_buf_t *pBuf);
+
+/** Get the data of a buffer.
+ *
+ * \param pBuf The buffer
+ * \return Start of the buffer data
+ */
+void *openavbMediaQBufData(media_q_buf_t *pBuf);
+
+/** Get the size of a buffer.
+ *
+ * \param pBuf The buffer
+ * \return Size of the buffer data in bytes
+ */
+U32 openavbMediaQBufSize(media_q_buf_t *pBuf);
+
+/** Add a segment of a buffer to a media queue item.
+ *
+ * Appends len bytes at offset in pBuf to the data of a locked head item and
+ * takes a reference to pBuf, which is dropped when the item is pulled. The
+ * caller keeps its own reference. dataLen grows by len. An item holds its data
+ * either in pPubData or in segments, not both.
+ *
+ * Mapping modules read segmented items with openavbMediaQItemCopy() or
+ * openavbMediaQItemSpan(). Mapping modules that access pPubData directly
+ * do not support segments. The segments are kept by the media queue, so this
+ * and the other item data functions only take items of a media queue.
+ *
+ * \param pItem A locked head item
+ * \param pBuf The buffer
+ * \param offset Offset of the segment in the buffer
+ * \param len Length of the segment
+ * \return TRUE on success, FALSE if the item has no free segment or the
+ *         segment is outside the buffer.
+ */
+bool openavbMediaQItemAddSeg(media_q_item_t *pItem, media_q_buf_t *pBuf, U32 offset, U32 len);
+
+/** Place data in a media queue item, by reference when possible.
+ *
+ * Wraps pData in a buffer and adds it to a locked head item as a segment, so
+ * it is only copied by the mapping module into the outgoing packet. If the
+ * item can't take another segment, or the buffer can't be allocated, the data
+ * is copied into pPubData instead. Either way releaseCb is called, with pData
+ * and pCtx, once the media queue no longer needs the data, which may be before
+ * this returns. The caller must not use pData after this call.
+ *
+ * \param pItem A locked head item
+ * \param pData The data
+ * \param len Length of the data
+ * \param releaseCb Called when the data is no longer needed, may be NULL
+ * \param pCtx Passed to releaseCb
+ * \return TRUE on success, FALSE if the data could neither be added nor copied.
+ */
+bool openavbMediaQItemAddData(media_q_item_t *pItem, void *pData, U32 len, media_q_buf_release_cb_t releaseCb, void *pCtx);
+
+/** Copy item data.
+ *
+ * Copies up to len bytes of item data starting at offset into pDst, from the
+ * segments of the item if it has any, from pPubData otherwise.
+ *
+ * \param pItem The item
+ * \param offset Offset into the item data
+ * \param pDst Destination
+ * \param len Bytes to copy
+ * \return The number of bytes copied, less than len if the item data ends
+ *         first.
+ */
+U32 openavbMediaQItemCopy(media_q_item_t *pItem, U32 offset, void *pDst, U32 len);
+
+/** Get contiguous item data.
+ *
+ * Returns a pointer to the item data at offset and in *pLen the number of bytes
+ * that are contiguous from there: up to the end of the segment holding offset,
+ * or up to dataLen for an item without segments.
+ *
+ * \param pItem The item
+ * \param offset Offset into the item data
+ * \param pLen Set to the number of contiguous bytes, 0 past the end.
+ * \return Pointer to the data, NULL past the end.
+ */
+const U8 *openavbMediaQItemSpan(media_q_item_t *pItem, U32 offset, U32 *pLen);
+
+/** Get the number of segments of an item.
+ *
+ * \param pItem The item
+ * \return The number of segments added with openavbMediaQItemAddSeg(), 0 when
+ *         the item data is in pPubData.
+ */
+U32 openavbMediaQItemSegCount(media_q_item_t *pItem);
+
 #endif  // OPENAVB_MEDIA_Q_PUB_H
@@ -71,6 +71,7 @@ extern bool openavbIntfViewerInitialize(media_q_t *pMediaQ, openavb_intf_cb_t *p
 extern bool openavbIntfAlsaInitialize(media_q_t *pMediaQ, openavb_intf_cb_t *pIntfCB);
 extern bool openavbIntfMpeg2tsFileInitialize(media_q_t *pMediaQ, openavb_intf_cb_t *pIntfCB);
 extern bool openavbIntfWavFileInitialize(media_q_t *pMediaQ, openavb_intf_cb_t *pIntfCB);
+extern bool openavbIntfShmInitialize(media_q_t *pMediaQ, openavb_intf_cb_t *pIntfCB);
 #ifdef AVB_FEATURE_GSTREAMER
 extern bool openavbIntfMjpegGstInitialize(media_q_t *pMediaQ, openavb_intf_cb_t *pIntfCB);
 extern bool openavbIntfMpeg2tsGstInitialize(media_q_t *pMediaQ, openavb_intf_cb_t *pIntfCB);
@@ -111,6 +112,7 @@ void openavbTlHostUsage(char *programName)
 		"\n"
 		"Usage: %s [options] file...\n"
 		"  -I val     Use given (val) interface globally, can be overriden by giving the ifname= option to the config line.\n"
+		"  -j val     Number of threads used to parse and configure the streams.  Defaults to one per CPU, at least 4.\n"
 		"  -l val     Filename of the log file to use.  If not specified, results will be logged to stderr.\n"
 		"\n"
 		"Examples:\n"
@@ -137,6 +139,7 @@ int main(int argc, char *argv[])
 	char *programName;
 	char *optIfnameGlobal = NULL;
 	char *optLogFileName = NULL;
+	U32 optWorkers = 0;
 
 	programName = strrchr(argv[0], '/');
 	programName = programName ? programName + 1 : argv[0];
@@ -152,12 +155,15 @@ int main(int argc, char *argv[])
 	// Process command line
 	bool optDone = FALSE;
 	while (!optDone) {
-		int opt = getopt(argc, argv, "hI:l:");
+		int opt = getopt(argc, argv, "hI:j:l:");
 		if (opt != EOF) {
 			switch (opt) {
 				case 'I':
 					optIfnameGlobal = strdup(optarg);
 					break;
+				case 'j':
+					optWorkers = strtoul(optarg, NULL, 0);
+					break;
 				case 'l':
 					optLogFileName = strdup(optarg);
 					break;
@@ -233,49 +239,30 @@ int main(int argc, char *argv[])
 	registerStaticIntfModule(openavbIntfAlsaInitialize);
 	registerStaticIntfModule(openavbIntfMpeg2tsFileInitialize);
 	registerStaticIntfModule(openavbIntfWavFileInitialize);
+	registerStaticIntfModule(openavbIntfShmInitialize);
 #ifdef AVB_FEATURE_GSTREAMER
 	registerStaticIntfModule(openavbIntfMjpegGstInitialize);
 	registerStaticIntfModule(openavbIntfMpeg2tsGstInitialize);
 	registerStaticIntfModule(openavbIntfH264RtpGstInitialize);
 #endif
 	tlHandleList = calloc(1, sizeof(tl_handle_t) * tlCount);
-
-	// Open all streams
-	for (i1 = 0; i1 < tlCount; i1++) {
-		tlHandleList[i1] = openavbTLOpen();
+	char **iniFiles = calloc(tlCount, sizeof(char *));
+	if (!tlHandleList || !iniFiles) {
+		AVB_LOG_ERROR("Unable to allocate stream list");
+		osalAVBFinalize();
+		exit(-1);
 	}
 
-	// Parse ini and configure all streams
 	for (i1 = 0; i1 < tlCount; i1++) {
-		openavb_tl_cfg_t cfg;
-		openavb_tl_cfg_name_value_t NVCfg;
 		char iniFile[1024];
 
 		snprintf(iniFile, sizeof(iniFile), "%s", argv[i1 + iniIdx]);
 
 		if (optIfnameGlobal && !strcasestr(iniFile, ",ifname=")) {
-			snprintf(iniFile + strlen(iniFile), sizeof(iniFile), ",ifname=%s", optIfnameGlobal);
+			snprintf(iniFile + strlen(iniFile), sizeof(iniFile) - strlen(iniFile), ",ifname=%s", optIfnameGlobal);
 		}
 
-		openavbTLInitCfg(&cfg);
-		memset(&NVCfg, 0, sizeof(NVCfg));
-
-		if (!openavbTLReadIniFileOsal(tlHandleList[i1], iniFile, &cfg, &NVCfg)) {
-			AVB_LOGF_ERROR("Error reading ini file: %s\n", argv[i1 + 1]);
-			osalAVBFinalize();
-			exit(-1);
-		}
-		if (!openavbTLConfigure(tlHandleList[i1], &cfg, &NVCfg)) {
-			AVB_LOGF_ERROR("Error configuring: %s\n", argv[i1 + 1]);
-			osalAVBFinalize();
-			exit(-1);
-		}
-
-		int i2;
-		for (i2 = 0; i2 < NVCfg.nLibCfgItems; i2++) {
-			free(NVCfg.libCfgNames[i2]);
-			free(NVCfg.libCfgValues[i2]);
-		}
+		iniFiles[i1] = strdup(iniFile);
 	}
 
 #ifdef AVB_FEATURE_GSTREAMER
@@ -284,12 +271,18 @@ int main(int argc, char *argv[])
 	gst_init(0, NULL);
 #endif
 
-	// Run any streams where the stop initial state was not requested.
+	// Open, parse ini, configure and run all streams
+	openavb_tl_startup_stats_t startupStats;
+	if (!openavbTLStartBatchOsal(tlHandleList, (const char **)iniFiles, tlCount, optWorkers, &startupStats)) {
+		AVB_LOGF_ERROR("Error starting streams: %u of %u configured", startupStats.nConfigured, tlCount);
+		osalAVBFinalize();
+		exit(-1);
+	}
+
 	for (i1 = 0; i1 < tlCount; i1++) {
-		if (openavbTLGetInitialState(tlHandleList[i1]) != TL_INIT_STATE_STOPPED) {
-			openavbTLRun(tlHandleList[i1]);
-		}
+		free(iniFiles[i1]);
 	}
+	free(iniFiles);
 
 	while (bRunning) {
 		SLEEP_MSEC(1);
@@ -84,6 +84,12 @@ static int cfgCallback(void *user, const char *section, const char *name, const
 				valOK = TRUE;
 			}
 		}
+		else if (MATCH(name, "single_thread_engine")) {
+			errno = 0;
+			pCfg->bSingleThreadEngine = (strtoul(value, &pEnd, 10) != 0);
+			if (*pEnd == '\0' && errno == 0)
+				valOK = TRUE;
+		}
 	}
 	else if (MATCH(section, "vlan"))
 	{
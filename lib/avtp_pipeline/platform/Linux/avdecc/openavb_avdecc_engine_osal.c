@@ -0,0 +1,707 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* MODULE SUMMARY : Single-thread AVDECC protocol engine (Linux)
+*
+* One thread polls the AVDECC socket and an eventfd. Received PDUs are
+* demultiplexed by AVTP subtype to the registered handlers, then every task
+* that was signalled or whose timeout expired is run, until none is due. The
+* poll timeout is the earliest task deadline.
+*
+* Rawsock implementations without a pollable descriptor (pcap) wait in
+* openavbRawsockGetRxFrame() instead, for at most ENGINE_MAX_WAIT_USEC, so
+* signals from other threads are picked up within that time.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
+#include "openavb_platform.h"
+
+#define	AVB_LOG_COMPONENT	"AVDECC"
+#include "openavb_log.h"
+
+#include "openavb_trace.h"
+#include "openavb_time.h"
+#include "openavb_avtp.h"
+#include "openavb_avdecc_engine.h"
+
+// AVDECC multicast address (ADP and ACMP)
+#define ENGINE_PROTOCOL_ADDR "91:E0:F0:01:00:00"
+
+// Frame size 0 lets the rawsock use the interface MTU; AECP PDUs are large
+#define ENGINE_FRAME_LEN		0
+#define ENGINE_NUM_BUFFERS		20
+
+// Frames taken from the socket per wakeup
+#define ENGINE_RX_BATCH			32
+
+// Bound on a wait when the rawsock can't be polled
+#define ENGINE_MAX_WAIT_USEC	10000
+
+// Longest task timeout; longer waits are cut short and the task waits again
+#define ENGINE_MAX_TIMEOUT_MSEC	(3600 * 1000)
+
+// do cast from ether_addr to U8*
+#define ADDR_PTR(A) (U8*)(&((A)->ether_addr_octet))
+
+typedef struct {
+	U8 subtype;
+	openavb_avdecc_engine_rx_cb_t cb;
+	void *pv;
+} engine_handler_t;
+
+static void *engineSock = NULL;
+static int engineSockFd = -1;
+static int engineWakeFd = -1;
+static struct ether_addr intfAddr;
+static struct ether_addr protocolAddr;
+
+static volatile bool bRunning = FALSE;
+static pthread_t engineThreadId;
+
+// Handlers, and the head of the task list
+static MUTEX_HANDLE_ALT(engineMutex);
+// Shared TX rawsock
+static MUTEX_HANDLE_ALT(engineTxMutex);
+
+static engine_handler_t handlers[OPENAVB_AVDECC_ENGINE_MAX_HANDLERS];
+static int handlerCount = 0;
+
+// Tasks are added at the head by any thread and only unlinked by the engine
+// thread, so the engine walks the list without holding the mutex.
+static openavb_avdecc_task_t *pTaskList = NULL;
+
+// A handler signalled a task while the engine thread dispatched a frame
+static bool bTaskSignalled = FALSE;
+
+static openavb_avdecc_engine_stats_t stats;
+
+THREAD_TYPE(openavbAvdeccEngineThread);
+THREAD_DEFINITON(openavbAvdeccEngineThread);
+
+static bool onEngineThread(void)
+{
+	return bRunning && pthread_equal(pthread_self(), engineThreadId);
+}
+
+static void engineWake(void)
+{
+	if (engineWakeFd >= 0 && !onEngineThread()) {
+		U64 one = 1;
+		if (write(engineWakeFd, &one, sizeof(one)) < 0 && errno != EAGAIN) {
+			AVB_LOGF_ERROR("Engine wakeup failed: %s", strerror(errno));
+		}
+	}
+}
+
+static void engineCloseSocket(void)
+{
+	if (engineSock) {
+		openavbRawsockClose(engineSock);
+		engineSock = NULL;
+	}
+	engineSockFd = -1;
+	if (engineWakeFd >= 0) {
+		close(engineWakeFd);
+		engineWakeFd = -1;
+	}
+}
+
+static bool engineOpenSocket(const char *ifname, U16 vlanID, U8 vlanPCP)
+{
+	hdr_info_t hdr;
+
+#ifndef UBUNTU
+	// This is the normal case for most of our supported platforms
+	engineSock = openavbRawsockOpen(ifname, TRUE, TRUE, ETHERTYPE_8021Q, ENGINE_FRAME_LEN, ENGINE_NUM_BUFFERS);
+#else
+	engineSock = openavbRawsockOpen(ifname, TRUE, TRUE, ETHERTYPE_AVTP, ENGINE_FRAME_LEN, ENGINE_NUM_BUFFERS);
+#endif
+
+	if (engineSock
+		&& openavbRawsockGetAddr(engineSock, ADDR_PTR(&intfAddr))
+		&& ether_aton_r(ENGINE_PROTOCOL_ADDR, &protocolAddr)
+		&& openavbRawsockRxMulticast(engineSock, TRUE, ADDR_PTR(&protocolAddr))
+		&& openavbRawsockRxMulticast(engineSock, TRUE, ADDR_PTR(&intfAddr)))
+	{
+		memset(&hdr, 0, sizeof(hdr_info_t));
+		hdr.shost = ADDR_PTR(&intfAddr);
+		hdr.dhost = ADDR_PTR(&protocolAddr);
+		hdr.ethertype = ETHERTYPE_AVTP;
+		if (vlanID != 0 || vlanPCP != 0) {
+			hdr.vlan = TRUE;
+			hdr.vlan_pcp = vlanPCP;
+			hdr.vlan_vid = vlanID;
+			AVB_LOGF_DEBUG("VLAN pcp=%d vid=%d", hdr.vlan_pcp, hdr.vlan_vid);
+		}
+		if (!openavbRawsockTxSetHdr(engineSock, &hdr)) {
+			AVB_LOG_ERROR("TX socket Header Failure");
+			engineCloseSocket();
+			return FALSE;
+		}
+
+		engineSockFd = openavbRawsockGetSocket(engineSock);
+		engineWakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+		if (engineWakeFd < 0) {
+			AVB_LOGF_ERROR("Engine eventfd failed: %s", strerror(errno));
+			engineCloseSocket();
+			return FALSE;
+		}
+		if (engineSockFd < 0) {
+			AVB_LOGF_INFO("Rawsock on %s can't be polled; engine waits at most %u usec", ifname, ENGINE_MAX_WAIT_USEC);
+		}
+		return TRUE;
+	}
+
+	AVB_LOG_ERROR("Invalid socket");
+	engineCloseSocket();
+	return FALSE;
+}
+
+static void engineDispatch(U8 *pBuf, U32 frameOffset, U32 len)
+{
+	hdr_info_t hdrInfo;
+	U8 *pFrame = pBuf + frameOffset;
+	int i;
+
+	memset(&hdrInfo, 0, sizeof(hdr_info_t));
+	int offset = openavbRawsockRxParseHdr(engineSock, pBuf, &hdrInfo);
+	if (offset < 0) {
+		return;
+	}
+
+	if (hdrInfo.ethertype == ETHERTYPE_8021Q) {
+		// Look past the VLAN tag
+		U16 vlan_bits = ntohs(*(U16 *)(pFrame + offset));
+		hdrInfo.vlan = TRUE;
+		hdrInfo.vlan_vid = vlan_bits & 0x0FFF;
+		hdrInfo.vlan_pcp = (vlan_bits >> 13) & 0x0007;
+		offset += 2;
+		hdrInfo.ethertype = ntohs(*(U16 *)(pFrame + offset));
+		offset += 2;
+	}
+
+	// AVDECC PDUs are AVTP control PDUs (cd bit set)
+	if (hdrInfo.ethertype != ETHERTYPE_AVTP || (U32)offset >= len || !(pFrame[offset] & 0x80)) {
+		return;
+	}
+	if (memcmp(hdrInfo.shost, ADDR_PTR(&intfAddr), ETH_ALEN) == 0) {
+		// Not from us!
+		return;
+	}
+
+	U8 subtype = pFrame[offset] & 0x7F;
+	bool bHandled = FALSE;
+	stats.rxFrames++;
+
+	MUTEX_LOCK_ALT(engineMutex);
+	for (i = 0; i < handlerCount; i++) {
+		if (handlers[i].subtype == subtype) {
+			handlers[i].cb(handlers[i].pv, pFrame + offset, len - offset, &hdrInfo);
+			bHandled = TRUE;
+		}
+	}
+	MUTEX_UNLOCK_ALT(engineMutex);
+
+	if (!bHandled) {
+		stats.rxUnhandled++;
+	}
+}
+
+static U32 engineRunTasks(void);
+
+// Receive up to ENGINE_RX_BATCH frames, waiting up to timeoutUsec for the first
+static void engineReceive(U32 timeoutUsec)
+{
+	U32 offset, len;
+	int n;
+
+	for (n = 0; n < ENGINE_RX_BATCH; n++) {
+		U8 *pBuf = openavbRawsockGetRxFrame(engineSock, n == 0 ? timeoutUsec : OPENAVB_RAWSOCK_NONBLOCK, &offset, &len);
+		if (!pBuf) {
+			break;
+		}
+		bTaskSignalled = FALSE;
+		engineDispatch(pBuf, offset, len);
+		openavbRawsockRelRxFrame(engineSock, pBuf);
+
+		// The state machines keep one received command each (e.g. ACMP
+		// pRcvdCmdResp), so the task a frame signalled has to take it in
+		// before the next frame of the batch overwrites it
+		if (bTaskSignalled) {
+			engineRunTasks();
+		}
+	}
+}
+
+static bool engineTaskDue(openavb_avdecc_task_t *pTask, struct timespec *pNow)
+{
+	if (pTask->bDone) {
+		return FALSE;
+	}
+	if (!pTask->bStarted || __atomic_load_n(&pTask->signals, __ATOMIC_ACQUIRE) > 0) {
+		return TRUE;
+	}
+	return pTask->bDeadline && openavbTimeTimespecCmp(pNow, &pTask->deadline) >= 0;
+}
+
+// Call the state machine once. Returns TRUE if it finished.
+static bool engineRunTask(openavb_avdecc_task_t *pTask, struct timespec *pNow)
+{
+	// A task woken by its deadline alone sees a timeout, as sem_timedwait() would
+	pTask->bTimedOut = pTask->bDeadline && openavbTimeTimespecCmp(pNow, &pTask->deadline) >= 0
+		&& __atomic_load_n(&pTask->signals, __ATOMIC_ACQUIRE) == 0;
+	pTask->bDeadline = FALSE;
+	pTask->bYielded = FALSE;
+	pTask->bStarted = TRUE;
+	stats.taskRuns++;
+
+	pTask->fn(pTask->pv);
+
+	if (pTask->bYielded) {
+		return FALSE;
+	}
+
+	AVB_LOGF_DEBUG("Task %s finished", pTask->name);
+	pTask->bDone = TRUE;
+	return TRUE;
+}
+
+static void engineUnlinkTask(openavb_avdecc_task_t *pTask)
+{
+	MUTEX_LOCK_ALT(engineMutex);
+	openavb_avdecc_task_t **ppTask = &pTaskList;
+	while (*ppTask && *ppTask != pTask) {
+		ppTask = &(*ppTask)->next;
+	}
+	if (*ppTask) {
+		*ppTask = pTask->next;
+	}
+	pTask->next = NULL;
+	MUTEX_UNLOCK_ALT(engineMutex);
+}
+
+// Run due tasks until none is due. Returns the wait until the next deadline.
+static U32 engineRunTasks(void)
+{
+	struct timespec now;
+	bool bRan = TRUE;
+
+	while (bRan) {
+		bRan = FALSE;
+		CLOCK_GETTIME(OPENAVB_CLOCK_MONOTONIC, &now);
+
+		MUTEX_LOCK_ALT(engineMutex);
+		openavb_avdecc_task_t *pTask = pTaskList;
+		MUTEX_UNLOCK_ALT(engineMutex);
+
+		while (pTask) {
+			openavb_avdecc_task_t *pNext = pTask->next;
+			if (engineTaskDue(pTask, &now)) {
+				bRan = TRUE;
+				if (engineRunTask(pTask, &now)) {
+					engineUnlinkTask(pTask);
+					SEM_ERR_T(err);
+					SEM_POST(pTask->doneSem, err);
+					SEM_LOG_ERR(err);
+				}
+			}
+			pTask = pNext;
+		}
+	}
+
+	// Earliest deadline
+	U64 waitUsec = (U64)-1;
+	CLOCK_GETTIME(OPENAVB_CLOCK_MONOTONIC, &now);
+	MUTEX_LOCK_ALT(engineMutex);
+	openavb_avdecc_task_t *pTask;
+	for (pTask = pTaskList; pTask; pTask = pTask->next) {
+		if (__atomic_load_n(&pTask->signals, __ATOMIC_ACQUIRE) > 0) {
+			waitUsec = 0;
+		}
+		else if (pTask->bDeadline) {
+			U64 untilUsec = openavbTimeUntilUSec(&now, &pTask->deadline);
+			if (untilUsec < waitUsec) {
+				waitUsec = untilUsec;
+			}
+		}
+	}
+	MUTEX_UNLOCK_ALT(engineMutex);
+
+	return waitUsec > 0xFFFFFFFE ? 0xFFFFFFFF : (U32)waitUsec;
+}
+
+void *openavbAvdeccEngineThreadFn(void *pv)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_AVDECC);
+
+	AVB_LOG_DEBUG("AVDECC Engine Thread Started");
+	while (bRunning) {
+		U32 waitUsec = engineRunTasks();
+
+		if (engineSockFd >= 0) {
+			struct pollfd fds[2];
+			fds[0].fd = engineSockFd;
+			fds[0].events = POLLIN;
+			fds[1].fd = engineWakeFd;
+			fds[1].events = POLLIN;
+
+			// Round up so a deadline is never polled for as 0 ms too early
+			int timeoutMsec = (waitUsec == 0xFFFFFFFF) ? -1 : (int)((waitUsec + 999) / 1000);
+			int rslt = poll(fds, 2, timeoutMsec);
+			stats.wakeups++;
+			if (rslt < 0) {
+				if (errno != EINTR) {
+					AVB_LOGF_ERROR("Engine poll failed: %s", strerror(errno));
+				}
+				continue;
+			}
+			if (fds[1].revents & POLLIN) {
+				U64 count;
+				if (read(engineWakeFd, &count, sizeof(count)) < 0 && errno != EAGAIN) {
+					AVB_LOGF_ERROR("Engine wakeup read failed: %s", strerror(errno));
+				}
+			}
+			if (fds[0].revents & POLLIN) {
+				engineReceive(OPENAVB_RAWSOCK_NONBLOCK);
+			}
+		}
+		else {
+			// GetRxFrame treats a timeout of 0 as "don't wait"
+			if (waitUsec > ENGINE_MAX_WAIT_USEC) {
+				waitUsec = ENGINE_MAX_WAIT_USEC;
+			}
+			engineReceive(waitUsec);
+			stats.wakeups++;
+		}
+	}
+	AVB_LOG_DEBUG("AVDECC Engine Thread Done");
+
+	AVB_TRACE_EXIT(AVB_TRACE_AVDECC);
+	return NULL;
+}
+
+bool openavbAvdeccEngineStart(const char *ifname, U16 vlanID, U8 vlanPCP)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_AVDECC);
+
+	if (bRunning) {
+		AVB_LOG_ERROR("AVDECC engine already running");
+		AVB_TRACE_EXIT(AVB_TRACE_AVDECC);
+		return FALSE;
+	}
+
+	MUTEX_CREATE_ALT(engineMutex);
+	MUTEX_CREATE_ALT(engineTxMutex);
+	handlerCount = 0;
+	pTaskList = NULL;
+	memset(&stats, 0, sizeof(stats));
+
+	if (!engineOpenSocket(ifname, vlanID, vlanPCP)) {
+		AVB_TRACE_EXIT(AVB_TRACE_AVDECC);
+		return FALSE;
+	}
+
+	bRunning = TRUE;
+
+	bool errResult;
+	THREAD_CREATE(openavbAvdeccEngineThread, openavbAvdeccEngineThread, NULL, openavbAvdeccEngineThreadFn, NULL);
+	THREAD_CHECK_ERROR(openavbAvdeccEngineThread, "Thread / task creation failed", errResult);
+	if (errResult) {
+		bRunning = FALSE;
+		engineCloseSocket();
+		AVB_TRACE_EXIT(AVB_TRACE_AVDECC);
+		return FALSE;
+	}
+	engineThreadId = openavbAvdeccEngineThread_ThreadData.pthread;
+
+	AVB_LOGF_INFO("AVDECC engine running on %s", ifname);
+	AVB_TRACE_EXIT(AVB_TRACE_AVDECC);
+	return TRUE;
+}
+
+void openavbAvdeccEngineStop(void)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_AVDECC);
+
+	if (bRunning) {
+		if (pTaskList || handlerCount) {
+			AVB_LOG_WARNING("AVDECC engine stopped with tasks or handlers still registered");
+		}
+
+		// Clearing bRunning makes engineWake() treat us as a foreign thread
+		bRunning = FALSE;
+		U64 one = 1;
+		if (write(engineWakeFd, &one, sizeof(one)) < 0) {
+			AVB_LOGF_ERROR("Engine wakeup failed: %s", strerror(errno));
+		}
+		THREAD_JOIN(openavbAvdeccEngineThread, NULL);
+		engineCloseSocket();
+
+		MUTEX_DESTROY_ALT(engineMutex);
+		MUTEX_DESTROY_ALT(engineTxMutex);
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_AVDECC);
+}
+
+bool openavbAvdeccEngineIsRunning(void)
+{
+	return bRunning;
+}
+
+bool openavbAvdeccEngineGetAddr(U8 addr[ETH_ALEN])
+{
+	if (!bRunning) {
+		return FALSE;
+	}
+	memcpy(addr, ADDR_PTR(&intfAddr), ETH_ALEN);
+	return TRUE;
+}
+
+bool openavbAvdeccEngineRegister(U8 subtype, openavb_avdecc_engine_rx_cb_t cb, void *pv)
+{
+	bool bOK = FALSE;
+
+	if (!bRunning || !cb) {
+		return FALSE;
+	}
+
+	MUTEX_LOCK_ALT(engineMutex);
+	if (handlerCount < OPENAVB_AVDECC_ENGINE_MAX_HANDLERS) {
+		handlers[handlerCount].subtype = subtype;
+		handlers[handlerCount].cb = cb;
+		handlers[handlerCount].pv = pv;
+		handlerCount++;
+		bOK = TRUE;
+	}
+	MUTEX_UNLOCK_ALT(engineMutex);
+
+	if (!bOK) {
+		AVB_LOGF_ERROR("No room for a handler of AVTP subtype 0x%02x", subtype);
+	}
+	return bOK;
+}
+
+void openavbAvdeccEngineUnregister(U8 subtype, openavb_avdecc_engine_rx_cb_t cb, void *pv)
+{
+	int i;
+
+	if (!bRunning) {
+		return;
+	}
+
+	MUTEX_LOCK_ALT(engineMutex);
+	for (i = 0; i < handlerCount; i++) {
+		if (handlers[i].subtype == subtype && handlers[i].cb == cb && handlers[i].pv == pv) {
+			handlers[i] = handlers[--handlerCount];
+			break;
+		}
+	}
+	MUTEX_UNLOCK_ALT(engineMutex);
+}
+
+void *openavbAvdeccEngineTxSock(void)
+{
+	return bRunning ? engineSock : NULL;
+}
+
+void openavbAvdeccEngineTxLock(void)
+{
+	if (bRunning) {
+		MUTEX_LOCK_ALT(engineTxMutex);
+	}
+}
+
+void openavbAvdeccEngineTxUnlock(void)
+{
+	if (bRunning) {
+		MUTEX_UNLOCK_ALT(engineTxMutex);
+	}
+}
+
+void openavbAvdeccEngineGetStats(openavb_avdecc_engine_stats_t *pStats)
+{
+	*pStats = stats;
+}
+
+void openavbAvdeccTaskInit(openavb_avdecc_task_t *pTask, const char *name, openavb_avdecc_task_fn_t fn, void *pv, U32 initialSignals)
+{
+	memset(pTask, 0, sizeof(*pTask));
+	pTask->name = name;
+	pTask->fn = fn;
+	pTask->pv = pv;
+	pTask->bEngine = bRunning;
+
+	SEM_ERR_T(err);
+	if (pTask->bEngine) {
+		pTask->signals = initialSignals;
+		SEM_INIT(pTask->doneSem, 0, err);
+	}
+	else {
+		SEM_INIT(pTask->sem, initialSignals, err);
+	}
+	SEM_LOG_ERR(err);
+}
+
+void openavbAvdeccTaskDestroy(openavb_avdecc_task_t *pTask)
+{
+	SEM_ERR_T(err);
+	if (pTask->bEngine) {
+		SEM_DESTROY(pTask->doneSem, err);
+	}
+	else {
+		SEM_DESTROY(pTask->sem, err);
+	}
+	SEM_LOG_ERR(err);
+}
+
+bool openavbAvdeccEngineAddTask(openavb_avdecc_task_t *pTask)
+{
+	if (!pTask->bEngine) {
+		return FALSE;
+	}
+
+	MUTEX_LOCK_ALT(engineMutex);
+	pTask->next = pTaskList;
+	pTaskList = pTask;
+	MUTEX_UNLOCK_ALT(engineMutex);
+
+	engineWake();
+	return TRUE;
+}
+
+bool openavbAvdeccEngineRemoveTask(openavb_avdecc_task_t *pTask)
+{
+	if (!pTask->bEngine) {
+		return FALSE;
+	}
+
+	if (onEngineThread()) {
+		// Can't wait for ourselves; the task was told to terminate, so run it to the end here
+		struct timespec now;
+		while (!pTask->bDone) {
+			CLOCK_GETTIME(OPENAVB_CLOCK_MONOTONIC, &now);
+			if (engineRunTask(pTask, &now)) {
+				break;
+			}
+			if (!engineTaskDue(pTask, &now)) {
+				AVB_LOGF_ERROR("Task %s did not terminate", pTask->name);
+				break;
+			}
+		}
+		engineUnlinkTask(pTask);
+		return TRUE;
+	}
+
+	if (bRunning) {
+		SEM_ERR_T(err);
+		SEM_WAIT(pTask->doneSem, err);
+		SEM_LOG_ERR(err);
+	}
+	return TRUE;
+}
+
+void openavbAvdeccTaskSignal(openavb_avdecc_task_t *pTask)
+{
+	if (pTask->bEngine) {
+		__atomic_add_fetch(&pTask->signals, 1, __ATOMIC_RELEASE);
+		if (onEngineThread()) {
+			bTaskSignalled = TRUE;
+		}
+		engineWake();
+	}
+	else {
+		SEM_ERR_T(err);
+		SEM_POST(pTask->sem, err);
+		SEM_LOG_ERR(err);
+	}
+}
+
+openavb_avdecc_task_wait_t openavbAvdeccTaskWait(openavb_avdecc_task_t *pTask, U32 timeoutMSec)
+{
+	if (!pTask->bEngine) {
+		SEM_ERR_T(err);
+		if (timeoutMSec == OPENAVB_AVDECC_TASK_WAIT_FOREVER) {
+			SEM_WAIT(pTask->sem, err);
+		}
+		else {
+			SEM_TIMEDWAIT(pTask->sem, timeoutMSec, err);
+		}
+		if (SEM_IS_ERR_NONE(err)) {
+			return OPENAVB_AVDECC_TASK_WOKEN;
+		}
+		if (SEM_IS_ERR_TIMEOUT(err)) {
+			return OPENAVB_AVDECC_TASK_TIMEOUT;
+		}
+		AVB_LOGF_WARNING("Semaphore error %d", err);
+		return OPENAVB_AVDECC_TASK_ERROR;
+	}
+
+	// Engine mode: consume a signal, report an expired timeout, or yield
+	U32 signals = __atomic_load_n(&pTask->signals, __ATOMIC_ACQUIRE);
+	while (signals > 0) {
+		if (__atomic_compare_exchange_n(&pTask->signals, &signals, signals - 1, FALSE, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+			pTask->bResume = FALSE;
+			pTask->bTimedOut = FALSE;
+			return OPENAVB_AVDECC_TASK_WOKEN;
+		}
+	}
+
+	if (pTask->bTimedOut || timeoutMSec == 0) {
+		pTask->bResume = FALSE;
+		pTask->bTimedOut = FALSE;
+		return OPENAVB_AVDECC_TASK_TIMEOUT;
+	}
+
+	pTask->bYielded = TRUE;
+	pTask->bResume = TRUE;
+	if (timeoutMSec != OPENAVB_AVDECC_TASK_WAIT_FOREVER) {
+		if (timeoutMSec > ENGINE_MAX_TIMEOUT_MSEC) {
+			timeoutMSec = ENGINE_MAX_TIMEOUT_MSEC;
+		}
+		CLOCK_GETTIME(OPENAVB_CLOCK_MONOTONIC, &pTask->deadline);
+		openavbTimeTimespecAddUsec(&pTask->deadline, timeoutMSec * 1000);
+		pTask->bDeadline = TRUE;
+	}
+	return OPENAVB_AVDECC_TASK_YIELD;
+}
+
+bool openavbAvdeccTaskResumed(openavb_avdecc_task_t *pTask)
+{
+	return pTask->bEngine && pTask->bResume;
+}
@@ -32,10 +32,34 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #ifndef OPENAVB_AVDECC_MSG_CLIENT_OSAL_C
 #define OPENAVB_AVDECC_MSG_CLIENT_OSAL_C
 
+#if AVB_FEATURE_SHM_IPC
+#include "openavb_shm_mbox_osal.h"
+
+// Mailboxes of the open connections, indexed by socket handle. Connections on
+// higher descriptors stay on the socket.
+#define CLNT_MBOX_MAX_HANDLE	1024
+// Service calls without a server heartbeat before the socket is checked
+#define CLNT_MBOX_STALE_CHECKS	3
+
+static shm_mbox_t *x_clntMbox[CLNT_MBOX_MAX_HANDLE];
+
+static shm_mbox_t *clntMbox(int socketHandle)
+{
+	return (socketHandle >= 0 && socketHandle < CLNT_MBOX_MAX_HANDLE) ? x_clntMbox[socketHandle] : NULL;
+}
+#endif
+
 static void socketClose(int socketHandle)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_AVDECC_MSG);
 	if (socketHandle != AVB_AVDECC_MSG_HANDLE_INVALID) {
+#if AVB_FEATURE_SHM_IPC
+		shm_mbox_t *pMbox = clntMbox(socketHandle);
+		if (pMbox) {
+			x_clntMbox[socketHandle] = NULL;
+			osalShmMboxClose(pMbox);
+		}
+#endif
 		close(socketHandle);
 	}
 	AVB_TRACE_EXIT(AVB_TRACE_AVDECC_MSG);
@@ -51,6 +75,20 @@ static bool openavbAvdeccMsgClntSendToServer(int socketHandle, openavbAvdeccMess
 		return FALSE;
 	}
 
+#if AVB_FEATURE_SHM_IPC
+	shm_mbox_t *pMbox = clntMbox(socketHandle);
+	if (pMbox) {
+		if (!osalShmMboxSend(pMbox, msg)) {
+			AVB_LOG_ERROR("Client send: mailbox full or closed");
+			socketClose(socketHandle);
+			AVB_TRACE_EXIT(AVB_TRACE_AVDECC_MSG);
+			return FALSE;
+		}
+		AVB_TRACE_EXIT(AVB_TRACE_AVDECC_MSG);
+		return TRUE;
+	}
+#endif
+
 	ssize_t nWrite = write(socketHandle, msg, OPENAVB_AVDECC_MSG_LEN);
 	AVB_LOGF_VERBOSE("Sent message, len=%zu, nWrite=%zu", OPENAVB_AVDECC_MSG_LEN, nWrite);
 
@@ -96,6 +134,29 @@ int openavbAvdeccMsgClntOpenSrvrConnection(void)
 		return AVB_AVDECC_MSG_HANDLE_INVALID;
 	}
 
+#if AVB_FEATURE_SHM_IPC
+	// The AVDECC Msg server offers a shared memory mailbox as soon as it accepts
+	bool bOk;
+	shm_mbox_t *pMbox = osalShmMboxAccept(h, OPENAVB_AVDECC_MSG_LEN, 1000, &bOk);
+	if (!bOk) {
+		socketClose(h);
+		AVB_TRACE_EXIT(AVB_TRACE_AVDECC_MSG);
+		return AVB_AVDECC_MSG_HANDLE_INVALID;
+	}
+	if (pMbox) {
+		if (h < CLNT_MBOX_MAX_HANDLE) {
+			x_clntMbox[h] = pMbox;
+		}
+		else {
+			AVB_LOG_ERROR("Socket handle too large for mailbox table");
+			osalShmMboxClose(pMbox);
+			socketClose(h);
+			AVB_TRACE_EXIT(AVB_TRACE_AVDECC_MSG);
+			return AVB_AVDECC_MSG_HANDLE_INVALID;
+		}
+	}
+#endif
+
 	AVB_LOG_DEBUG("Connected to AVDECC Msg");
 	AVB_TRACE_EXIT(AVB_TRACE_AVDECC_MSG);
 	return h;
@@ -109,6 +170,59 @@ void openavbAvdeccMsgClntCloseSrvrConnection(int socketHandle)
 	AVB_TRACE_EXIT(AVB_TRACE_AVDECC_MSG);
 }
 
+#if AVB_FEATURE_SHM_IPC
+// Service a connection that uses a shared memory mailbox. With timeout 0 this
+// makes no system calls unless the server looks like it has gone away.
+static bool openavbAvdeccMsgClntServiceMbox(int socketHandle, shm_mbox_t *pMbox, int timeout)
+{
+	openavbAvdeccMessage_t msgBuf;
+	bool bHangup = FALSE;
+
+	if (timeout != 0 && osalShmMboxPrepareWait(pMbox)) {
+		struct pollfd fds[2];
+		memset(fds, 0, sizeof(fds));
+		fds[0].fd = osalShmMboxDoorbellFd(pMbox);
+		fds[0].events = POLLIN;
+		fds[1].fd = socketHandle;
+		fds[1].events = POLLIN;
+
+		AVB_LOG_VERBOSE("Waiting for event...");
+		int pRet = poll(fds, 2, timeout);
+		if (pRet < 0 && errno != EINTR) {
+			AVB_LOGF_ERROR("Poll error: %s", strerror(errno));
+		}
+		if (pRet > 0 && fds[0].revents) {
+			osalShmMboxDrainDoorbell(fds[0].fd);
+		}
+		// The server never writes to the socket once the mailbox is up
+		bHangup = pRet > 0 && fds[1].revents;
+	}
+	osalShmMboxFinishWait(pMbox);
+
+	while (osalShmMboxRecv(pMbox, &msgBuf)) {
+		if (!openavbAvdeccMsgClntReceiveFromServer(socketHandle, &msgBuf)) {
+			AVB_LOG_ERROR("Invalid message received");
+			socketClose(socketHandle);
+			return FALSE;
+		}
+	}
+
+	if (!bHangup && osalShmMboxPeerSuspect(pMbox, CLNT_MBOX_STALE_CHECKS)) {
+		struct pollfd fd;
+		fd.fd = socketHandle;
+		fd.events = POLLIN;
+		fd.revents = 0;
+		bHangup = poll(&fd, 1, 0) > 0;
+	}
+	if (bHangup) {
+		AVB_LOG_ERROR("Socket closed unexpectedly");
+		socketClose(socketHandle);
+		return FALSE;
+	}
+	return TRUE;
+}
+#endif
+
 bool openavbAvdeccMsgClntService(int socketHandle, int timeout)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_AVDECC_MSG);
@@ -120,6 +234,15 @@ bool openavbAvdeccMsgClntService(int socketHandle, int timeout)
 		return FALSE;
 	}
 
+#if AVB_FEATURE_SHM_IPC
+	shm_mbox_t *pMbox = clntMbox(socketHandle);
+	if (pMbox) {
+		rc = openavbAvdeccMsgClntServiceMbox(socketHandle, pMbox, timeout);
+		AVB_TRACE_EXIT(AVB_TRACE_AVDECC_MSG);
+		return rc;
+	}
+#endif
+
 	struct pollfd fds[1];
 	memset(fds, 0, sizeof(struct pollfd));
 	fds[0].fd = socketHandle;
@@ -37,9 +37,20 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #define POLL_FD_COUNT ((MAX_AVB_STREAMS) + 1)
 
 static int lsock  = SOCK_INVALID;
-static struct pollfd fds[POLL_FD_COUNT];
 static struct sockaddr_un serverAddr;
 
+#if AVB_FEATURE_SHM_IPC
+#include "openavb_shm_mbox_osal.h"
+
+// The doorbell shared by all client mailboxes is polled after the sockets
+#define AVB_AVDECC_DOORBELL_FDS	POLL_FD_COUNT
+static struct pollfd fds[POLL_FD_COUNT + 1];
+static shm_mbox_t *mboxes[POLL_FD_COUNT];
+static int doorbellFd = SOCK_INVALID;
+#else
+static struct pollfd fds[POLL_FD_COUNT];
+#endif
+
 static void socketClose(int h)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_AVDECC_MSG);
@@ -51,9 +62,16 @@ static void socketClose(int h)
 		if (h != AVB_AVDECC_LISTEN_FDS) {
 			openavbAvdeccMsgSrvrCloseClientConnection(h);
 		}
+#if AVB_FEATURE_SHM_IPC
+		if (mboxes[h]) {
+			osalShmMboxClose(mboxes[h]);
+			mboxes[h] = NULL;
+		}
+#endif
 		close(fds[h].fd);
 		fds[h].fd = SOCK_INVALID;
 		fds[h].events = 0;
+		fds[h].revents = 0;
 	}
 
 	AVB_TRACE_EXIT(AVB_TRACE_AVDECC_MSG);
@@ -80,6 +98,19 @@ static bool openavbAvdeccMsgSrvrSendToClient(int h, openavbAvdeccMessage_t *msg)
 		return FALSE;
 	}
 
+#if AVB_FEATURE_SHM_IPC
+	if (mboxes[h]) {
+		if (!osalShmMboxSend(mboxes[h], msg)) {
+			AVB_LOGF_ERROR("Mailbox full or closed, h=%d", h);
+			socketClose(h);
+			AVB_TRACE_EXIT(AVB_TRACE_AVDECC_MSG);
+			return FALSE;
+		}
+		AVB_TRACE_EXIT(AVB_TRACE_AVDECC_MSG);
+		return TRUE;
+	}
+#endif
+
 	ssize_t nWrite = write(csock, msg, OPENAVB_AVDECC_MSG_LEN);
 	AVB_LOGF_VERBOSE("Sent message, len=%zu, nWrite=%zu", OPENAVB_AVDECC_MSG_LEN, nWrite);
 	if (nWrite < OPENAVB_AVDECC_MSG_LEN) {
@@ -114,6 +145,13 @@ bool openavbAvdeccMsgServerOpen(void)
 		fds[i].events = 0;
 	}
 
+#if AVB_FEATURE_SHM_IPC
+	// Without a doorbell clients are simply kept on their sockets
+	doorbellFd = osalShmMboxCreateDoorbell();
+	fds[AVB_AVDECC_DOORBELL_FDS].fd = doorbellFd;
+	fds[AVB_AVDECC_DOORBELL_FDS].events = POLLIN;
+#endif
+
 	lsock = socket(AF_UNIX, SOCK_STREAM, 0);
 	if (lsock < 0) {
 		AVB_LOGF_ERROR("Failed to open socket: %s", strerror(errno));
@@ -157,6 +195,52 @@ bool openavbAvdeccMsgServerOpen(void)
 	return FALSE;
 }
 
+#if AVB_FEATURE_SHM_IPC
+// Handle everything queued in the client mailboxes
+static void openavbAvdeccMsgSrvrServiceMailboxes(void)
+{
+	openavbAvdeccMessage_t msgBuf;
+	int i;
+
+	for (i = 0; i < POLL_FD_COUNT; i++) {
+		while (mboxes[i] && osalShmMboxRecv(mboxes[i], &msgBuf)) {
+			if (!openavbAvdeccMsgSrvrReceiveFromClient(i, &msgBuf)) {
+				AVB_LOG_ERROR("Failed to handle message");
+				socketClose(i);
+			}
+		}
+		if (mboxes[i]) {
+			osalShmMboxHeartbeat(mboxes[i]);
+		}
+	}
+}
+
+// Announce the wait to every client; returns the poll timeout to use
+static int openavbAvdeccMsgSrvrPrepareWait(int timeout)
+{
+	int i;
+	for (i = 0; i < POLL_FD_COUNT; i++) {
+		if (mboxes[i] && !osalShmMboxPrepareWait(mboxes[i])) {
+			timeout = 0;
+		}
+	}
+	return timeout;
+}
+
+static void openavbAvdeccMsgSrvrFinishWait(void)
+{
+	int i;
+	for (i = 0; i < POLL_FD_COUNT; i++) {
+		if (mboxes[i]) {
+			osalShmMboxFinishWait(mboxes[i]);
+		}
+	}
+	if (fds[AVB_AVDECC_DOORBELL_FDS].revents) {
+		osalShmMboxDrainDoorbell(doorbellFd);
+	}
+}
+#endif
+
 void openavbAvdeccMsgSrvrService(void)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_AVDECC_MSG);
@@ -169,7 +253,17 @@ void openavbAvdeccMsgSrvrService(void)
 	int pRet;
 
 	AVB_LOG_VERBOSE("Waiting for event...");
+#if AVB_FEATURE_SHM_IPC
+	pRet = poll(fds, POLL_FD_COUNT + 1, openavbAvdeccMsgSrvrPrepareWait(1000));
+	openavbAvdeccMsgSrvrFinishWait();
+	// Mailbox messages first, so a client's last message is handled before its hangup
+	openavbAvdeccMsgSrvrServiceMailboxes();
+	if (pRet > 0 && fds[AVB_AVDECC_DOORBELL_FDS].revents) {
+		pRet--;
+	}
+#else
 	pRet = poll(fds, nfds, 1000);
+#endif
 
 	if (pRet == 0) {
 		AVB_LOG_VERBOSE("poll timeout");
@@ -207,6 +301,15 @@ void openavbAvdeccMsgSrvrService(void)
 							AVB_LOG_ERROR("Too many client connections");
 							close(csock);
 						}
+#if AVB_FEATURE_SHM_IPC
+						else {
+							bool bOfferSent;
+							mboxes[j] = osalShmMboxOffer(csock, OPENAVB_AVDECC_MSG_LEN, doorbellFd, &bOfferSent);
+							if (!bOfferSent) {
+								socketClose(j);
+							}
+						}
+#endif
 					}
 
 					AVB_LOG_INFO("New AVDECC Msg client connection detected");
@@ -257,6 +360,13 @@ void openavbAvdeccMsgServerClose(void)
 	if (lsock != SOCK_INVALID) {
 		close(lsock);
 	}
+#if AVB_FEATURE_SHM_IPC
+	if (doorbellFd != SOCK_INVALID) {
+		close(doorbellFd);
+		doorbellFd = SOCK_INVALID;
+		fds[AVB_AVDECC_DOORBELL_FDS].fd = SOCK_INVALID;
+	}
+#endif
 
 	if (unlink(serverAddr.sun_path) != 0) {
 		AVB_LOGF_ERROR("Failed to unlink %s: %s", serverAddr.sun_path, strerror(errno));
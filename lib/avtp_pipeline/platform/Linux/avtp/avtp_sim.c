@@ -0,0 +1,631 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* MODULE SUMMARY : Deterministic virtual-time simulation of AVTP streams
+*
+* Runs N AAF talkers and listeners in one process, connected through in-memory
+* sim rawsock links, on the virtual clock of openavb_sim_osal. Each talker and
+* listener is a simulated thread on a node with its own clock drift and gPTP
+* error; the links add delay, jitter and loss. The talkers and listeners run
+* the TL streaming loops (talkerDoStream and listenerDoStream) with a TL
+* configuration built from the options, so batching, spin waits, launch times
+* and the software time-aware shaper pace the frames as they do in a real TL.
+* A synthetic interface module fills the talker media queue from the media
+* clock. The listener presents each media queue item when it is due, which is
+* checked against the ideal gPTP time.
+* A run simulates seconds of streaming in as much time as its processing takes,
+* and the same options and seed always give the same result and digest.
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <glib.h>
+#include "openavb_platform.h"
+#include "openavb_types.h"
+#include "openavb_trace.h"
+#include "openavb_mediaq.h"
+#include "openavb_avtp.h"
+#include "openavb_tl.h"
+#include "openavb_talker.h"
+#include "openavb_listener.h"
+#include "openavb_avtp_time_pub.h"
+#include "openavb_map_pub.h"
+#include "openavb_intf_pub.h"
+#include "openavb_map_aaf_audio_pub.h"
+#include "openavb_arena.h"
+#include "openavb_sim_osal.h"
+#include "sim_rawsock.h"
+
+#define	AVB_LOG_COMPONENT	"AVTP Sim"
+#include "openavb_log.h"
+
+//Common usage: ./avtp_sim -n 16 -s 10 -j 20 -p 100 -d 50 -w 30 -x
+
+#define SIM_VLAN_ID				2
+#define SIM_VLAN_PCP			3
+#define SIM_TX_BUFFERS			8
+#define SIM_RX_BUFFERS			32
+#define SIM_ITEM_COUNT			"64"
+
+extern bool openavbMapAVTPAudioInitialize(media_q_t *pMediaQ, openavb_map_cb_t *pMapCB, U32 inMaxTransitUsec);
+
+static int streams = 4;
+static int links = 1;
+static int seconds = 2;
+static int audioRate = 48000;
+static int audioChannels = 2;
+static int audioBits = 24;
+static int txRate = 8000;
+static int transitUsec = 2000;
+static int latencyUsec = 5;
+static int jitterUsec = 0;
+static int lossPpm = 0;
+static int linkMbps = 100;
+static double driftPpm = 0;
+static int offsetNsec = 0;
+static int syncMsec = 125;
+static int wakeJitterUsec = 0;
+static int seed = 1;
+static int lateUsec = 125;
+static int batchFactor = 1;
+static gboolean spinWait = FALSE;
+static gboolean launchTime = FALSE;
+static gchar *tasGcl = NULL;
+static int tasClass = 0;
+static gboolean strict = FALSE;
+static gchar *expectDigest = NULL;
+
+static GOptionEntry entries[] =
+{
+  { "streams",  'n', 0, G_OPTION_ARG_INT,    &streams,        "talker/listener pairs",                          "NUM" },
+  { "links",    'L', 0, G_OPTION_ARG_INT,    &links,          "links the streams are spread over",              "NUM" },
+  { "seconds",  's', 0, G_OPTION_ARG_INT,    &seconds,        "virtual run time in seconds",                    "SEC" },
+  { "rate",     'r', 0, G_OPTION_ARG_INT,    &audioRate,      "audio sample rate",                              "HZ" },
+  { "channels", 'c', 0, G_OPTION_ARG_INT,    &audioChannels,  "audio channels",                                 "NUM" },
+  { "bits",     'b', 0, G_OPTION_ARG_INT,    &audioBits,      "audio bit depth (16, 24 or 32)",                 "BITS" },
+  { "txrate",   't', 0, G_OPTION_ARG_INT,    &txRate,         "packets per second per stream",                  "RATE" },
+  { "transit",  'T', 0, G_OPTION_ARG_INT,    &transitUsec,    "max transit time",                               "USEC" },
+  { "latency",  'l', 0, G_OPTION_ARG_INT,    &latencyUsec,    "link delay",                                     "USEC" },
+  { "jitter",   'j', 0, G_OPTION_ARG_INT,    &jitterUsec,     "random extra link delay, up to",                 "USEC" },
+  { "loss",     'p', 0, G_OPTION_ARG_INT,    &lossPpm,        "frames lost on the links",                       "PPM" },
+  { "linkrate", 'R', 0, G_OPTION_ARG_INT,    &linkMbps,       "link rate (0 for no serialization delay)",       "MBPS" },
+  { "drift",    'd', 0, G_OPTION_ARG_DOUBLE, &driftPpm,       "node clock drift, up to +/-",                    "PPM" },
+  { "offset",   'o', 0, G_OPTION_ARG_INT,    &offsetNsec,     "node gPTP offset, up to +/-",                    "NSEC" },
+  { "sync",     'y', 0, G_OPTION_ARG_INT,    &syncMsec,       "gPTP sync interval (0 for free running clocks)", "MSEC" },
+  { "wake",     'w', 0, G_OPTION_ARG_INT,    &wakeJitterUsec, "thread wake up latency, up to",                  "USEC" },
+  { "seed",     'S', 0, G_OPTION_ARG_INT,    &seed,           "random seed",                                    "NUM" },
+  { "late",     'e', 0, G_OPTION_ARG_INT,    &lateUsec,       "presentation error counted as late or early",    "USEC" },
+  { "batch",    'B', 0, G_OPTION_ARG_INT,    &batchFactor,    "talker batch_factor",                            "NUM" },
+  { "spin",     'i', 0, G_OPTION_ARG_NONE,   &spinWait,       "talker spin_wait",                               NULL },
+  { "launch",   'a', 0, G_OPTION_ARG_NONE,   &launchTime,     "talker tx_launch_time",                          NULL },
+  { "tas",      'g', 0, G_OPTION_ARG_STRING, &tasGcl,         "talker tas_gcl",                                 "GCL" },
+  { "tasclass", 'G', 0, G_OPTION_ARG_INT,    &tasClass,       "talker tas_traffic_class",                       "TC" },
+  { "strict",   'x', 0, G_OPTION_ARG_NONE,   &strict,         "exit 1 on lost, late or early media",            NULL },
+  { "expect",   'E', 0, G_OPTION_ARG_STRING, &expectDigest,   "exit 1 unless the run gives this digest",        "HEX" },
+  { NULL }
+};
+
+typedef struct {
+	int index;
+	char ifname[IFNAMSIZ];
+	char linkName[IFNAMSIZ];
+	osal_sim_clock_t talkerClock;
+	osal_sim_clock_t listenerClock;
+
+	// Talker and listener as the TL runs them
+	tl_state_t talkerTL;
+	tl_state_t listenerTL;
+	talker_data_t talkerData;
+	listener_data_t listenerData;
+	bool bTalkerStarted;
+	bool bListenerStarted;
+
+	// Talker media clock
+	U64 mediaStartNsec;
+	U64 nextItemNsec;
+
+	U64 txItems;
+	U64 txOverruns;
+	U64 rxItems;
+	U64 rxMissing;
+	U32 rxNextSeq;
+	U64 late;
+	U64 early;
+	S64 errMinNsec;
+	S64 errMaxNsec;
+	S64 errSumNsec;
+	U64 digest;
+} sim_stream_t;
+
+// Private interface module data; freed with the media queue
+typedef struct {
+	sim_stream_t *pStream;
+} sim_intf_t;
+
+static U64 x_drainNsec;
+
+static U64 x_realNsec(void)
+{
+	// Straight from the OS; CLOCK_GETTIME reads the virtual clock
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((U64)ts.tv_sec * NANOSECONDS_PER_SECOND) + (U64)ts.tv_nsec;
+}
+
+static U64 x_fnv(U64 hash, U64 value)
+{
+	int i1;
+	for (i1 = 0; i1 < 8; i1++) {
+		hash ^= (value >> (i1 * 8)) & 0xFF;
+		hash *= 0x100000001B3ULL;
+	}
+	return hash;
+}
+
+static void x_drawClock(osal_sim_clock_t *pClock, U64 *pRand)
+{
+	pClock->driftPpm = driftPpm ? driftPpm * (((double)(osalSimRand(pRand) % 2001) / 1000.0) - 1.0) : 0;
+	pClock->wallOffsetNsec = offsetNsec ? (S64)(osalSimRand(pRand) % (2 * (U64)offsetNsec + 1)) - offsetNsec : 0;
+	pClock->syncIntervalNsec = (U64)syncMsec * NANOSECONDS_PER_MSEC;
+}
+
+static void x_intfNopCB(media_q_t *pMediaQ)
+{
+}
+
+// Capture side: push the items the media clock has produced by now
+static bool x_intfTxCB(media_q_t *pMediaQ)
+{
+	sim_stream_t *pStream = ((sim_intf_t *)pMediaQ->pPvtIntfInfo)->pStream;
+	media_q_pub_map_aaf_audio_info_t *pPubMapInfo = pMediaQ->pPubMapInfo;
+	U64 nowNsec;
+
+	CLOCK_GETTIME64(OPENAVB_CLOCK_WALLTIME, &nowNsec);
+	if (!pStream->mediaStartNsec) {
+		pStream->mediaStartNsec = pStream->nextItemNsec = nowNsec;
+	}
+
+	while (pStream->nextItemNsec <= nowNsec) {
+		media_q_item_t *pMediaQItem = openavbMediaQHeadLock(pMediaQ);
+		if (pMediaQItem) {
+			U32 seq = (U32)(pStream->txItems + pStream->txOverruns);
+			memset(pMediaQItem->pPubData, 0, pPubMapInfo->itemSize);
+			memcpy(pMediaQItem->pPubData, &seq, sizeof(seq));
+			openavbAvtpTimeSetToTimestampNS(pMediaQItem->pAvtpTime, pStream->nextItemNsec);
+			pMediaQItem->dataLen = pPubMapInfo->itemSize;
+			pMediaQItem->readIdx = 0;
+			openavbMediaQHeadPush(pMediaQ);
+			pStream->txItems++;
+		}
+		else {
+			pStream->txOverruns++;
+		}
+
+		// From the sample count, so rates that don't divide a second don't drift
+		U64 frames = (pStream->txItems + pStream->txOverruns) * pPubMapInfo->framesPerItem;
+		pStream->nextItemNsec = pStream->mediaStartNsec + (frames * NANOSECONDS_PER_SECOND) / pPubMapInfo->audioRate;
+	}
+
+	return TRUE;
+}
+
+// Render side: present the items that are due, and check them against the ideal gPTP time
+static bool x_intfRxCB(media_q_t *pMediaQ)
+{
+	sim_stream_t *pStream = ((sim_intf_t *)pMediaQ->pPvtIntfInfo)->pStream;
+	media_q_item_t *pMediaQItem;
+
+	while ((pMediaQItem = openavbMediaQTailLock(pMediaQ, FALSE)) != NULL) {
+		U64 simNsec = osalSimNow(), idealNsec;
+		U64 presentNsec = openavbAvtpTimeGetAvtpTimeNS(pMediaQItem->pAvtpTime);
+		osalSimClockAt(NULL, OPENAVB_CLOCK_WALLTIME, simNsec, &idealNsec);
+
+		S64 errNsec = (S64)(idealNsec - presentNsec);
+		if (pStream->rxItems == 0 || errNsec < pStream->errMinNsec) {
+			pStream->errMinNsec = errNsec;
+		}
+		if (pStream->rxItems == 0 || errNsec > pStream->errMaxNsec) {
+			pStream->errMaxNsec = errNsec;
+		}
+		pStream->errSumNsec += errNsec;
+		if (errNsec > (S64)lateUsec * NANOSECONDS_PER_USEC) {
+			pStream->late++;
+		}
+		else if (errNsec < -(S64)lateUsec * NANOSECONDS_PER_USEC) {
+			pStream->early++;
+		}
+
+		U32 seq = 0;
+		if (pMediaQItem->dataLen >= sizeof(seq)) {
+			memcpy(&seq, pMediaQItem->pPubData, sizeof(seq));
+		}
+		if (pStream->rxItems && seq != pStream->rxNextSeq) {
+			pStream->rxMissing += (U32)(seq - pStream->rxNextSeq);
+		}
+		pStream->rxNextSeq = seq + 1;
+		pStream->rxItems++;
+
+		pStream->digest = x_fnv(pStream->digest, seq);
+		pStream->digest = x_fnv(pStream->digest, simNsec);
+		pStream->digest = x_fnv(pStream->digest, presentNsec);
+
+		openavbMediaQTailPull(pMediaQ);
+	}
+
+	return TRUE;
+}
+
+static bool x_mapInit(sim_stream_t *pStream, tl_state_t *pTLState)
+{
+	media_q_t *pMediaQ = pTLState->pMediaQ;
+	openavb_map_cb_t *pMapCB = &pTLState->cfg.map_cb;
+	openavb_intf_cb_t *pIntfCB = &pTLState->cfg.intf_cb;
+
+	if (!pMediaQ || !openavbMapAVTPAudioInitialize(pMediaQ, pMapCB, transitUsec)) {
+		return FALSE;
+	}
+
+	// Stream format normally set by the interface module configuration
+	media_q_pub_map_aaf_audio_info_t *pPubMapInfo = pMediaQ->pPubMapInfo;
+	pPubMapInfo->audioRate = (avb_audio_rate_t)audioRate;
+	pPubMapInfo->audioType = AVB_AUDIO_TYPE_INT;
+	pPubMapInfo->audioBitDepth = (avb_audio_bit_depth_t)audioBits;
+	pPubMapInfo->audioEndian = AVB_AUDIO_ENDIAN_LITTLE;
+	pPubMapInfo->audioChannels = (avb_audio_channels_t)audioChannels;
+
+	char value[16];
+	snprintf(value, sizeof(value), "%d", txRate);
+	pMapCB->map_cfg_cb(pMediaQ, "map_nv_tx_rate", value);
+	pMapCB->map_cfg_cb(pMediaQ, "map_nv_item_count", SIM_ITEM_COUNT);
+
+	sim_intf_t *pIntf = calloc(1, sizeof(sim_intf_t));
+	if (!pIntf) {
+		return FALSE;
+	}
+	pIntf->pStream = pStream;
+	pMediaQ->pPvtIntfInfo = pIntf;
+
+	memset(pIntfCB, 0, sizeof(*pIntfCB));
+	pIntfCB->intf_gen_init_cb = x_intfNopCB;
+	pIntfCB->intf_tx_init_cb = x_intfNopCB;
+	pIntfCB->intf_tx_cb = x_intfTxCB;
+	pIntfCB->intf_rx_init_cb = x_intfNopCB;
+	pIntfCB->intf_rx_cb = x_intfRxCB;
+	pIntfCB->intf_end_cb = x_intfNopCB;
+	pIntfCB->intf_gen_end_cb = x_intfNopCB;
+
+	pMapCB->map_gen_init_cb(pMediaQ);
+	pIntfCB->intf_gen_init_cb(pMediaQ);
+	return TRUE;
+}
+
+// What openavbTLRunTalker/openavbTLRunListener set up before streaming,
+// with the endpoint callback data filled in directly
+static bool x_tlInit(sim_stream_t *pStream, tl_state_t *pTLState)
+{
+	openavbTLInitCfg(&pTLState->cfg);
+	pTLState->cfg.max_transit_usec = transitUsec;
+	pTLState->cfg.report_seconds = 0;
+	pTLState->cfg.report_frames = 0;
+	pTLState->bRunning = TRUE;
+	pTLState->bConnected = TRUE;
+	pTLState->pMediaQ = openavbMediaQCreate();
+
+	MUTEX_ATTR_HANDLE(mta);
+	MUTEX_ATTR_INIT(mta);
+	MUTEX_ATTR_SET_TYPE(mta, MUTEX_ATTR_TYPE_DEFAULT);
+	MUTEX_ATTR_SET_NAME(mta, "TLStatsMutex");
+	MUTEX_CREATE_ERR();
+	MUTEX_CREATE(pTLState->statsMutex, mta);
+	MUTEX_LOG_ERR("Could not create/initialize 'TLStatsMutex' mutex");
+
+	return x_mapInit(pStream, pTLState);
+}
+
+static bool x_streamInit(sim_stream_t *pStream, U64 *pClockRand)
+{
+	static const U8 streamMac[ETH_ALEN] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x01 };
+	talker_data_t *pTalkerData = &pStream->talkerData;
+	listener_data_t *pListenerData = &pStream->listenerData;
+
+	snprintf(pStream->linkName, sizeof(pStream->linkName), "sim%d", pStream->index % links);
+	snprintf(pStream->ifname, sizeof(pStream->ifname), SIM_RAWSOCK_PROTO ":%s", pStream->linkName);
+	x_drawClock(&pStream->talkerClock, pClockRand);
+	x_drawClock(&pStream->listenerClock, pClockRand);
+
+	if (!x_tlInit(pStream, &pStream->talkerTL) || !x_tlInit(pStream, &pStream->listenerTL)) {
+		AVB_LOGF_ERROR("Stream %d: failed to initialize the mapping module", pStream->index);
+		return FALSE;
+	}
+
+	AVBStreamID_t streamID;
+	memcpy(streamID.addr, streamMac, ETH_ALEN);
+	streamID.uniqueID = (U16)pStream->index;
+	U8 destAddr[ETH_ALEN] = { 0x91, 0xe0, 0xf0, 0x00, (U8)(0xfe - (pStream->index >> 8)), (U8)pStream->index };
+
+	openavb_tl_cfg_t *pCfg = &pStream->talkerTL.cfg;
+	pCfg->role = AVB_ROLE_TALKER;
+	pCfg->batch_factor = batchFactor;
+	pCfg->raw_tx_buffers = SIM_TX_BUFFERS;
+	pCfg->spin_wait = spinWait;
+	pCfg->tx_launch_time = launchTime;
+	if (tasGcl) {
+		snprintf(pCfg->tas_gcl, sizeof(pCfg->tas_gcl), "%s", tasGcl);
+		pCfg->tas_traffic_class = (U8)tasClass;
+		if (linkMbps) {
+			pCfg->tas_link_mbps = linkMbps;
+		}
+	}
+	strncpy(pTalkerData->ifname, pStream->ifname, sizeof(pTalkerData->ifname) - 1);
+	pTalkerData->streamID = streamID;
+	memcpy(pTalkerData->destAddr, destAddr, ETH_ALEN);
+	pTalkerData->classRate = txRate;
+	pTalkerData->vlanID = SIM_VLAN_ID;
+	pTalkerData->vlanPCP = SIM_VLAN_PCP;
+	pStream->talkerTL.pPvtTalkerData = pTalkerData;
+
+	pCfg = &pStream->listenerTL.cfg;
+	pCfg->role = AVB_ROLE_LISTENER;
+	pCfg->raw_rx_buffers = SIM_RX_BUFFERS;
+	pCfg->rx_signal_mode = FALSE;
+	strncpy(pListenerData->ifname, pStream->ifname, sizeof(pListenerData->ifname) - 1);
+	pListenerData->streamID = streamID;
+	memcpy(pListenerData->destAddr, destAddr, ETH_ALEN);
+	pStream->listenerTL.pPvtListenerData = pListenerData;
+
+	// Listening before any talker thread runs; talkers start on their own clock
+	pStream->bListenerStarted = listenerStartStream(&pStream->listenerTL);
+	if (!pStream->bListenerStarted) {
+		AVB_LOGF_ERROR("Stream %d: listener init failed", pStream->index);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+static void x_tlEnd(tl_state_t *pTLState)
+{
+	if (pTLState->pMediaQ) {
+		if (pTLState->cfg.map_cb.map_gen_end_cb) {
+			pTLState->cfg.map_cb.map_gen_end_cb(pTLState->pMediaQ);
+		}
+		openavbMediaQDelete(pTLState->pMediaQ);
+		pTLState->pMediaQ = NULL;
+
+		MUTEX_CREATE_ERR();
+		MUTEX_DESTROY(pTLState->statsMutex);
+		MUTEX_LOG_ERR("Error destroying mutex");
+	}
+}
+
+static void x_streamEnd(sim_stream_t *pStream)
+{
+	if (pStream->bTalkerStarted) {
+		talkerStopStream(&pStream->talkerTL);
+	}
+	if (pStream->bListenerStarted) {
+		listenerStopStream(&pStream->listenerTL);
+	}
+	x_tlEnd(&pStream->talkerTL);
+	x_tlEnd(&pStream->listenerTL);
+}
+
+static void *x_talkerThread(void *pv)
+{
+	sim_stream_t *pStream = (sim_stream_t *)pv;
+
+	pStream->bTalkerStarted = talkerStartStream(&pStream->talkerTL);
+	if (!pStream->bTalkerStarted) {
+		AVB_LOGF_ERROR("Stream %d: talker init failed", pStream->index);
+		return NULL;
+	}
+
+	while (!osalSimStopping()) {
+		talkerDoStream(&pStream->talkerTL);
+	}
+
+	return NULL;
+}
+
+static void *x_listenerThread(void *pv)
+{
+	sim_stream_t *pStream = (sim_stream_t *)pv;
+
+	while (!osalSimStopping()) {
+		listenerDoStream(&pStream->listenerTL);
+	}
+
+	// Present what the talkers sent before they stopped
+	U64 endNsec = osalSimNow() + x_drainNsec;
+	while (osalSimNow() < endNsec) {
+		listenerDoStream(&pStream->listenerTL);
+	}
+
+	return NULL;
+}
+
+int main(int argc, char* argv[])
+{
+	GError *error = NULL;
+	GOptionContext *context;
+
+	context = g_option_context_new("- deterministic virtual-time AVTP stream simulation");
+	g_option_context_add_main_entries(context, entries, NULL);
+	if (!g_option_context_parse(context, &argc, &argv, &error))
+	{
+		printf("error: %s\n", error->message);
+		exit(1);
+	}
+	if (streams < 1 || links < 1 || seconds < 1 || audioRate < 1 || txRate < 1 || transitUsec < 0
+		|| latencyUsec < 0 || jitterUsec < 0 || lossPpm < 0 || linkMbps < 0 || offsetNsec < 0
+		|| syncMsec < 0 || wakeJitterUsec < 0 || lateUsec < 0 || batchFactor < 1 || tasClass < 0 || tasClass > 7) {
+		printf("error: invalid arguments\n");
+		exit(2);
+	}
+
+	avbLogInit();
+	openavbArenaInitialize();
+	if (!osalSimInitialize((U64)seed, (U32)wakeJitterUsec * NANOSECONDS_PER_USEC)) {
+		printf("error: failed to start the simulation\n");
+		exit(3);
+	}
+
+	sim_link_cfg_t linkCfg;
+	memset(&linkCfg, 0, sizeof(linkCfg));
+	linkCfg.latencyNsec = (U32)latencyUsec * NANOSECONDS_PER_USEC;
+	linkCfg.jitterNsec = (U32)jitterUsec * NANOSECONDS_PER_USEC;
+	linkCfg.lossPpm = (U32)lossPpm;
+	linkCfg.rateMbps = (U32)linkMbps;
+
+	int i1;
+	for (i1 = 0; i1 < links; i1++) {
+		char name[IFNAMSIZ];
+		snprintf(name, sizeof(name), "sim%d", i1);
+		simRawsockLinkConfig(name, &linkCfg);
+	}
+
+	// Enough for the last frames to arrive and be presented
+	x_drainNsec = ((U64)transitUsec + latencyUsec + jitterUsec + wakeJitterUsec) * NANOSECONDS_PER_USEC + NANOSECONDS_PER_MSEC * 10;
+
+	sim_stream_t *pStreams = calloc(streams, sizeof(sim_stream_t));
+	if (!pStreams) {
+		printf("error: out of memory\n");
+		exit(3);
+	}
+
+	U64 clockRand = osalSimSeed("clocks");
+	bool bOk = TRUE;
+	for (i1 = 0; i1 < streams && bOk; i1++) {
+		pStreams[i1].index = i1;
+		bOk = x_streamInit(&pStreams[i1], &clockRand);
+	}
+
+	for (i1 = 0; i1 < streams && bOk; i1++) {
+		char name[32];
+		snprintf(name, sizeof(name), "listener%d", i1);
+		bOk = osalSimThreadCreate(name, &pStreams[i1].listenerClock, x_listenerThread, &pStreams[i1]) != NULL;
+		snprintf(name, sizeof(name), "talker%d", i1);
+		bOk = bOk && osalSimThreadCreate(name, &pStreams[i1].talkerClock, x_talkerThread, &pStreams[i1]) != NULL;
+	}
+	if (!bOk) {
+		printf("error: failed to set up the streams\n");
+		exit(3);
+	}
+
+	media_q_pub_map_aaf_audio_info_t *pPubMapInfo = pStreams[0].talkerTL.pMediaQ->pPubMapInfo;
+	printf("streams=%d links=%d rate=%d channels=%d bits=%d frames/packet=%u seed=%d\n",
+		streams, links, audioRate, audioChannels, audioBits, pPubMapInfo->framesPerPacket, seed);
+
+	U64 realStartNsec = x_realNsec();
+	bool bDrained = osalSimRun((U64)seconds * NANOSECONDS_PER_SECOND, x_drainNsec + (2 * NANOSECONDS_PER_SECOND));
+	U64 realNsec = x_realNsec() - realStartNsec;
+	U64 simNsec = osalSimNow();
+
+	if (!bDrained) {
+		// Threads are still using the streams; leave everything as it is
+		printf("error: simulated threads did not stop\n");
+		exit(4);
+	}
+	for (i1 = 0; i1 < streams; i1++) {
+		if (!pStreams[i1].bTalkerStarted) {
+			printf("error: failed to start the talkers\n");
+			exit(3);
+		}
+	}
+
+	U64 digest = 0xCBF29CE484222325ULL;
+	U64 txItems = 0, rxItems = 0, missing = 0, late = 0, early = 0;
+	int lost = 0;
+	for (i1 = 0; i1 < streams; i1++) {
+		sim_stream_t *pStream = &pStreams[i1];
+		U32 wakeMin = 0, wakeP50 = 0, wakeP99 = 0, wakeMax = 0;
+		openavbAvtpRxWakeLatency(pStream->listenerData.avtpHandle, &wakeMin, &wakeP50, &wakeP99, &wakeMax);
+		int streamLost = openavbAvtpLost(pStream->listenerData.avtpHandle);
+		if (streamLost < 0) {
+			streamLost = 0;
+		}
+
+		printf("stream=%d link=%s tx_frames=%lu tx_wakes=%lu tx_items=%" PRIu64 " tx_overruns=%" PRIu64
+			" rx_items=%" PRIu64 " lost=%d missing=%" PRIu64 " late=%" PRIu64 " early=%" PRIu64
+			" err_us=%.3f/%.3f/%.3f wake_us=%u/%u/%u/%u talker_ppm=%.3f listener_ppm=%.3f\n",
+			i1, pStream->linkName, pStream->talkerData.cntFrames, pStream->talkerData.cntWakes, pStream->txItems, pStream->txOverruns,
+			pStream->rxItems, streamLost, pStream->rxMissing, pStream->late, pStream->early,
+			pStream->errMinNsec / 1000.0, pStream->rxItems ? (pStream->errSumNsec / (double)pStream->rxItems) / 1000.0 : 0.0,
+			pStream->errMaxNsec / 1000.0, wakeMin, wakeP50, wakeP99, wakeMax,
+			pStream->talkerClock.driftPpm, pStream->listenerClock.driftPpm);
+
+		txItems += pStream->txItems;
+		rxItems += pStream->rxItems;
+		missing += pStream->rxMissing;
+		lost += streamLost;
+		late += pStream->late;
+		early += pStream->early;
+		digest = x_fnv(digest, pStream->digest);
+	}
+
+	for (i1 = 0; i1 < links; i1++) {
+		char name[IFNAMSIZ];
+		sim_link_stats_t stats;
+		snprintf(name, sizeof(name), "sim%d", i1);
+		if (simRawsockLinkStats(name, &stats)) {
+			printf("link=%s tx=%" PRIu64 " lost=%" PRIu64 " rx=%" PRIu64 " overruns=%" PRIu64 " max_wire_wait_us=%.3f\n",
+				name, stats.txFrames, stats.lostFrames, stats.rxFrames, stats.rxOverruns, stats.maxWireWaitNsec / 1000.0);
+		}
+	}
+
+	double simSeconds = (double)simNsec / NANOSECONDS_PER_SECOND;
+	double realSeconds = (double)realNsec / NANOSECONDS_PER_SECOND;
+	printf("tx_items=%" PRIu64 " rx_items=%" PRIu64 " lost=%d missing=%" PRIu64 " late=%" PRIu64 " early=%" PRIu64 "\n",
+		txItems, rxItems, lost, missing, late, early);
+	printf("virtual_seconds=%.3f real_seconds=%.3f speedup=%.1f switches=%" PRIu64 " digest=%016" PRIx64 "\n",
+		simSeconds, realSeconds, realSeconds > 0 ? simSeconds / realSeconds : 0.0, osalSimSwitches(), digest);
+
+	for (i1 = 0; i1 < streams; i1++) {
+		x_streamEnd(&pStreams[i1]);
+	}
+	free(pStreams);
+	simRawsockLinksFree();
+	osalSimFinalize();
+	openavbArenaFinalize();
+	avbLogExit();
+
+	if (strict && (lost || missing || late || early)) {
+		return 1;
+	}
+	if (expectDigest && strtoull(expectDigest, NULL, 16) != digest) {
+		printf("error: digest=%016" PRIx64 " expected %s\n", digest, expectDigest);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,233 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* MODULE SUMMARY : Packets per second microbenchmark of the talker packet build path
+*
+* Drives a mapping module's TX callback in a tight loop, stamping the Ethernet and
+* AVTP common header from a template the way openavbAvtpTx does, and reports how
+* many packets per second one core can build. No network or gPTP is needed; the
+* media queue is refilled in line with synthetic samples and timestamps.
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <glib.h>
+#include "openavb_platform.h"
+#include "openavb_types.h"
+#include "openavb_trace.h"
+#include "openavb_mediaq.h"
+#include "openavb_avtp.h"
+#include "openavb_avtp_time_pub.h"
+#include "openavb_map_pub.h"
+#include "openavb_map_uncmp_audio_pub.h"
+#include "openavb_arena.h"
+
+#define	AVB_LOG_COMPONENT	"AVTP TX Bench"
+#include "openavb_log.h"
+
+//Common usage: ./avtp_tx_bench -m aaf -c 8 -b 24 -s 5
+
+#define BENCH_FRAME_LEN		1522
+#define BENCH_BATCH			1024
+
+extern bool openavbMapAVTPAudioInitialize(media_q_t *pMediaQ, openavb_map_cb_t *pMapCB, U32 inMaxTransitUsec);
+extern bool openavbMapUncmpAudioInitialize(media_q_t *pMediaQ, openavb_map_cb_t *pMapCB, U32 inMaxTransitUsec);
+
+static char *mapping = "aaf";
+static int audioRate = 48000;
+static int audioChannels = 2;
+static int audioBits = 24;
+static int txRate = 8000;
+static int seconds = 5;
+
+static GOptionEntry entries[] =
+{
+  { "mapping",  'm', 0, G_OPTION_ARG_STRING, &mapping,       "mapping module: aaf or 61883",      "NAME" },
+  { "rate",     'r', 0, G_OPTION_ARG_INT,    &audioRate,     "audio sample rate",                 "HZ" },
+  { "channels", 'c', 0, G_OPTION_ARG_INT,    &audioChannels, "audio channels",                    "NUM" },
+  { "bits",     'b', 0, G_OPTION_ARG_INT,    &audioBits,     "audio bit depth (16, 24 or 32)",    "BITS" },
+  { "txrate",   't', 0, G_OPTION_ARG_INT,    &txRate,        "packets per second per stream",     "RATE" },
+  { "seconds",  's', 0, G_OPTION_ARG_INT,    &seconds,       "run time in seconds",               "SEC" },
+  { NULL }
+};
+
+static U64 x_monoNsec(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((U64)ts.tv_sec * NANOSECONDS_PER_SECOND) + (U64)ts.tv_nsec;
+}
+
+// Same layout openavbAvtpTxInit builds: untagged Ethernet header then AVTP common header
+static U32 x_buildHdrTemplate(U8 *pTmpl, U8 subtype)
+{
+	static const U8 dest[ETH_ALEN] = { 0x91, 0xe0, 0xf0, 0x00, 0xfe, 0x00 };
+	static const U8 src[ETH_ALEN] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x01 };
+	U8 *pFill = pTmpl;
+
+	memcpy(pFill, dest, ETH_ALEN);
+	pFill += ETH_ALEN;
+	memcpy(pFill, src, ETH_ALEN);
+	pFill += ETH_ALEN;
+	*pFill++ = 0x22;
+	*pFill++ = 0xf0;
+
+	*pFill++ = subtype & 0x7F;
+	*pFill++ = 0x81;
+	*pFill++ = 0;
+	*pFill++ = 0;
+	memcpy(pFill, src, ETH_ALEN);
+	pFill[6] = 0;
+	pFill[7] = 1;
+	pFill += 8;
+
+	return pFill - pTmpl;
+}
+
+// Keep the media queue full, as an interface module would
+static void x_fillMediaQ(media_q_t *pMediaQ, U64 *pTimeNS, U64 itemNS)
+{
+	media_q_pub_map_uncmp_audio_info_t *pPubMapInfo = pMediaQ->pPubMapInfo;
+	media_q_item_t *pMediaQItem;
+
+	while ((pMediaQItem = openavbMediaQHeadLock(pMediaQ)) != NULL) {
+		openavbAvtpTimeSetToTimestampNS(pMediaQItem->pAvtpTime, *pTimeNS);
+		*pTimeNS += itemNS;
+		pMediaQItem->dataLen = pPubMapInfo->itemSize;
+		pMediaQItem->readIdx = 0;
+		openavbMediaQHeadPush(pMediaQ);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	GError *error = NULL;
+	GOptionContext *context;
+
+	context = g_option_context_new("- AVTP talker packet build benchmark");
+	g_option_context_add_main_entries(context, entries, NULL);
+	if (!g_option_context_parse(context, &argc, &argv, &error))
+	{
+		printf("error: %s\n", error->message);
+		exit(1);
+	}
+
+	avbLogInit();
+	openavbArenaInitialize();
+
+	media_q_t *pMediaQ = openavbMediaQCreate();
+	openavb_map_cb_t mapCB;
+	memset(&mapCB, 0, sizeof(mapCB));
+
+	bool bOk;
+	if (strcmp(mapping, "aaf") == 0) {
+		bOk = openavbMapAVTPAudioInitialize(pMediaQ, &mapCB, 2000);
+	}
+	else if (strcmp(mapping, "61883") == 0 || strcmp(mapping, "uncmp") == 0) {
+		bOk = openavbMapUncmpAudioInitialize(pMediaQ, &mapCB, 2000);
+	}
+	else {
+		printf("error: unknown mapping %s\n", mapping);
+		exit(2);
+	}
+	if (!pMediaQ || !bOk) {
+		printf("error: failed to initialize the mapping module\n");
+		exit(3);
+	}
+
+	// Stream format normally set by the interface module configuration
+	media_q_pub_map_uncmp_audio_info_t *pPubMapInfo = pMediaQ->pPubMapInfo;
+	pPubMapInfo->audioRate = (avb_audio_rate_t)audioRate;
+	pPubMapInfo->audioType = AVB_AUDIO_TYPE_INT;
+	pPubMapInfo->audioBitDepth = (avb_audio_bit_depth_t)audioBits;
+	pPubMapInfo->audioEndian = AVB_AUDIO_ENDIAN_LITTLE;
+	pPubMapInfo->audioChannels = (avb_audio_channels_t)audioChannels;
+
+	char txRateStr[16];
+	snprintf(txRateStr, sizeof(txRateStr), "%d", txRate);
+	mapCB.map_cfg_cb(pMediaQ, "map_nv_tx_rate", txRateStr);
+
+	mapCB.map_gen_init_cb(pMediaQ);
+	mapCB.map_tx_init_cb(pMediaQ);
+
+	U8 frame[BENCH_FRAME_LEN];
+	U8 hdrTemplate[ETH_HDR_LEN + AVTP_V0_HDR_LEN];
+	U32 hdrLen = x_buildHdrTemplate(hdrTemplate, mapCB.map_subtype_cb());
+	U32 ethHdrLen = hdrLen - AVTP_V0_HDR_LEN;
+	U8 seq = 0;
+
+	U64 timeNS = NANOSECONDS_PER_SECOND;
+	U64 itemNS = (NANOSECONDS_PER_SECOND / txRate) * (pPubMapInfo->framesPerItem / (pPubMapInfo->framesPerPacket ? pPubMapInfo->framesPerPacket : 1));
+	U64 packets = 0, notReady = 0, bytes = 0;
+
+	printf("mapping=%s rate=%d channels=%d bits=%d frames/packet=%u\n",
+		mapping, audioRate, audioChannels, audioBits, pPubMapInfo->framesPerPacket);
+
+	U64 startNS = x_monoNsec();
+	U64 endNS = startNS + ((U64)seconds * NANOSECONDS_PER_SECOND);
+	U64 nowNS = startNS;
+	while (nowNS < endNS) {
+		int i1;
+		for (i1 = 0; i1 < BENCH_BATCH; i1++) {
+			x_fillMediaQ(pMediaQ, &timeNS, itemNS);
+
+			// What openavbAvtpTx does per frame before calling the mapping module
+			memcpy(frame, hdrTemplate, hdrLen);
+			frame[ethHdrLen + 2] = seq;
+
+			U32 avtpLen = BENCH_FRAME_LEN - ethHdrLen;
+			if (mapCB.map_tx_cb(pMediaQ, frame + ethHdrLen, &avtpLen) == TX_CB_RET_PACKET_READY) {
+				seq++;
+				packets++;
+				bytes += avtpLen + ethHdrLen;
+			}
+			else {
+				notReady++;
+			}
+		}
+		nowNS = x_monoNsec();
+	}
+
+	double elapsed = (double)(nowNS - startNS) / NANOSECONDS_PER_SECOND;
+	printf("packets=%" PRIu64 " not_ready=%" PRIu64 " bytes=%" PRIu64 " seconds=%.3f\n", packets, notReady, bytes, elapsed);
+	printf("pps=%.0f ns/packet=%.1f\n", packets / elapsed, packets ? (elapsed * NANOSECONDS_PER_SECOND) / packets : 0.0);
+
+	mapCB.map_end_cb(pMediaQ);
+	mapCB.map_gen_end_cb(pMediaQ);
+	openavbMediaQDelete(pMediaQ);
+	openavbArenaFinalize();
+	avbLogExit();
+
+	return 0;
+}
@@ -32,10 +32,34 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #ifndef OPENAVB_ENDPOINT_CLIENT_OSAL_C
 #define OPENAVB_ENDPOINT_CLIENT_OSAL_C
 
+#if AVB_FEATURE_SHM_IPC
+#include "openavb_shm_mbox_osal.h"
+
+// Mailboxes of the open connections, indexed by socket handle. Connections on
+// higher descriptors stay on the socket.
+#define CLNT_MBOX_MAX_HANDLE	1024
+// Service calls without a server heartbeat before the socket is checked
+#define CLNT_MBOX_STALE_CHECKS	3
+
+static shm_mbox_t *x_clntMbox[CLNT_MBOX_MAX_HANDLE];
+
+static shm_mbox_t *clntMbox(int h)
+{
+	return (h >= 0 && h < CLNT_MBOX_MAX_HANDLE) ? x_clntMbox[h] : NULL;
+}
+#endif
+
 static void socketClose(int h)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_ENDPOINT);
 	if (h != AVB_ENDPOINT_HANDLE_INVALID) {
+#if AVB_FEATURE_SHM_IPC
+		shm_mbox_t *pMbox = clntMbox(h);
+		if (pMbox) {
+			x_clntMbox[h] = NULL;
+			osalShmMboxClose(pMbox);
+		}
+#endif
 		close(h);
 	}
 	AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
@@ -51,6 +75,20 @@ static bool openavbEptClntSendToServer(int h, openavbEndpointMessage_t *msg)
 		return FALSE;
 	}
 
+#if AVB_FEATURE_SHM_IPC
+	shm_mbox_t *pMbox = clntMbox(h);
+	if (pMbox) {
+		if (!osalShmMboxSend(pMbox, msg)) {
+			AVB_LOG_ERROR("Client send: mailbox full or closed");
+			socketClose(h);
+			AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
+			return FALSE;
+		}
+		AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
+		return TRUE;
+	}
+#endif
+
 	ssize_t nWrite = write(h, msg, OPENAVB_ENDPOINT_MSG_LEN);
 	AVB_LOGF_VERBOSE("Sent message, len=%zu, nWrite=%zu", OPENAVB_ENDPOINT_MSG_LEN, nWrite);
 
@@ -96,6 +134,29 @@ int openavbEptClntOpenSrvrConnection(tl_state_t *pTLState)
 		return AVB_ENDPOINT_HANDLE_INVALID;
 	}
 
+#if AVB_FEATURE_SHM_IPC
+	// The endpoint offers a shared memory mailbox as soon as it accepts
+	bool bOk;
+	shm_mbox_t *pMbox = osalShmMboxAccept(h, OPENAVB_ENDPOINT_MSG_LEN, 1000, &bOk);
+	if (!bOk) {
+		socketClose(h);
+		AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
+		return AVB_ENDPOINT_HANDLE_INVALID;
+	}
+	if (pMbox) {
+		if (h < CLNT_MBOX_MAX_HANDLE) {
+			x_clntMbox[h] = pMbox;
+		}
+		else {
+			AVB_LOG_ERROR("Socket handle too large for mailbox table");
+			osalShmMboxClose(pMbox);
+			socketClose(h);
+			AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
+			return AVB_ENDPOINT_HANDLE_INVALID;
+		}
+	}
+#endif
+
 	AVB_LOG_DEBUG("Connected to endpoint");
 	AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
 	return h;
@@ -108,6 +169,59 @@ void openavbEptClntCloseSrvrConnection(int h)
 	AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
 }
 
+#if AVB_FEATURE_SHM_IPC
+// Service a connection that uses a shared memory mailbox. With timeout 0 this
+// makes no system calls unless the endpoint looks like it has gone away.
+static bool openavbEptClntServiceMbox(int h, shm_mbox_t *pMbox, int timeout)
+{
+	openavbEndpointMessage_t msgBuf;
+	bool bHangup = FALSE;
+
+	if (timeout != 0 && osalShmMboxPrepareWait(pMbox)) {
+		struct pollfd fds[2];
+		memset(fds, 0, sizeof(fds));
+		fds[0].fd = osalShmMboxDoorbellFd(pMbox);
+		fds[0].events = POLLIN;
+		fds[1].fd = h;
+		fds[1].events = POLLIN;
+
+		AVB_LOG_VERBOSE("Waiting for event...");
+		int pRet = poll(fds, 2, timeout);
+		if (pRet < 0 && errno != EINTR) {
+			AVB_LOGF_ERROR("Poll error: %s", strerror(errno));
+		}
+		if (pRet > 0 && fds[0].revents) {
+			osalShmMboxDrainDoorbell(fds[0].fd);
+		}
+		// The endpoint never writes to the socket once the mailbox is up
+		bHangup = pRet > 0 && fds[1].revents;
+	}
+	osalShmMboxFinishWait(pMbox);
+
+	while (osalShmMboxRecv(pMbox, &msgBuf)) {
+		if (!openavbEptClntReceiveFromServer(h, &msgBuf)) {
+			AVB_LOG_ERROR("Invalid message received");
+			socketClose(h);
+			return FALSE;
+		}
+	}
+
+	if (!bHangup && osalShmMboxPeerSuspect(pMbox, CLNT_MBOX_STALE_CHECKS)) {
+		struct pollfd fd;
+		fd.fd = h;
+		fd.events = POLLIN;
+		fd.revents = 0;
+		bHangup = poll(&fd, 1, 0) > 0;
+	}
+	if (bHangup) {
+		AVB_LOG_ERROR("Socket closed unexpectedly");
+		socketClose(h);
+		return FALSE;
+	}
+	return TRUE;
+}
+#endif
+
 bool openavbEptClntService(int h, int timeout)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_ENDPOINT);
@@ -118,7 +232,16 @@ bool openavbEptClntService(int h, int timeout)
 		AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
 		return FALSE;
 	}
-	
+
+#if AVB_FEATURE_SHM_IPC
+	shm_mbox_t *pMbox = clntMbox(h);
+	if (pMbox) {
+		rc = openavbEptClntServiceMbox(h, pMbox, timeout);
+		AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
+		return rc;
+	}
+#endif
+
 	struct pollfd fds[1];
 	memset(fds, 0, sizeof(struct pollfd));
 	fds[0].fd = h;
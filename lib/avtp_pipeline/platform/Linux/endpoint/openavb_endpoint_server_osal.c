@@ -37,9 +37,20 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #define POLL_FD_COUNT ((MAX_AVB_STREAMS) + 1)
 
 static int lsock  = SOCK_INVALID;
-static struct pollfd fds[POLL_FD_COUNT];
 static struct sockaddr_un serverAddr;
 
+#if AVB_FEATURE_SHM_IPC
+#include "openavb_shm_mbox_osal.h"
+
+// The doorbell shared by all client mailboxes is polled after the sockets
+#define AVB_ENDPOINT_DOORBELL_FDS	POLL_FD_COUNT
+static struct pollfd fds[POLL_FD_COUNT + 1];
+static shm_mbox_t *mboxes[POLL_FD_COUNT];
+static int doorbellFd = SOCK_INVALID;
+#else
+static struct pollfd fds[POLL_FD_COUNT];
+#endif
+
 static void socketClose(int h)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_ENDPOINT);
@@ -49,9 +60,16 @@ static void socketClose(int h)
 	}
 	else {
 		openavbEptSrvrCloseClientConnection(h);
+#if AVB_FEATURE_SHM_IPC
+		if (mboxes[h]) {
+			osalShmMboxClose(mboxes[h]);
+			mboxes[h] = NULL;
+		}
+#endif
 		close(fds[h].fd);
 		fds[h].fd = SOCK_INVALID;
 		fds[h].events = 0;
+		fds[h].revents = 0;
 	}
 	
 	AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
@@ -78,6 +96,19 @@ static bool openavbEptSrvrSendToClient(int h, openavbEndpointMessage_t *msg)
 		return FALSE;
 	}
 
+#if AVB_FEATURE_SHM_IPC
+	if (mboxes[h]) {
+		if (!osalShmMboxSend(mboxes[h], msg)) {
+			AVB_LOGF_ERROR("Mailbox full or closed, h=%d", h);
+			socketClose(h);
+			AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
+			return FALSE;
+		}
+		AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
+		return TRUE;
+	}
+#endif
+
 	ssize_t nWrite = write(csock, msg, OPENAVB_ENDPOINT_MSG_LEN);
 	AVB_LOGF_VERBOSE("Sent message, len=%zu, nWrite=%zu", OPENAVB_ENDPOINT_MSG_LEN, nWrite);
 	if (nWrite < OPENAVB_ENDPOINT_MSG_LEN) {
@@ -109,6 +140,13 @@ bool openavbEndpointServerOpen(void)
 		fds[i].events = 0;
 	}
 
+#if AVB_FEATURE_SHM_IPC
+	// Without a doorbell clients are simply kept on their sockets
+	doorbellFd = osalShmMboxCreateDoorbell();
+	fds[AVB_ENDPOINT_DOORBELL_FDS].fd = doorbellFd;
+	fds[AVB_ENDPOINT_DOORBELL_FDS].events = POLLIN;
+#endif
+
 	lsock = socket(AF_UNIX, SOCK_STREAM, 0);
 	if (lsock < 0) {
 		AVB_LOGF_ERROR("Failed to open socket: %s", strerror(errno));
@@ -152,6 +190,52 @@ bool openavbEndpointServerOpen(void)
 	return FALSE;
 }
  
+#if AVB_FEATURE_SHM_IPC
+// Handle everything queued in the client mailboxes
+static void openavbEptSrvrServiceMailboxes(void)
+{
+	openavbEndpointMessage_t msgBuf;
+	int i;
+
+	for (i = 0; i < POLL_FD_COUNT; i++) {
+		while (mboxes[i] && osalShmMboxRecv(mboxes[i], &msgBuf)) {
+			if (!openavbEptSrvrReceiveFromClient(i, &msgBuf)) {
+				AVB_LOG_ERROR("Failed to handle message");
+				socketClose(i);
+			}
+		}
+		if (mboxes[i]) {
+			osalShmMboxHeartbeat(mboxes[i]);
+		}
+	}
+}
+
+// Announce the wait to every client; returns the poll timeout to use
+static int openavbEptSrvrPrepareWait(int timeout)
+{
+	int i;
+	for (i = 0; i < POLL_FD_COUNT; i++) {
+		if (mboxes[i] && !osalShmMboxPrepareWait(mboxes[i])) {
+			timeout = 0;
+		}
+	}
+	return timeout;
+}
+
+static void openavbEptSrvrFinishWait(void)
+{
+	int i;
+	for (i = 0; i < POLL_FD_COUNT; i++) {
+		if (mboxes[i]) {
+			osalShmMboxFinishWait(mboxes[i]);
+		}
+	}
+	if (fds[AVB_ENDPOINT_DOORBELL_FDS].revents) {
+		osalShmMboxDrainDoorbell(doorbellFd);
+	}
+}
+#endif
+
 void openavbEptSrvrService(void)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_ENDPOINT);
@@ -164,7 +248,17 @@ void openavbEptSrvrService(void)
 	int pRet;
 
 	AVB_LOG_VERBOSE("Waiting for event...");
+#if AVB_FEATURE_SHM_IPC
+	pRet = poll(fds, POLL_FD_COUNT + 1, openavbEptSrvrPrepareWait(1000));
+	openavbEptSrvrFinishWait();
+	// Mailbox messages first, so a client's last message is handled before its hangup
+	openavbEptSrvrServiceMailboxes();
+	if (pRet > 0 && fds[AVB_ENDPOINT_DOORBELL_FDS].revents) {
+		pRet--;
+	}
+#else
 	pRet = poll(fds, nfds, 1000);
+#endif
 
 	if (pRet == 0) {
 		AVB_LOG_VERBOSE("poll timeout");
@@ -202,6 +296,15 @@ void openavbEptSrvrService(void)
 							AVB_LOG_ERROR("Too many client connections");
 							close(csock);
 						}
+#if AVB_FEATURE_SHM_IPC
+						else {
+							bool bOfferSent;
+							mboxes[j] = osalShmMboxOffer(csock, OPENAVB_ENDPOINT_MSG_LEN, doorbellFd, &bOfferSent);
+							if (!bOfferSent) {
+								socketClose(j);
+							}
+						}
+#endif
 					}
 				}
 				else {
@@ -252,6 +355,19 @@ void openavbEndpointServerClose(void)
 		close(lsock);
 		lsock = SOCK_INVALID;
 	}
+#if AVB_FEATURE_SHM_IPC
+	for (i = 0; i < POLL_FD_COUNT; i++) {
+		if (mboxes[i]) {
+			osalShmMboxClose(mboxes[i]);
+			mboxes[i] = NULL;
+		}
+	}
+	if (doorbellFd != SOCK_INVALID) {
+		close(doorbellFd);
+		doorbellFd = SOCK_INVALID;
+		fds[AVB_ENDPOINT_DOORBELL_FDS].fd = SOCK_INVALID;
+	}
+#endif
 
 	if (unlink(serverAddr.sun_path) != 0) {
 		AVB_LOGF_ERROR("Failed to unlink %s: %s", serverAddr.sun_path, strerror(errno));
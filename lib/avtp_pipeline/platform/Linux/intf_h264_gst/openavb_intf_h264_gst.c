@@ -269,6 +269,12 @@ void openavbIntfH264RtpGstTxInitCB(media_q_t *pMediaQ)
 	return;
 }
 
+// Release callback for RTP buffers placed in the media queue by reference
+static void x_releaseTxBuf(void *pData, void *pCtx)
+{
+	gst_al_rtp_buffer_unref((GstAlBuf *)pCtx);
+}
+
 // This callback will be called for each AVB transmit interval. Commonly this will be
 // 4000 or 8000 times  per second.
 bool openavbIntfH264RtpGstTxCB(media_q_t *pMediaQ)
@@ -330,8 +336,6 @@ bool openavbIntfH264RtpGstTxCB(media_q_t *pMediaQ)
 				return FALSE;
 			}
 
-			pMediaQItem->dataLen = paySize;
-			memcpy(pMediaQItem->pPubData, GST_AL_BUF_DATA(txBuf), paySize);
 			if (gst_al_rtp_buffer_get_marker(txBuf))
 			{
 				((media_q_item_map_h264_pub_data_t *)pMediaQItem->pPubMapData)->lastPacket = TRUE;
@@ -343,9 +347,9 @@ bool openavbIntfH264RtpGstTxCB(media_q_t *pMediaQ)
 			((media_q_item_map_h264_pub_data_t *)pMediaQItem->pPubMapData)->timestamp =
 					gst_al_rtp_buffer_get_timestamp(txBuf);
 			openavbAvtpTimeSetToWallTime(pMediaQItem->pAvtpTime);
+			// The item keeps txBuf until the mapping has copied it into the packet
+			openavbMediaQItemAddData(pMediaQItem, GST_AL_BUF_DATA(txBuf), paySize, x_releaseTxBuf, txBuf);
 			openavbMediaQHeadPush(pMediaQ);
-
-			gst_al_rtp_buffer_unref(txBuf);
 		}
 		else
 		{
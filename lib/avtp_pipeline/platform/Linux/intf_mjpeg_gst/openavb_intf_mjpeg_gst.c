@@ -188,6 +188,12 @@ void openavbIntfMjpegGstTxInitCB(media_q_t *pMediaQ)
 	return;
 }
 
+// Release callback for RTP buffers placed in the media queue by reference
+static void x_releaseTxBuf(void *pData, void *pCtx)
+{
+	gst_al_rtp_buffer_unref((GstAlBuf *)pCtx);
+}
+
 // This callback will be called for each AVB transmit interval. Commonly this will be
 // 4000 or 8000 times  per second.
 bool openavbIntfMjpegGstTxCB(media_q_t *pMediaQ)
@@ -227,8 +233,6 @@ bool openavbIntfMjpegGstTxCB(media_q_t *pMediaQ)
 	media_q_item_t *pMediaQItem = openavbMediaQHeadLock(pMediaQ);
 	if (pMediaQItem)
 	{
-		pMediaQItem->dataLen = paySize;
-		memcpy(pMediaQItem->pPubData, GST_AL_BUF_DATA(txBuf), paySize);
 		if (gst_al_rtp_buffer_get_marker(txBuf))
 		{
 			((media_q_item_map_mjpeg_pub_data_t *)pMediaQItem->pPubMapData)->lastFragment = TRUE;
@@ -246,10 +250,10 @@ bool openavbIntfMjpegGstTxCB(media_q_t *pMediaQ)
 			}
 			((media_q_item_map_mjpeg_pub_data_t *)pMediaQItem->pPubMapData)->lastFragment = FALSE;
 		}
+		// The item keeps txBuf until the mapping has copied it into the packet
+		openavbMediaQItemAddData(pMediaQItem, GST_AL_BUF_DATA(txBuf), paySize, x_releaseTxBuf, txBuf);
 		openavbMediaQHeadPush(pMediaQ);
 
-		gst_al_rtp_buffer_unref(txBuf);
-
 		AVB_TRACE_EXIT(AVB_TRACE_INTF_DETAIL);
 		return TRUE;
 	}
@@ -0,0 +1,717 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* MODULE SUMMARY : Shared memory interface module.
+*
+* Exchanges media queue items with an external process through a memfd
+* backed single producer / single consumer ring (see openavb_intf_shm_pub.h).
+* As a talker the external process produces frames into the ring and this
+* module hands them to the media queue: by reference to the ring slot when the
+* mapping module reads items through the segment API, copied otherwise. As a
+* listener this module copies media queue items into the ring for the
+* external process to consume.
+*
+* The external process connects to a Unix socket and receives the memfd and
+* two eventfds once. After that no system call is made per frame unless one
+* side runs dry and has to sleep. Pending connections are checked from the
+* TX/RX callbacks at a low rate, so no extra thread is needed.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/eventfd.h>
+#include "openavb_types_pub.h"
+#include "openavb_trace_pub.h"
+#include "openavb_mediaq_pub.h"
+#include "openavb_map_uncmp_audio_pub.h"
+#include "openavb_map_aaf_audio_pub.h"
+#include "openavb_map_pipe_pub.h"
+#include "openavb_map_mjpeg_pub.h"
+#include "openavb_map_h264_pub.h"
+#include "openavb_intf_pub.h"
+#include "openavb_intf_shm.h"
+
+#define	AVB_LOG_COMPONENT	"Shm Interface"
+#include "openavb_log_pub.h"
+
+#define SHM_DEFAULT_SLOTS				64
+#define SHM_CONNECTION_CHECK_NSEC		(100 * NANOSECONDS_PER_MSEC)
+
+typedef struct {
+	/////////////
+	// Config data
+	/////////////
+	// intf_nv_socket_path: Unix socket the external process connects to.
+	// A leading '@' uses the abstract namespace.
+	char *pSocketPath;
+
+	// intf_nv_ring_slots: Number of ring slots, rounded up to a power of two.
+	U32 ringSlots;
+
+	// intf_nv_slot_size: Data bytes per slot. 0 uses the media queue item size.
+	U32 slotSize;
+
+	// Ignore timestamp at listener.
+	bool ignoreTimestamp;
+
+	/////////////
+	// Variable data
+	/////////////
+	U16 streamUid;
+	bool bTalker;
+	openavb_shm_ring_t ring;
+	int listenFd;
+	int clientFd;
+	// Talker: media queue items reference the ring slots instead of copies
+	bool bByRef;
+	// Talker by reference: slots handed to the media queue and not yet released,
+	// and which of them the media queue is done with
+	U32 slotsHeld;
+	U8 *pSlotDone;
+	U64 nextConnectionCheckNsec;
+	U64 framesIn;
+	U64 framesOut;
+} pvt_data_t;
+
+static bool xSupportedMappingFormat(media_q_t *pMediaQ)
+{
+	if (pMediaQ) {
+		if (pMediaQ->pMediaQDataFormat) {
+			if (strcmp(pMediaQ->pMediaQDataFormat, MapUncmpAudioMediaQDataFormat) == 0 || strcmp(pMediaQ->pMediaQDataFormat, MapAVTPAudioMediaQDataFormat) == 0) {
+				return TRUE;
+			}
+		}
+	}
+	return FALSE;
+}
+
+// Mapping modules that read items with openavbMediaQItemCopy() or
+// openavbMediaQItemSpan(), so items may reference the ring slots
+static bool xByRefMappingFormat(media_q_t *pMediaQ)
+{
+	if (pMediaQ && pMediaQ->pMediaQDataFormat) {
+		if (strcmp(pMediaQ->pMediaQDataFormat, MapPipeMediaQDataFormat) == 0
+			|| strcmp(pMediaQ->pMediaQDataFormat, MapMjpegMediaQDataFormat) == 0
+			|| strcmp(pMediaQ->pMediaQDataFormat, MapH264MediaQDataFormat) == 0) {
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+// Release callback for ring slots placed in the media queue by reference.
+// The ring is released in order, up to the oldest slot still in use.
+static void xReleaseSlot(void *pData, void *pCtx)
+{
+	pvt_data_t *pPvtData = pCtx;
+	openavb_shm_ring_t *pRing = &pPvtData->ring;
+	U32 slotMask = pRing->pHdr->slotCount - 1;
+
+	pPvtData->pSlotDone[openavbShmRingSlotIndex(pRing, pData)] = TRUE;
+	while (pPvtData->slotsHeld && pPvtData->pSlotDone[pRing->pHdr->tail & slotMask]) {
+		pPvtData->pSlotDone[pRing->pHdr->tail & slotMask] = FALSE;
+		openavbShmRingConsumeRelease(pRing);
+		pPvtData->slotsHeld--;
+	}
+}
+
+static U64 xMonoNsec(void)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return ((U64)now.tv_sec * NANOSECONDS_PER_SECOND) + (U64)now.tv_nsec;
+}
+
+// The media queue does not expose its item size directly. Nobody else uses
+// the head during init, so briefly locking it is harmless.
+static U32 xMediaQItemSize(media_q_t *pMediaQ)
+{
+	U32 itemSize = 0;
+	media_q_item_t *pMediaQItem = openavbMediaQHeadLock(pMediaQ);
+	if (pMediaQItem) {
+		itemSize = pMediaQItem->itemSize;
+		openavbMediaQHeadUnlock(pMediaQ);
+	}
+	return itemSize;
+}
+
+static bool xCreateRing(pvt_data_t *pPvtData, U32 direction, U32 itemSize)
+{
+	openavb_shm_ring_t *pRing = &pPvtData->ring;
+	U32 slots = 1;
+	while (slots < pPvtData->ringSlots) {
+		slots <<= 1;
+	}
+	U32 slotSize = pPvtData->slotSize ? pPvtData->slotSize : itemSize;
+	if (slotSize == 0) {
+		AVB_LOG_ERROR("Unable to determine ring slot size; set intf_nv_slot_size");
+		return FALSE;
+	}
+
+	char name[32];
+	snprintf(name, sizeof(name), "openavb_shm_%u", pPvtData->streamUid);
+	pRing->memFd = memfd_create(name, MFD_CLOEXEC | MFD_ALLOW_SEALING);
+	if (pRing->memFd < 0) {
+		AVB_LOGF_ERROR("memfd_create failed: %s", strerror(errno));
+		return FALSE;
+	}
+
+	pRing->mapSize = openavbShmRingMemSize(slots, slotSize);
+	if (ftruncate(pRing->memFd, pRing->mapSize) < 0) {
+		AVB_LOGF_ERROR("ftruncate failed: %s", strerror(errno));
+		return FALSE;
+	}
+	// The client maps the whole size; make sure it can never change under it
+	fcntl(pRing->memFd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL);
+
+	void *pMap = mmap(NULL, pRing->mapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, pRing->memFd, 0);
+	if (pMap == MAP_FAILED) {
+		AVB_LOGF_ERROR("mmap failed: %s", strerror(errno));
+		return FALSE;
+	}
+	pRing->pHdr = pMap;
+	openavbShmRingInitHdr(pRing->pHdr, direction, slots, slotSize);
+	pRing->pSlots = (U8 *)pMap + pRing->pHdr->slotOffset;
+
+	pRing->dataEventFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	pRing->spaceEventFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	if (pRing->dataEventFd < 0 || pRing->spaceEventFd < 0) {
+		AVB_LOGF_ERROR("eventfd failed: %s", strerror(errno));
+		return FALSE;
+	}
+
+	AVB_LOGF_INFO("Ring created: %u slots of %u bytes (%zu bytes shared)", slots, slotSize, pRing->mapSize);
+	return TRUE;
+}
+
+static void xDestroyRing(pvt_data_t *pPvtData)
+{
+	openavb_shm_ring_t *pRing = &pPvtData->ring;
+	if (pRing->pHdr) {
+		munmap(pRing->pHdr, pRing->mapSize);
+		pRing->pHdr = NULL;
+	}
+	if (pRing->memFd >= 0) {
+		close(pRing->memFd);
+	}
+	if (pRing->dataEventFd >= 0) {
+		close(pRing->dataEventFd);
+	}
+	if (pRing->spaceEventFd >= 0) {
+		close(pRing->spaceEventFd);
+	}
+	pRing->memFd = pRing->dataEventFd = pRing->spaceEventFd = -1;
+}
+
+static bool xListen(pvt_data_t *pPvtData)
+{
+	struct sockaddr_un addr;
+	socklen_t addrLen;
+
+	if (!pPvtData->pSocketPath) {
+		char path[64];
+		snprintf(path, sizeof(path), "@openavb_shm_%u", pPvtData->streamUid);
+		pPvtData->pSocketPath = strdup(path);
+	}
+
+	if (!openavbShmSocketAddr(pPvtData->pSocketPath, &addr, &addrLen)) {
+		AVB_LOGF_ERROR("Invalid socket path: %s", pPvtData->pSocketPath);
+		return FALSE;
+	}
+
+	pPvtData->listenFd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (pPvtData->listenFd < 0) {
+		AVB_LOGF_ERROR("socket failed: %s", strerror(errno));
+		return FALSE;
+	}
+	if (pPvtData->pSocketPath[0] != '@') {
+		unlink(pPvtData->pSocketPath);
+	}
+	if (bind(pPvtData->listenFd, (struct sockaddr *)&addr, addrLen) < 0 || listen(pPvtData->listenFd, 1) < 0) {
+		AVB_LOGF_ERROR("Unable to listen on %s: %s", pPvtData->pSocketPath, strerror(errno));
+		close(pPvtData->listenFd);
+		pPvtData->listenFd = -1;
+		return FALSE;
+	}
+
+	AVB_LOGF_INFO("Waiting for shm client on %s", pPvtData->pSocketPath);
+	return TRUE;
+}
+
+// Accept a new client and pass it the ring. Only one client is served at a
+// time; a new connection replaces the previous one.
+static void xCheckConnection(pvt_data_t *pPvtData)
+{
+	U64 nowNsec = xMonoNsec();
+	if (nowNsec < pPvtData->nextConnectionCheckNsec) {
+		return;
+	}
+	pPvtData->nextConnectionCheckNsec = nowNsec + SHM_CONNECTION_CHECK_NSEC;
+
+	if (pPvtData->listenFd < 0 && !xListen(pPvtData)) {
+		return;
+	}
+
+	int fd = accept4(pPvtData->listenFd, NULL, NULL, SOCK_CLOEXEC);
+	if (fd < 0) {
+		if (errno != EAGAIN && errno != EWOULDBLOCK) {
+			AVB_LOGF_ERROR("accept failed: %s", strerror(errno));
+		}
+		return;
+	}
+
+	openavb_shm_hello_t hello;
+	hello.magic = OPENAVB_SHM_RING_MAGIC;
+	hello.version = OPENAVB_SHM_RING_VERSION;
+	hello.mapSize = pPvtData->ring.mapSize;
+
+	int fds[OPENAVB_SHM_NUM_FDS] = { pPvtData->ring.memFd, pPvtData->ring.dataEventFd, pPvtData->ring.spaceEventFd };
+	char cbuf[CMSG_SPACE(sizeof(fds))];
+	struct iovec iov = { .iov_base = &hello, .iov_len = sizeof(hello) };
+	struct msghdr msg;
+	memset(&msg, 0, sizeof(msg));
+	memset(cbuf, 0, sizeof(cbuf));
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = cbuf;
+	msg.msg_controllen = sizeof(cbuf);
+	struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+	cmsg->cmsg_level = SOL_SOCKET;
+	cmsg->cmsg_type = SCM_RIGHTS;
+	cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+	memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+
+	if (sendmsg(fd, &msg, MSG_NOSIGNAL) != sizeof(hello)) {
+		AVB_LOGF_ERROR("Unable to pass ring to shm client: %s", strerror(errno));
+		close(fd);
+		return;
+	}
+
+	if (pPvtData->clientFd >= 0) {
+		AVB_LOG_INFO("Replacing previous shm client");
+		close(pPvtData->clientFd);
+	}
+	pPvtData->clientFd = fd;
+	AVB_LOG_INFO("Shm client connected");
+}
+
+// Each configuration name value pair for this interface will result in this callback being called.
+void openavbIntfShmCfgCB(media_q_t *pMediaQ, const char *name, const char *value)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_INTF);
+
+	if (pMediaQ) {
+		pvt_data_t *pPvtData = pMediaQ->pPvtIntfInfo;
+		if (!pPvtData) {
+			AVB_LOG_ERROR("Private interface module data not allocated.");
+			return;
+		}
+
+		media_q_pub_map_uncmp_audio_info_t *pPubMapUncmpAudioInfo;
+		pPubMapUncmpAudioInfo = (media_q_pub_map_uncmp_audio_info_t *)pMediaQ->pPubMapInfo;
+
+		char *pEnd;
+		unsigned long tmp;
+		bool nameOK = TRUE, valueOK = FALSE;
+
+		if (strcmp(name, "intf_nv_socket_path") == 0) {
+			if (pPvtData->pSocketPath)
+				free(pPvtData->pSocketPath);
+			pPvtData->pSocketPath = strdup(value);
+			valueOK = TRUE;
+		}
+		else if (strcmp(name, "intf_nv_ring_slots") == 0) {
+			tmp = strtoul(value, &pEnd, 10);
+			if (*pEnd == '\0' && pEnd != value && tmp >= 2 && tmp <= 65536) {
+				pPvtData->ringSlots = tmp;
+				valueOK = TRUE;
+			}
+		}
+		else if (strcmp(name, "intf_nv_slot_size") == 0) {
+			tmp = strtoul(value, &pEnd, 10);
+			if (*pEnd == '\0' && pEnd != value) {
+				pPvtData->slotSize = tmp;
+				valueOK = TRUE;
+			}
+		}
+		else if (strcmp(name, "intf_nv_ignore_timestamp") == 0) {
+			tmp = strtoul(value, &pEnd, 10);
+			if (*pEnd == '\0' && pEnd != value && (tmp == 0 || tmp == 1)) {
+				pPvtData->ignoreTimestamp = (tmp == 1);
+				valueOK = TRUE;
+			}
+		}
+		else if (strcmp(name, "intf_nv_audio_rate") == 0 && xSupportedMappingFormat(pMediaQ)) {
+			tmp = strtoul(value, &pEnd, 10);
+			if (*pEnd == '\0' && tmp >= AVB_AUDIO_RATE_8KHZ && tmp <= AVB_AUDIO_RATE_192KHZ) {
+				pPubMapUncmpAudioInfo->audioRate = (avb_audio_rate_t)tmp;
+				valueOK = TRUE;
+			}
+		}
+		else if (strcmp(name, "intf_nv_audio_bit_depth") == 0 && xSupportedMappingFormat(pMediaQ)) {
+			tmp = strtoul(value, &pEnd, 10);
+			if (*pEnd == '\0' && tmp >= AVB_AUDIO_BIT_DEPTH_1BIT && tmp <= AVB_AUDIO_BIT_DEPTH_64BIT) {
+				pPubMapUncmpAudioInfo->audioBitDepth = (avb_audio_bit_depth_t)tmp;
+				valueOK = TRUE;
+			}
+		}
+		else if (strcmp(name, "intf_nv_audio_channels") == 0 && xSupportedMappingFormat(pMediaQ)) {
+			tmp = strtoul(value, &pEnd, 10);
+			if (*pEnd == '\0' && tmp >= AVB_AUDIO_CHANNELS_1) {
+				pPubMapUncmpAudioInfo->audioChannels = (avb_audio_channels_t)tmp;
+				valueOK = TRUE;
+			}
+		}
+		else if (strcmp(name, "intf_nv_audio_type") == 0 && xSupportedMappingFormat(pMediaQ)) {
+			valueOK = TRUE;
+			if (strncasecmp(value, "float", 5) == 0)
+				pPubMapUncmpAudioInfo->audioType = AVB_AUDIO_TYPE_FLOAT;
+			else if (strncasecmp(value, "sign", 4) == 0 || strncasecmp(value, "int", 4) == 0)
+				pPubMapUncmpAudioInfo->audioType = AVB_AUDIO_TYPE_INT;
+			else if (strncasecmp(value, "unsign", 6) == 0 || strncasecmp(value, "uint", 4) == 0)
+				pPubMapUncmpAudioInfo->audioType = AVB_AUDIO_TYPE_UINT;
+			else
+				valueOK = FALSE;
+		}
+		else if (strcmp(name, "intf_nv_audio_endian") == 0 && xSupportedMappingFormat(pMediaQ)) {
+			valueOK = TRUE;
+			if (strncasecmp(value, "big", 3) == 0)
+				pPubMapUncmpAudioInfo->audioEndian = AVB_AUDIO_ENDIAN_BIG;
+			else if (strncasecmp(value, "little", 6) == 0)
+				pPubMapUncmpAudioInfo->audioEndian = AVB_AUDIO_ENDIAN_LITTLE;
+			else
+				valueOK = FALSE;
+		}
+		else {
+			AVB_LOGF_WARNING("Unknown configuration item: %s", name);
+			nameOK = FALSE;
+		}
+
+		if (nameOK && !valueOK) {
+			AVB_LOGF_WARNING("Bad value for configuration item: %s = %s", name, value);
+		}
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_INTF);
+}
+
+void openavbIntfShmGenInitCB(media_q_t *pMediaQ)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_INTF);
+	AVB_TRACE_EXIT(AVB_TRACE_INTF);
+}
+
+// A call to this callback indicates that this interface module will be
+// a talker. Any talker initialization can be done in this function.
+void openavbIntfShmTxInitCB(media_q_t *pMediaQ)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_INTF);
+
+	if (pMediaQ) {
+		pvt_data_t *pPvtData = pMediaQ->pPvtIntfInfo;
+		if (!pPvtData) {
+			AVB_LOG_ERROR("Private interface module data not allocated.");
+			return;
+		}
+
+		pPvtData->bTalker = TRUE;
+		if (!xCreateRing(pPvtData, OPENAVB_SHM_DIR_TO_TL, xMediaQItemSize(pMediaQ))) {
+			xDestroyRing(pPvtData);
+		}
+		else if (xByRefMappingFormat(pMediaQ)) {
+			pPvtData->pSlotDone = calloc(pPvtData->ring.pHdr->slotCount, sizeof(U8));
+			pPvtData->bByRef = (pPvtData->pSlotDone != NULL);
+			pPvtData->slotsHeld = 0;
+		}
+		AVB_LOGF_INFO("Media queue items %s the ring slots", pPvtData->bByRef ? "reference" : "copy");
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_INTF);
+}
+
+// This callback will be called for each AVB transmit interval.
+bool openavbIntfShmTxCB(media_q_t *pMediaQ)
+{
+	bool moreItems = FALSE;
+
+	AVB_TRACE_ENTRY(AVB_TRACE_INTF_DETAIL);
+
+	if (pMediaQ) {
+		pvt_data_t *pPvtData = pMediaQ->pPvtIntfInfo;
+		if (!pPvtData) {
+			AVB_LOG_ERROR("Private interface module data not allocated.");
+			return FALSE;
+		}
+		if (!pPvtData->ring.pHdr) {
+			AVB_TRACE_EXIT(AVB_TRACE_INTF_DETAIL);
+			return FALSE;
+		}
+
+		xCheckConnection(pPvtData);
+
+		// Move everything the producer has ready, as long as the media queue has room
+		U32 dataLen;
+		U64 timestampNsec;
+		U8 *pData;
+		while ((pData = openavbShmRingConsumePeek(&pPvtData->ring, pPvtData->slotsHeld, &dataLen, &timestampNsec)) != NULL) {
+			media_q_item_t *pMediaQItem = openavbMediaQHeadLock(pMediaQ);
+			if (!pMediaQItem) {
+				break;	// Media queue full, the frame stays in the ring
+			}
+
+			if (pPvtData->bByRef) {
+				// The slot stays with the item until the mapping has sent it
+				pPvtData->slotsHeld++;
+				if (!openavbMediaQItemAddData(pMediaQItem, pData, dataLen, xReleaseSlot, pPvtData)) {
+					openavbMediaQHeadUnlock(pMediaQ);
+					continue;
+				}
+			}
+			else {
+				if (dataLen > pMediaQItem->itemSize) {
+					IF_LOG_INTERVAL(1000) AVB_LOGF_WARNING("Shm frame of %u bytes truncated to %u", dataLen, pMediaQItem->itemSize);
+					dataLen = pMediaQItem->itemSize;
+				}
+				memcpy(pMediaQItem->pPubData, pData, dataLen);
+				pMediaQItem->dataLen = dataLen;
+			}
+			if (timestampNsec) {
+				openavbAvtpTimeSetToTimestampNS(pMediaQItem->pAvtpTime, timestampNsec);
+			}
+			else {
+				openavbAvtpTimeSetToWallTime(pMediaQItem->pAvtpTime);
+			}
+			openavbMediaQHeadPush(pMediaQ);
+			if (!pPvtData->bByRef) {
+				openavbShmRingConsumeRelease(&pPvtData->ring);
+			}
+			pPvtData->framesIn++;
+			moreItems = TRUE;
+		}
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_INTF_DETAIL);
+	return moreItems;
+}
+
+// A call to this callback indicates that this interface module will be
+// a listener. Any listener initialization can be done in this function.
+void openavbIntfShmRxInitCB(media_q_t *pMediaQ)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_INTF);
+
+	if (pMediaQ) {
+		pvt_data_t *pPvtData = pMediaQ->pPvtIntfInfo;
+		if (!pPvtData) {
+			AVB_LOG_ERROR("Private interface module data not allocated.");
+			return;
+		}
+
+		pPvtData->bTalker = FALSE;
+		if (!xCreateRing(pPvtData, OPENAVB_SHM_DIR_FROM_TL, xMediaQItemSize(pMediaQ))) {
+			xDestroyRing(pPvtData);
+		}
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_INTF);
+}
+
+// This callback is called when acting as a listener.
+bool openavbIntfShmRxCB(media_q_t *pMediaQ)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_INTF_DETAIL);
+
+	if (pMediaQ) {
+		pvt_data_t *pPvtData = pMediaQ->pPvtIntfInfo;
+		if (!pPvtData) {
+			AVB_LOG_ERROR("Private interface module data not allocated.");
+			return FALSE;
+		}
+		if (!pPvtData->ring.pHdr) {
+			AVB_TRACE_EXIT(AVB_TRACE_INTF_DETAIL);
+			return FALSE;
+		}
+
+		xCheckConnection(pPvtData);
+
+		bool moreItems = TRUE;
+		while (moreItems) {
+			media_q_item_t *pMediaQItem = openavbMediaQTailLock(pMediaQ, pPvtData->ignoreTimestamp);
+			if (!pMediaQItem) {
+				break;
+			}
+
+			if (pPvtData->clientFd < 0) {
+				// Nobody to hand it to
+				openavbMediaQTailPull(pMediaQ);
+				continue;
+			}
+
+			U32 maxLen;
+			U8 *pData = openavbShmRingProduceBegin(&pPvtData->ring, &maxLen);
+			if (!pData) {
+				// Consumer is behind. Leave the item in the media queue; stale
+				// items are purged there if the consumer does not catch up.
+				IF_LOG_INTERVAL(1000) AVB_LOG_WARNING("Shm ring full");
+				pPvtData->ring.pHdr->overruns++;
+				openavbMediaQTailUnlock(pMediaQ);
+				moreItems = FALSE;
+				break;
+			}
+
+			U32 dataLen = pMediaQItem->dataLen < maxLen ? pMediaQItem->dataLen : maxLen;
+			memcpy(pData, pMediaQItem->pPubData, dataLen);
+			openavbShmRingProduceCommit(&pPvtData->ring, dataLen, openavbAvtpTimeGetAvtpTimeNS(pMediaQItem->pAvtpTime));
+			openavbMediaQTailPull(pMediaQ);
+			pPvtData->framesOut++;
+		}
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_INTF_DETAIL);
+	return FALSE;
+}
+
+// This callback will be called when the interface needs to be closed. All shutdown should
+// occur in this function.
+void openavbIntfShmEndCB(media_q_t *pMediaQ)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_INTF);
+
+	if (pMediaQ) {
+		pvt_data_t *pPvtData = pMediaQ->pPvtIntfInfo;
+		if (!pPvtData) {
+			AVB_LOG_ERROR("Private interface module data not allocated.");
+			return;
+		}
+
+		AVB_LOGF_INFO("Shm interface closing: frames in=%" PRIu64 " out=%" PRIu64, pPvtData->framesIn, pPvtData->framesOut);
+
+		if (pPvtData->bByRef) {
+			// Items still referencing the ring must go before it is unmapped
+			while (openavbMediaQTailLock(pMediaQ, TRUE)) {
+				openavbMediaQTailPull(pMediaQ);
+			}
+			free(pPvtData->pSlotDone);
+			pPvtData->pSlotDone = NULL;
+			pPvtData->bByRef = FALSE;
+		}
+
+		if (pPvtData->clientFd >= 0) {
+			close(pPvtData->clientFd);
+			pPvtData->clientFd = -1;
+		}
+		if (pPvtData->listenFd >= 0) {
+			close(pPvtData->listenFd);
+			pPvtData->listenFd = -1;
+			if (pPvtData->pSocketPath && pPvtData->pSocketPath[0] != '@') {
+				unlink(pPvtData->pSocketPath);
+			}
+		}
+		xDestroyRing(pPvtData);
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_INTF);
+}
+
+void openavbIntfShmGenEndCB(media_q_t *pMediaQ)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_INTF);
+
+	if (pMediaQ) {
+		pvt_data_t *pPvtData = pMediaQ->pPvtIntfInfo;
+		if (pPvtData && pPvtData->pSocketPath) {
+			free(pPvtData->pSocketPath);
+			pPvtData->pSocketPath = NULL;
+		}
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_INTF);
+}
+
+void openavbIntfShmSetStreamUidCB(media_q_t *pMediaQ, U16 stream_uid)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_INTF);
+
+	if (pMediaQ) {
+		pvt_data_t *pPvtData = pMediaQ->pPvtIntfInfo;
+		if (pPvtData) {
+			pPvtData->streamUid = stream_uid;
+		}
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_INTF);
+}
+
+// Main initialization entry point into the interface module
+extern DLL_EXPORT bool openavbIntfShmInitialize(media_q_t *pMediaQ, openavb_intf_cb_t *pIntfCB)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_INTF);
+
+	if (pMediaQ) {
+		pMediaQ->pPvtIntfInfo = calloc(1, sizeof(pvt_data_t));		// Memory freed by the media queue when the media queue is destroyed.
+
+		if (!pMediaQ->pPvtIntfInfo) {
+			AVB_LOG_ERROR("Unable to allocate memory for AVTP interface module.");
+			return FALSE;
+		}
+
+		pvt_data_t *pPvtData = pMediaQ->pPvtIntfInfo;
+
+		pIntfCB->intf_cfg_cb = openavbIntfShmCfgCB;
+		pIntfCB->intf_gen_init_cb = openavbIntfShmGenInitCB;
+		pIntfCB->intf_tx_init_cb = openavbIntfShmTxInitCB;
+		pIntfCB->intf_tx_cb = openavbIntfShmTxCB;
+		pIntfCB->intf_rx_init_cb = openavbIntfShmRxInitCB;
+		pIntfCB->intf_rx_cb = openavbIntfShmRxCB;
+		pIntfCB->intf_end_cb = openavbIntfShmEndCB;
+		pIntfCB->intf_gen_end_cb = openavbIntfShmGenEndCB;
+		pIntfCB->intf_set_stream_uid_cb = openavbIntfShmSetStreamUidCB;
+
+		pPvtData->ringSlots = SHM_DEFAULT_SLOTS;
+		pPvtData->slotSize = 0;
+		pPvtData->ignoreTimestamp = FALSE;
+		pPvtData->listenFd = -1;
+		pPvtData->clientFd = -1;
+		pPvtData->ring.memFd = -1;
+		pPvtData->ring.dataEventFd = -1;
+		pPvtData->ring.spaceEventFd = -1;
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_INTF);
+	return TRUE;
+}
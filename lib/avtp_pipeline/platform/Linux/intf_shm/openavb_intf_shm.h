@@ -0,0 +1,65 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* HEADER SUMMARY : Shared memory interface module internal declarations.
+*/
+
+#ifndef OPENAVB_INTF_SHM_H
+#define OPENAVB_INTF_SHM_H 1
+
+#include <stddef.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "openavb_intf_shm_pub.h"
+
+// memfd, data eventfd and space eventfd are passed to the client
+#define OPENAVB_SHM_NUM_FDS		3
+
+// Message sent along with the file descriptors on connect
+typedef struct {
+	U32 magic;
+	U32 version;
+	U64 mapSize;
+} openavb_shm_hello_t;
+
+void openavbShmRingInitHdr(openavb_shm_ring_hdr_t *pHdr, U32 direction, U32 slotCount, U32 slotSize);
+
+// Consumer: the filled slot ahead slots past the oldest one, NULL if there is
+// none yet. Lets the consumer hold several slots and release them in order.
+U8 *openavbShmRingConsumePeek(openavb_shm_ring_t *pRing, U32 ahead, U32 *pDataLen, U64 *pTimestampNsec);
+
+// Index of the slot whose data area is pData
+U32 openavbShmRingSlotIndex(openavb_shm_ring_t *pRing, const U8 *pData);
+
+bool openavbShmSocketAddr(const char *socketPath, struct sockaddr_un *pAddr, socklen_t *pAddrLen);
+
+#endif // OPENAVB_INTF_SHM_H
@@ -0,0 +1,160 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* HEADER SUMMARY : Shared memory interface module public interface.
+*
+* Layout of the shared memory ring used by the shm interface module and the
+* client API external processes use to feed (talker) or drain (listener) a
+* stream through it.
+*/
+
+#ifndef OPENAVB_INTF_SHM_PUB_H
+#define OPENAVB_INTF_SHM_PUB_H 1
+
+#include "openavb_types_pub.h"
+
+/** \file
+ * Shared memory interface.
+ *
+ * The talker or listener process owns a memfd backed single producer /
+ * single consumer ring of media queue sized slots and two eventfds. An
+ * external process connects to the Unix socket configured with
+ * intf_nv_socket_path and receives the three file descriptors. From then on
+ * frames are exchanged by writing and reading slots in place; the eventfds
+ * are only signalled when the other side has announced that it is about to
+ * sleep, so a busy stream does not cost any system calls per frame.
+ */
+
+#define OPENAVB_SHM_RING_MAGIC		0x4F415653	// "OAVS"
+#define OPENAVB_SHM_RING_VERSION	1
+#define OPENAVB_SHM_CACHE_LINE		64
+
+/// Data flows from the external process into the talker.
+#define OPENAVB_SHM_DIR_TO_TL		1
+/// Data flows from the listener to the external process.
+#define OPENAVB_SHM_DIR_FROM_TL		2
+
+/** Ring header at offset 0 of the shared memory.
+ * Producer and consumer indexes are free running and live on separate cache
+ * lines so the two sides never write to the same line.
+ */
+typedef struct {
+	U32 magic;
+	U32 version;
+	U32 direction;			///< OPENAVB_SHM_DIR_TO_TL or OPENAVB_SHM_DIR_FROM_TL
+	U32 slotCount;			///< Number of slots, power of two
+	U32 slotSize;			///< Usable data bytes per slot
+	U32 slotStride;			///< Bytes between consecutive slots
+	U32 slotOffset;			///< Offset of the first slot from the header
+	U32 reserved;
+	U8 pad0[OPENAVB_SHM_CACHE_LINE - (8 * sizeof(U32))];
+
+	U32 head;				///< Written by the producer only
+	U32 consumerWaiting;	///< Set by the consumer before it sleeps on the data eventfd
+	U8 pad1[OPENAVB_SHM_CACHE_LINE - (2 * sizeof(U32))];
+
+	U32 tail;				///< Written by the consumer only
+	U32 producerWaiting;	///< Set by the producer before it sleeps on the space eventfd
+	U8 pad2[OPENAVB_SHM_CACHE_LINE - (2 * sizeof(U32))];
+
+	U32 overruns;			///< Frames the listener could not hand over because the ring was full
+	U8 pad3[OPENAVB_SHM_CACHE_LINE - sizeof(U32)];
+} openavb_shm_ring_hdr_t;
+
+/** Slot header. dataLen bytes of media data follow directly.
+ */
+typedef struct {
+	U32 dataLen;
+	U32 flags;
+	/// Talker: capture time in gPTP nanoseconds, 0 to let the interface stamp
+	/// it with the current walltime. Listener: presentation time.
+	U64 timestampNsec;
+} openavb_shm_slot_t;
+
+/** Ring handle used by both ends. */
+typedef struct {
+	openavb_shm_ring_hdr_t *pHdr;
+	U8 *pSlots;
+	size_t mapSize;
+	int memFd;
+	int dataEventFd;		///< Signalled by the producer: data available
+	int spaceEventFd;		///< Signalled by the consumer: space available
+} openavb_shm_ring_t;
+
+/** Size in bytes of the shared memory needed for a ring. */
+size_t openavbShmRingMemSize(U32 slotCount, U32 slotSize);
+
+/** Producer: get the next free slot, NULL if the ring is full.
+ * \param pRing The ring
+ * \param pMaxLen Set to the number of data bytes the slot can hold
+ * \return Pointer to the slot data area
+ */
+U8 *openavbShmRingProduceBegin(openavb_shm_ring_t *pRing, U32 *pMaxLen);
+
+/** Producer: publish the slot returned by openavbShmRingProduceBegin(). */
+void openavbShmRingProduceCommit(openavb_shm_ring_t *pRing, U32 dataLen, U64 timestampNsec);
+
+/** Consumer: get the oldest filled slot, NULL if the ring is empty.
+ * \param pRing The ring
+ * \param pDataLen Set to the number of valid data bytes
+ * \param pTimestampNsec Set to the slot timestamp, may be NULL
+ * \return Pointer to the slot data area, valid until openavbShmRingConsumeRelease()
+ */
+U8 *openavbShmRingConsumeBegin(openavb_shm_ring_t *pRing, U32 *pDataLen, U64 *pTimestampNsec);
+
+/** Consumer: hand the slot returned by openavbShmRingConsumeBegin() back. */
+void openavbShmRingConsumeRelease(openavb_shm_ring_t *pRing);
+
+/** Number of filled slots. */
+U32 openavbShmRingLevel(openavb_shm_ring_t *pRing);
+
+/** Block until the ring has data (consumer) or space (producer).
+ * \param pRing The ring
+ * \param producer TRUE to wait for space, FALSE to wait for data
+ * \param timeoutMsec poll() style timeout, -1 waits forever
+ * \return TRUE if the ring is ready, FALSE on timeout or error
+ */
+bool openavbShmRingWait(openavb_shm_ring_t *pRing, bool producer, int timeoutMsec);
+
+/** Connect to a talker or listener shm interface.
+ *
+ * \param pRing Ring handle to fill in
+ * \param socketPath Path given in intf_nv_socket_path. A leading '@' selects
+ *        the Linux abstract socket namespace.
+ * \return TRUE on success
+ */
+bool openavbShmClientConnect(openavb_shm_ring_t *pRing, const char *socketPath);
+
+/** Unmap the ring and close all file descriptors. */
+void openavbShmClientClose(openavb_shm_ring_t *pRing);
+
+#endif // OPENAVB_INTF_SHM_PUB_H
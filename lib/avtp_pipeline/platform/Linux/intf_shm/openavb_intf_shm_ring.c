@@ -0,0 +1,301 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* MODULE SUMMARY : Shared memory ring used by the shm interface module.
+*
+* This file has no dependencies on the rest of the AVB stack so external
+* producer and consumer processes can build it in directly.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "openavb_intf_shm_pub.h"
+#include "openavb_intf_shm.h"
+
+#define LOAD_ACQUIRE(p)			__atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define STORE_RELEASE(p, v)		__atomic_store_n((p), (v), __ATOMIC_RELEASE)
+
+static inline openavb_shm_slot_t *x_slot(openavb_shm_ring_t *pRing, U32 idx)
+{
+	return (openavb_shm_slot_t *)(pRing->pSlots + (size_t)(idx & (pRing->pHdr->slotCount - 1)) * pRing->pHdr->slotStride);
+}
+
+// Wake the other side only when it announced it is going to sleep. The full
+// fence orders our index update before reading its waiting flag; the waiter
+// sets its flag before re-checking the index, so one of us sees the other.
+static inline void x_notify(U32 *pWaiting, int eventFd)
+{
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	if (__atomic_load_n(pWaiting, __ATOMIC_RELAXED)) {
+		U64 one = 1;
+		if (write(eventFd, &one, sizeof(one)) < 0) {
+			// Counter saturated or fd gone; either way the peer will poll again
+		}
+	}
+}
+
+size_t openavbShmRingMemSize(U32 slotCount, U32 slotSize)
+{
+	size_t stride = (sizeof(openavb_shm_slot_t) + slotSize + OPENAVB_SHM_CACHE_LINE - 1) & ~(size_t)(OPENAVB_SHM_CACHE_LINE - 1);
+	return sizeof(openavb_shm_ring_hdr_t) + stride * slotCount;
+}
+
+void openavbShmRingInitHdr(openavb_shm_ring_hdr_t *pHdr, U32 direction, U32 slotCount, U32 slotSize)
+{
+	memset(pHdr, 0, sizeof(*pHdr));
+	pHdr->magic = OPENAVB_SHM_RING_MAGIC;
+	pHdr->version = OPENAVB_SHM_RING_VERSION;
+	pHdr->direction = direction;
+	pHdr->slotCount = slotCount;
+	pHdr->slotSize = slotSize;
+	pHdr->slotStride = (sizeof(openavb_shm_slot_t) + slotSize + OPENAVB_SHM_CACHE_LINE - 1) & ~(OPENAVB_SHM_CACHE_LINE - 1);
+	pHdr->slotOffset = sizeof(openavb_shm_ring_hdr_t);
+}
+
+U8 *openavbShmRingProduceBegin(openavb_shm_ring_t *pRing, U32 *pMaxLen)
+{
+	openavb_shm_ring_hdr_t *pHdr = pRing->pHdr;
+	U32 head = pHdr->head;
+
+	if (head - LOAD_ACQUIRE(&pHdr->tail) >= pHdr->slotCount) {
+		return NULL;
+	}
+
+	if (pMaxLen) {
+		*pMaxLen = pHdr->slotSize;
+	}
+	return (U8 *)(x_slot(pRing, head) + 1);
+}
+
+void openavbShmRingProduceCommit(openavb_shm_ring_t *pRing, U32 dataLen, U64 timestampNsec)
+{
+	openavb_shm_ring_hdr_t *pHdr = pRing->pHdr;
+	U32 head = pHdr->head;
+	openavb_shm_slot_t *pSlot = x_slot(pRing, head);
+
+	pSlot->dataLen = dataLen < pHdr->slotSize ? dataLen : pHdr->slotSize;
+	pSlot->flags = 0;
+	pSlot->timestampNsec = timestampNsec;
+	STORE_RELEASE(&pHdr->head, head + 1);
+
+	x_notify(&pHdr->consumerWaiting, pRing->dataEventFd);
+}
+
+U8 *openavbShmRingConsumeBegin(openavb_shm_ring_t *pRing, U32 *pDataLen, U64 *pTimestampNsec)
+{
+	return openavbShmRingConsumePeek(pRing, 0, pDataLen, pTimestampNsec);
+}
+
+U8 *openavbShmRingConsumePeek(openavb_shm_ring_t *pRing, U32 ahead, U32 *pDataLen, U64 *pTimestampNsec)
+{
+	openavb_shm_ring_hdr_t *pHdr = pRing->pHdr;
+	U32 tail = pHdr->tail;
+
+	if (LOAD_ACQUIRE(&pHdr->head) - tail <= ahead) {
+		return NULL;
+	}
+
+	openavb_shm_slot_t *pSlot = x_slot(pRing, tail + ahead);
+	U32 dataLen = pSlot->dataLen;
+	if (pDataLen) {
+		// Never trust the peer with a length past the slot
+		*pDataLen = dataLen < pHdr->slotSize ? dataLen : pHdr->slotSize;
+	}
+	if (pTimestampNsec) {
+		*pTimestampNsec = pSlot->timestampNsec;
+	}
+	return (U8 *)(pSlot + 1);
+}
+
+void openavbShmRingConsumeRelease(openavb_shm_ring_t *pRing)
+{
+	openavb_shm_ring_hdr_t *pHdr = pRing->pHdr;
+
+	STORE_RELEASE(&pHdr->tail, pHdr->tail + 1);
+
+	x_notify(&pHdr->producerWaiting, pRing->spaceEventFd);
+}
+
+U32 openavbShmRingSlotIndex(openavb_shm_ring_t *pRing, const U8 *pData)
+{
+	return (pData - sizeof(openavb_shm_slot_t) - pRing->pSlots) / pRing->pHdr->slotStride;
+}
+
+U32 openavbShmRingLevel(openavb_shm_ring_t *pRing)
+{
+	return LOAD_ACQUIRE(&pRing->pHdr->head) - LOAD_ACQUIRE(&pRing->pHdr->tail);
+}
+
+bool openavbShmRingWait(openavb_shm_ring_t *pRing, bool producer, int timeoutMsec)
+{
+	openavb_shm_ring_hdr_t *pHdr = pRing->pHdr;
+	U32 *pWaiting = producer ? &pHdr->producerWaiting : &pHdr->consumerWaiting;
+	int fd = producer ? pRing->spaceEventFd : pRing->dataEventFd;
+	bool ready;
+
+	__atomic_store_n(pWaiting, 1, __ATOMIC_SEQ_CST);
+
+	U32 level = openavbShmRingLevel(pRing);
+	ready = producer ? (level < pHdr->slotCount) : (level > 0);
+	if (!ready) {
+		struct pollfd pfd = { .fd = fd, .events = POLLIN, .revents = 0 };
+		if (poll(&pfd, 1, timeoutMsec) > 0) {
+			U64 count;
+			if (read(fd, &count, sizeof(count)) < 0) {
+				// Non-blocking eventfd raced with another read; nothing to do
+			}
+		}
+		level = openavbShmRingLevel(pRing);
+		ready = producer ? (level < pHdr->slotCount) : (level > 0);
+	}
+
+	__atomic_store_n(pWaiting, 0, __ATOMIC_RELAXED);
+	return ready;
+}
+
+bool openavbShmSocketAddr(const char *socketPath, struct sockaddr_un *pAddr, socklen_t *pAddrLen)
+{
+	size_t len = strlen(socketPath);
+
+	memset(pAddr, 0, sizeof(*pAddr));
+	pAddr->sun_family = AF_UNIX;
+	if (len == 0 || len >= sizeof(pAddr->sun_path)) {
+		return FALSE;
+	}
+
+	memcpy(pAddr->sun_path, socketPath, len);
+	if (socketPath[0] == '@') {
+		// Abstract namespace: leading NUL, not NUL terminated
+		pAddr->sun_path[0] = '\0';
+		*pAddrLen = offsetof(struct sockaddr_un, sun_path) + len;
+	}
+	else {
+		*pAddrLen = offsetof(struct sockaddr_un, sun_path) + len + 1;
+	}
+	return TRUE;
+}
+
+bool openavbShmClientConnect(openavb_shm_ring_t *pRing, const char *socketPath)
+{
+	struct sockaddr_un addr;
+	socklen_t addrLen;
+
+	memset(pRing, 0, sizeof(*pRing));
+	pRing->memFd = pRing->dataEventFd = pRing->spaceEventFd = -1;
+
+	if (!openavbShmSocketAddr(socketPath, &addr, &addrLen)) {
+		errno = EINVAL;
+		return FALSE;
+	}
+
+	int sock = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+	if (sock < 0) {
+		return FALSE;
+	}
+	if (connect(sock, (struct sockaddr *)&addr, addrLen) < 0) {
+		close(sock);
+		return FALSE;
+	}
+
+	openavb_shm_hello_t hello;
+	int fds[OPENAVB_SHM_NUM_FDS];
+	char cbuf[CMSG_SPACE(sizeof(fds))];
+	struct iovec iov = { .iov_base = &hello, .iov_len = sizeof(hello) };
+	struct msghdr msg;
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = cbuf;
+	msg.msg_controllen = sizeof(cbuf);
+
+	ssize_t n = recvmsg(sock, &msg, MSG_CMSG_CLOEXEC);
+	close(sock);
+
+	struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+	if (n != sizeof(hello) || !cmsg || cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS
+		|| cmsg->cmsg_len != CMSG_LEN(sizeof(fds))) {
+		errno = EPROTO;
+		return FALSE;
+	}
+	memcpy(fds, CMSG_DATA(cmsg), sizeof(fds));
+	pRing->memFd = fds[0];
+	pRing->dataEventFd = fds[1];
+	pRing->spaceEventFd = fds[2];
+
+	if (hello.magic != OPENAVB_SHM_RING_MAGIC || hello.version != OPENAVB_SHM_RING_VERSION) {
+		openavbShmClientClose(pRing);
+		errno = EPROTO;
+		return FALSE;
+	}
+
+	void *pMap = mmap(NULL, hello.mapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, pRing->memFd, 0);
+	if (pMap == MAP_FAILED) {
+		openavbShmClientClose(pRing);
+		return FALSE;
+	}
+	pRing->pHdr = pMap;
+	pRing->mapSize = hello.mapSize;
+	pRing->pSlots = (U8 *)pMap + pRing->pHdr->slotOffset;
+
+	if (pRing->pHdr->magic != OPENAVB_SHM_RING_MAGIC
+		|| openavbShmRingMemSize(pRing->pHdr->slotCount, pRing->pHdr->slotSize) > hello.mapSize) {
+		openavbShmClientClose(pRing);
+		errno = EPROTO;
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+void openavbShmClientClose(openavb_shm_ring_t *pRing)
+{
+	if (pRing->pHdr) {
+		munmap(pRing->pHdr, pRing->mapSize);
+		pRing->pHdr = NULL;
+	}
+	if (pRing->memFd >= 0) {
+		close(pRing->memFd);
+	}
+	if (pRing->dataEventFd >= 0) {
+		close(pRing->dataEventFd);
+	}
+	if (pRing->spaceEventFd >= 0) {
+		close(pRing->spaceEventFd);
+	}
+	pRing->memFd = pRing->dataEventFd = pRing->spaceEventFd = -1;
+}
@@ -0,0 +1,143 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+ 
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ 
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ 
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+Attributions: The inih library portion of the source code is licensed from 
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt. 
+Complete license and copyright information can be found at 
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* MODULE SUMMARY : Linux chunk mapping and NUMA topology for the streaming buffer arena.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include "openavb_platform.h"
+#include "openavb_arena_osal.h"
+
+#define	AVB_LOG_COMPONENT	"Arena"
+#include "openavb_log.h"
+
+// From <numaif.h>; avoids a libnuma dependency
+#ifndef MPOL_PREFERRED
+#define MPOL_PREFERRED	1
+#endif
+
+void *osalArenaMapChunk(size_t size, int numaNode, bool hugePages, bool *pHugePages)
+{
+	static bool hugePagesWarned = FALSE;
+	void *pChunk = MAP_FAILED;
+
+	*pHugePages = FALSE;
+	if (hugePages) {
+		pChunk = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+		if (pChunk != MAP_FAILED) {
+			*pHugePages = TRUE;
+		}
+		else if (!hugePagesWarned) {
+			hugePagesWarned = TRUE;
+			AVB_LOGF_WARNING("No huge pages available (%s); reserve some via /proc/sys/vm/nr_hugepages. Using normal pages.", strerror(errno));
+		}
+	}
+	if (pChunk == MAP_FAILED) {
+		pChunk = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (pChunk == MAP_FAILED) {
+			AVB_LOGF_ERROR("Arena chunk mmap failed: %s", strerror(errno));
+			return NULL;
+		}
+		if (hugePages) {
+			// Let transparent huge pages back it if enabled
+			madvise(pChunk, size, MADV_HUGEPAGE);
+		}
+	}
+
+	// The policy has to be in place before the pages are first touched
+	if (numaNode >= 0 && numaNode < 64) {
+		unsigned long nodeMask = 1UL << numaNode;
+		if (syscall(SYS_mbind, pChunk, size, MPOL_PREFERRED, &nodeMask, sizeof(nodeMask) * 8, 0) != 0) {
+			AVB_LOGF_DEBUG("mbind to node %d failed: %s", numaNode, strerror(errno));
+		}
+	}
+
+	// Prefault now so the streaming threads never take a page fault on these buffers
+	memset(pChunk, 0, size);
+	mlock(pChunk, size);
+
+	return pChunk;
+}
+
+void osalArenaUnmapChunk(void *pChunk, size_t size)
+{
+	munlock(pChunk, size);
+	munmap(pChunk, size);
+}
+
+int osalArenaNodeOfCpu(U32 cpu)
+{
+	char path[64];
+	snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u", cpu);
+
+	DIR *pDir = opendir(path);
+	if (!pDir) {
+		return -1;
+	}
+
+	int node = -1;
+	struct dirent *pEntry;
+	while ((pEntry = readdir(pDir)) != NULL) {
+		if (strncmp(pEntry->d_name, "node", 4) == 0 && pEntry->d_name[4] >= '0' && pEntry->d_name[4] <= '9') {
+			node = atoi(pEntry->d_name + 4);
+			break;
+		}
+	}
+	closedir(pDir);
+	return node;
+}
+
+int osalArenaNodeOfInterface(const char *ifname)
+{
+	char path[128];
+	snprintf(path, sizeof(path), "/sys/class/net/%s/device/numa_node", ifname);
+
+	// Virtual interfaces have no device link; single node systems report -1
+	FILE *pFile = fopen(path, "r");
+	if (!pFile) {
+		return -1;
+	}
+
+	int node = -1;
+	if (fscanf(pFile, "%d", &node) != 1) {
+		node = -1;
+	}
+	fclose(pFile);
+	return node;
+}
@@ -0,0 +1,58 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+ 
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ 
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ 
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+Attributions: The inih library portion of the source code is licensed from 
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt. 
+Complete license and copyright information can be found at 
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* HEADER SUMMARY : OS abstraction for the streaming buffer arena.
+*/
+
+#ifndef _OPENAVB_ARENA_OSAL_H
+#define _OPENAVB_ARENA_OSAL_H
+
+#include <stddef.h>
+#include "openavb_types.h"
+
+// Granularity of arena chunks. Matches the huge page size so a chunk maps to one TLB entry.
+#define ARENA_OSAL_CHUNK_SIZE		(2 * 1024 * 1024)
+
+// Map a zeroed, prefaulted chunk of size bytes, preferably on numaNode (-1 for any).
+// pHugePages reports whether huge pages were actually used. Returns NULL on failure.
+void *osalArenaMapChunk(size_t size, int numaNode, bool hugePages, bool *pHugePages);
+
+// Unmap a chunk returned by osalArenaMapChunk().
+void osalArenaUnmapChunk(void *pChunk, size_t size);
+
+// NUMA node of a CPU, or -1 if unknown.
+int osalArenaNodeOfCpu(U32 cpu);
+
+// NUMA node of a network interface, or -1 if unknown.
+int osalArenaNodeOfInterface(const char *ifname);
+
+#endif // _OPENAVB_ARENA_OSAL_H
@@ -64,11 +64,27 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #define RAWSOCK_MIN_TIMEOUT_USEC	1
 
 #define SLEEP(sec)  							   sleep(sec)
-#define SLEEP_MSEC(mSec)						   usleep(mSec * 1000)
-#define SLEEP_NSEC(nSec)						   usleep(nSec / 1000)
+#define SLEEP_MSEC(mSec)						   xSleepNSec((U64)(mSec) * NANOSECONDS_PER_MSEC)
+#define SLEEP_NSEC(nSec)						   xSleepNSec(nSec)
+inline static void xSleepNSec(U64 nSec)
+{
+	if (osalTimeSource) {
+		U64 nowNS = 0;
+		osalTimeSource->getTime(osalTimeSource->pCtx, OPENAVB_CLOCK_MONOTONIC, &nowNS);
+		osalTimeSource->sleepUntil(osalTimeSource->pCtx, OPENAVB_CLOCK_MONOTONIC, nowNS + nSec);
+		return;
+	}
+	usleep(nSec / 1000);
+}
+
 #define SLEEP_UNTIL_NSEC(nSec)  				   xSleepUntilNSec(nSec)
 inline static void xSleepUntilNSec(U64 nSec)
 {
+	if (osalTimeSource) {
+		osalTimeSource->sleepUntil(osalTimeSource->pCtx, OPENAVB_CLOCK_MONOTONIC, nSec);
+		return;
+	}
+
 	struct timespec tmpTime;
 	tmpTime.tv_sec = nSec / NANOSECONDS_PER_SECOND;
 	tmpTime.tv_nsec = nSec % NANOSECONDS_PER_SECOND;
@@ -78,6 +94,12 @@ inline static void xSleepUntilNSec(U64 nSec)
 #define SPIN_UNTIL_NSEC(nsec)					xSpinUntilNSec(nsec)
 inline static void xSpinUntilNSec(U64 nSec)
 {
+	if (osalTimeSource) {
+		// A virtual clock only moves while its threads wait
+		osalTimeSource->sleepUntil(osalTimeSource->pCtx, OPENAVB_CLOCK_WALLTIME, nSec);
+		return;
+	}
+
 	do {
 		U64 spinNowNS;
 		CLOCK_GETTIME64(OPENAVB_CLOCK_WALLTIME, &spinNowNS);
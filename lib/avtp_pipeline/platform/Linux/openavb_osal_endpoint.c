@@ -32,6 +32,8 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #include "openavb_platform.h"
 #include "openavb_osal.h"
 #include "openavb_qmgr.h"
+#include "openavb_arena.h"
+#include "openavb_placement.h"
 #include "openavb_endpoint.h"
 
 #define	AVB_LOG_COMPONENT	"osal"
@@ -56,6 +58,8 @@ extern DLL_EXPORT bool osalAVBInitialize(const char* logfilename, const char* if
 
 	avbLogInitEx(s_logfile);
 	osalAVBTimeInit();
+	openavbArenaInitialize();
+	openavbPlacementInitialize();
 	startEndpoint(FQTSS_MODE_HW_CLASS, 0, ifname, 0, 0, 0);
 	return TRUE;
 }
@@ -63,6 +67,8 @@ extern DLL_EXPORT bool osalAVBInitialize(const char* logfilename, const char* if
 extern DLL_EXPORT bool osalAVBFinalize(void)
 {
 	stopEndpoint();
+	openavbPlacementFinalize();
+	openavbArenaFinalize();
 	osalAVBTimeClose();
 	avbLogExit();
 
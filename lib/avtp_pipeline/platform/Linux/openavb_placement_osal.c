@@ -0,0 +1,340 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* MODULE SUMMARY : Linux NIC queue topology, RX steering rules and thread pinning
+* for the placement of streams.
+*
+* Queue maps come from sysfs (/sys/class/net/<if>/queues) and the interrupt
+* names in /proc/interrupts. Steering rules are ethtool ntuple rules, added
+* through the SIOCETHTOOL ioctl, so the ethtool tool is not needed; they
+* need CAP_NET_ADMIN and "ethtool -K <if> ntuple on".
+*/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sched.h>
+#include <pthread.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <net/if.h>
+#include <linux/ethtool.h>
+#include <linux/sockios.h>
+#include "openavb_platform.h"
+#include "openavb_placement_osal.h"
+
+#define	AVB_LOG_COMPONENT	"Placement"
+#include "openavb_log.h"
+
+// Parse a sysfs CPU mask ("00000000,0000000f": 32 bit hex words, most significant first)
+static bool x_parseCpuMask(const char *text, openavb_cpu_mask_t *pMask)
+{
+	const char *end = text + strlen(text);
+	int cpu = 0;
+	bool any = FALSE;
+
+	while (end > text && isspace((unsigned char)end[-1])) {
+		end--;
+	}
+	while (end > text && cpu < OPENAVB_PLACEMENT_MAX_CPUS) {
+		const char *p = end;
+		while (p > text && p[-1] != ',') {
+			p--;
+		}
+		char word[16];
+		size_t len = end - p < (int)sizeof(word) - 1 ? (size_t)(end - p) : sizeof(word) - 1;
+		memcpy(word, p, len);
+		word[len] = '\0';
+
+		unsigned long bits = strtoul(word, NULL, 16);
+		int i;
+		for (i = 0; i < 32 && cpu + i < OPENAVB_PLACEMENT_MAX_CPUS; i++) {
+			if (bits & (1UL << i)) {
+				OPENAVB_CPU_MASK_SET(pMask, cpu + i);
+				any = TRUE;
+			}
+		}
+		cpu += 32;
+		end = p > text ? p - 1 : p;
+	}
+	return any;
+}
+
+// Parse a CPU list ("0-3,8")
+static bool x_parseCpuList(const char *text, openavb_cpu_mask_t *pMask)
+{
+	const char *p = text;
+	bool any = FALSE;
+
+	while (*p) {
+		char *end;
+		long first = strtol(p, &end, 10);
+		long last = first;
+		if (end == p) {
+			break;
+		}
+		if (*end == '-') {
+			p = end + 1;
+			last = strtol(p, &end, 10);
+		}
+		for (; first <= last && first < OPENAVB_PLACEMENT_MAX_CPUS; first++) {
+			if (first >= 0) {
+				OPENAVB_CPU_MASK_SET(pMask, first);
+				any = TRUE;
+			}
+		}
+		p = (*end == ',') ? end + 1 : end;
+		if (*end != ',') {
+			break;
+		}
+	}
+	return any;
+}
+
+static bool x_readLine(const char *path, char *buf, size_t len)
+{
+	FILE *pFile = fopen(path, "r");
+	if (!pFile) {
+		return FALSE;
+	}
+	bool ok = fgets(buf, len, pFile) != NULL;
+	fclose(pFile);
+	return ok;
+}
+
+// Interrupt of an RX queue, found by its name in /proc/interrupts: drivers name
+// them "<if>-TxRx-<n>", "<if>-rx-<n>", "<driver>-<if>-TxRx-<n>" and the like
+static int x_rxQueueIrq(const char *ifname, int queue)
+{
+	FILE *pFile = fopen("/proc/interrupts", "r");
+	if (!pFile) {
+		return -1;
+	}
+
+	char line[1024];
+	int irq = -1;
+	size_t ifLen = strlen(ifname);
+
+	while (irq < 0 && fgets(line, sizeof(line), pFile)) {
+		char *colon = strchr(line, ':');
+		if (!colon || !isdigit((unsigned char)line[strspn(line, " ")])) {
+			continue;
+		}
+
+		// The name is the last word on the line
+		char *end = line + strlen(line);
+		while (end > line && isspace((unsigned char)end[-1])) {
+			end--;
+		}
+		*end = '\0';
+		char *name = end;
+		while (name > colon && !isspace((unsigned char)name[-1])) {
+			name--;
+		}
+
+		char *pIf = strstr(name, ifname);
+		if (!pIf || pIf[ifLen] != '-') {
+			continue;
+		}
+		char *pNum = strrchr(pIf, '-') + 1;
+		char *pEnd;
+		long n = strtol(pNum, &pEnd, 10);
+		if (pEnd == pNum || *pEnd != '\0' || n != queue) {
+			continue;
+		}
+		// Skip TX only vectors
+		const char *kind = pIf + ifLen + 1;
+		if (strncasecmp(kind, "tx-", 3) == 0) {
+			continue;
+		}
+		irq = atoi(line);
+	}
+
+	fclose(pFile);
+	return irq;
+}
+
+int osalPlacementQueueCount(const char *ifname, bool tx)
+{
+	char path[128];
+	snprintf(path, sizeof(path), "/sys/class/net/%s/queues", ifname);
+
+	DIR *pDir = opendir(path);
+	if (!pDir) {
+		return 0;
+	}
+
+	int count = 0;
+	struct dirent *pEntry;
+	while ((pEntry = readdir(pDir)) != NULL) {
+		if (strncmp(pEntry->d_name, tx ? "tx-" : "rx-", 3) == 0) {
+			count++;
+		}
+	}
+	closedir(pDir);
+	return count;
+}
+
+openavb_placement_cpu_t osalPlacementQueueCpus(const char *ifname, bool tx, int queue, openavb_cpu_mask_t *pMask)
+{
+	char path[160];
+	char buf[512];
+
+	memset(pMask, 0, sizeof(*pMask));
+
+	if (tx) {
+		// Without CONFIG_XPS or a map the file is missing or all zeros
+		snprintf(path, sizeof(path), "/sys/class/net/%s/queues/tx-%d/xps_cpus", ifname, queue);
+		if (x_readLine(path, buf, sizeof(buf)) && x_parseCpuMask(buf, pMask)) {
+			return OPENAVB_PLACEMENT_CPU_XPS;
+		}
+		return OPENAVB_PLACEMENT_CPU_NONE;
+	}
+
+	// With RPS the frames are handed to the sockets on the RPS cores
+	snprintf(path, sizeof(path), "/sys/class/net/%s/queues/rx-%d/rps_cpus", ifname, queue);
+	if (x_readLine(path, buf, sizeof(buf)) && x_parseCpuMask(buf, pMask)) {
+		return OPENAVB_PLACEMENT_CPU_RPS;
+	}
+
+	int irq = x_rxQueueIrq(ifname, queue);
+	if (irq >= 0) {
+		snprintf(path, sizeof(path), "/proc/irq/%d/effective_affinity_list", irq);
+		if (!x_readLine(path, buf, sizeof(buf)) || !x_parseCpuList(buf, pMask)) {
+			snprintf(path, sizeof(path), "/proc/irq/%d/smp_affinity_list", irq);
+			if (!x_readLine(path, buf, sizeof(buf)) || !x_parseCpuList(buf, pMask)) {
+				return OPENAVB_PLACEMENT_CPU_NONE;
+			}
+		}
+		return OPENAVB_PLACEMENT_CPU_IRQ;
+	}
+	return OPENAVB_PLACEMENT_CPU_NONE;
+}
+
+bool osalPlacementAllowedCpus(openavb_cpu_mask_t *pMask)
+{
+	cpu_set_t *pSet = CPU_ALLOC(OPENAVB_PLACEMENT_MAX_CPUS);
+	size_t setSize = CPU_ALLOC_SIZE(OPENAVB_PLACEMENT_MAX_CPUS);
+	int cpu;
+
+	memset(pMask, 0, sizeof(*pMask));
+	if (!pSet) {
+		return FALSE;
+	}
+	CPU_ZERO_S(setSize, pSet);
+	if (sched_getaffinity(0, setSize, pSet) != 0) {
+		CPU_FREE(pSet);
+		return FALSE;
+	}
+	for (cpu = 0; cpu < OPENAVB_PLACEMENT_MAX_CPUS; cpu++) {
+		if (CPU_ISSET_S(cpu, setSize, pSet)) {
+			OPENAVB_CPU_MASK_SET(pMask, cpu);
+		}
+	}
+	CPU_FREE(pSet);
+	return TRUE;
+}
+
+static int x_ethtool(const char *ifname, void *data)
+{
+	struct ifreq ifr;
+	int sock = socket(AF_INET, SOCK_DGRAM, 0);
+	if (sock < 0) {
+		return -1;
+	}
+	memset(&ifr, 0, sizeof(ifr));
+	strncpy(ifr.ifr_name, ifname, IFNAMSIZ - 1);
+	ifr.ifr_data = data;
+	int ret = ioctl(sock, SIOCETHTOOL, &ifr);
+	int err = errno;
+	close(sock);
+	errno = err;
+	return ret;
+}
+
+int osalPlacementAddRxRule(const char *ifname, const U8 destAddr[ETH_ALEN], int queue)
+{
+	struct ethtool_rxnfc nfc;
+
+	memset(&nfc, 0, sizeof(nfc));
+	nfc.cmd = ETHTOOL_SRXCLSRLINS;
+	nfc.fs.flow_type = ETHER_FLOW;
+	memcpy(nfc.fs.h_u.ether_spec.h_dest, destAddr, ETH_ALEN);
+	memset(nfc.fs.m_u.ether_spec.h_dest, 0xFF, ETH_ALEN);
+	nfc.fs.ring_cookie = queue;
+	nfc.fs.location = RX_CLS_LOC_ANY;
+
+	if (x_ethtool(ifname, &nfc) < 0) {
+		AVB_LOGF_DEBUG("ntuple rule on %s to RX queue %d failed: %s", ifname, queue, strerror(errno));
+		return -1;
+	}
+	return nfc.fs.location;
+}
+
+void osalPlacementDelRxRule(const char *ifname, int location)
+{
+	struct ethtool_rxnfc nfc;
+
+	memset(&nfc, 0, sizeof(nfc));
+	nfc.cmd = ETHTOOL_SRXCLSRLDEL;
+	nfc.fs.location = location;
+	if (x_ethtool(ifname, &nfc) < 0) {
+		AVB_LOGF_WARNING("Removing ntuple rule %d from %s failed: %s", location, ifname, strerror(errno));
+	}
+}
+
+bool osalPlacementPinThread(int cpu)
+{
+	cpu_set_t *pSet = CPU_ALLOC(cpu + 1);
+	size_t setSize = CPU_ALLOC_SIZE(cpu + 1);
+
+	if (!pSet) {
+		return FALSE;
+	}
+	CPU_ZERO_S(setSize, pSet);
+	CPU_SET_S(cpu, setSize, pSet);
+	int err = pthread_setaffinity_np(pthread_self(), setSize, pSet);
+	CPU_FREE(pSet);
+	if (err) {
+		AVB_LOGF_WARNING("Pinning thread to core %d failed: %s", cpu, strerror(err));
+		return FALSE;
+	}
+	return TRUE;
+}
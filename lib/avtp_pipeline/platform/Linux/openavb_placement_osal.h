@@ -0,0 +1,62 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* HEADER SUMMARY : OS abstraction for the placement of streams on NIC queues and cores.
+*/
+
+#ifndef _OPENAVB_PLACEMENT_OSAL_H
+#define _OPENAVB_PLACEMENT_OSAL_H
+
+#include "openavb_types.h"
+#include "openavb_placement.h"
+
+// Number of TX or RX queues of an interface, 0 if unknown.
+int osalPlacementQueueCount(const char *ifname, bool tx);
+
+// Cores that service a queue. Returns OPENAVB_PLACEMENT_CPU_NONE and an empty
+// mask if unknown.
+openavb_placement_cpu_t osalPlacementQueueCpus(const char *ifname, bool tx, int queue, openavb_cpu_mask_t *pMask);
+
+// Cores the process may run on. Returns FALSE if unknown.
+bool osalPlacementAllowedCpus(openavb_cpu_mask_t *pMask);
+
+// Steer frames to destAddr to an RX queue. Returns the rule location, or -1 if
+// the interface can't do it.
+int osalPlacementAddRxRule(const char *ifname, const U8 destAddr[ETH_ALEN], int queue);
+
+// Remove a rule added by osalPlacementAddRxRule().
+void osalPlacementDelRxRule(const char *ifname, int location);
+
+// Pin the calling thread to a core.
+bool osalPlacementPinThread(int cpu);
+
+#endif // _OPENAVB_PLACEMENT_OSAL_H
@@ -0,0 +1,491 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+ 
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ 
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ 
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+Attributions: The inih library portion of the source code is licensed from 
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt. 
+Complete license and copyright information can be found at 
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* MODULE SUMMARY : Shared memory mailbox used for the local IPC channels.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <time.h>
+#include "openavb_platform.h"
+#include "openavb_shm_mbox_osal.h"
+
+#define	AVB_LOG_COMPONENT	"IPC"
+#include "openavb_log.h"
+
+#define SHM_MBOX_MAGIC		0x4d424f58	// "MBOX"
+#define SHM_MBOX_VERSION	2
+#define SHM_MBOX_CACHE_LINE	64
+
+#define SHM_MBOX_RING_C2S	0
+#define SHM_MBOX_RING_S2C	1
+
+// Index fields are free running; the slot is index % depth
+typedef struct {
+	U32 head;						// next slot the producer writes
+	U8 pad1[SHM_MBOX_CACHE_LINE - sizeof(U32)];
+	U32 tail;						// next slot the consumer reads; producer futex
+	U32 consumerWaiting;			// consumer is (about to be) blocked on its doorbell
+	U32 producerWaiting;			// producer is (about to be) blocked on tail
+	U8 pad2[SHM_MBOX_CACHE_LINE - 3 * sizeof(U32)];
+} shm_mbox_ring_t;
+
+typedef struct {
+	U32 magic;
+	U32 version;
+	U32 msgLen;
+	U32 depth;
+	U32 heartbeat;					// bumped by the server every service pass
+	U32 closed;						// set by whichever side closes first
+	U8 pad[SHM_MBOX_CACHE_LINE - 6 * sizeof(U32)];
+	shm_mbox_ring_t ring[2];
+	// Followed by the slots of ring[0], then those of ring[1]
+} shm_mbox_shared_t;
+
+// Sent once over the socket when the server accepts a connection
+typedef struct {
+	U32 magic;
+	U32 version;
+	U32 msgLen;
+	U32 depth;
+	U32 nFds;						// 0: no mailbox, stay on the socket
+} shm_mbox_offer_t;
+
+struct shm_mbox {
+	shm_mbox_shared_t *pShared;
+	size_t mapSize;
+	shm_mbox_ring_t *pTx;
+	shm_mbox_ring_t *pRx;
+	U8 *pTxSlots;
+	U8 *pRxSlots;
+	U32 msgLen;
+	U32 depth;
+	int txDoorbellFd;				// peer's doorbell
+	int rxDoorbellFd;				// our doorbell
+	bool bOwnRxDoorbell;			// FALSE for the server's shared doorbell
+	U32 lastHeartbeat;
+	U32 staleChecks;
+};
+
+static size_t mboxMapSize(U32 msgLen, U32 depth)
+{
+	size_t size = sizeof(shm_mbox_shared_t) + 2 * (size_t)msgLen * depth;
+	long pageSize = sysconf(_SC_PAGESIZE);
+	if (pageSize <= 0)
+		pageSize = 4096;
+	return (size + pageSize - 1) & ~((size_t)pageSize - 1);
+}
+
+static shm_mbox_t *mboxAttach(void *pMap, size_t mapSize, bool bServer)
+{
+	shm_mbox_t *pMbox = calloc(1, sizeof(shm_mbox_t));
+	if (!pMbox)
+		return NULL;
+
+	pMbox->pShared = (shm_mbox_shared_t *)pMap;
+	pMbox->mapSize = mapSize;
+	pMbox->msgLen = pMbox->pShared->msgLen;
+	pMbox->depth = pMbox->pShared->depth;
+
+	U8 *pSlots = (U8 *)(pMbox->pShared + 1);
+	U8 *pC2SSlots = pSlots;
+	U8 *pS2CSlots = pSlots + (size_t)pMbox->msgLen * pMbox->depth;
+	if (bServer) {
+		pMbox->pTx = &pMbox->pShared->ring[SHM_MBOX_RING_S2C];
+		pMbox->pRx = &pMbox->pShared->ring[SHM_MBOX_RING_C2S];
+		pMbox->pTxSlots = pS2CSlots;
+		pMbox->pRxSlots = pC2SSlots;
+	}
+	else {
+		pMbox->pTx = &pMbox->pShared->ring[SHM_MBOX_RING_C2S];
+		pMbox->pRx = &pMbox->pShared->ring[SHM_MBOX_RING_S2C];
+		pMbox->pTxSlots = pC2SSlots;
+		pMbox->pRxSlots = pS2CSlots;
+	}
+	pMbox->txDoorbellFd = -1;
+	pMbox->rxDoorbellFd = -1;
+	return pMbox;
+}
+
+static void ringDoorbell(int doorbellFd)
+{
+	U64 one = 1;
+	if (write(doorbellFd, &one, sizeof(one)) < 0 && errno != EAGAIN) {
+		AVB_LOGF_ERROR("Doorbell write failed: %s", strerror(errno));
+	}
+}
+
+// The rings are in a shared mapping, so these are not FUTEX_PRIVATE
+static void futexWait(U32 *pWord, U32 value, const struct timespec *pTimeout)
+{
+	syscall(SYS_futex, pWord, FUTEX_WAIT, value, pTimeout, NULL, 0);
+}
+
+static void futexWake(U32 *pWord)
+{
+	syscall(SYS_futex, pWord, FUTEX_WAKE, 1, NULL, NULL, 0);
+}
+
+static U64 monotonicMsec(void)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (U64)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+// Wait until the consumer frees a slot of a full ring. FALSE on timeout or
+// when the mailbox is closed.
+static bool waitForSlot(shm_mbox_t *pMbox, U32 head)
+{
+	shm_mbox_ring_t *pRing = pMbox->pTx;
+	U64 deadline = monotonicMsec() + SHM_MBOX_SEND_TIMEOUT_MSEC;
+	bool bFree = FALSE;
+
+	__atomic_store_n(&pRing->producerWaiting, 1, __ATOMIC_RELAXED);
+	while (!__atomic_load_n(&pMbox->pShared->closed, __ATOMIC_ACQUIRE)) {
+		// Pairs with the fence in osalShmMboxRecv(): either the consumer sees
+		// us waiting, or we see the tail it moved and don't block.
+		__atomic_thread_fence(__ATOMIC_SEQ_CST);
+		U32 tail = __atomic_load_n(&pRing->tail, __ATOMIC_ACQUIRE);
+		if (head - tail < pMbox->depth) {
+			bFree = TRUE;
+			break;
+		}
+
+		U64 now = monotonicMsec();
+		if (now >= deadline)
+			break;
+		struct timespec timeout;
+		timeout.tv_sec = (deadline - now) / 1000;
+		timeout.tv_nsec = ((deadline - now) % 1000) * 1000000;
+		futexWait(&pRing->tail, tail, &timeout);
+	}
+	__atomic_store_n(&pRing->producerWaiting, 0, __ATOMIC_RELAXED);
+	return bFree;
+}
+
+int osalShmMboxCreateDoorbell(void)
+{
+	int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (fd < 0) {
+		AVB_LOGF_ERROR("Failed to create doorbell: %s", strerror(errno));
+	}
+	return fd;
+}
+
+void osalShmMboxDrainDoorbell(int doorbellFd)
+{
+	U64 count;
+	if (read(doorbellFd, &count, sizeof(count)) < 0 && errno != EAGAIN) {
+		AVB_LOGF_ERROR("Doorbell read failed: %s", strerror(errno));
+	}
+}
+
+shm_mbox_t *osalShmMboxOffer(int sock, U32 msgLen, int serverDoorbellFd, bool *pOfferSent)
+{
+	shm_mbox_t *pMbox = NULL;
+	int memFd = -1, clientDoorbellFd = -1;
+	void *pMap = MAP_FAILED;
+	size_t mapSize = mboxMapSize(msgLen, SHM_MBOX_DEPTH);
+
+	*pOfferSent = FALSE;
+
+	if (serverDoorbellFd >= 0) {
+		memFd = syscall(SYS_memfd_create, "openavb_mbox", 1 /* MFD_CLOEXEC */);
+		if (memFd < 0 || ftruncate(memFd, mapSize) < 0) {
+			AVB_LOGF_WARNING("Unable to create IPC mailbox, using socket: %s", strerror(errno));
+		}
+		else {
+			pMap = mmap(NULL, mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, memFd, 0);
+			clientDoorbellFd = osalShmMboxCreateDoorbell();
+		}
+	}
+
+	if (pMap != MAP_FAILED && clientDoorbellFd >= 0) {
+		shm_mbox_shared_t *pShared = (shm_mbox_shared_t *)pMap;
+		pShared->magic = SHM_MBOX_MAGIC;
+		pShared->version = SHM_MBOX_VERSION;
+		pShared->msgLen = msgLen;
+		pShared->depth = SHM_MBOX_DEPTH;
+		pMbox = mboxAttach(pMap, mapSize, TRUE);
+	}
+
+	shm_mbox_offer_t offer;
+	memset(&offer, 0, sizeof(offer));
+	offer.magic = SHM_MBOX_MAGIC;
+	offer.version = SHM_MBOX_VERSION;
+	offer.msgLen = msgLen;
+	offer.depth = SHM_MBOX_DEPTH;
+	offer.nFds = pMbox ? 3 : 0;
+
+	struct iovec iov = { &offer, sizeof(offer) };
+	union {
+		char buf[CMSG_SPACE(3 * sizeof(int))];
+		struct cmsghdr align;
+	} ctrl;
+	struct msghdr msg;
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	if (pMbox) {
+		int passFds[3] = { memFd, serverDoorbellFd, clientDoorbellFd };
+		memset(&ctrl, 0, sizeof(ctrl));
+		msg.msg_control = ctrl.buf;
+		msg.msg_controllen = sizeof(ctrl.buf);
+		struct cmsghdr *pCmsg = CMSG_FIRSTHDR(&msg);
+		pCmsg->cmsg_level = SOL_SOCKET;
+		pCmsg->cmsg_type = SCM_RIGHTS;
+		pCmsg->cmsg_len = CMSG_LEN(sizeof(passFds));
+		memcpy(CMSG_DATA(pCmsg), passFds, sizeof(passFds));
+	}
+
+	if (sendmsg(sock, &msg, MSG_NOSIGNAL) == sizeof(offer)) {
+		*pOfferSent = TRUE;
+	}
+	else {
+		AVB_LOGF_ERROR("Failed to send IPC mailbox offer: %s", strerror(errno));
+	}
+
+	// The client holds its own references now; the server keeps the mapping
+	if (memFd >= 0)
+		close(memFd);
+	if (pMbox && *pOfferSent) {
+		pMbox->txDoorbellFd = clientDoorbellFd;
+		pMbox->rxDoorbellFd = serverDoorbellFd;
+		pMbox->bOwnRxDoorbell = FALSE;
+		return pMbox;
+	}
+
+	free(pMbox);
+	if (pMap != MAP_FAILED)
+		munmap(pMap, mapSize);
+	if (clientDoorbellFd >= 0)
+		close(clientDoorbellFd);
+	return NULL;
+}
+
+shm_mbox_t *osalShmMboxAccept(int sock, U32 msgLen, int timeoutMsec, bool *pOk)
+{
+	*pOk = FALSE;
+
+	struct pollfd pfd;
+	pfd.fd = sock;
+	pfd.events = POLLIN;
+	pfd.revents = 0;
+	if (poll(&pfd, 1, timeoutMsec) <= 0) {
+		AVB_LOG_ERROR("No IPC mailbox offer from server");
+		return NULL;
+	}
+
+	shm_mbox_offer_t offer;
+	int passFds[3] = { -1, -1, -1 };
+	struct iovec iov = { &offer, sizeof(offer) };
+	union {
+		char buf[CMSG_SPACE(3 * sizeof(int))];
+		struct cmsghdr align;
+	} ctrl;
+	struct msghdr msg;
+	memset(&msg, 0, sizeof(msg));
+	memset(&ctrl, 0, sizeof(ctrl));
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = ctrl.buf;
+	msg.msg_controllen = sizeof(ctrl.buf);
+
+	ssize_t nRead = recvmsg(sock, &msg, MSG_CMSG_CLOEXEC);
+	struct cmsghdr *pCmsg = CMSG_FIRSTHDR(&msg);
+	if (pCmsg && pCmsg->cmsg_level == SOL_SOCKET && pCmsg->cmsg_type == SCM_RIGHTS &&
+		pCmsg->cmsg_len == CMSG_LEN(sizeof(passFds))) {
+		memcpy(passFds, CMSG_DATA(pCmsg), sizeof(passFds));
+	}
+
+	if (nRead != sizeof(offer) || offer.magic != SHM_MBOX_MAGIC) {
+		AVB_LOG_ERROR("Invalid IPC mailbox offer from server");
+		goto error;
+	}
+	if (offer.nFds == 0) {
+		// Server stays on the socket
+		*pOk = TRUE;
+		return NULL;
+	}
+	if (offer.version != SHM_MBOX_VERSION || offer.msgLen != msgLen || passFds[2] < 0) {
+		AVB_LOGF_ERROR("IPC mailbox mismatch: version %u, message length %u (expected %u, %u)",
+			offer.version, offer.msgLen, SHM_MBOX_VERSION, msgLen);
+		goto error;
+	}
+
+	size_t mapSize = mboxMapSize(offer.msgLen, offer.depth);
+	void *pMap = mmap(NULL, mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, passFds[0], 0);
+	if (pMap == MAP_FAILED) {
+		AVB_LOGF_ERROR("Failed to map IPC mailbox: %s", strerror(errno));
+		goto error;
+	}
+	close(passFds[0]);
+
+	shm_mbox_t *pMbox = mboxAttach(pMap, mapSize, FALSE);
+	if (!pMbox) {
+		munmap(pMap, mapSize);
+		passFds[0] = -1;
+		goto error;
+	}
+	pMbox->txDoorbellFd = passFds[1];
+	pMbox->rxDoorbellFd = passFds[2];
+	pMbox->bOwnRxDoorbell = TRUE;
+	pMbox->lastHeartbeat = __atomic_load_n(&pMbox->pShared->heartbeat, __ATOMIC_RELAXED);
+
+	*pOk = TRUE;
+	return pMbox;
+
+  error:
+	if (passFds[0] >= 0)
+		close(passFds[0]);
+	if (passFds[1] >= 0)
+		close(passFds[1]);
+	if (passFds[2] >= 0)
+		close(passFds[2]);
+	return NULL;
+}
+
+void osalShmMboxClose(shm_mbox_t *pMbox)
+{
+	if (!pMbox)
+		return;
+
+	__atomic_store_n(&pMbox->pShared->closed, 1, __ATOMIC_RELEASE);
+	// Wake the peer if it is blocked so it notices
+	futexWake(&pMbox->pRx->tail);
+	if (pMbox->txDoorbellFd >= 0) {
+		ringDoorbell(pMbox->txDoorbellFd);
+		close(pMbox->txDoorbellFd);
+	}
+	if (pMbox->bOwnRxDoorbell && pMbox->rxDoorbellFd >= 0)
+		close(pMbox->rxDoorbellFd);
+	munmap(pMbox->pShared, pMbox->mapSize);
+	free(pMbox);
+}
+
+bool osalShmMboxSend(shm_mbox_t *pMbox, const void *pMsg)
+{
+	shm_mbox_ring_t *pRing = pMbox->pTx;
+
+	if (__atomic_load_n(&pMbox->pShared->closed, __ATOMIC_ACQUIRE))
+		return FALSE;
+
+	U32 head = pRing->head;		// only we write it
+	if (head - __atomic_load_n(&pRing->tail, __ATOMIC_ACQUIRE) >= pMbox->depth
+		&& !waitForSlot(pMbox, head)) {
+		AVB_LOG_ERROR("IPC mailbox full");
+		return FALSE;
+	}
+
+	memcpy(pMbox->pTxSlots + (size_t)(head % pMbox->depth) * pMbox->msgLen, pMsg, pMbox->msgLen);
+	__atomic_store_n(&pRing->head, head + 1, __ATOMIC_RELEASE);
+
+	// Pairs with the fence in osalShmMboxPrepareWait(): either the consumer
+	// sees the new head before it blocks, or we see it waiting here.
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&pRing->consumerWaiting, __ATOMIC_RELAXED)) {
+		ringDoorbell(pMbox->txDoorbellFd);
+	}
+	return TRUE;
+}
+
+bool osalShmMboxRecv(shm_mbox_t *pMbox, void *pMsg)
+{
+	shm_mbox_ring_t *pRing = pMbox->pRx;
+
+	U32 tail = pRing->tail;		// only we write it
+	if (__atomic_load_n(&pRing->head, __ATOMIC_ACQUIRE) == tail)
+		return FALSE;
+
+	memcpy(pMsg, pMbox->pRxSlots + (size_t)(tail % pMbox->depth) * pMbox->msgLen, pMbox->msgLen);
+	__atomic_store_n(&pRing->tail, tail + 1, __ATOMIC_RELEASE);
+
+	// Pairs with the fence in waitForSlot()
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&pRing->producerWaiting, __ATOMIC_RELAXED)) {
+		futexWake(&pRing->tail);
+	}
+	return TRUE;
+}
+
+bool osalShmMboxPrepareWait(shm_mbox_t *pMbox)
+{
+	shm_mbox_ring_t *pRing = pMbox->pRx;
+
+	__atomic_store_n(&pRing->consumerWaiting, 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	return __atomic_load_n(&pRing->head, __ATOMIC_ACQUIRE) == pRing->tail &&
+		!__atomic_load_n(&pMbox->pShared->closed, __ATOMIC_ACQUIRE);
+}
+
+void osalShmMboxFinishWait(shm_mbox_t *pMbox)
+{
+	__atomic_store_n(&pMbox->pRx->consumerWaiting, 0, __ATOMIC_RELAXED);
+}
+
+int osalShmMboxDoorbellFd(shm_mbox_t *pMbox)
+{
+	return pMbox->rxDoorbellFd;
+}
+
+void osalShmMboxHeartbeat(shm_mbox_t *pMbox)
+{
+	__atomic_store_n(&pMbox->pShared->heartbeat, pMbox->pShared->heartbeat + 1, __ATOMIC_RELAXED);
+}
+
+bool osalShmMboxPeerSuspect(shm_mbox_t *pMbox, U32 nChecks)
+{
+	if (__atomic_load_n(&pMbox->pShared->closed, __ATOMIC_ACQUIRE))
+		return TRUE;
+
+	U32 heartbeat = __atomic_load_n(&pMbox->pShared->heartbeat, __ATOMIC_RELAXED);
+	if (heartbeat != pMbox->lastHeartbeat) {
+		pMbox->lastHeartbeat = heartbeat;
+		pMbox->staleChecks = 0;
+		return FALSE;
+	}
+	if (++pMbox->staleChecks >= nChecks) {
+		pMbox->staleChecks = 0;
+		return TRUE;
+	}
+	return FALSE;
+}
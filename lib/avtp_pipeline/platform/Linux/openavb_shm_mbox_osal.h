@@ -0,0 +1,108 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+ 
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ 
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ 
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+Attributions: The inih library portion of the source code is licensed from 
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt. 
+Complete license and copyright information can be found at 
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* HEADER SUMMARY : Shared memory mailbox used for the local IPC channels.
+*
+* A mailbox is a pair of single-producer/single-consumer rings of fixed-size
+* messages in a memfd shared between a server and one client, plus eventfd
+* doorbells. The server creates it when it accepts a connection and passes
+* the descriptors to the client over the connection's AF_UNIX socket; after
+* that, messages only go through the rings and the socket is kept to detect
+* a peer going away.
+*
+* Sending and receiving are plain memory operations. A doorbell is only rung
+* when the receiving side has announced that it is about to block, so a
+* client that polls its mailbox (e.g. from a streaming thread) makes no
+* system calls at all. All clients of a server share one server doorbell, so
+* a server with hundreds of clients waits on a single extra descriptor. A
+* sender that finds the mailbox full waits on a futex on the ring's tail until
+* the receiver takes a message.
+*/
+
+#ifndef _OPENAVB_SHM_MBOX_OSAL_H
+#define _OPENAVB_SHM_MBOX_OSAL_H
+
+#include "openavb_types.h"
+
+// Messages each direction can hold before the sender has to wait
+#define SHM_MBOX_DEPTH		64
+
+// How long a sender waits for the peer to free a slot of a full mailbox
+#define SHM_MBOX_SEND_TIMEOUT_MSEC	100
+
+typedef struct shm_mbox shm_mbox_t;
+
+// Create the server's doorbell, shared by all of its mailboxes. Returns -1 on failure.
+int osalShmMboxCreateDoorbell(void);
+
+// Consume pending rings of a doorbell so the next poll() blocks again.
+void osalShmMboxDrainDoorbell(int doorbellFd);
+
+// Server side: create a mailbox for a newly accepted connection and offer it to
+// the client over sock. If the mailbox cannot be created the client is told to
+// stay on the socket and NULL is returned; check *pOfferSent for whether the
+// connection is still usable at all.
+shm_mbox_t *osalShmMboxOffer(int sock, U32 msgLen, int serverDoorbellFd, bool *pOfferSent);
+
+// Client side: wait up to timeoutMsec for the server's offer on sock.
+// Returns NULL with *pOk TRUE if the server chose to stay on the socket.
+shm_mbox_t *osalShmMboxAccept(int sock, U32 msgLen, int timeoutMsec, bool *pOk);
+
+// Release a mailbox. The peer sees it as closed.
+void osalShmMboxClose(shm_mbox_t *pMbox);
+
+// Queue a message for the peer. If the mailbox is full, waits up to
+// SHM_MBOX_SEND_TIMEOUT_MSEC for the peer to take a message. FALSE if it is
+// still full then, or if the mailbox is closed.
+bool osalShmMboxSend(shm_mbox_t *pMbox, const void *pMsg);
+
+// Take the next message from the peer. FALSE if there is none.
+bool osalShmMboxRecv(shm_mbox_t *pMbox, void *pMsg);
+
+// Announce that this side is about to wait on its doorbell. Returns FALSE if a
+// message is already waiting, in which case the caller must not block.
+// Always pair with osalShmMboxFinishWait().
+bool osalShmMboxPrepareWait(shm_mbox_t *pMbox);
+void osalShmMboxFinishWait(shm_mbox_t *pMbox);
+
+// Descriptor to poll() for this side's doorbell.
+int osalShmMboxDoorbellFd(shm_mbox_t *pMbox);
+
+// Server side: show the client the server is still servicing its mailbox.
+void osalShmMboxHeartbeat(shm_mbox_t *pMbox);
+
+// Client side: TRUE if the server closed the mailbox, or has not shown a
+// heartbeat for nChecks consecutive calls; the caller should then confirm
+// with the socket.
+bool osalShmMboxPeerSuspect(shm_mbox_t *pMbox, U32 nChecks);
+
+#endif // _OPENAVB_SHM_MBOX_OSAL_H
@@ -0,0 +1,505 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* MODULE SUMMARY : Virtual time scheduler for simulations of the AVTP pipeline.
+*
+* A baton is passed between the simulated threads; a thread only runs while
+* it holds it, and the one handing it on posts the semaphore of the next. Waiting threads are picked by wake time, then
+* by the order they started waiting in, which keeps runs repeatable. The
+* installed time source maps the virtual time to the clocks of each node.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include "openavb_platform.h"
+#include "openavb_sim_osal.h"
+#include "openavb_trace.h"
+
+#define	AVB_LOG_COMPONENT	"osalSim"
+#include "openavb_pub.h"
+#include "openavb_log.h"
+
+// Clock values at the start of a simulation; arbitrary but fixed so runs repeat
+#define SIM_MONOTONIC_EPOCH_NSEC	(1000ULL * NANOSECONDS_PER_SECOND)
+#define SIM_REALTIME_EPOCH_NSEC		(1577836800ULL * NANOSECONDS_PER_SECOND)
+#define SIM_WALLTIME_EPOCH_NSEC		(1577836837ULL * NANOSECONDS_PER_SECOND)
+
+// Polling interval of the controlling thread while the threads stop
+#define SIM_STOP_POLL_NSEC			(1 * NANOSECONDS_PER_MSEC)
+
+// A thread that reads a clock this many times without waiting is spinning,
+// and virtual time moves on by SIM_SPIN_NSEC as real time would
+#define SIM_SPIN_READS				8
+#define SIM_SPIN_NSEC				200
+
+typedef enum {
+	SIM_THREAD_WAITING,
+	SIM_THREAD_RUNNING,
+	SIM_THREAD_DONE,
+} sim_thread_state_t;
+
+struct osal_sim_thread {
+	struct osal_sim_thread *pNext;
+	char name[16];
+	osal_sim_clock_t clock;
+	void *(*pFn)(void *);
+	void *pArg;
+	pthread_t thread;
+	sem_t baton;
+	sim_thread_state_t state;
+	U64 wakeNsec;
+	U64 waitSeq;
+	U32 spinReads;
+	bool bStarted;
+};
+
+static pthread_mutex_t x_simMutex = PTHREAD_MUTEX_INITIALIZER;
+static osal_sim_thread_t x_controller;
+static osal_sim_thread_t *x_pThreads = NULL;	// controller first, then in order of creation
+static osal_sim_thread_t *x_pRunning = NULL;
+static __thread osal_sim_thread_t *x_pSelf = NULL;
+static U64 x_nowNsec = 0;
+static U64 x_waitSeq = 0;
+static U64 x_seed = 0;
+static U64 x_jitterRand = 0;
+static U32 x_wakeJitterNsec = 0;
+static U64 x_switches = 0;
+static bool x_bStopping = FALSE;
+
+static const osal_sim_clock_t x_idealClock = { 0.0, 0, 0 };
+
+// Local oscillator time since the start of the simulation
+static U64 x_localNsec(const osal_sim_clock_t *pClock, U64 simNsec)
+{
+	return simNsec + (S64)((double)simNsec * pClock->driftPpm / 1000000.0);
+}
+
+// gPTP error of a node; a triangle wave when a servo steers the drift out
+static S64 x_wallErrorNsec(const osal_sim_clock_t *pClock, U64 simNsec)
+{
+	U64 driftNsec = simNsec;
+	if (pClock->syncIntervalNsec) {
+		U64 phase = simNsec % pClock->syncIntervalNsec;
+		driftNsec = (phase < pClock->syncIntervalNsec / 2) ? phase : pClock->syncIntervalNsec - phase;
+	}
+	return pClock->wallOffsetNsec + (S64)((double)driftNsec * pClock->driftPpm / 1000000.0);
+}
+
+static void x_realSleepNsec(U64 nsec)
+{
+	struct timespec ts;
+	ts.tv_sec = nsec / NANOSECONDS_PER_SECOND;
+	ts.tv_nsec = nsec % NANOSECONDS_PER_SECOND;
+	while (nanosleep(&ts, &ts) == -1 && errno == EINTR);
+}
+
+// Pick the waiting thread that is due first to run next. Called with the
+// mutex held by the running thread, after it set its own state. The caller
+// posts the baton of the thread returned once it released the mutex.
+static osal_sim_thread_t *x_handOff(osal_sim_thread_t *pSelf)
+{
+	osal_sim_thread_t *pNext = NULL, *pThread;
+
+	for (pThread = x_pThreads; pThread; pThread = pThread->pNext) {
+		if (pThread->state == SIM_THREAD_WAITING
+			&& (!pNext || pThread->wakeNsec < pNext->wakeNsec
+				|| (pThread->wakeNsec == pNext->wakeNsec && pThread->waitSeq < pNext->waitSeq))) {
+			pNext = pThread;
+		}
+	}
+	if (!pNext) {
+		// Only if the controlling thread returned from osalSimRun() early
+		x_pRunning = NULL;
+		return NULL;
+	}
+
+	if (pNext->wakeNsec > x_nowNsec) {
+		__atomic_store_n(&x_nowNsec, pNext->wakeNsec, __ATOMIC_RELAXED);
+	}
+	pNext->state = SIM_THREAD_RUNNING;
+	x_pRunning = pNext;
+	if (pNext == pSelf) {
+		return NULL;
+	}
+	x_switches++;
+	return pNext;
+}
+
+// Give the baton to pNext (if any), then block pSelf (if any) until it gets it back
+static void x_switchTo(osal_sim_thread_t *pSelf, osal_sim_thread_t *pNext)
+{
+	if (pNext) {
+		sem_post(&pNext->baton);
+	}
+	if (pSelf) {
+		while (sem_wait(&pSelf->baton) == -1 && errno == EINTR);
+	}
+}
+
+static void *x_threadMain(void *pv)
+{
+	osal_sim_thread_t *pSelf = (osal_sim_thread_t *)pv;
+	x_pSelf = pSelf;
+
+	while (sem_wait(&pSelf->baton) == -1 && errno == EINTR);
+
+	pSelf->pFn(pSelf->pArg);
+
+	pthread_mutex_lock(&x_simMutex);
+	pSelf->state = SIM_THREAD_DONE;
+	osal_sim_thread_t *pNext = x_handOff(pSelf);
+	pthread_mutex_unlock(&x_simMutex);
+
+	x_switchTo(NULL, pNext);
+	return NULL;
+}
+
+static bool x_getTime(void *pCtx, openavb_clockId_t openavbClockId, U64 *timeNsec)
+{
+	osal_sim_thread_t *pSelf = x_pSelf;
+
+	if (pSelf && ++pSelf->spinReads >= SIM_SPIN_READS) {
+		// Without this a loop that polls until a time comes would never end.
+		// Time moves on without passing the baton, so a thread spinning with
+		// a lock held can't block the others.
+		pSelf->spinReads = 0;
+		__atomic_add_fetch(&x_nowNsec, SIM_SPIN_NSEC, __ATOMIC_RELAXED);
+	}
+
+	return osalSimClockAt(pSelf, openavbClockId, osalSimNow(), timeNsec);
+}
+
+static void x_sleepUntil(void *pCtx, openavb_clockId_t openavbClockId, U64 timeNsec)
+{
+	osal_sim_thread_t *pSelf = x_pSelf;
+	const osal_sim_clock_t *pClock = pSelf ? &pSelf->clock : &x_idealClock;
+	// No clock of a node runs faster than this against virtual time
+	double maxRate = 1.0 + fabs(pClock->driftPpm) / 1000000.0;
+	U64 clockNsec;
+
+	while (osalSimClockAt(pSelf, openavbClockId, osalSimNow(), &clockNsec) && clockNsec < timeNsec) {
+		if (!pSelf) {
+			// Threads outside the simulation (logging) sleep in real time
+			x_realSleepNsec(timeNsec - clockNsec);
+			return;
+		}
+
+		// First virtual time the clock reaches timeNsec
+		U64 wakeNsec = osalSimNow();
+		do {
+			U64 stepNsec = (U64)((double)(timeNsec - clockNsec) / maxRate);
+			wakeNsec += stepNsec ? stepNsec : 1;
+			osalSimClockAt(pSelf, openavbClockId, wakeNsec, &clockNsec);
+		} while (clockNsec < timeNsec);
+
+		osalSimWaitUntil(wakeNsec);
+	}
+}
+
+static const openavb_time_source_t x_timeSource = { x_getTime, x_sleepUntil, NULL };
+
+bool osalSimInitialize(U64 seed, U32 wakeJitterNsec)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TIME);
+
+	if (x_pThreads) {
+		AVB_LOG_ERROR("Simulation already running");
+		AVB_TRACE_EXIT(AVB_TRACE_TIME);
+		return FALSE;
+	}
+
+	memset(&x_controller, 0, sizeof(x_controller));
+	strncpy(x_controller.name, "controller", sizeof(x_controller.name) - 1);
+	x_controller.state = SIM_THREAD_RUNNING;
+	x_controller.bStarted = TRUE;
+	sem_init(&x_controller.baton, 0, 0);
+
+	x_pThreads = &x_controller;
+	x_pRunning = &x_controller;
+	x_pSelf = &x_controller;
+	x_nowNsec = 0;
+	x_waitSeq = 0;
+	x_switches = 0;
+	x_bStopping = FALSE;
+	x_seed = seed;
+	x_jitterRand = osalSimSeed("wake jitter");
+	x_wakeJitterNsec = wakeJitterNsec;
+
+	osalSetTimeSource(&x_timeSource);
+
+	AVB_TRACE_EXIT(AVB_TRACE_TIME);
+	return TRUE;
+}
+
+void osalSimFinalize(void)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TIME);
+
+	osalSetTimeSource(NULL);
+
+	pthread_mutex_lock(&x_simMutex);
+	osal_sim_thread_t *pThread = x_pThreads ? x_pThreads->pNext : NULL;
+	while (pThread) {
+		osal_sim_thread_t *pNext = pThread->pNext;
+		if (pThread->state == SIM_THREAD_DONE || !pThread->bStarted) {
+			sem_destroy(&pThread->baton);
+			free(pThread);
+		}
+		// else still blocked in the simulation; it is left behind
+		pThread = pNext;
+	}
+	if (x_pThreads) {
+		sem_destroy(&x_controller.baton);
+	}
+	x_pThreads = NULL;
+	x_pRunning = NULL;
+	x_pSelf = NULL;
+	pthread_mutex_unlock(&x_simMutex);
+
+	AVB_TRACE_EXIT(AVB_TRACE_TIME);
+}
+
+osal_sim_thread_t *osalSimThreadCreate(const char *name, const osal_sim_clock_t *pClock, void *(*pFn)(void *), void *pArg)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TIME);
+
+	if (x_pSelf != &x_controller) {
+		AVB_LOG_ERROR("Simulated threads are created by the controlling thread");
+		AVB_TRACE_EXIT(AVB_TRACE_TIME);
+		return NULL;
+	}
+
+	osal_sim_thread_t *pThread = calloc(1, sizeof(osal_sim_thread_t));
+	if (!pThread) {
+		AVB_LOG_ERROR("Creating simulated thread; out of memory");
+		AVB_TRACE_EXIT(AVB_TRACE_TIME);
+		return NULL;
+	}
+	strncpy(pThread->name, name ? name : "sim", sizeof(pThread->name) - 1);
+	pThread->clock = pClock ? *pClock : x_idealClock;
+	pThread->pFn = pFn;
+	pThread->pArg = pArg;
+	sem_init(&pThread->baton, 0, 0);
+
+	pthread_mutex_lock(&x_simMutex);
+	pThread->state = SIM_THREAD_WAITING;
+	pThread->wakeNsec = x_nowNsec;
+	pThread->waitSeq = ++x_waitSeq;
+
+	osal_sim_thread_t **ppLast = &x_pThreads;
+	while (*ppLast) {
+		ppLast = &(*ppLast)->pNext;
+	}
+	*ppLast = pThread;
+
+	int err = pthread_create(&pThread->thread, NULL, x_threadMain, pThread);
+	if (err) {
+		*ppLast = NULL;
+		pthread_mutex_unlock(&x_simMutex);
+		AVB_LOGF_ERROR("Creating simulated thread %s: %s", pThread->name, strerror(err));
+		sem_destroy(&pThread->baton);
+		free(pThread);
+		AVB_TRACE_EXIT(AVB_TRACE_TIME);
+		return NULL;
+	}
+	pThread->bStarted = TRUE;
+	pthread_setname_np(pThread->thread, pThread->name);
+	pthread_mutex_unlock(&x_simMutex);
+
+	AVB_TRACE_EXIT(AVB_TRACE_TIME);
+	return pThread;
+}
+
+bool osalSimRun(U64 durationNsec, U64 drainNsec)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TIME);
+
+	if (x_pSelf != &x_controller) {
+		AVB_LOG_ERROR("Simulation run from a thread other than the controlling one");
+		AVB_TRACE_EXIT(AVB_TRACE_TIME);
+		return FALSE;
+	}
+
+	U64 endNsec = osalSimNow() + durationNsec;
+	osalSimWaitUntil(endNsec);
+
+	x_bStopping = TRUE;
+	endNsec += drainNsec;
+
+	bool bAllDone;
+	for (;;) {
+		osal_sim_thread_t *pThread;
+		bAllDone = TRUE;
+		pthread_mutex_lock(&x_simMutex);
+		for (pThread = x_controller.pNext; pThread; pThread = pThread->pNext) {
+			if (pThread->state != SIM_THREAD_DONE) {
+				bAllDone = FALSE;
+			}
+		}
+		pthread_mutex_unlock(&x_simMutex);
+
+		if (bAllDone || osalSimNow() >= endNsec) {
+			break;
+		}
+		osalSimWaitUntil(osalSimNow() + SIM_STOP_POLL_NSEC);
+	}
+
+	if (!bAllDone) {
+		AVB_LOG_ERROR("Simulated threads did not stop");
+		AVB_TRACE_EXIT(AVB_TRACE_TIME);
+		return FALSE;
+	}
+
+	osal_sim_thread_t *pThread;
+	for (pThread = x_controller.pNext; pThread; pThread = pThread->pNext) {
+		pthread_join(pThread->thread, NULL);
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_TIME);
+	return TRUE;
+}
+
+bool osalSimStopping(void)
+{
+	return x_bStopping;
+}
+
+U64 osalSimNow(void)
+{
+	return __atomic_load_n(&x_nowNsec, __ATOMIC_RELAXED);
+}
+
+osal_sim_thread_t *osalSimSelf(void)
+{
+	return x_pSelf;
+}
+
+void osalSimWaitUntil(U64 simNsec)
+{
+	osal_sim_thread_t *pSelf = x_pSelf;
+
+	if (!pSelf) {
+		U64 nowNsec = osalSimNow();
+		if (simNsec > nowNsec) {
+			x_realSleepNsec(simNsec - nowNsec);
+		}
+		return;
+	}
+
+	pthread_mutex_lock(&x_simMutex);
+	if (x_wakeJitterNsec && pSelf != &x_controller) {
+		simNsec += osalSimRand(&x_jitterRand) % ((U64)x_wakeJitterNsec + 1);
+	}
+	pSelf->spinReads = 0;
+	pSelf->wakeNsec = (simNsec > x_nowNsec) ? simNsec : x_nowNsec;
+	pSelf->waitSeq = ++x_waitSeq;
+	pSelf->state = SIM_THREAD_WAITING;
+	osal_sim_thread_t *pNext = x_handOff(pSelf);
+	bool bWait = (x_pRunning != pSelf);
+	pthread_mutex_unlock(&x_simMutex);
+
+	if (bWait) {
+		x_switchTo(pSelf, pNext);
+	}
+}
+
+void osalSimWake(osal_sim_thread_t *pThread, U64 simNsec)
+{
+	if (!pThread) {
+		return;
+	}
+
+	pthread_mutex_lock(&x_simMutex);
+	if (pThread->state == SIM_THREAD_WAITING) {
+		if (x_wakeJitterNsec && pThread != &x_controller) {
+			simNsec += osalSimRand(&x_jitterRand) % ((U64)x_wakeJitterNsec + 1);
+		}
+		if (simNsec < x_nowNsec) {
+			simNsec = x_nowNsec;
+		}
+		if (simNsec < pThread->wakeNsec) {
+			pThread->wakeNsec = simNsec;
+		}
+	}
+	pthread_mutex_unlock(&x_simMutex);
+}
+
+bool osalSimClockAt(osal_sim_thread_t *pThread, openavb_clockId_t openavbClockId, U64 simNsec, U64 *pTimeNsec)
+{
+	const osal_sim_clock_t *pClock = pThread ? &pThread->clock : &x_idealClock;
+
+	switch (openavbClockId) {
+		case OPENAVB_CLOCK_REALTIME:
+			*pTimeNsec = SIM_REALTIME_EPOCH_NSEC + x_localNsec(pClock, simNsec);
+			return TRUE;
+		case OPENAVB_CLOCK_MONOTONIC:
+		case OPENAVB_TIMER_CLOCK:
+			*pTimeNsec = SIM_MONOTONIC_EPOCH_NSEC + x_localNsec(pClock, simNsec);
+			return TRUE;
+		case OPENAVB_CLOCK_WALLTIME:
+			*pTimeNsec = SIM_WALLTIME_EPOCH_NSEC + simNsec + x_wallErrorNsec(pClock, simNsec);
+			return TRUE;
+	}
+	return FALSE;
+}
+
+U64 osalSimSeed(const char *name)
+{
+	// FNV-1a of the name, mixed with the simulation seed
+	U64 hash = 14695981039346656037ULL;
+	while (name && *name) {
+		hash = (hash ^ (U8)*name++) * 1099511628211ULL;
+	}
+	hash ^= x_seed * 0x9E3779B97F4A7C15ULL;
+	return hash ? hash : 1;
+}
+
+U64 osalSimRand(U64 *pState)
+{
+	// xorshift64*
+	U64 x = *pState;
+	x ^= x >> 12;
+	x ^= x << 25;
+	x ^= x >> 27;
+	*pState = x;
+	return x * 0x2545F4914F6CDD1DULL;
+}
+
+U64 osalSimSwitches(void)
+{
+	return x_switches;
+}
@@ -0,0 +1,114 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* HEADER SUMMARY : Virtual time for simulations of the AVTP pipeline.
+*
+* Simulated threads are real threads, but only one of them runs at a time.
+* When the running thread waits, the thread with the earliest wake time runs
+* next and the virtual clock jumps to that time. A run therefore takes as long
+* as the processing it does, not as long as the time it simulates, and the
+* same inputs and seed always give the same interleaving.
+*/
+
+#ifndef _OPENAVB_SIM_OSAL_H
+#define _OPENAVB_SIM_OSAL_H
+
+#include "openavb_types.h"
+#include "openavb_time_osal_pub.h"
+
+// Clock of a simulated node. It is read through the time source installed by
+// osalSimInitialize(), so CLOCK_GETTIME and the sleep macros of a simulated
+// thread see the clock of its node.
+typedef struct {
+	// Frequency error of the node's oscillator in ppm. The monotonic, timer
+	// and realtime clocks run this much fast (or slow, if negative).
+	double driftPpm;
+	// Error of the gPTP (walltime) clock in nsec, before drift
+	S64 wallOffsetNsec;
+	// With a syncIntervalNsec the gPTP servo steers out the drift, so the
+	// walltime error swings between wallOffsetNsec and
+	// wallOffsetNsec + driftPpm * syncIntervalNsec / 2. With 0 the walltime
+	// drifts away like the local clocks.
+	U64 syncIntervalNsec;
+} osal_sim_clock_t;
+
+typedef struct osal_sim_thread osal_sim_thread_t;
+
+// Start a simulation and install its time source. The calling thread controls
+// the run and is the only simulated thread until others are created. Every
+// wait of a simulated thread is extended by a random delay of up to
+// wakeJitterNsec, drawn from seed, to model scheduling latency.
+bool osalSimInitialize(U64 seed, U32 wakeJitterNsec);
+
+// Restore the OS clocks and free the simulation.
+void osalSimFinalize(void);
+
+// Create a simulated thread with the clock of its node (NULL for an ideal
+// clock). It first runs when the controlling thread waits.
+osal_sim_thread_t *osalSimThreadCreate(const char *name, const osal_sim_clock_t *pClock, void *(*pFn)(void *), void *pArg);
+
+// From the controlling thread: run the simulation for durationNsec of virtual
+// time, then set osalSimStopping() and wait up to drainNsec for every thread
+// to return. Returns FALSE if some did not.
+bool osalSimRun(U64 durationNsec, U64 drainNsec);
+
+// TRUE once the simulation run is over; simulated threads should return.
+bool osalSimStopping(void);
+
+// Virtual time in nsec since the start of the simulation.
+U64 osalSimNow(void);
+
+// Calling simulated thread, NULL for other threads.
+osal_sim_thread_t *osalSimSelf(void);
+
+// Block the calling simulated thread until virtual time simNsec, or until
+// another thread wakes it earlier with osalSimWake().
+void osalSimWaitUntil(U64 simNsec);
+
+// Bring the wake time of a waiting thread forward to simNsec.
+void osalSimWake(osal_sim_thread_t *pThread, U64 simNsec);
+
+// Time of a clock of a thread's node at virtual time simNsec. A NULL thread
+// reads the ideal clock.
+bool osalSimClockAt(osal_sim_thread_t *pThread, openavb_clockId_t openavbClockId, U64 simNsec, U64 *pTimeNsec);
+
+// Seed for a random number stream of a named simulation object, derived from
+// the simulation seed so runs repeat.
+U64 osalSimSeed(const char *name);
+
+// Next number of a random number stream. The state must not be 0.
+U64 osalSimRand(U64 *pState);
+
+// Number of times a thread handed the CPU to another one.
+U64 osalSimSwitches(void);
+
+#endif // _OPENAVB_SIM_OSAL_H
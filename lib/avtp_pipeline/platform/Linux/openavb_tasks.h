@@ -103,6 +103,9 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 //task openavbAcmpSmControllerThread
 #define openavbAcmpSmControllerThread_THREAD_STK_SIZE  			THREAD_STACK_SIZE
 
+//task openavbAvdeccEngineThread
+#define openavbAvdeccEngineThread_THREAD_STK_SIZE  			THREAD_STACK_SIZE
+
 
 
 
@@ -49,6 +49,7 @@ static pthread_mutex_t gOSALTimeInitMutex = PTHREAD_MUTEX_INITIALIZER;
 #define UNLOCK()	pthread_mutex_unlock(&gOSALTimeInitMutex)
 
 static bool bInitialized = FALSE;
+const openavb_time_source_t *osalTimeSource = NULL;
 static int gPtpShmFd = -1;
 static char *gPtpMmap = NULL;
 gPtpTimeData gPtpTD;
@@ -104,6 +105,41 @@ static bool x_getPTPTime(U64 *timeNsec) {
 	return FALSE;
 }
 
+bool osalClockWalltimeToTai(U64 walltimeNsec, U64 *taiNsec) {
+	AVB_TRACE_ENTRY(AVB_TRACE_TIME);
+
+	// Only gPTP wall time has a known relation to the system clock
+	if (osalTimeSource || !bInitialized || !gPtpTD.local_time
+		|| gPtpTD.ml_freqoffset <= 0 || gPtpTD.ls_freqoffset <= 0) {
+		AVB_TRACE_EXIT(AVB_TRACE_TIME);
+		return FALSE;
+	}
+
+	// gPTP to the PHC of the interface, then the PHC to CLOCK_REALTIME
+	uint64_t local;
+	if (!gptpmaster2local(&gPtpTD, walltimeNsec, &local)) {
+		AVB_TRACE_EXIT(AVB_TRACE_TIME);
+		return FALSE;
+	}
+	int64_t delta_system = (int64_t)(local - gPtpTD.local_time) / gPtpTD.ls_freqoffset;
+	U64 realtimeNsec = gPtpTD.local_time + gPtpTD.ls_phoffset + delta_system;
+
+	// CLOCK_TAI is CLOCK_REALTIME plus the whole second UTC offset the kernel knows
+	struct timespec tai, real;
+	if (clock_gettime(CLOCK_TAI, &tai) || clock_gettime(CLOCK_REALTIME, &real)) {
+		AVB_TRACE_EXIT(AVB_TRACE_TIME);
+		return FALSE;
+	}
+	S64 offsetSec = tai.tv_sec - real.tv_sec;
+	if (tai.tv_nsec < real.tv_nsec) {
+		offsetSec--;
+	}
+	*taiNsec = realtimeNsec + offsetSec * (S64)NANOSECONDS_PER_SECOND;
+
+	AVB_TRACE_EXIT(AVB_TRACE_TIME);
+	return TRUE;
+}
+
 bool osalAVBTimeInit(void) {
 	AVB_TRACE_ENTRY(AVB_TRACE_TIME);
 
@@ -127,10 +163,30 @@ bool osalAVBTimeClose(void) {
 	return TRUE;
 }
 
+void osalSetTimeSource(const openavb_time_source_t *pTimeSource) {
+	AVB_TRACE_ENTRY(AVB_TRACE_TIME);
+
+	osalTimeSource = pTimeSource;
+	AVB_LOGF_INFO("Time source: %s", pTimeSource ? "external" : "OS clocks");
+
+	AVB_TRACE_EXIT(AVB_TRACE_TIME);
+}
+
 bool osalClockGettime(openavb_clockId_t openavbClockId, struct timespec *getTime) {
 	AVB_TRACE_ENTRY(AVB_TRACE_TIME);
 
-	if (openavbClockId < OPENAVB_CLOCK_WALLTIME)
+	if (osalTimeSource) {
+		U64 timeNsec;
+		if (!osalTimeSource->getTime(osalTimeSource->pCtx, openavbClockId, &timeNsec)) {
+			AVB_TRACE_EXIT(AVB_TRACE_TIME);
+			return FALSE;
+		}
+		getTime->tv_sec = timeNsec / NANOSECONDS_PER_SECOND;
+		getTime->tv_nsec = timeNsec % NANOSECONDS_PER_SECOND;
+		AVB_TRACE_EXIT(AVB_TRACE_TIME);
+		return TRUE;
+	}
+	else if (openavbClockId < OPENAVB_CLOCK_WALLTIME)
 	{
 		clockid_t clockId = CLOCK_MONOTONIC;
 		switch (openavbClockId) {
@@ -164,7 +220,10 @@ bool osalClockGettime(openavb_clockId_t openavbClockId, struct timespec *getTime
 }
 
 bool osalClockGettime64(openavb_clockId_t openavbClockId, U64 *timeNsec) {
-	if (openavbClockId < OPENAVB_CLOCK_WALLTIME)
+	if (osalTimeSource) {
+		return osalTimeSource->getTime(osalTimeSource->pCtx, openavbClockId, timeNsec);
+	}
+	else if (openavbClockId < OPENAVB_CLOCK_WALLTIME)
 	{
 		clockid_t clockId = CLOCK_MONOTONIC;
 		switch (openavbClockId) {
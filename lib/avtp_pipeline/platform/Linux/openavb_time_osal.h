@@ -34,4 +34,8 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 
 #include "openavb_time_osal_pub.h"
 
+// Convert gPTP wall time to CLOCK_TAI, for SO_TXTIME launch times. Returns FALSE
+// when there is no gPTP time data to relate the two clocks.
+bool osalClockWalltimeToTai(U64 walltimeNsec, U64 *taiNsec);
+
 #endif // _OPENAVB_TIME_OSAL_H
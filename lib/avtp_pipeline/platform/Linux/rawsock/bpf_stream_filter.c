@@ -0,0 +1,292 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+#include "bpf_stream_filter.h"
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <linux/bpf.h>
+
+#include "openavb_trace.h"
+
+#define	AVB_LOG_COMPONENT	"Raw Socket"
+#include "openavb_log.h"
+
+#ifndef BPF_ATOMIC
+#define BPF_ATOMIC	0xc0	// BPF_XADD in older headers
+#endif
+
+// eBPF instruction encoding, as in the kernel's samples/bpf/bpf_insn.h
+#define INSN(CODE, DST, SRC, OFF, IMM) \
+	((struct bpf_insn) { .code = (CODE), .dst_reg = (DST), .src_reg = (SRC), .off = (OFF), .imm = (IMM) })
+#define MOV64_REG(DST, SRC)			INSN(BPF_ALU64 | BPF_MOV | BPF_X, DST, SRC, 0, 0)
+#define MOV64_IMM(DST, IMM)			INSN(BPF_ALU64 | BPF_MOV | BPF_K, DST, 0, 0, IMM)
+#define MOV32_IMM(DST, IMM)			INSN(BPF_ALU | BPF_MOV | BPF_K, DST, 0, 0, IMM)
+#define ALU64_IMM(OP, DST, IMM)		INSN(BPF_ALU64 | (OP) | BPF_K, DST, 0, 0, IMM)
+#define LD_ABS(SIZE, IMM)			INSN(BPF_LD | (SIZE) | BPF_ABS, 0, 0, 0, IMM)
+#define LD_IND(SIZE, SRC, IMM)		INSN(BPF_LD | (SIZE) | BPF_IND, 0, SRC, 0, IMM)
+#define LD_MAP_FD(DST, FD)			INSN(BPF_LD | BPF_DW | BPF_IMM, DST, BPF_PSEUDO_MAP_FD, 0, FD), INSN(0, 0, 0, 0, 0)
+#define ST_DW(DST, OFF, IMM)		INSN(BPF_ST | BPF_DW | BPF_MEM, DST, 0, OFF, IMM)
+#define ATOMIC_ADD_DW(DST, SRC, OFF)	INSN(BPF_STX | BPF_DW | BPF_ATOMIC, DST, SRC, OFF, BPF_ADD)
+#define JMP_IMM(OP, DST, IMM, OFF)	INSN(BPF_JMP | (OP) | BPF_K, DST, 0, OFF, IMM)
+#define JA(OFF)						INSN(BPF_JMP | BPF_JA, 0, 0, OFF, 0)
+#define CALL(FN)					INSN(BPF_JMP | BPF_CALL, 0, 0, 0, FN)
+#define EXIT()						INSN(BPF_JMP | BPF_EXIT, 0, 0, 0, 0)
+
+#define ETHERTYPE_AVTP_FILTER	0x22F0
+#define ETHERTYPE_VLAN_FILTER	0x8100
+
+static int bpfSys(int cmd, union bpf_attr *attr)
+{
+	return syscall(__NR_bpf, cmd, attr, sizeof(*attr));
+}
+
+static int bpfMapCreate(U32 type, U32 maxEntries)
+{
+	union bpf_attr attr;
+	memset(&attr, 0, sizeof(attr));
+	attr.map_type = type;
+	attr.key_size = 8;
+	attr.value_size = sizeof(U64);
+	attr.max_entries = maxEntries;
+	return bpfSys(BPF_MAP_CREATE, &attr);
+}
+
+static int bpfProgLoad(int acceptMapFd, int dropMapFd)
+{
+	// The stream_id goes in the 8 bytes at fp-8, zero if the frame has none.
+	// Offsets are for packet sockets, where the frame starts at the MAC header.
+	struct bpf_insn prog[] = {
+		/*  0 */ MOV64_REG(BPF_REG_6, BPF_REG_1),
+		/*  1 */ ST_DW(BPF_REG_10, -8, 0),
+		/*  2 */ MOV64_IMM(BPF_REG_7, ETH_HLEN),
+		/*  3 */ LD_ABS(BPF_H, 12),
+		/*  4 */ JMP_IMM(BPF_JEQ, BPF_REG_0, ETHERTYPE_AVTP_FILTER, 4),		// to 9
+		/*  5 */ JMP_IMM(BPF_JNE, BPF_REG_0, ETHERTYPE_VLAN_FILTER, 24),	// to drop
+		/*  6 */ LD_ABS(BPF_H, 16),
+		/*  7 */ JMP_IMM(BPF_JNE, BPF_REG_0, ETHERTYPE_AVTP_FILTER, 22),	// to drop
+		/*  8 */ MOV64_IMM(BPF_REG_7, ETH_HLEN + 4),
+		// AVTP header at r7: no stream_id unless the sv bit is set
+		/*  9 */ LD_IND(BPF_B, BPF_REG_7, 1),
+		/* 10 */ ALU64_IMM(BPF_AND, BPF_REG_0, 0x80),
+		/* 11 */ JMP_IMM(BPF_JEQ, BPF_REG_0, 0, 18),						// to drop
+		/* 12 */ MOV64_REG(BPF_REG_1, BPF_REG_6),
+		/* 13 */ MOV64_REG(BPF_REG_2, BPF_REG_7),
+		/* 14 */ ALU64_IMM(BPF_ADD, BPF_REG_2, 4),
+		/* 15 */ MOV64_REG(BPF_REG_3, BPF_REG_10),
+		/* 16 */ ALU64_IMM(BPF_ADD, BPF_REG_3, -8),
+		/* 17 */ MOV64_IMM(BPF_REG_4, 8),
+		/* 18 */ CALL(BPF_FUNC_skb_load_bytes),
+		/* 19 */ JMP_IMM(BPF_JNE, BPF_REG_0, 0, 10),						// to drop
+		// Subscribed: count and pass the whole frame
+		/* 20 */ LD_MAP_FD(BPF_REG_1, acceptMapFd),
+		/* 22 */ MOV64_REG(BPF_REG_2, BPF_REG_10),
+		/* 23 */ ALU64_IMM(BPF_ADD, BPF_REG_2, -8),
+		/* 24 */ CALL(BPF_FUNC_map_lookup_elem),
+		/* 25 */ JMP_IMM(BPF_JEQ, BPF_REG_0, 0, 4),						// to drop
+		/* 26 */ MOV64_IMM(BPF_REG_1, 1),
+		/* 27 */ ATOMIC_ADD_DW(BPF_REG_0, BPF_REG_1, 0),
+		/* 28 */ MOV32_IMM(BPF_REG_0, -1),
+		/* 29 */ EXIT(),
+		// drop: count against the stream_id, adding it if new
+		/* 30 */ LD_MAP_FD(BPF_REG_1, dropMapFd),
+		/* 32 */ MOV64_REG(BPF_REG_2, BPF_REG_10),
+		/* 33 */ ALU64_IMM(BPF_ADD, BPF_REG_2, -8),
+		/* 34 */ CALL(BPF_FUNC_map_lookup_elem),
+		/* 35 */ JMP_IMM(BPF_JEQ, BPF_REG_0, 0, 3),						// to 39
+		/* 36 */ MOV64_IMM(BPF_REG_1, 1),
+		/* 37 */ ATOMIC_ADD_DW(BPF_REG_0, BPF_REG_1, 0),
+		/* 38 */ JA(9),													// to 48
+		/* 39 */ ST_DW(BPF_REG_10, -16, 1),
+		/* 40 */ LD_MAP_FD(BPF_REG_1, dropMapFd),
+		/* 42 */ MOV64_REG(BPF_REG_2, BPF_REG_10),
+		/* 43 */ ALU64_IMM(BPF_ADD, BPF_REG_2, -8),
+		/* 44 */ MOV64_REG(BPF_REG_3, BPF_REG_10),
+		/* 45 */ ALU64_IMM(BPF_ADD, BPF_REG_3, -16),
+		/* 46 */ MOV64_IMM(BPF_REG_4, BPF_NOEXIST),
+		/* 47 */ CALL(BPF_FUNC_map_update_elem),
+		/* 48 */ MOV64_IMM(BPF_REG_0, 0),
+		/* 49 */ EXIT(),
+	};
+	static char log[4096];
+	union bpf_attr attr;
+
+	memset(&attr, 0, sizeof(attr));
+	attr.prog_type = BPF_PROG_TYPE_SOCKET_FILTER;
+	attr.insns = (U64)(unsigned long)prog;
+	attr.insn_cnt = sizeof(prog) / sizeof(prog[0]);
+	attr.license = (U64)(unsigned long)"Dual BSD/GPL";
+	attr.log_buf = (U64)(unsigned long)log;
+	attr.log_size = sizeof(log);
+	attr.log_level = 1;
+	log[0] = '\0';
+
+	int fd = bpfSys(BPF_PROG_LOAD, &attr);
+	if (fd < 0 && log[0]) {
+		AVB_LOGF_DEBUG("Stream filter verifier log: %s", log);
+	}
+	return fd;
+}
+
+bpf_stream_filter_t *bpfStreamFilterOpen(void)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_RAWSOCK);
+
+	bpf_stream_filter_t *filter = calloc(1, sizeof(bpf_stream_filter_t));
+	if (!filter) {
+		AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+		return NULL;
+	}
+	filter->progFd = filter->acceptMapFd = filter->dropMapFd = filter->sock = -1;
+
+	filter->acceptMapFd = bpfMapCreate(BPF_MAP_TYPE_HASH, BPF_STREAM_FILTER_MAX_STREAMS);
+	filter->dropMapFd = bpfMapCreate(BPF_MAP_TYPE_LRU_HASH, BPF_STREAM_FILTER_MAX_DROP_STREAMS);
+	if (filter->dropMapFd < 0 && errno == EINVAL) {
+		// No LRU maps before Linux 4.10; new streams stop being counted once full
+		filter->dropMapFd = bpfMapCreate(BPF_MAP_TYPE_HASH, BPF_STREAM_FILTER_MAX_DROP_STREAMS);
+	}
+	if (filter->acceptMapFd < 0 || filter->dropMapFd < 0) {
+		AVB_LOGF_WARNING("Stream filter; creating BPF maps failed: %s", strerror(errno));
+		bpfStreamFilterClose(filter);
+		AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+		return NULL;
+	}
+
+	filter->progFd = bpfProgLoad(filter->acceptMapFd, filter->dropMapFd);
+	if (filter->progFd < 0) {
+		AVB_LOGF_WARNING("Stream filter; loading BPF program failed: %s", strerror(errno));
+		bpfStreamFilterClose(filter);
+		AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+		return NULL;
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+	return filter;
+}
+
+void bpfStreamFilterClose(bpf_stream_filter_t *filter)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_RAWSOCK);
+
+	if (filter) {
+		if (filter->progFd >= 0)
+			close(filter->progFd);
+		if (filter->acceptMapFd >= 0)
+			close(filter->acceptMapFd);
+		if (filter->dropMapFd >= 0)
+			close(filter->dropMapFd);
+		free(filter);
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+}
+
+bool bpfStreamFilterAttach(bpf_stream_filter_t *filter, int sock)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_RAWSOCK);
+
+	if (setsockopt(sock, SOL_SOCKET, SO_ATTACH_BPF, &filter->progFd, sizeof(filter->progFd)) < 0) {
+		AVB_LOGF_WARNING("Stream filter; setsockopt(SO_ATTACH_BPF) failed: %s", strerror(errno));
+		AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+		return FALSE;
+	}
+	filter->sock = sock;
+
+	AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+	return TRUE;
+}
+
+bool bpfStreamFilterSetStream(bpf_stream_filter_t *filter, bool add, const U8 streamID[8])
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_RAWSOCK);
+
+	union bpf_attr attr;
+	U64 zero = 0;
+	int ret;
+
+	memset(&attr, 0, sizeof(attr));
+	attr.map_fd = filter->acceptMapFd;
+	attr.key = (U64)(unsigned long)streamID;
+	if (add) {
+		attr.value = (U64)(unsigned long)&zero;
+		attr.flags = BPF_NOEXIST;
+		ret = bpfSys(BPF_MAP_UPDATE_ELEM, &attr);
+		if (ret < 0 && errno == EEXIST)
+			ret = 0;
+	}
+	else {
+		ret = bpfSys(BPF_MAP_DELETE_ELEM, &attr);
+		if (ret < 0 && errno == ENOENT)
+			ret = 0;
+	}
+	if (ret < 0) {
+		AVB_LOGF_ERROR("Stream filter; %s stream failed: %s", add ? "adding" : "removing", strerror(errno));
+		AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+		return FALSE;
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+	return TRUE;
+}
+
+int bpfStreamFilterCounts(bpf_stream_filter_t *filter, bool dropped, rawsock_stream_count_t *counts, int max)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_RAWSOCK);
+
+	int fd = dropped ? filter->dropMapFd : filter->acceptMapFd;
+	union bpf_attr attr;
+	U8 key[8], nextKey[8];
+	bool first = TRUE;
+	int n = 0;
+
+	while (n < max) {
+		memset(&attr, 0, sizeof(attr));
+		attr.map_fd = fd;
+		attr.key = first ? 0 : (U64)(unsigned long)key;
+		attr.next_key = (U64)(unsigned long)nextKey;
+		if (bpfSys(BPF_MAP_GET_NEXT_KEY, &attr) < 0)
+			break;
+		memcpy(key, nextKey, sizeof(key));
+		first = FALSE;
+
+		memset(&attr, 0, sizeof(attr));
+		attr.map_fd = fd;
+		attr.key = (U64)(unsigned long)key;
+		attr.value = (U64)(unsigned long)&counts[n].frames;
+		if (bpfSys(BPF_MAP_LOOKUP_ELEM, &attr) < 0)
+			continue;	// deleted (or evicted) since
+		memcpy(counts[n].streamID, key, sizeof(key));
+		n++;
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+	return n;
+}
@@ -0,0 +1,81 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+#ifndef BPF_STREAM_FILTER_H
+#define BPF_STREAM_FILTER_H
+
+#include "openavb_rawsock.h"
+
+// Kernel side AVTP stream filter for packet sockets.
+//
+// An eBPF socket filter looks up the stream_id of each AVTP frame in a hash
+// map of subscribed streams. Frames of subscribed streams are passed to the
+// socket and counted per stream; all other frames are dropped before they
+// are queued to the socket and counted per stream_id in an LRU map (frames
+// without a valid stream_id are counted under stream_id 0). The filter
+// replaces the multicast address filter on the socket: the stream_id is
+// enough to tell the frames of a stream apart.
+
+// Maximum number of streams a filter can subscribe to
+#define BPF_STREAM_FILTER_MAX_STREAMS		256
+// Maximum number of other streams with their own drop counter
+#define BPF_STREAM_FILTER_MAX_DROP_STREAMS	1024
+
+typedef struct {
+	// loaded program
+	int progFd;
+	// subscribed stream_id -> frames passed
+	int acceptMapFd;
+	// other stream_id -> frames dropped
+	int dropMapFd;
+	// socket the program is attached to, -1 if none
+	int sock;
+} bpf_stream_filter_t;
+
+// Create the maps and load the program. Returns NULL if the kernel doesn't
+// support it or the process may not load BPF programs.
+bpf_stream_filter_t *bpfStreamFilterOpen(void);
+
+// Release the program and maps. A socket the filter is attached to keeps
+// filtering until it is closed.
+void bpfStreamFilterClose(bpf_stream_filter_t *filter);
+
+// Attach the filter to a packet socket, replacing any filter on it
+bool bpfStreamFilterAttach(bpf_stream_filter_t *filter, int sock);
+
+// Subscribe to (or unsubscribe from) a stream; streamID in network order
+bool bpfStreamFilterSetStream(bpf_stream_filter_t *filter, bool add, const U8 streamID[8]);
+
+// Read the per stream counters: frames passed for the subscribed streams, or
+// frames dropped for the others. Returns the number of entries, at most max.
+int bpfStreamFilterCounts(bpf_stream_filter_t *filter, bool dropped, rawsock_stream_count_t *counts, int max);
+
+#endif // BPF_STREAM_FILTER_H
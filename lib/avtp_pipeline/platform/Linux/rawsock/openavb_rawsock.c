@@ -32,8 +32,10 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #include "sendmmsg_rawsock.h"
 #include "simple_rawsock.h"
 #include "ring_rawsock.h"
+#include "sim_rawsock.h"
 #if AVB_FEATURE_PCAP
 #include "pcap_rawsock.h"
+#include "pcapfile_rawsock.h"
 #if AVB_FEATURE_IGB
 #include "igb_rawsock.h"
 #endif
@@ -43,6 +45,7 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #endif
 
 #include "openavb_rawsock.h"
+#include "openavb_arena.h"
 
 #include "openavb_trace.h"
 
@@ -67,6 +70,22 @@ bool openavbCheckInterface(const char *ifname_uri, if_info_t *info)
 
 	AVB_LOGF_DEBUG("%s ifname_uri %s ifname %s proto %s", __func__, ifname_uri, ifname, proto);
 
+#if AVB_FEATURE_PCAP
+	// Capture file replay has no real interface behind it
+	if (strcmp(proto, PCAPFILE_RAWSOCK_PROTO) == 0) {
+		bool ret = pcapfileRawsockCheckInterface(ifname, info);
+		AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+		return ret;
+	}
+#endif
+
+	// Links of a simulation have none either
+	if (strcmp(proto, SIM_RAWSOCK_PROTO) == 0) {
+		bool ret = simRawsockCheckInterface(ifname, info);
+		AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+		return ret;
+	}
+
 	bool ret = simpleAvbCheckInterface(ifname, info);
 
 	AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
@@ -120,8 +139,8 @@ void *openavbRawsockOpen(const char *ifname_uri, bool rx_mode, bool tx_mode, U16
 
 		AVB_LOG_INFO("Using *simple* implementation");
 
-		// allocate memory for rawsock object
-		simple_rawsock_t *rawsock = calloc(1, sizeof(simple_rawsock_t) + 4 /* Just in case */);
+		// allocate memory for rawsock object; it holds the TX staging buffer
+		simple_rawsock_t *rawsock = openavbArenaAlloc(sizeof(simple_rawsock_t) + 4 /* Just in case */, openavbArenaNodeForStream(ifname, 0xFFFFFFFF));
 		if (!rawsock) {
 			AVB_LOG_ERROR("Creating rawsock; malloc failed");
 			return NULL;
@@ -133,8 +152,8 @@ void *openavbRawsockOpen(const char *ifname_uri, bool rx_mode, bool tx_mode, U16
 
 		AVB_LOG_INFO("Using *sendmmsg* implementation");
 
-		// allocate memory for rawsock object
-		sendmmsg_rawsock_t *rawsock = calloc(1, sizeof(sendmmsg_rawsock_t));
+		// allocate memory for rawsock object; it holds the TX staging buffers
+		sendmmsg_rawsock_t *rawsock = openavbArenaAlloc(sizeof(sendmmsg_rawsock_t), openavbArenaNodeForStream(ifname, 0xFFFFFFFF));
 		if (!rawsock) {
 			AVB_LOG_ERROR("Creating rawsock; malloc failed");
 			return NULL;
@@ -142,6 +161,19 @@ void *openavbRawsockOpen(const char *ifname_uri, bool rx_mode, bool tx_mode, U16
 
 		// call constructor
 		pvRawsock = sendmmsgRawsockOpen(rawsock, ifname, rx_mode, tx_mode, ethertype, frame_size, num_frames);
+	} else if (strcmp(proto, SIM_RAWSOCK_PROTO) == 0) {
+
+		AVB_LOG_INFO("Using *sim* link implementation");
+
+		// allocate memory for rawsock object
+		sim_rawsock_t *rawsock = calloc(1, sizeof(sim_rawsock_t));
+		if (!rawsock) {
+			AVB_LOG_ERROR("Creating rawsock; malloc failed");
+			return NULL;
+		}
+
+		// call constructor
+		pvRawsock = simRawsockOpen(rawsock, ifname, rx_mode, tx_mode, ethertype, frame_size, num_frames);
 #if AVB_FEATURE_PCAP
 	} else if (strcmp(proto, "pcap") == 0) {
 
@@ -156,6 +188,19 @@ void *openavbRawsockOpen(const char *ifname_uri, bool rx_mode, bool tx_mode, U16
 
 		// call constructor
 		pvRawsock = pcapRawsockOpen(rawsock, ifname, rx_mode, tx_mode, ethertype, frame_size, num_frames);
+	} else if (strcmp(proto, PCAPFILE_RAWSOCK_PROTO) == 0) {
+
+		AVB_LOG_INFO("Using *pcapfile* replay implementation");
+
+		// allocate memory for rawsock object
+		pcapfile_rawsock_t *rawsock = calloc(1, sizeof(pcapfile_rawsock_t));
+		if (!rawsock) {
+			AVB_LOG_ERROR("Creating rawsock; malloc failed");
+			return NULL;
+		}
+
+		// call constructor
+		pvRawsock = pcapfileRawsockOpen(rawsock, ifname, rx_mode, tx_mode, ethertype, frame_size, num_frames);
 #if AVB_FEATURE_IGB
 	} else if (strcmp(proto, "igb") == 0) {
 
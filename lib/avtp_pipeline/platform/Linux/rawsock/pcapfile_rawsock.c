@@ -0,0 +1,519 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+ * Rawsock implementation which replays a capture file on receive and records
+ * transmitted frames into a capture file. No network device or privileges are
+ * needed, which makes it usable for offline profiling and regression tests of
+ * the listener and AVDECC receive paths at rates a real NIC may not deliver.
+*/
+
+#include <time.h>
+#include <pthread.h>
+#include <netinet/ether.h>
+#include "pcapfile_rawsock.h"
+#include "openavb_trace.h"
+
+#define	AVB_LOG_COMPONENT	"Raw Socket"
+#include "openavb_log.h"
+
+#define PCAPFILE_DEFAULT_MAC		"02:00:00:00:00:01"
+#define PCAPFILE_DEFAULT_MTU		1500
+#define PCAPFILE_IDLE_USEC			(100 * 1000)	// wait used for a blocking read after the replay ended
+#define PCAPFILE_TX_SNAPLEN			65535
+#define PCAPFILE_ETHERTYPE_AVTP		0x22F0
+
+// All TX sockets of the process share a single output file so that
+// frames from talkers and AVDECC end up interleaved in send order.
+static pthread_mutex_t gTxMutex = PTHREAD_MUTEX_INITIALIZER;
+static pcap_t *gTxDead = NULL;
+static pcap_dumper_t *gTxDumper = NULL;
+static int gTxRefCount = 0;
+
+static U64 x_monoNsec(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((U64)ts.tv_sec * NANOSECONDS_PER_SECOND) + (U64)ts.tv_nsec;
+}
+
+static void x_sleepUntilNsec(U64 monoNsec)
+{
+	struct timespec ts;
+	ts.tv_sec = monoNsec / NANOSECONDS_PER_SECOND;
+	ts.tv_nsec = monoNsec % NANOSECONDS_PER_SECOND;
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR);
+}
+
+static U64 x_pktNsec(const struct pcap_pkthdr *hdr)
+{
+	// Files are opened with nanosecond precision so tv_usec holds nanoseconds
+	return ((U64)hdr->ts.tv_sec * NANOSECONDS_PER_SECOND) + (U64)hdr->ts.tv_usec;
+}
+
+static double x_speedFromEnv(void)
+{
+	const char *value = getenv("OPENAVB_PCAPFILE_SPEED");
+	if (!value || !*value || strcasecmp(value, "original") == 0) {
+		return 1.0;
+	}
+	if (strcasecmp(value, "max") == 0) {
+		return 0.0;
+	}
+
+	char *pEnd;
+	double speed = strtod(value, &pEnd);
+	if (*pEnd != '\0' || speed < 0.0) {
+		AVB_LOGF_WARNING("Invalid OPENAVB_PCAPFILE_SPEED %s, using original speed", value);
+		return 1.0;
+	}
+	return speed;
+}
+
+static bool x_openRxFile(pcapfile_rawsock_t *rawsock)
+{
+	char errbuf[PCAP_ERRBUF_SIZE];
+
+	rawsock->rxHandle = pcap_open_offline_with_tstamp_precision(rawsock->rxPath, PCAP_TSTAMP_PRECISION_NANO, errbuf);
+	if (!rawsock->rxHandle) {
+		AVB_LOGF_ERROR("Cannot open capture %s: %s", rawsock->rxPath, errbuf);
+		return FALSE;
+	}
+	if (pcap_datalink(rawsock->rxHandle) != DLT_EN10MB) {
+		AVB_LOGF_ERROR("Capture %s is not an Ethernet capture", rawsock->rxPath);
+		pcap_close(rawsock->rxHandle);
+		rawsock->rxHandle = NULL;
+		return FALSE;
+	}
+	rawsock->firstPktNsec = 0;
+	rawsock->rxPacket = NULL;
+	return TRUE;
+}
+
+static bool x_openTxFile(void)
+{
+	bool ret = TRUE;
+	const char *path = getenv("OPENAVB_PCAPFILE_TX");
+
+	pthread_mutex_lock(&gTxMutex);
+	if (gTxRefCount++ == 0 && path && *path) {
+		gTxDead = pcap_open_dead_with_tstamp_precision(DLT_EN10MB, PCAPFILE_TX_SNAPLEN, PCAP_TSTAMP_PRECISION_NANO);
+		if (gTxDead) {
+			gTxDumper = pcap_dump_open(gTxDead, path);
+		}
+		if (!gTxDumper) {
+			AVB_LOGF_ERROR("Cannot create TX capture %s: %s", path, gTxDead ? pcap_geterr(gTxDead) : "no memory");
+			if (gTxDead) {
+				pcap_close(gTxDead);
+				gTxDead = NULL;
+			}
+			gTxRefCount--;
+			ret = FALSE;
+		}
+		else {
+			AVB_LOGF_INFO("Recording TX frames to %s", path);
+		}
+	}
+	pthread_mutex_unlock(&gTxMutex);
+	return ret;
+}
+
+static void x_closeTxFile(void)
+{
+	pthread_mutex_lock(&gTxMutex);
+	if (gTxRefCount > 0 && --gTxRefCount == 0 && gTxDumper) {
+		pcap_dump_close(gTxDumper);
+		pcap_close(gTxDead);
+		gTxDumper = NULL;
+		gTxDead = NULL;
+	}
+	pthread_mutex_unlock(&gTxMutex);
+}
+
+// Decide if a frame from the capture would have reached this socket
+static bool x_rxAccept(pcapfile_rawsock_t *rawsock, const U8 *pkt, U32 len)
+{
+	if (len < sizeof(eth_hdr_t)) {
+		return FALSE;
+	}
+
+	const eth_hdr_t *eth = (const eth_hdr_t *)pkt;
+	U16 ethertype = ntohs(eth->ethertype);
+	U32 hdrLen = sizeof(eth_hdr_t);
+	if (ethertype == ETHERTYPE_8021Q && rawsock->base.ethertype != ETHERTYPE_8021Q) {
+		if (len < sizeof(eth_vlan_hdr_t)) {
+			return FALSE;
+		}
+		ethertype = ntohs(((const eth_vlan_hdr_t *)pkt)->ethertype);
+		hdrLen = sizeof(eth_vlan_hdr_t);
+	}
+	if (ethertype != rawsock->base.ethertype) {
+		return FALSE;
+	}
+
+	if (rawsock->avtpSubtypeSet && ethertype == PCAPFILE_ETHERTYPE_AVTP
+		&& (len <= hdrLen || (pkt[hdrLen] & 0x7F) != rawsock->avtpSubtype)) {
+		return FALSE;
+	}
+
+	// Multicast destinations only pass once a membership was requested.
+	// With no memberships at all everything is passed, like a promiscuous capture.
+	if ((eth->dhost[0] & 0x01) && rawsock->mcastCount > 0) {
+		int i;
+		for (i = 0; i < rawsock->mcastCount; i++) {
+			if (memcmp(eth->dhost, rawsock->mcastAddr[i], ETH_ALEN) == 0) {
+				return TRUE;
+			}
+		}
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+// Read the next accepted frame from the capture into rxPacket. Returns FALSE
+// once all passes through the file have been replayed.
+static bool x_readNext(pcapfile_rawsock_t *rawsock)
+{
+	while (rawsock->rxHandle) {
+		int ret = pcap_next_ex(rawsock->rxHandle, &rawsock->rxHeader, &rawsock->rxPacket);
+		if (ret == 1) {
+			U64 pktNsec = x_pktNsec(rawsock->rxHeader);
+			if (rawsock->firstPktNsec == 0) {
+				rawsock->firstPktNsec = pktNsec;
+			}
+			rawsock->lastPktNsec = pktNsec;
+			if (!x_rxAccept(rawsock, rawsock->rxPacket, rawsock->rxHeader->caplen)) {
+				rawsock->rxFiltered++;
+				continue;
+			}
+			return TRUE;
+		}
+
+		if (ret == -1) {
+			AVB_LOGF_ERROR("pcap_next_ex failed: %s", pcap_geterr(rawsock->rxHandle));
+		}
+
+		// End of file; start another pass if requested
+		rawsock->loopsDone++;
+		pcap_close(rawsock->rxHandle);
+		rawsock->rxHandle = NULL;
+		rawsock->rxPacket = NULL;
+		if (ret == -2 && (rawsock->loopCount == 0 || rawsock->loopsDone < rawsock->loopCount)) {
+			// Keep the pacing continuous across passes
+			rawsock->passOffsetNsec += rawsock->lastPktNsec - rawsock->firstPktNsec;
+			if (!x_openRxFile(rawsock)) {
+				break;
+			}
+		}
+		else {
+			AVB_LOGF_INFO("Capture replay finished: %" PRIu64 " frames delivered, %" PRIu64 " filtered",
+				rawsock->rxFrames, rawsock->rxFiltered);
+		}
+	}
+
+	rawsock->rxPacket = NULL;
+	return FALSE;
+}
+
+// Get information about the (virtual) interface
+bool pcapfileRawsockCheckInterface(const char *ifname, if_info_t *info)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_RAWSOCK);
+
+	if (!ifname || !info) {
+		AVB_LOG_ERROR("Checking interface; invalid arguments");
+		AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+		return FALSE;
+	}
+
+	memset(info, 0, sizeof(if_info_t));
+	strncpy(info->name, ifname, sizeof(info->name) - 1);
+
+	const char *mac = getenv("OPENAVB_PCAPFILE_MAC");
+	if (!mac || !ether_aton_r(mac, &info->mac)) {
+		ether_aton_r(PCAPFILE_DEFAULT_MAC, &info->mac);
+	}
+	info->index = 0;
+	info->mtu = PCAPFILE_DEFAULT_MTU;
+
+	AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+	return TRUE;
+}
+
+// Open a rawsock for TX or RX
+void *pcapfileRawsockOpen(pcapfile_rawsock_t *rawsock, const char *ifname, bool rx_mode, bool tx_mode, U16 ethertype, U32 frame_size, U32 num_frames)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_RAWSOCK);
+
+	AVB_LOGF_DEBUG("Open, rx=%d, tx=%d, ethertype=%x size=%d, num=%d", rx_mode, tx_mode, ethertype, frame_size, num_frames);
+
+	baseRawsockOpen(&rawsock->base, ifname, rx_mode, tx_mode, ethertype, frame_size, num_frames);
+
+	pcapfileRawsockCheckInterface(ifname, &rawsock->base.ifInfo);
+
+	// Deal with frame size.
+	if (rawsock->base.frameSize == 0) {
+		rawsock->base.frameSize = rawsock->base.ifInfo.mtu + ETH_HLEN + VLAN_HLEN;
+	}
+	else if (rawsock->base.frameSize > (int)sizeof(rawsock->txBuffer)) {
+		AVB_LOG_ERROR("Creating rawsock; requested frame size exceeds MTU");
+		free(rawsock);
+		AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+		return NULL;
+	}
+
+	if (rx_mode) {
+		const char *path = getenv("OPENAVB_PCAPFILE_RX");
+		if (path && *path) {
+			strncpy(rawsock->rxPath, path, sizeof(rawsock->rxPath) - 1);
+		}
+		else {
+			snprintf(rawsock->rxPath, sizeof(rawsock->rxPath), "%s.pcap", ifname);
+		}
+
+		const char *loop = getenv("OPENAVB_PCAPFILE_LOOP");
+		rawsock->loopCount = (loop && *loop) ? strtoul(loop, NULL, 0) : 1;
+		rawsock->speed = x_speedFromEnv();
+
+		if (!x_openRxFile(rawsock)) {
+			free(rawsock);
+			AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+			return NULL;
+		}
+		rawsock->replayStartNsec = x_monoNsec();
+
+		AVB_LOGF_INFO("Replaying %s, speed=%s%.2f, passes=%u", rawsock->rxPath,
+			rawsock->speed == 0.0 ? "max/" : "", rawsock->speed, rawsock->loopCount);
+	}
+
+	if (tx_mode) {
+		if (!x_openTxFile()) {
+			if (rawsock->rxHandle) {
+				pcap_close(rawsock->rxHandle);
+			}
+			free(rawsock);
+			AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+			return NULL;
+		}
+	}
+
+	// fill virtual functions table
+	rawsock_cb_t *cb = &rawsock->base.cb;
+	cb->close = pcapfileRawsockClose;
+	cb->getTxFrame = pcapfileRawsockGetTxFrame;
+	cb->txFrameReady = pcapfileRawsockTxFrameReady;
+	cb->send = pcapfileRawsockSend;
+	cb->getRxFrame = pcapfileRawsockGetRxFrame;
+	cb->rxMulticast = pcapfileRawsockRxMulticast;
+	cb->rxAVTPSubtype = pcapfileRawsockRxAVTPSubtype;
+	cb->rxParseHdr = pcapfileRawsockRxParseHdr;
+
+	AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+	return rawsock;
+}
+
+void pcapfileRawsockClose(void *pvRawsock)
+{
+	pcapfile_rawsock_t *rawsock = (pcapfile_rawsock_t*)pvRawsock;
+
+	if (rawsock) {
+		if (rawsock->rxHandle) {
+			pcap_close(rawsock->rxHandle);
+		}
+		if (rawsock->base.txMode) {
+			x_closeTxFile();
+		}
+		AVB_LOGF_DEBUG("Closing pcapfile rawsock: rx=%" PRIu64 " filtered=%" PRIu64 " tx=%" PRIu64,
+			rawsock->rxFrames, rawsock->rxFiltered, rawsock->txFrames);
+	}
+
+	baseRawsockClose(rawsock);
+}
+
+U8 *pcapfileRawsockGetTxFrame(void *pvRawsock, bool blocking, unsigned int *len)
+{
+	pcapfile_rawsock_t *rawsock = (pcapfile_rawsock_t*)pvRawsock;
+
+	if (rawsock) {
+		*len = rawsock->base.frameSize;
+		return rawsock->txBuffer;
+	}
+
+	return NULL;
+}
+
+bool pcapfileRawsockTxFrameReady(void *pvRawsock, U8 *pBuffer, unsigned int len, U64 timeNsec)
+{
+	pcapfile_rawsock_t *rawsock = (pcapfile_rawsock_t*)pvRawsock;
+
+	if (!rawsock) {
+		return FALSE;
+	}
+
+	rawsock->txFrames++;
+
+	pthread_mutex_lock(&gTxMutex);
+	if (gTxDumper) {
+		// Record the launch time when one was requested, otherwise the send time
+		if (!timeNsec) {
+			struct timespec now;
+			clock_gettime(CLOCK_REALTIME, &now);
+			timeNsec = ((U64)now.tv_sec * NANOSECONDS_PER_SECOND) + (U64)now.tv_nsec;
+		}
+
+		struct pcap_pkthdr hdr;
+		hdr.ts.tv_sec = timeNsec / NANOSECONDS_PER_SECOND;
+		hdr.ts.tv_usec = timeNsec % NANOSECONDS_PER_SECOND;
+		hdr.caplen = len;
+		hdr.len = len;
+		pcap_dump((u_char *)gTxDumper, &hdr, pBuffer);
+	}
+	pthread_mutex_unlock(&gTxMutex);
+
+	return TRUE;
+}
+
+// Send all packets that are ready
+int pcapfileRawsockSend(void *pvRawsock)
+{
+	// Frames are written in pcapfileRawsockTxFrameReady
+
+	return 1;
+}
+
+U8 *pcapfileRawsockGetRxFrame(void *pvRawsock, U32 timeout, unsigned int *offset, unsigned int *len)
+{
+	pcapfile_rawsock_t *rawsock = (pcapfile_rawsock_t*)pvRawsock;
+
+	if (!VALID_RX_RAWSOCK(rawsock)) {
+		AVB_LOG_ERROR("Getting RX frame; invalid arguments");
+		return NULL;
+	}
+
+	U64 nowNsec = x_monoNsec();
+	U64 timeoutNsec = (timeout == (U32)OPENAVB_RAWSOCK_BLOCK) ? (U64)-1 : (U64)timeout * NANOSECONDS_PER_USEC;
+
+	if (!rawsock->rxPacket && !x_readNext(rawsock)) {
+		// Replay done; behave like an idle link
+		U64 waitNsec = timeoutNsec < (PCAPFILE_IDLE_USEC * NANOSECONDS_PER_USEC) ? timeoutNsec : (PCAPFILE_IDLE_USEC * NANOSECONDS_PER_USEC);
+		if (waitNsec) {
+			x_sleepUntilNsec(nowNsec + waitNsec);
+		}
+		return NULL;
+	}
+
+	U64 dueNsec = nowNsec;
+	if (rawsock->speed > 0.0) {
+		U64 captureOffset = rawsock->passOffsetNsec + (x_pktNsec(rawsock->rxHeader) - rawsock->firstPktNsec);
+		dueNsec = rawsock->replayStartNsec + (U64)((double)captureOffset / rawsock->speed);
+		if (dueNsec > nowNsec) {
+			if (dueNsec - nowNsec > timeoutNsec) {
+				// Not due within the timeout; keep it for the next call
+				if (timeoutNsec) {
+					x_sleepUntilNsec(nowNsec + timeoutNsec);
+				}
+				return NULL;
+			}
+			x_sleepUntilNsec(dueNsec);
+		}
+	}
+
+	U8 *pFrame = (U8 *)rawsock->rxPacket;
+	*offset = 0;
+	*len = rawsock->rxHeader->caplen;
+	rawsock->rxDeliverNsec = x_pktNsec(rawsock->rxHeader);
+	rawsock->rxPacket = NULL;	// buffer stays valid until the next pcap_next_ex()
+	rawsock->rxFrames++;
+	return pFrame;
+}
+
+int pcapfileRawsockRxParseHdr(void *pvRawsock, U8 *pBuffer, hdr_info_t *pInfo)
+{
+	int hdrLen = baseRawsockRxParseHdr(pvRawsock, pBuffer, pInfo);
+
+	pcapfile_rawsock_t *rawsock = (pcapfile_rawsock_t*)pvRawsock;
+	if (rawsock) {
+		// Report the capture timestamp of the frame
+		pInfo->ts.tv_sec = rawsock->rxDeliverNsec / NANOSECONDS_PER_SECOND;
+		pInfo->ts.tv_nsec = rawsock->rxDeliverNsec % NANOSECONDS_PER_SECOND;
+	}
+	return hdrLen;
+}
+
+// Setup the rawsock to receive multicast packets
+bool pcapfileRawsockRxMulticast(void *pvRawsock, bool add_membership, const U8 addr[ETH_ALEN])
+{
+	pcapfile_rawsock_t *rawsock = (pcapfile_rawsock_t*)pvRawsock;
+	int i;
+
+	if (!VALID_RX_RAWSOCK(rawsock)) {
+		AVB_LOG_ERROR("Setting multicast; invalid arguments");
+		return FALSE;
+	}
+
+	for (i = 0; i < rawsock->mcastCount; i++) {
+		if (memcmp(rawsock->mcastAddr[i], addr, ETH_ALEN) == 0) {
+			break;
+		}
+	}
+
+	if (add_membership) {
+		if (i < rawsock->mcastCount) {
+			return TRUE;
+		}
+		if (rawsock->mcastCount >= PCAPFILE_MAX_MCAST) {
+			AVB_LOG_ERROR("Setting multicast; too many memberships");
+			return FALSE;
+		}
+		memcpy(rawsock->mcastAddr[rawsock->mcastCount++], addr, ETH_ALEN);
+	}
+	else if (i < rawsock->mcastCount) {
+		memmove(rawsock->mcastAddr[i], rawsock->mcastAddr[i + 1], (rawsock->mcastCount - i - 1) * ETH_ALEN);
+		rawsock->mcastCount--;
+	}
+
+	return TRUE;
+}
+
+// Only deliver AVTP frames of the given subtype
+bool pcapfileRawsockRxAVTPSubtype(void *pvRawsock, U8 subtype)
+{
+	pcapfile_rawsock_t *rawsock = (pcapfile_rawsock_t*)pvRawsock;
+
+	if (!VALID_RX_RAWSOCK(rawsock)) {
+		return FALSE;
+	}
+
+	rawsock->avtpSubtype = subtype & 0x7F;
+	rawsock->avtpSubtypeSet = TRUE;
+	return TRUE;
+}
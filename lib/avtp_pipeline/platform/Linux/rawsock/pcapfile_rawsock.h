@@ -0,0 +1,113 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* HEADER SUMMARY : Rawsock implementation that replays packets from a capture
+*  file and records transmitted packets to a capture file.
+*/
+
+#ifndef PCAPFILE_RAWSOCK_H
+#define PCAPFILE_RAWSOCK_H
+
+#include "rawsock_impl.h"
+#include <pcap/pcap.h>
+#include <limits.h>
+
+// Interface name prefix selecting this implementation, e.g. "pcapfile:avb0".
+// The part after the colon is a logical interface name; it does not have to
+// exist on the host. The capture files and replay speed are taken from the
+// environment since an interface name is too short to carry a path:
+//
+//  OPENAVB_PCAPFILE_RX     capture replayed into every RX socket
+//                          (default <name>.pcap)
+//  OPENAVB_PCAPFILE_TX     capture file receiving all TX frames of the process
+//                          (default: TX frames are counted and dropped)
+//  OPENAVB_PCAPFILE_SPEED  "original" (default), "max" or a scale factor such
+//                          as 2.0 for twice the recorded rate
+//  OPENAVB_PCAPFILE_LOOP   number of passes through the RX capture, 0 = forever
+//                          (default 1)
+//  OPENAVB_PCAPFILE_MAC    MAC address reported for the interface
+//                          (default 02:00:00:00:00:01)
+#define PCAPFILE_RAWSOCK_PROTO	"pcapfile"
+
+#define PCAPFILE_MAX_MCAST	16
+
+typedef struct {
+	base_rawsock_t base;
+
+	// RX replay
+	pcap_t *rxHandle;
+	char rxPath[PATH_MAX];
+	struct pcap_pkthdr *rxHeader;
+	const u_char *rxPacket;		// next packet read from the file, not yet delivered
+	U32 loopCount;				// 0 = loop forever
+	U32 loopsDone;
+	double speed;				// 0.0 = as fast as possible
+	U64 firstPktNsec;			// capture time of the first packet of the pass
+	U64 replayStartNsec;		// CLOCK_MONOTONIC time the pass started
+	U64 passOffsetNsec;			// capture time span of all previous passes
+	U64 lastPktNsec;
+	U64 rxDeliverNsec;			// replay time of the frame last delivered
+	U8 mcastAddr[PCAPFILE_MAX_MCAST][ETH_ALEN];
+	int mcastCount;
+	U8 avtpSubtype;
+	bool avtpSubtypeSet;
+
+	// TX recording
+	U8 txBuffer[1522];
+
+	// statistics
+	U64 rxFrames;
+	U64 rxFiltered;
+	U64 txFrames;
+} pcapfile_rawsock_t;
+
+bool pcapfileRawsockCheckInterface(const char *ifname, if_info_t *info);
+
+void *pcapfileRawsockOpen(pcapfile_rawsock_t *rawsock, const char *ifname, bool rx_mode, bool tx_mode, U16 ethertype, U32 frame_size, U32 num_frames);
+
+void pcapfileRawsockClose(void *pvRawsock);
+
+U8 *pcapfileRawsockGetTxFrame(void *pvRawsock, bool blocking, unsigned int *len);
+
+bool pcapfileRawsockTxFrameReady(void *pvRawsock, U8 *pBuffer, unsigned int len, U64 timeNsec);
+
+int pcapfileRawsockSend(void *pvRawsock);
+
+U8 *pcapfileRawsockGetRxFrame(void *pvRawsock, U32 timeout, unsigned int *offset, unsigned int *len);
+
+int pcapfileRawsockRxParseHdr(void *pvRawsock, U8 *pBuffer, hdr_info_t *pInfo);
+
+bool pcapfileRawsockRxMulticast(void *pvRawsock, bool add_membership, const U8 addr[ETH_ALEN]);
+
+bool pcapfileRawsockRxAVTPSubtype(void *pvRawsock, U8 subtype);
+
+#endif
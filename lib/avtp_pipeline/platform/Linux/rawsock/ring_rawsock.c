@@ -38,6 +38,8 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #define	AVB_LOG_COMPONENT	"Raw Socket"
 #include "openavb_log.h"
 
+static int ringRawsockSendTimed(ring_rawsock_t *rawsock, U64 timeNsec);
+
 
 // Open a rawsock for TX or RX
 void* ringRawsockOpen(ring_rawsock_t *rawsock, const char *ifname, bool rx_mode, bool tx_mode, U16 ethertype, U32 frame_size, U32 num_frames)
@@ -163,6 +165,7 @@ void* ringRawsockOpen(ring_rawsock_t *rawsock, const char *ifname, bool rx_mode,
 	cb->rxBufLevel = ringRawsockRxBufLevel;
 	cb->getRxFrame = ringRawsockGetRxFrame;
 	cb->rxParseHdr = ringRawsockRxParseHdr;
+	cb->rxFramePending = ringRawsockRxFramePending;
 	cb->relRxFrame = ringRawsockRelRxFrame;
 	cb->getTXOutOfBuffers = ringRawsockGetTXOutOfBuffers;
 	cb->getTXOutOfBuffersCyclic = ringRawsockGetTXOutOfBuffersCyclic;
@@ -336,11 +339,6 @@ bool ringRawsockTxFrameReady(void *pvRawsock, U8 *pBuffer, unsigned int len, U64
 		return FALSE;
 	}
 
-	if (timeNsec) {
-		IF_LOG_INTERVAL(1000) AVB_LOG_WARNING("launch time is unsupported in ring_rawsock");
-	}
-
-
 	volatile struct tpacket2_hdr *pHdr = (struct tpacket2_hdr*)(pBuffer - rawsock->bufHdrSize);
 	AVB_LOGF_VERBOSE("pBuffer=%p, pHdr=%p szFrame=%d, len=%d", pBuffer, pHdr, rawsock->base.frameSize, len);
 
@@ -349,7 +347,12 @@ bool ringRawsockTxFrameReady(void *pvRawsock, U8 *pBuffer, unsigned int len, U64
 	pHdr->tp_status = TP_STATUS_SEND_REQUEST;
 	rawsock->buffersReady += 1;
 
-	if (rawsock->buffersReady >= rawsock->frameCount) {
+	if (rawsock->base.txLaunchTime && timeNsec) {
+		// The kernel applies one SCM_TXTIME to every frame a send call takes
+		// from the ring, so each timed frame has to go out on its own.
+		ringRawsockSendTimed(rawsock, timeNsec);
+	}
+	else if (rawsock->buffersReady >= rawsock->frameCount) {
 		AVB_LOG_WARNING("All buffers in ready/unsent state, calling send");
 		ringRawsockSend(pvRawsock);
 	}
@@ -369,10 +372,35 @@ int ringRawsockSend(void *pvRawsock)
 		return -1;
 	}
 
+	int sent = ringRawsockSendTimed(rawsock, 0);
+	if (rawsock->base.txLaunchTime) {
+		simpleRawsockTxLaunchErrors(rawsock);
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK_DETAIL);
+	return sent;
+}
+
+// Tell the kernel to send the ready frames, with a launch time if timeNsec is set
+static int ringRawsockSendTimed(ring_rawsock_t *rawsock, U64 timeNsec)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_RAWSOCK_DETAIL);
+
 	// Linux does something dumb to wait for frames to be sent.
 	// Without MSG_DONTWAIT, CPU usage is bad.
 	int flags = MSG_DONTWAIT;
-	int sent = send(rawsock->sock, NULL, 0, flags);
+	int sent;
+	if (timeNsec) {
+		unsigned char cmsgbuf[TXTIME_CMSG_SPACE];
+		struct msghdr msg;
+
+		memset(&msg, 0, sizeof(msg));
+		simpleRawsockTxTimeCmsg(&msg, cmsgbuf, timeNsec);
+		sent = sendmsg(rawsock->sock, &msg, flags);
+	}
+	else {
+		sent = send(rawsock->sock, NULL, 0, flags);
+	}
 	if (errno == EINTR) {
 		// ignore
 	}
@@ -427,6 +455,23 @@ int ringRawsockTxBufLevel(void *pvRawsock)
 }
 
 
+// Check whether the kernel has handed the next RX slot to us.
+// Only reads the slot header in the mapped ring, so it is cheap enough to spin on.
+bool ringRawsockRxFramePending(void *pvRawsock)
+{
+	ring_rawsock_t *rawsock = (ring_rawsock_t*)pvRawsock;
+	if (!VALID_RX_RAWSOCK(rawsock) || rawsock->buffersOut >= rawsock->frameCount) {
+		return FALSE;
+	}
+
+	volatile struct tpacket2_hdr *pHdr =
+		(struct tpacket2_hdr*)(rawsock->pMem
+							   + (rawsock->blockIndex * rawsock->blockSize)
+							   + (rawsock->bufferIndex * rawsock->bufferSize));
+
+	return (pHdr->tp_status & TP_STATUS_USER) != 0;
+}
+
 // Count used TX buffers in ring
 int ringRawsockRxBufLevel(void *pvRawsock)
 {
@@ -103,6 +103,9 @@ int ringRawsockRxBufLevel(void *pvRawsock);
 // Get a RX frame
 U8* ringRawsockGetRxFrame(void *pvRawsock, U32 timeout, unsigned int *offset, unsigned int *len);
 
+// Check the next RX slot in the ring without a system call
+bool ringRawsockRxFramePending(void *pvRawsock);
+
 // Parse the ethernet frame header.  Returns length of header, or -1 for failure
 int ringRawsockRxParseHdr(void *pvRawsock, U8 *pBuffer, hdr_info_t *pInfo);
 
@@ -32,6 +32,7 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #include "sendmmsg_rawsock.h"
 
 #include "simple_rawsock.h"
+#include "bpf_stream_filter.h"
 #include <sys/socket.h>
 #include <sys/ioctl.h>
 #include <linux/if_packet.h>
@@ -40,24 +41,14 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #define AVB_LOG_LEVEL AVB_LOG_LEVEL_INFO
 
 #include "openavb_trace.h"
+#include "openavb_arena.h"
 
 #define	AVB_LOG_COMPONENT	"Raw Socket"
 #include "openavb_log.h"
 
 
-#if USE_LAUNCHTIME
-
-#ifndef SCM_TIMEDLAUNCH
-#define SCM_TIMEDLAUNCH 0x04
-#endif
-
-#endif /* if USE_LAUNCHTIME */
-
-
 static void fillmsghdr(struct msghdr *msg, struct iovec *iov,
-#if USE_LAUNCHTIME
 					   unsigned char *cmsgbuf, uint64_t time,
-#endif
 					   void *pktdata, size_t pktlen)
 {
 	msg->msg_name = NULL;
@@ -68,26 +59,13 @@ static void fillmsghdr(struct msghdr *msg, struct iovec *iov,
 	msg->msg_iov = iov;
 	msg->msg_iovlen = 1;
 
-#if USE_LAUNCHTIME
-	{
-		struct cmsghdr *cmsg;
-		uint64_t *tsptr;
-
-		msg->msg_control = cmsgbuf;
-		msg->msg_controllen = CMSG_LEN(sizeof time);
-
-		cmsg = CMSG_FIRSTHDR(msg);
-		cmsg->cmsg_level = SOL_SOCKET;
-		cmsg->cmsg_type = SCM_TIMEDLAUNCH;
-		cmsg->cmsg_len = CMSG_LEN(sizeof time);
-
-		tsptr = (uint64_t *)CMSG_DATA(cmsg);
-		*tsptr = time;
+	if (cmsgbuf) {
+		simpleRawsockTxTimeCmsg(msg, cmsgbuf, time);
+	}
+	else {
+		msg->msg_control = NULL;
+		msg->msg_controllen = 0;
 	}
-#else
-	msg->msg_control = NULL;
-	msg->msg_controllen = 0;
-#endif
 
 	msg->msg_flags = 0;
 }
@@ -107,7 +85,7 @@ void* sendmmsgRawsockOpen(sendmmsg_rawsock_t* rawsock, const char *ifname, bool
 	// Get info about the network device
 	if (!simpleAvbCheckInterface(ifname, &(rawsock->base.ifInfo))) {
 		AVB_LOGF_ERROR("Creating rawsock; bad interface name: %s", ifname);
-		free(rawsock);
+		openavbArenaFree(rawsock);
 		AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
 		return NULL;
 	}
@@ -119,7 +97,7 @@ void* sendmmsgRawsockOpen(sendmmsg_rawsock_t* rawsock, const char *ifname, bool
 	}
 	else if (rawsock->base.frameSize > rawsock->base.ifInfo.mtu + ETH_HLEN + VLAN_HLEN) {
 		AVB_LOG_ERROR("Creating raswsock; requested frame size exceeds MTU");
-		free(rawsock);
+		openavbArenaFree(rawsock);
 		AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
 		return NULL;
 	}
@@ -168,9 +146,7 @@ void* sendmmsgRawsockOpen(sendmmsg_rawsock_t* rawsock, const char *ifname, bool
 	memset(rawsock->mmsg, 0, sizeof(rawsock->mmsg));
 	memset(rawsock->miov, 0, sizeof(rawsock->miov));
 	memset(rawsock->pktbuf, 0, sizeof(rawsock->pktbuf));
-#if USE_LAUNCHTIME
 	memset(rawsock->cmsgbuf, 0, sizeof(rawsock->cmsgbuf));
-#endif
 
 	rawsock->buffersOut = 0;
 	rawsock->buffersReady = 0;
@@ -187,6 +163,10 @@ void* sendmmsgRawsockOpen(sendmmsg_rawsock_t* rawsock, const char *ifname, bool
 	cb->getRxFrame = sendmmsgRawsockGetRxFrame;
 	cb->rxMulticast = sendmmsgRawsockRxMulticast;
 	cb->getSocket = sendmmsgRawsockGetSocket;
+	cb->setRxBusyPoll = simpleRawsockSetRxBusyPoll;
+	cb->txSetLaunchTime = simpleRawsockTxSetLaunchTime;
+	cb->rxStreamID = simpleRawsockRxStreamID;
+	cb->rxStreamCounts = simpleRawsockRxStreamCounts;
 
 	AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
 	return rawsock;
@@ -203,6 +183,8 @@ void sendmmsgRawsockClose(void *pvRawsock)
 			close(rawsock->sock);
 			rawsock->sock = -1;
 		}
+		bpfStreamFilterClose(rawsock->base.rxStreamFilter);
+		rawsock->base.rxStreamFilter = NULL;
 	}
 
 	baseRawsockClose(rawsock);
@@ -221,6 +203,10 @@ U8* sendmmsgRawsockGetTxFrame(void *pvRawsock, bool blocking, unsigned int *len)
 		AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK_DETAIL);
 		return NULL;
 	}
+	if (rawsock->buffersOut >= rawsock->frameCount && rawsock->buffersReady == rawsock->buffersOut) {
+		// All slots are queued; flush them so a caller can batch more than MSG_COUNT frames
+		sendmmsgRawsockSend(rawsock);
+	}
 	if (rawsock->buffersOut >= rawsock->frameCount) {
 		AVB_LOG_ERROR("Getting TX frame; too many TX buffers in use");
 		AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK_DETAIL);
@@ -303,19 +289,14 @@ bool sendmmsgRawsockTxFrameReady(void *pvRawsock, U8 *pBuffer, unsigned int len,
 	bufidx = rawsock->buffersReady;
 	assert(pBuffer == rawsock->pktbuf[bufidx]);
 
-#if USE_LAUNCHTIME
-	if (!timeNsec) {
-		IF_LOG_INTERVAL(1000) AVB_LOG_WARNING("launch time is enabled but not passed to TxFrameReady");
+	if (rawsock->base.txLaunchTime && timeNsec) {
+		fillmsghdr(&(rawsock->mmsg[bufidx].msg_hdr), &(rawsock->miov[bufidx]), rawsock->cmsgbuf[bufidx],
+				   timeNsec, rawsock->pktbuf[bufidx], len);
 	}
-	fillmsghdr(&(rawsock->mmsg[bufidx].msg_hdr), &(rawsock->miov[bufidx]), rawsock->cmsgbuf[bufidx],
-			   timeNsec, rawsock->pktbuf[bufidx], len);
-#else
-	if (timeNsec) {
-		IF_LOG_INTERVAL(1000) AVB_LOG_WARNING("launch time is not enabled but was passed to TxFrameReady");
+	else {
+		fillmsghdr(&(rawsock->mmsg[bufidx].msg_hdr), &(rawsock->miov[bufidx]), NULL,
+				   0, rawsock->pktbuf[bufidx], len);
 	}
-	fillmsghdr(&(rawsock->mmsg[bufidx].msg_hdr), &(rawsock->miov[bufidx]), rawsock->pktbuf[bufidx], len);
-#endif
-
 
 	rawsock->buffersReady += 1;
 
@@ -364,6 +345,10 @@ int sendmmsgRawsockSend(void *pvRawsock)
 
 	rawsock->buffersOut = rawsock->buffersReady = 0;
 
+	if (rawsock->base.txLaunchTime) {
+		simpleRawsockTxLaunchErrors(rawsock);
+	}
+
 	AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK_DETAIL);
 	return bytes;
 }
@@ -442,8 +427,11 @@ bool sendmmsgRawsockRxMulticast(void *pvRawsock, bool add_membership, const U8 a
 	//	per-socket, so without the filter, this socket would receieve
 	//	packets for all the multicast addresses added by all other
 	//	sockets.
-	//
-	if (add_membership)
+	if (rawsock->base.rxStreamFilter) {
+		// The stream filter already limits the socket to its streams,
+		// whatever the destination address; leave it attached.
+	}
+	else if (add_membership)
 	{
 		// Here's the template packet filter code.
 		// It was produced by running:
@@ -39,10 +39,10 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #include <sys/socket.h>
 
 #include "rawsock_impl.h"
+#include "simple_rawsock.h"
 
 #define MSG_COUNT 8
 #define MAX_FRAME_SIZE 1024
-#define USE_LAUNCHTIME 0
 
 
 // State information for raw socket
@@ -70,9 +70,9 @@ typedef struct {
 	struct iovec miov[MSG_COUNT];
 
 	unsigned char pktbuf[MSG_COUNT][MAX_FRAME_SIZE];
-#if USE_LAUNCHTIME
-	unsigned char cmsgbuf[MSG_COUNT][CMSG_SPACE(sizeof(uint64_t))];
-#endif
+
+	// SCM_TXTIME control messages, used when launch time is enabled
+	unsigned char cmsgbuf[MSG_COUNT][TXTIME_CMSG_SPACE];
 } sendmmsg_rawsock_t;
 
 // Open a rawsock for TX or RX
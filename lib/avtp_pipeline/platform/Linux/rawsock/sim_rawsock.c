@@ -0,0 +1,599 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+ * Rawsock implementation on in-memory links, for simulations of talkers and
+ * listeners in one process on virtual time. A frame sent on a link is copied
+ * to the RX sockets on it with the virtual time it arrives at, after waiting
+ * for the wire and the link delay and jitter, unless the loss model drops it.
+ * A read waits in virtual time for the next frame to arrive, so a listener
+ * sees the same pacing it would on a network, only faster.
+*/
+
+#include <pthread.h>
+#include <netinet/ether.h>
+#include "sim_rawsock.h"
+#include "openavb_trace.h"
+
+#define	AVB_LOG_COMPONENT	"Raw Socket"
+#include "openavb_log.h"
+
+#define SIM_DEFAULT_MAC				"02:00:00:00:00:01"
+#define SIM_DEFAULT_MTU				1500
+#define SIM_DEFAULT_RX_FRAMES		64
+#define SIM_ETHERTYPE_AVTP			0x22F0
+#define SIM_MIN_FRAME_BYTES			60
+// Preamble, FCS and inter-frame gap
+#define SIM_WIRE_OVERHEAD_BYTES		24
+
+struct sim_link {
+	struct sim_link *pNext;
+	char name[IFNAMSIZ];
+	sim_link_cfg_t cfg;
+	sim_link_stats_t stats;
+	U64 rand;					// random number stream of the loss and jitter models
+	U64 wireFreeNsec;			// virtual time the wire is free again
+	U64 lastArrivalNsec;		// arrival time of the last frame; later frames don't overtake it
+	sim_rawsock_t *pRxSocks;
+};
+
+// All links of the process, and the frames queued on them
+static pthread_mutex_t gLinkMutex = PTHREAD_MUTEX_INITIALIZER;
+static sim_link_t *gLinks = NULL;
+
+// Find a link, creating it if needed. Called with gLinkMutex held.
+static sim_link_t *x_linkGet(const char *name, bool bCreate)
+{
+	sim_link_t *pLink;
+
+	for (pLink = gLinks; pLink; pLink = pLink->pNext) {
+		if (strncmp(pLink->name, name, sizeof(pLink->name)) == 0) {
+			return pLink;
+		}
+	}
+	if (!bCreate) {
+		return NULL;
+	}
+
+	pLink = calloc(1, sizeof(sim_link_t));
+	if (pLink) {
+		strncpy(pLink->name, name, sizeof(pLink->name) - 1);
+		pLink->rand = osalSimSeed(pLink->name);
+		pLink->pNext = gLinks;
+		gLinks = pLink;
+	}
+	return pLink;
+}
+
+// Decide if a frame on the link would reach this socket
+static bool x_rxAccept(sim_rawsock_t *rawsock, const U8 *pkt, U32 len)
+{
+	if (len < sizeof(eth_hdr_t)) {
+		return FALSE;
+	}
+
+	const eth_hdr_t *eth = (const eth_hdr_t *)pkt;
+	U16 ethertype = ntohs(eth->ethertype);
+	U32 hdrLen = sizeof(eth_hdr_t);
+	if (ethertype == ETHERTYPE_8021Q && rawsock->base.ethertype != ETHERTYPE_8021Q) {
+		if (len < sizeof(eth_vlan_hdr_t)) {
+			return FALSE;
+		}
+		ethertype = ntohs(((const eth_vlan_hdr_t *)pkt)->ethertype);
+		hdrLen = sizeof(eth_vlan_hdr_t);
+	}
+	if (ethertype != rawsock->base.ethertype) {
+		return FALSE;
+	}
+
+	if (rawsock->avtpSubtypeSet && ethertype == SIM_ETHERTYPE_AVTP
+		&& (len <= hdrLen || (pkt[hdrLen] & 0x7F) != rawsock->avtpSubtype)) {
+		return FALSE;
+	}
+
+	// Multicast destinations only pass once a membership was requested
+	if (eth->dhost[0] & 0x01) {
+		int i;
+		for (i = 0; i < rawsock->mcastCount; i++) {
+			if (memcmp(eth->dhost, rawsock->mcastAddr[i], ETH_ALEN) == 0) {
+				return TRUE;
+			}
+		}
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+// Queue a copy of a frame on an RX socket. Called with gLinkMutex held.
+static void x_rxQueue(sim_rawsock_t *rawsock, const U8 *pFrame, U32 len, U64 dueNsec)
+{
+	if (rawsock->rxCount == rawsock->rxSlotCount) {
+		rawsock->rxOverruns++;
+		rawsock->pLink->stats.rxOverruns++;
+		return;
+	}
+
+	sim_rx_slot_t *pSlot = &rawsock->pRxSlots[rawsock->rxHead];
+	pSlot->len = (len < (U32)rawsock->base.frameSize) ? len : (U32)rawsock->base.frameSize;
+	pSlot->dueNsec = dueNsec;
+	memcpy(pSlot->pData, pFrame, pSlot->len);
+	rawsock->rxHead = (rawsock->rxHead + 1) % rawsock->rxSlotCount;
+	rawsock->rxCount++;
+	rawsock->pLink->stats.rxFrames++;
+
+	if (rawsock->pRxWaiter) {
+		osalSimWake(rawsock->pRxWaiter, dueNsec);
+	}
+}
+
+// Put a frame on the wire of a link at virtual time sendNsec
+static void x_linkSend(sim_link_t *pLink, const U8 *pFrame, U32 len, U64 sendNsec)
+{
+	pthread_mutex_lock(&gLinkMutex);
+
+	pLink->stats.txFrames++;
+	if (pLink->cfg.lossPpm && osalSimRand(&pLink->rand) % 1000000 < pLink->cfg.lossPpm) {
+		pLink->stats.lostFrames++;
+		pthread_mutex_unlock(&gLinkMutex);
+		return;
+	}
+
+	U64 startNsec = (sendNsec > pLink->wireFreeNsec) ? sendNsec : pLink->wireFreeNsec;
+	if (startNsec - sendNsec > pLink->stats.maxWireWaitNsec) {
+		pLink->stats.maxWireWaitNsec = startNsec - sendNsec;
+	}
+	pLink->wireFreeNsec = startNsec;
+	if (pLink->cfg.rateMbps) {
+		U64 bytes = ((len < SIM_MIN_FRAME_BYTES) ? SIM_MIN_FRAME_BYTES : len) + SIM_WIRE_OVERHEAD_BYTES;
+		pLink->wireFreeNsec += (bytes * 8 * 1000) / pLink->cfg.rateMbps;
+	}
+
+	U64 dueNsec = pLink->wireFreeNsec + pLink->cfg.latencyNsec;
+	if (pLink->cfg.jitterNsec) {
+		dueNsec += osalSimRand(&pLink->rand) % ((U64)pLink->cfg.jitterNsec + 1);
+	}
+	if (dueNsec < pLink->lastArrivalNsec) {
+		dueNsec = pLink->lastArrivalNsec;
+	}
+	pLink->lastArrivalNsec = dueNsec;
+
+	sim_rawsock_t *pRx;
+	for (pRx = pLink->pRxSocks; pRx; pRx = pRx->pNextRx) {
+		if (x_rxAccept(pRx, pFrame, len)) {
+			x_rxQueue(pRx, pFrame, len, dueNsec);
+		}
+	}
+
+	pthread_mutex_unlock(&gLinkMutex);
+}
+
+bool simRawsockLinkConfig(const char *name, const sim_link_cfg_t *pCfg)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_RAWSOCK);
+
+	if (!name || !pCfg) {
+		AVB_LOG_ERROR("Configuring link; invalid arguments");
+		AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+		return FALSE;
+	}
+
+	pthread_mutex_lock(&gLinkMutex);
+	sim_link_t *pLink = x_linkGet(name, TRUE);
+	if (pLink) {
+		pLink->cfg = *pCfg;
+	}
+	pthread_mutex_unlock(&gLinkMutex);
+
+	if (pLink) {
+		AVB_LOGF_INFO("Link %s: latency=%uns jitter=%uns loss=%uppm rate=%uMbps",
+			name, pCfg->latencyNsec, pCfg->jitterNsec, pCfg->lossPpm, pCfg->rateMbps);
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+	return pLink != NULL;
+}
+
+bool simRawsockLinkStats(const char *name, sim_link_stats_t *pStats)
+{
+	pthread_mutex_lock(&gLinkMutex);
+	sim_link_t *pLink = x_linkGet(name, FALSE);
+	if (pLink) {
+		*pStats = pLink->stats;
+	}
+	pthread_mutex_unlock(&gLinkMutex);
+
+	return pLink != NULL;
+}
+
+void simRawsockLinksFree(void)
+{
+	pthread_mutex_lock(&gLinkMutex);
+	while (gLinks) {
+		sim_link_t *pLink = gLinks;
+		if (pLink->pRxSocks) {
+			AVB_LOGF_WARNING("Link %s freed with RX sockets open", pLink->name);
+		}
+		gLinks = pLink->pNext;
+		free(pLink);
+	}
+	pthread_mutex_unlock(&gLinkMutex);
+}
+
+// Get information about the (virtual) interface
+bool simRawsockCheckInterface(const char *ifname, if_info_t *info)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_RAWSOCK);
+
+	if (!ifname || !info) {
+		AVB_LOG_ERROR("Checking interface; invalid arguments");
+		AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+		return FALSE;
+	}
+
+	memset(info, 0, sizeof(if_info_t));
+	strncpy(info->name, ifname, sizeof(info->name) - 1);
+	ether_aton_r(SIM_DEFAULT_MAC, &info->mac);
+	info->index = 0;
+	info->mtu = SIM_DEFAULT_MTU;
+
+	AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+	return TRUE;
+}
+
+// Open a rawsock for TX or RX
+void *simRawsockOpen(sim_rawsock_t *rawsock, const char *ifname, bool rx_mode, bool tx_mode, U16 ethertype, U32 frame_size, U32 num_frames)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_RAWSOCK);
+
+	AVB_LOGF_DEBUG("Open, rx=%d, tx=%d, ethertype=%x size=%d, num=%d", rx_mode, tx_mode, ethertype, frame_size, num_frames);
+
+	if (!osalSimSelf()) {
+		AVB_LOG_ERROR("Creating rawsock; sim links only exist in a simulation");
+		free(rawsock);
+		AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+		return NULL;
+	}
+
+	baseRawsockOpen(&rawsock->base, ifname, rx_mode, tx_mode, ethertype, frame_size, num_frames);
+
+	simRawsockCheckInterface(ifname, &rawsock->base.ifInfo);
+
+	// Deal with frame size.
+	if (rawsock->base.frameSize == 0) {
+		rawsock->base.frameSize = rawsock->base.ifInfo.mtu + ETH_HLEN + VLAN_HLEN;
+	}
+	else if (rawsock->base.frameSize > (int)sizeof(rawsock->txBuffer)) {
+		AVB_LOG_ERROR("Creating rawsock; requested frame size exceeds MTU");
+		free(rawsock);
+		AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+		return NULL;
+	}
+
+	if (rx_mode) {
+		U32 i;
+		rawsock->rxSlotCount = (num_frames ? num_frames : SIM_DEFAULT_RX_FRAMES) + SIM_RX_INFLIGHT;
+		rawsock->pRxSlots = calloc(rawsock->rxSlotCount, sizeof(sim_rx_slot_t));
+		rawsock->pRxData = malloc((size_t)rawsock->rxSlotCount * rawsock->base.frameSize);
+		if (!rawsock->pRxSlots || !rawsock->pRxData) {
+			AVB_LOG_ERROR("Creating rawsock; malloc failed");
+			free(rawsock->pRxSlots);
+			free(rawsock->pRxData);
+			free(rawsock);
+			AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+			return NULL;
+		}
+		for (i = 0; i < rawsock->rxSlotCount; i++) {
+			rawsock->pRxSlots[i].pData = rawsock->pRxData + (size_t)i * rawsock->base.frameSize;
+		}
+	}
+
+	pthread_mutex_lock(&gLinkMutex);
+	rawsock->pLink = x_linkGet(ifname, TRUE);
+	if (rawsock->pLink && rx_mode) {
+		rawsock->pNextRx = rawsock->pLink->pRxSocks;
+		rawsock->pLink->pRxSocks = rawsock;
+	}
+	pthread_mutex_unlock(&gLinkMutex);
+
+	if (!rawsock->pLink) {
+		AVB_LOG_ERROR("Creating rawsock; malloc failed");
+		free(rawsock->pRxSlots);
+		free(rawsock->pRxData);
+		free(rawsock);
+		AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+		return NULL;
+	}
+
+	// fill virtual functions table
+	rawsock_cb_t *cb = &rawsock->base.cb;
+	cb->close = simRawsockClose;
+	cb->getTxFrame = simRawsockGetTxFrame;
+	cb->txFrameReady = simRawsockTxFrameReady;
+	cb->send = simRawsockSend;
+	cb->txSetLaunchTime = simRawsockTxSetLaunchTime;
+	cb->getRxFrame = simRawsockGetRxFrame;
+	cb->relRxFrame = simRawsockRelRxFrame;
+	cb->rxFramePending = simRawsockRxFramePending;
+	cb->rxMulticast = simRawsockRxMulticast;
+	cb->rxAVTPSubtype = simRawsockRxAVTPSubtype;
+	cb->rxParseHdr = simRawsockRxParseHdr;
+	cb->rxBufLevel = simRawsockRxBufLevel;
+
+	AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+	return rawsock;
+}
+
+void simRawsockClose(void *pvRawsock)
+{
+	sim_rawsock_t *rawsock = (sim_rawsock_t*)pvRawsock;
+
+	if (rawsock) {
+		pthread_mutex_lock(&gLinkMutex);
+		if (rawsock->pLink) {
+			sim_rawsock_t **ppRx = &rawsock->pLink->pRxSocks;
+			while (*ppRx && *ppRx != rawsock) {
+				ppRx = &(*ppRx)->pNextRx;
+			}
+			if (*ppRx) {
+				*ppRx = rawsock->pNextRx;
+			}
+		}
+		pthread_mutex_unlock(&gLinkMutex);
+
+		AVB_LOGF_DEBUG("Closing sim rawsock: rx=%" PRIu64 " overruns=%" PRIu64 " tx=%" PRIu64,
+			rawsock->rxFrames, rawsock->rxOverruns, rawsock->txFrames);
+		free(rawsock->pRxSlots);
+		free(rawsock->pRxData);
+	}
+
+	baseRawsockClose(rawsock);
+}
+
+U8 *simRawsockGetTxFrame(void *pvRawsock, bool blocking, unsigned int *len)
+{
+	sim_rawsock_t *rawsock = (sim_rawsock_t*)pvRawsock;
+
+	if (rawsock) {
+		*len = rawsock->base.frameSize;
+		return rawsock->txBuffer;
+	}
+
+	return NULL;
+}
+
+bool simRawsockTxFrameReady(void *pvRawsock, U8 *pBuffer, unsigned int len, U64 timeNsec)
+{
+	sim_rawsock_t *rawsock = (sim_rawsock_t*)pvRawsock;
+
+	if (!VALID_TX_RAWSOCK(rawsock)) {
+		return FALSE;
+	}
+
+	U64 sendNsec = osalSimNow();
+	if (rawsock->base.txLaunchTime && timeNsec) {
+		// Hold the frame back until its launch time on the sender's gPTP clock
+		U64 wallNsec;
+		if (osalSimClockAt(osalSimSelf(), OPENAVB_CLOCK_WALLTIME, sendNsec, &wallNsec) && timeNsec > wallNsec) {
+			sendNsec += timeNsec - wallNsec;
+		}
+	}
+
+	rawsock->txFrames++;
+	x_linkSend(rawsock->pLink, pBuffer, len, sendNsec);
+	return TRUE;
+}
+
+// Send all packets that are ready
+int simRawsockSend(void *pvRawsock)
+{
+	// Frames are put on the link in simRawsockTxFrameReady
+
+	return 1;
+}
+
+bool simRawsockTxSetLaunchTime(void *pvRawsock, bool enable)
+{
+	sim_rawsock_t *rawsock = (sim_rawsock_t*)pvRawsock;
+
+	if (!VALID_TX_RAWSOCK(rawsock)) {
+		return FALSE;
+	}
+
+	rawsock->base.txLaunchTime = enable;
+	return TRUE;
+}
+
+U8 *simRawsockGetRxFrame(void *pvRawsock, U32 timeout, unsigned int *offset, unsigned int *len)
+{
+	sim_rawsock_t *rawsock = (sim_rawsock_t*)pvRawsock;
+
+	if (!VALID_RX_RAWSOCK(rawsock)) {
+		AVB_LOG_ERROR("Getting RX frame; invalid arguments");
+		return NULL;
+	}
+
+	U64 nowNsec = osalSimNow();
+	U64 endNsec = (timeout == (U32)OPENAVB_RAWSOCK_BLOCK) ? (U64)-1 : nowNsec + (U64)timeout * NANOSECONDS_PER_USEC;
+
+	for (;;) {
+		pthread_mutex_lock(&gLinkMutex);
+		U64 wakeNsec = endNsec;
+		if (rawsock->rxCount) {
+			sim_rx_slot_t *pSlot = &rawsock->pRxSlots[rawsock->rxTail];
+			if (pSlot->dueNsec <= nowNsec) {
+				*offset = 0;
+				*len = pSlot->len;
+				rawsock->rxDeliverNsec = pSlot->dueNsec;
+				rawsock->rxFrames++;
+				pthread_mutex_unlock(&gLinkMutex);
+				// The slot is freed by simRawsockRelRxFrame
+				return pSlot->pData;
+			}
+			if (pSlot->dueNsec < wakeNsec) {
+				wakeNsec = pSlot->dueNsec;
+			}
+		}
+		if (nowNsec >= endNsec) {
+			pthread_mutex_unlock(&gLinkMutex);
+			return NULL;
+		}
+		rawsock->pRxWaiter = osalSimSelf();
+		pthread_mutex_unlock(&gLinkMutex);
+
+		osalSimWaitUntil(wakeNsec);
+
+		pthread_mutex_lock(&gLinkMutex);
+		rawsock->pRxWaiter = NULL;
+		pthread_mutex_unlock(&gLinkMutex);
+		nowNsec = osalSimNow();
+	}
+}
+
+bool simRawsockRelRxFrame(void *pvRawsock, U8 *pBuffer)
+{
+	sim_rawsock_t *rawsock = (sim_rawsock_t*)pvRawsock;
+
+	if (!VALID_RX_RAWSOCK(rawsock)) {
+		return FALSE;
+	}
+
+	pthread_mutex_lock(&gLinkMutex);
+	bool ret = rawsock->rxCount && rawsock->pRxSlots[rawsock->rxTail].pData == pBuffer;
+	if (ret) {
+		rawsock->rxTail = (rawsock->rxTail + 1) % rawsock->rxSlotCount;
+		rawsock->rxCount--;
+	}
+	pthread_mutex_unlock(&gLinkMutex);
+	return ret;
+}
+
+bool simRawsockRxFramePending(void *pvRawsock)
+{
+	sim_rawsock_t *rawsock = (sim_rawsock_t*)pvRawsock;
+
+	if (!VALID_RX_RAWSOCK(rawsock)) {
+		return FALSE;
+	}
+
+	pthread_mutex_lock(&gLinkMutex);
+	bool ret = rawsock->rxCount && rawsock->pRxSlots[rawsock->rxTail].dueNsec <= osalSimNow();
+	pthread_mutex_unlock(&gLinkMutex);
+	return ret;
+}
+
+int simRawsockRxParseHdr(void *pvRawsock, U8 *pBuffer, hdr_info_t *pInfo)
+{
+	int hdrLen = baseRawsockRxParseHdr(pvRawsock, pBuffer, pInfo);
+
+	sim_rawsock_t *rawsock = (sim_rawsock_t*)pvRawsock;
+	U64 rxNsec;
+	if (rawsock && osalSimClockAt(osalSimSelf(), OPENAVB_CLOCK_REALTIME, rawsock->rxDeliverNsec, &rxNsec)) {
+		// Arrival time on the receiver's clock, as a NIC or the kernel would stamp it
+		pInfo->ts.tv_sec = rxNsec / NANOSECONDS_PER_SECOND;
+		pInfo->ts.tv_nsec = rxNsec % NANOSECONDS_PER_SECOND;
+	}
+	return hdrLen;
+}
+
+// Setup the rawsock to receive multicast packets
+bool simRawsockRxMulticast(void *pvRawsock, bool add_membership, const U8 addr[ETH_ALEN])
+{
+	sim_rawsock_t *rawsock = (sim_rawsock_t*)pvRawsock;
+	int i;
+
+	if (!VALID_RX_RAWSOCK(rawsock)) {
+		AVB_LOG_ERROR("Setting multicast; invalid arguments");
+		return FALSE;
+	}
+
+	pthread_mutex_lock(&gLinkMutex);
+	for (i = 0; i < rawsock->mcastCount; i++) {
+		if (memcmp(rawsock->mcastAddr[i], addr, ETH_ALEN) == 0) {
+			break;
+		}
+	}
+
+	bool ret = TRUE;
+	if (add_membership) {
+		if (i == rawsock->mcastCount) {
+			if (rawsock->mcastCount >= SIM_MAX_MCAST) {
+				AVB_LOG_ERROR("Setting multicast; too many memberships");
+				ret = FALSE;
+			}
+			else {
+				memcpy(rawsock->mcastAddr[rawsock->mcastCount++], addr, ETH_ALEN);
+			}
+		}
+	}
+	else if (i < rawsock->mcastCount) {
+		memmove(rawsock->mcastAddr[i], rawsock->mcastAddr[i + 1], (rawsock->mcastCount - i - 1) * ETH_ALEN);
+		rawsock->mcastCount--;
+	}
+	pthread_mutex_unlock(&gLinkMutex);
+
+	return ret;
+}
+
+// Only deliver AVTP frames of the given subtype
+bool simRawsockRxAVTPSubtype(void *pvRawsock, U8 subtype)
+{
+	sim_rawsock_t *rawsock = (sim_rawsock_t*)pvRawsock;
+
+	if (!VALID_RX_RAWSOCK(rawsock)) {
+		return FALSE;
+	}
+
+	rawsock->avtpSubtype = subtype & 0x7F;
+	rawsock->avtpSubtypeSet = TRUE;
+	return TRUE;
+}
+
+// Frames that have arrived and not been read
+int simRawsockRxBufLevel(void *pvRawsock)
+{
+	sim_rawsock_t *rawsock = (sim_rawsock_t*)pvRawsock;
+	int level = 0;
+
+	if (!VALID_RX_RAWSOCK(rawsock)) {
+		return 0;
+	}
+
+	pthread_mutex_lock(&gLinkMutex);
+	U64 nowNsec = osalSimNow();
+	U32 i, idx = rawsock->rxTail;
+	for (i = 0; i < rawsock->rxCount && rawsock->pRxSlots[idx].dueNsec <= nowNsec; i++) {
+		idx = (idx + 1) % rawsock->rxSlotCount;
+		level++;
+	}
+	pthread_mutex_unlock(&gLinkMutex);
+	return level;
+}
@@ -0,0 +1,145 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* HEADER SUMMARY : Rawsock implementation on in-memory links between the
+*  talkers and listeners of a simulation on virtual time.
+*/
+
+#ifndef SIM_RAWSOCK_H
+#define SIM_RAWSOCK_H
+
+#include "rawsock_impl.h"
+#include "openavb_sim_osal.h"
+
+// Interface name prefix selecting this implementation, e.g. "sim:link0".
+// The part after the colon names an in-memory link: every frame sent on the
+// link reaches every RX socket on it that accepts it. Links run on the virtual
+// time of openavb_sim_osal, so the sockets must be opened and used by
+// simulated threads (see avtp_sim).
+#define SIM_RAWSOCK_PROTO	"sim"
+
+#define SIM_MAX_MCAST		16
+// Frames in flight on a link are queued on the RX sockets on top of the
+// frames they were opened for
+#define SIM_RX_INFLIGHT		256
+
+// Model of a link, set with simRawsockLinkConfig()
+typedef struct {
+	U32 latencyNsec;			// propagation and bridge delay
+	U32 jitterNsec;				// random extra delay of up to this; frames stay in order
+	U32 lossPpm;				// frames lost, per million
+	U32 rateMbps;				// frames queue for the wire at this rate; 0 = no limit
+} sim_link_cfg_t;
+
+typedef struct {
+	U64 txFrames;
+	U64 lostFrames;				// dropped by the loss model
+	U64 rxFrames;				// copies queued to RX sockets
+	U64 rxOverruns;				// copies dropped by full RX sockets
+	U64 maxWireWaitNsec;		// longest a frame waited for the wire
+} sim_link_stats_t;
+
+typedef struct sim_link sim_link_t;
+
+typedef struct {
+	U64 dueNsec;				// virtual time the frame arrives
+	U32 len;
+	U8 *pData;
+} sim_rx_slot_t;
+
+typedef struct sim_rawsock {
+	base_rawsock_t base;
+
+	sim_link_t *pLink;
+	struct sim_rawsock *pNextRx;	// next RX socket on the link
+
+	// RX queue, in arrival order
+	sim_rx_slot_t *pRxSlots;
+	U8 *pRxData;
+	U32 rxSlotCount;
+	U32 rxHead;					// next slot to fill
+	U32 rxTail;					// oldest frame
+	U32 rxCount;
+	osal_sim_thread_t *pRxWaiter;	// thread blocked in simRawsockGetRxFrame
+	U64 rxDeliverNsec;			// arrival time of the frame last delivered
+	U8 mcastAddr[SIM_MAX_MCAST][ETH_ALEN];
+	int mcastCount;
+	U8 avtpSubtype;
+	bool avtpSubtypeSet;
+
+	U8 txBuffer[1522];
+
+	// statistics
+	U64 rxFrames;
+	U64 rxOverruns;
+	U64 txFrames;
+} sim_rawsock_t;
+
+// Create a link, or change the model of an existing one. Links that are not
+// configured are created without delay or loss when a socket is opened on them.
+bool simRawsockLinkConfig(const char *name, const sim_link_cfg_t *pCfg);
+
+// Counters of a link since it was created.
+bool simRawsockLinkStats(const char *name, sim_link_stats_t *pStats);
+
+// Free all links. Their sockets must have been closed.
+void simRawsockLinksFree(void);
+
+bool simRawsockCheckInterface(const char *ifname, if_info_t *info);
+
+void *simRawsockOpen(sim_rawsock_t *rawsock, const char *ifname, bool rx_mode, bool tx_mode, U16 ethertype, U32 frame_size, U32 num_frames);
+
+void simRawsockClose(void *pvRawsock);
+
+U8 *simRawsockGetTxFrame(void *pvRawsock, bool blocking, unsigned int *len);
+
+bool simRawsockTxFrameReady(void *pvRawsock, U8 *pBuffer, unsigned int len, U64 timeNsec);
+
+int simRawsockSend(void *pvRawsock);
+
+bool simRawsockTxSetLaunchTime(void *pvRawsock, bool enable);
+
+U8 *simRawsockGetRxFrame(void *pvRawsock, U32 timeout, unsigned int *offset, unsigned int *len);
+
+bool simRawsockRelRxFrame(void *pvRawsock, U8 *pBuffer);
+
+bool simRawsockRxFramePending(void *pvRawsock);
+
+int simRawsockRxParseHdr(void *pvRawsock, U8 *pBuffer, hdr_info_t *pInfo);
+
+bool simRawsockRxMulticast(void *pvRawsock, bool add_membership, const U8 addr[ETH_ALEN]);
+
+bool simRawsockRxAVTPSubtype(void *pvRawsock, U8 subtype);
+
+int simRawsockRxBufLevel(void *pvRawsock);
+
+#endif
@@ -30,12 +30,16 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 *************************************************************************************************************/
 
 #include "simple_rawsock.h"
+#include "bpf_stream_filter.h"
 #include <sys/socket.h>
 #include <sys/ioctl.h>
 #include <linux/if_packet.h>
 #include <linux/filter.h>
+#include <linux/errqueue.h>
+#include <linux/net_tstamp.h>
 
 #include "openavb_trace.h"
+#include "openavb_time_osal.h"
 
 #define	AVB_LOG_COMPONENT	"Raw Socket"
 #include "openavb_log.h"
@@ -208,6 +212,10 @@ void* simpleRawsockOpen(simple_rawsock_t* rawsock, const char *ifname, bool rx_m
 	cb->rxAVTPSubtype = simpleRawsockRxAVTPSubtype;
 	cb->getSocket = simpleRawsockGetSocket;
 	cb->relRxFrame = simpleRawsockRelRxFrame;
+	cb->setRxBusyPoll = simpleRawsockSetRxBusyPoll;
+	cb->txSetLaunchTime = simpleRawsockTxSetLaunchTime;
+	cb->rxStreamID = simpleRawsockRxStreamID;
+	cb->rxStreamCounts = simpleRawsockRxStreamCounts;
 
 	AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
 	return rawsock;
@@ -225,6 +233,8 @@ void simpleRawsockClose(void *pvRawsock)
 			close(rawsock->sock);
 			rawsock->sock = -1;
 		}
+		bpfStreamFilterClose(rawsock->base.rxStreamFilter);
+		rawsock->base.rxStreamFilter = NULL;
 	}
 
 	baseRawsockClose(rawsock);
@@ -320,12 +330,21 @@ bool simpleRawsockTxFrameReady(void *pvRawsock, U8 *pBuffer, unsigned int len, U
 		return FALSE;
 	}
 
-	if (timeNsec) {
-		IF_LOG_INTERVAL(1000) AVB_LOG_WARNING("launch time is unsupported in simple_rawsock");
-	}
-
 	int flags = MSG_DONTWAIT;
-	send(rawsock->sock, pBuffer, len, flags);
+	if (rawsock->base.txLaunchTime && timeNsec) {
+		unsigned char cmsgbuf[TXTIME_CMSG_SPACE];
+		struct iovec iov = { pBuffer, len };
+		struct msghdr msg;
+
+		memset(&msg, 0, sizeof(msg));
+		msg.msg_iov = &iov;
+		msg.msg_iovlen = 1;
+		simpleRawsockTxTimeCmsg(&msg, cmsgbuf, timeNsec);
+		sendmsg(rawsock->sock, &msg, flags);
+	}
+	else {
+		send(rawsock->sock, pBuffer, len, flags);
+	}
 
 	AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK_DETAIL);
 	return TRUE;
@@ -337,6 +356,9 @@ int simpleRawsockSend(void *pvRawsock)
 	AVB_TRACE_ENTRY(AVB_TRACE_RAWSOCK_DETAIL);
 
 	// simpleRawsock sends frames in simpleRawsockTxFrameReady
+	if (((simple_rawsock_t*)pvRawsock)->base.txLaunchTime) {
+		simpleRawsockTxLaunchErrors(pvRawsock);
+	}
 
 	AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK_DETAIL);
 	return 1;
@@ -428,8 +450,11 @@ bool simpleRawsockRxMulticast(void *pvRawsock, bool add_membership, const U8 add
 	//	per-socket, so without the filter, this socket would receive
 	//	packets for all the multicast addresses added by all other
 	//	sockets.
-	//
-	if (add_membership)
+	if (rawsock->base.rxStreamFilter) {
+		// The stream filter already limits the socket to its streams,
+		// whatever the destination address; leave it attached.
+	}
+	else if (add_membership)
 	{
 		// Here's the template packet filter code.
 		// It was produced by running:
@@ -497,3 +522,212 @@ bool simpleRawsockRelRxFrame(void *pvRawsock, U8 *pFrame)
 {
 	return true;
 }
+
+// Filter RX frames by stream in the kernel. The filter is loaded and attached
+// on the first call; it replaces the multicast address filter.
+bool simpleRawsockRxStreamID(void *pvRawsock, bool add, const U8 streamID[8])
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_RAWSOCK);
+	base_rawsock_t *rawsock = (base_rawsock_t*)pvRawsock;
+
+	if (!VALID_RX_RAWSOCK(rawsock) || !streamID) {
+		AVB_LOG_ERROR("Setting stream filter; invalid arguments");
+		AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+		return FALSE;
+	}
+
+	if (!rawsock->rxStreamFilter) {
+		if (!add) {
+			AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+			return TRUE;
+		}
+
+		bpf_stream_filter_t *filter = bpfStreamFilterOpen();
+		if (!filter) {
+			AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+			return FALSE;
+		}
+		// Subscribe before attaching, so no frame of the stream is missed
+		if (!bpfStreamFilterSetStream(filter, TRUE, streamID)
+			|| !bpfStreamFilterAttach(filter, rawsock->cb.getSocket(pvRawsock))) {
+			bpfStreamFilterClose(filter);
+			AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+			return FALSE;
+		}
+		rawsock->rxStreamFilter = filter;
+
+		AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+		return TRUE;
+	}
+
+	bool ret = bpfStreamFilterSetStream(rawsock->rxStreamFilter, add, streamID);
+
+	AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+	return ret;
+}
+
+int simpleRawsockRxStreamCounts(void *pvRawsock, bool dropped, rawsock_stream_count_t *counts, int max)
+{
+	base_rawsock_t *rawsock = (base_rawsock_t*)pvRawsock;
+
+	if (!VALID_RX_RAWSOCK(rawsock) || !rawsock->rxStreamFilter || !counts) {
+		return 0;
+	}
+	return bpfStreamFilterCounts(rawsock->rxStreamFilter, dropped, counts, max);
+}
+
+// Enable busy polling of the device queue on reads and polls of the socket.
+// Values above net.core.busy_read need CAP_NET_ADMIN.
+bool simpleRawsockSetRxBusyPoll(void *pvRawsock, U32 usec)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_RAWSOCK);
+	base_rawsock_t *rawsock = (base_rawsock_t*)pvRawsock;
+
+	if (!VALID_RX_RAWSOCK(rawsock)) {
+		AVB_LOG_ERROR("Setting busy poll; invalid arguments");
+		AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+		return FALSE;
+	}
+
+#ifdef SO_BUSY_POLL
+	int sock = rawsock->cb.getSocket(pvRawsock);
+	int val = (int)usec;
+	if (sock < 0 || setsockopt(sock, SOL_SOCKET, SO_BUSY_POLL, &val, sizeof(val)) < 0) {
+		AVB_LOGF_WARNING("Setting SO_BUSY_POLL to %u usec failed: %s", usec, strerror(errno));
+		AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+		return FALSE;
+	}
+
+	AVB_LOGF_DEBUG("SO_BUSY_POLL set to %u usec", usec);
+	AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+	return TRUE;
+#else
+	AVB_LOG_WARNING("Setting busy poll; SO_BUSY_POLL not supported");
+	AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+	return FALSE;
+#endif
+}
+
+// Queue TX frames with a launch time for the ETF qdisc. The kernel reports
+// frames it drops for a missed or invalid launch time on the error queue.
+bool simpleRawsockTxSetLaunchTime(void *pvRawsock, bool enable)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_RAWSOCK);
+	base_rawsock_t *rawsock = (base_rawsock_t*)pvRawsock;
+
+	if (!VALID_TX_RAWSOCK(rawsock)) {
+		AVB_LOG_ERROR("Setting launch time; invalid arguments");
+		AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+		return FALSE;
+	}
+
+#ifdef SO_TXTIME
+	// Launch times are gPTP wall time, which can only be turned into CLOCK_TAI
+	// with the gPTP daemon's time data
+	U64 nowNsec, taiNsec;
+	if (enable && (!CLOCK_GETTIME64(OPENAVB_CLOCK_WALLTIME, &nowNsec)
+			|| !osalClockWalltimeToTai(nowNsec, &taiNsec))) {
+		AVB_LOG_WARNING("Setting SO_TXTIME; no gPTP time data to convert launch times to CLOCK_TAI");
+		AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+		return FALSE;
+	}
+
+	int sock = rawsock->cb.getSocket(pvRawsock);
+	struct sock_txtime txtime;
+	memset(&txtime, 0, sizeof(txtime));
+	txtime.clockid = CLOCK_TAI;
+	txtime.flags = enable ? SOF_TXTIME_REPORT_ERRORS : 0;
+	if (sock < 0 || setsockopt(sock, SOL_SOCKET, SO_TXTIME, &txtime, enable ? sizeof(txtime) : 0) < 0) {
+		AVB_LOGF_WARNING("Setting SO_TXTIME failed: %s", strerror(errno));
+		AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+		return FALSE;
+	}
+
+	rawsock->txLaunchTime = enable;
+	AVB_LOGF_DEBUG("SO_TXTIME %s", enable ? "enabled" : "disabled");
+	AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+	return TRUE;
+#else
+	AVB_LOG_WARNING("Setting launch time; SO_TXTIME not supported");
+	AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+	return !enable;
+#endif
+}
+
+void simpleRawsockTxTimeCmsg(struct msghdr *msg, unsigned char *cmsgbuf, U64 timeNsec)
+{
+#ifdef SCM_TXTIME
+	struct cmsghdr *cmsg;
+
+	if (!osalClockWalltimeToTai(timeNsec, &timeNsec)) {
+		IF_LOG_INTERVAL(1000) AVB_LOG_WARNING("No gPTP time data; sending frame without launch time");
+		msg->msg_control = NULL;
+		msg->msg_controllen = 0;
+		return;
+	}
+
+	msg->msg_control = cmsgbuf;
+	msg->msg_controllen = TXTIME_CMSG_SPACE;
+
+	cmsg = CMSG_FIRSTHDR(msg);
+	cmsg->cmsg_level = SOL_SOCKET;
+	cmsg->cmsg_type = SCM_TXTIME;
+	cmsg->cmsg_len = CMSG_LEN(sizeof(timeNsec));
+	memcpy(CMSG_DATA(cmsg), &timeNsec, sizeof(timeNsec));
+#else
+	msg->msg_control = NULL;
+	msg->msg_controllen = 0;
+#endif
+}
+
+int simpleRawsockTxLaunchErrors(void *pvRawsock)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_RAWSOCK_DETAIL);
+	base_rawsock_t *rawsock = (base_rawsock_t*)pvRawsock;
+	int count = 0;
+
+#ifdef SO_EE_ORIGIN_TXTIME
+	int sock = rawsock->cb.getSocket(pvRawsock);
+	unsigned char control[CMSG_SPACE(sizeof(struct sock_extended_err) + sizeof(struct sockaddr_ll))];
+	U8 data[64];
+
+	for (;;) {
+		struct iovec iov = { data, sizeof(data) };
+		struct msghdr msg;
+		struct cmsghdr *cmsg;
+
+		memset(&msg, 0, sizeof(msg));
+		msg.msg_iov = &iov;
+		msg.msg_iovlen = 1;
+		msg.msg_control = control;
+		msg.msg_controllen = sizeof(control);
+
+		// Only the error report matters; the frame itself is truncated
+		if (recvmsg(sock, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) {
+			break;
+		}
+
+		for (cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+			struct sock_extended_err serr;
+
+			if (cmsg->cmsg_level != SOL_PACKET || cmsg->cmsg_type != PACKET_TX_TIMESTAMP) {
+				continue;
+			}
+			memcpy(&serr, CMSG_DATA(cmsg), sizeof(serr));
+			if (serr.ee_origin != SO_EE_ORIGIN_TXTIME) {
+				continue;
+			}
+
+			rawsock->txLaunchMissed++;
+			count++;
+			IF_LOG_INTERVAL(1000) AVB_LOGF_WARNING("TX frame dropped, launch time %" PRIu64 " %s (%lu total)",
+				((U64)serr.ee_data << 32) | serr.ee_info,
+				serr.ee_code == SO_EE_CODE_TXTIME_MISSED ? "missed" : "invalid",
+				rawsock->txLaunchMissed);
+		}
+	}
+#endif
+
+	AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK_DETAIL);
+	return count;
+}
@@ -32,8 +32,13 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #ifndef SIMPLE_RAWSOCK_H
 #define SIMPLE_RAWSOCK_H
 
+#include <sys/socket.h>
+
 #include "rawsock_impl.h"
 
+// Control message space for a TX launch time
+#define TXTIME_CMSG_SPACE CMSG_SPACE(sizeof(U64))
+
 // State information for raw socket
 //
 typedef struct {
@@ -89,4 +94,23 @@ int  simpleRawsockGetSocket(void *pvRawsock);
 
 bool simpleRawsockRelRxFrame(void *pvRawsock, U8 *pFrame);
 
+// Filter RX frames by stream_id in the kernel (eBPF socket filter); shared by
+// the socket based implementations
+bool simpleRawsockRxStreamID(void *pvRawsock, bool add, const U8 streamID[8]);
+int simpleRawsockRxStreamCounts(void *pvRawsock, bool dropped, rawsock_stream_count_t *counts, int max);
+
+// Enable SO_BUSY_POLL on the socket; shared by the socket based implementations
+bool simpleRawsockSetRxBusyPoll(void *pvRawsock, U32 usec);
+
+// Enable SO_TXTIME launch times on the socket; shared by the socket based implementations
+bool simpleRawsockTxSetLaunchTime(void *pvRawsock, bool enable);
+
+// Attach a SCM_TXTIME control message for timeNsec, gPTP wall time converted to
+// CLOCK_TAI, to msg. cmsgbuf must hold TXTIME_CMSG_SPACE bytes.
+void simpleRawsockTxTimeCmsg(struct msghdr *msg, unsigned char *cmsgbuf, U64 timeNsec);
+
+// Read the launch time errors queued by the kernel (frames dropped by the ETF
+// qdisc) and count them. Returns the number read.
+int simpleRawsockTxLaunchErrors(void *pvRawsock);
+
 #endif
@@ -33,6 +33,7 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #include <string.h>
 #include <errno.h>
 #include <ctype.h>
+#include <time.h>
 
 #include <unistd.h>
 #include <pthread.h>
@@ -50,6 +51,7 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #include "openavb_mediaq.h"
 #include "openavb_tl.h"
 #include "openavb_avtp.h"
+#include "openavb_placement.h"
 
 #define	AVB_LOG_COMPONENT	"Talker / Listener"
 #include "openavb_log.h"
@@ -63,6 +65,37 @@ typedef struct {
 	openavb_tl_cfg_name_value_t *pNVCfg;
 } parse_ini_data_t;
 
+// Initialize function lookups, shared by every stream using the same plugin.
+// A host running hundreds of streams resolves each plugin once instead of
+// once per stream; with dynamic plugins the library handle is kept here too
+// so a library is only opened once, and stays open for the life of the process.
+#define TL_PLUGIN_CACHE_SIZE 32
+typedef struct {
+	char *libName;
+	char *funcName;
+	void *libHandle;
+	void *pInitFn;
+} tl_plugin_cache_entry_t;
+
+static tl_plugin_cache_entry_t x_pluginCache[TL_PLUGIN_CACHE_SIZE];
+static int x_pluginCacheCount = 0;
+static pthread_mutex_t x_pluginCacheMutex = PTHREAD_MUTEX_INITIALIZER;
+
+// Per-interface results of the checks done while reading an INI file. All
+// streams of a host normally share one or two interfaces, so the interface
+// is validated, and a raw socket opened to learn its MAC address, only once.
+#define TL_IF_CACHE_SIZE 8
+typedef struct {
+	char ifname[IFNAMSIZ + 10];
+	bool bValid;
+	bool bMacValid;
+	U8 mac[ETH_ALEN];
+} tl_if_cache_entry_t;
+
+static tl_if_cache_entry_t x_ifCache[TL_IF_CACHE_SIZE];
+static int x_ifCacheCount = 0;
+static pthread_mutex_t x_ifCacheMutex = PTHREAD_MUTEX_INITIALIZER;
+
 static bool parse_mac(const char *str, cfg_mac_t *mac)
 {
 	memset(&mac->buffer, 0, sizeof(struct ether_addr));
@@ -75,78 +108,163 @@ static bool parse_mac(const char *str, cfg_mac_t *mac)
 	return FALSE;
 }
 
-static bool openMapLib(tl_state_t *pTLState)
+static bool sameName(const char *a, const char *b)
 {
-// OpenAVB using static mapping plugins therefore don't attempt to open a library
+	if (!a || !b)
+		return a == b;
+	return strcmp(a, b) == 0;
+}
+
+// Resolve an initialize function, consulting the plugin cache first.
+// Returns NULL (and logs) if the function cannot be found.
+static void *lookupPluginInitFn(const char *libName, const char *funcName, const char *kind)
+{
+	void *pInitFn = NULL;
+	int i1;
+
+	pthread_mutex_lock(&x_pluginCacheMutex);
+
+	for (i1 = 0; i1 < x_pluginCacheCount; i1++) {
+		if (sameName(x_pluginCache[i1].libName, libName) && strcmp(x_pluginCache[i1].funcName, funcName) == 0) {
+			pInitFn = x_pluginCache[i1].pInitFn;
+			pthread_mutex_unlock(&x_pluginCacheMutex);
+			return pInitFn;
+		}
+	}
+
+	void *libHandle = NULL;
+// OpenAVB using static plugins therefore don't attempt to open a library
 #if 0
 	// Opening library
-	if (pTLState->mapLib.libName) {
-		AVB_LOGF_INFO("Attempting to open library: %s", pTLState->mapLib.libName);
-		pTLState->mapLib.libHandle = dlopen(pTLState->mapLib.libName, RTLD_LAZY);
-		if (!pTLState->mapLib.libHandle) {
-			AVB_LOG_ERROR("Unable to open the mapping library.");
-			return FALSE;
+	if (libName) {
+		AVB_LOGF_INFO("Attempting to open library: %s", libName);
+		libHandle = dlopen(libName, RTLD_LAZY);
+		if (!libHandle) {
+			AVB_LOGF_ERROR("Unable to open the %s library.", kind);
+			pthread_mutex_unlock(&x_pluginCacheMutex);
+			return NULL;
 		}
 	}
 #endif
 
+	char *error;
+	AVB_LOGF_INFO("Looking up symbol for function: %s", funcName);
+	dlerror();
+	pInitFn = dlsym(libHandle ? libHandle : RTLD_DEFAULT, funcName);
+	if ((error = dlerror()) != NULL)  {
+		AVB_LOGF_ERROR("%s initialize function lookup error: %s.", kind, error);
+		if (libHandle)
+			dlclose(libHandle);
+		pthread_mutex_unlock(&x_pluginCacheMutex);
+		return NULL;
+	}
+
+	if (x_pluginCacheCount < TL_PLUGIN_CACHE_SIZE) {
+		tl_plugin_cache_entry_t *pEntry = &x_pluginCache[x_pluginCacheCount];
+		pEntry->libName = libName ? strdup(libName) : NULL;
+		pEntry->funcName = strdup(funcName);
+		pEntry->libHandle = libHandle;
+		pEntry->pInitFn = pInitFn;
+		if (pEntry->funcName && (pEntry->libName || !libName)) {
+			x_pluginCacheCount++;
+		}
+		else {
+			free(pEntry->libName);
+			free(pEntry->funcName);
+		}
+	}
+
+	pthread_mutex_unlock(&x_pluginCacheMutex);
+	return pInitFn;
+}
+
+static bool openMapLib(tl_state_t *pTLState)
+{
 	// Looking up function entry
 	if (!pTLState->mapLib.funcName) {
 		AVB_LOG_ERROR("Mapping initialize function not set.");
 		return FALSE;
 	}
 
-	char *error;
-	AVB_LOGF_INFO("Looking up symbol for function: %s", pTLState->mapLib.funcName);
-	if (pTLState->mapLib.libHandle) {
-		pTLState->cfg.pMapInitFn = dlsym(pTLState->mapLib.libHandle, pTLState->mapLib.funcName);
-	}
-	else {
-		pTLState->cfg.pMapInitFn = dlsym(RTLD_DEFAULT, pTLState->mapLib.funcName);
-	}
-	if ((error = dlerror()) != NULL)  {
-		AVB_LOGF_ERROR("Mapping initialize function lookup error: %s.", error);
+	pTLState->cfg.pMapInitFn = lookupPluginInitFn(pTLState->mapLib.libName, pTLState->mapLib.funcName, "Mapping");
+	return pTLState->cfg.pMapInitFn != NULL;
+}
+
+static bool openIntfLib(tl_state_t *pTLState)
+{
+	// Looking up function entry
+	if (!pTLState->intfLib.funcName) {
+		AVB_LOG_ERROR("Interface initialize function not set.");
 		return FALSE;
 	}
 
-	return TRUE;
+	pTLState->cfg.pIntfInitFn = lookupPluginInitFn(pTLState->intfLib.libName, pTLState->intfLib.funcName, "Interface");
+	return pTLState->cfg.pIntfInitFn != NULL;
 }
 
-static bool openIntfLib(tl_state_t *pTLState)
+// Cache entry for an interface, or NULL. Called with x_ifCacheMutex held.
+static tl_if_cache_entry_t *ifCacheEntry(const char *ifname)
 {
-// OpenAVB using static interface plugins therefore don't attempt to open a library
-#if 0
-	// Opening library
-	if (pTLState->intfLib.libName) {
-		AVB_LOGF_INFO("Attempting to open library: %s", pTLState->intfLib.libName);
-		pTLState->intfLib.libHandle = dlopen(pTLState->intfLib.libName, RTLD_LAZY);
-		if (!pTLState->intfLib.libHandle) {
-			AVB_LOG_ERROR("Unable to open the interface library.");
-			return FALSE;
+	int i1;
+	for (i1 = 0; i1 < x_ifCacheCount; i1++) {
+		if (strcmp(x_ifCache[i1].ifname, ifname) == 0) {
+			return &x_ifCache[i1];
 		}
 	}
-#endif
+	return NULL;
+}
 
-	// Looking up function entry
-	if (!pTLState->intfLib.funcName) {
-		AVB_LOG_ERROR("Interface initialize function not set.");
-		return FALSE;
+static bool checkInterfaceCached(const char *ifname)
+{
+	pthread_mutex_lock(&x_ifCacheMutex);
+
+	tl_if_cache_entry_t *pEntry = ifCacheEntry(ifname);
+	if (!pEntry) {
+		if_info_t ifinfo;
+		bool bValid = openavbCheckInterface(ifname, &ifinfo);
+		if (!bValid || x_ifCacheCount >= TL_IF_CACHE_SIZE) {
+			// Failures are not cached so a late interface is picked up on retry
+			pthread_mutex_unlock(&x_ifCacheMutex);
+			return bValid;
+		}
+		pEntry = &x_ifCache[x_ifCacheCount++];
+		memset(pEntry, 0, sizeof(*pEntry));
+		strncpy(pEntry->ifname, ifname, sizeof(pEntry->ifname) - 1);
+		pEntry->bValid = TRUE;
 	}
 
-	char *error;
-	AVB_LOGF_INFO("Looking up symbol for function: %s", pTLState->intfLib.funcName);
-	if (pTLState->intfLib.libHandle) {
-		pTLState->cfg.pIntfInitFn = dlsym(pTLState->intfLib.libHandle, pTLState->intfLib.funcName);
+	pthread_mutex_unlock(&x_ifCacheMutex);
+	return TRUE;
+}
+
+static bool getInterfaceMacCached(const char *ifname, U8 *mac)
+{
+	bool bOk = FALSE;
+
+	pthread_mutex_lock(&x_ifCacheMutex);
+
+	tl_if_cache_entry_t *pEntry = ifCacheEntry(ifname);
+	if (pEntry && pEntry->bMacValid) {
+		memcpy(mac, pEntry->mac, ETH_ALEN);
+		pthread_mutex_unlock(&x_ifCacheMutex);
+		return TRUE;
 	}
-	else {
-		pTLState->cfg.pIntfInitFn = dlsym(RTLD_DEFAULT, pTLState->intfLib.funcName);
+
+	// Open a rawsock may be the easiest cross platform way to get the MAC address.
+	void *txSock = openavbRawsockOpen(ifname, FALSE, TRUE, ETHERTYPE_AVTP, 100, 1);
+	if (txSock) {
+		bOk = openavbRawsockGetAddr(txSock, mac);
+		openavbRawsockClose(txSock);
+		txSock = NULL;
 	}
-	if ((error = dlerror()) != NULL)  {
-		AVB_LOGF_ERROR("Interface initialize function lookup error: %s.", error);
-		return FALSE;
+
+	if (bOk && pEntry) {
+		memcpy(pEntry->mac, mac, ETH_ALEN);
+		pEntry->bMacValid = TRUE;
 	}
 
-	return TRUE;
+	pthread_mutex_unlock(&x_ifCacheMutex);
+	return bOk;
 }
 
 // callback function - called for each name/value pair by ini parsing library
@@ -350,6 +468,73 @@ static int openavbTLCfgCallback(void *user, const char *tlSection, const char *n
 			valOK = TRUE;
 		}
 	}
+	else if (MATCH(name, "rx_busy_poll_usec")) {
+		errno = 0;
+		long tmp;
+		tmp = strtol(value, &pEnd, 0);
+		if (*pEnd == '\0' && errno == 0 && tmp >= 0) {
+			pCfg->rx_busy_poll_usec = tmp;
+			valOK = TRUE;
+		}
+	}
+	else if (MATCH(name, "rx_stream_filter")) {
+		errno = 0;
+		long tmp;
+		tmp = strtol(value, &pEnd, 0);
+		if (*pEnd == '\0' && errno == 0) {
+			pCfg->rx_stream_filter = (tmp == 1);
+			valOK = TRUE;
+		}
+	}
+	else if (MATCH(name, "tx_launch_time")) {
+		errno = 0;
+		long tmp;
+		tmp = strtol(value, &pEnd, 0);
+		if (*pEnd == '\0' && errno == 0) {
+			pCfg->tx_launch_time = (tmp == 1);
+			valOK = TRUE;
+		}
+	}
+	else if (MATCH(name, "tas_gcl")) {
+		strncpy(pCfg->tas_gcl, value, sizeof(pCfg->tas_gcl) - 1);
+		valOK = TRUE;
+	}
+	else if (MATCH(name, "tas_base_time")) {
+		errno = 0;
+		unsigned long long tmp;
+		tmp = strtoull(value, &pEnd, 0);
+		if (*pEnd == '\0' && errno == 0) {
+			pCfg->tas_base_time = tmp;
+			valOK = TRUE;
+		}
+	}
+	else if (MATCH(name, "tas_cycle_time")) {
+		errno = 0;
+		unsigned long long tmp;
+		tmp = strtoull(value, &pEnd, 0);
+		if (*pEnd == '\0' && errno == 0) {
+			pCfg->tas_cycle_time = tmp;
+			valOK = TRUE;
+		}
+	}
+	else if (MATCH(name, "tas_traffic_class")) {
+		errno = 0;
+		long tmp;
+		tmp = strtol(value, &pEnd, 0);
+		if (*pEnd == '\0' && errno == 0 && tmp >= 0 && tmp < 8) {
+			pCfg->tas_traffic_class = tmp;
+			valOK = TRUE;
+		}
+	}
+	else if (MATCH(name, "tas_link_mbps")) {
+		errno = 0;
+		long tmp;
+		tmp = strtol(value, &pEnd, 0);
+		if (*pEnd == '\0' && errno == 0 && tmp > 0) {
+			pCfg->tas_link_mbps = tmp;
+			valOK = TRUE;
+		}
+	}
 	else if (MATCH(name, "tx_blocking_in_intf")) {
 		errno = 0;
 		long tmp;
@@ -377,6 +562,24 @@ static int openavbTLCfgCallback(void *user, const char *tlSection, const char *n
 			valOK = TRUE;
 		}
 	}
+	else if (MATCH(name, "queue_placement")) {
+		errno = 0;
+		long tmp;
+		tmp = strtol(value, &pEnd, 0);
+		if (*pEnd == '\0' && errno == 0) {
+			pCfg->queue_placement = (tmp == 1);
+			valOK = TRUE;
+		}
+	}
+	else if (MATCH(name, "nic_queue")) {
+		errno = 0;
+		long tmp;
+		tmp = strtol(value, &pEnd, 0);
+		if (*pEnd == '\0' && errno == 0 && tmp >= -1 && tmp < OPENAVB_PLACEMENT_MAX_QUEUES) {
+			pCfg->nic_queue = tmp;
+			valOK = TRUE;
+		}
+	}
 
 	else if (MATCH(name, "friendly_name")) {
 		strncpy(pCfg->friendly_name, value, FRIENDLY_NAME_SIZE - 1);
@@ -485,8 +688,7 @@ EXTERN_DLL_EXPORT bool openavbTLReadIniFileOsal(tl_handle_t TLhandle, const char
 
 	int result = ini_parse(fileName, openavbTLCfgCallback, &parseIniData);
 	if (result == 0) {
-		if_info_t ifinfo;
-		if (pCfg->ifname[0] && !openavbCheckInterface(parseIniData.pCfg->ifname, &ifinfo)) {
+		if (pCfg->ifname[0] && !checkInterfaceCached(parseIniData.pCfg->ifname)) {
 			AVB_LOGF_ERROR("Invalid value: name=%s, value=%s", "ifname", parseIniData.pCfg->ifname);
 			AVB_TRACE_EXIT(AVB_TRACE_TL);
 			return FALSE;
@@ -507,14 +709,8 @@ EXTERN_DLL_EXPORT bool openavbTLReadIniFileOsal(tl_handle_t TLhandle, const char
 	if (parseIniData.pCfg->role == AVB_ROLE_TALKER &&
 	    (!parseIniData.pCfg->stream_addr.mac || memcmp(parseIniData.pCfg->stream_addr.mac, "\x00\x00\x00\x00\x00\x00", 6) == 0))
 	{
-		// Open a rawsock may be the easiest cross platform way to get the MAC address.
-		void *txSock = openavbRawsockOpen(parseIniData.pCfg->ifname, FALSE, TRUE, ETHERTYPE_AVTP, 100, 1);
-		if (txSock) {
-			if (openavbRawsockGetAddr(txSock, parseIniData.pCfg->stream_addr.buffer.ether_addr_octet)) {
-				parseIniData.pCfg->stream_addr.mac = &(parseIniData.pCfg->stream_addr.buffer); // Indicate that the MAC Address is valid.
-			}
-			openavbRawsockClose(txSock);
-			txSock = NULL;
+		if (getInterfaceMacCached(parseIniData.pCfg->ifname, parseIniData.pCfg->stream_addr.buffer.ether_addr_octet)) {
+			parseIniData.pCfg->stream_addr.mac = &(parseIniData.pCfg->stream_addr.buffer); // Indicate that the MAC Address is valid.
 		}
 
 		if (!parseIniData.pCfg->stream_addr.mac || memcmp(parseIniData.pCfg->stream_addr.mac, "\x00\x00\x00\x00\x00\x00", 6) == 0) {
@@ -566,4 +762,181 @@ bool openavbTLCloseLinkLibsOsal(tl_state_t *pTLState)
 	return TRUE;
 }
 
+#define TL_STARTUP_MIN_DEFAULT_WORKERS 4
+
+// Work shared by the startup worker threads. Streams are handed out through
+// an atomic index so a slow INI file or plugin init does not stall a worker.
+typedef struct {
+	tl_handle_t *pHandles;
+	const char **iniFiles;
+	openavb_tl_cfg_t *pCfgs;
+	openavb_tl_cfg_name_value_t *pNVCfgs;
+	bool *pOk;
+	U32 count;
+	bool bConfigure;
+	volatile U32 next;
+} tl_startup_work_t;
+
+static void *startupWorker(void *pv)
+{
+	tl_startup_work_t *pWork = (tl_startup_work_t *)pv;
+
+	while (TRUE) {
+		U32 i1 = __sync_fetch_and_add(&pWork->next, 1);
+		if (i1 >= pWork->count)
+			break;
+		if (!pWork->pOk[i1])
+			continue;
+
+		if (!pWork->bConfigure) {
+			openavbTLInitCfg(&pWork->pCfgs[i1]);
+			if (!openavbTLReadIniFileOsal(pWork->pHandles[i1], pWork->iniFiles[i1], &pWork->pCfgs[i1], &pWork->pNVCfgs[i1])) {
+				AVB_LOGF_ERROR("Error reading ini file: %s", pWork->iniFiles[i1]);
+				pWork->pOk[i1] = FALSE;
+			}
+		}
+		else {
+			if (!openavbTLConfigure(pWork->pHandles[i1], &pWork->pCfgs[i1], &pWork->pNVCfgs[i1])) {
+				AVB_LOGF_ERROR("Error configuring: %s", pWork->iniFiles[i1]);
+				pWork->pOk[i1] = FALSE;
+			}
+		}
+	}
+
+	return NULL;
+}
+
+// Run one startup phase over all streams on nWorkers threads (the caller is one of them)
+static void startupRunPhase(tl_startup_work_t *pWork, bool bConfigure, U32 nWorkers)
+{
+	pthread_t threads[TL_STARTUP_MAX_WORKERS];
+	U32 nThreads = 0;
+	U32 i1;
+
+	pWork->bConfigure = bConfigure;
+	pWork->next = 0;
+	__sync_synchronize();
+
+	for (i1 = 1; i1 < nWorkers; i1++) {
+		if (pthread_create(&threads[nThreads], NULL, startupWorker, pWork) != 0) {
+			AVB_LOG_WARNING("Unable to create startup worker; continuing with fewer workers");
+			break;
+		}
+		nThreads++;
+	}
+	startupWorker(pWork);
+	for (i1 = 0; i1 < nThreads; i1++) {
+		pthread_join(threads[i1], NULL);
+	}
+}
+
+static U64 startupElapsedUsec(struct timespec *pStart)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (U64)(now.tv_sec - pStart->tv_sec) * 1000000ULL + (now.tv_nsec - pStart->tv_nsec) / 1000;
+}
+
+EXTERN_DLL_EXPORT bool openavbTLStartBatchOsal(tl_handle_t *pHandles, const char **iniFiles, U32 count, U32 nWorkers, openavb_tl_startup_stats_t *pStats)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TL);
+
+	openavb_tl_startup_stats_t stats;
+	struct timespec start, phase;
+	U32 i1, i2;
+
+	memset(&stats, 0, sizeof(stats));
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	if (pStats)
+		*pStats = stats;
+
+	if (!pHandles || !iniFiles) {
+		AVB_TRACE_EXIT(AVB_TRACE_TL);
+		return FALSE;
+	}
 
+	if (nWorkers == 0) {
+		// Plugin init often blocks on devices and files, so use a few workers even on small CPUs
+		long nCpus = sysconf(_SC_NPROCESSORS_ONLN);
+		nWorkers = nCpus > TL_STARTUP_MIN_DEFAULT_WORKERS ? (U32)nCpus : TL_STARTUP_MIN_DEFAULT_WORKERS;
+	}
+	if (nWorkers > TL_STARTUP_MAX_WORKERS)
+		nWorkers = TL_STARTUP_MAX_WORKERS;
+	if (nWorkers > count)
+		nWorkers = count ? count : 1;
+
+	tl_startup_work_t work;
+	memset(&work, 0, sizeof(work));
+	work.pHandles = pHandles;
+	work.iniFiles = iniFiles;
+	work.count = count;
+	work.pCfgs = calloc(count ? count : 1, sizeof(openavb_tl_cfg_t));
+	work.pNVCfgs = calloc(count ? count : 1, sizeof(openavb_tl_cfg_name_value_t));
+	work.pOk = calloc(count ? count : 1, sizeof(bool));
+	if (!work.pCfgs || !work.pNVCfgs || !work.pOk) {
+		AVB_LOG_ERROR("Unable to allocate startup state");
+		free(work.pCfgs);
+		free(work.pNVCfgs);
+		free(work.pOk);
+		AVB_TRACE_EXIT(AVB_TRACE_TL);
+		return FALSE;
+	}
+
+	// Open: registers each handle in the shared talker/listener list
+	for (i1 = 0; i1 < count; i1++) {
+		pHandles[i1] = openavbTLOpen();
+		work.pOk[i1] = pHandles[i1] != NULL;
+	}
+	stats.openUsec = startupElapsedUsec(&start);
+
+	// Parse all INI files
+	clock_gettime(CLOCK_MONOTONIC, &phase);
+	startupRunPhase(&work, FALSE, nWorkers);
+	stats.parseUsec = startupElapsedUsec(&phase);
+
+	// Configure: plugin init and media queue allocation
+	clock_gettime(CLOCK_MONOTONIC, &phase);
+	startupRunPhase(&work, TRUE, nWorkers);
+	stats.configureUsec = startupElapsedUsec(&phase);
+
+	for (i1 = 0; i1 < count; i1++) {
+		for (i2 = 0; i2 < work.pNVCfgs[i1].nLibCfgItems; i2++) {
+			free(work.pNVCfgs[i1].libCfgNames[i2]);
+			free(work.pNVCfgs[i1].libCfgValues[i2]);
+		}
+		if (work.pOk[i1])
+			stats.nConfigured++;
+	}
+
+	// Run any streams where the stop initial state was not requested.
+	// Only thread creation happens here; the streams come up concurrently.
+	clock_gettime(CLOCK_MONOTONIC, &phase);
+	if (stats.nConfigured == count) {
+		for (i1 = 0; i1 < count; i1++) {
+			if (openavbTLGetInitialState(pHandles[i1]) != TL_INIT_STATE_STOPPED) {
+				openavbTLRun(pHandles[i1]);
+			}
+		}
+	}
+	stats.runUsec = startupElapsedUsec(&phase);
+
+	stats.nStreams = count;
+	stats.nWorkers = nWorkers;
+	stats.totalUsec = startupElapsedUsec(&start);
+
+	AVB_LOGF_INFO("Startup of %u streams (%u configured) on %u workers took %llu usec (open %llu, parse %llu, configure %llu, run %llu)",
+		count, stats.nConfigured, nWorkers,
+		(unsigned long long)stats.totalUsec, (unsigned long long)stats.openUsec,
+		(unsigned long long)stats.parseUsec, (unsigned long long)stats.configureUsec,
+		(unsigned long long)stats.runUsec);
+
+	if (pStats)
+		*pStats = stats;
+
+	free(work.pCfgs);
+	free(work.pNVCfgs);
+	free(work.pOk);
+
+	AVB_TRACE_EXIT(AVB_TRACE_TL);
+	return stats.nConfigured == count;
+}
@@ -64,6 +64,10 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 inline static void xSleepUntilNSec(U64 nSec)
 {
         U64 nowNS;
+        if (osalTimeSource) {
+                osalTimeSource->sleepUntil(osalTimeSource->pCtx, OPENAVB_CLOCK_WALLTIME, nSec);
+                return;
+        }
         while (TRUE) {
                 CLOCK_GETTIME64(OPENAVB_CLOCK_WALLTIME, &nowNS);
                 if (nowNS >= nSec)
@@ -76,6 +80,11 @@ inline static void xSleepUntilNSec(U64 nSec)
 #define SPIN_UNTIL_NSEC(nsec)					xSpinUntilNSec(nsec)
 inline static void xSpinUntilNSec(U64 nSec)
 {
+	if (osalTimeSource) {
+		osalTimeSource->sleepUntil(osalTimeSource->pCtx, OPENAVB_CLOCK_WALLTIME, nSec);
+		return;
+	}
+
 	do {
 		U64 spinNowNS;
 		CLOCK_GETTIME64(OPENAVB_CLOCK_WALLTIME, &spinNowNS);
@@ -35,6 +35,8 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #include "openavb_platform.h"
 #include "openavb_osal.h"
 #include "openavb_qmgr.h"
+#include "openavb_arena.h"
+#include "openavb_placement.h"
 #include "openavb_avdecc.h"
 
 #define	AVB_LOG_COMPONENT	"osal"
@@ -66,6 +68,8 @@ extern DLL_EXPORT bool osalAvdeccInitialize(const char* logfilename, const char*
 
 	avbLogInitEx(s_logfile);
 	osalAVBTimeInit();
+	openavbArenaInitialize();
+	openavbPlacementInitialize();
 	if (!osalAVBGrandmasterInit()) { return FALSE; }
 	if (!startAvdecc(ifname, inifiles, numfiles)) { return FALSE; }
 	return TRUE;
@@ -75,6 +79,8 @@ extern DLL_EXPORT bool osalAvdeccFinalize(void)
 {
         stopAvdecc();
         osalAVBGrandmasterClose();
+        openavbPlacementFinalize();
+        openavbArenaFinalize();
         osalAVBTimeClose();
         avbLogExit();
 
@@ -0,0 +1,86 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* MODULE SUMMARY : Windows stubs for the placement of streams.
+*
+* NIC queue topology is not available, so streams are only spread over the
+* cores the process may run on.
+*/
+
+#include <windows.h>
+#include "openavb_platform.h"
+#include "openavb_placement_osal.h"
+
+int osalPlacementQueueCount(const char *ifname, bool tx)
+{
+	return 0;
+}
+
+openavb_placement_cpu_t osalPlacementQueueCpus(const char *ifname, bool tx, int queue, openavb_cpu_mask_t *pMask)
+{
+	memset(pMask, 0, sizeof(*pMask));
+	return OPENAVB_PLACEMENT_CPU_NONE;
+}
+
+bool osalPlacementAllowedCpus(openavb_cpu_mask_t *pMask)
+{
+	DWORD_PTR processMask, systemMask;
+	int cpu;
+
+	memset(pMask, 0, sizeof(*pMask));
+	if (!GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask)) {
+		return FALSE;
+	}
+	for (cpu = 0; cpu < (int)(sizeof(processMask) * 8); cpu++) {
+		if (processMask & ((DWORD_PTR)1 << cpu)) {
+			OPENAVB_CPU_MASK_SET(pMask, cpu);
+		}
+	}
+	return TRUE;
+}
+
+int osalPlacementAddRxRule(const char *ifname, const U8 destAddr[ETH_ALEN], int queue)
+{
+	return -1;
+}
+
+void osalPlacementDelRxRule(const char *ifname, int location)
+{
+}
+
+bool osalPlacementPinThread(int cpu)
+{
+	if (cpu >= (int)(sizeof(DWORD_PTR) * 8)) {
+		return FALSE;
+	}
+	return SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu) != 0;
+}
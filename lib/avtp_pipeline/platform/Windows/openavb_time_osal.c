@@ -10,6 +10,7 @@
 
 static LARGE_INTEGER gFreq;
 static BOOL gInit = FALSE;
+const openavb_time_source_t *osalTimeSource = NULL;
 
 bool osalAVBTimeInit(void)
 {
@@ -31,8 +32,22 @@ static void perfToTimespec(LARGE_INTEGER counter, struct timespec *ts)
     ts->tv_nsec = (long)((secs - ts->tv_sec) * 1e9);
 }
 
+void osalSetTimeSource(const openavb_time_source_t *pTimeSource)
+{
+    osalTimeSource = pTimeSource;
+}
+
 bool osalClockGettime(openavb_clockId_t clockId, struct timespec *tp)
 {
+    if (osalTimeSource) {
+        U64 ns;
+        if (!osalTimeSource->getTime(osalTimeSource->pCtx, clockId, &ns))
+            return FALSE;
+        tp->tv_sec = (long)(ns / 1000000000ULL);
+        tp->tv_nsec = (long)(ns % 1000000000ULL);
+        return TRUE;
+    }
+
     if (!gInit && !osalAVBTimeInit())
         return FALSE;
 
@@ -52,6 +67,8 @@ bool osalClockGettime(openavb_clockId_t clockId, struct timespec *tp)
 bool osalClockGettime64(openavb_clockId_t clockId, U64 *ns)
 {
     struct timespec ts;
+    if (osalTimeSource)
+        return osalTimeSource->getTime(osalTimeSource->pCtx, clockId, ns);
     if (!osalClockGettime(clockId, &ts))
         return FALSE;
     *ns = ((U64)ts.tv_sec * 1000000000ULL) + ts.tv_nsec;
@@ -56,6 +56,22 @@ typedef enum {
 #define CLOCK_GETTIME(arg1, arg2) osalClockGettime(arg1, arg2)
 #define CLOCK_GETTIME64(arg1, arg2) osalClockGettime64(arg1, arg2)
 
+// Source of time used in place of the OS clocks and gPTP, such as the virtual
+// clock of a simulation. getTime reads a clock; sleepUntil blocks the calling
+// thread until that clock reaches timeNsec.
+typedef struct {
+	bool (*getTime)(void *pCtx, openavb_clockId_t openavbClockId, U64 *timeNsec);
+	void (*sleepUntil)(void *pCtx, openavb_clockId_t openavbClockId, U64 timeNsec);
+	void *pCtx;
+} openavb_time_source_t;
+
+// Time source in use, NULL for the OS clocks
+extern const openavb_time_source_t *osalTimeSource;
+
+// Install a time source, or go back to the OS clocks with NULL. The pointer is
+// read without locking, so set it before any stream threads are started.
+void osalSetTimeSource(const openavb_time_source_t *pTimeSource);
+
 // Initialize the AVB Time system for client usage
 bool osalAVBTimeInit(void);
 
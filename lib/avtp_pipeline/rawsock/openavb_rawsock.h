@@ -105,6 +105,15 @@ U8 *openavbRawsockGetRxFrame(void *rawsock,	// rawsock handle
 						 U32 *offset,	// offset of frame in the frame buffer
 						 U32 *len);		// returns length of received frame
 
+// Check, without blocking or a system call where the implementation allows it,
+// whether a received frame is waiting. Used to spin on the socket for low latency.
+// Implementations that can't tell cheaply always return TRUE.
+bool openavbRawsockRxFramePending(void *rawsock);
+
+// Let the kernel busy poll the device queue for up to usec while the socket is
+// read or polled (SO_BUSY_POLL). Returns FALSE if not supported or not permitted.
+bool openavbRawsockSetRxBusyPoll(void *rawsock, U32 usec);
+
 // Parse the frame header.  Returns length of header, or -1 for failure
 int openavbRawsockRxParseHdr(void* rawsock, U8 *pBuffer, hdr_info_t *pInfo);
 
@@ -118,6 +127,23 @@ bool openavbRawsockRxMulticast(void *rawsock, bool add_membership, const U8 buf[
 //  delivery the same packet to multiple sockets. 
 bool openavbRawsockRxAVTPSubtype(void *rawsock, U8 subtype);
 
+// Frame count for one stream
+typedef struct {
+	U8 streamID[8];		// network order
+	U64 frames;
+} rawsock_stream_count_t;
+
+// Receive only the AVTP frames of the given streams (streamID in network
+// order), dropping all others in the kernel before they reach the socket.
+// The first call replaces the multicast address filter. Returns FALSE if the
+// implementation or the kernel can't filter; frames are then not filtered by
+// stream.
+bool openavbRawsockRxStreamID(void *rawsock, bool add, const U8 streamID[8]);
+
+// Kernel filter counters: frames passed per subscribed stream, or frames
+// dropped per other stream. Returns the number of entries filled, at most max.
+int openavbRawsockRxStreamCounts(void *rawsock, bool dropped, rawsock_stream_count_t *counts, int max);
+
 // TX FUNCTIONS
 //
 // Setup the header that we'll use on TX Ethernet frames.
@@ -148,6 +174,14 @@ bool openavbRawsockTxFrameReady(void *rawsock,	// rawsock handle
 							U32 len,	// length of frame to send
 							U64 timeNsec);	// launch time (in gPTP wall clock)
 
+// Queue TX frames with the launch time passed to openavbRawsockTxFrameReady
+// instead of sending them right away. On Linux this is SO_TXTIME with
+// CLOCK_TAI, for an ETF qdisc on the interface; launch times are converted
+// from gPTP with the gPTP daemon's time data.
+// Returns FALSE if the implementation or the kernel can't do it, or if there
+// is no gPTP time data.
+bool openavbRawsockTxSetLaunchTime(void *rawsock, bool enable);
+
 // Send all packets that are marked "ready to send".
 // Returns count of bytes in sent frames - or < 0 for error.
 int openavbRawsockSend(void *rawsock);
@@ -164,4 +198,8 @@ unsigned long openavbRawsockGetTXOutOfBuffers(void *pvRawsock);
 // returns number of TX out of buffer events noticed from the last reporting period
 unsigned long openavbRawsockGetTXOutOfBuffersCyclic(void *pvRawsock);
 
+// returns number of TX frames dropped by the kernel because their launch time
+// was missed or invalid
+unsigned long openavbRawsockGetTXLaunchMissed(void *pvRawsock);
+
 #endif // RAWSOCK_H
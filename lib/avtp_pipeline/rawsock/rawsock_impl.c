@@ -31,6 +31,7 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 
 #include "rawsock_impl.h"
 #include "openavb_trace.h"
+#include "openavb_arena.h"
 
 #define	AVB_LOG_COMPONENT	"Raw Socket"
 #include "openavb_log.h"
@@ -50,6 +51,12 @@ int baseRawsockTxBufLevel(void *rawsock) { return -1; }
 int baseRawsockRxBufLevel(void *rawsock) { return -1; }
 unsigned long baseRawsockGetTXOutOfBuffers(void *pvRawsock) { return 0; }
 unsigned long baseRawsockGetTXOutOfBuffersCyclic(void *pvRawsock) { return 0; }
+bool baseRawsockSetRxBusyPoll(void *rawsock, U32 usec) { return false; }
+// Without a cheap way to peek, report a frame so the caller tries a non-blocking read
+bool baseRawsockRxFramePending(void *rawsock) { return true; }
+bool baseRawsockTxSetLaunchTime(void *rawsock, bool enable) { return !enable; }
+bool baseRawsockRxStreamID(void *rawsock, bool add, const U8 streamID[8]) { return false; }
+int baseRawsockRxStreamCounts(void *rawsock, bool dropped, rawsock_stream_count_t *counts, int max) { return 0; }
 
 void* baseRawsockOpen(base_rawsock_t* rawsock, const char *ifname, bool rx_mode, bool tx_mode, U16 ethertype, U32 frame_size, U32 num_frames)
 {
@@ -82,6 +89,11 @@ void* baseRawsockOpen(base_rawsock_t* rawsock, const char *ifname, bool rx_mode,
 	cb->rxBufLevel = baseRawsockRxBufLevel;
 	cb->getTXOutOfBuffers = baseRawsockGetTXOutOfBuffers;
 	cb->getTXOutOfBuffersCyclic = baseRawsockGetTXOutOfBuffersCyclic;
+	cb->setRxBusyPoll = baseRawsockSetRxBusyPoll;
+	cb->rxFramePending = baseRawsockRxFramePending;
+	cb->txSetLaunchTime = baseRawsockTxSetLaunchTime;
+	cb->rxStreamID = baseRawsockRxStreamID;
+	cb->rxStreamCounts = baseRawsockRxStreamCounts;
 
 
 	AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK_DETAIL);
@@ -91,8 +103,8 @@ void* baseRawsockOpen(base_rawsock_t* rawsock, const char *ifname, bool rx_mode,
 void baseRawsockClose(void *rawsock)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_RAWSOCK_DETAIL);
-	// free the state struct
-	free(rawsock);
+	// free the state struct; it may come from the arena or the heap
+	openavbArenaFree(rawsock);
 	AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK_DETAIL);
 }
 
@@ -292,6 +304,16 @@ bool openavbRawsockTxFrameReady(void *pvRawsock, U8 *pBuffer, unsigned int len,
 	return ret;
 }
 
+bool openavbRawsockTxSetLaunchTime(void *pvRawsock, bool enable)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_RAWSOCK);
+
+	bool ret = ((base_rawsock_t*)pvRawsock)->cb.txSetLaunchTime(pvRawsock, enable);
+
+	AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+	return ret;
+}
+
 int openavbRawsockSend(void *pvRawsock)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_RAWSOCK_DETAIL);
@@ -322,6 +344,26 @@ int openavbRawsockRxBufLevel(void *pvRawsock)
 	return ret;
 }
 
+bool openavbRawsockSetRxBusyPoll(void *pvRawsock, U32 usec)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_RAWSOCK);
+
+	bool ret = ((base_rawsock_t*)pvRawsock)->cb.setRxBusyPoll(pvRawsock, usec);
+
+	AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+	return ret;
+}
+
+bool openavbRawsockRxFramePending(void *pvRawsock)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_RAWSOCK_DETAIL);
+
+	bool ret = ((base_rawsock_t*)pvRawsock)->cb.rxFramePending(pvRawsock);
+
+	AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK_DETAIL);
+	return ret;
+}
+
 U8 *openavbRawsockGetRxFrame(void *pvRawsock, U32 timeout, unsigned int *offset, unsigned int *len)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_RAWSOCK_DETAIL);
@@ -372,6 +414,26 @@ bool openavbRawsockRxAVTPSubtype(void *pvRawsock, U8 subtype)
 	return ret;
 }
 
+bool openavbRawsockRxStreamID(void *pvRawsock, bool add, const U8 streamID[8])
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_RAWSOCK);
+
+	bool ret = ((base_rawsock_t*)pvRawsock)->cb.rxStreamID(pvRawsock, add, streamID);
+
+	AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+	return ret;
+}
+
+int openavbRawsockRxStreamCounts(void *pvRawsock, bool dropped, rawsock_stream_count_t *counts, int max)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_RAWSOCK);
+
+	int ret = ((base_rawsock_t*)pvRawsock)->cb.rxStreamCounts(pvRawsock, dropped, counts, max);
+
+	AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+	return ret;
+}
+
 int openavbRawsockGetSocket(void *pvRawsock)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_RAWSOCK);
@@ -411,3 +473,13 @@ unsigned long openavbRawsockGetTXOutOfBuffersCyclic(void *pvRawsock)
 	AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK_DETAIL);
 	return ret;
 }
+
+unsigned long openavbRawsockGetTXLaunchMissed(void *pvRawsock)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_RAWSOCK_DETAIL);
+
+	unsigned long ret = ((base_rawsock_t*)pvRawsock)->txLaunchMissed;
+
+	AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK_DETAIL);
+	return ret;
+}
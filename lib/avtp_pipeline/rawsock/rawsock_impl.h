@@ -82,6 +82,11 @@ typedef struct {
 	int (*rxBufLevel)(void* rawsock);
 	unsigned long (*getTXOutOfBuffers)(void* pvRawsock);
 	unsigned long (*getTXOutOfBuffersCyclic)(void* pvRawsock);
+	bool (*setRxBusyPoll)(void* rawsock, U32 usec);
+	bool (*rxFramePending)(void* rawsock);
+	bool (*txSetLaunchTime)(void* rawsock, bool enable);
+	bool (*rxStreamID)(void* rawsock, bool add, const U8 streamID[8]);
+	int (*rxStreamCounts)(void* rawsock, bool dropped, rawsock_stream_count_t *counts, int max);
 } rawsock_cb_t;
 
 // State information for raw socket
@@ -112,6 +117,14 @@ typedef struct base_rawsock {
 	// RX usage of the socket
 	bool rxMode;
 
+	// TX frames are queued with their launch time (SO_TXTIME)
+	bool txLaunchTime;
+	// TX frames the kernel dropped for a missed or invalid launch time
+	unsigned long txLaunchMissed;
+
+	// Kernel RX stream filter of the implementation; NULL if not in use
+	void *rxStreamFilter;
+
 } base_rawsock_t;
 
 // Argument validation
@@ -0,0 +1,180 @@
+#include "CppUTest/TestHarness.h"
+
+extern "C" {
+#include "openavb_am824.h"
+}
+#include <arpa/inet.h>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+extern "C" void avbLogFn(unsigned level, const char *tag, const char *company,
+                          const char *component, const char *path, int line,
+                          const char *fmt, ...)
+{
+    (void)level; (void)tag; (void)company; (void)component;
+    (void)path; (void)line; (void)fmt;
+}
+
+static const am824_isa_t allIsas[] = {
+    AM824_ISA_SCALAR, AM824_ISA_SSSE3, AM824_ISA_AVX2, AM824_ISA_NEON
+};
+
+// Lengths around every kernel's step and tail thresholds
+static const U32 counts[] = { 0, 1, 3, 4, 5, 6, 7, 8, 9, 10, 15, 16, 17, 31, 33, 63, 64, 65, 191, 250 };
+
+static void fillRandom(std::vector<U8> &buf, unsigned seed)
+{
+    srand(seed);
+    for (size_t i = 0; i < buf.size(); i++)
+        buf[i] = (U8)rand();
+}
+
+// Formulas the 61883-6 mapping used before the kernels existed
+static void referencePack(U8 *pDst, const U8 *pSrc, U32 count, U32 sampleBytes, U32 label)
+{
+    for (U32 i = 0; i < count; i++) {
+        U32 sample;
+        if (sampleBytes == 2) {
+            S16 s16;
+            memcpy(&s16, pSrc + (i * 2), 2);
+            sample = ((U32)s16 & 0x0000ffff) << 8;
+        }
+        else {
+            sample = pSrc[i * 3] | (pSrc[(i * 3) + 1] << 8) | (pSrc[(i * 3) + 2] << 16);
+        }
+        sample = htonl(sample | label);
+        memcpy(pDst + (i * 4), &sample, 4);
+    }
+}
+
+static void referenceUnpack(U8 *pDst, const U8 *pSrc, U32 count, U32 sampleBytes)
+{
+    for (U32 i = 0; i < count; i++) {
+        U32 sample;
+        memcpy(&sample, pSrc + (i * 4), 4);
+        sample = ntohl(sample) & 0x00ffffff;
+        if (sampleBytes == 2) {
+            S16 s16 = (S16)(sample >> 8);
+            memcpy(pDst + (i * 2), &s16, 2);
+        }
+        else {
+            pDst[i * 3] = sample;
+            pDst[(i * 3) + 1] = sample >> 8;
+            pDst[(i * 3) + 2] = sample >> 16;
+        }
+    }
+}
+
+TEST_GROUP(Am824)
+{
+    am824_isa_t savedIsa;
+
+    void setup()
+    {
+        savedIsa = openavbAm824GetIsa();
+    }
+
+    void teardown()
+    {
+        openavbAm824SetIsa(savedIsa);
+    }
+};
+
+TEST(Am824, ScalarAlwaysAvailable)
+{
+    CHECK_TRUE(openavbAm824SetIsa(AM824_ISA_SCALAR));
+    LONGS_EQUAL(AM824_ISA_SCALAR, openavbAm824GetIsa());
+    STRCMP_EQUAL("scalar", openavbAm824IsaName(AM824_ISA_SCALAR));
+}
+
+TEST(Am824, InitPicksSupportedIsa)
+{
+    openavbAm824Init();
+    CHECK_TRUE(openavbAm824SetIsa(openavbAm824GetIsa()));
+}
+
+TEST(Am824, PackMatchesReference)
+{
+    for (U32 sampleBytes = 2; sampleBytes <= 3; sampleBytes++) {
+        U32 label = (sampleBytes == 2) ? AM824_LABEL_MBLA_16BIT : AM824_LABEL_MBLA_24BIT;
+        for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); c++) {
+            U32 count = counts[c];
+            std::vector<U8> src(count * sampleBytes + 1);
+            std::vector<U8> expected(count * 4 + 4, 0xa5);
+            fillRandom(src, count * sampleBytes);
+            referencePack(&expected[0], &src[0], count, sampleBytes, label);
+
+            for (size_t i = 0; i < sizeof(allIsas) / sizeof(allIsas[0]); i++) {
+                if (!openavbAm824SetIsa(allIsas[i]))
+                    continue;
+                std::vector<U8> out(count * 4 + 4, 0xa5);
+                openavbAm824Pack(&out[0], &src[0], count, sampleBytes, label);
+                MEMCMP_EQUAL(&expected[0], &out[0], out.size());
+            }
+        }
+    }
+}
+
+TEST(Am824, UnpackMatchesReference)
+{
+    for (U32 sampleBytes = 2; sampleBytes <= 3; sampleBytes++) {
+        for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); c++) {
+            U32 count = counts[c];
+            std::vector<U8> src(count * 4 + 1);
+            std::vector<U8> expected(count * sampleBytes + 4, 0xa5);
+            fillRandom(src, count + 100);
+            referenceUnpack(&expected[0], &src[0], count, sampleBytes);
+
+            for (size_t i = 0; i < sizeof(allIsas) / sizeof(allIsas[0]); i++) {
+                if (!openavbAm824SetIsa(allIsas[i]))
+                    continue;
+                // The guard bytes after the last sample must be left alone
+                std::vector<U8> out(count * sampleBytes + 4, 0xa5);
+                openavbAm824Unpack(&out[0], &src[0], count, sampleBytes);
+                MEMCMP_EQUAL(&expected[0], &out[0], out.size());
+            }
+        }
+    }
+}
+
+TEST(Am824, PlanarMatchesInterleaved)
+{
+    const U32 channels = 6;
+    for (U32 sampleBytes = 2; sampleBytes <= 3; sampleBytes++) {
+        for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); c++) {
+            U32 frames = counts[c];
+            std::vector<U8> interleaved(frames * channels * sampleBytes + 1);
+            fillRandom(interleaved, frames);
+
+            std::vector<std::vector<U8> > planes(channels, std::vector<U8>(frames * sampleBytes + 1));
+            const U8 *pSrc[channels];
+            U8 *pDst[channels];
+            for (U32 ch = 0; ch < channels; ch++) {
+                for (U32 f = 0; f < frames; f++)
+                    memcpy(&planes[ch][f * sampleBytes], &interleaved[((f * channels) + ch) * sampleBytes], sampleBytes);
+                pSrc[ch] = &planes[ch][0];
+            }
+
+            std::vector<U8> expected(frames * channels * 4 + 4, 0xa5);
+            referencePack(&expected[0], &interleaved[0], frames * channels, sampleBytes, AM824_LABEL_MBLA_24BIT);
+
+            for (size_t i = 0; i < sizeof(allIsas) / sizeof(allIsas[0]); i++) {
+                if (!openavbAm824SetIsa(allIsas[i]))
+                    continue;
+                std::vector<U8> packed(frames * channels * 4 + 4, 0xa5);
+                openavbAm824PackPlanar(&packed[0], pSrc, frames, channels, sampleBytes, AM824_LABEL_MBLA_24BIT);
+                MEMCMP_EQUAL(&expected[0], &packed[0], packed.size());
+
+                std::vector<std::vector<U8> > out(channels, std::vector<U8>(frames * sampleBytes + 1, 0xa5));
+                for (U32 ch = 0; ch < channels; ch++)
+                    pDst[ch] = &out[ch][0];
+                openavbAm824UnpackPlanar(pDst, &packed[0], frames, channels, sampleBytes);
+                for (U32 ch = 0; ch < channels; ch++) {
+                    MEMCMP_EQUAL(&planes[ch][0], &out[ch][0], frames * sampleBytes);
+                    BYTES_EQUAL(0xa5, out[ch][frames * sampleBytes]);
+                }
+            }
+        }
+    }
+}
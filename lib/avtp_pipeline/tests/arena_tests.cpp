@@ -0,0 +1,191 @@
+#include "CppUTest/TestHarness.h"
+
+extern "C" {
+#include "openavb_platform.h"
+#include "openavb_arena.h"
+#include "openavb_arena_osal.h"
+}
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// Fake chunk mapping on the heap, counting the chunks that are mapped.
+static int fakeChunksMapped;
+
+extern "C" void *osalArenaMapChunk(size_t size, int numaNode, bool hugePages, bool *pHugePages)
+{
+    (void)numaNode; (void)hugePages;
+    *pHugePages = FALSE;
+    void *pChunk = NULL;
+    if (posix_memalign(&pChunk, OPENAVB_ARENA_ALIGNMENT, size) != 0)
+        return NULL;
+    fakeChunksMapped++;
+    return pChunk;
+}
+
+extern "C" void osalArenaUnmapChunk(void *pChunk, size_t size)
+{
+    (void)size;
+    free(pChunk);
+}
+
+extern "C" int osalArenaNodeOfCpu(U32 cpu)
+{
+    (void)cpu;
+    return -1;
+}
+
+extern "C" int osalArenaNodeOfInterface(const char *ifname)
+{
+    (void)ifname;
+    return -1;
+}
+
+extern "C" void avbLogFn(unsigned level, const char *tag, const char *company,
+                          const char *component, const char *path, int line,
+                          const char *fmt, ...)
+{
+    (void)level; (void)tag; (void)company; (void)component;
+    (void)path; (void)line; (void)fmt;
+}
+
+// The blocks one stream allocates when it connects: its rawsock and the
+// item, map and interface blocks of its media queue.
+struct Stream {
+    void *pRawsock;
+    void *pItems;
+    void *pMapData;
+    void *pIntfData;
+};
+
+static const size_t rawsockSize = 13 * 1024;
+
+static Stream connectStream(size_t itemCount, size_t itemSize, int node)
+{
+    Stream s;
+    s.pRawsock = openavbArenaAlloc(rawsockSize, node);
+    s.pItems = openavbArenaAlloc(itemCount * (128 + itemSize), node);
+    s.pMapData = openavbArenaAlloc(itemCount * 64, node);
+    s.pIntfData = openavbArenaAlloc(itemCount * 32, node);
+    return s;
+}
+
+static void disconnectStream(Stream &s)
+{
+    openavbArenaFree(s.pIntfData);
+    openavbArenaFree(s.pMapData);
+    openavbArenaFree(s.pItems);
+    openavbArenaFree(s.pRawsock);
+}
+
+static U32 chunkCount()
+{
+    U32 chunks = 0;
+    openavbArenaGetStats(&chunks, NULL);
+    return chunks;
+}
+
+TEST_GROUP(Arena)
+{
+    void setup()
+    {
+        fakeChunksMapped = 0;
+        openavbArenaInitialize();
+    }
+
+    void teardown()
+    {
+        openavbArenaFinalize();
+        LONGS_EQUAL(0, chunkCount());
+    }
+};
+
+TEST(Arena, BlocksAreAlignedAndZeroed)
+{
+    U8 *p = (U8 *)openavbArenaAlloc(100, 0);
+    CHECK(p != NULL);
+    LONGS_EQUAL(0, (uintptr_t)p % OPENAVB_ARENA_ALIGNMENT);
+    memset(p, 0xa5, 100);
+    openavbArenaFree(p);
+
+    U8 *q = (U8 *)openavbArenaAlloc(100, 0);
+    LONGS_EQUAL(0, (uintptr_t)q % OPENAVB_ARENA_ALIGNMENT);
+    for (int i = 0; i < 100; i++)
+        BYTES_EQUAL(0, q[i]);
+    openavbArenaFree(q);
+}
+
+TEST(Arena, ChurnWithLiveStreamKeepsChunkCountFlat)
+{
+    // A stream that stays connected keeps its chunk from being reset
+    Stream live = connectStream(32, 1500, 0);
+    U32 chunks = chunkCount();
+
+    for (int i = 0; i < 2000; i++) {
+        Stream s = connectStream(20 + (i % 3), 1024 + 256 * (i % 4), 0);
+        disconnectStream(s);
+        LONGS_EQUAL(chunks, chunkCount());
+    }
+
+    disconnectStream(live);
+    LONGS_EQUAL(1, fakeChunksMapped);
+}
+
+TEST(Arena, InterleavedStreamsReuseFreedBlocks)
+{
+    Stream live = connectStream(8, 200, 0);
+    std::vector<Stream> streams;
+    for (int i = 0; i < 4; i++)
+        streams.push_back(connectStream(32, 1500, 0));
+    U32 chunks = chunkCount();
+
+    // Streams drop out and reconnect in a different order each round
+    for (int i = 0; i < 1000; i++) {
+        size_t idx = (i * 7) % streams.size();
+        disconnectStream(streams[idx]);
+        streams[idx] = connectStream(32, 1500, 0);
+        LONGS_EQUAL(chunks, chunkCount());
+    }
+
+    for (size_t i = 0; i < streams.size(); i++)
+        disconnectStream(streams[i]);
+    disconnectStream(live);
+}
+
+TEST(Arena, LargerFreedBlockIsSplit)
+{
+    void *pLive = openavbArenaAlloc(64, 0);
+    void *pBig = openavbArenaAlloc(64 * 1024, 0);
+    void *pTop = openavbArenaAlloc(64, 0);
+    openavbArenaFree(pBig);
+
+    // Both fit in the freed block, so neither is carved from the unused end
+    U8 *pA = (U8 *)openavbArenaAlloc(16 * 1024, 0);
+    U8 *pB = (U8 *)openavbArenaAlloc(16 * 1024, 0);
+    CHECK(pA >= (U8 *)pBig && pA < (U8 *)pTop);
+    CHECK(pB >= (U8 *)pBig && pB < (U8 *)pTop);
+    CHECK(pA != pB);
+
+    openavbArenaFree(pA);
+    openavbArenaFree(pB);
+    openavbArenaFree(pTop);
+    openavbArenaFree(pLive);
+}
+
+TEST(Arena, NodesDoNotShareBlocks)
+{
+    void *pLive0 = openavbArenaAlloc(64, 0);
+    void *pLive1 = openavbArenaAlloc(64, 1);
+    LONGS_EQUAL(2, chunkCount());
+
+    for (int i = 0; i < 100; i++) {
+        Stream s0 = connectStream(16, 1500, 0);
+        Stream s1 = connectStream(16, 1500, 1);
+        disconnectStream(s0);
+        disconnectStream(s1);
+    }
+    LONGS_EQUAL(2, chunkCount());
+
+    openavbArenaFree(pLive0);
+    openavbArenaFree(pLive1);
+}
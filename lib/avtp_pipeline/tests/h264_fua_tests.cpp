@@ -0,0 +1,251 @@
+#include "CppUTest/TestHarness.h"
+
+extern "C" {
+#include "openavb_h264_fua.h"
+}
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+typedef std::vector<U8> Bytes;
+
+// Random NAL unit with emulation prevention applied, so it holds no start code
+static Bytes makeNal(U8 header, U32 len, unsigned seed)
+{
+    Bytes nal;
+    U32 zeros = 0;
+
+    srand(seed);
+    nal.push_back(header);
+    while (nal.size() < len) {
+        // Plenty of zero bytes to exercise the start code search
+        U8 b = (rand() % 4 == 0) ? 0x00 : (U8)rand();
+        if (zeros >= 2 && b <= 0x03) {
+            nal.push_back(0x03);
+            zeros = 0;
+        }
+        nal.push_back(b);
+        zeros = (b == 0x00) ? zeros + 1 : 0;
+    }
+    if (nal.back() == 0x00)
+        nal.push_back(0x80);    // rbsp_stop_one_bit
+    return nal;
+}
+
+static void appendAnnexB(Bytes &au, const Bytes &nal, bool longStartCode)
+{
+    static const U8 startCode[] = { 0x00, 0x00, 0x00, 0x01 };
+    au.insert(au.end(), longStartCode ? startCode : startCode + 1, startCode + 4);
+    au.insert(au.end(), nal.begin(), nal.end());
+}
+
+static std::vector<Bytes> packetize(const Bytes &au, U32 maxLen)
+{
+    std::vector<Bytes> packets;
+    openavb_h264_fua_tx_t tx;
+    Bytes buf(maxLen + 16, 0xee);
+    bool last = FALSE;
+
+    openavbH264FuaTxStart(&tx, au.data(), au.size());
+    while (!openavbH264FuaTxDone(&tx)) {
+        CHECK_FALSE(last);
+        U32 len = openavbH264FuaTxNext(&tx, buf.data(), maxLen, &last);
+        CHECK(len > 0);
+        CHECK(len <= maxLen);
+        BYTES_EQUAL(0xee, buf[maxLen]);
+        packets.push_back(Bytes(buf.begin(), buf.begin() + len));
+    }
+    CHECK(last || packets.empty());
+    return packets;
+}
+
+static Bytes reassemble(const std::vector<Bytes> &packets, U32 bufSize, U32 *pStatus, U32 *pNalUnits)
+{
+    openavb_h264_fua_rx_t rx;
+    Bytes buf(bufSize + 16, 0xee);
+
+    openavbH264FuaRxStart(&rx, buf.data(), bufSize);
+    for (size_t i = 0; i < packets.size(); i++)
+        openavbH264FuaRxAdd(&rx, packets[i].data(), packets[i].size());
+    U32 len = openavbH264FuaRxEnd(&rx, pStatus);
+    CHECK(len <= bufSize);
+    BYTES_EQUAL(0xee, buf[bufSize]);
+    if (pNalUnits)
+        *pNalUnits = rx.nalUnits;
+    return Bytes(buf.begin(), buf.begin() + len);
+}
+
+TEST_GROUP(H264Fua)
+{
+    std::vector<Bytes> nals;
+    Bytes au;           // as the interface would hand it over
+    Bytes expected;     // as the reassembler writes it back
+
+    void setup()
+    {
+        static const U32 sizes[] = { 9, 4, 1, 1400, 1401, 1402, 5000, 2, 30000, 1416, 1417 };
+        for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+            U8 header = (i == 0) ? 0x67 : (i == 1) ? 0x68 : (i % 2) ? 0x65 : 0x41;
+            nals.push_back(makeNal(header, sizes[i], 100 + i));
+            appendAnnexB(au, nals.back(), i % 3 == 0);
+            appendAnnexB(expected, nals.back(), true);
+        }
+        // trailing_zero_8bits are not part of the last NAL unit
+        au.push_back(0x00);
+        au.push_back(0x00);
+    }
+};
+
+TEST(H264Fua, RoundTrip)
+{
+    static const U32 maxLens[] = { 3, 4, 64, 1399, 1400, 1416 };
+    for (size_t i = 0; i < sizeof(maxLens) / sizeof(maxLens[0]); i++) {
+        std::vector<Bytes> packets = packetize(au, maxLens[i]);
+        U32 status, nalUnits;
+        Bytes out = reassemble(packets, 1 << 20, &status, &nalUnits);
+        LONGS_EQUAL(H264_AU_OK, status);
+        LONGS_EQUAL(nals.size(), nalUnits);
+        LONGS_EQUAL(expected.size(), out.size());
+        CHECK(out == expected);
+    }
+}
+
+TEST(H264Fua, SmallNalsAreNotFragmented)
+{
+    std::vector<Bytes> packets = packetize(au, 1416);
+    // SPS, PPS and the 1 byte NAL units go out as they are
+    CHECK(packets[0] == nals[0]);
+    CHECK(packets[1] == nals[1]);
+    CHECK(packets[2] == nals[2]);
+    // 1417 bytes needs two FU-A fragments
+    Bytes &first = packets[packets.size() - 2];
+    Bytes &end = packets.back();
+    BYTES_EQUAL((nals.back()[0] & 0xE0) | H264_NAL_TYPE_FU_A, first[0]);
+    BYTES_EQUAL(0x80 | (nals.back()[0] & 0x1F), first[1]);
+    BYTES_EQUAL(0x40 | (nals.back()[0] & 0x1F), end[1]);
+}
+
+TEST(H264Fua, NoStartCode)
+{
+    Bytes nal = makeNal(0x65, 3000, 7);
+    std::vector<Bytes> packets = packetize(nal, 1000);
+    LONGS_EQUAL(4, packets.size());
+    U32 status;
+    Bytes out = reassemble(packets, 1 << 16, &status, NULL);
+    LONGS_EQUAL(H264_AU_OK, status);
+    Bytes ref;
+    appendAnnexB(ref, nal, true);
+    CHECK(out == ref);
+}
+
+TEST(H264Fua, EmptyAccessUnit)
+{
+    static const U8 onlyStartCodes[] = { 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01 };
+    Bytes empty(onlyStartCodes, onlyStartCodes + sizeof(onlyStartCodes));
+    LONGS_EQUAL(0, packetize(empty, 100).size());
+    LONGS_EQUAL(0, packetize(Bytes(), 100).size());
+}
+
+TEST(H264Fua, LostFragment)
+{
+    std::vector<Bytes> packets = packetize(au, 1000);
+    openavb_h264_fua_rx_t rx;
+    Bytes buf(1 << 20);
+    U32 status;
+
+    // Drop the middle fragment of the 5000 byte NAL unit (index 6)
+    size_t lostIdx = 0, nal = 0;
+    for (size_t i = 0; i < packets.size(); i++) {
+        if ((packets[i][0] & 0x1F) != H264_NAL_TYPE_FU_A || (packets[i][1] & 0x80))
+            nal += (i == 0) ? 0 : 1;
+        if (nal == 6 && !(packets[i][1] & 0xC0)) {
+            lostIdx = i;
+            break;
+        }
+    }
+    CHECK(lostIdx > 0);
+
+    openavbH264FuaRxStart(&rx, buf.data(), buf.size());
+    for (size_t i = 0; i < packets.size(); i++) {
+        if (i == lostIdx) {
+            openavbH264FuaRxMarkLost(&rx);
+            continue;
+        }
+        openavbH264FuaRxAdd(&rx, packets[i].data(), packets[i].size());
+    }
+    U32 len = openavbH264FuaRxEnd(&rx, &status);
+    LONGS_EQUAL(H264_AU_PACKET_LOST, status);
+    LONGS_EQUAL(nals.size() - 1, rx.nalUnits);
+    // Everything but the damaged NAL unit is kept
+    LONGS_EQUAL(expected.size() - nals[6].size() - H264_START_CODE_SIZE, len);
+}
+
+TEST(H264Fua, MissingStartAndEnd)
+{
+    std::vector<Bytes> packets = packetize(au, 1000);
+    std::vector<Bytes> noStart, noEnd;
+    bool droppedStart = false, droppedEnd = false;
+
+    for (size_t i = 0; i < packets.size(); i++) {
+        bool fu = (packets[i][0] & 0x1F) == H264_NAL_TYPE_FU_A;
+        if (fu && (packets[i][1] & 0x80) && !droppedStart)
+            droppedStart = true;
+        else
+            noStart.push_back(packets[i]);
+        if (fu && (packets[i][1] & 0x40) && !droppedEnd)
+            droppedEnd = true;
+        else
+            noEnd.push_back(packets[i]);
+    }
+
+    U32 status, nalUnits;
+    reassemble(noStart, 1 << 20, &status, &nalUnits);
+    LONGS_EQUAL(H264_AU_FU_INCOMPLETE, status);
+    LONGS_EQUAL(nals.size() - 1, nalUnits);
+
+    reassemble(noEnd, 1 << 20, &status, &nalUnits);
+    LONGS_EQUAL(H264_AU_FU_INCOMPLETE, status);
+    LONGS_EQUAL(nals.size() - 1, nalUnits);
+
+    // Access unit ending inside a FU-A
+    packets.pop_back();
+    reassemble(packets, 1 << 20, &status, &nalUnits);
+    LONGS_EQUAL(H264_AU_FU_INCOMPLETE, status);
+    LONGS_EQUAL(nals.size() - 1, nalUnits);
+}
+
+TEST(H264Fua, Overflow)
+{
+    std::vector<Bytes> packets = packetize(au, 1416);
+    U32 status;
+    Bytes out = reassemble(packets, 10000, &status, NULL);
+    CHECK(status & H264_AU_OVERFLOW);
+    // Only whole NAL units are kept
+    CHECK(out.size() <= 10000);
+    CHECK(memcmp(out.data(), expected.data(), out.size()) == 0);
+}
+
+TEST(H264Fua, StapA)
+{
+    Bytes stap;
+    stap.push_back(0x78);
+    for (int i = 0; i < 2; i++) {
+        stap.push_back(nals[i].size() >> 8);
+        stap.push_back(nals[i].size() & 0xff);
+        stap.insert(stap.end(), nals[i].begin(), nals[i].end());
+    }
+    std::vector<Bytes> packets(1, stap);
+    U32 status, nalUnits;
+    Bytes out = reassemble(packets, 1 << 16, &status, &nalUnits);
+    LONGS_EQUAL(H264_AU_OK, status);
+    LONGS_EQUAL(2, nalUnits);
+    Bytes ref;
+    appendAnnexB(ref, nals[0], true);
+    appendAnnexB(ref, nals[1], true);
+    CHECK(out == ref);
+
+    // Truncated aggregation unit
+    packets[0].resize(packets[0].size() - 1);
+    reassemble(packets, 1 << 16, &status, &nalUnits);
+    CHECK(status & H264_AU_BAD_PAYLOAD);
+}
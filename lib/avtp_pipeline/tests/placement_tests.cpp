@@ -0,0 +1,245 @@
+#include "CppUTest/TestHarness.h"
+
+extern "C" {
+#include "openavb_platform.h"
+#include "openavb_placement.h"
+#include "openavb_placement_osal.h"
+}
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Fake NIC: queue counts and per-queue cores set up by each test, and a
+// record of the steering rules added and removed.
+static int fakeTxQueues;
+static int fakeRxQueues;
+static openavb_cpu_mask_t fakeTxCpus[8];
+static openavb_cpu_mask_t fakeRxCpus[8];
+static openavb_placement_cpu_t fakeRxSource;
+static openavb_cpu_mask_t fakeAllowed;
+static bool fakeRulesSupported;
+static int fakeNextLocation;
+static std::vector<int> fakeRuleQueues;
+static std::vector<int> fakeDeletedRules;
+static std::string fakeLastIfname;
+
+extern "C" int osalPlacementQueueCount(const char *ifname, bool tx)
+{
+    fakeLastIfname = ifname;
+    return tx ? fakeTxQueues : fakeRxQueues;
+}
+
+extern "C" openavb_placement_cpu_t osalPlacementQueueCpus(const char *ifname, bool tx, int queue, openavb_cpu_mask_t *pMask)
+{
+    (void)ifname;
+    *pMask = tx ? fakeTxCpus[queue] : fakeRxCpus[queue];
+    for (int i = 0; i < OPENAVB_PLACEMENT_MAX_CPUS / 64; i++) {
+        if (pMask->bits[i])
+            return tx ? OPENAVB_PLACEMENT_CPU_XPS : fakeRxSource;
+    }
+    return OPENAVB_PLACEMENT_CPU_NONE;
+}
+
+extern "C" bool osalPlacementAllowedCpus(openavb_cpu_mask_t *pMask)
+{
+    *pMask = fakeAllowed;
+    return TRUE;
+}
+
+extern "C" int osalPlacementAddRxRule(const char *ifname, const U8 destAddr[ETH_ALEN], int queue)
+{
+    (void)ifname; (void)destAddr;
+    if (!fakeRulesSupported)
+        return -1;
+    fakeRuleQueues.push_back(queue);
+    return fakeNextLocation++;
+}
+
+extern "C" void osalPlacementDelRxRule(const char *ifname, int location)
+{
+    (void)ifname;
+    fakeDeletedRules.push_back(location);
+}
+
+extern "C" bool osalPlacementPinThread(int cpu)
+{
+    (void)cpu;
+    return TRUE;
+}
+
+extern "C" void avbLogFn(unsigned level, const char *tag, const char *company,
+                          const char *component, const char *path, int line,
+                          const char *fmt, ...)
+{
+    (void)level; (void)tag; (void)company; (void)component;
+    (void)path; (void)line; (void)fmt;
+}
+
+static const U8 addrA[ETH_ALEN] = { 0x91, 0xe0, 0xf0, 0x00, 0xfe, 0x01 };
+static const U8 addrB[ETH_ALEN] = { 0x91, 0xe0, 0xf0, 0x00, 0xfe, 0x02 };
+
+TEST_GROUP(Placement)
+{
+    void setup()
+    {
+        fakeTxQueues = 0;
+        fakeRxQueues = 0;
+        memset(fakeTxCpus, 0, sizeof(fakeTxCpus));
+        memset(fakeRxCpus, 0, sizeof(fakeRxCpus));
+        fakeRxSource = OPENAVB_PLACEMENT_CPU_IRQ;
+        memset(&fakeAllowed, 0, sizeof(fakeAllowed));
+        for (int cpu = 0; cpu < 4; cpu++)
+            OPENAVB_CPU_MASK_SET(&fakeAllowed, cpu);
+        fakeRulesSupported = true;
+        fakeNextLocation = 100;
+        fakeRuleQueues.clear();
+        fakeDeletedRules.clear();
+        openavbPlacementInitialize();
+    }
+
+    void teardown()
+    {
+        openavbPlacementFinalize();
+    }
+
+    // Queue q served by core q
+    void oneCorePerQueue(openavb_cpu_mask_t *cpus, int queues)
+    {
+        for (int q = 0; q < queues; q++)
+            OPENAVB_CPU_MASK_SET(&cpus[q], q);
+    }
+};
+
+TEST(Placement, TalkersSpreadOverXpsQueues)
+{
+    fakeTxQueues = 4;
+    oneCorePerQueue(fakeTxCpus, 4);
+
+    openavb_placement_t p[5];
+    for (int i = 0; i < 4; i++) {
+        CHECK(openavbPlacementAssign(&p[i], "eth0", TRUE, OPENAVB_PLACEMENT_AUTO, NULL));
+        LONGS_EQUAL(i, p[i].queue);
+        LONGS_EQUAL(i, p[i].cpu);
+        LONGS_EQUAL(OPENAVB_PLACEMENT_CPU_XPS, p[i].cpuSource);
+    }
+
+    // All queues have one stream: back to the first
+    CHECK(openavbPlacementAssign(&p[4], "eth0", TRUE, OPENAVB_PLACEMENT_AUTO, NULL));
+    LONGS_EQUAL(0, p[4].queue);
+
+    // A released queue is the least loaded again
+    openavbPlacementRelease(&p[2]);
+    openavb_placement_t again;
+    CHECK(openavbPlacementAssign(&again, "eth0", TRUE, OPENAVB_PLACEMENT_AUTO, NULL));
+    LONGS_EQUAL(2, again.queue);
+    LONGS_EQUAL(2, again.cpu);
+
+    for (int i = 0; i < 5; i++)
+        openavbPlacementRelease(&p[i]);
+    openavbPlacementRelease(&again);
+}
+
+TEST(Placement, RawsockPrefixIsSkipped)
+{
+    fakeTxQueues = 1;
+    openavb_placement_t p;
+    CHECK(openavbPlacementAssign(&p, "ring:eth1", TRUE, OPENAVB_PLACEMENT_AUTO, NULL));
+    STRCMP_EQUAL("eth1", p.ifname);
+    STRCMP_EQUAL("eth1", fakeLastIfname.c_str());
+    openavbPlacementRelease(&p);
+}
+
+TEST(Placement, TxQueueWithoutXpsLeftToKernel)
+{
+    fakeTxQueues = 4;
+    OPENAVB_CPU_MASK_SET(&fakeTxCpus[1], 1);
+
+    openavb_placement_t p;
+    CHECK(openavbPlacementAssign(&p, "eth0", TRUE, 2, NULL));
+    LONGS_EQUAL(-1, p.queue);
+    LONGS_EQUAL(OPENAVB_PLACEMENT_CPU_SPREAD, p.cpuSource);
+    openavbPlacementRelease(&p);
+
+    CHECK(openavbPlacementAssign(&p, "eth0", TRUE, 1, NULL));
+    LONGS_EQUAL(1, p.queue);
+    LONGS_EQUAL(1, p.cpu);
+    openavbPlacementRelease(&p);
+}
+
+TEST(Placement, CoresOutsideAffinityAreNotUsed)
+{
+    fakeTxQueues = 2;
+    OPENAVB_CPU_MASK_SET(&fakeTxCpus[0], 6);
+    OPENAVB_CPU_MASK_SET(&fakeTxCpus[1], 3);
+
+    openavb_placement_t p;
+    CHECK(openavbPlacementAssign(&p, "eth0", TRUE, OPENAVB_PLACEMENT_AUTO, NULL));
+    LONGS_EQUAL(1, p.queue);
+    LONGS_EQUAL(3, p.cpu);
+    openavbPlacementRelease(&p);
+}
+
+TEST(Placement, ListenersOfOneAddressShareARule)
+{
+    fakeRxQueues = 4;
+    oneCorePerQueue(fakeRxCpus, 4);
+
+    openavb_placement_t a1, a2, b;
+    CHECK(openavbPlacementAssign(&a1, "eth0", FALSE, OPENAVB_PLACEMENT_AUTO, addrA));
+    CHECK(openavbPlacementAssign(&a2, "eth0", FALSE, OPENAVB_PLACEMENT_AUTO, addrA));
+    CHECK(openavbPlacementAssign(&b, "eth0", FALSE, OPENAVB_PLACEMENT_AUTO, addrB));
+
+    LONGS_EQUAL(2, fakeRuleQueues.size());
+    CHECK(a1.rxSteered);
+    CHECK(a2.rxSteered);
+    LONGS_EQUAL(a1.queue, a2.queue);
+    LONGS_EQUAL(OPENAVB_PLACEMENT_CPU_IRQ, a1.cpuSource);
+    LONGS_EQUAL(a1.queue, a1.cpu);
+    CHECK(b.queue != a1.queue);
+
+    openavbPlacementRelease(&a1);
+    LONGS_EQUAL(0, fakeDeletedRules.size());
+    openavbPlacementRelease(&a2);
+    LONGS_EQUAL(1, fakeDeletedRules.size());
+    LONGS_EQUAL(100, fakeDeletedRules[0]);
+
+    // Finalize removes the rule still in place
+    openavbPlacementFinalize();
+    LONGS_EQUAL(2, fakeDeletedRules.size());
+    LONGS_EQUAL(101, fakeDeletedRules[1]);
+    openavbPlacementInitialize();
+}
+
+TEST(Placement, ListenerWithoutRulesIsSpread)
+{
+    fakeRxQueues = 4;
+    oneCorePerQueue(fakeRxCpus, 4);
+    fakeRulesSupported = false;
+
+    openavb_placement_t p1, p2;
+    CHECK(openavbPlacementAssign(&p1, "eth0", FALSE, OPENAVB_PLACEMENT_AUTO, addrA));
+    CHECK(openavbPlacementAssign(&p2, "eth0", FALSE, OPENAVB_PLACEMENT_AUTO, addrB));
+    LONGS_EQUAL(-1, p1.queue);
+    CHECK(!p1.rxSteered);
+    LONGS_EQUAL(OPENAVB_PLACEMENT_CPU_SPREAD, p1.cpuSource);
+    CHECK(p1.cpu != p2.cpu);
+
+    openavbPlacementRelease(&p1);
+    openavbPlacementRelease(&p2);
+    LONGS_EQUAL(0, fakeDeletedRules.size());
+}
+
+TEST(Placement, SingleRxQueueUsesItsCore)
+{
+    fakeRxQueues = 1;
+    OPENAVB_CPU_MASK_SET(&fakeRxCpus[0], 2);
+    fakeRxSource = OPENAVB_PLACEMENT_CPU_RPS;
+
+    openavb_placement_t p;
+    CHECK(openavbPlacementAssign(&p, "eth0", FALSE, OPENAVB_PLACEMENT_AUTO, addrA));
+    LONGS_EQUAL(0, p.queue);
+    LONGS_EQUAL(2, p.cpu);
+    LONGS_EQUAL(OPENAVB_PLACEMENT_CPU_RPS, p.cpuSource);
+    LONGS_EQUAL(0, fakeRuleQueues.size());
+    openavbPlacementRelease(&p);
+}
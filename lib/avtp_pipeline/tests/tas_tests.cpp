@@ -0,0 +1,310 @@
+#include "CppUTest/TestHarness.h"
+
+extern "C" {
+#include "hal/network_hal_tas.h"
+}
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Gate windows worked out the long way: every entry of every cycle between
+// from and to, straight from the configuration, adjacent open entries merged.
+struct Window {
+    uint64_t open;
+    uint64_t close;
+};
+
+static std::vector<Window> expandSchedule(const network_hal_tas_config_t &cfg, uint8_t tc, uint64_t from, uint64_t to)
+{
+    std::vector<Window> windows;
+    uint64_t sum = 0;
+    for (uint32_t i = 0; i < cfg.gate_control_list_length; i++)
+        sum += cfg.gate_control_list[i].time_interval_ns;
+    uint64_t cycle = cfg.cycle_time_ns ? cfg.cycle_time_ns : sum;
+
+    uint64_t cycleStart = cfg.base_time_ns;
+    while (cycleStart > from)
+        cycleStart -= cycle;
+    for (; cycleStart < to; cycleStart += cycle) {
+        uint64_t t = cycleStart;
+        for (uint32_t i = 0; i < cfg.gate_control_list_length; i++) {
+            uint64_t end = t + cfg.gate_control_list[i].time_interval_ns;
+            if (i == cfg.gate_control_list_length - 1 || end > cycleStart + cycle)
+                end = cycleStart + cycle;
+            if (end > t && (cfg.gate_control_list[i].gate_states & (1 << tc))) {
+                if (!windows.empty() && windows.back().close == t)
+                    windows.back().close = end;
+                else
+                    windows.push_back(Window { t, end });
+            }
+            t = end;
+            if (t == cycleStart + cycle)
+                break;
+        }
+    }
+    return windows;
+}
+
+static bool insideWindow(const std::vector<Window> &windows, uint64_t start, uint64_t end)
+{
+    for (size_t i = 0; i < windows.size(); i++) {
+        if (start >= windows[i].open && end <= windows[i].close)
+            return true;
+    }
+    return false;
+}
+
+static network_hal_tas_config_t makeConfig(const char *gcl, uint64_t base, uint64_t cycle)
+{
+    network_hal_tas_config_t cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.base_time_ns = base;
+    cfg.cycle_time_ns = cycle;
+    CHECK_EQUAL(NETWORK_HAL_SUCCESS, network_hal_tas_parse(gcl, &cfg));
+    return cfg;
+}
+
+TEST_GROUP(Tas)
+{
+    network_hal_tas_t tas;
+
+    void setup()
+    {
+        memset(&tas, 0, sizeof(tas));
+    }
+};
+
+TEST(Tas, Parse)
+{
+    network_hal_tas_config_t cfg = makeConfig("S 01 300000, S fe 700000;s 3 1000", 5, 0);
+
+    CHECK_EQUAL(3, cfg.gate_control_list_length);
+    CHECK_EQUAL(0x01, cfg.gate_control_list[0].gate_states);
+    CHECK_EQUAL(300000, cfg.gate_control_list[0].time_interval_ns);
+    CHECK_EQUAL(0xfe, cfg.gate_control_list[1].gate_states);
+    CHECK_EQUAL(700000, cfg.gate_control_list[1].time_interval_ns);
+    CHECK_EQUAL(0x03, cfg.gate_control_list[2].gate_states);
+    CHECK(cfg.base_time_ns == 5);
+
+    CHECK_EQUAL(NETWORK_HAL_ERROR_INVALID_PARAM, network_hal_tas_parse("", &cfg));
+    CHECK_EQUAL(NETWORK_HAL_ERROR_INVALID_PARAM, network_hal_tas_parse("X 01 100", &cfg));
+    CHECK_EQUAL(NETWORK_HAL_ERROR_INVALID_PARAM, network_hal_tas_parse("S 100 100", &cfg));
+    CHECK_EQUAL(NETWORK_HAL_ERROR_INVALID_PARAM, network_hal_tas_parse("S 01", &cfg));
+    CHECK_EQUAL(NETWORK_HAL_ERROR_INVALID_PARAM, network_hal_tas_parse("S 01 5000000000", &cfg));
+
+    std::string tooLong;
+    for (int i = 0; i <= NETWORK_HAL_TAS_MAX_ENTRIES; i++)
+        tooLong += "S 01 10,";
+    CHECK_EQUAL(NETWORK_HAL_ERROR_INVALID_PARAM, network_hal_tas_parse(tooLong.c_str(), &cfg));
+}
+
+TEST(Tas, InitRejectsBadConfig)
+{
+    network_hal_tas_config_t cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    CHECK_EQUAL(NETWORK_HAL_ERROR_INVALID_PARAM, network_hal_tas_init(&tas, &cfg));
+
+    cfg = makeConfig("S 01 0, S 02 0", 0, 0);
+    CHECK_EQUAL(NETWORK_HAL_ERROR_INVALID_PARAM, network_hal_tas_init(&tas, &cfg));
+
+    cfg.gate_control_list_length = NETWORK_HAL_TAS_MAX_ENTRIES + 1;
+    cfg.cycle_time_ns = 1000;
+    CHECK_EQUAL(NETWORK_HAL_ERROR_INVALID_PARAM, network_hal_tas_init(&tas, &cfg));
+}
+
+TEST(Tas, GateStates)
+{
+    network_hal_tas_config_t cfg = makeConfig("S 01 300, S 02 200, S 04 500", 10000, 0);
+    CHECK_EQUAL(NETWORK_HAL_SUCCESS, network_hal_tas_init(&tas, &cfg));
+    CHECK(tas.cycle_time_ns == 1000);
+
+    CHECK_EQUAL(0x01, network_hal_tas_gate_states(&tas, 10000));
+    CHECK_EQUAL(0x01, network_hal_tas_gate_states(&tas, 10299));
+    CHECK_EQUAL(0x02, network_hal_tas_gate_states(&tas, 10300));
+    CHECK_EQUAL(0x04, network_hal_tas_gate_states(&tas, 10999));
+    CHECK_EQUAL(0x01, network_hal_tas_gate_states(&tas, 11000));
+    CHECK_EQUAL(0x02, network_hal_tas_gate_states(&tas, 25450));
+
+    // Before base time the schedule runs as if it had started earlier
+    CHECK_EQUAL(0x04, network_hal_tas_gate_states(&tas, 9999));
+    CHECK_EQUAL(0x01, network_hal_tas_gate_states(&tas, 9000));
+    CHECK_EQUAL(0x02, network_hal_tas_gate_states(&tas, 8300));
+}
+
+TEST(Tas, CycleExtendsAndTruncates)
+{
+    // Cycle longer than the list: the last entry runs to the end
+    network_hal_tas_config_t cfg = makeConfig("S 01 300, S 02 200", 0, 1000);
+    CHECK_EQUAL(NETWORK_HAL_SUCCESS, network_hal_tas_init(&tas, &cfg));
+    CHECK_EQUAL(0x02, network_hal_tas_gate_states(&tas, 999));
+    CHECK_EQUAL(0x01, network_hal_tas_gate_states(&tas, 1000));
+
+    // Cycle shorter than the list: entries past the end never take effect
+    cfg = makeConfig("S 01 300, S 02 200, S 04 500", 0, 400);
+    CHECK_EQUAL(NETWORK_HAL_SUCCESS, network_hal_tas_init(&tas, &cfg));
+    CHECK_EQUAL(0x02, network_hal_tas_gate_states(&tas, 399));
+    CHECK_EQUAL(0x01, network_hal_tas_gate_states(&tas, 400));
+
+    uint64_t open, close;
+    CHECK_FALSE(network_hal_tas_next_window(&tas, 2, 0, 1, &open, &close));
+}
+
+TEST(Tas, NextWindow)
+{
+    network_hal_tas_config_t cfg = makeConfig("S 01 300, S 02 200, S 03 100, S 04 400", 1000, 0);
+    CHECK_EQUAL(NETWORK_HAL_SUCCESS, network_hal_tas_init(&tas, &cfg));
+    uint64_t open, close;
+
+    // Open now: the window starts now
+    CHECK(network_hal_tas_next_window(&tas, 0, 1100, 1, &open, &close));
+    CHECK(open == 1100 && close == 1300);
+
+    // Adjacent open entries merge
+    CHECK(network_hal_tas_next_window(&tas, 1, 1000, 1, &open, &close));
+    CHECK(open == 1300 && close == 1600);
+
+    // The rest of this window is too short; the next cycle's is not
+    CHECK(network_hal_tas_next_window(&tas, 1, 1500, 250, &open, &close));
+    CHECK(open == 2300 && close == 2600);
+
+    // Windows merge across the end of the cycle
+    cfg = makeConfig("S 01 300, S 02 600, S 01 100", 0, 0);
+    CHECK_EQUAL(NETWORK_HAL_SUCCESS, network_hal_tas_init(&tas, &cfg));
+    CHECK(network_hal_tas_next_window(&tas, 0, 500, 350, &open, &close));
+    CHECK(open == 900 && close == 1300);
+
+    // Never long enough, never open, always open
+    CHECK_FALSE(network_hal_tas_next_window(&tas, 0, 0, 401, &open, &close));
+    CHECK_FALSE(network_hal_tas_next_window(&tas, 5, 0, 1, &open, &close));
+    cfg = makeConfig("S 01 300, S 01 0, S 03 700", 0, 0);
+    CHECK_EQUAL(NETWORK_HAL_SUCCESS, network_hal_tas_init(&tas, &cfg));
+    CHECK(network_hal_tas_next_window(&tas, 0, 12345, 5000, &open, &close));
+    CHECK(open == 12345 && close == NETWORK_HAL_TAS_FOREVER);
+}
+
+TEST(Tas, Admit)
+{
+    network_hal_tas_config_t cfg = makeConfig("S 01 1000, S 02 9000", 0, 0);
+    CHECK_EQUAL(NETWORK_HAL_SUCCESS, network_hal_tas_init(&tas, &cfg));
+    uint64_t start = 0;
+
+    CHECK_EQUAL(8, network_hal_tas_admit(&tas, 0, 0, 120, 100, &start));
+    CHECK(start == 0);
+    CHECK_EQUAL(3, network_hal_tas_admit(&tas, 0, 0, 120, 3, &start));
+
+    // Committed frames keep the wire busy
+    network_hal_tas_commit(&tas, 0, 3, 120);
+    CHECK_EQUAL(5, network_hal_tas_admit(&tas, 0, 100, 120, 100, &start));
+    CHECK(start == 360);
+
+    // Too late for a frame in this window: wait for the next
+    CHECK_EQUAL(8, network_hal_tas_admit(&tas, 0, 900, 120, 100, &start));
+    CHECK(start == 10000);
+
+    CHECK_EQUAL(0, network_hal_tas_admit(&tas, 0, 0, 1001, 100, &start));
+    CHECK_EQUAL(0, network_hal_tas_admit(&tas, 3, 0, 120, 100, &start));
+}
+
+TEST(Tas, FrameTime)
+{
+    // 1500 bytes + FCS, preamble, SFD and IPG at 1 Gbit/s
+    CHECK(network_hal_tas_frame_time_ns(1500, 1000) == 12192);
+    CHECK(network_hal_tas_frame_time_ns(100, 100) == 9920);
+    CHECK(network_hal_tas_frame_time_ns(1, 3) == 66667);
+    CHECK(network_hal_tas_frame_time_ns(100, 0) == 0);
+}
+
+TEST(Tas, FormatTaprio)
+{
+    network_hal_tas_config_t cfg = makeConfig("S 01 300000, S fe 700000", 1000000000ULL, 0);
+    char buf[256];
+
+    int len = network_hal_tas_format_taprio(&cfg, buf, sizeof(buf));
+    STRCMP_EQUAL("base-time 1000000000 sched-entry S 01 300000 sched-entry S fe 700000 cycle-time 1000000 clockid CLOCK_TAI", buf);
+    CHECK_EQUAL((int)strlen(buf), len);
+
+    char small[16];
+    CHECK_EQUAL(len, network_hal_tas_format_taprio(&cfg, small, sizeof(small)));
+    STRCMP_EQUAL("base-time 10000", small);
+}
+
+// A talker on a virtual clock, gated the same way as talkerTasTx(): paced
+// wakeups that run late by a random amount, a random CPU cost per frame below
+// the frame time, and a wire that sends queued frames back to back. Every
+// frame on the wire must start and finish inside a window of its traffic
+// class.
+static void simulateTalker(const char *gcl, uint64_t base, uint64_t cycle, uint8_t tc,
+                           uint32_t frameLen, uint32_t linkMbps, uint64_t intervalNS,
+                           uint32_t batch, unsigned seed)
+{
+    network_hal_tas_config_t cfg = makeConfig(gcl, base, cycle);
+    network_hal_tas_t tas;
+    CHECK_EQUAL(NETWORK_HAL_SUCCESS, network_hal_tas_init(&tas, &cfg));
+
+    const uint64_t frameNS = network_hal_tas_frame_time_ns(frameLen, linkMbps);
+    const uint64_t simStart = 5000000000ULL + 777;
+    const uint64_t simEnd = simStart + 200 * tas.cycle_time_ns + 100 * intervalNS;
+    std::vector<Window> wire;
+
+    uint64_t clock = simStart;
+    uint64_t wireFree = 0;
+
+    srand(seed);
+    for (uint64_t wake = simStart; wake < simEnd; wake += intervalNS) {
+        if (clock < wake)
+            clock = wake + rand() % (intervalNS / 4 + 1);
+
+        uint32_t sent = 0;
+        while (sent < batch) {
+            uint64_t start;
+            uint32_t admitted = network_hal_tas_admit(&tas, tc, clock, frameNS, batch - sent, &start);
+            CHECK(admitted > 0);
+            if (start > clock) {
+                // Sleep overshoot, up to a quarter of a frame
+                clock = start + rand() % (frameNS / 4 + 1);
+                continue;
+            }
+            for (uint32_t i = 0; i < admitted; i++) {
+                uint64_t wireStart = clock > wireFree ? clock : wireFree;
+                wireFree = wireStart + frameNS;
+                wire.push_back(Window { wireStart, wireFree });
+                clock += 1 + rand() % (frameNS / 2);
+            }
+            network_hal_tas_commit(&tas, start, admitted, frameNS);
+            sent += admitted;
+        }
+    }
+
+    // The schedule has room for the stream, so the talker keeps up
+    CHECK(clock < simEnd + 2 * intervalNS + tas.cycle_time_ns);
+
+    std::vector<Window> windows = expandSchedule(cfg, tc, simStart - tas.cycle_time_ns, clock + tas.cycle_time_ns);
+    uint32_t outside = 0;
+    for (size_t i = 0; i < wire.size(); i++) {
+        if (!insideWindow(windows, wire[i].open, wire[i].close))
+            outside++;
+    }
+    CHECK_EQUAL(0, outside);
+}
+
+TEST(Tas, SimulatedTalkerClassA)
+{
+    // Class A stream on TC 3 with a third of each 1 ms cycle, 125 us wakeups
+    simulateTalker("S 08 300000, S f7 700000", 123456, 0, 3, 224 + 18, 1000, 125000, 4, 1);
+}
+
+TEST(Tas, SimulatedTalkerBatchedAndShortWindows)
+{
+    // Windows that fit one or two full size frames, base time in the
+    // future, batches larger than a window
+    simulateTalker("S 01 26000, S 06 20000, S 03 14000, S 04 40000", 9000000000ULL, 0, 0, 1522, 1000, 1000000, 16, 2);
+    simulateTalker("S 01 26000, S 06 20000, S 03 14000, S 04 40000", 9000000000ULL, 0, 1, 1522, 1000, 1000000, 16, 3);
+}
+
+TEST(Tas, SimulatedTalkerTruncatedCycle)
+{
+    // Cycle time cuts the list short, window across the end of the cycle,
+    // slow link
+    simulateTalker("S 02 50000, S 01 100000, S 02 100000", 0, 200000, 1, 300, 100, 250000, 3, 4);
+}
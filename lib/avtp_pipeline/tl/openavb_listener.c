@@ -81,6 +81,20 @@ bool listenerStartStream(tl_state_t *pTLState)
 		return FALSE;
 	}
 
+	if (pCfg->rx_busy_poll_usec) {
+		openavbAvtpConfigRxBusyPoll(pListenerData->avtpHandle, pCfg->rx_busy_poll_usec);
+	}
+
+	if (pCfg->rx_stream_filter) {
+		openavbAvtpConfigRxStreamFilter(pListenerData->avtpHandle, TRUE);
+	}
+
+	if (pCfg->queue_placement) {
+		// Only multicast addresses get a steering rule; the NIC hashes the rest
+		openavbTLPlaceStream(pTLState, &pListenerData->placement, pListenerData->ifname, FALSE,
+			(pListenerData->destAddr[0] & 0x01) ? pListenerData->destAddr : NULL);
+	}
+
 	// Setup timers
 	U64 nowNS;
 	CLOCK_GETTIME64(OPENAVB_TIMER_CLOCK, &nowNS);
@@ -133,6 +147,7 @@ void listenerStopStream(tl_state_t *pTLState)
 
 	if (pTLState->bStreaming) {
 		openavbAvtpShutdownListener(pListenerData->avtpHandle);
+		openavbPlacementRelease(&pListenerData->placement);
 		pTLState->bStreaming = FALSE;
 	}
 
@@ -156,11 +171,29 @@ static inline void listenerShowStats(listener_data_t *pListenerData, tl_state_t
 	AVB_LOGRT_INFO(FALSE, LOG_RT_ITEM, FALSE, "mqbuf=%d, ", LOG_RT_DATATYPE_U32, &mqbuf);
 	AVB_LOGRT_INFO(FALSE, LOG_RT_ITEM, LOG_RT_END, "mqrdy=%d", LOG_RT_DATATYPE_U32, &mqrdy);
 
+	U32 wakeMin, wakeP50, wakeP99, wakeMax;
+	if (openavbAvtpRxWakeLatency(pListenerData->avtpHandle, &wakeMin, &wakeP50, &wakeP99, &wakeMax)) {
+		AVB_LOGRT_INFO(LOG_RT_BEGIN, LOG_RT_ITEM, FALSE, "RX UID:%d wake usec ", LOG_RT_DATATYPE_U16, &pListenerData->streamID.uniqueID);
+		AVB_LOGRT_INFO(FALSE, LOG_RT_ITEM, FALSE, "min=%u, ", LOG_RT_DATATYPE_U32, &wakeMin);
+		AVB_LOGRT_INFO(FALSE, LOG_RT_ITEM, FALSE, "p50=%u, ", LOG_RT_DATATYPE_U32, &wakeP50);
+		AVB_LOGRT_INFO(FALSE, LOG_RT_ITEM, FALSE, "p99=%u, ", LOG_RT_DATATYPE_U32, &wakeP99);
+		AVB_LOGRT_INFO(FALSE, LOG_RT_ITEM, LOG_RT_END, "max=%u", LOG_RT_DATATYPE_U32, &wakeMax);
+	}
+
+	U64 filterPassed, filterDropped;
+	U32 filterStreams;
+	if (openavbAvtpRxFilterCounts(pListenerData->avtpHandle, &filterPassed, &filterDropped, &filterStreams)) {
+		AVB_LOGRT_INFO(LOG_RT_BEGIN, LOG_RT_ITEM, FALSE, "RX UID:%d kernel filter ", LOG_RT_DATATYPE_U16, &pListenerData->streamID.uniqueID);
+		AVB_LOGRT_INFO(FALSE, LOG_RT_ITEM, FALSE, "passed=%lld, ", LOG_RT_DATATYPE_U64, &filterPassed);
+		AVB_LOGRT_INFO(FALSE, LOG_RT_ITEM, FALSE, "dropped=%lld, ", LOG_RT_DATATYPE_U64, &filterDropped);
+		AVB_LOGRT_INFO(FALSE, LOG_RT_ITEM, LOG_RT_END, "streams=%u", LOG_RT_DATATYPE_U32, &filterStreams);
+	}
+
 	openavbListenerAddStat(pTLState, TL_STAT_RX_LOST, lost);
 	openavbListenerAddStat(pTLState, TL_STAT_RX_BYTES, bytes);
 }
 
-static inline bool listenerDoStream(tl_state_t *pTLState)
+bool listenerDoStream(tl_state_t *pTLState)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_TL);
 
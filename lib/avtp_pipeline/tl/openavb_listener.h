@@ -55,6 +55,7 @@ typedef struct {
 
 	// State info for streaming
 	void			*avtpHandle;
+	openavb_placement_t placement;
 	unsigned long	nReportFrames;
 	unsigned long	nReportCalls;
 	U64 			nextReportNS;
@@ -71,5 +72,7 @@ U64 openavbListenerGetStat(tl_state_t *pTLState, tl_stat_t stat);
 bool openavbTLRunListenerInit(int h, AVBStreamID_t *streamID);
 bool listenerStartStream(tl_state_t *pTLState);
 void listenerStopStream(tl_state_t *pTLState);
+// One pass of the listener loop. Returns TRUE when the endpoint IPC is due.
+bool listenerDoStream(tl_state_t *pTLState);
 
 #endif  // OPENAVB_TL_LISTENER_H
@@ -51,6 +51,84 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 
 
 
+static bool talkerTasInit(openavb_tl_cfg_t *pCfg, talker_data_t *pTalkerData, U32 frameLen)
+{
+	network_hal_tas_config_t tasCfg;
+	char taprio[256];
+	U64 openNS;
+
+	memset(&tasCfg, 0, sizeof(tasCfg));
+	tasCfg.base_time_ns = pCfg->tas_base_time;
+	tasCfg.cycle_time_ns = pCfg->tas_cycle_time;
+	if (network_hal_tas_parse(pCfg->tas_gcl, &tasCfg) != NETWORK_HAL_SUCCESS ||
+		network_hal_tas_init(&pTalkerData->tas, &tasCfg) != NETWORK_HAL_SUCCESS) {
+		AVB_LOGF_ERROR("Invalid tas_gcl: %s", pCfg->tas_gcl);
+		return FALSE;
+	}
+
+	pTalkerData->tasFrameNS = network_hal_tas_frame_time_ns(frameLen, pCfg->tas_link_mbps);
+	if (!network_hal_tas_admit(&pTalkerData->tas, pCfg->tas_traffic_class, tasCfg.base_time_ns,
+			pTalkerData->tasFrameNS, 1, &openNS)) {
+		AVB_LOGF_ERROR("tas_gcl never opens traffic class %u for a %" PRIu64 "ns frame",
+			pCfg->tas_traffic_class, pTalkerData->tasFrameNS);
+		return FALSE;
+	}
+
+	network_hal_tas_format_taprio(&tasCfg, taprio, sizeof(taprio));
+	AVB_LOGF_INFO("Software time-aware shaper on traffic class %u, frame=%" PRIu64 "ns; taprio equivalent: %s",
+		pCfg->tas_traffic_class, pTalkerData->tasFrameNS, taprio);
+
+	pTalkerData->tasEnabled = TRUE;
+	return TRUE;
+}
+
+// Send a batch of frames in the gate windows of the stream's traffic class.
+// Each window takes as many frames as finish in it; the talker waits for the
+// next window for the rest. Returns the number of frames sent.
+static unsigned long talkerTasTx(openavb_tl_cfg_t *pCfg, talker_data_t *pTalkerData, unsigned long frames)
+{
+	unsigned long sent = 0;
+
+	while (sent < frames) {
+		U64 wallNS, startNS;
+		U32 admitted, i;
+
+		CLOCK_GETTIME64(OPENAVB_CLOCK_WALLTIME, &wallNS);
+		admitted = network_hal_tas_admit(&pTalkerData->tas, pCfg->tas_traffic_class, wallNS,
+			pTalkerData->tasFrameNS, frames - sent, &startNS);
+		if (!admitted) {
+			break;
+		}
+
+		if (startNS > wallNS) {
+			// Gate closed or wire still busy. Wake-ups run late, so admit
+			// again from the time we actually get there.
+			if (pCfg->spin_wait) {
+				SPIN_UNTIL_NSEC(startNS);
+			}
+			else {
+				U64 timerNS;
+				CLOCK_GETTIME64(OPENAVB_TIMER_CLOCK, &timerNS);
+				SLEEP_UNTIL_NSEC(timerNS + (startNS - wallNS));
+			}
+			continue;
+		}
+
+		for (i = 0; i < admitted; i++) {
+			if (IS_OPENAVB_FAILURE(openavbAvtpTx(pTalkerData->avtpHandle, i == admitted - 1, FALSE))) {
+				break;
+			}
+		}
+		network_hal_tas_commit(&pTalkerData->tas, startNS, i, pTalkerData->tasFrameNS);
+		sent += i;
+		if (i < admitted) {
+			break;
+		}
+	}
+
+	return sent;
+}
+
 bool talkerStartStream(tl_state_t *pTLState)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_TL);
@@ -104,6 +182,28 @@ bool talkerStartStream(tl_state_t *pTLState)
 
 	avtp_stream_t *pStream = (avtp_stream_t *)(pTalkerData->avtpHandle);
 
+	if (pCfg->tx_launch_time) {
+		openavbAvtpConfigTxLaunchTime(pTalkerData->avtpHandle, TRUE);
+	}
+
+	pTalkerData->tasEnabled = FALSE;
+	if (pCfg->tas_gcl[0] != '\0') {
+		if (pCfg->tx_launch_time) {
+			AVB_LOG_WARNING("tas_gcl ignored with tx_launch_time; use a taprio qdisc instead");
+		}
+		else if (pCfg->tx_blocking_in_intf) {
+			AVB_LOG_WARNING("tas_gcl ignored with tx_blocking_in_intf");
+		}
+		else if (!talkerTasInit(pCfg, pTalkerData, pStream->frameLen)) {
+			AVB_TRACE_EXIT(AVB_TRACE_TL);
+			return FALSE;
+		}
+	}
+
+	if (pCfg->queue_placement) {
+		openavbTLPlaceStream(pTLState, &pTalkerData->placement, pTalkerData->ifname, TRUE, NULL);
+	}
+
 	pTalkerData->wakeRate = transmitInterval / pCfg->batch_factor;
 
 	pTalkerData->sleepUsec = MICROSECONDS_PER_SECOND / pTalkerData->wakeRate;
@@ -189,6 +289,7 @@ void talkerStopStream(tl_state_t *pTLState)
 
 	if (pTLState->bStreaming) {
 		openavbAvtpShutdownTalker(pTalkerData->avtpHandle);
+		openavbPlacementRelease(&pTalkerData->placement);
 		pTLState->bStreaming = FALSE;
 	}
 
@@ -202,6 +303,7 @@ static inline void talkerShowStats(talker_data_t *pTalkerData, tl_state_t *pTLSt
 	if (late < 0) late = 0;
 	U32 txbuf = openavbAvtpTxBufferLevel(pTalkerData->avtpHandle);
 	U32 mqbuf = openavbMediaQCountItems(pTLState->pMediaQ, TRUE);
+	U32 missed = openavbAvtpTxLaunchMissed(pTalkerData->avtpHandle);
 
 	AVB_LOGRT_INFO(LOG_RT_BEGIN, LOG_RT_ITEM, FALSE, "TX UID:%d, ", LOG_RT_DATATYPE_U16, &pTalkerData->streamID.uniqueID);
 	AVB_LOGRT_INFO(FALSE, LOG_RT_ITEM, FALSE, "calls=%ld, ", LOG_RT_DATATYPE_U32, &pTalkerData->cntWakes);
@@ -209,13 +311,14 @@ static inline void talkerShowStats(talker_data_t *pTalkerData, tl_state_t *pTLSt
 	AVB_LOGRT_INFO(FALSE, LOG_RT_ITEM, FALSE, "late=%d, ", LOG_RT_DATATYPE_U32, &late);
 	AVB_LOGRT_INFO(FALSE, LOG_RT_ITEM, FALSE, "bytes=%lld, ", LOG_RT_DATATYPE_U64, &bytes);
 	AVB_LOGRT_INFO(FALSE, LOG_RT_ITEM, FALSE, "txbuf=%d, ", LOG_RT_DATATYPE_U32, &txbuf);
-	AVB_LOGRT_INFO(FALSE, LOG_RT_ITEM, LOG_RT_END, "mqbuf=%d, ", LOG_RT_DATATYPE_U32, &mqbuf);
+	AVB_LOGRT_INFO(FALSE, LOG_RT_ITEM, FALSE, "mqbuf=%d, ", LOG_RT_DATATYPE_U32, &mqbuf);
+	AVB_LOGRT_INFO(FALSE, LOG_RT_ITEM, LOG_RT_END, "missed=%d", LOG_RT_DATATYPE_U32, &missed);
 
 	openavbTalkerAddStat(pTLState, TL_STAT_TX_LATE, late);
 	openavbTalkerAddStat(pTLState, TL_STAT_TX_BYTES, bytes);
 }
 
-static inline bool talkerDoStream(tl_state_t *pTLState)
+bool talkerDoStream(tl_state_t *pTLState)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_TL);
 
@@ -239,19 +342,27 @@ static inline bool talkerDoStream(tl_state_t *pTLState)
 				SLEEP_UNTIL_NSEC(pTalkerData->nextCycleNS);
 			} else {
 #if !IGB_LAUNCHTIME_ENABLED && !ATL_LAUNCHTIME_ENABLED
-				SPIN_UNTIL_NSEC(pTalkerData->nextCycleNS);
+				// With launch times the qdisc paces the frames
+				if (!((avtp_stream_t *)pTalkerData->avtpHandle)->txLaunchTime) {
+					SPIN_UNTIL_NSEC(pTalkerData->nextCycleNS);
+				}
 #endif
 			}
 
 			//AVB_DBG_INTERVAL(8000, TRUE);
 
 			// send the frames for this interval
-			int i;
-			for (i = pTalkerData->wakeFrames; i > 0; i--) {
-				if (IS_OPENAVB_SUCCESS(openavbAvtpTx(pTalkerData->avtpHandle, i == 1, pCfg->tx_blocking_in_intf)))
-					pTalkerData->cntFrames++;
-				else
-					break;
+			if (pTalkerData->tasEnabled) {
+				pTalkerData->cntFrames += talkerTasTx(pCfg, pTalkerData, pTalkerData->wakeFrames);
+			}
+			else {
+				int i;
+				for (i = pTalkerData->wakeFrames; i > 0; i--) {
+					if (IS_OPENAVB_SUCCESS(openavbAvtpTx(pTalkerData->avtpHandle, i == 1, pCfg->tx_blocking_in_intf)))
+						pTalkerData->cntFrames++;
+					else
+						break;
+				}
 			}
 		}
 		else {
@@ -37,6 +37,7 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #define OPENAVB_TL_TALKER_H 1
 
 #include "openavb_tl.h"
+#include "hal/network_hal_tas.h"
 
 typedef struct {
 	// Data from callback
@@ -52,6 +53,7 @@ typedef struct {
 
 	// State info for streaming
 	void			*avtpHandle;
+	openavb_placement_t placement;
 	unsigned long 	sleepUsec;
 	unsigned long	wakeRate;
 	unsigned long	wakeFrames;
@@ -64,6 +66,11 @@ typedef struct {
 	U64				nextSecondNS;
 	unsigned long	lastReportFrames;
 	talker_stats_t	stats;
+
+	// Software time-aware shaper (tas_gcl)
+	bool			tasEnabled;
+	U64				tasFrameNS;
+	network_hal_tas_t	tas;
 } talker_data_t;
 
 
@@ -74,6 +81,8 @@ void openavbTalkerAddStat(tl_state_t *pTLState, tl_stat_t stat, U64 val);
 U64 openavbTalkerGetStat(tl_state_t *pTLState, tl_stat_t stat);
 bool talkerStartStream(tl_state_t *pTLState);
 void talkerStopStream(tl_state_t *pTLState);
+// One pass of the talker loop. Returns TRUE when the endpoint IPC is due.
+bool talkerDoStream(tl_state_t *pTLState);
 bool openavbTLRunTalkerInit(tl_state_t *pTLState);
 void openavbTLRunTalkerFinish(tl_state_t *pTLState);
 
@@ -39,6 +39,7 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #include "openavb_tl.h"
 #include "openavb_trace.h"
 #include "openavb_mediaq.h"
+#include "openavb_arena.h"
 #include "openavb_talker.h"
 #include "openavb_listener.h"
 #include "openavb_avdecc_msg.h"
@@ -53,6 +54,7 @@ tl_handle_t *gTLHandleList;
 
 // We are accessed from multiple threads, so need a mutex
 MUTEX_HANDLE(gTLStateMutex);
+MUTEX_HANDLE(gTLPluginMutex);
 
 #define MATCH(A, B)(strcasecmp((A), (B)) == 0)
 //#define MATCH_LEFT(A, B, C)(strncasecmp((A), (B), (C)) == 0)
@@ -290,6 +292,16 @@ EXTERN_DLL_EXPORT bool openavbTLInitialize(U32 maxTL)
 		MUTEX_LOG_ERR("Error creating mutex");
 	}
 
+	{
+		MUTEX_ATTR_HANDLE(mta);
+		MUTEX_ATTR_INIT(mta);
+		MUTEX_ATTR_SET_TYPE(mta, MUTEX_ATTR_TYPE_DEFAULT);
+		MUTEX_ATTR_SET_NAME(mta, "gTLPluginMutex");
+		MUTEX_CREATE_ERR();
+		MUTEX_CREATE(gTLPluginMutex, mta);
+		MUTEX_LOG_ERR("Error creating mutex");
+	}
+
 	gTLHandleList = calloc(1, sizeof(tl_handle_t) * gMaxTL);
 	if (gTLHandleList) {
 		AVB_TRACE_EXIT(AVB_TRACE_TL);
@@ -319,6 +331,12 @@ EXTERN_DLL_EXPORT bool openavbTLCleanup()
 		MUTEX_LOG_ERR("Error destroying mutex");
 	}
 
+	{
+		MUTEX_CREATE_ERR();
+		MUTEX_DESTROY(gTLPluginMutex);
+		MUTEX_LOG_ERR("Error destroying mutex");
+	}
+
 	AVB_TRACE_EXIT(AVB_TRACE_TL);
 	return TRUE;
 }
@@ -389,6 +407,14 @@ EXTERN_DLL_EXPORT void openavbTLInitCfg(openavb_tl_cfg_t *pCfg)
 	pCfg->raw_rx_buffers = 100;
 	pCfg->tx_blocking_in_intf =  0;
 	pCfg->rx_signal_mode = 1;
+	pCfg->rx_busy_poll_usec = 0;
+	pCfg->rx_stream_filter = FALSE;
+	pCfg->tx_launch_time = FALSE;
+	pCfg->tas_gcl[0] = '\0';
+	pCfg->tas_base_time = 0;
+	pCfg->tas_cycle_time = 0;
+	pCfg->tas_traffic_class = 0;
+	pCfg->tas_link_mbps = 1000;
 	pCfg->pMapInitFn = NULL;
 	pCfg->pIntfInitFn = NULL;
 	pCfg->vlan_id = 0;
@@ -396,51 +422,18 @@ EXTERN_DLL_EXPORT void openavbTLInitCfg(openavb_tl_cfg_t *pCfg)
 	pCfg->spin_wait = FALSE;
 	pCfg->thread_rt_priority = 0;
 	pCfg->thread_affinity = 0xFFFFFFFF;
+	pCfg->queue_placement = FALSE;
+	pCfg->nic_queue = -1;
 
 	AVB_TRACE_EXIT(AVB_TRACE_TL);
 }
 
-EXTERN_DLL_EXPORT bool openavbTLConfigure(tl_handle_t handle, openavb_tl_cfg_t *pCfgIn, openavb_tl_cfg_name_value_t *pNVCfg)
+// Open the mapping and interface modules, initialize and configure them.
+// Caller holds the plugin mutex.
+static bool initPlugins(tl_state_t *pTLState, openavb_tl_cfg_name_value_t *pNVCfg)
 {
-	AVB_TRACE_ENTRY(AVB_TRACE_TL);
-
-	tl_state_t *pTLState = (tl_state_t *)handle;
-
-	if (!pTLState) {
-		AVB_LOG_ERROR("Invalid handle.");
-		AVB_TRACE_EXIT(AVB_TRACE_TL);
-		return FALSE;
-	}
-
-	// Create the mediaQ
-	pTLState->pMediaQ = openavbMediaQCreate();
-	if (!pTLState->pMediaQ) {
-		AVB_LOG_ERROR("Unable to create media queue");
-		AVB_TRACE_EXIT(AVB_TRACE_TL);
-		return FALSE;
-	}
-
-	// CORE_TODO: It's not safe to simply copy the openavb_tl_cfg_t since there are embedded pointers in the cfg_mac_t member.
-	// Those pointers need to be updated after a copy. Longer term the cfg_mac_t should be changed to not contain the mac
-	// member to remedy this issue and avoid further bugs.
-	memcpy(&pTLState->cfg, pCfgIn, sizeof(openavb_tl_cfg_t));
-	pTLState->cfg.dest_addr.mac = &pTLState->cfg.dest_addr.buffer;
-	pTLState->cfg.stream_addr.mac = &pTLState->cfg.stream_addr.buffer;
-
 	openavb_tl_cfg_t *pCfg = &pTLState->cfg;
 
-	if (!((pCfg->role == AVB_ROLE_TALKER) || (pCfg->role == AVB_ROLE_LISTENER))) {
-		AVB_LOG_ERROR("Talker - Listener Config Error: invalid role");
-		return FALSE;
-	}
-
-	if ((pCfg->role == AVB_ROLE_TALKER) && (pCfg->max_interval_frames == 0)) {
-		AVB_LOG_ERROR("Talker - Listener Config Error: talker role requires 'max_interval_frames'");
-		return FALSE;
-	}
-
-	openavbMediaQSetMaxStaleTail(pTLState->pMediaQ, pCfg->max_stale);
-
 	if (!openavbTLOpenLinkLibsOsal(pTLState)) {
 		AVB_LOG_ERROR("Failed to open mapping / interface library");
 		return FALSE;
@@ -489,6 +482,61 @@ EXTERN_DLL_EXPORT bool openavbTLConfigure(tl_handle_t handle, openavb_tl_cfg_t *
 	pTLState->cfg.map_cb.map_gen_init_cb(pTLState->pMediaQ);
 	pTLState->cfg.intf_cb.intf_gen_init_cb(pTLState->pMediaQ);
 
+	return TRUE;
+}
+
+EXTERN_DLL_EXPORT bool openavbTLConfigure(tl_handle_t handle, openavb_tl_cfg_t *pCfgIn, openavb_tl_cfg_name_value_t *pNVCfg)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TL);
+
+	tl_state_t *pTLState = (tl_state_t *)handle;
+
+	if (!pTLState) {
+		AVB_LOG_ERROR("Invalid handle.");
+		AVB_TRACE_EXIT(AVB_TRACE_TL);
+		return FALSE;
+	}
+
+	// Create the mediaQ
+	pTLState->pMediaQ = openavbMediaQCreate();
+	if (!pTLState->pMediaQ) {
+		AVB_LOG_ERROR("Unable to create media queue");
+		AVB_TRACE_EXIT(AVB_TRACE_TL);
+		return FALSE;
+	}
+
+	// CORE_TODO: It's not safe to simply copy the openavb_tl_cfg_t since there are embedded pointers in the cfg_mac_t member.
+	// Those pointers need to be updated after a copy. Longer term the cfg_mac_t should be changed to not contain the mac
+	// member to remedy this issue and avoid further bugs.
+	memcpy(&pTLState->cfg, pCfgIn, sizeof(openavb_tl_cfg_t));
+	pTLState->cfg.dest_addr.mac = &pTLState->cfg.dest_addr.buffer;
+	pTLState->cfg.stream_addr.mac = &pTLState->cfg.stream_addr.buffer;
+
+	openavb_tl_cfg_t *pCfg = &pTLState->cfg;
+
+	if (!((pCfg->role == AVB_ROLE_TALKER) || (pCfg->role == AVB_ROLE_LISTENER))) {
+		AVB_LOG_ERROR("Talker - Listener Config Error: invalid role");
+		return FALSE;
+	}
+
+	if ((pCfg->role == AVB_ROLE_TALKER) && (pCfg->max_interval_frames == 0)) {
+		AVB_LOG_ERROR("Talker - Listener Config Error: talker role requires 'max_interval_frames'");
+		return FALSE;
+	}
+
+	openavbMediaQSetMaxStaleTail(pTLState->pMediaQ, pCfg->max_stale);
+
+	// Keep the item buffers on the NUMA node of the CPU or NIC that will touch them
+	openavbMediaQSetArenaNode(pTLState->pMediaQ, openavbArenaNodeForStream(pCfg->ifname, pCfg->thread_affinity));
+
+	// openavbTLStartBatchOsal() configures several streams at once
+	TL_PLUGIN_LOCK();
+	bool bPluginsOk = initPlugins(pTLState, pNVCfg);
+	TL_PLUGIN_UNLOCK();
+	if (!bPluginsOk) {
+		return FALSE;
+	}
+
 	// Initialize the AVDECC support for this Talker/Listener.
 	pTLState->bAvdeccMsgRunning = TRUE;
 	THREAD_CREATE_AVDECC_MSG();
@@ -496,6 +544,28 @@ EXTERN_DLL_EXPORT bool openavbTLConfigure(tl_handle_t handle, openavb_tl_cfg_t *
 	return TRUE;
 }
 
+void openavbTLPlaceStream(tl_state_t *pTLState, openavb_placement_t *pPlacement, const char *ifname, bool tx, const U8 *destAddr)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TL);
+
+	openavb_tl_cfg_t *pCfg = &pTLState->cfg;
+
+	if (!openavbPlacementAssign(pPlacement, ifname, tx, pCfg->nic_queue, destAddr) || pPlacement->cpu < 0) {
+		AVB_TRACE_EXIT(AVB_TRACE_TL);
+		return;
+	}
+
+	if (pCfg->thread_affinity == 0xFFFFFFFF) {
+		openavbPlacementPinThread(pPlacement);
+	}
+	else if (pPlacement->cpu >= 32 || !(pCfg->thread_affinity & (1U << pPlacement->cpu))) {
+		AVB_LOGF_WARNING("thread_affinity 0x%x does not include core %d of NIC queue %d",
+			pCfg->thread_affinity, pPlacement->cpu, pPlacement->queue);
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_TL);
+}
+
 EXTERN_DLL_EXPORT bool openavbTLRun(tl_handle_t handle)
 {
 	bool retVal = FALSE;
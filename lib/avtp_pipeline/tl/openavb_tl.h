@@ -40,6 +40,7 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #include "openavb_osal.h"
 #include "openavb_mediaq_pub.h"
 #include "openavb_tl_pub.h"
+#include "openavb_placement.h"
 
 typedef enum OPENAVB_TL_AVB_VER_STATE 
 {
@@ -119,6 +120,15 @@ extern MUTEX_HANDLE(gTLStateMutex);
 #define TL_LOCK() { MUTEX_CREATE_ERR(); MUTEX_LOCK(gTLStateMutex); MUTEX_LOG_ERR("Mutex lock failure"); }
 #define TL_UNLOCK() { MUTEX_CREATE_ERR(); MUTEX_UNLOCK(gTLStateMutex); MUTEX_LOG_ERR("Mutex unlock failure"); }
 
+////////////////
+// TL plugin mutex
+////////////////
+// Mapping and interface modules are not required to be thread safe, so their
+// initialize and configuration callbacks never run for two streams at once.
+extern MUTEX_HANDLE(gTLPluginMutex);
+#define TL_PLUGIN_LOCK() { MUTEX_CREATE_ERR(); MUTEX_LOCK(gTLPluginMutex); MUTEX_LOG_ERR("Mutex lock failure"); }
+#define TL_PLUGIN_UNLOCK() { MUTEX_CREATE_ERR(); MUTEX_UNLOCK(gTLPluginMutex); MUTEX_LOG_ERR("Mutex unlock failure"); }
+
 ////////////////
 // TL stats mutex
 ////////////////
@@ -144,6 +154,10 @@ tl_handle_t TLHandleListGet(int endpointHandle);
 bool TLHandleListRemove(tl_handle_t handle);
 void openavbTLUnconfigure(tl_state_t *pTLState);
 
+// Place the stream on a NIC queue and core (queue_placement) and pin the calling
+// TL thread to that core, unless thread_affinity pins it already.
+void openavbTLPlaceStream(tl_state_t *pTLState, openavb_placement_t *pPlacement, const char *ifname, bool tx, const U8 *destAddr);
+
 // Remove a tl_handle_t from the TL handle list.
 bool TLHandleRemove(tl_handle_t handle);
 
@@ -80,6 +80,7 @@ typedef enum {
 
 /// Maximum size of the friendly name
 #define FRIENDLY_NAME_SIZE 64
+#define TAS_GCL_SIZE 512
 
 /// Initial talker/listener state
 typedef enum {
@@ -146,12 +147,32 @@ typedef struct {
 	U16 vlan_id;
 	/// When set incoming packets will trigger a signal to the stream task to wakeup.
 	bool rx_signal_mode;
+	/// Time in usec a listener spins on the RX socket before blocking. 0 disables busy polling.
+	U32 rx_busy_poll_usec;
+	/// Listener only. Drop frames of other streams in the kernel with an eBPF filter on the RX socket.
+	bool rx_stream_filter;
+	/// Talker only. Queue TX frames with a launch time (SO_TXTIME) for the ETF qdisc.
+	bool tx_launch_time;
+	/// Talker only. Gate control list for software time-aware shaping, e.g. "S 01 300000,S fe 700000". Empty disables it.
+	char tas_gcl[TAS_GCL_SIZE];
+	/// Talker only. Start of the first gate control cycle, gPTP time in nsec.
+	U64 tas_base_time;
+	/// Talker only. Gate control cycle time in nsec. 0 uses the sum of the tas_gcl intervals.
+	U64 tas_cycle_time;
+	/// Talker only. Traffic class (gate) of the stream in tas_gcl.
+	U8 tas_traffic_class;
+	/// Talker only. Link speed in Mbit/s, used to size the frames against the gate windows.
+	U32 tas_link_mbps;
 	/// Enable fixed timestamping in interface
 	U32 fixed_timestamp;
 	/// Wait for next observation interval by spinning rather than sleeping
 	bool spin_wait;
 	/// Bit mask used for CPU pinning
 	U32 thread_affinity;
+	/// Place the stream on a NIC queue and run the thread on a core that serves that queue.
+	bool queue_placement;
+	/// NIC queue for queue_placement. -1 picks the least loaded one.
+	S32 nic_queue;
 	/// Real time priority of thread.
 	U32 thread_rt_priority;
 	/// Friendly name for this configuration
@@ -391,6 +412,59 @@ U64 openavbTLStat(tl_handle_t handle, tl_stat_t stat);
 bool openavbTLReadIniFileOsal(tl_handle_t TLhandle, const char *fileName, openavb_tl_cfg_t *pCfg, openavb_tl_cfg_name_value_t *pNVCfg);
 
 
+/// Upper bound on the worker threads used by openavbTLStartBatchOsal()
+#define TL_STARTUP_MAX_WORKERS 32
+
+/// Per-phase timings of a batched startup, in microseconds
+typedef struct {
+	/// Number of streams requested
+	U32 nStreams;
+	/// Number of streams parsed and configured successfully
+	U32 nConfigured;
+	/// Number of worker threads used for the parse and configure phases
+	U32 nWorkers;
+	/// Opening the talker/listener handles
+	U64 openUsec;
+	/// Reading all ini files, including interface checks
+	U64 parseUsec;
+	/// Media queue allocation, plugin lookup and mapping/interface initialization
+	U64 configureUsec;
+	/// Starting the talker/listener threads
+	U64 runUsec;
+	/// Whole startup
+	U64 totalUsec;
+} openavb_tl_startup_stats_t;
+
+/** Open, configure and run many streams at once.
+ *
+ * Equivalent to calling openavbTLOpen(), openavbTLReadIniFileOsal(),
+ * openavbTLConfigure() and, unless the initial state is stopped,
+ * openavbTLRun() for every ini file, but the parse and configure phases of
+ * all streams are spread over a pool of worker threads. Interface checks,
+ * the talker MAC address lookup and plugin initialize function lookups are
+ * cached and shared between streams. Streams are only run if every stream
+ * was configured successfully.
+ *
+ * Mapping and interface modules need not be thread safe: their initialize
+ * and configuration callbacks run for one stream at a time, while the rest
+ * of the configure phase runs in parallel.
+ *
+ * \param pHandles Array of count handles, filled in with the opened
+ *        talker/listeners. Handles are returned even on failure so they can
+ *        be closed with openavbTLClose()
+ * \param iniFiles Array of count configuration file names, in the format
+ *        accepted by openavbTLReadIniFileOsal()
+ * \param count Number of streams
+ * \param nWorkers Number of worker threads, 0 for one per online CPU (at least 4). Limited
+ *        to TL_STARTUP_MAX_WORKERS
+ * \param pStats Optional pointer filled in with the startup timings
+ * \return TRUE if every stream was configured, FALSE otherwise
+ *
+ * \warning Not available on all platforms
+ */
+bool openavbTLStartBatchOsal(tl_handle_t *pHandles, const char **iniFiles, U32 count, U32 nWorkers, openavb_tl_startup_stats_t *pStats);
+
+
 /** \example openavb_host.c
  * Talker / Listener example host application.
  */
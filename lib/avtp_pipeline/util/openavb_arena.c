@@ -0,0 +1,343 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+ 
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ 
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ 
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+Attributions: The inih library portion of the source code is licensed from 
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt. 
+Complete license and copyright information can be found at 
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* MODULE SUMMARY : Implementation of the per-process streaming buffer arena.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "openavb_platform.h"
+#include "openavb_types.h"
+#include "openavb_trace.h"
+#include "openavb_arena.h"
+#include "openavb_arena_osal.h"
+
+#define	AVB_LOG_COMPONENT	"Arena"
+#include "openavb_log.h"
+
+typedef struct arena_block {
+	// Bytes of the block including this header
+	size_t size;
+	// Next block on the free list of the chunk
+	struct arena_block *nextFree;
+} arena_block_t;
+
+// Each block starts with a header; the caller's data follows it aligned
+#define ARENA_BLOCK_HDR_SIZE	OPENAVB_ARENA_ALIGN(sizeof(arena_block_t))
+
+typedef struct arena_chunk {
+	struct arena_chunk *next;
+	U8 *pBase;
+	size_t size;
+	size_t used;
+	U32 liveBlocks;
+	// Freed blocks below used
+	arena_block_t *pFree;
+	int numaNode;
+	bool hugePages;
+} arena_chunk_t;
+
+static MUTEX_HANDLE_ALT(gArenaMutex);
+static bool gArenaInitialized = FALSE;
+static bool gArenaEnabled = FALSE;
+static bool gArenaHugePages = FALSE;
+static bool gArenaNuma = TRUE;
+static arena_chunk_t *gArenaChunks = NULL;
+static size_t gArenaMappedBytes = 0;
+static size_t gArenaHeapFallbacks = 0;
+static U32 gArenaChunkCount = 0;
+
+static bool x_envFlag(const char *name, bool dflt)
+{
+	const char *value = getenv(name);
+	if (!value || !value[0]) {
+		return dflt;
+	}
+	return atoi(value) != 0;
+}
+
+// Caller holds the arena mutex
+static arena_chunk_t *x_arenaNewChunk(size_t size, int numaNode)
+{
+	arena_chunk_t *pChunk = calloc(1, sizeof(arena_chunk_t));
+	if (!pChunk) {
+		return NULL;
+	}
+
+	size = (size + ARENA_OSAL_CHUNK_SIZE - 1) & ~((size_t)ARENA_OSAL_CHUNK_SIZE - 1);
+	pChunk->pBase = osalArenaMapChunk(size, numaNode, gArenaHugePages, &pChunk->hugePages);
+	if (!pChunk->pBase) {
+		free(pChunk);
+		return NULL;
+	}
+	pChunk->size = size;
+	pChunk->numaNode = numaNode;
+
+	pChunk->next = gArenaChunks;
+	gArenaChunks = pChunk;
+	gArenaMappedBytes += size;
+	gArenaChunkCount++;
+
+	AVB_LOGF_INFO("New %zu KB chunk on NUMA node %d (%s pages), %zu KB mapped in total",
+		size / 1024, numaNode, pChunk->hugePages ? "huge" : "normal", gArenaMappedBytes / 1024);
+	return pChunk;
+}
+
+bool openavbArenaInitialize(void)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_MEDIAQ);
+
+	if (!gArenaInitialized) {
+		gArenaInitialized = TRUE;
+		MUTEX_CREATE_ALT(gArenaMutex);
+		gArenaHugePages = x_envFlag("OPENAVB_ARENA_HUGEPAGES", FALSE);
+		gArenaNuma = x_envFlag("OPENAVB_ARENA_NUMA", TRUE);
+		gArenaEnabled = x_envFlag("OPENAVB_ARENA", TRUE);
+		if (gArenaEnabled) {
+			AVB_LOGF_INFO("Streaming buffer arena enabled (huge pages %s, NUMA binding %s)",
+				gArenaHugePages ? "on" : "off", gArenaNuma ? "on" : "off");
+		}
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ);
+	return TRUE;
+}
+
+void openavbArenaFinalize(void)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_MEDIAQ);
+
+	if (gArenaEnabled) {
+		MUTEX_LOCK_ALT(gArenaMutex);
+		size_t liveBytes = 0;
+		arena_chunk_t **ppChunk = &gArenaChunks;
+		while (*ppChunk) {
+			arena_chunk_t *pChunk = *ppChunk;
+			if (pChunk->liveBlocks == 0) {
+				*ppChunk = pChunk->next;
+				osalArenaUnmapChunk(pChunk->pBase, pChunk->size);
+				gArenaMappedBytes -= pChunk->size;
+				gArenaChunkCount--;
+				free(pChunk);
+			}
+			else {
+				// Still referenced (e.g. an orphaned media queue); leave it mapped
+				liveBytes += pChunk->used;
+				ppChunk = &pChunk->next;
+			}
+		}
+		AVB_LOGF_INFO("Arena closed: %zu KB still in use, %zu heap fallbacks", liveBytes / 1024, gArenaHeapFallbacks);
+		MUTEX_UNLOCK_ALT(gArenaMutex);
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ);
+}
+
+void *openavbArenaAlloc(size_t size, int numaNode)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_MEDIAQ);
+
+	if (size == 0) {
+		AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ);
+		return NULL;
+	}
+
+	if (!gArenaEnabled) {
+		AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ);
+		return calloc(1, size);
+	}
+
+	if (!gArenaNuma) {
+		numaNode = OPENAVB_ARENA_NODE_ANY;
+	}
+	size_t dataSize = size;
+	size = ARENA_BLOCK_HDR_SIZE + OPENAVB_ARENA_ALIGN(size);
+
+	MUTEX_LOCK_ALT(gArenaMutex);
+
+	// Best fit among the freed blocks of the node
+	arena_chunk_t *pChunk;
+	arena_chunk_t *pFitChunk = NULL;
+	arena_block_t **ppFit = NULL;
+	for (pChunk = gArenaChunks; pChunk; pChunk = pChunk->next) {
+		if (pChunk->numaNode != numaNode) {
+			continue;
+		}
+		arena_block_t **ppBlock;
+		for (ppBlock = &pChunk->pFree; *ppBlock; ppBlock = &(*ppBlock)->nextFree) {
+			if ((*ppBlock)->size >= size && (!ppFit || (*ppBlock)->size < (*ppFit)->size)) {
+				pFitChunk = pChunk;
+				ppFit = ppBlock;
+			}
+		}
+	}
+
+	arena_block_t *pBlock = NULL;
+	if (ppFit) {
+		pChunk = pFitChunk;
+		pBlock = *ppFit;
+		*ppFit = pBlock->nextFree;
+		if (pBlock->size - size >= ARENA_BLOCK_HDR_SIZE + OPENAVB_ARENA_ALIGNMENT) {
+			// Return the tail of a larger block to the free list
+			arena_block_t *pRest = (arena_block_t *)((U8 *)pBlock + size);
+			pRest->size = pBlock->size - size;
+			pRest->nextFree = pChunk->pFree;
+			pChunk->pFree = pRest;
+			pBlock->size = size;
+		}
+	}
+	else {
+		for (pChunk = gArenaChunks; pChunk; pChunk = pChunk->next) {
+			if (pChunk->numaNode == numaNode && pChunk->size - pChunk->used >= size) {
+				break;
+			}
+		}
+		if (!pChunk) {
+			pChunk = x_arenaNewChunk(size, numaNode);
+		}
+		if (pChunk) {
+			pBlock = (arena_block_t *)(pChunk->pBase + pChunk->used);
+			pBlock->size = size;
+			pChunk->used += size;
+		}
+	}
+
+	void *ptr = NULL;
+	if (pBlock) {
+		pBlock->nextFree = NULL;
+		pChunk->liveBlocks++;
+		ptr = (U8 *)pBlock + ARENA_BLOCK_HDR_SIZE;
+	}
+	else {
+		gArenaHeapFallbacks++;
+	}
+
+	MUTEX_UNLOCK_ALT(gArenaMutex);
+
+	if (ptr) {
+		// Blocks are reused, so the block may hold data of a previous owner
+		memset(ptr, 0, dataSize);
+	}
+	else {
+		IF_LOG_INTERVAL(100) AVB_LOG_WARNING("Unable to map arena chunk; using the heap");
+		ptr = calloc(1, dataSize);
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ);
+	return ptr;
+}
+
+void openavbArenaFree(void *ptr)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_MEDIAQ);
+
+	if (!ptr) {
+		AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ);
+		return;
+	}
+
+	if (gArenaEnabled) {
+		MUTEX_LOCK_ALT(gArenaMutex);
+		arena_chunk_t *pChunk;
+		for (pChunk = gArenaChunks; pChunk; pChunk = pChunk->next) {
+			if ((U8 *)ptr >= pChunk->pBase && (U8 *)ptr < pChunk->pBase + pChunk->size) {
+				arena_block_t *pBlock = (arena_block_t *)((U8 *)ptr - ARENA_BLOCK_HDR_SIZE);
+				if (pChunk->liveBlocks && --pChunk->liveBlocks == 0) {
+					pChunk->used = 0;
+					pChunk->pFree = NULL;
+				}
+				else if ((U8 *)pBlock + pBlock->size == pChunk->pBase + pChunk->used) {
+					// Last block carved: give it back to the unused end of the chunk
+					pChunk->used -= pBlock->size;
+				}
+				else {
+					pBlock->nextFree = pChunk->pFree;
+					pChunk->pFree = pBlock;
+				}
+				break;
+			}
+		}
+		MUTEX_UNLOCK_ALT(gArenaMutex);
+
+		if (pChunk) {
+			AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ);
+			return;
+		}
+	}
+
+	free(ptr);
+
+	AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ);
+}
+
+void openavbArenaGetStats(U32 *pChunks, size_t *pMappedBytes)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_MEDIAQ);
+
+	if (gArenaInitialized) {
+		MUTEX_LOCK_ALT(gArenaMutex);
+	}
+	if (pChunks) {
+		*pChunks = gArenaChunkCount;
+	}
+	if (pMappedBytes) {
+		*pMappedBytes = gArenaMappedBytes;
+	}
+	if (gArenaInitialized) {
+		MUTEX_UNLOCK_ALT(gArenaMutex);
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ);
+}
+
+int openavbArenaNodeForStream(const char *ifname, U32 threadAffinity)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_MEDIAQ);
+
+	int node = OPENAVB_ARENA_NODE_ANY;
+
+	if (threadAffinity != 0xFFFFFFFF && threadAffinity != 0) {
+		U32 cpu = 0;
+		while (!(threadAffinity & (1U << cpu))) {
+			cpu++;
+		}
+		node = osalArenaNodeOfCpu(cpu);
+	}
+
+	if (node == OPENAVB_ARENA_NODE_ANY && ifname && ifname[0]) {
+		const char *colon = strchr(ifname, ':');
+		node = osalArenaNodeOfInterface(colon ? colon + 1 : ifname);
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ);
+	return node;
+}
@@ -0,0 +1,86 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+ 
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ 
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ 
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+Attributions: The inih library portion of the source code is licensed from 
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt. 
+Complete license and copyright information can be found at 
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* HEADER SUMMARY : Per-process memory arena for streaming buffers.
+*
+* Media queue items and rawsock staging buffers are carved contiguously out
+* of large chunks instead of being scattered across the heap by many small
+* allocations. Chunks are kept per NUMA node and can be backed by huge pages,
+* so the buffers of all streams served by one node share few TLB entries and
+* stay local to the NIC or CPU handling them.
+*
+* Blocks are released back to the chunk they came from and kept on its free
+* list, so the blocks of a stream that disconnects are reused by the next one
+* to connect. A chunk is reused from the start once every block carved from
+* it has been freed.
+*
+* Runtime control (environment, read by openavbArenaInitialize()):
+*  OPENAVB_ARENA=0            Disable the arena; allocations use the heap.
+*  OPENAVB_ARENA_HUGEPAGES=1  Back chunks with huge pages when available.
+*  OPENAVB_ARENA_NUMA=0       Do not bind chunks to a NUMA node.
+*/
+
+#ifndef OPENAVB_ARENA_H
+#define OPENAVB_ARENA_H 1
+
+#include <stddef.h>
+#include "openavb_types.h"
+
+// No NUMA preference
+#define OPENAVB_ARENA_NODE_ANY		(-1)
+
+// Alignment of every arena block
+#define OPENAVB_ARENA_ALIGNMENT		64
+#define OPENAVB_ARENA_ALIGN(size)	(((size) + OPENAVB_ARENA_ALIGNMENT - 1) & ~((size_t)OPENAVB_ARENA_ALIGNMENT - 1))
+
+// Set up the process wide arena. Until this is called all allocations come from the heap.
+bool openavbArenaInitialize(void);
+
+// Release unused chunks and log usage statistics.
+void openavbArenaFinalize(void);
+
+// Allocate a zeroed, cache line aligned block, preferably on numaNode. Falls back to
+// the heap if the arena is disabled or out of memory. Returns NULL on failure.
+void *openavbArenaAlloc(size_t size, int numaNode);
+
+// Free a block from openavbArenaAlloc(). Heap pointers are accepted as well.
+void openavbArenaFree(void *ptr);
+
+// Number of chunks and bytes currently mapped by the arena.
+void openavbArenaGetStats(U32 *pChunks, size_t *pMappedBytes);
+
+// Pick the NUMA node for a stream: the node of the first CPU in threadAffinity if
+// set (not 0xFFFFFFFF), otherwise the node of the network interface. The ifname
+// may carry a rawsock prefix ("ring:eth0"). Returns OPENAVB_ARENA_NODE_ANY if unknown.
+int openavbArenaNodeForStream(const char *ifname, U32 threadAffinity);
+
+#endif // OPENAVB_ARENA_H
@@ -0,0 +1,395 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* MODULE SUMMARY : Placement of streams on NIC queues and CPU cores.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "openavb_platform.h"
+#include "openavb_types.h"
+#include "openavb_trace.h"
+#include "openavb_placement.h"
+#include "openavb_placement_osal.h"
+
+#define	AVB_LOG_COMPONENT	"Placement"
+#include "openavb_log.h"
+
+#define PLACEMENT_MAX_IFS		8
+#define PLACEMENT_MAX_RULES		256
+
+// Streams placed on each queue of an interface
+typedef struct {
+	char ifname[IFNAMSIZ];
+	U32 txStreams[OPENAVB_PLACEMENT_MAX_QUEUES];
+	U32 rxStreams[OPENAVB_PLACEMENT_MAX_QUEUES];
+	bool rxRulesWarned;
+} placement_if_t;
+
+// RX steering rule, shared by the listeners of one destination address
+typedef struct {
+	placement_if_t *pIf;
+	U8 destAddr[ETH_ALEN];
+	int queue;
+	int location;
+	U32 refs;
+} placement_rule_t;
+
+// Cores of each queue of an interface, as read from the OS
+typedef struct {
+	openavb_cpu_mask_t cpus[OPENAVB_PLACEMENT_MAX_QUEUES];
+	openavb_placement_cpu_t source[OPENAVB_PLACEMENT_MAX_QUEUES];
+	bool usable[OPENAVB_PLACEMENT_MAX_QUEUES];
+} placement_queue_cpus_t;
+
+static MUTEX_HANDLE_ALT(gPlacementMutex);
+static bool gPlacementInitialized = FALSE;
+static placement_if_t gPlacementIfs[PLACEMENT_MAX_IFS];
+static placement_rule_t gPlacementRules[PLACEMENT_MAX_RULES];
+static U32 gPlacementCpuStreams[OPENAVB_PLACEMENT_MAX_CPUS];
+
+// Caller holds the placement mutex
+static placement_if_t *x_placementIf(const char *ifname)
+{
+	int i;
+	for (i = 0; i < PLACEMENT_MAX_IFS; i++) {
+		if (strcmp(gPlacementIfs[i].ifname, ifname) == 0) {
+			return &gPlacementIfs[i];
+		}
+	}
+	for (i = 0; i < PLACEMENT_MAX_IFS; i++) {
+		if (!gPlacementIfs[i].ifname[0]) {
+			strncpy(gPlacementIfs[i].ifname, ifname, IFNAMSIZ - 1);
+			return &gPlacementIfs[i];
+		}
+	}
+	return NULL;
+}
+
+// Caller holds the placement mutex
+static placement_rule_t *x_placementRule(placement_if_t *pIf, const U8 destAddr[ETH_ALEN])
+{
+	int i;
+	for (i = 0; i < PLACEMENT_MAX_RULES; i++) {
+		if (gPlacementRules[i].refs && gPlacementRules[i].pIf == pIf
+			&& memcmp(gPlacementRules[i].destAddr, destAddr, ETH_ALEN) == 0) {
+			return &gPlacementRules[i];
+		}
+	}
+	return NULL;
+}
+
+// Least loaded queue; with usable set, only those with known cores. Caller holds the placement mutex
+static int x_placementPickQueue(const U32 *pStreams, int nQueues, const bool *usable)
+{
+	int best = -1;
+	int q;
+	for (q = 0; q < nQueues; q++) {
+		if (usable && !usable[q]) {
+			continue;
+		}
+		if (best < 0 || pStreams[q] < pStreams[best]) {
+			best = q;
+		}
+	}
+	return best;
+}
+
+// Least loaded core in the mask. Caller holds the placement mutex
+static int x_placementPickCpu(const openavb_cpu_mask_t *pMask)
+{
+	int best = -1;
+	int cpu;
+	for (cpu = 0; cpu < OPENAVB_PLACEMENT_MAX_CPUS; cpu++) {
+		if (OPENAVB_CPU_MASK_ISSET(pMask, cpu)
+			&& (best < 0 || gPlacementCpuStreams[cpu] < gPlacementCpuStreams[best])) {
+			best = cpu;
+		}
+	}
+	return best;
+}
+
+// Restrict pMask to the allowed cores; FALSE if nothing is left
+static bool x_placementAllowed(openavb_cpu_mask_t *pMask, const openavb_cpu_mask_t *pAllowed)
+{
+	bool any = FALSE;
+	int i;
+	for (i = 0; i < OPENAVB_PLACEMENT_MAX_CPUS / 64; i++) {
+		pMask->bits[i] &= pAllowed->bits[i];
+		if (pMask->bits[i]) {
+			any = TRUE;
+		}
+	}
+	return any;
+}
+
+bool openavbPlacementInitialize(void)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TL);
+
+	if (!gPlacementInitialized) {
+		MUTEX_CREATE_ALT(gPlacementMutex);
+		memset(gPlacementIfs, 0, sizeof(gPlacementIfs));
+		memset(gPlacementRules, 0, sizeof(gPlacementRules));
+		memset(gPlacementCpuStreams, 0, sizeof(gPlacementCpuStreams));
+		gPlacementInitialized = TRUE;
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_TL);
+	return TRUE;
+}
+
+void openavbPlacementFinalize(void)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TL);
+
+	if (gPlacementInitialized) {
+		int i;
+		MUTEX_LOCK_ALT(gPlacementMutex);
+		for (i = 0; i < PLACEMENT_MAX_RULES; i++) {
+			if (gPlacementRules[i].refs) {
+				osalPlacementDelRxRule(gPlacementRules[i].pIf->ifname, gPlacementRules[i].location);
+				gPlacementRules[i].refs = 0;
+			}
+		}
+		MUTEX_UNLOCK_ALT(gPlacementMutex);
+		MUTEX_DESTROY_ALT(gPlacementMutex);
+		gPlacementInitialized = FALSE;
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_TL);
+}
+
+bool openavbPlacementAssign(openavb_placement_t *pPlacement, const char *ifname, bool tx, int queue, const U8 destAddr[ETH_ALEN])
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TL);
+
+	if (!pPlacement || !ifname || !gPlacementInitialized) {
+		AVB_LOG_ERROR("Placing stream; invalid arguments");
+		AVB_TRACE_EXIT(AVB_TRACE_TL);
+		return FALSE;
+	}
+
+	memset(pPlacement, 0, sizeof(*pPlacement));
+	const char *colon = strchr(ifname, ':');
+	strncpy(pPlacement->ifname, colon ? colon + 1 : ifname, IFNAMSIZ - 1);
+	pPlacement->tx = tx;
+	pPlacement->queue = -1;
+	pPlacement->cpu = -1;
+	pPlacement->ruleIdx = -1;
+
+	int nQueues = osalPlacementQueueCount(pPlacement->ifname, tx);
+	if (nQueues > OPENAVB_PLACEMENT_MAX_QUEUES) {
+		nQueues = OPENAVB_PLACEMENT_MAX_QUEUES;
+	}
+	if (queue >= nQueues) {
+		AVB_LOGF_WARNING("%s has %d %s queues; placing stream on any queue instead of %d",
+			pPlacement->ifname, nQueues, tx ? "TX" : "RX", queue);
+		queue = OPENAVB_PLACEMENT_AUTO;
+	}
+
+	// Too big for the stack of a stream thread
+	placement_queue_cpus_t *pQueues = calloc(1, sizeof(placement_queue_cpus_t));
+	if (!pQueues) {
+		AVB_LOG_ERROR("Placing stream; out of memory");
+		AVB_TRACE_EXIT(AVB_TRACE_TL);
+		return FALSE;
+	}
+
+	openavb_cpu_mask_t allowed;
+	bool anyUsable = FALSE;
+	int q;
+
+	// Read the queue maps before taking the lock; they come from the file system
+	if (!osalPlacementAllowedCpus(&allowed)) {
+		memset(&allowed, 0xFF, sizeof(allowed));
+	}
+	for (q = 0; q < nQueues; q++) {
+		pQueues->source[q] = osalPlacementQueueCpus(pPlacement->ifname, tx, q, &pQueues->cpus[q]);
+		pQueues->usable[q] = pQueues->source[q] != OPENAVB_PLACEMENT_CPU_NONE
+			&& x_placementAllowed(&pQueues->cpus[q], &allowed);
+		anyUsable = anyUsable || pQueues->usable[q];
+	}
+
+	MUTEX_LOCK_ALT(gPlacementMutex);
+
+	placement_if_t *pIf = x_placementIf(pPlacement->ifname);
+	placement_rule_t *pRule = (!tx && destAddr && pIf) ? x_placementRule(pIf, destAddr) : NULL;
+
+	if (!pIf || nQueues == 0) {
+		// Unknown interface, or too many of them: spread over the cores only
+	}
+	else if (pRule) {
+		// Another listener already steers this address
+		if (queue != OPENAVB_PLACEMENT_AUTO && queue != pRule->queue) {
+			AVB_LOGF_WARNING("RX queue %d of %s already receives the stream's address; using it instead of %d",
+				pRule->queue, pIf->ifname, queue);
+		}
+		pRule->refs++;
+		pPlacement->queue = pRule->queue;
+		pPlacement->rxSteered = TRUE;
+		pPlacement->ruleIdx = pRule - gPlacementRules;
+	}
+	else if (nQueues == 1) {
+		// Single queue: nothing to pick, but its core still counts
+		pPlacement->queue = 0;
+	}
+	else if (tx) {
+		// The TX queue follows the sending core through XPS
+		if (queue == OPENAVB_PLACEMENT_AUTO) {
+			queue = x_placementPickQueue(pIf->txStreams, nQueues, pQueues->usable);
+		}
+		else if (!pQueues->usable[queue]) {
+			AVB_LOGF_WARNING("TX queue %d of %s has no XPS map for the allowed cores; the kernel picks the queue",
+				queue, pIf->ifname);
+			queue = -1;
+		}
+		pPlacement->queue = queue;
+	}
+	else if (destAddr) {
+		if (queue == OPENAVB_PLACEMENT_AUTO) {
+			// Prefer queues whose core is known, if any
+			queue = x_placementPickQueue(pIf->rxStreams, nQueues, anyUsable ? pQueues->usable : NULL);
+		}
+
+		int i;
+		for (i = 0; i < PLACEMENT_MAX_RULES && gPlacementRules[i].refs; i++) {
+		}
+		int location = i < PLACEMENT_MAX_RULES ? osalPlacementAddRxRule(pIf->ifname, destAddr, queue) : -1;
+		if (location >= 0) {
+			pRule = &gPlacementRules[i];
+			pRule->pIf = pIf;
+			memcpy(pRule->destAddr, destAddr, ETH_ALEN);
+			pRule->queue = queue;
+			pRule->location = location;
+			pRule->refs = 1;
+			pPlacement->queue = queue;
+			pPlacement->rxSteered = TRUE;
+			pPlacement->ruleIdx = i;
+		}
+		else if (!pIf->rxRulesWarned) {
+			pIf->rxRulesWarned = TRUE;
+			AVB_LOGF_WARNING("Can't steer streams to RX queues of %s (ntuple filters off or not supported); the NIC picks the queue",
+				pIf->ifname);
+		}
+	}
+
+	if (pPlacement->queue >= 0) {
+		if (tx) {
+			pIf->txStreams[pPlacement->queue]++;
+		}
+		else {
+			pIf->rxStreams[pPlacement->queue]++;
+		}
+		if (pQueues->usable[pPlacement->queue]) {
+			pPlacement->cpu = x_placementPickCpu(&pQueues->cpus[pPlacement->queue]);
+			pPlacement->cpuSource = pQueues->source[pPlacement->queue];
+		}
+	}
+	if (pPlacement->cpu < 0) {
+		pPlacement->cpu = x_placementPickCpu(&allowed);
+		pPlacement->cpuSource = pPlacement->cpu >= 0 ? OPENAVB_PLACEMENT_CPU_SPREAD : OPENAVB_PLACEMENT_CPU_NONE;
+	}
+	if (pPlacement->cpu >= 0) {
+		gPlacementCpuStreams[pPlacement->cpu]++;
+	}
+	pPlacement->assigned = TRUE;
+
+	MUTEX_UNLOCK_ALT(gPlacementMutex);
+	free(pQueues);
+
+	AVB_LOGF_INFO("%s %s queue %d%s, core %d (%s)",
+		tx ? "TX" : "RX", pPlacement->ifname, pPlacement->queue,
+		tx ? "" : (pPlacement->rxSteered ? " (steered)" : " (not steered)"),
+		pPlacement->cpu, openavbPlacementCpuSourceName(pPlacement->cpuSource));
+
+	AVB_TRACE_EXIT(AVB_TRACE_TL);
+	return TRUE;
+}
+
+void openavbPlacementRelease(openavb_placement_t *pPlacement)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TL);
+
+	if (!pPlacement || !pPlacement->assigned || !gPlacementInitialized) {
+		AVB_TRACE_EXIT(AVB_TRACE_TL);
+		return;
+	}
+
+	MUTEX_LOCK_ALT(gPlacementMutex);
+
+	placement_if_t *pIf = x_placementIf(pPlacement->ifname);
+	if (pIf && pPlacement->queue >= 0) {
+		U32 *pStreams = pPlacement->tx ? &pIf->txStreams[pPlacement->queue] : &pIf->rxStreams[pPlacement->queue];
+		if (*pStreams) {
+			(*pStreams)--;
+		}
+	}
+	if (pPlacement->ruleIdx >= 0) {
+		placement_rule_t *pRule = &gPlacementRules[pPlacement->ruleIdx];
+		if (pRule->refs && --pRule->refs == 0) {
+			osalPlacementDelRxRule(pRule->pIf->ifname, pRule->location);
+		}
+	}
+	if (pPlacement->cpu >= 0 && gPlacementCpuStreams[pPlacement->cpu]) {
+		gPlacementCpuStreams[pPlacement->cpu]--;
+	}
+	pPlacement->assigned = FALSE;
+
+	MUTEX_UNLOCK_ALT(gPlacementMutex);
+
+	AVB_TRACE_EXIT(AVB_TRACE_TL);
+}
+
+bool openavbPlacementPinThread(const openavb_placement_t *pPlacement)
+{
+	if (!pPlacement || pPlacement->cpu < 0) {
+		return FALSE;
+	}
+	return osalPlacementPinThread(pPlacement->cpu);
+}
+
+const char *openavbPlacementCpuSourceName(openavb_placement_cpu_t cpuSource)
+{
+	switch (cpuSource) {
+		case OPENAVB_PLACEMENT_CPU_XPS:
+			return "xps";
+		case OPENAVB_PLACEMENT_CPU_RPS:
+			return "rps";
+		case OPENAVB_PLACEMENT_CPU_IRQ:
+			return "irq";
+		case OPENAVB_PLACEMENT_CPU_SPREAD:
+			return "spread";
+		default:
+			return "none";
+	}
+}
@@ -0,0 +1,124 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* HEADER SUMMARY : Placement of streams on NIC queues and CPU cores.
+*
+* Each stream is given a NIC queue, a TX queue for a talker and an RX queue
+* for a listener, and the core that services that queue. The talker or
+* listener thread is then pinned to that core. Streams spread over the
+* queues of the interface and run on the cores that service them, instead
+* of all going through one queue and its lock.
+*
+* TX queues are followed through XPS: the kernel sends a packet socket's
+* frames on the queue mapped to the CPU it sends from, so a talker pinned to
+* a CPU in the queue's XPS map uses that queue. With mqprio, the stream's
+* SO_PRIORITY (its VLAN PCP) selects the traffic class first. RX queues are
+* selected with an ethtool ntuple rule on the stream's destination address.
+* Listeners sharing an address share the rule and the queue. The core of an
+* RX queue is taken from its RPS map, or else from its interrupt affinity.
+*
+* When the interface gives no way to tell (no XPS, no ntuple support), the
+* queue is left to the NIC and the streams are spread over the allowed
+* cores instead.
+*/
+
+#ifndef OPENAVB_PLACEMENT_H
+#define OPENAVB_PLACEMENT_H 1
+
+#include "openavb_types.h"
+
+#ifndef IFNAMSIZ
+#define IFNAMSIZ 16
+#endif
+
+// Let the placement pick the least loaded queue
+#define OPENAVB_PLACEMENT_AUTO			(-1)
+
+#define OPENAVB_PLACEMENT_MAX_CPUS		1024
+#define OPENAVB_PLACEMENT_MAX_QUEUES	256
+
+typedef struct {
+	U64 bits[OPENAVB_PLACEMENT_MAX_CPUS / 64];
+} openavb_cpu_mask_t;
+
+#define OPENAVB_CPU_MASK_SET(pMask, cpu)	((pMask)->bits[(cpu) / 64] |= (1ULL << ((cpu) % 64)))
+#define OPENAVB_CPU_MASK_ISSET(pMask, cpu)	(((pMask)->bits[(cpu) / 64] >> ((cpu) % 64)) & 1)
+
+// Where the core of a stream came from
+typedef enum {
+	OPENAVB_PLACEMENT_CPU_NONE = 0,	// no core found; the thread is not pinned
+	OPENAVB_PLACEMENT_CPU_XPS,		// XPS map of the TX queue
+	OPENAVB_PLACEMENT_CPU_RPS,		// RPS map of the RX queue
+	OPENAVB_PLACEMENT_CPU_IRQ,		// interrupt affinity of the RX queue
+	OPENAVB_PLACEMENT_CPU_SPREAD,	// least loaded allowed core
+} openavb_placement_cpu_t;
+
+typedef struct {
+	char ifname[IFNAMSIZ];
+	bool tx;
+	// NIC queue of the stream; -1 if the NIC picks it
+	int queue;
+	// Core servicing the queue, to run the stream thread on; -1 if none
+	int cpu;
+	openavb_placement_cpu_t cpuSource;
+	// RX frames of the stream are steered to the queue by an ntuple rule
+	bool rxSteered;
+
+	// Internal
+	bool assigned;
+	int ruleIdx;
+} openavb_placement_t;
+
+// Set up the process wide placement tables.
+bool openavbPlacementInitialize(void);
+
+// Remove any steering rules still installed.
+void openavbPlacementFinalize(void);
+
+// Place a stream on ifname (a rawsock prefix such as "ring:" is skipped). queue is
+// the NIC queue to use or OPENAVB_PLACEMENT_AUTO. destAddr, for listeners, is the
+// stream's destination address for the RX steering rule; NULL for none.
+// Returns FALSE only on invalid arguments; a stream that can't be placed gets
+// queue and cpu -1.
+bool openavbPlacementAssign(openavb_placement_t *pPlacement, const char *ifname, bool tx, int queue, const U8 destAddr[ETH_ALEN]);
+
+// Release the queue, core and steering rule of a stream.
+void openavbPlacementRelease(openavb_placement_t *pPlacement);
+
+// Pin the calling thread to the core of the stream. Returns FALSE if there is none
+// or pinning failed.
+bool openavbPlacementPinThread(const openavb_placement_t *pPlacement);
+
+// Name of a core source, for reports.
+const char *openavbPlacementCpuSourceName(openavb_placement_cpu_t cpuSource);
+
+#endif // OPENAVB_PLACEMENT_H
@@ -0,0 +1,454 @@
+/**
+ * @file streaming_clock_metrics.cpp
+ * @brief Incremental window, lifetime, MTIE and TDEV statistics
+ *
+ * @copyright
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "streaming_clock_metrics.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace OpenAvnu {
+namespace ClockQuality {
+
+namespace {
+
+const double NS_PER_SECOND = 1e9;
+
+uint64_t samples_for(double seconds, uint32_t interval_ms) {
+    long long n = std::llround(seconds * 1000.0 / interval_ms);
+    return n < 1 ? 1 : static_cast<uint64_t>(n);
+}
+
+} // anonymous namespace
+
+void StreamingClockMetrics::SeqQueue::init(uint64_t capacity) {
+    uint64_t size = 1;
+    while (size < capacity) size <<= 1;
+    buf.assign(static_cast<size_t>(size), 0);
+    head = tail = 0;
+}
+
+StreamingClockMetrics::StreamingClockMetrics(const StreamingMetricsConfig& config)
+    : _config(config) {
+    if (_config.sync_interval_ms == 0) {
+        _config.sync_interval_ms = 125;
+    }
+    configure();
+}
+
+void StreamingClockMetrics::configure() {
+    uint32_t interval = _config.sync_interval_ms;
+    uint64_t ringSize = 2;
+
+    _windows.clear();
+    for (uint32_t seconds : _config.windows_seconds) {
+        Window w;
+        w.seconds = seconds;
+        w.spanNs = static_cast<uint64_t>(seconds) * 1000000000ULL;
+        w.rebuildPeriod = samples_for(seconds, interval);
+        // Headroom for Sync arriving faster than the nominal interval
+        w.capacity = 2 * (w.rebuildPeriod + 1);
+        _windows.push_back(w);
+        ringSize = std::max(ringSize, w.capacity);
+    }
+
+    _intervals.clear();
+    for (double seconds : _config.tau_seconds) {
+        Interval iv;
+        iv.n = static_cast<uint32_t>(samples_for(seconds, interval));
+        iv.seconds = static_cast<double>(iv.n) * interval / 1000.0;
+        iv.diff.assign(iv.n, 0);
+        _intervals.push_back(iv);
+        // TDEV reads back 2n samples
+        ringSize = std::max<uint64_t>(ringSize, 2 * static_cast<uint64_t>(iv.n) + 1);
+    }
+
+    uint64_t size = 1;
+    while (size < ringSize) size <<= 1;
+    _ring.assign(static_cast<size_t>(size), Sample{0, 0});
+    _ringMask = size - 1;
+
+    // Queues never hold more than their window or n + 1 samples
+    for (Window& w : _windows) {
+        w.maxSeq.init(w.capacity);
+        w.minSeq.init(w.capacity);
+        w.capacity = w.maxSeq.buf.size();
+    }
+    for (Interval& iv : _intervals) {
+        iv.maxSeq.init(iv.n + 1);
+        iv.minSeq.init(iv.n + 1);
+    }
+    reset();
+}
+
+void StreamingClockMetrics::reset() {
+    _nextSeq = 0;
+    for (Window& w : _windows) {
+        w.firstSeq = 0;
+        w.count = 0;
+        w.mean = w.m2 = w.sumSquares = 0.0;
+        w.anchorNs = 0;
+        w.sumT = w.sumTT = w.sumTX = 0.0;
+        w.sinceRebuild = 0;
+        w.maxSeq.clear();
+        w.minSeq.clear();
+    }
+    for (Interval& iv : _intervals) {
+        iv.mtie = 0;
+        iv.maxSeq.clear();
+        iv.minSeq.clear();
+        std::fill(iv.diff.begin(), iv.diff.end(), 0);
+        iv.diffSum = 0;
+        iv.diffCount = 0;
+        iv.sumSquares = 0.0;
+        iv.terms = 0;
+    }
+    _mean = _m2 = _sumSquares = 0.0;
+    _min = _max = 0;
+    _startNs = _lastNs = 0;
+    _consecutiveGood = 0;
+    _locked = _everLocked = false;
+    _lockNs = 0;
+}
+
+void StreamingClockMetrics::enable_monitoring(uint32_t interval_ms) {
+    if (interval_ms != 0 && interval_ms != _config.sync_interval_ms) {
+        _config.sync_interval_ms = interval_ms;
+        configure();
+    } else {
+        reset();
+    }
+    _enabled = true;
+}
+
+void StreamingClockMetrics::disable_monitoring() {
+    _enabled = false;
+}
+
+void StreamingClockMetrics::record_sync_ingress(uint64_t t1_master_tx, uint64_t t2_slave_rx,
+                                                uint64_t path_delay) {
+    int64_t error = static_cast<int64_t>(t2_slave_rx - t1_master_tx - path_delay);
+    record_time_error(error, t2_slave_rx);
+}
+
+void StreamingClockMetrics::record_time_error(int64_t time_error_ns, uint64_t timestamp_ns) {
+    if (!_enabled) {
+        return;
+    }
+    uint64_t seq = _nextSeq;
+
+    // Bound each window by its capacity, which also keeps it inside the ring
+    for (Window& w : _windows) {
+        while (w.count > 0 && seq - w.firstSeq >= w.capacity) {
+            removeFromWindow(w);
+        }
+    }
+
+    _ring[seq & _ringMask] = Sample{timestamp_ns, time_error_ns};
+    _nextSeq++;
+
+    // Lifetime
+    double x = static_cast<double>(time_error_ns);
+    if (seq == 0) {
+        _startNs = timestamp_ns;
+        _min = _max = time_error_ns;
+    } else {
+        _min = std::min(_min, time_error_ns);
+        _max = std::max(_max, time_error_ns);
+    }
+    double d = x - _mean;
+    _mean += d / static_cast<double>(seq + 1);
+    _m2 += d * (x - _mean);
+    _sumSquares += x * x;
+    _lastNs = timestamp_ns;
+
+    if (std::llabs(time_error_ns) <= _config.accuracy_limit_ns) {
+        _consecutiveGood++;
+        if (_consecutiveGood >= _config.lock_threshold && !_locked) {
+            _locked = true;
+            if (!_everLocked) {
+                _everLocked = true;
+                _lockNs = timestamp_ns;
+            }
+        }
+    } else {
+        _consecutiveGood = 0;
+        _locked = false;
+    }
+
+    for (Window& w : _windows) {
+        addToWindow(w, seq);
+        while (w.count > 1 && at(w.firstSeq).timestamp + w.spanNs < timestamp_ns) {
+            removeFromWindow(w);
+        }
+        // Periodic exact rebuild keeps the sliding sums from drifting
+        if (++w.sinceRebuild >= w.rebuildPeriod) {
+            rebuildWindow(w);
+        }
+    }
+
+    for (Interval& iv : _intervals) {
+        addToInterval(iv, seq);
+    }
+}
+
+void StreamingClockMetrics::addToWindow(Window& w, uint64_t seq) {
+    const Sample& s = at(seq);
+    if (w.count == 0) {
+        w.firstSeq = seq;
+        w.anchorNs = s.timestamp;
+    }
+    double x = static_cast<double>(s.error);
+    double t = static_cast<double>(static_cast<int64_t>(s.timestamp - w.anchorNs)) / NS_PER_SECOND;
+
+    w.count++;
+    double d = x - w.mean;
+    w.mean += d / static_cast<double>(w.count);
+    w.m2 += d * (x - w.mean);
+    w.sumSquares += x * x;
+    w.sumT += t;
+    w.sumTT += t * t;
+    w.sumTX += t * x;
+
+    while (!w.maxSeq.empty() && at(w.maxSeq.back()).error <= s.error) w.maxSeq.pop_back();
+    w.maxSeq.push_back(seq);
+    while (!w.minSeq.empty() && at(w.minSeq.back()).error >= s.error) w.minSeq.pop_back();
+    w.minSeq.push_back(seq);
+}
+
+void StreamingClockMetrics::removeFromWindow(Window& w) {
+    uint64_t seq = w.firstSeq++;
+    if (!w.maxSeq.empty() && w.maxSeq.front() == seq) w.maxSeq.pop_front();
+    if (!w.minSeq.empty() && w.minSeq.front() == seq) w.minSeq.pop_front();
+
+    if (--w.count == 0) {
+        w.mean = w.m2 = w.sumSquares = 0.0;
+        w.sumT = w.sumTT = w.sumTX = 0.0;
+        return;
+    }
+
+    const Sample& s = at(seq);
+    double x = static_cast<double>(s.error);
+    double t = static_cast<double>(static_cast<int64_t>(s.timestamp - w.anchorNs)) / NS_PER_SECOND;
+
+    double d = x - w.mean;
+    w.mean -= d / static_cast<double>(w.count);
+    w.m2 = std::max(0.0, w.m2 - d * (x - w.mean));
+    w.sumSquares -= x * x;
+    w.sumT -= t;
+    w.sumTT -= t * t;
+    w.sumTX -= t * x;
+}
+
+void StreamingClockMetrics::rebuildWindow(Window& w) {
+    w.sinceRebuild = 0;
+    if (w.count == 0) {
+        return;
+    }
+    w.anchorNs = at(w.firstSeq).timestamp;
+    w.mean = w.m2 = w.sumSquares = 0.0;
+    w.sumT = w.sumTT = w.sumTX = 0.0;
+
+    uint64_t n = 0;
+    for (uint64_t seq = w.firstSeq; seq < w.firstSeq + w.count; ++seq) {
+        const Sample& s = at(seq);
+        double x = static_cast<double>(s.error);
+        double t = static_cast<double>(s.timestamp - w.anchorNs) / NS_PER_SECOND;
+        double d = x - w.mean;
+        w.mean += d / static_cast<double>(++n);
+        w.m2 += d * (x - w.mean);
+        w.sumSquares += x * x;
+        w.sumT += t;
+        w.sumTT += t * t;
+        w.sumTX += t * x;
+    }
+}
+
+void StreamingClockMetrics::addToInterval(Interval& iv, uint64_t seq) {
+    int64_t x = at(seq).error;
+
+    // MTIE: peak-to-peak over every span of n intervals (n + 1 samples)
+    while (!iv.maxSeq.empty() && at(iv.maxSeq.back()).error <= x) iv.maxSeq.pop_back();
+    iv.maxSeq.push_back(seq);
+    while (!iv.minSeq.empty() && at(iv.minSeq.back()).error >= x) iv.minSeq.pop_back();
+    iv.minSeq.push_back(seq);
+    while (seq - iv.maxSeq.front() > iv.n) iv.maxSeq.pop_front();
+    while (seq - iv.minSeq.front() > iv.n) iv.minSeq.pop_front();
+    if (seq >= iv.n) {
+        iv.mtie = std::max(iv.mtie, at(iv.maxSeq.front()).error - at(iv.minSeq.front()).error);
+    }
+
+    // TDEV: sliding sum of n second differences x[i+2n] - 2x[i+n] + x[i]
+    if (seq >= 2ULL * iv.n) {
+        int64_t d = x - 2 * at(seq - iv.n).error + at(seq - 2ULL * iv.n).error;
+        size_t slot = static_cast<size_t>(iv.diffCount % iv.n);
+        iv.diffSum += d - iv.diff[slot];
+        iv.diff[slot] = d;
+        if (++iv.diffCount >= iv.n) {
+            double sum = static_cast<double>(iv.diffSum);
+            iv.sumSquares += sum * sum;
+            iv.terms++;
+        }
+    }
+}
+
+void StreamingClockMetrics::fillCommon(WindowMetrics& m) const {
+    m.is_locked = _locked;
+    m.consecutive_good_measurements = _consecutiveGood;
+    uint64_t lockNs = _everLocked ? _lockNs : _lastNs;
+    m.lock_time_seconds = static_cast<uint32_t>((lockNs - _startNs) / 1000000000ULL);
+    m.meets_lock_time_requirement = _everLocked && m.lock_time_seconds <= _config.lock_time_limit_seconds;
+    m.meets_80ns_requirement = m.total_measurements > 0 &&
+                               m.max_time_error_ns <= _config.accuracy_limit_ns &&
+                               m.min_time_error_ns >= -_config.accuracy_limit_ns;
+    m.meets_stability_requirement =
+        m.meets_80ns_requirement &&
+        m.last_measurement_time - m.measurement_start_time >=
+            static_cast<uint64_t>(_config.stability_window_seconds) * 1000000000ULL;
+}
+
+WindowMetrics StreamingClockMetrics::compute_metrics(uint32_t window_seconds) const {
+    const Window* w = nullptr;
+    for (const Window& candidate : _windows) {
+        if (candidate.seconds == window_seconds) {
+            w = &candidate;
+            break;
+        }
+    }
+    if (!w) {
+        return scanWindow(window_seconds);
+    }
+
+    WindowMetrics m;
+    m.observation_window_seconds = window_seconds;
+    m.total_measurements = static_cast<uint32_t>(w->count);
+    if (w->count > 0) {
+        double n = static_cast<double>(w->count);
+        m.mean_time_error_ns = std::llround(w->mean);
+        m.std_dev_ns = std::sqrt(w->m2 / n);
+        m.rms_error_ns = std::sqrt(std::max(0.0, w->sumSquares) / n);
+        m.max_time_error_ns = at(w->maxSeq.front()).error;
+        m.min_time_error_ns = at(w->minSeq.front()).error;
+        double denom = n * w->sumTT - w->sumT * w->sumT;
+        if (w->count > 1 && denom > 0.0) {
+            // ns of time error per second is ppb
+            m.frequency_stability_ppb = (n * w->sumTX - w->sumT * w->mean * n) / denom;
+        }
+        m.measurement_start_time = at(w->firstSeq).timestamp;
+        m.last_measurement_time = _lastNs;
+    }
+    fillCommon(m);
+    return m;
+}
+
+WindowMetrics StreamingClockMetrics::scanWindow(uint32_t window_seconds) const {
+    WindowMetrics m;
+    m.observation_window_seconds = window_seconds;
+    if (_nextSeq == 0) {
+        fillCommon(m);
+        return m;
+    }
+
+    uint64_t spanNs = static_cast<uint64_t>(window_seconds) * 1000000000ULL;
+    uint64_t oldest = _nextSeq > _ring.size() ? _nextSeq - _ring.size() : 0;
+    uint64_t first = _nextSeq - 1;
+    while (first > oldest && at(first - 1).timestamp + spanNs >= _lastNs) {
+        first--;
+    }
+
+    double n = 0, sum = 0, sumSquares = 0, sumT = 0, sumTT = 0, sumTX = 0;
+    uint64_t anchor = at(first).timestamp;
+    m.min_time_error_ns = m.max_time_error_ns = at(first).error;
+    for (uint64_t seq = first; seq < _nextSeq; ++seq) {
+        const Sample& s = at(seq);
+        double x = static_cast<double>(s.error);
+        double t = static_cast<double>(s.timestamp - anchor) / NS_PER_SECOND;
+        n++;
+        sum += x;
+        sumSquares += x * x;
+        sumT += t;
+        sumTT += t * t;
+        sumTX += t * x;
+        m.min_time_error_ns = std::min(m.min_time_error_ns, s.error);
+        m.max_time_error_ns = std::max(m.max_time_error_ns, s.error);
+    }
+    double mean = sum / n;
+    double m2 = 0;
+    for (uint64_t seq = first; seq < _nextSeq; ++seq) {
+        double d = static_cast<double>(at(seq).error) - mean;
+        m2 += d * d;
+    }
+
+    m.total_measurements = static_cast<uint32_t>(n);
+    m.mean_time_error_ns = std::llround(mean);
+    m.std_dev_ns = std::sqrt(m2 / n);
+    m.rms_error_ns = std::sqrt(sumSquares / n);
+    double denom = n * sumTT - sumT * sumT;
+    if (n > 1 && denom > 0.0) {
+        m.frequency_stability_ppb = (n * sumTX - sumT * sum) / denom;
+    }
+    m.measurement_start_time = anchor;
+    m.last_measurement_time = _lastNs;
+    fillCommon(m);
+    return m;
+}
+
+WindowMetrics StreamingClockMetrics::lifetime_metrics() const {
+    WindowMetrics m;
+    m.total_measurements = static_cast<uint32_t>(std::min<uint64_t>(_nextSeq, UINT32_MAX));
+    if (_nextSeq > 0) {
+        double n = static_cast<double>(_nextSeq);
+        m.observation_window_seconds = static_cast<uint32_t>((_lastNs - _startNs) / 1000000000ULL);
+        m.mean_time_error_ns = std::llround(_mean);
+        m.std_dev_ns = std::sqrt(_m2 / n);
+        m.rms_error_ns = std::sqrt(_sumSquares / n);
+        m.min_time_error_ns = _min;
+        m.max_time_error_ns = _max;
+        m.measurement_start_time = _startNs;
+        m.last_measurement_time = _lastNs;
+    }
+    fillCommon(m);
+    return m;
+}
+
+std::vector<IntervalStability> StreamingClockMetrics::interval_stability() const {
+    std::vector<IntervalStability> result;
+    result.reserve(_intervals.size());
+    for (const Interval& iv : _intervals) {
+        IntervalStability s;
+        s.tau_seconds = iv.seconds;
+        s.tau_samples = iv.n;
+        s.mtie_ns = iv.mtie;
+        s.tdev_terms = iv.terms;
+        if (iv.terms > 0) {
+            double n = static_cast<double>(iv.n);
+            s.tdev_ns = std::sqrt(iv.sumSquares / (6.0 * n * n * static_cast<double>(iv.terms)));
+        }
+        result.push_back(s);
+    }
+    return result;
+}
+
+size_t StreamingClockMetrics::retained_samples() const {
+    return static_cast<size_t>(std::min<uint64_t>(_nextSeq, _ring.size()));
+}
+
+size_t StreamingClockMetrics::memory_bytes() const {
+    size_t bytes = sizeof(*this) + _ring.capacity() * sizeof(Sample);
+    for (const Window& w : _windows) {
+        bytes += sizeof(Window) + (w.maxSeq.buf.capacity() + w.minSeq.buf.capacity()) * sizeof(uint64_t);
+    }
+    for (const Interval& iv : _intervals) {
+        bytes += sizeof(Interval) + (iv.maxSeq.buf.capacity() + iv.minSeq.buf.capacity()) * sizeof(uint64_t) +
+                 iv.diff.capacity() * sizeof(int64_t);
+    }
+    return bytes;
+}
+
+} // namespace ClockQuality
+} // namespace OpenAvnu
@@ -0,0 +1,217 @@
+/**
+ * @file streaming_clock_metrics.hpp
+ * @brief Incremental gPTP clock quality metrics with bounded memory
+ * @details IngressEventMonitor::compute_metrics() rescans every stored sample
+ * on each call. For continuous monitoring of many ports at 8 Sync/s this
+ * engine updates all statistics as each Sync arrives instead:
+ *
+ * - Observation windows (default 60 s and 300 s): sliding Welford mean and
+ *   variance, RMS and drift regression sums, and monotonic queues for min/max.
+ *   A window is rebuilt exactly from the sample ring once per window length,
+ *   so floating point error cannot accumulate over days of operation.
+ * - Lifetime: Welford mean/variance and min/max since monitoring started.
+ * - MTIE and TDEV for a set of observation intervals tau. MTIE uses a sliding
+ *   min/max per tau. TDEV keeps the running second-difference sum per tau.
+ *
+ * record_sync_ingress() is amortized O(1) per configured window and tau.
+ * compute_metrics() is O(1) for a configured window and falls back to a scan
+ * of the retained samples for any other window. Memory is fixed by the
+ * largest window and tau, not by the run time.
+ *
+ * The public calls mirror IngressEventMonitor so the monitor can hold one of
+ * these. WindowMetrics::assign_to() copies into a ClockQualityMetrics.
+ *
+ * Not thread-safe; one instance per port, driven by the port's Sync handler.
+ *
+ * @copyright
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace OpenAvnu {
+namespace ClockQuality {
+
+struct StreamingMetricsConfig {
+    uint32_t sync_interval_ms = 125;
+    /** Observation windows answered in O(1) by compute_metrics() */
+    std::vector<uint32_t> windows_seconds = {60, 300};
+    /** MTIE/TDEV observation intervals, rounded to whole Sync intervals */
+    std::vector<double> tau_seconds = {1, 10, 30, 60, 300};
+    int64_t accuracy_limit_ns = 80;
+    /** Consecutive in-limit measurements before the clock counts as locked */
+    uint32_t lock_threshold = 8;
+    uint32_t lock_time_limit_seconds = 6;
+    uint32_t stability_window_seconds = 300;
+};
+
+/** Field names follow ClockQualityMetrics */
+struct WindowMetrics {
+    int64_t mean_time_error_ns = 0;
+    int64_t max_time_error_ns = 0;
+    int64_t min_time_error_ns = 0;
+    double std_dev_ns = 0.0;
+    double rms_error_ns = 0.0;
+    double frequency_stability_ppb = 0.0;
+
+    uint32_t lock_time_seconds = 0;
+    bool is_locked = false;
+    uint32_t observation_window_seconds = 0;
+    uint32_t consecutive_good_measurements = 0;
+    uint32_t total_measurements = 0;
+
+    bool meets_80ns_requirement = false;
+    bool meets_lock_time_requirement = false;
+    bool meets_stability_requirement = false;
+
+    uint64_t measurement_start_time = 0;
+    uint64_t last_measurement_time = 0;
+
+    /** Copy into any struct with the same field names (ClockQualityMetrics) */
+    template <typename Metrics>
+    void assign_to(Metrics& out) const {
+        out.mean_time_error_ns = mean_time_error_ns;
+        out.max_time_error_ns = max_time_error_ns;
+        out.min_time_error_ns = min_time_error_ns;
+        out.std_dev_ns = std_dev_ns;
+        out.rms_error_ns = rms_error_ns;
+        out.frequency_stability_ppb = frequency_stability_ppb;
+        out.lock_time_seconds = lock_time_seconds;
+        out.is_locked = is_locked;
+        out.observation_window_seconds = observation_window_seconds;
+        out.consecutive_good_measurements = consecutive_good_measurements;
+        out.total_measurements = total_measurements;
+        out.meets_80ns_requirement = meets_80ns_requirement;
+        out.meets_lock_time_requirement = meets_lock_time_requirement;
+        out.meets_stability_requirement = meets_stability_requirement;
+        out.measurement_start_time = measurement_start_time;
+        out.last_measurement_time = last_measurement_time;
+    }
+};
+
+struct IntervalStability {
+    double tau_seconds = 0.0;
+    uint32_t tau_samples = 0;
+    int64_t mtie_ns = 0;         ///< 0 until one full interval was observed
+    double tdev_ns = 0.0;        ///< 0 until 3 * tau of samples were observed
+    uint64_t tdev_terms = 0;
+};
+
+class StreamingClockMetrics {
+public:
+    explicit StreamingClockMetrics(const StreamingMetricsConfig& config = StreamingMetricsConfig());
+
+    /** Start a new measurement run; clears all state */
+    void enable_monitoring(uint32_t interval_ms = 125);
+    void disable_monitoring();
+    bool is_monitoring_enabled() const { return _enabled; }
+    void reset();
+
+    /** Time error is t2 - t1 - path_delay, stamped with t2 */
+    void record_sync_ingress(uint64_t t1_master_tx, uint64_t t2_slave_rx, uint64_t path_delay);
+    void record_time_error(int64_t time_error_ns, uint64_t timestamp_ns);
+
+    WindowMetrics compute_metrics(uint32_t window_seconds = 300) const;
+    WindowMetrics lifetime_metrics() const;
+    std::vector<IntervalStability> interval_stability() const;
+
+    uint64_t sample_count() const { return _nextSeq; }
+    size_t retained_samples() const;
+    size_t memory_bytes() const;
+
+private:
+    struct Sample {
+        uint64_t timestamp;
+        int64_t error;
+    };
+
+    /** Fixed-capacity double-ended queue of sequence numbers */
+    struct SeqQueue {
+        std::vector<uint64_t> buf;
+        uint64_t head = 0;
+        uint64_t tail = 0;
+
+        void init(uint64_t capacity);
+        bool empty() const { return head == tail; }
+        uint64_t size() const { return tail - head; }
+        uint64_t front() const { return buf[head & (buf.size() - 1)]; }
+        uint64_t back() const { return buf[(tail - 1) & (buf.size() - 1)]; }
+        void push_back(uint64_t seq) { buf[tail++ & (buf.size() - 1)] = seq; }
+        void pop_back() { tail--; }
+        void pop_front() { head++; }
+        void clear() { head = tail = 0; }
+    };
+
+    struct Window {
+        uint32_t seconds;
+        uint64_t spanNs;
+        uint64_t firstSeq = 0;        // oldest sample still in the window
+        uint64_t count = 0;
+        double mean = 0.0;            // Welford
+        double m2 = 0.0;
+        double sumSquares = 0.0;      // for RMS
+        uint64_t anchorNs = 0;        // regression time origin
+        double sumT = 0.0;
+        double sumTT = 0.0;
+        double sumTX = 0.0;
+        uint64_t capacity = 0;        // most samples held, power of two
+        uint64_t rebuildPeriod = 1;   // samples between exact rebuilds
+        uint64_t sinceRebuild = 0;
+        SeqQueue maxSeq;              // errors decreasing
+        SeqQueue minSeq;              // errors increasing
+    };
+
+    struct Interval {
+        double seconds;
+        uint32_t n;                   // tau in Sync intervals
+        int64_t mtie = 0;
+        SeqQueue maxSeq;
+        SeqQueue minSeq;
+        std::vector<int64_t> diff;    // last n second differences
+        int64_t diffSum = 0;
+        uint64_t diffCount = 0;
+        double sumSquares = 0.0;
+        uint64_t terms = 0;
+    };
+
+    const Sample& at(uint64_t seq) const { return _ring[seq & _ringMask]; }
+    void configure();
+    void addToWindow(Window& w, uint64_t seq);
+    void removeFromWindow(Window& w);
+    void rebuildWindow(Window& w);
+    void addToInterval(Interval& iv, uint64_t seq);
+    WindowMetrics scanWindow(uint32_t window_seconds) const;
+    void fillCommon(WindowMetrics& m) const;
+
+    StreamingMetricsConfig _config;
+    bool _enabled = false;
+
+    std::vector<Sample> _ring;        // power of two, indexed by seq
+    uint64_t _ringMask = 0;
+    uint64_t _nextSeq = 0;
+
+    std::vector<Window> _windows;
+    std::vector<Interval> _intervals;
+
+    // Lifetime
+    double _mean = 0.0;
+    double _m2 = 0.0;
+    double _sumSquares = 0.0;
+    int64_t _min = 0;
+    int64_t _max = 0;
+    uint64_t _startNs = 0;
+    uint64_t _lastNs = 0;
+
+    // Lock tracking
+    uint32_t _consecutiveGood = 0;
+    bool _locked = false;
+    bool _everLocked = false;
+    uint64_t _lockNs = 0;
+};
+
+} // namespace ClockQuality
+} // namespace OpenAvnu
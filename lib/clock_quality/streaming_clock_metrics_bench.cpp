@@ -0,0 +1,150 @@
+/**
+ * @file streaming_clock_metrics_bench.cpp
+ * @brief 24 h of synthetic Sync ingress: recompute per query vs streaming
+ *
+ * The recompute baseline works like IngressEventMonitor: it keeps every
+ * sample of the largest window in a deque and rescans the requested window
+ * on each compute_metrics() call. The streaming engine updates its state per
+ * sample and additionally tracks lifetime, MTIE and TDEV.
+ *
+ * Both are queried for the 60 s and 300 s windows once per simulated second.
+ *
+ * Usage: streaming_clock_metrics_bench [hours]
+ */
+
+#include "streaming_clock_metrics.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace OpenAvnu::ClockQuality;
+
+namespace {
+
+const uint64_t INTERVAL_NS = 125000000ULL;
+
+volatile double sink;
+
+struct Sample {
+    uint64_t timestamp;
+    int64_t error;
+};
+
+class RecomputeMonitor {
+public:
+    void record(int64_t error, uint64_t timestamp) {
+        _samples.push_back(Sample{timestamp, error});
+        while (_samples.front().timestamp + 300000000000ULL < timestamp) _samples.pop_front();
+    }
+
+    WindowMetrics compute(uint32_t window_seconds) const {
+        WindowMetrics m;
+        uint64_t last = _samples.back().timestamp;
+        uint64_t span = window_seconds * 1000000000ULL;
+        std::vector<int64_t> errors;
+        for (const Sample& s : _samples) {
+            if (s.timestamp + span >= last) errors.push_back(s.error);
+        }
+        double sum = 0, squares = 0;
+        for (int64_t e : errors) {
+            sum += e;
+            squares += static_cast<double>(e) * e;
+        }
+        double mean = sum / errors.size();
+        double m2 = 0;
+        for (int64_t e : errors) m2 += (e - mean) * (e - mean);
+        m.total_measurements = static_cast<uint32_t>(errors.size());
+        m.mean_time_error_ns = std::llround(mean);
+        m.std_dev_ns = std::sqrt(m2 / errors.size());
+        m.rms_error_ns = std::sqrt(squares / errors.size());
+        m.max_time_error_ns = *std::max_element(errors.begin(), errors.end());
+        m.min_time_error_ns = *std::min_element(errors.begin(), errors.end());
+        return m;
+    }
+
+    size_t memory_bytes() const { return sizeof(*this) + _samples.size() * sizeof(Sample); }
+
+private:
+    std::deque<Sample> _samples;
+};
+
+std::vector<int64_t> make_errors(size_t count) {
+    // White phase noise on top of a slow random-walk wander
+    std::mt19937_64 rng(1);
+    std::normal_distribution<double> noise(0.0, 20.0);
+    std::vector<int64_t> errors(count);
+    double wander = 0;
+    for (size_t i = 0; i < count; ++i) {
+        wander = 0.999 * wander + noise(rng) * 0.05;
+        errors[i] = static_cast<int64_t>(wander + noise(rng));
+    }
+    return errors;
+}
+
+template <typename Fn>
+double run_seconds(Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv) {
+    double hours = argc > 1 ? std::atof(argv[1]) : 24.0;
+    size_t count = static_cast<size_t>(hours * 3600 * 8);
+    std::vector<int64_t> errors = make_errors(count);
+
+    RecomputeMonitor recompute;
+    double checksumA = 0;
+    double recomputeSeconds = run_seconds([&]() {
+        for (size_t i = 0; i < count; ++i) {
+            recompute.record(errors[i], i * INTERVAL_NS);
+            if (i % 8 == 7) {
+                checksumA += recompute.compute(60).std_dev_ns + recompute.compute(300).std_dev_ns;
+            }
+        }
+    });
+
+    StreamingClockMetrics streaming;
+    streaming.enable_monitoring(125);
+    double checksumB = 0;
+    double streamingSeconds = run_seconds([&]() {
+        for (size_t i = 0; i < count; ++i) {
+            streaming.record_time_error(errors[i], i * INTERVAL_NS);
+            if (i % 8 == 7) {
+                checksumB += streaming.compute_metrics(60).std_dev_ns + streaming.compute_metrics(300).std_dev_ns;
+            }
+        }
+    });
+    sink = checksumA + checksumB;
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << count << " samples (" << hours << " h at 8 Sync/s), 2 window queries per second\n\n";
+    std::cout << "  recompute  " << std::setw(9) << recomputeSeconds << " s  "
+              << std::setw(9) << recomputeSeconds * 1e9 / count << " ns/sample  "
+              << recompute.memory_bytes() / 1024 << " KiB\n";
+    std::cout << "  streaming  " << std::setw(9) << streamingSeconds << " s  "
+              << std::setw(9) << streamingSeconds * 1e9 / count << " ns/sample  "
+              << streaming.memory_bytes() / 1024 << " KiB\n";
+    std::cout << "  speedup    " << std::setprecision(1) << recomputeSeconds / streamingSeconds << "x\n";
+    std::cout << "  std dev checksum difference " << std::scientific << std::setprecision(2)
+              << std::fabs(checksumA - checksumB) / checksumA << " (relative)\n\n";
+
+    std::cout << std::fixed << std::setprecision(1);
+    WindowMetrics life = streaming.lifetime_metrics();
+    std::cout << "  lifetime: mean " << life.mean_time_error_ns << " ns, std dev " << life.std_dev_ns
+              << " ns, range [" << life.min_time_error_ns << ", " << life.max_time_error_ns << "] ns\n";
+    for (const IntervalStability& s : streaming.interval_stability()) {
+        std::cout << "  tau " << std::setw(5) << s.tau_seconds << " s: MTIE " << std::setw(4) << s.mtie_ns
+                  << " ns, TDEV " << std::setw(6) << s.tdev_ns << " ns\n";
+    }
+    return 0;
+}
@@ -0,0 +1,288 @@
+/**
+ * @file streaming_clock_metrics_test.cpp
+ * @brief Tests for StreamingClockMetrics against direct recomputation
+ *
+ * Every incremental result is compared with a brute-force pass over the same
+ * samples: window statistics, lifetime statistics, MTIE and TDEV.
+ */
+
+#include "streaming_clock_metrics.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace OpenAvnu::ClockQuality;
+
+namespace {
+
+const uint64_t INTERVAL_NS = 125000000ULL;
+const uint64_t START_NS = 1000000000000ULL;
+
+struct Sample {
+    uint64_t timestamp;
+    int64_t error;
+};
+
+bool near(double a, double b, double tolerance) {
+    return std::fabs(a - b) <= tolerance * std::max(1.0, std::fabs(b));
+}
+
+// Reference: samples with timestamp >= last - window
+WindowMetrics reference_window(const std::vector<Sample>& samples, uint32_t window_seconds) {
+    WindowMetrics m;
+    uint64_t last = samples.back().timestamp;
+    uint64_t span = window_seconds * 1000000000ULL;
+    std::vector<Sample> w;
+    for (const Sample& s : samples) {
+        if (s.timestamp + span >= last) w.push_back(s);
+    }
+    double n = static_cast<double>(w.size());
+    double sum = 0, squares = 0;
+    m.min_time_error_ns = m.max_time_error_ns = w.front().error;
+    for (const Sample& s : w) {
+        sum += s.error;
+        squares += static_cast<double>(s.error) * s.error;
+        m.min_time_error_ns = std::min(m.min_time_error_ns, s.error);
+        m.max_time_error_ns = std::max(m.max_time_error_ns, s.error);
+    }
+    double mean = sum / n;
+    double m2 = 0, st = 0, stt = 0, stx = 0;
+    for (const Sample& s : w) {
+        double t = static_cast<double>(s.timestamp - w.front().timestamp) / 1e9;
+        m2 += (s.error - mean) * (s.error - mean);
+        st += t;
+        stt += t * t;
+        stx += t * s.error;
+    }
+    m.total_measurements = static_cast<uint32_t>(w.size());
+    m.mean_time_error_ns = std::llround(mean);
+    m.std_dev_ns = std::sqrt(m2 / n);
+    m.rms_error_ns = std::sqrt(squares / n);
+    m.frequency_stability_ppb = (n * stx - st * sum) / (n * stt - st * st);
+    return m;
+}
+
+int64_t reference_mtie(const std::vector<Sample>& x, uint32_t n) {
+    int64_t mtie = 0;
+    for (size_t i = 0; i + n < x.size(); ++i) {
+        int64_t lo = x[i].error, hi = x[i].error;
+        for (size_t j = i; j <= i + n; ++j) {
+            lo = std::min(lo, x[j].error);
+            hi = std::max(hi, x[j].error);
+        }
+        mtie = std::max(mtie, hi - lo);
+    }
+    return mtie;
+}
+
+// ITU-T G.810 TDEV estimator for tau = n * tau0
+double reference_tdev(const std::vector<Sample>& x, uint32_t n) {
+    size_t N = x.size();
+    if (N < 3 * n) return 0.0;
+    double total = 0;
+    size_t terms = 0;
+    for (size_t j = 0; j + 3 * n <= N; ++j) {
+        double s = 0;
+        for (size_t i = j; i < j + n; ++i) {
+            s += x[i + 2 * n].error - 2.0 * x[i + n].error + x[i].error;
+        }
+        total += s * s;
+        terms++;
+    }
+    return std::sqrt(total / (6.0 * n * n * terms));
+}
+
+} // anonymous namespace
+
+bool test_basic_statistics() {
+    std::cout << "Test 1: Mean, std dev, accuracy and lock from a simple series\n";
+    StreamingClockMetrics metrics;
+    metrics.enable_monitoring(125);
+
+    const int64_t errors[] = {10, 20, 30, 40, 50};
+    uint64_t t = START_NS;
+    for (int64_t e : errors) {
+        metrics.record_sync_ingress(t - 1000 - e, t, 1000);
+        t += INTERVAL_NS;
+    }
+
+    WindowMetrics m = metrics.compute_metrics(300);
+    bool ok = m.total_measurements == 5 && m.mean_time_error_ns == 30;
+    ok &= near(m.std_dev_ns, 14.1421356, 1e-6);
+    ok &= m.min_time_error_ns == 10 && m.max_time_error_ns == 50;
+    ok &= m.meets_80ns_requirement && !m.is_locked && m.consecutive_good_measurements == 5;
+    ok &= !m.meets_stability_requirement;  // nowhere near 300 s observed
+    ok &= near(m.frequency_stability_ppb, 80.0, 1e-9);  // 10 ns per 125 ms
+
+    // One out-of-limit sample fails the window and breaks the good run
+    metrics.record_time_error(120, t);
+    m = metrics.compute_metrics(300);
+    ok &= !m.meets_80ns_requirement && m.consecutive_good_measurements == 0;
+
+    // Disabled monitoring drops samples
+    metrics.disable_monitoring();
+    metrics.record_time_error(0, t + INTERVAL_NS);
+    ok &= metrics.sample_count() == 6;
+
+    std::cout << (ok ? "  ✓ PASSED\n" : "  ✗ FAILED\n");
+    return ok;
+}
+
+bool test_lock_detection() {
+    std::cout << "Test 2: Lock after consecutive in-limit samples\n";
+    StreamingClockMetrics metrics;
+    metrics.enable_monitoring(125);
+
+    uint64_t t = START_NS;
+    for (int i = 0; i < 20; ++i, t += INTERVAL_NS) metrics.record_time_error(500 - i * 20, t);
+    bool ok = !metrics.compute_metrics(60).is_locked;
+    for (int i = 0; i < 49; ++i, t += INTERVAL_NS) metrics.record_time_error(i % 2 ? 25 : -25, t);
+
+    WindowMetrics m = metrics.compute_metrics(60);
+    ok &= m.is_locked && m.consecutive_good_measurements == 49;
+    // Samples 20..27 are the first eight in limit; lock is taken at #27
+    ok &= m.lock_time_seconds == (20 + 7) * 125 / 1000;
+    ok &= m.meets_lock_time_requirement;
+
+    std::cout << (ok ? "  ✓ PASSED\n" : "  ✗ FAILED\n");
+    return ok;
+}
+
+bool test_windows_against_reference() {
+    std::cout << "Test 3: Sliding windows match recomputation, with jitter and gaps\n";
+    StreamingMetricsConfig config;
+    config.windows_seconds = {10, 60};
+    config.tau_seconds = {1};
+    StreamingClockMetrics metrics(config);
+    metrics.enable_monitoring(125);
+
+    std::mt19937_64 rng(42);
+    std::normal_distribution<double> noise(0.0, 25.0);
+    std::uniform_int_distribution<int64_t> jitter(-2000000, 2000000);
+    std::vector<Sample> samples;
+
+    bool ok = true;
+    uint64_t t = START_NS;
+    for (int i = 0; i < 6000; ++i) {
+        t += INTERVAL_NS + jitter(rng);
+        if (i % 1000 == 999) t += 15000000000ULL;  // Sync outage longer than a window
+        int64_t e = static_cast<int64_t>(noise(rng) + 0.002 * i);
+        samples.push_back(Sample{t, e});
+        metrics.record_time_error(e, t);
+
+        if (i % 97 != 0) continue;
+        for (uint32_t window : {10u, 60u, 30u}) {  // 30 s takes the scan path
+            WindowMetrics got = metrics.compute_metrics(window);
+            WindowMetrics want = reference_window(samples, window);
+            bool same = got.total_measurements == want.total_measurements &&
+                        got.mean_time_error_ns == want.mean_time_error_ns &&
+                        got.min_time_error_ns == want.min_time_error_ns &&
+                        got.max_time_error_ns == want.max_time_error_ns &&
+                        near(got.std_dev_ns, want.std_dev_ns, 1e-9) &&
+                        near(got.rms_error_ns, want.rms_error_ns, 1e-9);
+            if (want.total_measurements > 2) {
+                same &= near(got.frequency_stability_ppb, want.frequency_stability_ppb, 1e-6);
+            }
+            if (!same) {
+                std::cout << "  mismatch at sample " << i << ", window " << window << " s\n";
+                ok = false;
+            }
+        }
+    }
+
+    std::cout << (ok ? "  ✓ PASSED\n" : "  ✗ FAILED\n");
+    return ok;
+}
+
+bool test_lifetime_mtie_tdev() {
+    std::cout << "Test 4: Lifetime statistics, MTIE and TDEV match recomputation\n";
+    StreamingMetricsConfig config;
+    config.windows_seconds = {5};
+    config.tau_seconds = {0.125, 1, 2.5};
+    StreamingClockMetrics metrics(config);
+    metrics.enable_monitoring(125);
+
+    std::mt19937_64 rng(7);
+    std::normal_distribution<double> noise(0.0, 40.0);
+    std::vector<Sample> samples;
+    double wander = 0;
+    uint64_t t = START_NS;
+    for (int i = 0; i < 3000; ++i, t += INTERVAL_NS) {
+        wander += noise(rng) * 0.1;
+        int64_t e = static_cast<int64_t>(wander + noise(rng));
+        samples.push_back(Sample{t, e});
+        metrics.record_time_error(e, t);
+    }
+
+    double sum = 0;
+    for (const Sample& s : samples) sum += s.error;
+    double mean = sum / samples.size();
+    double m2 = 0;
+    for (const Sample& s : samples) m2 += (s.error - mean) * (s.error - mean);
+
+    WindowMetrics life = metrics.lifetime_metrics();
+    bool ok = life.total_measurements == samples.size() && life.mean_time_error_ns == std::llround(mean);
+    ok &= near(life.std_dev_ns, std::sqrt(m2 / samples.size()), 1e-9);
+    ok &= life.observation_window_seconds == 374;
+
+    // The 5 s window only keeps the tail, memory stays at the ring size
+    ok &= metrics.compute_metrics(5).total_measurements == 41;
+    ok &= metrics.retained_samples() < samples.size();
+
+    for (const IntervalStability& s : metrics.interval_stability()) {
+        int64_t mtie = reference_mtie(samples, s.tau_samples);
+        double tdev = reference_tdev(samples, s.tau_samples);
+        if (s.mtie_ns != mtie || !near(s.tdev_ns, tdev, 1e-9)) {
+            std::cout << "  tau " << s.tau_seconds << " s: MTIE " << s.mtie_ns << "/" << mtie
+                      << " TDEV " << s.tdev_ns << "/" << tdev << "\n";
+            ok = false;
+        }
+    }
+
+    std::cout << (ok ? "  ✓ PASSED\n" : "  ✗ FAILED\n");
+    return ok;
+}
+
+bool test_bounded_memory() {
+    std::cout << "Test 5: Memory stays bounded over a long run\n";
+    StreamingClockMetrics metrics;
+    metrics.enable_monitoring(125);
+
+    std::mt19937_64 rng(3);
+    std::uniform_int_distribution<int64_t> noise(-60, 60);
+    uint64_t t = START_NS;
+    size_t early = 0;
+    for (int i = 0; i < 8 * 3600; ++i, t += INTERVAL_NS) {
+        metrics.record_time_error(noise(rng), t);
+        if (i == 8 * 600) early = metrics.memory_bytes();
+    }
+
+    WindowMetrics m = metrics.compute_metrics(300);
+    bool ok = m.total_measurements == 2401 && m.meets_80ns_requirement && m.meets_stability_requirement;
+    // Deque occupancy varies with the data; the ring does not grow
+    ok &= metrics.memory_bytes() < early + early / 4;
+    ok &= metrics.lifetime_metrics().total_measurements == 8 * 3600;
+
+    std::cout << "  " << metrics.memory_bytes() / 1024 << " KiB after one hour\n";
+    std::cout << (ok ? "  ✓ PASSED\n" : "  ✗ FAILED\n");
+    return ok;
+}
+
+int main() {
+    std::cout << "=== Streaming Clock Quality Metrics Tests ===\n";
+
+    int passed = 0;
+    int total = 5;
+
+    if (test_basic_statistics()) passed++;
+    if (test_lock_detection()) passed++;
+    if (test_windows_against_reference()) passed++;
+    if (test_lifetime_mtie_tdev()) passed++;
+    if (test_bounded_memory()) passed++;
+
+    std::cout << "=== Test Results: " << passed << "/" << total << " Tests Passed ===\n";
+    return passed == total ? 0 : 1;
+}
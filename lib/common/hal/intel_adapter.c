@@ -968,7 +968,11 @@ static network_hal_result_t intel_adapter_configure_time_aware_shaper(
     if (context->is_attached) {
         /* TODO: Configure Intel Time-Aware Shaper
          * 
-         * struct tsn_tas_config *tas_config = (struct tsn_tas_config*)config;
+         * Translate the network_hal_tas_config_t gate control list into
+         * struct tsn_tas_config (gate_states/time_interval per entry,
+         * base_time, cycle_time) before handing it to intel_avb:
+         * 
+         * struct tsn_tas_config *tas_config = ...;
          * 
          * int result = intel_setup_time_aware_shaper(&context->intel_device, tas_config);
          * if (result != 0) {
@@ -288,6 +288,51 @@ typedef struct network_hal_timestamp {
 #define NETWORK_HAL_TIMESTAMP_SOURCE_CROSS_TIMESTAMP   3
 #define NETWORK_HAL_TIMESTAMP_SOURCE_SOFTWARE          4
 
+/**
+ * @brief Maximum entries in a gate control list
+ */
+#define NETWORK_HAL_TAS_MAX_ENTRIES 64
+
+/**
+ * @brief Number of traffic classes (gates) in a gate control list
+ */
+#define NETWORK_HAL_TAS_MAX_TC      8
+
+/**
+ * @brief Gate control list entry (IEEE 802.1Qbv SetGateStates)
+ */
+typedef struct network_hal_tas_entry {
+    /** Open gates, bit n for traffic class n */
+    uint8_t gate_states;
+    
+    /** Time the gates stay in this state, in nanoseconds */
+    uint32_t time_interval_ns;
+} network_hal_tas_entry_t;
+
+/**
+ * @brief Time-Aware Shaper configuration (IEEE 802.1Qbv)
+ * 
+ * Passed to network_hal_configure_time_aware_shaper(), and used by the
+ * software shaper in network_hal_tas.h when the hardware has no TAS.
+ * 
+ * The schedule repeats every cycle_time_ns from base_time_ns (gPTP time).
+ * If the entries add up to less than the cycle the last entry is extended,
+ * if they add up to more the list is cut short at the end of the cycle.
+ */
+typedef struct network_hal_tas_config {
+    /** Start of the first cycle, gPTP time in nanoseconds */
+    uint64_t base_time_ns;
+    
+    /** Cycle time in nanoseconds; 0 for the sum of the entry intervals */
+    uint64_t cycle_time_ns;
+    
+    /** Number of valid entries in gate_control_list */
+    uint32_t gate_control_list_length;
+    
+    /** Gate control list */
+    network_hal_tas_entry_t gate_control_list[NETWORK_HAL_TAS_MAX_ENTRIES];
+} network_hal_tas_config_t;
+
 /* ============================================================================
  * VENDOR ADAPTER STRUCTURES  
  * ============================================================================ */
@@ -598,14 +643,15 @@ void* network_hal_device_get_vendor_context(
  * Available on Intel I225/I226 adapters.
  * 
  * @param[in] device_handle     Device handle from open operation
- * @param[in] config           Time-aware shaper configuration
+ * @param[in] config           Time-aware shaper configuration (network_hal_tas_config_t)
  * 
  * @return NETWORK_HAL_SUCCESS on success, error code on failure
  *         NETWORK_HAL_ERROR_NOT_SUPPORTED if hardware lacks TAS support
  * 
  * Implementation Notes:
  * - Intel I225+: Uses intel_setup_time_aware_shaper() from intel_avb
- * - Other devices: Returns NETWORK_HAL_ERROR_NOT_SUPPORTED
+ * - Other devices: Returns NETWORK_HAL_ERROR_NOT_SUPPORTED; the caller can
+ *   gate its own transmit with the software shaper (network_hal_tas.h)
  * - Requires NETWORK_HAL_CAP_TIME_AWARE_SHAPER capability
  * 
  * Hardware Context (Intel I225/I226):
@@ -615,7 +661,7 @@ void* network_hal_device_get_vendor_context(
  */
 network_hal_result_t network_hal_configure_time_aware_shaper(
     network_hal_device_t *device_handle,
-    const void *config  /* vendor-specific config structure */
+    const void *config  /* network_hal_tas_config_t */
 );
 
 /**
@@ -0,0 +1,290 @@
+/**
+ * @file network_hal_tas.c
+ * @brief Software Time-Aware Shaper (IEEE 802.1Qbv gate control list emulation)
+ *
+ * The gate control list is reduced to the end offset of each entry within the
+ * cycle, so a lookup is a modulo and a binary search, and a window search
+ * walks the entries from there.
+ *
+ * @copyright Copyright (c) 2025, The OpenAvnu Contributors
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "network_hal_tas.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <inttypes.h>
+
+/* ============================================================================
+ * INTERNAL HELPERS
+ * ============================================================================ */
+
+/**
+ * @brief Offset of time_ns into its cycle; earlier cycles extend back from base time
+ */
+static uint64_t tas_cycle_offset(const network_hal_tas_t *tas, uint64_t time_ns)
+{
+    if (time_ns >= tas->base_time_ns) {
+        return (time_ns - tas->base_time_ns) % tas->cycle_time_ns;
+    }
+    return tas->cycle_time_ns - 1 - ((tas->base_time_ns - time_ns - 1) % tas->cycle_time_ns);
+}
+
+/**
+ * @brief Entry in effect at an offset into the cycle
+ */
+static uint32_t tas_entry_at(const network_hal_tas_t *tas, uint64_t offset_ns)
+{
+    uint32_t lo = 0;
+    uint32_t hi = tas->entry_count - 1;
+
+    /* First entry that ends after offset_ns; the last one ends at the cycle time */
+    while (lo < hi) {
+        uint32_t mid = (lo + hi) / 2;
+        if (tas->entry_end_ns[mid] > offset_ns) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    return lo;
+}
+
+/* ============================================================================
+ * PUBLIC API
+ * ============================================================================ */
+
+network_hal_result_t network_hal_tas_init(
+    network_hal_tas_t *tas,
+    const network_hal_tas_config_t *config
+)
+{
+    uint64_t sum = 0;
+    uint32_t i;
+
+    if (!tas || !config || config->gate_control_list_length == 0 ||
+        config->gate_control_list_length > NETWORK_HAL_TAS_MAX_ENTRIES) {
+        return NETWORK_HAL_ERROR_INVALID_PARAM;
+    }
+
+    for (i = 0; i < config->gate_control_list_length; i++) {
+        sum += config->gate_control_list[i].time_interval_ns;
+    }
+
+    memset(tas, 0, sizeof(*tas));
+    tas->base_time_ns = config->base_time_ns;
+    tas->cycle_time_ns = config->cycle_time_ns ? config->cycle_time_ns : sum;
+    tas->entry_count = config->gate_control_list_length;
+    if (tas->cycle_time_ns == 0) {
+        return NETWORK_HAL_ERROR_INVALID_PARAM;
+    }
+
+    /* Entries past the end of the cycle are cut short; the last one is
+     * extended to the end of the cycle */
+    sum = 0;
+    for (i = 0; i < tas->entry_count; i++) {
+        sum += config->gate_control_list[i].time_interval_ns;
+        tas->gate_states[i] = config->gate_control_list[i].gate_states;
+        tas->entry_end_ns[i] = sum < tas->cycle_time_ns ? sum : tas->cycle_time_ns;
+    }
+    tas->entry_end_ns[tas->entry_count - 1] = tas->cycle_time_ns;
+
+    return NETWORK_HAL_SUCCESS;
+}
+
+uint8_t network_hal_tas_gate_states(const network_hal_tas_t *tas, uint64_t time_ns)
+{
+    return tas->gate_states[tas_entry_at(tas, tas_cycle_offset(tas, time_ns))];
+}
+
+bool network_hal_tas_next_window(
+    const network_hal_tas_t *tas,
+    uint8_t traffic_class,
+    uint64_t time_ns,
+    uint64_t min_open_ns,
+    uint64_t *open_ns,
+    uint64_t *close_ns
+)
+{
+    uint8_t gate = (uint8_t)(1u << traffic_class);
+    uint64_t offset;
+    uint64_t cycle_start;
+    uint64_t entry_start;
+    uint64_t run_start = 0;
+    bool in_run = false;
+    uint32_t idx;
+    uint32_t steps;
+
+    if (traffic_class >= NETWORK_HAL_TAS_MAX_TC) {
+        return false;
+    }
+
+    offset = tas_cycle_offset(tas, time_ns);
+    cycle_start = time_ns - offset;
+    idx = tas_entry_at(tas, offset);
+    entry_start = time_ns;
+
+    /* A window found in the rest of this cycle or the next one can run into
+     * the cycle after that, so three cycles' worth of entries cover it */
+    for (steps = 0; steps < 3 * tas->entry_count; steps++) {
+        uint64_t entry_end = cycle_start + tas->entry_end_ns[idx];
+
+        if (entry_end <= entry_start) {
+            /* Zero length (or truncated) entry: the gates never take its state */
+        } else if (tas->gate_states[idx] & gate) {
+            if (!in_run) {
+                run_start = entry_start;
+                in_run = true;
+            }
+        } else if (in_run) {
+            if (entry_start - run_start >= min_open_ns) {
+                *open_ns = run_start;
+                *close_ns = entry_start;
+                return true;
+            }
+            in_run = false;
+        }
+
+        entry_start = entry_end > entry_start ? entry_end : entry_start;
+        if (++idx == tas->entry_count) {
+            idx = 0;
+            cycle_start += tas->cycle_time_ns;
+        }
+    }
+
+    /* Still open after all that: the gate only closes for zero length entries, if ever */
+    if (in_run && entry_start - run_start >= tas->cycle_time_ns) {
+        *open_ns = run_start;
+        *close_ns = NETWORK_HAL_TAS_FOREVER;
+        return true;
+    }
+    return false;
+}
+
+uint32_t network_hal_tas_admit(
+    const network_hal_tas_t *tas,
+    uint8_t traffic_class,
+    uint64_t time_ns,
+    uint64_t frame_ns,
+    uint32_t max_frames,
+    uint64_t *start_ns
+)
+{
+    uint64_t from_ns = time_ns > tas->wire_free_ns ? time_ns : tas->wire_free_ns;
+    uint64_t open_ns;
+    uint64_t close_ns;
+    uint64_t fit;
+
+    if (max_frames == 0 || frame_ns == 0 ||
+        !network_hal_tas_next_window(tas, traffic_class, from_ns, frame_ns, &open_ns, &close_ns)) {
+        return 0;
+    }
+
+    *start_ns = open_ns;
+    if (close_ns == NETWORK_HAL_TAS_FOREVER) {
+        return max_frames;
+    }
+    fit = (close_ns - open_ns) / frame_ns;
+    return fit < max_frames ? (uint32_t)fit : max_frames;
+}
+
+void network_hal_tas_commit(
+    network_hal_tas_t *tas,
+    uint64_t start_ns,
+    uint32_t frames,
+    uint64_t frame_ns
+)
+{
+    tas->wire_free_ns = start_ns + frames * frame_ns;
+}
+
+uint64_t network_hal_tas_frame_time_ns(uint32_t frame_bytes, uint32_t link_mbps)
+{
+    uint64_t bits = ((uint64_t)frame_bytes + NETWORK_HAL_TAS_WIRE_OVERHEAD_BYTES) * 8;
+
+    if (link_mbps == 0) {
+        return 0;
+    }
+    return (bits * 1000 + link_mbps - 1) / link_mbps;
+}
+
+network_hal_result_t network_hal_tas_parse(const char *text, network_hal_tas_config_t *config)
+{
+    const char *p = text;
+    uint32_t count = 0;
+
+    if (!text || !config) {
+        return NETWORK_HAL_ERROR_INVALID_PARAM;
+    }
+
+    for (;;) {
+        unsigned long gates;
+        unsigned long long interval;
+        char *end;
+
+        while (isspace((unsigned char)*p) || *p == ',' || *p == ';') {
+            p++;
+        }
+        if (*p == '\0') {
+            break;
+        }
+        if ((*p != 'S' && *p != 's') || !isspace((unsigned char)p[1]) ||
+            count == NETWORK_HAL_TAS_MAX_ENTRIES) {
+            return NETWORK_HAL_ERROR_INVALID_PARAM;
+        }
+
+        gates = strtoul(p + 1, &end, 16);
+        if (end == p + 1 || gates > 0xFF) {
+            return NETWORK_HAL_ERROR_INVALID_PARAM;
+        }
+        p = end;
+        interval = strtoull(p, &end, 10);
+        if (end == p || interval > UINT32_MAX) {
+            return NETWORK_HAL_ERROR_INVALID_PARAM;
+        }
+        p = end;
+
+        config->gate_control_list[count].gate_states = (uint8_t)gates;
+        config->gate_control_list[count].time_interval_ns = (uint32_t)interval;
+        count++;
+    }
+
+    if (count == 0) {
+        return NETWORK_HAL_ERROR_INVALID_PARAM;
+    }
+    config->gate_control_list_length = count;
+    return NETWORK_HAL_SUCCESS;
+}
+
+int network_hal_tas_format_taprio(const network_hal_tas_config_t *config, char *buf, size_t len)
+{
+    uint64_t sum = 0;
+    size_t total = 0;
+    uint32_t i;
+    int n;
+
+#define TAS_APPEND(...) \
+    do { \
+        n = snprintf(buf && total < len ? buf + total : NULL, \
+                     buf && total < len ? len - total : 0, __VA_ARGS__); \
+        if (n < 0) { \
+            return n; \
+        } \
+        total += (size_t)n; \
+    } while (0)
+
+    TAS_APPEND("base-time %" PRIu64, config->base_time_ns);
+    for (i = 0; i < config->gate_control_list_length && i < NETWORK_HAL_TAS_MAX_ENTRIES; i++) {
+        TAS_APPEND(" sched-entry S %02x %" PRIu32, config->gate_control_list[i].gate_states,
+                   config->gate_control_list[i].time_interval_ns);
+        sum += config->gate_control_list[i].time_interval_ns;
+    }
+    TAS_APPEND(" cycle-time %" PRIu64 " clockid CLOCK_TAI",
+               config->cycle_time_ns ? config->cycle_time_ns : sum);
+
+#undef TAS_APPEND
+
+    return (int)total;
+}
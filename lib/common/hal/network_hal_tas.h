@@ -0,0 +1,169 @@
+/**
+ * @file network_hal_tas.h
+ * @brief Software Time-Aware Shaper (IEEE 802.1Qbv gate control list emulation)
+ *
+ * Evaluates a network_hal_tas_config_t gate control list against gPTP time so
+ * a talker can hold its transmit to the windows of its traffic class on
+ * adapters without hardware TAS. Pure computation: no clocks, no I/O, so the
+ * same code can be driven by a real clock or a simulated one.
+ *
+ * Where the kernel has the taprio qdisc, network_hal_tas_format_taprio()
+ * gives the equivalent schedule in tc syntax.
+ *
+ * @copyright Copyright (c) 2025, The OpenAvnu Contributors
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __OPENAVNU_NETWORK_HAL_TAS_H__
+#define __OPENAVNU_NETWORK_HAL_TAS_H__
+
+#include "network_hal.h"
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Close time of a window that never closes (gate always open)
+ */
+#define NETWORK_HAL_TAS_FOREVER     UINT64_MAX
+
+/**
+ * @brief Ethernet overhead per frame on the wire: FCS, preamble, SFD and IPG
+ */
+#define NETWORK_HAL_TAS_WIRE_OVERHEAD_BYTES 24
+
+/**
+ * @brief Software shaper state, built from a configuration by network_hal_tas_init()
+ */
+typedef struct network_hal_tas {
+    uint64_t base_time_ns;
+    uint64_t cycle_time_ns;
+    uint32_t entry_count;
+    uint8_t gate_states[NETWORK_HAL_TAS_MAX_ENTRIES];
+
+    /** End of each entry as an offset into the cycle */
+    uint64_t entry_end_ns[NETWORK_HAL_TAS_MAX_ENTRIES];
+
+    /** End of the last frame committed with network_hal_tas_commit() */
+    uint64_t wire_free_ns;
+} network_hal_tas_t;
+
+/**
+ * @brief Build the shaper state from a gate control list
+ *
+ * @return NETWORK_HAL_ERROR_INVALID_PARAM for an empty or oversized list or a
+ *         zero cycle time
+ */
+network_hal_result_t network_hal_tas_init(
+    network_hal_tas_t *tas,
+    const network_hal_tas_config_t *config
+);
+
+/**
+ * @brief Gates open at a point in time
+ *
+ * Times before base_time_ns are treated as if the schedule was already
+ * running; there is no previous list to fall back on.
+ *
+ * @return Bit mask of open gates, bit n for traffic class n
+ */
+uint8_t network_hal_tas_gate_states(const network_hal_tas_t *tas, uint64_t time_ns);
+
+/**
+ * @brief Find the next transmit window of a traffic class
+ *
+ * Finds the earliest time at or after time_ns at which the gate of
+ * traffic_class is open and stays open for at least min_open_ns. Adjacent
+ * entries with the gate open, also across the end of the cycle, make one
+ * window.
+ *
+ * @param[out] open_ns   Start of the window (time_ns if the gate is open now)
+ * @param[out] close_ns  End of the window, NETWORK_HAL_TAS_FOREVER if the
+ *                       gate never closes
+ *
+ * @return false if the gate never stays open for min_open_ns
+ */
+bool network_hal_tas_next_window(
+    const network_hal_tas_t *tas,
+    uint8_t traffic_class,
+    uint64_t time_ns,
+    uint64_t min_open_ns,
+    uint64_t *open_ns,
+    uint64_t *close_ns
+);
+
+/**
+ * @brief Admit a batch of frames to the next transmit window
+ *
+ * Finds the next window of traffic_class that fits at least one frame,
+ * starting no earlier than time_ns or the end of the frames committed so far,
+ * and counts how many back to back frames of frame_ns fit in it from its
+ * start. Every admitted frame starts and finishes while the gate is open.
+ *
+ * The caller should not hand the frames to the adapter before start_ns, and
+ * if it gets there late, admit again from the time it got there.
+ *
+ * @param[out] start_ns  When the first frame may start
+ *
+ * @return Frames that fit, at most max_frames; 0 if the gate never stays
+ *         open for one frame
+ */
+uint32_t network_hal_tas_admit(
+    const network_hal_tas_t *tas,
+    uint8_t traffic_class,
+    uint64_t time_ns,
+    uint64_t frame_ns,
+    uint32_t max_frames,
+    uint64_t *start_ns
+);
+
+/**
+ * @brief Record frames handed to the adapter
+ *
+ * Frames sent back to back from start_ns keep the wire busy for
+ * frames * frame_ns; later admissions start after them.
+ */
+void network_hal_tas_commit(
+    network_hal_tas_t *tas,
+    uint64_t start_ns,
+    uint32_t frames,
+    uint64_t frame_ns
+);
+
+/**
+ * @brief Time a frame occupies the wire, rounded up
+ *
+ * @param frame_bytes  Frame length from the destination address to the end of
+ *                     the payload (no FCS)
+ * @param link_mbps    Link speed in Mbit/s
+ */
+uint64_t network_hal_tas_frame_time_ns(uint32_t frame_bytes, uint32_t link_mbps);
+
+/**
+ * @brief Parse a gate control list in taprio sched-entry syntax
+ *
+ * Entries are "S <gate mask in hex> <interval in ns>", separated by commas
+ * or semicolons, e.g. "S 01 300000, S fe 700000". base_time_ns and
+ * cycle_time_ns in config are left unchanged.
+ *
+ * @return NETWORK_HAL_ERROR_INVALID_PARAM on a syntax error or too many entries
+ */
+network_hal_result_t network_hal_tas_parse(const char *text, network_hal_tas_config_t *config);
+
+/**
+ * @brief Format the schedule as taprio qdisc parameters
+ *
+ * Writes "base-time ... sched-entry S .. ... cycle-time ... clockid CLOCK_TAI"
+ * for "tc qdisc replace dev <if> parent root taprio num_tc .. map .. queues ..".
+ *
+ * @return Length of the full string, as snprintf()
+ */
+int network_hal_tas_format_taprio(const network_hal_tas_config_t *config, char *buf, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __OPENAVNU_NETWORK_HAL_TAS_H__ */
@@ -0,0 +1,707 @@
+/**
+ * ACMP Inflight Stress Probe
+ *
+ * Controller and talker side probe used by run_acmp_inflight_veth.sh. It sits
+ * on one end of a veth pair, with openavb_avdecc running a listener on the
+ * other end, and keeps thousands of ACMP commands inflight in the listener
+ * state machine at once:
+ *
+ *  - As controller it sends CONNECT_RX_COMMAND and DISCONNECT_RX_COMMAND to
+ *    listener unique id 0 at a fixed rate, each with its own sequence id and
+ *    talker unique id.
+ *  - As the talker named in those commands it answers the listener's
+ *    CONNECT_TX_COMMAND after --hold msec (with TALKER_NO_BANDWIDTH, so the
+ *    listener never starts a stream) and DISCONNECT_TX_COMMAND after
+ *    --disconnect-hold msec (SUCCESS).
+ *  - A share of connects is answered only on the retry (first attempt
+ *    dropped) and a share never, so the listener's retry and
+ *    LISTENER_TALKER_TIMEOUT paths run while the table is full.
+ *
+ * Every command must get exactly one response with its sequence id and the
+ * expected status. The talker side measures the interval between a CONNECT_TX
+ * attempt and its retry, which must match the 2000 msec CONNECT_TX timeout of
+ * IEEE 1722.1-2013 clause 8.2.2 regardless of how many commands are inflight.
+ * Timers are taken on CLOCK_MONOTONIC.
+ *
+ * Results are written as a single JSON object on stdout (and optionally CSV
+ * rows).
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <poll.h>
+#include <net/if.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/ioctl.h>
+#include <linux/if_packet.h>
+#include <linux/if_ether.h>
+
+#define PROBE_ETHERTYPE_AVTP        0x22F0
+#define PROBE_ETHERTYPE_VLAN        0x8100
+#define PROBE_MAX_COMMANDS          60000   // sequence ids stay unique
+
+#define AVTP_SUBTYPE_ADP            0x7A
+#define AVTP_SUBTYPE_ACMP           0x7C
+
+#define ADP_ENTITY_AVAILABLE        0
+#define ADP_ENTITY_DISCOVER         2
+#define ADP_CONTROL_DATA_LENGTH     56
+
+#define ACMP_CONNECT_TX_COMMAND     0
+#define ACMP_CONNECT_TX_RESPONSE    1
+#define ACMP_DISCONNECT_TX_COMMAND  2
+#define ACMP_DISCONNECT_TX_RESPONSE 3
+#define ACMP_CONNECT_RX_COMMAND     6
+#define ACMP_CONNECT_RX_RESPONSE    7
+#define ACMP_DISCONNECT_RX_COMMAND  8
+#define ACMP_DISCONNECT_RX_RESPONSE 9
+#define ACMP_CONTROL_DATA_LENGTH    44
+
+#define ACMP_STATUS_SUCCESS                 0
+#define ACMP_STATUS_TALKER_NO_BANDWIDTH     5
+#define ACMP_STATUS_LISTENER_TALKER_TIMEOUT 7
+
+// IEEE 1722.1-2013 Table 8.1
+#define ACMP_CONNECT_TX_TIMEOUT_MSEC        2000
+
+// Offsets into an AVTP control PDU (after the Ethernet header)
+#define CTL_ENTITY_ID               4
+#define CTL_HDR_LEN                 12
+
+// Offsets into the ACMP data (after the control header)
+#define ACMP_CONTROLLER_ID          0
+#define ACMP_TALKER_ID              8
+#define ACMP_LISTENER_ID            16
+#define ACMP_TALKER_UNIQUE          24
+#define ACMP_LISTENER_UNIQUE        26
+#define ACMP_SEQUENCE_ID            36
+
+#define NSEC_PER_MSEC               1000000ULL
+
+static const uint8_t acmpMcast[ETH_ALEN] = { 0x91, 0xE0, 0xF0, 0x01, 0x00, 0x00 };
+
+typedef enum {
+    CMD_CONNECT,
+    CMD_DISCONNECT,
+} cmd_kind_t;
+
+typedef enum {
+    TALKER_ANSWER,          // answer the first attempt
+    TALKER_DROP_FIRST,      // answer only the retry
+    TALKER_SILENT,          // never answer
+} talker_behaviour_t;
+
+typedef struct {
+    cmd_kind_t kind;
+    talker_behaviour_t behaviour;
+    uint8_t expectedStatus;
+    uint64_t sentNs;
+    uint64_t respNs;
+    uint32_t responses;
+    uint8_t status;
+    uint32_t talkerAttempts;
+    uint64_t talkerFirstNs;
+} cmd_t;
+
+// Talker response waiting for its hold time
+typedef struct {
+    uint64_t dueNs;
+    uint8_t data[ACMP_CONTROL_DATA_LENGTH];
+    uint8_t streamId[8];
+    uint8_t msgType;
+    uint8_t status;
+} talker_rsp_t;
+
+typedef struct {
+    talker_rsp_t *rsp;
+    uint32_t head;
+    uint32_t tail;
+    uint32_t size;
+} rsp_queue_t;
+
+typedef struct {
+    const char *name;
+    uint32_t sent;
+    uint32_t responses;
+    uint32_t lost;
+    uint32_t duplicates;
+    uint32_t wrongStatus;
+    uint32_t nLatency;
+    uint64_t *latencyNs;
+} probe_test_t;
+
+static int sock = -1;
+static int ifindex;
+static uint8_t myMac[ETH_ALEN];
+static uint8_t myEntityId[8];
+static uint8_t talkerEntityId[8];
+static uint8_t listenerEntityId[8];
+static uint8_t listenerMac[ETH_ALEN];
+
+static cmd_t *cmds;
+static uint32_t nCmds;
+static uint16_t seq0;
+
+static uint64_t nowNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void put16(uint8_t *p, uint16_t v) { p[0] = v >> 8; p[1] = v & 0xFF; }
+static uint16_t get16(const uint8_t *p) { return (uint16_t)((p[0] << 8) | p[1]); }
+
+static int openSocket(const char *ifname)
+{
+    sock = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ALL));
+    if (sock < 0) {
+        fprintf(stderr, "socket: %s\n", strerror(errno));
+        return -1;
+    }
+
+    struct ifreq ifr;
+    memset(&ifr, 0, sizeof(ifr));
+    snprintf(ifr.ifr_name, sizeof(ifr.ifr_name), "%s", ifname);
+    if (ioctl(sock, SIOCGIFINDEX, &ifr) < 0) {
+        fprintf(stderr, "SIOCGIFINDEX %s: %s\n", ifname, strerror(errno));
+        return -1;
+    }
+    ifindex = ifr.ifr_ifindex;
+    if (ioctl(sock, SIOCGIFHWADDR, &ifr) < 0) {
+        fprintf(stderr, "SIOCGIFHWADDR %s: %s\n", ifname, strerror(errno));
+        return -1;
+    }
+    memcpy(myMac, ifr.ifr_hwaddr.sa_data, ETH_ALEN);
+
+    // Controller entity id from the MAC, the same way openavb derives it, and
+    // a second id for the talker this probe pretends to be
+    memcpy(myEntityId, myMac, 3);
+    myEntityId[3] = 0xFF;
+    myEntityId[4] = 0xFE;
+    memcpy(myEntityId + 5, myMac + 3, 3);
+    memcpy(talkerEntityId, myEntityId, 8);
+    talkerEntityId[4] = 0xFD;
+
+    struct sockaddr_ll sll;
+    memset(&sll, 0, sizeof(sll));
+    sll.sll_family = AF_PACKET;
+    sll.sll_protocol = htons(ETH_P_ALL);
+    sll.sll_ifindex = ifindex;
+    if (bind(sock, (struct sockaddr *)&sll, sizeof(sll)) < 0) {
+        fprintf(stderr, "bind: %s\n", strerror(errno));
+        return -1;
+    }
+
+    struct packet_mreq mreq;
+    memset(&mreq, 0, sizeof(mreq));
+    mreq.mr_ifindex = ifindex;
+    mreq.mr_type = PACKET_MR_MULTICAST;
+    mreq.mr_alen = ETH_ALEN;
+    memcpy(mreq.mr_address, acmpMcast, ETH_ALEN);
+    if (setsockopt(sock, SOL_PACKET, PACKET_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0) {
+        fprintf(stderr, "PACKET_ADD_MEMBERSHIP: %s\n", strerror(errno));
+        return -1;
+    }
+
+    // Bursts of thousands of frames
+    int rcvbuf = 8 * 1024 * 1024;
+    setsockopt(sock, SOL_SOCKET, SO_RCVBUFFORCE, &rcvbuf, sizeof(rcvbuf));
+    return 0;
+}
+
+// Build the Ethernet and AVTP control header; returns the PDU start
+static uint8_t *buildHeader(uint8_t *frame, const uint8_t *dst, uint8_t subtype, uint8_t msgType,
+                            uint8_t status, uint16_t controlDataLength, const uint8_t *streamId)
+{
+    memcpy(frame, dst, ETH_ALEN);
+    memcpy(frame + ETH_ALEN, myMac, ETH_ALEN);
+    put16(frame + 12, PROBE_ETHERTYPE_AVTP);
+    uint8_t *pdu = frame + ETH_HLEN;
+    pdu[0] = 0x80 | subtype;
+    pdu[1] = msgType & 0x0F;
+    put16(pdu + 2, ((uint16_t)(status & 0x1F) << 11) | (controlDataLength & 0x07FF));
+    memcpy(pdu + CTL_ENTITY_ID, streamId, 8);
+    return pdu;
+}
+
+static int sendFrame(const uint8_t *frame, size_t len)
+{
+    if (len < 60) {
+        len = 60;
+    }
+    while (send(sock, frame, len, 0) < 0) {
+        if (errno != ENOBUFS && errno != EAGAIN) {
+            fprintf(stderr, "send: %s\n", strerror(errno));
+            return -1;
+        }
+        // veth queue full under a burst; let the other end drain it
+        struct timespec backoff = { 0, 20000 };
+        nanosleep(&backoff, NULL);
+    }
+    return 0;
+}
+
+// AVTP control PDU of the given subtype in frame, not sent by us, or NULL
+static const uint8_t *parsePdu(const uint8_t *frame, ssize_t n, uint8_t subtype, int *pduLen)
+{
+    if (n < ETH_HLEN + CTL_HDR_LEN || memcmp(frame + ETH_ALEN, myMac, ETH_ALEN) == 0) {
+        return NULL;
+    }
+    int off = 12;
+    if (get16(frame + off) == PROBE_ETHERTYPE_VLAN) {
+        off += 4;
+    }
+    if (get16(frame + off) != PROBE_ETHERTYPE_AVTP) {
+        return NULL;
+    }
+    const uint8_t *pdu = frame + off + 2;
+    if (pdu[0] != (0x80 | subtype)) {
+        return NULL;
+    }
+    *pduLen = (int)(n - (off + 2));
+    return pdu;
+}
+
+static bool discoverListener(void)
+{
+    uint8_t frame[128];
+    uint8_t rx[2048];
+    uint8_t zero[8] = { 0 };
+    memset(frame, 0, sizeof(frame));
+    buildHeader(frame, acmpMcast, AVTP_SUBTYPE_ADP, ADP_ENTITY_DISCOVER, 0, ADP_CONTROL_DATA_LENGTH, zero);
+
+    // The entity may still be starting up
+    uint64_t giveUp = nowNs() + 10000 * NSEC_PER_MSEC;
+    while (nowNs() < giveUp) {
+        if (sendFrame(frame, ETH_HLEN + CTL_HDR_LEN + ADP_CONTROL_DATA_LENGTH) < 0) {
+            return false;
+        }
+        uint64_t deadline = nowNs() + 1000 * NSEC_PER_MSEC;
+        uint64_t now;
+        while ((now = nowNs()) < deadline) {
+            struct pollfd pfd = { sock, POLLIN, 0 };
+            if (poll(&pfd, 1, (int)((deadline - now) / NSEC_PER_MSEC) + 1) <= 0) {
+                continue;
+            }
+            ssize_t n = recv(sock, rx, sizeof(rx), 0);
+            int len;
+            const uint8_t *pdu = parsePdu(rx, n, AVTP_SUBTYPE_ADP, &len);
+            if (!pdu || len < CTL_HDR_LEN + ADP_CONTROL_DATA_LENGTH || (pdu[1] & 0x0F) != ADP_ENTITY_AVAILABLE) {
+                continue;
+            }
+            // listener_stream_sinks
+            if (get16(pdu + CTL_HDR_LEN + 8 + 4 + 2 + 2) == 0) {
+                continue;
+            }
+            memcpy(listenerEntityId, pdu + CTL_ENTITY_ID, 8);
+            memcpy(listenerMac, rx + ETH_ALEN, ETH_ALEN);
+            return true;
+        }
+    }
+    return false;
+}
+
+static void sendCommand(uint32_t idx)
+{
+    uint8_t frame[128];
+    uint8_t zero[8] = { 0 };
+    cmd_t *pCmd = &cmds[idx];
+    memset(frame, 0, sizeof(frame));
+    uint8_t msgType = pCmd->kind == CMD_CONNECT ? ACMP_CONNECT_RX_COMMAND : ACMP_DISCONNECT_RX_COMMAND;
+    uint8_t *pdu = buildHeader(frame, listenerMac, AVTP_SUBTYPE_ACMP, msgType, 0, ACMP_CONTROL_DATA_LENGTH, zero);
+    uint8_t *data = pdu + CTL_HDR_LEN;
+    memcpy(data + ACMP_CONTROLLER_ID, myEntityId, 8);
+    memcpy(data + ACMP_TALKER_ID, talkerEntityId, 8);
+    memcpy(data + ACMP_LISTENER_ID, listenerEntityId, 8);
+    put16(data + ACMP_TALKER_UNIQUE, (uint16_t)(idx & 0x3FF));
+    put16(data + ACMP_LISTENER_UNIQUE, 0);
+    put16(data + ACMP_SEQUENCE_ID, (uint16_t)(seq0 + idx));
+
+    pCmd->sentNs = nowNs();
+    sendFrame(frame, ETH_HLEN + CTL_HDR_LEN + ACMP_CONTROL_DATA_LENGTH);
+}
+
+static cmd_t *cmdFromSeq(uint16_t seq)
+{
+    uint32_t idx = (uint16_t)(seq - seq0);
+    return idx < nCmds ? &cmds[idx] : NULL;
+}
+
+static bool queuePush(rsp_queue_t *q, const talker_rsp_t *rsp)
+{
+    if (q->tail - q->head == q->size) {
+        return false;
+    }
+    q->rsp[q->tail++ % q->size] = *rsp;
+    return true;
+}
+
+static talker_rsp_t *queueFront(rsp_queue_t *q)
+{
+    return q->head == q->tail ? NULL : &q->rsp[q->head % q->size];
+}
+
+static void sendTalkerResponse(const talker_rsp_t *rsp)
+{
+    uint8_t frame[128];
+    memset(frame, 0, sizeof(frame));
+    uint8_t *pdu = buildHeader(frame, acmpMcast, AVTP_SUBTYPE_ACMP, rsp->msgType, rsp->status, ACMP_CONTROL_DATA_LENGTH, rsp->streamId);
+    memcpy(pdu + CTL_HDR_LEN, rsp->data, ACMP_CONTROL_DATA_LENGTH);
+    sendFrame(frame, ETH_HLEN + CTL_HDR_LEN + ACMP_CONTROL_DATA_LENGTH);
+}
+
+static void recordLatency(probe_test_t *t, uint64_t ns)
+{
+    if (t->nLatency < nCmds) {
+        t->latencyNs[t->nLatency++] = ns;
+    }
+}
+
+static int cmpU64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static double pctMsec(const probe_test_t *t, double pct)
+{
+    if (t->nLatency == 0) {
+        return 0.0;
+    }
+    uint32_t idx = (uint32_t)(pct / 100.0 * (t->nLatency - 1) + 0.5);
+    return t->latencyNs[idx] / 1e6;
+}
+
+static void printTest(probe_test_t *t, bool last)
+{
+    qsort(t->latencyNs, t->nLatency, sizeof(uint64_t), cmpU64);
+    printf("    \"%s\": {\"sent\": %u, \"responses\": %u, \"lost\": %u, \"duplicates\": %u, \"wrong_status\": %u, ",
+           t->name, t->sent, t->responses, t->lost, t->duplicates, t->wrongStatus);
+    printf("\"latency_msec\": {\"min\": %.2f, \"p50\": %.2f, \"p90\": %.2f, \"p99\": %.2f, \"max\": %.2f}}%s\n",
+           pctMsec(t, 0), pctMsec(t, 50), pctMsec(t, 90), pctMsec(t, 99), pctMsec(t, 100), last ? "" : ",");
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "Usage: %s -i IFNAME [options]\n"
+            "  -i IFNAME   Controller/talker end of the veth pair\n"
+            "  -n COUNT    Commands to send, at most %u (default 5000)\n"
+            "  -r RATE     Commands per second (default 2000)\n"
+            "  -d MSEC     Talker hold time for CONNECT_TX (default 1500)\n"
+            "  -D MSEC     Talker hold time for DISCONNECT_TX (default 50)\n"
+            "  -m N        Every Nth command is a DISCONNECT_RX, 0 for none (default 2)\n"
+            "  -x PCT      Connects answered only on the retry (default 5)\n"
+            "  -s PCT      Connects never answered (default 5)\n"
+            "  -T MSEC     Allowed retry timer error (default 100)\n"
+            "  -l LABEL    Label for the JSON/CSV output\n"
+            "  -c FILE     Append CSV rows to FILE\n",
+            prog, PROBE_MAX_COMMANDS);
+}
+
+int main(int argc, char **argv)
+{
+    const char *ifname = NULL;
+    const char *label = "acmp";
+    const char *csvFile = NULL;
+    uint32_t rate = 2000;
+    uint32_t holdMsec = 1500;
+    uint32_t disconnectHoldMsec = 50;
+    uint32_t disconnectEvery = 2;
+    uint32_t dropPct = 5;
+    uint32_t silentPct = 5;
+    uint32_t timerTolMsec = 100;
+    nCmds = 5000;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "i:n:r:d:D:m:x:s:T:l:c:h")) != -1) {
+        switch (opt) {
+            case 'i': ifname = optarg; break;
+            case 'n': nCmds = (uint32_t)strtoul(optarg, NULL, 10); break;
+            case 'r': rate = (uint32_t)strtoul(optarg, NULL, 10); break;
+            case 'd': holdMsec = (uint32_t)strtoul(optarg, NULL, 10); break;
+            case 'D': disconnectHoldMsec = (uint32_t)strtoul(optarg, NULL, 10); break;
+            case 'm': disconnectEvery = (uint32_t)strtoul(optarg, NULL, 10); break;
+            case 'x': dropPct = (uint32_t)strtoul(optarg, NULL, 10); break;
+            case 's': silentPct = (uint32_t)strtoul(optarg, NULL, 10); break;
+            case 'T': timerTolMsec = (uint32_t)strtoul(optarg, NULL, 10); break;
+            case 'l': label = optarg; break;
+            case 'c': csvFile = optarg; break;
+            default: usage(argv[0]); return 1;
+        }
+    }
+    if (!ifname || nCmds == 0 || nCmds > PROBE_MAX_COMMANDS || rate == 0 ||
+            holdMsec >= ACMP_CONNECT_TX_TIMEOUT_MSEC || dropPct + silentPct > 100) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (openSocket(ifname) < 0) {
+        return 1;
+    }
+    if (!discoverListener()) {
+        fprintf(stderr, "No AVDECC listener answered ENTITY_DISCOVER on %s\n", ifname);
+        printf("{\"label\": \"%s\", \"entity_found\": false}\n", label);
+        return 2;
+    }
+
+    cmds = calloc(nCmds, sizeof(cmd_t));
+    rsp_queue_t connectQ = { calloc(nCmds * 2, sizeof(talker_rsp_t)), 0, 0, nCmds * 2 };
+    rsp_queue_t disconnectQ = { calloc(nCmds * 2, sizeof(talker_rsp_t)), 0, 0, nCmds * 2 };
+    probe_test_t tests[3] = {
+        { .name = "connect_rx" },
+        { .name = "disconnect_rx" },
+        { .name = "connect_rx_talker_timeout" },
+    };
+    probe_test_t retry = { .name = "connect_tx_retry" };
+    int i;
+    for (i = 0; i < 3; i++) {
+        tests[i].latencyNs = calloc(nCmds, sizeof(uint64_t));
+    }
+    retry.latencyNs = calloc(nCmds, sizeof(uint64_t));
+    if (!cmds || !connectQ.rsp || !disconnectQ.rsp || !tests[0].latencyNs || !tests[1].latencyNs ||
+            !tests[2].latencyNs || !retry.latencyNs) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+
+    // Fixed pattern so runs are comparable
+    srand(1722);
+    seq0 = (uint16_t)rand();
+    uint32_t n;
+    for (n = 0; n < nCmds; n++) {
+        cmd_t *pCmd = &cmds[n];
+        if (disconnectEvery && (n % disconnectEvery) == disconnectEvery - 1) {
+            pCmd->kind = CMD_DISCONNECT;
+            pCmd->behaviour = TALKER_ANSWER;
+            pCmd->expectedStatus = ACMP_STATUS_SUCCESS;
+            continue;
+        }
+        pCmd->kind = CMD_CONNECT;
+        uint32_t roll = (uint32_t)(rand() % 100);
+        if (roll < silentPct) {
+            pCmd->behaviour = TALKER_SILENT;
+            pCmd->expectedStatus = ACMP_STATUS_LISTENER_TALKER_TIMEOUT;
+        }
+        else if (roll < silentPct + dropPct) {
+            pCmd->behaviour = TALKER_DROP_FIRST;
+            pCmd->expectedStatus = ACMP_STATUS_TALKER_NO_BANDWIDTH;
+        }
+        else {
+            pCmd->behaviour = TALKER_ANSWER;
+            pCmd->expectedStatus = ACMP_STATUS_TALKER_NO_BANDWIDTH;
+        }
+    }
+
+    uint64_t intervalNs = 1000000000ULL / rate;
+    uint64_t startNs = nowNs();
+    // Silent connects answer after two CONNECT_TX timeouts
+    uint64_t endNs = startNs + intervalNs * nCmds + (2 * ACMP_CONNECT_TX_TIMEOUT_MSEC + 3000) * NSEC_PER_MSEC;
+    uint32_t nextSend = 0;
+    uint32_t resolved = 0;
+    uint32_t outstanding = 0;
+    uint32_t peakOutstanding = 0;
+    uint32_t talkerUnexpected = 0;
+    static uint8_t rx[2048];
+
+    while (resolved < nCmds) {
+        uint64_t now = nowNs();
+        if (now >= endNs) {
+            break;
+        }
+
+        while (nextSend < nCmds && now >= startNs + intervalNs * nextSend) {
+            sendCommand(nextSend++);
+            outstanding++;
+        }
+        if (outstanding > peakOutstanding) {
+            peakOutstanding = outstanding;
+        }
+
+        talker_rsp_t *rsp;
+        while ((rsp = queueFront(&connectQ)) && rsp->dueNs <= now) {
+            sendTalkerResponse(rsp);
+            connectQ.head++;
+        }
+        while ((rsp = queueFront(&disconnectQ)) && rsp->dueNs <= now) {
+            sendTalkerResponse(rsp);
+            disconnectQ.head++;
+        }
+
+        // Sleep until the next send or talker response is due
+        uint64_t wakeNs = endNs;
+        if (nextSend < nCmds && startNs + intervalNs * nextSend < wakeNs) {
+            wakeNs = startNs + intervalNs * nextSend;
+        }
+        if ((rsp = queueFront(&connectQ)) && rsp->dueNs < wakeNs) {
+            wakeNs = rsp->dueNs;
+        }
+        if ((rsp = queueFront(&disconnectQ)) && rsp->dueNs < wakeNs) {
+            wakeNs = rsp->dueNs;
+        }
+        now = nowNs();
+        struct pollfd pfd = { sock, POLLIN, 0 };
+        int waitMsec = wakeNs > now ? (int)((wakeNs - now) / NSEC_PER_MSEC) : 0;
+        if (poll(&pfd, 1, waitMsec) <= 0) {
+            continue;
+        }
+
+        ssize_t len;
+        while ((len = recv(sock, rx, sizeof(rx), MSG_DONTWAIT)) > 0) {
+            int pduLen;
+            const uint8_t *pdu = parsePdu(rx, len, AVTP_SUBTYPE_ACMP, &pduLen);
+            if (!pdu || pduLen < CTL_HDR_LEN + ACMP_CONTROL_DATA_LENGTH) {
+                continue;
+            }
+            const uint8_t *data = pdu + CTL_HDR_LEN;
+            uint8_t msgType = pdu[1] & 0x0F;
+            uint8_t status = pdu[2] >> 3;
+            uint64_t rxNs = nowNs();
+            cmd_t *pCmd = cmdFromSeq(get16(data + ACMP_SEQUENCE_ID));
+
+            if (msgType == ACMP_CONNECT_TX_COMMAND || msgType == ACMP_DISCONNECT_TX_COMMAND) {
+                // Talker side
+                if (memcmp(data + ACMP_TALKER_ID, talkerEntityId, 8) != 0) {
+                    continue;
+                }
+                if (!pCmd || memcmp(data + ACMP_CONTROLLER_ID, myEntityId, 8) != 0 ||
+                        (msgType == ACMP_CONNECT_TX_COMMAND) != (pCmd->kind == CMD_CONNECT)) {
+                    talkerUnexpected++;
+                    continue;
+                }
+                pCmd->talkerAttempts++;
+                if (pCmd->talkerAttempts == 1) {
+                    pCmd->talkerFirstNs = rxNs;
+                }
+                else if (pCmd->talkerAttempts == 2 && msgType == ACMP_CONNECT_TX_COMMAND) {
+                    recordLatency(&retry, rxNs - pCmd->talkerFirstNs);
+                }
+                if (pCmd->behaviour == TALKER_SILENT ||
+                        (pCmd->behaviour == TALKER_DROP_FIRST && pCmd->talkerAttempts == 1)) {
+                    continue;
+                }
+
+                talker_rsp_t r;
+                memcpy(r.data, data, ACMP_CONTROL_DATA_LENGTH);
+                memcpy(r.streamId, pdu + CTL_ENTITY_ID, 8);
+                r.msgType = msgType + 1;
+                if (msgType == ACMP_CONNECT_TX_COMMAND) {
+                    r.status = ACMP_STATUS_TALKER_NO_BANDWIDTH;
+                    r.dueNs = rxNs + holdMsec * NSEC_PER_MSEC;
+                    queuePush(&connectQ, &r);
+                }
+                else {
+                    r.status = ACMP_STATUS_SUCCESS;
+                    r.dueNs = rxNs + disconnectHoldMsec * NSEC_PER_MSEC;
+                    queuePush(&disconnectQ, &r);
+                }
+            }
+            else if (msgType == ACMP_CONNECT_RX_RESPONSE || msgType == ACMP_DISCONNECT_RX_RESPONSE) {
+                // Controller side
+                if (memcmp(data + ACMP_CONTROLLER_ID, myEntityId, 8) != 0 || !pCmd) {
+                    continue;
+                }
+                if ((msgType == ACMP_CONNECT_RX_RESPONSE) != (pCmd->kind == CMD_CONNECT)) {
+                    continue;
+                }
+                pCmd->responses++;
+                if (pCmd->responses == 1) {
+                    pCmd->respNs = rxNs;
+                    pCmd->status = status;
+                    resolved++;
+                    outstanding--;
+                }
+            }
+        }
+    }
+
+    // Tally
+    uint32_t timerLate = 0;
+    for (n = 0; n < nCmds; n++) {
+        cmd_t *pCmd = &cmds[n];
+        probe_test_t *t = pCmd->kind == CMD_DISCONNECT ? &tests[1] :
+                          pCmd->behaviour == TALKER_SILENT ? &tests[2] : &tests[0];
+        if (n >= nextSend) {
+            continue;
+        }
+        t->sent++;
+        if (pCmd->responses == 0) {
+            t->lost++;
+            continue;
+        }
+        t->responses++;
+        if (pCmd->responses > 1) {
+            t->duplicates++;
+        }
+        if (pCmd->status != pCmd->expectedStatus) {
+            t->wrongStatus++;
+        }
+        recordLatency(t, pCmd->respNs - pCmd->sentNs);
+    }
+    for (n = 0; n < retry.nLatency; n++) {
+        int64_t errMsec = (int64_t)(retry.latencyNs[n] / NSEC_PER_MSEC) - ACMP_CONNECT_TX_TIMEOUT_MSEC;
+        if (errMsec < -(int64_t)timerTolMsec || errMsec > (int64_t)timerTolMsec) {
+            timerLate++;
+        }
+    }
+
+    bool pass = nextSend == nCmds && timerLate == 0 && talkerUnexpected == 0;
+    for (i = 0; i < 3; i++) {
+        pass = pass && tests[i].lost == 0 && tests[i].duplicates == 0 && tests[i].wrongStatus == 0;
+    }
+
+    printf("{\"label\": \"%s\", \"entity_found\": true, ", label);
+    printf("\"entity_id\": \"%02x%02x%02x%02x%02x%02x%02x%02x\", ",
+           listenerEntityId[0], listenerEntityId[1], listenerEntityId[2], listenerEntityId[3],
+           listenerEntityId[4], listenerEntityId[5], listenerEntityId[6], listenerEntityId[7]);
+    printf("\"commands\": %u, \"rate\": %u, \"hold_msec\": %u, \"peak_outstanding\": %u, ",
+           nCmds, rate, holdMsec, peakOutstanding);
+    printf("\"talker_unexpected\": %u, \"retry_timer_out_of_tolerance\": %u, \"timer_tolerance_msec\": %u, \"conformant\": %s, \"tests\": {\n",
+           talkerUnexpected, timerLate, timerTolMsec, pass ? "true" : "false");
+    for (i = 0; i < 3; i++) {
+        printTest(&tests[i], false);
+    }
+    qsort(retry.latencyNs, retry.nLatency, sizeof(uint64_t), cmpU64);
+    printf("    \"%s\": {\"retries\": %u, \"interval_msec\": {\"min\": %.2f, \"p50\": %.2f, \"p99\": %.2f, \"max\": %.2f}}\n",
+           retry.name, retry.nLatency, pctMsec(&retry, 0), pctMsec(&retry, 50), pctMsec(&retry, 99), pctMsec(&retry, 100));
+    printf("}}\n");
+
+    if (csvFile) {
+        FILE *csv = fopen(csvFile, "a");
+        if (csv) {
+            if (ftell(csv) == 0) {
+                fprintf(csv, "label,test,sent,responses,lost,duplicates,wrong_status,p50_msec,p99_msec,max_msec\n");
+            }
+            for (i = 0; i < 3; i++) {
+                fprintf(csv, "%s,%s,%u,%u,%u,%u,%u,%.2f,%.2f,%.2f\n", label, tests[i].name,
+                        tests[i].sent, tests[i].responses, tests[i].lost, tests[i].duplicates, tests[i].wrongStatus,
+                        pctMsec(&tests[i], 50), pctMsec(&tests[i], 99), pctMsec(&tests[i], 100));
+            }
+            fprintf(csv, "%s,%s,%u,%u,0,0,%u,%.2f,%.2f,%.2f\n", label, retry.name,
+                    retry.nLatency, retry.nLatency, timerLate,
+                    pctMsec(&retry, 50), pctMsec(&retry, 99), pctMsec(&retry, 100));
+            fclose(csv);
+        }
+    }
+
+    for (i = 0; i < 3; i++) {
+        free(tests[i].latencyNs);
+    }
+    free(retry.latencyNs);
+    free(connectQ.rsp);
+    free(disconnectQ.rsp);
+    free(cmds);
+    close(sock);
+    return pass ? 0 : 3;
+}
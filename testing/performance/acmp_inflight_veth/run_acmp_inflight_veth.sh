@@ -0,0 +1,203 @@
+#!/bin/bash
+#
+# ACMP inflight stress test over a veth pair.
+#
+# Runs openavb_avdecc with a listener (and openavb_endpoint and openavb_host
+# for the stream) on one end of a veth pair and acmp_stress_probe on the other
+# end, once per AVDECC mode (threads, engine). The probe is the controller and
+# the talker at once: it sends thousands of CONNECT_RX and DISCONNECT_RX
+# commands and holds the listener's CONNECT_TX commands, so thousands are
+# inflight in the listener state machine together. Per mode it records:
+#   - lost, duplicate and wrong-status responses and response latency
+#   - the CONNECT_TX retry interval seen by the talker, which must stay at the
+#     2000 msec timeout
+#   - thread count and CPU time of the openavb_avdecc process
+#
+# One JSON object per mode is appended to results.jsonl and the probe adds
+# rows to results.csv in the output directory. The exit status is non-zero if
+# any mode lost or mis-answered a command or missed a retry timer.
+#
+# Requirements: root (veth creation, raw sockets), an AVDECC build of the
+# avtp_pipeline and a listener ini. openavb_endpoint needs mrpd and
+# maap_daemon on the entity end of the pair, as for normal use.
+
+set -u
+
+BIN_DIR=""
+PROBE=""
+AVDECC_INI=""
+ENDPOINT_INI=""
+STREAM_INI=""
+MODES="threads engine"
+COMMANDS=5000
+RATE=2000
+HOLD_MSEC=1500
+OUT_DIR="./acmp_inflight_veth_results"
+VETH_ENTITY="acmp0"
+VETH_CONTROLLER="acmp1"
+KEEP_VETH=0
+
+usage() {
+    cat <<EOF
+Usage: $0 --bin DIR --probe PATH --avdecc-ini FILE --endpoint-ini FILE --stream-ini FILE [options]
+  --bin DIR             Directory with openavb_avdecc, openavb_endpoint and openavb_host
+  --probe PATH          acmp_stress_probe binary
+  --avdecc-ini FILE     avdecc.ini to start from; [network] is overridden per mode
+  --endpoint-ini FILE   endpoint.ini to start from; ifname is set to the veth
+  --stream-ini FILE     Listener ini for openavb_host and openavb_avdecc
+  --modes "LIST"        Modes to run (default "${MODES}")
+  --commands N          CONNECT_RX and DISCONNECT_RX commands (default ${COMMANDS})
+  --rate N              Commands per second (default ${RATE})
+  --hold MSEC           Talker hold time for CONNECT_TX (default ${HOLD_MSEC})
+  --out DIR             Output directory (default ${OUT_DIR})
+  --keep-veth           Leave the veth pair in place on exit
+EOF
+}
+
+while [ $# -gt 0 ]; do
+    case "$1" in
+        --bin) BIN_DIR="$2"; shift 2 ;;
+        --probe) PROBE="$2"; shift 2 ;;
+        --avdecc-ini) AVDECC_INI="$2"; shift 2 ;;
+        --endpoint-ini) ENDPOINT_INI="$2"; shift 2 ;;
+        --stream-ini) STREAM_INI="$2"; shift 2 ;;
+        --modes) MODES="$2"; shift 2 ;;
+        --commands) COMMANDS="$2"; shift 2 ;;
+        --rate) RATE="$2"; shift 2 ;;
+        --hold) HOLD_MSEC="$2"; shift 2 ;;
+        --out) OUT_DIR="$2"; shift 2 ;;
+        --keep-veth) KEEP_VETH=1; shift ;;
+        -h|--help) usage; exit 0 ;;
+        *) echo "Unknown option: $1"; usage; exit 1 ;;
+    esac
+done
+
+if [ -z "${BIN_DIR}" ] || [ -z "${PROBE}" ] || [ -z "${AVDECC_INI}" ] || [ -z "${ENDPOINT_INI}" ] || [ -z "${STREAM_INI}" ]; then
+    usage
+    exit 1
+fi
+if [ "$(id -u)" -ne 0 ]; then
+    echo "This test needs root to create veth interfaces and open raw sockets"
+    exit 1
+fi
+for bin in openavb_avdecc openavb_endpoint openavb_host; do
+    if [ ! -x "${BIN_DIR}/${bin}" ]; then
+        echo "${BIN_DIR}/${bin} not found"
+        exit 1
+    fi
+done
+
+mkdir -p "${OUT_DIR}"
+OUT_DIR="$(cd "${OUT_DIR}" && pwd)"
+AVDECC_INI="$(cd "$(dirname "${AVDECC_INI}")" && pwd)/$(basename "${AVDECC_INI}")"
+ENDPOINT_INI="$(cd "$(dirname "${ENDPOINT_INI}")" && pwd)/$(basename "${ENDPOINT_INI}")"
+STREAM_INI="$(cd "$(dirname "${STREAM_INI}")" && pwd)/$(basename "${STREAM_INI}")"
+RESULTS_JSON="${OUT_DIR}/results.jsonl"
+RESULTS_CSV="${OUT_DIR}/results.csv"
+CLK_TCK=$(getconf CLK_TCK)
+
+ENDPOINT_PID=""
+AVDECC_PID=""
+HOST_PID=""
+
+cleanup() {
+    for pid in ${HOST_PID} ${AVDECC_PID} ${ENDPOINT_PID}; do
+        kill -INT "${pid}" 2>/dev/null
+    done
+    sleep 1
+    for pid in ${HOST_PID} ${AVDECC_PID} ${ENDPOINT_PID}; do
+        kill -KILL "${pid}" 2>/dev/null
+    done
+    HOST_PID=""
+    AVDECC_PID=""
+    ENDPOINT_PID=""
+}
+
+teardown() {
+    cleanup
+    if [ ${KEEP_VETH} -eq 0 ]; then
+        ip link del "${VETH_ENTITY}" 2>/dev/null
+    fi
+}
+trap teardown EXIT INT TERM
+
+# Total utime+stime ticks of a process, 0 if it is gone
+proc_ticks() {
+    if [ -r "/proc/$1/stat" ]; then
+        sed 's/^.*) //' "/proc/$1/stat" | awk '{ print $12 + $13 }'
+    else
+        echo 0
+    fi
+}
+
+proc_threads() {
+    awk '/^Threads:/ { print $2 }' "/proc/$1/status" 2>/dev/null || echo 0
+}
+
+ip link del "${VETH_ENTITY}" 2>/dev/null
+ip link add "${VETH_ENTITY}" type veth peer name "${VETH_CONTROLLER}" || exit 1
+for dev in "${VETH_ENTITY}" "${VETH_CONTROLLER}"; do
+    sysctl -qw "net.ipv6.conf.${dev}.disable_ipv6=1" 2>/dev/null
+    ip link set "${dev}" up || exit 1
+done
+
+FAILED=0
+for MODE in ${MODES}; do
+    case "${MODE}" in
+        threads) ENGINE=0 ;;
+        engine) ENGINE=1 ;;
+        *) echo "Skipping unknown mode ${MODE}"; continue ;;
+    esac
+
+    # openavb_avdecc and openavb_endpoint read their ini from the working
+    # directory
+    RUN_DIR="${OUT_DIR}/${MODE}"
+    rm -rf "${RUN_DIR}"
+    mkdir -p "${RUN_DIR}"
+    awk -v engine="${ENGINE}" -v ifname="${VETH_ENTITY}" '
+        /^\[/ { in_net = ($0 ~ /^\[network\]/) }
+        in_net && /^[ \t]*(ifname|single_thread_engine)[ \t]*=/ { next }
+        { print }
+        /^\[network\]/ { print "ifname = " ifname; print "single_thread_engine = " engine }
+    ' "${AVDECC_INI}" > "${RUN_DIR}/avdecc.ini"
+    sed "s/^[ \t]*ifname[ \t]*=.*/ifname = ${VETH_ENTITY}/" "${ENDPOINT_INI}" > "${RUN_DIR}/endpoint.ini"
+    cp "${STREAM_INI}" "${RUN_DIR}/"
+    STREAM_FILE="${RUN_DIR}/$(basename "${STREAM_INI}")"
+
+    (cd "${RUN_DIR}" && exec "${BIN_DIR}/openavb_endpoint" > endpoint.out 2>&1) &
+    ENDPOINT_PID=$!
+    sleep 1
+    (cd "${RUN_DIR}" && exec "${BIN_DIR}/openavb_avdecc" -I "${VETH_ENTITY}" "${STREAM_FILE}" > avdecc.out 2>&1) &
+    AVDECC_PID=$!
+    sleep 1
+    (cd "${RUN_DIR}" && exec "${BIN_DIR}/openavb_host" -I "${VETH_ENTITY}" "${STREAM_FILE}" > host.out 2>&1) &
+    HOST_PID=$!
+    sleep 2
+
+    THREADS=$(proc_threads "${AVDECC_PID}")
+    A0=$(proc_ticks "${AVDECC_PID}")
+    T0=$(date +%s.%N)
+    "${PROBE}" -i "${VETH_CONTROLLER}" -n "${COMMANDS}" -r "${RATE}" -d "${HOLD_MSEC}" \
+        -l "${MODE}" -c "${RESULTS_CSV}" > "${RUN_DIR}/probe.json"
+    PROBE_RC=$?
+    T1=$(date +%s.%N)
+    A1=$(proc_ticks "${AVDECC_PID}")
+    AVDECC_ALIVE=1; kill -0 "${AVDECC_PID}" 2>/dev/null || AVDECC_ALIVE=0
+    cleanup
+
+    [ ${PROBE_RC} -ne 0 ] && FAILED=1
+    CPU_PCT=$(awk -v a0="${A0}" -v a1="${A1}" -v t0="${T0}" -v t1="${T1}" -v hz="${CLK_TCK}" \
+        'BEGIN { printf "%.2f", (a1 - a0) * 100.0 / hz / (t1 - t0) }')
+
+    {
+        printf '{"mode": "%s", "avdecc_threads": %d, "avdecc_cpu_pct": %s, "avdecc_alive": %d, "probe_rc": %d, "probe": ' \
+            "${MODE}" "${THREADS:-0}" "${CPU_PCT}" "${AVDECC_ALIVE}" "${PROBE_RC}"
+        tr -d '\n' < "${RUN_DIR}/probe.json"
+        printf '}\n'
+    } >> "${RESULTS_JSON}"
+
+    echo "${MODE}: threads=${THREADS} cpu=${CPU_PCT}% $(grep -o '"conformant": [a-z]*' "${RUN_DIR}/probe.json")"
+    grep -o '"[a-z_]*": {"\(sent\|retries\)[^}]*}' "${RUN_DIR}/probe.json" | sed 's/^/    /'
+done
+
+exit ${FAILED}
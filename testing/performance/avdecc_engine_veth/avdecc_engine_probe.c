@@ -0,0 +1,677 @@
+/**
+ * AVDECC Engine Veth Probe
+ *
+ * Controller-side probe used by run_avdecc_engine_veth.sh. It sits on one end
+ * of a veth pair, with openavb_avdecc on the other end, and checks that the
+ * entity answers the AVDECC protocols correctly and how quickly:
+ *  - ADP:  ENTITY_DISCOVER -> ENTITY_AVAILABLE
+ *  - AECP: AEM READ_DESCRIPTOR(ENTITY 0) and ENTITY_AVAILABLE -> AEM_RESPONSE
+ *  - ACMP: GET_RX_STATE_COMMAND -> GET_RX_STATE_RESPONSE (listener entities)
+ *  - ACMP: two CONNECT_RX_COMMANDs back to back -> a CONNECT_RX_RESPONSE for
+ *          each (listener entities). The probe plays the talker and refuses
+ *          the CONNECT_TX_COMMANDs, so no stream is started.
+ *
+ * Every response is checked against the command that triggered it (message
+ * type, status, sequence id, controller and target ids, command type and
+ * lengths). Responses that fail a check are counted as non-conformant,
+ * commands that get no response within the timeout as lost. Round trip
+ * latency is measured from send to receive on CLOCK_MONOTONIC.
+ *
+ * The same probe is run against the thread-per-protocol AVDECC and against
+ * the single-thread engine (single_thread_engine = 1), so the two can be
+ * compared. Results are written as a single JSON object on stdout (and
+ * optionally one CSV row).
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <poll.h>
+#include <net/if.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/ioctl.h>
+#include <linux/if_packet.h>
+#include <linux/if_ether.h>
+
+#define PROBE_ETHERTYPE_AVTP        0x22F0
+#define PROBE_ETHERTYPE_VLAN        0x8100
+#define PROBE_MAX_ITERATIONS        100000
+
+#define AVTP_SUBTYPE_ADP            0x7A
+#define AVTP_SUBTYPE_AECP           0x7B
+#define AVTP_SUBTYPE_ACMP           0x7C
+
+#define ADP_ENTITY_AVAILABLE        0
+#define ADP_ENTITY_DISCOVER         2
+#define ADP_CONTROL_DATA_LENGTH     56
+
+#define AECP_AEM_COMMAND            0
+#define AECP_AEM_RESPONSE           1
+#define AEM_CMD_ENTITY_AVAILABLE    0x0002
+#define AEM_CMD_READ_DESCRIPTOR     0x0004
+#define AEM_DESCRIPTOR_ENTITY       0x0000
+#define AEM_ENTITY_DESCRIPTOR_MIN   12      // type, index and entity_id
+
+#define ACMP_CONNECT_TX_COMMAND     0
+#define ACMP_CONNECT_TX_RESPONSE    1
+#define ACMP_CONNECT_RX_COMMAND     6
+#define ACMP_CONNECT_RX_RESPONSE    7
+#define ACMP_GET_RX_STATE_COMMAND   10
+#define ACMP_GET_RX_STATE_RESPONSE  11
+#define ACMP_CONTROL_DATA_LENGTH    44
+#define ACMP_STATUS_TALKER_NO_BANDWIDTH 5
+#define ACMP_STATUS_MAX             31
+#define ACMP_BURST                  2
+
+// Offsets into an AVTP control PDU (after the Ethernet header)
+#define CTL_ENTITY_ID               4
+#define CTL_HDR_LEN                 12
+
+static const uint8_t adpMcast[ETH_ALEN] = { 0x91, 0xE0, 0xF0, 0x01, 0x00, 0x00 };
+
+typedef struct {
+    const char *name;
+    uint32_t sent;
+    uint32_t responses;
+    uint32_t lost;
+    uint32_t nonconformant;
+    uint32_t statusCounts[ACMP_STATUS_MAX + 1];
+    uint32_t nLatency;
+    uint64_t *latencyNs;
+} probe_test_t;
+
+typedef struct {
+    uint8_t mac[ETH_ALEN];
+    uint8_t entityId[8];
+    uint16_t listenerSinks;
+    uint32_t availableIndex;
+    bool found;
+} probe_entity_t;
+
+static int sock = -1;
+static int ifindex;
+static uint8_t myMac[ETH_ALEN];
+static uint8_t myEntityId[8];
+static uint16_t seqId;
+static int timeoutMsec = 200;
+
+static uint64_t nowNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void put16(uint8_t *p, uint16_t v) { p[0] = v >> 8; p[1] = v & 0xFF; }
+static uint16_t get16(const uint8_t *p) { return (uint16_t)((p[0] << 8) | p[1]); }
+static uint32_t get32(const uint8_t *p) { return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3]; }
+
+static int openSocket(const char *ifname)
+{
+    sock = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ALL));
+    if (sock < 0) {
+        fprintf(stderr, "socket: %s\n", strerror(errno));
+        return -1;
+    }
+
+    struct ifreq ifr;
+    memset(&ifr, 0, sizeof(ifr));
+    snprintf(ifr.ifr_name, sizeof(ifr.ifr_name), "%s", ifname);
+    if (ioctl(sock, SIOCGIFINDEX, &ifr) < 0) {
+        fprintf(stderr, "SIOCGIFINDEX %s: %s\n", ifname, strerror(errno));
+        return -1;
+    }
+    ifindex = ifr.ifr_ifindex;
+    if (ioctl(sock, SIOCGIFHWADDR, &ifr) < 0) {
+        fprintf(stderr, "SIOCGIFHWADDR %s: %s\n", ifname, strerror(errno));
+        return -1;
+    }
+    memcpy(myMac, ifr.ifr_hwaddr.sa_data, ETH_ALEN);
+
+    // Controller entity id from the MAC, the same way openavb derives it
+    memcpy(myEntityId, myMac, 3);
+    myEntityId[3] = 0xFF;
+    myEntityId[4] = 0xFE;
+    memcpy(myEntityId + 5, myMac + 3, 3);
+
+    struct sockaddr_ll sll;
+    memset(&sll, 0, sizeof(sll));
+    sll.sll_family = AF_PACKET;
+    sll.sll_protocol = htons(ETH_P_ALL);
+    sll.sll_ifindex = ifindex;
+    if (bind(sock, (struct sockaddr *)&sll, sizeof(sll)) < 0) {
+        fprintf(stderr, "bind: %s\n", strerror(errno));
+        return -1;
+    }
+
+    struct packet_mreq mreq;
+    memset(&mreq, 0, sizeof(mreq));
+    mreq.mr_ifindex = ifindex;
+    mreq.mr_type = PACKET_MR_MULTICAST;
+    mreq.mr_alen = ETH_ALEN;
+    memcpy(mreq.mr_address, adpMcast, ETH_ALEN);
+    if (setsockopt(sock, SOL_PACKET, PACKET_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0) {
+        fprintf(stderr, "PACKET_ADD_MEMBERSHIP: %s\n", strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+// Build the Ethernet and AVTP control header; returns the PDU start
+static uint8_t *buildHeader(uint8_t *frame, const uint8_t *dst, uint8_t subtype, uint8_t msgType,
+                            uint16_t controlDataLength, const uint8_t *entityId)
+{
+    memcpy(frame, dst, ETH_ALEN);
+    memcpy(frame + ETH_ALEN, myMac, ETH_ALEN);
+    put16(frame + 12, PROBE_ETHERTYPE_AVTP);
+    uint8_t *pdu = frame + ETH_HLEN;
+    pdu[0] = 0x80 | subtype;
+    pdu[1] = msgType & 0x0F;
+    put16(pdu + 2, controlDataLength & 0x07FF);
+    memcpy(pdu + CTL_ENTITY_ID, entityId, 8);
+    return pdu;
+}
+
+static int sendFrame(const uint8_t *frame, size_t len)
+{
+    if (len < 60) {
+        len = 60;
+    }
+    if (send(sock, frame, len, 0) < 0) {
+        fprintf(stderr, "send: %s\n", strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+// Next AVTP control PDU of the given subtype not sent by us, or NULL on
+// timeout. *srcMac points at the frame's source address.
+static const uint8_t *recvPdu(uint8_t *frame, size_t size, uint8_t subtype, uint64_t deadlineNs,
+                              int *pduLen, const uint8_t **srcMac)
+{
+    for (;;) {
+        uint64_t now = nowNs();
+        if (now >= deadlineNs) {
+            return NULL;
+        }
+        struct pollfd pfd = { sock, POLLIN, 0 };
+        int waitMsec = (int)((deadlineNs - now + 999999) / 1000000);
+        if (poll(&pfd, 1, waitMsec) <= 0) {
+            continue;
+        }
+        ssize_t n = recv(sock, frame, size, 0);
+        if (n < ETH_HLEN + CTL_HDR_LEN) {
+            continue;
+        }
+        if (memcmp(frame + ETH_ALEN, myMac, ETH_ALEN) == 0) {
+            continue;
+        }
+        int off = 12;
+        if (get16(frame + off) == PROBE_ETHERTYPE_VLAN) {
+            off += 4;
+        }
+        if (get16(frame + off) != PROBE_ETHERTYPE_AVTP) {
+            continue;
+        }
+        const uint8_t *pdu = frame + off + 2;
+        if (pdu[0] != (0x80 | subtype)) {
+            continue;
+        }
+        *pduLen = (int)(n - (off + 2));
+        *srcMac = frame + ETH_ALEN;
+        return pdu;
+    }
+}
+
+static void recordLatency(probe_test_t *t, uint64_t ns)
+{
+    if (t->nLatency < PROBE_MAX_ITERATIONS) {
+        t->latencyNs[t->nLatency++] = ns;
+    }
+}
+
+// ADP ENTITY_AVAILABLE fields required by IEEE 1722.1 6.2.1
+static bool adpConformant(const uint8_t *pdu, int len)
+{
+    uint16_t cdl = get16(pdu + 2) & 0x07FF;
+    uint8_t validTime = pdu[2] >> 3;
+    return len >= CTL_HDR_LEN + ADP_CONTROL_DATA_LENGTH &&
+           (pdu[1] & 0x0F) == ADP_ENTITY_AVAILABLE &&
+           (pdu[1] & 0x80) == 0 &&
+           cdl == ADP_CONTROL_DATA_LENGTH &&
+           validTime != 0;
+}
+
+static bool discoverEntity(probe_entity_t *pEntity, uint8_t *rx, size_t rxSize)
+{
+    uint8_t frame[128];
+    uint8_t zero[8] = { 0 };
+    memset(frame, 0, sizeof(frame));
+    buildHeader(frame, adpMcast, AVTP_SUBTYPE_ADP, ADP_ENTITY_DISCOVER, ADP_CONTROL_DATA_LENGTH, zero);
+
+    // The entity may still be starting up
+    uint64_t giveUp = nowNs() + 10ULL * 1000000000ULL;
+    while (nowNs() < giveUp) {
+        if (sendFrame(frame, ETH_HLEN + CTL_HDR_LEN + ADP_CONTROL_DATA_LENGTH) < 0) {
+            return false;
+        }
+        int len;
+        const uint8_t *src;
+        const uint8_t *pdu = recvPdu(rx, rxSize, AVTP_SUBTYPE_ADP, nowNs() + 1000000000ULL, &len, &src);
+        if (pdu && adpConformant(pdu, len)) {
+            memcpy(pEntity->mac, src, ETH_ALEN);
+            memcpy(pEntity->entityId, pdu + CTL_ENTITY_ID, 8);
+            pEntity->listenerSinks = get16(pdu + CTL_HDR_LEN + 8 + 4 + 2 + 2);
+            pEntity->availableIndex = get32(pdu + CTL_HDR_LEN + 8 + 4 + 2 + 2 + 2 + 2 + 4);
+            pEntity->found = true;
+            return true;
+        }
+    }
+    return false;
+}
+
+static void runAdp(probe_test_t *t, probe_entity_t *pEntity, uint8_t *rx, size_t rxSize)
+{
+    uint8_t frame[128];
+    uint8_t zero[8] = { 0 };
+    memset(frame, 0, sizeof(frame));
+    buildHeader(frame, adpMcast, AVTP_SUBTYPE_ADP, ADP_ENTITY_DISCOVER, ADP_CONTROL_DATA_LENGTH, zero);
+
+    uint64_t start = nowNs();
+    if (sendFrame(frame, ETH_HLEN + CTL_HDR_LEN + ADP_CONTROL_DATA_LENGTH) < 0) {
+        return;
+    }
+    t->sent++;
+
+    uint64_t deadline = start + (uint64_t)timeoutMsec * 1000000ULL;
+    int len;
+    const uint8_t *src;
+    const uint8_t *pdu;
+    while ((pdu = recvPdu(rx, rxSize, AVTP_SUBTYPE_ADP, deadline, &len, &src)) != NULL) {
+        if (memcmp(pdu + CTL_ENTITY_ID, pEntity->entityId, 8) != 0) {
+            continue;
+        }
+        recordLatency(t, nowNs() - start);
+        t->responses++;
+
+        // available_index must never go backwards while the entity is up
+        uint32_t index = get32(pdu + CTL_HDR_LEN + 8 + 4 + 2 + 2 + 2 + 2 + 4);
+        if (!adpConformant(pdu, len) || index < pEntity->availableIndex) {
+            t->nonconformant++;
+        }
+        pEntity->availableIndex = index;
+        return;
+    }
+    t->lost++;
+}
+
+static void runAecp(probe_test_t *t, const probe_entity_t *pEntity, uint16_t commandType, uint8_t *rx, size_t rxSize)
+{
+    uint8_t frame[128];
+    memset(frame, 0, sizeof(frame));
+    uint16_t payloadLen = (commandType == AEM_CMD_READ_DESCRIPTOR) ? 8 : 0;
+    uint16_t cdl = 8 + 2 + 2 + payloadLen;
+    uint8_t *pdu = buildHeader(frame, pEntity->mac, AVTP_SUBTYPE_AECP, AECP_AEM_COMMAND, cdl, pEntity->entityId);
+    uint16_t seq = seqId++;
+    memcpy(pdu + CTL_HDR_LEN, myEntityId, 8);
+    put16(pdu + CTL_HDR_LEN + 8, seq);
+    put16(pdu + CTL_HDR_LEN + 10, commandType);
+    if (commandType == AEM_CMD_READ_DESCRIPTOR) {
+        // configuration 0, descriptor ENTITY 0
+        put16(pdu + CTL_HDR_LEN + 16, AEM_DESCRIPTOR_ENTITY);
+    }
+
+    uint64_t start = nowNs();
+    if (sendFrame(frame, ETH_HLEN + CTL_HDR_LEN + cdl) < 0) {
+        return;
+    }
+    t->sent++;
+
+    uint64_t deadline = start + (uint64_t)timeoutMsec * 1000000ULL;
+    int len;
+    const uint8_t *src;
+    const uint8_t *rsp;
+    while ((rsp = recvPdu(rx, rxSize, AVTP_SUBTYPE_AECP, deadline, &len, &src)) != NULL) {
+        if ((rsp[1] & 0x0F) != AECP_AEM_RESPONSE || get16(rsp + CTL_HDR_LEN + 8) != seq) {
+            continue;
+        }
+        recordLatency(t, nowNs() - start);
+        t->responses++;
+
+        uint8_t status = rsp[2] >> 3;
+        uint16_t rspCdl = get16(rsp + 2) & 0x07FF;
+        t->statusCounts[status]++;
+        bool ok = status == 0 &&
+                  memcmp(rsp + CTL_ENTITY_ID, pEntity->entityId, 8) == 0 &&
+                  memcmp(rsp + CTL_HDR_LEN, myEntityId, 8) == 0 &&
+                  (get16(rsp + CTL_HDR_LEN + 10) & 0x7FFF) == commandType &&
+                  len >= CTL_HDR_LEN + rspCdl;
+        if (commandType == AEM_CMD_READ_DESCRIPTOR) {
+            // configuration_index, reserved, then the ENTITY descriptor itself
+            ok = ok && rspCdl >= 8 + 2 + 2 + 4 + AEM_ENTITY_DESCRIPTOR_MIN &&
+                 get16(rsp + CTL_HDR_LEN + 16) == AEM_DESCRIPTOR_ENTITY &&
+                 memcmp(rsp + CTL_HDR_LEN + 20, pEntity->entityId, 8) == 0;
+        }
+        else {
+            ok = ok && rspCdl == cdl;
+        }
+        if (!ok) {
+            t->nonconformant++;
+        }
+        return;
+    }
+    t->lost++;
+}
+
+static void runAcmp(probe_test_t *t, const probe_entity_t *pEntity, uint8_t *rx, size_t rxSize)
+{
+    uint8_t frame[128];
+    uint8_t zero[8] = { 0 };
+    memset(frame, 0, sizeof(frame));
+    uint8_t *pdu = buildHeader(frame, adpMcast, AVTP_SUBTYPE_ACMP, ACMP_GET_RX_STATE_COMMAND, ACMP_CONTROL_DATA_LENGTH, zero);
+    uint16_t seq = seqId++;
+    uint8_t *data = pdu + CTL_HDR_LEN;
+    memcpy(data, myEntityId, 8);
+    memcpy(data + 16, pEntity->entityId, 8);    // listener_entity_id, unique id 0
+    put16(data + 36, seq);
+
+    uint64_t start = nowNs();
+    if (sendFrame(frame, ETH_HLEN + CTL_HDR_LEN + ACMP_CONTROL_DATA_LENGTH) < 0) {
+        return;
+    }
+    t->sent++;
+
+    uint64_t deadline = start + (uint64_t)timeoutMsec * 1000000ULL;
+    int len;
+    const uint8_t *src;
+    const uint8_t *rsp;
+    while ((rsp = recvPdu(rx, rxSize, AVTP_SUBTYPE_ACMP, deadline, &len, &src)) != NULL) {
+        const uint8_t *rdata = rsp + CTL_HDR_LEN;
+        if ((rsp[1] & 0x0F) != ACMP_GET_RX_STATE_RESPONSE || get16(rdata + 36) != seq) {
+            continue;
+        }
+        recordLatency(t, nowNs() - start);
+        t->responses++;
+
+        // Any status is a valid answer; a stream that is not connected
+        // reports NOT_CONNECTED rather than an error
+        uint8_t status = rsp[2] >> 3;
+        t->statusCounts[status]++;
+        bool ok = (get16(rsp + 2) & 0x07FF) == ACMP_CONTROL_DATA_LENGTH &&
+                  len >= CTL_HDR_LEN + ACMP_CONTROL_DATA_LENGTH &&
+                  memcmp(rdata, myEntityId, 8) == 0 &&
+                  memcmp(rdata + 16, pEntity->entityId, 8) == 0 &&
+                  get16(rdata + 26) == 0;
+        if (!ok) {
+            t->nonconformant++;
+        }
+        return;
+    }
+    t->lost++;
+}
+
+// Two CONNECT_RX_COMMANDs sent back to back reach the entity in one wakeup.
+// Each must get its own CONNECT_RX_RESPONSE: the second may not overwrite
+// the first before the listener state machine has taken it in.
+static void runAcmpConnectBurst(probe_test_t *t, const probe_entity_t *pEntity, uint8_t *rx, size_t rxSize)
+{
+    uint8_t frames[ACMP_BURST][128];
+    uint8_t zero[8] = { 0 };
+    uint16_t seqs[ACMP_BURST];
+    uint16_t uniqueIds[ACMP_BURST];
+    bool answered[ACMP_BURST] = { false };
+    int i;
+
+    // The probe is the talker as well, with an entity id of its own
+    uint8_t talkerId[8];
+    memcpy(talkerId, myEntityId, 8);
+    talkerId[7] ^= 0x01;
+
+    for (i = 0; i < ACMP_BURST; i++) {
+        memset(frames[i], 0, sizeof(frames[i]));
+        uint8_t *pdu = buildHeader(frames[i], adpMcast, AVTP_SUBTYPE_ACMP, ACMP_CONNECT_RX_COMMAND, ACMP_CONTROL_DATA_LENGTH, zero);
+        uint8_t *data = pdu + CTL_HDR_LEN;
+        seqs[i] = seqId++;
+        uniqueIds[i] = pEntity->listenerSinks > i ? i : 0;
+        memcpy(data, myEntityId, 8);
+        memcpy(data + 8, talkerId, 8);
+        memcpy(data + 16, pEntity->entityId, 8);
+        put16(data + 24, i);
+        put16(data + 26, uniqueIds[i]);
+        put16(data + 36, seqs[i]);
+    }
+
+    uint64_t start = nowNs();
+    for (i = 0; i < ACMP_BURST; i++) {
+        if (sendFrame(frames[i], ETH_HLEN + CTL_HDR_LEN + ACMP_CONTROL_DATA_LENGTH) < 0) {
+            return;
+        }
+        t->sent++;
+    }
+
+    // The listener asks the talker before it answers, so allow two timeouts
+    uint64_t deadline = start + 2ULL * timeoutMsec * 1000000ULL;
+    int nAnswered = 0;
+    int len;
+    const uint8_t *src;
+    const uint8_t *rsp;
+    while (nAnswered < ACMP_BURST &&
+           (rsp = recvPdu(rx, rxSize, AVTP_SUBTYPE_ACMP, deadline, &len, &src)) != NULL) {
+        const uint8_t *rdata = rsp + CTL_HDR_LEN;
+        if (len < CTL_HDR_LEN + ACMP_CONTROL_DATA_LENGTH) {
+            continue;
+        }
+        uint8_t msgType = rsp[1] & 0x0F;
+
+        if (msgType == ACMP_CONNECT_TX_COMMAND && memcmp(rdata + 8, talkerId, 8) == 0) {
+            // Refuse as the talker; the listener passes the status on
+            uint8_t frame[128];
+            memset(frame, 0, sizeof(frame));
+            uint8_t *pdu = buildHeader(frame, adpMcast, AVTP_SUBTYPE_ACMP, ACMP_CONNECT_TX_RESPONSE, ACMP_CONTROL_DATA_LENGTH, zero);
+            pdu[2] |= ACMP_STATUS_TALKER_NO_BANDWIDTH << 3;
+            memcpy(pdu + CTL_HDR_LEN, rdata, ACMP_CONTROL_DATA_LENGTH);
+            sendFrame(frame, ETH_HLEN + CTL_HDR_LEN + ACMP_CONTROL_DATA_LENGTH);
+            continue;
+        }
+        if (msgType != ACMP_CONNECT_RX_RESPONSE) {
+            continue;
+        }
+        for (i = 0; i < ACMP_BURST; i++) {
+            if (!answered[i] && get16(rdata + 36) == seqs[i]) {
+                break;
+            }
+        }
+        if (i == ACMP_BURST) {
+            continue;
+        }
+        answered[i] = true;
+        nAnswered++;
+        recordLatency(t, nowNs() - start);
+        t->responses++;
+
+        uint8_t status = rsp[2] >> 3;
+        t->statusCounts[status]++;
+        bool ok = (get16(rsp + 2) & 0x07FF) == ACMP_CONTROL_DATA_LENGTH &&
+                  memcmp(rdata, myEntityId, 8) == 0 &&
+                  memcmp(rdata + 8, talkerId, 8) == 0 &&
+                  memcmp(rdata + 16, pEntity->entityId, 8) == 0 &&
+                  get16(rdata + 24) == i &&
+                  get16(rdata + 26) == uniqueIds[i];
+        if (!ok) {
+            t->nonconformant++;
+        }
+    }
+    t->lost += ACMP_BURST - nAnswered;
+}
+
+static int cmpU64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static double pctUsec(const probe_test_t *t, double pct)
+{
+    if (t->nLatency == 0) {
+        return 0.0;
+    }
+    uint32_t idx = (uint32_t)(pct / 100.0 * (t->nLatency - 1) + 0.5);
+    return t->latencyNs[idx] / 1000.0;
+}
+
+static void printTest(probe_test_t *t, bool last)
+{
+    qsort(t->latencyNs, t->nLatency, sizeof(uint64_t), cmpU64);
+    double sum = 0;
+    uint32_t i;
+    for (i = 0; i < t->nLatency; i++) {
+        sum += t->latencyNs[i];
+    }
+    double mean = t->nLatency ? sum / t->nLatency / 1000.0 : 0.0;
+
+    printf("    \"%s\": {\"sent\": %u, \"responses\": %u, \"lost\": %u, \"nonconformant\": %u, ",
+           t->name, t->sent, t->responses, t->lost, t->nonconformant);
+    printf("\"latency_usec\": {\"min\": %.1f, \"mean\": %.1f, \"p50\": %.1f, \"p90\": %.1f, \"p99\": %.1f, \"max\": %.1f}, ",
+           pctUsec(t, 0), mean, pctUsec(t, 50), pctUsec(t, 90), pctUsec(t, 99), pctUsec(t, 100));
+    printf("\"status\": {");
+    bool first = true;
+    for (i = 0; i <= ACMP_STATUS_MAX; i++) {
+        if (t->statusCounts[i]) {
+            printf("%s\"%u\": %u", first ? "" : ", ", i, t->statusCounts[i]);
+            first = false;
+        }
+    }
+    printf("}}%s\n", last ? "" : ",");
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "Usage: %s -i IFNAME [options]\n"
+            "  -i IFNAME   Controller end of the veth pair\n"
+            "  -n COUNT    Commands per test (default 1000)\n"
+            "  -t MSEC     Response timeout per command (default 200)\n"
+            "  -g USEC     Gap between commands (default 1000)\n"
+            "  -l LABEL    Label for the JSON/CSV output\n"
+            "  -c FILE     Append a CSV row to FILE\n",
+            prog);
+}
+
+int main(int argc, char **argv)
+{
+    const char *ifname = NULL;
+    const char *label = "avdecc";
+    const char *csvFile = NULL;
+    uint32_t iterations = 1000;
+    uint32_t gapUsec = 1000;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "i:n:t:g:l:c:h")) != -1) {
+        switch (opt) {
+            case 'i': ifname = optarg; break;
+            case 'n': iterations = (uint32_t)strtoul(optarg, NULL, 10); break;
+            case 't': timeoutMsec = atoi(optarg); break;
+            case 'g': gapUsec = (uint32_t)strtoul(optarg, NULL, 10); break;
+            case 'l': label = optarg; break;
+            case 'c': csvFile = optarg; break;
+            default: usage(argv[0]); return 1;
+        }
+    }
+    if (!ifname || iterations == 0 || iterations > PROBE_MAX_ITERATIONS) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (openSocket(ifname) < 0) {
+        return 1;
+    }
+
+    static uint8_t rx[2048];
+    probe_entity_t entity;
+    memset(&entity, 0, sizeof(entity));
+    if (!discoverEntity(&entity, rx, sizeof(rx))) {
+        fprintf(stderr, "No AVDECC entity answered ENTITY_DISCOVER on %s\n", ifname);
+        printf("{\"label\": \"%s\", \"entity_found\": false}\n", label);
+        return 2;
+    }
+
+    probe_test_t tests[5] = {
+        { .name = "adp_discover" },
+        { .name = "aecp_read_descriptor" },
+        { .name = "aecp_entity_available" },
+        { .name = "acmp_get_rx_state" },
+        { .name = "acmp_connect_burst" },
+    };
+    int nTests = entity.listenerSinks ? 5 : 3;
+    int i;
+    for (i = 0; i < nTests; i++) {
+        tests[i].latencyNs = calloc(i == 4 ? iterations * ACMP_BURST : iterations, sizeof(uint64_t));
+        if (!tests[i].latencyNs) {
+            fprintf(stderr, "Out of memory\n");
+            return 1;
+        }
+    }
+
+    struct timespec gap = { gapUsec / 1000000, (gapUsec % 1000000) * 1000 };
+    uint32_t n;
+    for (n = 0; n < iterations; n++) {
+        runAdp(&tests[0], &entity, rx, sizeof(rx));
+        nanosleep(&gap, NULL);
+        runAecp(&tests[1], &entity, AEM_CMD_READ_DESCRIPTOR, rx, sizeof(rx));
+        nanosleep(&gap, NULL);
+        runAecp(&tests[2], &entity, AEM_CMD_ENTITY_AVAILABLE, rx, sizeof(rx));
+        nanosleep(&gap, NULL);
+        if (nTests > 3) {
+            runAcmp(&tests[3], &entity, rx, sizeof(rx));
+            nanosleep(&gap, NULL);
+            runAcmpConnectBurst(&tests[4], &entity, rx, sizeof(rx));
+            nanosleep(&gap, NULL);
+        }
+    }
+
+    bool pass = true;
+    for (i = 0; i < nTests; i++) {
+        pass = pass && tests[i].lost == 0 && tests[i].nonconformant == 0;
+    }
+
+    printf("{\"label\": \"%s\", \"entity_found\": true, ", label);
+    printf("\"entity_id\": \"%02x%02x%02x%02x%02x%02x%02x%02x\", ",
+           entity.entityId[0], entity.entityId[1], entity.entityId[2], entity.entityId[3],
+           entity.entityId[4], entity.entityId[5], entity.entityId[6], entity.entityId[7]);
+    printf("\"iterations\": %u, \"timeout_msec\": %d, \"conformant\": %s, \"tests\": {\n",
+           iterations, timeoutMsec, pass ? "true" : "false");
+    for (i = 0; i < nTests; i++) {
+        printTest(&tests[i], i == nTests - 1);
+    }
+    printf("}}\n");
+
+    if (csvFile) {
+        FILE *csv = fopen(csvFile, "a");
+        if (csv) {
+            if (ftell(csv) == 0) {
+                fprintf(csv, "label,test,sent,responses,lost,nonconformant,p50_usec,p99_usec,max_usec\n");
+            }
+            for (i = 0; i < nTests; i++) {
+                fprintf(csv, "%s,%s,%u,%u,%u,%u,%.1f,%.1f,%.1f\n", label, tests[i].name,
+                        tests[i].sent, tests[i].responses, tests[i].lost, tests[i].nonconformant,
+                        pctUsec(&tests[i], 50), pctUsec(&tests[i], 99), pctUsec(&tests[i], 100));
+            }
+            fclose(csv);
+        }
+    }
+
+    for (i = 0; i < nTests; i++) {
+        free(tests[i].latencyNs);
+    }
+    close(sock);
+    return pass ? 0 : 3;
+}
@@ -0,0 +1,548 @@
+/**
+ * AVTP Pipeline Veth Probe
+ *
+ * Passive receive-side probe used by run_veth_benchmark.sh. It listens on the
+ * listener end of a veth pair for AVTP stream PDUs (ethertype 0x22F0, with or
+ * without an 802.1Q tag) and measures, per stream and in aggregate:
+ *  - packets and packets/s
+ *  - sequence number gaps (loss)
+ *  - talker capture to listener arrival latency
+ *
+ * Latency is derived from the AVTP presentation timestamp. The talker stamps
+ * each PDU with (capture walltime + max_transit_usec), so arrival walltime
+ * minus (avtp_timestamp - max_transit) is the time spent in the talker
+ * interface, mapping, rawsock and the link. The walltime is read through the
+ * same gPTP shared memory the pipeline uses, so a gPTP daemon must be running.
+ *
+ * Frames are read in batches with recvmmsg() and each one carries its kernel
+ * receive timestamp, so neither the probe's wake-ups nor its batching show up
+ * in the latency. Frames the socket dropped because the probe fell behind are
+ * counted from PACKET_STATISTICS and reported as probe_drops; loss is only
+ * the streams' own when probe_drops is 0.
+ *
+ * Results are written as a single JSON object on stdout (and optionally one
+ * CSV row) so runs can be tracked for regressions.
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <string.h>
+#include <signal.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <poll.h>
+#include <net/if.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/ioctl.h>
+#include <linux/if_packet.h>
+#include <linux/if_ether.h>
+
+#include "avb_gptp.h"
+
+#define PROBE_ETHERTYPE_AVTP      0x22F0
+#define PROBE_ETHERTYPE_VLAN      0x8100
+#define PROBE_MAX_STREAMS         1024
+#define PROBE_HIST_BUCKET_NS      1000ULL     // 1 usec resolution
+#define PROBE_HIST_BUCKETS        100000      // up to 100 msec
+#define PROBE_AVTP_TV_MASK        0x01
+#define PROBE_BATCH               64
+#define PROBE_FRAME_SIZE          2048
+#define PROBE_RCVBUF_BYTES        (32 * 1024 * 1024)
+
+typedef struct {
+    uint64_t stream_id;
+    uint64_t packets;
+    uint64_t lost;
+    uint64_t late;          // arrival after presentation time
+    uint8_t  last_seq;
+    bool     seq_valid;
+    uint64_t lat_sum_ns;
+    uint64_t lat_min_ns;
+    uint64_t lat_max_ns;
+    uint64_t lat_samples;
+} probe_stream_t;
+
+typedef struct {
+    const char *ifname;
+    unsigned duration_sec;
+    unsigned warmup_sec;
+    uint32_t max_transit_usec;
+    unsigned expected_streams;
+    const char *csv_path;
+    const char *label;
+} probe_cfg_t;
+
+static volatile sig_atomic_t g_running = 1;
+
+static probe_stream_t g_streams[PROBE_MAX_STREAMS];
+static unsigned g_stream_count;
+static uint32_t *g_hist;
+static uint64_t g_hist_overflow;
+static uint64_t g_non_avtp;
+static uint64_t g_unknown_streams;
+static uint64_t g_probe_drops;
+
+static int g_ptp_fd = -1;
+static char *g_ptp_map;
+static gPtpTimeData g_ptp_td;
+
+static void probe_sig_handler(int sig)
+{
+    (void)sig;
+    g_running = 0;
+}
+
+static void probe_usage(const char *prog)
+{
+    fprintf(stderr,
+        "Usage: %s -i ifname [options]\n"
+        "  -i ifname   Listener side interface to capture on (required)\n"
+        "  -d sec      Measurement duration in seconds (default 10)\n"
+        "  -w sec      Warm-up seconds discarded before measuring (default 2)\n"
+        "  -t usec     max_transit_usec configured on the talker (default 2000)\n"
+        "  -n count    Expected stream count, reported for missing stream detection\n"
+        "  -c file     Append one CSV summary row to file\n"
+        "  -l label    Free form run label stored in the output\n",
+        prog);
+}
+
+static uint64_t probe_clock_ns(clockid_t clock)
+{
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t probe_mono_ns(void)
+{
+    return probe_clock_ns(CLOCK_MONOTONIC);
+}
+
+// Frames the socket dropped since the last call (the counters reset on read)
+static uint64_t probe_socket_drops(int sock)
+{
+    struct tpacket_stats stats;
+    socklen_t len = sizeof(stats);
+
+    if (getsockopt(sock, SOL_PACKET, PACKET_STATISTICS, &stats, &len) < 0) {
+        return 0;
+    }
+    return stats.tp_drops;
+}
+
+// Same conversion as x_getPTPTime() in the Linux time OSAL.
+static bool probe_walltime_ns(uint64_t *now)
+{
+    uint64_t now_local;
+
+    if (gptpgetdata(g_ptp_map, &g_ptp_td) < 0) {
+        return false;
+    }
+    if (!gptplocaltime(&g_ptp_td, &now_local)) {
+        return false;
+    }
+    int64_t delta_local = now_local - g_ptp_td.local_time;
+    *now = (g_ptp_td.local_time - g_ptp_td.ml_phoffset) +
+           (int64_t)(g_ptp_td.ml_freqoffset * delta_local);
+    return true;
+}
+
+static probe_stream_t *probe_find_stream(uint64_t stream_id)
+{
+    unsigned i;
+    for (i = 0; i < g_stream_count; i++) {
+        if (g_streams[i].stream_id == stream_id) {
+            return &g_streams[i];
+        }
+    }
+    if (g_stream_count >= PROBE_MAX_STREAMS) {
+        g_unknown_streams++;
+        return NULL;
+    }
+    probe_stream_t *s = &g_streams[g_stream_count++];
+    memset(s, 0, sizeof(*s));
+    s->stream_id = stream_id;
+    s->lat_min_ns = UINT64_MAX;
+    return s;
+}
+
+static void probe_account(const uint8_t *avtp, size_t len, uint64_t arrival_ns,
+                          bool have_walltime, uint32_t max_transit_ns)
+{
+    if (len < 16 || (avtp[0] & 0x80)) {
+        // Too short or a control (cd=1) PDU
+        g_non_avtp++;
+        return;
+    }
+
+    uint64_t stream_id = 0;
+    int i;
+    for (i = 0; i < 8; i++) {
+        stream_id = (stream_id << 8) | avtp[4 + i];
+    }
+
+    probe_stream_t *s = probe_find_stream(stream_id);
+    if (!s) {
+        return;
+    }
+
+    uint8_t seq = avtp[2];
+    if (s->seq_valid) {
+        uint8_t expected = (uint8_t)(s->last_seq + 1);
+        if (seq != expected) {
+            s->lost += (uint8_t)(seq - expected);
+        }
+    }
+    s->last_seq = seq;
+    s->seq_valid = true;
+    s->packets++;
+
+    if (!have_walltime || !(avtp[1] & PROBE_AVTP_TV_MASK)) {
+        return;
+    }
+
+    uint32_t avtp_ts = ((uint32_t)avtp[12] << 24) | ((uint32_t)avtp[13] << 16) |
+                       ((uint32_t)avtp[14] << 8) | (uint32_t)avtp[15];
+    uint32_t capture_ts = avtp_ts - max_transit_ns;
+    // 32-bit wrap-around arithmetic, valid for latencies below ~2 seconds
+    int32_t latency = (int32_t)((uint32_t)arrival_ns - capture_ts);
+    if (latency < 0) {
+        return;
+    }
+    if ((uint32_t)arrival_ns - avtp_ts < 0x80000000u && (uint32_t)arrival_ns != avtp_ts) {
+        s->late++;
+    }
+
+    uint64_t lat = (uint64_t)latency;
+    s->lat_sum_ns += lat;
+    s->lat_samples++;
+    if (lat < s->lat_min_ns) s->lat_min_ns = lat;
+    if (lat > s->lat_max_ns) s->lat_max_ns = lat;
+
+    uint64_t bucket = lat / PROBE_HIST_BUCKET_NS;
+    if (bucket < PROBE_HIST_BUCKETS) {
+        g_hist[bucket]++;
+    }
+    else {
+        g_hist_overflow++;
+    }
+}
+
+static double probe_percentile_us(uint64_t total, double pct)
+{
+    if (total == 0) {
+        return 0.0;
+    }
+    uint64_t target = (uint64_t)((double)total * pct / 100.0);
+    uint64_t acc = 0;
+    unsigned i;
+    for (i = 0; i < PROBE_HIST_BUCKETS; i++) {
+        acc += g_hist[i];
+        if (acc > target) {
+            return (double)i * (double)PROBE_HIST_BUCKET_NS / 1000.0;
+        }
+    }
+    return (double)PROBE_HIST_BUCKETS * (double)PROBE_HIST_BUCKET_NS / 1000.0;
+}
+
+static int probe_open_socket(const char *ifname)
+{
+    int sock = socket(PF_PACKET, SOCK_RAW, htons(ETH_P_ALL));
+    if (sock < 0) {
+        fprintf(stderr, "socket(PF_PACKET) failed: %s\n", strerror(errno));
+        return -1;
+    }
+
+    struct sockaddr_ll sll;
+    memset(&sll, 0, sizeof(sll));
+    sll.sll_family = AF_PACKET;
+    sll.sll_protocol = htons(ETH_P_ALL);
+    sll.sll_ifindex = if_nametoindex(ifname);
+    if (sll.sll_ifindex == 0) {
+        fprintf(stderr, "Unknown interface %s\n", ifname);
+        close(sock);
+        return -1;
+    }
+    if (bind(sock, (struct sockaddr *)&sll, sizeof(sll)) < 0) {
+        fprintf(stderr, "bind(%s) failed: %s\n", ifname, strerror(errno));
+        close(sock);
+        return -1;
+    }
+
+    // AVTP streams use multicast destinations; see them all.
+    struct packet_mreq mreq;
+    memset(&mreq, 0, sizeof(mreq));
+    mreq.mr_ifindex = sll.sll_ifindex;
+    mreq.mr_type = PACKET_MR_PROMISC;
+    if (setsockopt(sock, SOL_PACKET, PACKET_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0) {
+        fprintf(stderr, "PACKET_MR_PROMISC failed: %s\n", strerror(errno));
+    }
+
+    // SO_RCVBUFFORCE goes past rmem_max as root
+    int rcvbuf = PROBE_RCVBUF_BYTES;
+    if (setsockopt(sock, SOL_SOCKET, SO_RCVBUFFORCE, &rcvbuf, sizeof(rcvbuf)) < 0) {
+        setsockopt(sock, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    }
+
+    int on = 1;
+    if (setsockopt(sock, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on)) < 0) {
+        fprintf(stderr, "SO_TIMESTAMPNS failed: %s\n", strerror(errno));
+    }
+
+    return sock;
+}
+
+static void probe_report(const probe_cfg_t *cfg, double elapsed_sec)
+{
+    uint64_t packets = 0, lost = 0, late = 0, samples = 0, lat_sum = 0;
+    uint64_t lat_min = UINT64_MAX, lat_max = 0;
+    unsigned i;
+
+    for (i = 0; i < g_stream_count; i++) {
+        packets += g_streams[i].packets;
+        lost += g_streams[i].lost;
+        late += g_streams[i].late;
+        samples += g_streams[i].lat_samples;
+        lat_sum += g_streams[i].lat_sum_ns;
+        if (g_streams[i].lat_min_ns < lat_min) lat_min = g_streams[i].lat_min_ns;
+        if (g_streams[i].lat_max_ns > lat_max) lat_max = g_streams[i].lat_max_ns;
+    }
+    if (samples == 0) {
+        lat_min = 0;
+    }
+
+    double pps = elapsed_sec > 0 ? (double)packets / elapsed_sec : 0.0;
+    double loss_pct = (packets + lost) ? 100.0 * (double)lost / (double)(packets + lost) : 0.0;
+    uint64_t hist_total = samples - g_hist_overflow;
+    double p50 = probe_percentile_us(hist_total, 50.0);
+    double p90 = probe_percentile_us(hist_total, 90.0);
+    double p99 = probe_percentile_us(hist_total, 99.0);
+    double p999 = probe_percentile_us(hist_total, 99.9);
+    double mean = samples ? (double)lat_sum / (double)samples / 1000.0 : 0.0;
+
+    printf("{\n");
+    printf("  \"label\": \"%s\",\n", cfg->label ? cfg->label : "");
+    printf("  \"interface\": \"%s\",\n", cfg->ifname);
+    printf("  \"duration_sec\": %.3f,\n", elapsed_sec);
+    printf("  \"expected_streams\": %u,\n", cfg->expected_streams);
+    printf("  \"observed_streams\": %u,\n", g_stream_count);
+    printf("  \"packets\": %" PRIu64 ",\n", packets);
+    printf("  \"packets_per_sec\": %.1f,\n", pps);
+    printf("  \"lost\": %" PRIu64 ",\n", lost);
+    printf("  \"loss_pct\": %.6f,\n", loss_pct);
+    printf("  \"late\": %" PRIu64 ",\n", late);
+    printf("  \"probe_drops\": %" PRIu64 ",\n", g_probe_drops);
+    printf("  \"latency_us\": {\"samples\": %" PRIu64 ", \"min\": %.1f, \"mean\": %.1f, \"p50\": %.1f, "
+           "\"p90\": %.1f, \"p99\": %.1f, \"p99_9\": %.1f, \"max\": %.1f, \"overflow\": %" PRIu64 "},\n",
+           samples, (double)lat_min / 1000.0, mean, p50, p90, p99, p999, (double)lat_max / 1000.0,
+           g_hist_overflow);
+    printf("  \"streams\": [\n");
+    for (i = 0; i < g_stream_count; i++) {
+        const probe_stream_t *s = &g_streams[i];
+        printf("    {\"stream_id\": \"%016" PRIx64 "\", \"packets\": %" PRIu64 ", \"lost\": %" PRIu64
+               ", \"late\": %" PRIu64 ", \"latency_mean_us\": %.1f, \"latency_max_us\": %.1f}%s\n",
+               s->stream_id, s->packets, s->lost, s->late,
+               s->lat_samples ? (double)s->lat_sum_ns / (double)s->lat_samples / 1000.0 : 0.0,
+               (double)s->lat_max_ns / 1000.0,
+               (i + 1 < g_stream_count) ? "," : "");
+    }
+    printf("  ]\n");
+    printf("}\n");
+    fflush(stdout);
+
+    if (cfg->csv_path) {
+        FILE *csv = fopen(cfg->csv_path, "a");
+        if (!csv) {
+            fprintf(stderr, "Unable to open %s: %s\n", cfg->csv_path, strerror(errno));
+            return;
+        }
+        fseek(csv, 0, SEEK_END);
+        if (ftell(csv) == 0) {
+            fprintf(csv, "label,expected_streams,observed_streams,duration_sec,packets,packets_per_sec,"
+                         "lost,loss_pct,late,lat_min_us,lat_mean_us,lat_p50_us,lat_p90_us,lat_p99_us,"
+                         "lat_p99_9_us,lat_max_us,probe_drops\n");
+        }
+        fprintf(csv, "%s,%u,%u,%.3f,%" PRIu64 ",%.1f,%" PRIu64 ",%.6f,%" PRIu64 ",%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%" PRIu64 "\n",
+                cfg->label ? cfg->label : "", cfg->expected_streams, g_stream_count, elapsed_sec,
+                packets, pps, lost, loss_pct, late, (double)lat_min / 1000.0, mean, p50, p90, p99, p999,
+                (double)lat_max / 1000.0, g_probe_drops);
+        fclose(csv);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    probe_cfg_t cfg = {
+        .ifname = NULL,
+        .duration_sec = 10,
+        .warmup_sec = 2,
+        .max_transit_usec = 2000,
+        .expected_streams = 0,
+        .csv_path = NULL,
+        .label = NULL,
+    };
+    int opt;
+
+    while ((opt = getopt(argc, argv, "i:d:w:t:n:c:l:h")) != -1) {
+        switch (opt) {
+            case 'i': cfg.ifname = optarg; break;
+            case 'd': cfg.duration_sec = (unsigned)strtoul(optarg, NULL, 0); break;
+            case 'w': cfg.warmup_sec = (unsigned)strtoul(optarg, NULL, 0); break;
+            case 't': cfg.max_transit_usec = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'n': cfg.expected_streams = (unsigned)strtoul(optarg, NULL, 0); break;
+            case 'c': cfg.csv_path = optarg; break;
+            case 'l': cfg.label = optarg; break;
+            case 'h':
+            default:
+                probe_usage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (!cfg.ifname) {
+        probe_usage(argv[0]);
+        return 1;
+    }
+
+    g_hist = calloc(PROBE_HIST_BUCKETS, sizeof(*g_hist));
+    if (!g_hist) {
+        fprintf(stderr, "Unable to allocate latency histogram\n");
+        return 1;
+    }
+
+    bool have_walltime = (gptpinit(&g_ptp_fd, &g_ptp_map) >= 0);
+    if (!have_walltime) {
+        fprintf(stderr, "gPTP shared memory not available, latency will not be measured\n");
+    }
+
+    int sock = probe_open_socket(cfg.ifname);
+    if (sock < 0) {
+        return 1;
+    }
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = probe_sig_handler;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    static uint8_t frames[PROBE_BATCH][PROBE_FRAME_SIZE];
+    static uint8_t cmsgs[PROBE_BATCH][CMSG_SPACE(sizeof(struct timespec))];
+    struct sockaddr_ll addrs[PROBE_BATCH];
+    struct iovec iov[PROBE_BATCH];
+    struct mmsghdr msgs[PROBE_BATCH];
+    unsigned i;
+    for (i = 0; i < PROBE_BATCH; i++) {
+        iov[i].iov_base = frames[i];
+        iov[i].iov_len = PROBE_FRAME_SIZE;
+    }
+
+    probe_socket_drops(sock);
+    uint64_t start_ns = probe_mono_ns();
+    uint64_t measure_ns = start_ns + (uint64_t)cfg.warmup_sec * 1000000000ULL;
+    uint64_t end_ns = measure_ns + (uint64_t)cfg.duration_sec * 1000000000ULL;
+    bool measuring = (cfg.warmup_sec == 0);
+    uint32_t max_transit_ns = cfg.max_transit_usec * 1000u;
+
+    while (g_running) {
+        uint64_t now = probe_mono_ns();
+        if (!measuring && now >= measure_ns) {
+            // Drop warm-up data so start-up transients are not reported
+            memset(g_streams, 0, sizeof(g_streams));
+            g_stream_count = 0;
+            memset(g_hist, 0, PROBE_HIST_BUCKETS * sizeof(*g_hist));
+            g_hist_overflow = 0;
+            g_non_avtp = 0;
+            probe_socket_drops(sock);
+            g_probe_drops = 0;
+            measuring = true;
+        }
+        if (now >= end_ns) {
+            break;
+        }
+
+        struct pollfd pfd = { .fd = sock, .events = POLLIN, .revents = 0 };
+        int rc = poll(&pfd, 1, 100);
+        if (rc <= 0) {
+            continue;
+        }
+
+        memset(msgs, 0, sizeof(msgs));
+        for (i = 0; i < PROBE_BATCH; i++) {
+            msgs[i].msg_hdr.msg_name = &addrs[i];
+            msgs[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+            msgs[i].msg_hdr.msg_iov = &iov[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+            msgs[i].msg_hdr.msg_control = cmsgs[i];
+            msgs[i].msg_hdr.msg_controllen = sizeof(cmsgs[i]);
+        }
+        int count = recvmmsg(sock, msgs, PROBE_BATCH, MSG_DONTWAIT, NULL);
+        if (count <= 0) {
+            continue;
+        }
+
+        // One walltime read per batch; each frame is placed by how long ago
+        // the kernel timestamped it
+        uint64_t wall_now = 0;
+        bool walltime_ok = have_walltime && probe_walltime_ns(&wall_now);
+        uint64_t real_now = probe_clock_ns(CLOCK_REALTIME);
+
+        int m;
+        for (m = 0; m < count; m++) {
+            const uint8_t *frame = frames[m];
+            size_t len = msgs[m].msg_len;
+            if (len < ETH_HLEN || addrs[m].sll_pkttype == PACKET_OUTGOING) {
+                continue;
+            }
+
+            uint64_t arrival = wall_now;
+            struct cmsghdr *cmsg;
+            for (cmsg = CMSG_FIRSTHDR(&msgs[m].msg_hdr); cmsg; cmsg = CMSG_NXTHDR(&msgs[m].msg_hdr, cmsg)) {
+                if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+                    struct timespec ts;
+                    memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+                    uint64_t rx_ns = (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+                    if (rx_ns <= real_now) {
+                        arrival = wall_now - (real_now - rx_ns);
+                    }
+                }
+            }
+
+            size_t off = 12;
+            uint16_t ethertype = ((uint16_t)frame[off] << 8) | frame[off + 1];
+            if (ethertype == PROBE_ETHERTYPE_VLAN) {
+                off += 4;
+                ethertype = ((uint16_t)frame[off] << 8) | frame[off + 1];
+            }
+            off += 2;
+            if (ethertype != PROBE_ETHERTYPE_AVTP || len < off) {
+                continue;
+            }
+            probe_account(frame + off, len - off, arrival, walltime_ok, max_transit_ns);
+        }
+    }
+
+    g_probe_drops += probe_socket_drops(sock);
+    if (g_probe_drops) {
+        fprintf(stderr, "Probe socket dropped %" PRIu64 " frames; lost does not describe the streams\n", g_probe_drops);
+    }
+
+    uint64_t stop_ns = probe_mono_ns();
+    uint64_t from_ns = measuring ? measure_ns : start_ns;
+    double elapsed = (double)(stop_ns > from_ns ? stop_ns - from_ns : 0) / 1e9;
+    probe_report(&cfg, elapsed);
+
+    close(sock);
+    if (have_walltime) {
+        gptpdeinit(&g_ptp_fd, &g_ptp_map);
+    }
+    free(g_hist);
+    return 0;
+}
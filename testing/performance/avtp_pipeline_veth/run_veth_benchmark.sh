@@ -0,0 +1,254 @@
+#!/bin/bash
+#
+# AVTP pipeline streaming benchmark over a veth pair.
+#
+# For every requested stream count this starts one openavb_harness talker
+# process (tonegen -> map_aaf_audio -> rawsock) on one end of a veth pair and
+# one openavb_harness listener process (rawsock -> map_aaf_audio -> intf_null)
+# on the other end, then samples:
+#   - packets/s, loss and capture-to-arrival latency percentiles from
+#     avtp_pipeline_probe on the listener side of the link
+#   - CPU time of the talker and listener processes from /proc/<pid>/stat
+#   - optionally (--perf) TLB and cache miss counters of both processes from
+#     perf stat, to compare memory layouts such as --hugepages
+#
+# One JSON object per stream count is appended to results.jsonl and one row to
+# results.csv in the output directory, for regression tracking.
+#
+# Requirements: root (veth creation, raw sockets), a no-endpoint build of the
+# avtp_pipeline (openavb_harness) and a gPTP daemon publishing /dev/shm/ptp so
+# the talker can timestamp and the probe can measure latency.
+
+set -u
+
+HARNESS=""
+PROBE=""
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+TALKER_INI="${SCRIPT_DIR}/veth_talker.ini"
+LISTENER_INI="${SCRIPT_DIR}/veth_listener.ini"
+STREAM_COUNTS="1 2 4 8 16 32 64 128 256"
+DURATION=10
+WARMUP=3
+MAX_TRANSIT_USEC=2000
+RAWSOCK_PROTO=""
+OUT_DIR="./avtp_pipeline_veth_results"
+VETH_TALKER="avbbench0"
+VETH_LISTENER="avbbench1"
+KEEP_VETH=0
+REQUIRE_GPTP=1
+USE_PERF=0
+ARENA_MODE="default"
+PERF_EVENTS="dTLB-loads,dTLB-load-misses,iTLB-load-misses,cache-references,cache-misses"
+
+usage() {
+    cat <<EOF
+Usage: $0 --harness PATH --probe PATH [options]
+  --harness PATH        openavb_harness binary from the avtp_pipeline build
+  --probe PATH          avtp_pipeline_probe binary
+  --streams "LIST"      Stream counts to run (default "${STREAM_COUNTS}", max 256)
+  --duration SEC        Measurement seconds per run (default ${DURATION})
+  --warmup SEC          Warm-up seconds discarded per run (default ${WARMUP})
+  --rawsock PROTO       Rawsock backend prefix, e.g. ring, simple, sendmmsg
+  --out DIR             Output directory (default ${OUT_DIR})
+  --talker-ini FILE     Talker ini (default veth_talker.ini)
+  --listener-ini FILE   Listener ini (default veth_listener.ini)
+  --keep-veth           Leave the veth pair in place on exit
+  --no-gptp-check       Run even if /dev/shm/ptp is missing
+  --perf                Record TLB and cache misses with perf stat
+  --hugepages           Back the streaming buffer arena with huge pages
+  --no-arena            Allocate streaming buffers from the heap instead
+EOF
+}
+
+while [ $# -gt 0 ]; do
+    case "$1" in
+        --harness) HARNESS="$2"; shift 2 ;;
+        --probe) PROBE="$2"; shift 2 ;;
+        --streams) STREAM_COUNTS="$2"; shift 2 ;;
+        --duration) DURATION="$2"; shift 2 ;;
+        --warmup) WARMUP="$2"; shift 2 ;;
+        --rawsock) RAWSOCK_PROTO="$2"; shift 2 ;;
+        --out) OUT_DIR="$2"; shift 2 ;;
+        --talker-ini) TALKER_INI="$2"; shift 2 ;;
+        --listener-ini) LISTENER_INI="$2"; shift 2 ;;
+        --keep-veth) KEEP_VETH=1; shift ;;
+        --no-gptp-check) REQUIRE_GPTP=0; shift ;;
+        --perf) USE_PERF=1; shift ;;
+        --hugepages) ARENA_MODE="hugepages"; shift ;;
+        --no-arena) ARENA_MODE="heap"; shift ;;
+        -h|--help) usage; exit 0 ;;
+        *) echo "Unknown option: $1"; usage; exit 1 ;;
+    esac
+done
+
+if [ -z "${HARNESS}" ] || [ -z "${PROBE}" ]; then
+    usage
+    exit 1
+fi
+if [ "$(id -u)" -ne 0 ]; then
+    echo "This benchmark needs root to create veth interfaces and open raw sockets"
+    exit 1
+fi
+if [ ${REQUIRE_GPTP} -eq 1 ] && [ ! -e /dev/shm/ptp ]; then
+    echo "gPTP shared memory /dev/shm/ptp not found; start daemon_cl first or pass --no-gptp-check"
+    exit 1
+fi
+
+if [ ${USE_PERF} -eq 1 ] && ! command -v perf > /dev/null; then
+    echo "--perf needs the perf tool in PATH"
+    exit 1
+fi
+
+# The harness reads these when it sets up its buffer arena
+case "${ARENA_MODE}" in
+    hugepages) export OPENAVB_ARENA_HUGEPAGES=1 ;;
+    heap) export OPENAVB_ARENA=0 ;;
+esac
+
+mkdir -p "${OUT_DIR}"
+RESULTS_JSON="${OUT_DIR}/results.jsonl"
+RESULTS_CSV="${OUT_DIR}/results.csv"
+CLK_TCK=$(getconf CLK_TCK)
+NCPU=$(nproc)
+
+TALKER_PID=""
+LISTENER_PID=""
+
+cleanup() {
+    [ -n "${TALKER_PID}" ] && kill -INT "${TALKER_PID}" 2>/dev/null
+    [ -n "${LISTENER_PID}" ] && kill -INT "${LISTENER_PID}" 2>/dev/null
+    sleep 1
+    [ -n "${TALKER_PID}" ] && kill -KILL "${TALKER_PID}" 2>/dev/null
+    [ -n "${LISTENER_PID}" ] && kill -KILL "${LISTENER_PID}" 2>/dev/null
+    TALKER_PID=""
+    LISTENER_PID=""
+}
+
+teardown() {
+    cleanup
+    if [ ${KEEP_VETH} -eq 0 ]; then
+        ip link del "${VETH_TALKER}" 2>/dev/null
+    fi
+}
+trap teardown EXIT INT TERM
+
+# perf stat CSV of one process turned into a JSON object; unsupported
+# counters become null
+perf_json() {
+    if [ ! -s "$1" ]; then
+        echo "null"
+        return
+    fi
+    awk -F, 'BEGIN { printf "{"; n = 0 }
+        /^#/ || NF < 3 { next }
+        {
+            value = ($1 ~ /^[0-9.]+$/) ? $1 : "null";
+            printf "%s\"%s\": %s", (n++ ? ", " : ""), $3, value;
+        }
+        END { printf "}" }' "$1"
+}
+
+# Total utime+stime ticks of a process, 0 if it is gone
+proc_ticks() {
+    if [ -r "/proc/$1/stat" ]; then
+        # Strip "pid (comm)" first since comm may contain spaces
+        sed 's/^.*) //' "/proc/$1/stat" | awk '{ print $12 + $13 }'
+    else
+        echo 0
+    fi
+}
+
+setup_veth() {
+    ip link del "${VETH_TALKER}" 2>/dev/null
+    ip link add "${VETH_TALKER}" type veth peer name "${VETH_LISTENER}" || exit 1
+    for dev in "${VETH_TALKER}" "${VETH_LISTENER}"; do
+        # No IP stack traffic on the benchmark link
+        sysctl -qw "net.ipv6.conf.${dev}.disable_ipv6=1" 2>/dev/null
+        ip link set "${dev}" txqueuelen 10000
+        ip link set "${dev}" up || exit 1
+    done
+}
+
+setup_veth
+TALKER_MAC=$(cat "/sys/class/net/${VETH_TALKER}/address")
+
+IF_TALKER="${VETH_TALKER}"
+IF_LISTENER="${VETH_LISTENER}"
+if [ -n "${RAWSOCK_PROTO}" ]; then
+    IF_TALKER="${RAWSOCK_PROTO}:${VETH_TALKER}"
+    IF_LISTENER="${RAWSOCK_PROTO}:${VETH_LISTENER}"
+fi
+
+echo "AVTP pipeline veth benchmark: streams=[${STREAM_COUNTS}] duration=${DURATION}s warmup=${WARMUP}s"
+echo "Results: ${RESULTS_JSON} ${RESULTS_CSV}"
+
+for N in ${STREAM_COUNTS}; do
+    if [ "${N}" -lt 1 ] || [ "${N}" -gt 256 ]; then
+        echo "Skipping stream count ${N}: static destination pool holds 256 addresses"
+        continue
+    fi
+
+    LABEL="streams_${N}${RAWSOCK_PROTO:+_${RAWSOCK_PROTO}}"
+    [ "${ARENA_MODE}" != "default" ] && LABEL="${LABEL}_${ARENA_MODE}"
+    LOG_PREFIX="${OUT_DIR}/${LABEL}"
+
+    "${HARNESS}" -I "${IF_LISTENER}" -s "${N}" -d 0 -a "${TALKER_MAC}" \
+        -l "${LOG_PREFIX}_listener.log" "${LISTENER_INI}" \
+        > "${LOG_PREFIX}_listener.out" 2>&1 &
+    LISTENER_PID=$!
+    sleep 1
+
+    "${HARNESS}" -I "${IF_TALKER}" -s "${N}" -d 0 \
+        -l "${LOG_PREFIX}_talker.log" "${TALKER_INI}" \
+        > "${LOG_PREFIX}_talker.out" 2>&1 &
+    TALKER_PID=$!
+
+    "${PROBE}" -i "${VETH_LISTENER}" -d "${DURATION}" -w "${WARMUP}" \
+        -t "${MAX_TRANSIT_USEC}" -n "${N}" -l "${LABEL}" \
+        -c "${RESULTS_CSV}" > "${LOG_PREFIX}_probe.json" &
+    PROBE_PID=$!
+
+    # CPU is sampled over the same window the probe measures
+    sleep "${WARMUP}"
+    T0=$(proc_ticks "${TALKER_PID}")
+    L0=$(proc_ticks "${LISTENER_PID}")
+    PERF_PIDS=""
+    if [ ${USE_PERF} -eq 1 ]; then
+        rm -f "${LOG_PREFIX}_talker.perf" "${LOG_PREFIX}_listener.perf"
+        perf stat -x, -e "${PERF_EVENTS}" -p "${TALKER_PID}" -o "${LOG_PREFIX}_talker.perf" -- sleep "${DURATION}" 2>/dev/null &
+        PERF_PIDS="$!"
+        perf stat -x, -e "${PERF_EVENTS}" -p "${LISTENER_PID}" -o "${LOG_PREFIX}_listener.perf" -- sleep "${DURATION}" 2>/dev/null &
+        PERF_PIDS="${PERF_PIDS} $!"
+    fi
+    sleep "${DURATION}"
+    T1=$(proc_ticks "${TALKER_PID}")
+    L1=$(proc_ticks "${LISTENER_PID}")
+    [ -n "${PERF_PIDS}" ] && wait ${PERF_PIDS}
+
+    wait "${PROBE_PID}"
+    TALKER_ALIVE=1; kill -0 "${TALKER_PID}" 2>/dev/null || TALKER_ALIVE=0
+    LISTENER_ALIVE=1; kill -0 "${LISTENER_PID}" 2>/dev/null || LISTENER_ALIVE=0
+    cleanup
+
+    CPU_JSON=$(awk -v t0="${T0}" -v t1="${T1}" -v l0="${L0}" -v l1="${L1}" \
+        -v hz="${CLK_TCK}" -v dur="${DURATION}" -v n="${N}" -v ncpu="${NCPU}" 'BEGIN {
+            tc = (t1 - t0) * 100.0 / hz / dur;
+            lc = (l1 - l0) * 100.0 / hz / dur;
+            printf "{\"cpus\": %d, \"talker_pct\": %.2f, \"listener_pct\": %.2f, \"talker_pct_per_stream\": %.3f, \"listener_pct_per_stream\": %.3f}",
+                ncpu, tc, lc, tc / n, lc / n;
+        }')
+
+    PERF_JSON="null"
+    if [ ${USE_PERF} -eq 1 ]; then
+        PERF_JSON="{\"talker\": $(perf_json "${LOG_PREFIX}_talker.perf"), \"listener\": $(perf_json "${LOG_PREFIX}_listener.perf")}"
+    fi
+
+    {
+        printf '{"label": "%s", "streams": %d, "rawsock": "%s", "arena": "%s", "talker_alive": %d, "listener_alive": %d, "cpu": %s, "perf": %s, "probe": ' \
+            "${LABEL}" "${N}" "${RAWSOCK_PROTO:-default}" "${ARENA_MODE}" "${TALKER_ALIVE}" "${LISTENER_ALIVE}" "${CPU_JSON}" "${PERF_JSON}"
+        tr -d '\n' < "${LOG_PREFIX}_probe.json"
+        printf '}\n'
+    } >> "${RESULTS_JSON}"
+
+    echo "${LABEL}: $(grep -o '"packets_per_sec": [0-9.]*' "${LOG_PREFIX}_probe.json") $(grep -o '"loss_pct": [0-9.]*' "${LOG_PREFIX}_probe.json") $(grep -o '"probe_drops": [0-9]*' "${LOG_PREFIX}_probe.json") cpu=${CPU_JSON}"
+done
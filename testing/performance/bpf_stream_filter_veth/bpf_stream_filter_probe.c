@@ -0,0 +1,654 @@
+/**
+ * eBPF Stream Filter Probe
+ *
+ * Replays a pcap of interleaved AVTP streams on one end of a veth pair and
+ * receives it on the other end with one avtp_pipeline listener rawsock per
+ * stream (simple, sendmmsg or ring, linked as is).
+ *
+ *  - With -F every listener calls openavbRawsockRxStreamID() for its own
+ *    stream_id, so the kernel drops the other streams before they are copied
+ *    to the socket. The probe then checks that each listener got exactly the
+ *    frames of its stream in the pcap, and that the kernel counters of the
+ *    filter agree: passed equals the stream's own frames, and the drop
+ *    counter of every other stream_id equals that stream's frames in the pcap.
+ *  - Without -F the listeners only have the multicast address filter, so each
+ *    one also gets every stream that shares its destination address, and
+ *    drops them in user space.
+ *
+ * -w writes the pcap instead: -s streams over -a multicast addresses, one
+ * frame per stream per -p interval in a shuffled order, odd streams VLAN
+ * tagged, and an AVTP control frame without a stream_id every cycle.
+ *
+ * Results are written as a single JSON object on stdout (and optionally a CSV
+ * row). The exit status is 2 if a listener got fewer frames of its stream
+ * than the pcap has, or, with -F, any frame of another stream or a kernel
+ * counter that does not match the pcap.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <poll.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <sys/socket.h>
+#include <sys/resource.h>
+#include <linux/if_packet.h>
+#include <linux/if_ether.h>
+
+#include "openavb_types_pub.h"
+#include "openavb_rawsock.h"
+#include "openavb_arena.h"
+
+#define PROBE_ETHERTYPE         0x22F0
+#define PROBE_VLAN_ETHERTYPE    0x8100
+#define PROBE_MAX_STREAMS       256
+#define PROBE_MAX_FRAME         1518
+#define PROBE_RX_FRAME_SIZE     1024        // sendmmsg rawsock maximum
+#define PROBE_PAYLOAD_LEN       64
+#define AVTP_HDR_LEN            24
+#define DEFAULT_STREAMS         64
+#define DEFAULT_ADDRS           4
+#define DEFAULT_FRAMES          500
+#define DEFAULT_INTERVAL_USEC   1000
+#define DEFAULT_BACKEND         "simple"
+#define RX_IDLE_MSEC            300
+
+// Classic pcap file format, microsecond timestamps
+#define PCAP_MAGIC              0xA1B2C3D4
+#define PCAP_LINKTYPE_ETHERNET  1
+
+typedef struct {
+    uint32_t magic;
+    uint16_t versionMajor;
+    uint16_t versionMinor;
+    int32_t thisZone;
+    uint32_t sigFigs;
+    uint32_t snapLen;
+    uint32_t linkType;
+} pcap_file_hdr_t;
+
+typedef struct {
+    uint32_t tsSec;
+    uint32_t tsUsec;
+    uint32_t capLen;
+    uint32_t origLen;
+} pcap_rec_hdr_t;
+
+typedef struct {
+    uint64_t tsUsec;
+    uint32_t len;
+    uint8_t *data;
+} replay_frame_t;
+
+typedef struct {
+    uint8_t streamID[8];
+    uint8_t dest[ETH_ALEN];
+    uint64_t expected;          // frames of this stream in the pcap
+    void *rawsock;
+    uint64_t own;               // frames of its stream the listener received
+    uint64_t foreign;           // frames of other streams it received
+    uint64_t kernelPassed;
+    uint64_t kernelDropped;
+    uint32_t dropMismatches;    // drop counters that disagree with the pcap
+} listener_t;
+
+static listener_t listeners[PROBE_MAX_STREAMS];
+static uint32_t listenerCount;
+static uint64_t noStreamFrames;     // AVTP frames without a stream_id
+static volatile bool txDone;
+static double rxCpuUsec;
+
+/////////////////////////////////////////////////////////////////////////////
+// The rest of the avtp_pipeline is not linked; the rawsock only needs logging.
+/////////////////////////////////////////////////////////////////////////////
+
+void avbLogFn(int level, const char *tag, const char *company, const char *component,
+              const char *path, int line, const char *fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    fprintf(stderr, "%s %s: ", tag, component);
+    vfprintf(stderr, fmt, args);
+    fputc('\n', stderr);
+    va_end(args);
+}
+
+static uint64_t nowNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void sleepUntilNs(uint64_t ns)
+{
+    struct timespec ts;
+    ts.tv_sec = ns / 1000000000ULL;
+    ts.tv_nsec = ns % 1000000000ULL;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+    }
+}
+
+static double cpuUsec(void)
+{
+    struct rusage ru;
+    getrusage(RUSAGE_THREAD, &ru);
+    return ru.ru_utime.tv_sec * 1e6 + ru.ru_utime.tv_usec + ru.ru_stime.tv_sec * 1e6 + ru.ru_stime.tv_usec;
+}
+
+// Destination address and stream_id of an AVTP stream frame; false if the
+// frame is not AVTP or has no stream_id (sv clear)
+static bool parseFrame(const uint8_t *frame, uint32_t len, uint8_t dest[ETH_ALEN], uint8_t streamID[8], bool *avtp)
+{
+    uint32_t hdrLen = ETH_HLEN;
+    uint16_t ethertype;
+
+    *avtp = false;
+    if (len < ETH_HLEN + 4) {
+        return false;
+    }
+    ethertype = (frame[12] << 8) | frame[13];
+    if (ethertype == PROBE_VLAN_ETHERTYPE) {
+        ethertype = (frame[16] << 8) | frame[17];
+        hdrLen += 4;
+    }
+    if (ethertype != PROBE_ETHERTYPE || len < hdrLen + 12) {
+        return false;
+    }
+    *avtp = true;
+    if (!(frame[hdrLen + 1] & 0x80)) {
+        return false;
+    }
+    if (dest) {
+        memcpy(dest, frame, ETH_ALEN);
+    }
+    memcpy(streamID, frame + hdrLen + 4, 8);
+    return true;
+}
+
+static int findListener(const uint8_t streamID[8])
+{
+    uint32_t i;
+    for (i = 0; i < listenerCount; i++) {
+        if (memcmp(listeners[i].streamID, streamID, 8) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// pcap
+/////////////////////////////////////////////////////////////////////////////
+
+static int writePcap(const char *path, uint32_t streams, uint32_t addrs, uint32_t frames, uint32_t intervalUsec)
+{
+    static const uint8_t src[ETH_ALEN] = { 0x02, 0x1B, 0xC5, 0x0A, 0x00, 0x01 };
+    uint32_t order[PROBE_MAX_STREAMS];
+    uint32_t cycle, i;
+    uint32_t seed = 1;
+    pcap_file_hdr_t fileHdr;
+    FILE *f = fopen(path, "wb");
+
+    if (!f) {
+        perror(path);
+        return 1;
+    }
+    memset(&fileHdr, 0, sizeof(fileHdr));
+    fileHdr.magic = PCAP_MAGIC;
+    fileHdr.versionMajor = 2;
+    fileHdr.versionMinor = 4;
+    fileHdr.snapLen = PROBE_MAX_FRAME;
+    fileHdr.linkType = PCAP_LINKTYPE_ETHERNET;
+    fwrite(&fileHdr, sizeof(fileHdr), 1, f);
+
+    for (i = 0; i < streams; i++) {
+        order[i] = i;
+    }
+
+    for (cycle = 0; cycle < frames; cycle++) {
+        uint64_t tsUsec = (uint64_t)cycle * intervalUsec;
+
+        // A different interleaving every cycle
+        for (i = streams - 1; i > 0; i--) {
+            uint32_t j, tmp;
+            seed = seed * 1103515245 + 12345;
+            j = (seed >> 16) % (i + 1);
+            tmp = order[i]; order[i] = order[j]; order[j] = tmp;
+        }
+
+        for (i = 0; i <= streams; i++) {
+            uint8_t frame[PROBE_MAX_FRAME];
+            uint32_t len = 0;
+            bool control = (i == streams);
+            uint32_t s = control ? 0 : order[i];
+            pcap_rec_hdr_t recHdr;
+
+            // Multicast destination from the MAAP range; the control frame goes to the first one
+            frame[len++] = 0x91; frame[len++] = 0xE0; frame[len++] = 0xF0;
+            frame[len++] = 0x00; frame[len++] = 0xFE; frame[len++] = (uint8_t)(s % addrs);
+            memcpy(frame + len, src, ETH_ALEN);
+            len += ETH_ALEN;
+            if (!control && (s & 1)) {
+                // Class A: PCP 3, VID 2
+                frame[len++] = 0x81; frame[len++] = 0x00;
+                frame[len++] = 0x60; frame[len++] = 0x02;
+            }
+            frame[len++] = 0x22; frame[len++] = 0xF0;
+
+            memset(frame + len, 0, AVTP_HDR_LEN + PROBE_PAYLOAD_LEN);
+            if (control) {
+                // MAAP announce: control subtype, sv clear
+                frame[len] = 0xFE;
+                frame[len + 1] = 0x03;
+            }
+            else {
+                frame[len] = 0x02;                          // AAF
+                frame[len + 1] = 0x81;                      // sv, version 0, tv
+                frame[len + 2] = (uint8_t)cycle;            // sequence_num
+                memcpy(frame + len + 4, src, ETH_ALEN);     // stream_id
+                frame[len + 10] = (uint8_t)(s >> 8);
+                frame[len + 11] = (uint8_t)s;
+                frame[len + 20] = PROBE_PAYLOAD_LEN >> 8;   // stream_data_length
+                frame[len + 21] = PROBE_PAYLOAD_LEN & 0xFF;
+            }
+            len += AVTP_HDR_LEN + PROBE_PAYLOAD_LEN;
+
+            recHdr.tsSec = (uint32_t)(tsUsec / 1000000);
+            recHdr.tsUsec = (uint32_t)(tsUsec % 1000000);
+            recHdr.capLen = recHdr.origLen = len;
+            fwrite(&recHdr, sizeof(recHdr), 1, f);
+            fwrite(frame, len, 1, f);
+        }
+    }
+
+    if (fclose(f) != 0) {
+        perror(path);
+        return 1;
+    }
+    return 0;
+}
+
+static replay_frame_t *readPcap(const char *path, uint32_t *count)
+{
+    pcap_file_hdr_t fileHdr;
+    pcap_rec_hdr_t recHdr;
+    replay_frame_t *frames = NULL;
+    uint32_t n = 0, alloc = 0;
+    uint64_t firstUsec = 0;
+    FILE *f = fopen(path, "rb");
+
+    if (!f) {
+        perror(path);
+        return NULL;
+    }
+    if (fread(&fileHdr, sizeof(fileHdr), 1, f) != 1 || fileHdr.magic != PCAP_MAGIC
+        || fileHdr.linkType != PCAP_LINKTYPE_ETHERNET) {
+        fprintf(stderr, "%s: not a little endian, microsecond, Ethernet pcap file\n", path);
+        fclose(f);
+        return NULL;
+    }
+
+    while (fread(&recHdr, sizeof(recHdr), 1, f) == 1) {
+        uint64_t tsUsec = (uint64_t)recHdr.tsSec * 1000000 + recHdr.tsUsec;
+
+        if (recHdr.capLen == 0 || recHdr.capLen > PROBE_MAX_FRAME) {
+            fprintf(stderr, "%s: bad record length %u\n", path, recHdr.capLen);
+            break;
+        }
+        if (n == alloc) {
+            alloc = alloc ? alloc * 2 : 4096;
+            frames = realloc(frames, alloc * sizeof(*frames));
+            if (!frames) {
+                fclose(f);
+                return NULL;
+            }
+        }
+        frames[n].data = malloc(recHdr.capLen);
+        if (!frames[n].data || fread(frames[n].data, recHdr.capLen, 1, f) != 1) {
+            break;
+        }
+        if (n == 0) {
+            firstUsec = tsUsec;
+        }
+        frames[n].tsUsec = tsUsec - firstUsec;
+        frames[n].len = recHdr.capLen;
+        n++;
+    }
+
+    fclose(f);
+    *count = n;
+    return frames;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Receive
+/////////////////////////////////////////////////////////////////////////////
+
+static void *rxThread(void *arg)
+{
+    struct pollfd fds[PROBE_MAX_STREAMS];
+    uint64_t idleSince = 0;
+    double cpu0 = cpuUsec();
+    uint32_t i;
+
+    for (i = 0; i < listenerCount; i++) {
+        fds[i].fd = openavbRawsockGetSocket(listeners[i].rawsock);
+        fds[i].events = POLLIN;
+    }
+
+    for (;;) {
+        int ready = poll(fds, listenerCount, 10);
+        if (ready <= 0) {
+            if (txDone) {
+                if (!idleSince) {
+                    idleSince = nowNs();
+                }
+                else if (nowNs() - idleSince > RX_IDLE_MSEC * 1000000ULL) {
+                    break;
+                }
+            }
+            continue;
+        }
+        idleSince = 0;
+
+        for (i = 0; i < listenerCount; i++) {
+            listener_t *l = &listeners[i];
+            U32 offset, len;
+            U8 *frame;
+
+            // One frame per wakeup: the sendmmsg rawsock blocks whatever the timeout
+            if (!(fds[i].revents & POLLIN)) {
+                continue;
+            }
+            frame = openavbRawsockGetRxFrame(l->rawsock, OPENAVB_RAWSOCK_NONBLOCK, &offset, &len);
+            if (frame) {
+                uint8_t streamID[8];
+                bool avtp;
+
+                if (parseFrame(frame + offset, len, NULL, streamID, &avtp)
+                    && memcmp(streamID, l->streamID, 8) == 0) {
+                    l->own++;
+                }
+                else {
+                    l->foreign++;
+                }
+                openavbRawsockRelRxFrame(l->rawsock, frame);
+            }
+        }
+    }
+
+    rxCpuUsec = cpuUsec() - cpu0;
+    return NULL;
+}
+
+// Read back the kernel counters of the filter and compare them with the pcap
+static void checkKernelCounts(listener_t *l, rawsock_stream_count_t *counts, int max)
+{
+    int n, i;
+
+    n = openavbRawsockRxStreamCounts(l->rawsock, FALSE, counts, max);
+    for (i = 0; i < n; i++) {
+        l->kernelPassed += counts[i].frames;
+    }
+
+    n = openavbRawsockRxStreamCounts(l->rawsock, TRUE, counts, max);
+    for (i = 0; i < n; i++) {
+        static const uint8_t none[8];
+        int other = findListener(counts[i].streamID);
+        uint64_t expected;
+
+        l->kernelDropped += counts[i].frames;
+        if (memcmp(counts[i].streamID, none, 8) == 0) {
+            expected = noStreamFrames;
+        }
+        else if (other >= 0 && &listeners[other] != l) {
+            expected = listeners[other].expected;
+        }
+        else {
+            expected = 0;
+        }
+        if (counts[i].frames != expected) {
+            l->dropMismatches++;
+        }
+    }
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+        "Usage: %s -w PCAP [-s STREAMS] [-a ADDRS] [-n FRAMES] [-p USEC]\n"
+        "       %s -f PCAP -i TXIF -r RXIF [options]\n"
+        "  -w FILE    Write a pcap of interleaved AVTP streams and exit\n"
+        "  -s N       Streams to write (default %u, at most %u)\n"
+        "  -a N       Multicast addresses shared by the streams (default %u)\n"
+        "  -n N       Frames per stream (default %u)\n"
+        "  -p USEC    Interval between frames of a stream (default %u)\n"
+        "  -f FILE    pcap to replay\n"
+        "  -i IF      Interface to replay on\n"
+        "  -r IF      Peer interface to receive on\n"
+        "  -m NAME    Rawsock implementation: simple, sendmmsg or ring (default %s)\n"
+        "  -F         Filter by stream_id in the kernel (openavbRawsockRxStreamID)\n"
+        "  -l LABEL   Label in the results\n"
+        "  -c FILE    Append a CSV row to FILE\n",
+        prog, prog, DEFAULT_STREAMS, PROBE_MAX_STREAMS, DEFAULT_ADDRS, DEFAULT_FRAMES,
+        DEFAULT_INTERVAL_USEC, DEFAULT_BACKEND);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *writePath = NULL;
+    const char *pcapPath = NULL;
+    const char *txIfname = NULL;
+    const char *rxIfname = NULL;
+    const char *backend = DEFAULT_BACKEND;
+    const char *label = NULL;
+    const char *csvPath = NULL;
+    uint32_t streams = DEFAULT_STREAMS;
+    uint32_t addrs = DEFAULT_ADDRS;
+    uint32_t framesPerStream = DEFAULT_FRAMES;
+    uint32_t intervalUsec = DEFAULT_INTERVAL_USEC;
+    bool filter = false;
+    replay_frame_t *frames;
+    uint32_t frameCount = 0;
+    rawsock_stream_count_t *counts;
+    struct sockaddr_ll addr;
+    pthread_t rx;
+    uint64_t startNs;
+    uint32_t sent = 0, txErrors = 0, k, i;
+    uint64_t own = 0, foreign = 0, expected = 0, kernelPassed = 0, kernelDropped = 0;
+    uint32_t lost = 0, leaked = 0, passMismatches = 0, dropMismatches = 0;
+    bool ok;
+    int txSock;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "w:s:a:n:p:f:i:r:m:Fl:c:h")) != -1) {
+        switch (opt) {
+            case 'w': writePath = optarg; break;
+            case 's': streams = strtoul(optarg, NULL, 0); break;
+            case 'a': addrs = strtoul(optarg, NULL, 0); break;
+            case 'n': framesPerStream = strtoul(optarg, NULL, 0); break;
+            case 'p': intervalUsec = strtoul(optarg, NULL, 0); break;
+            case 'f': pcapPath = optarg; break;
+            case 'i': txIfname = optarg; break;
+            case 'r': rxIfname = optarg; break;
+            case 'm': backend = optarg; break;
+            case 'F': filter = true; break;
+            case 'l': label = optarg; break;
+            case 'c': csvPath = optarg; break;
+            default: usage(argv[0]); return 1;
+        }
+    }
+
+    if (writePath) {
+        if (streams == 0 || streams > PROBE_MAX_STREAMS || addrs == 0 || addrs > 256 || framesPerStream == 0) {
+            usage(argv[0]);
+            return 1;
+        }
+        return writePcap(writePath, streams, addrs, framesPerStream, intervalUsec);
+    }
+    if (!pcapPath || !txIfname || !rxIfname) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (!label) {
+        label = filter ? "stream_filter" : "address_filter";
+    }
+
+    frames = readPcap(pcapPath, &frameCount);
+    if (!frames || frameCount == 0) {
+        return 1;
+    }
+
+    // One listener per stream in the pcap
+    for (k = 0; k < frameCount; k++) {
+        uint8_t dest[ETH_ALEN], streamID[8];
+        bool avtp;
+        int l;
+
+        if (!parseFrame(frames[k].data, frames[k].len, dest, streamID, &avtp)) {
+            if (avtp) {
+                noStreamFrames++;
+            }
+            continue;
+        }
+        l = findListener(streamID);
+        if (l < 0) {
+            if (listenerCount == PROBE_MAX_STREAMS) {
+                fprintf(stderr, "%s: more than %u streams\n", pcapPath, PROBE_MAX_STREAMS);
+                return 1;
+            }
+            l = listenerCount++;
+            memcpy(listeners[l].streamID, streamID, 8);
+            memcpy(listeners[l].dest, dest, ETH_ALEN);
+        }
+        listeners[l].expected++;
+    }
+    if (listenerCount == 0) {
+        fprintf(stderr, "%s: no AVTP streams\n", pcapPath);
+        return 1;
+    }
+
+    openavbArenaInitialize();
+    for (i = 0; i < listenerCount; i++) {
+        listener_t *l = &listeners[i];
+        char uri[IFNAMSIZ + 16];
+
+        snprintf(uri, sizeof(uri), "%s:%s", backend, rxIfname);
+        l->rawsock = openavbRawsockOpen(uri, TRUE, FALSE, PROBE_ETHERTYPE, PROBE_RX_FRAME_SIZE, 64);
+        if (!l->rawsock) {
+            fprintf(stderr, "%s: rawsock open failed\n", uri);
+            return 1;
+        }
+        openavbRawsockRxMulticast(l->rawsock, TRUE, l->dest);
+        if (filter && !openavbRawsockRxStreamID(l->rawsock, TRUE, l->streamID)) {
+            fprintf(stderr, "%s: stream filter not available\n", uri);
+            return 1;
+        }
+    }
+
+    txSock = socket(AF_PACKET, SOCK_RAW, 0);
+    memset(&addr, 0, sizeof(addr));
+    addr.sll_family = AF_PACKET;
+    addr.sll_ifindex = if_nametoindex(txIfname);
+    addr.sll_halen = ETH_ALEN;
+    if (txSock < 0 || addr.sll_ifindex == 0) {
+        perror(txIfname);
+        return 1;
+    }
+
+    if (pthread_create(&rx, NULL, rxThread, NULL) != 0) {
+        return 1;
+    }
+
+    // Replay at the pcap's pace
+    startNs = nowNs() + 20000000ULL;
+    for (k = 0; k < frameCount; k++) {
+        sleepUntilNs(startNs + frames[k].tsUsec * 1000);
+        memcpy(addr.sll_addr, frames[k].data, ETH_ALEN);
+        if (sendto(txSock, frames[k].data, frames[k].len, 0, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+            txErrors++;
+        }
+        else {
+            sent++;
+        }
+    }
+    txDone = true;
+    pthread_join(rx, NULL);
+    close(txSock);
+
+    counts = calloc(2 * PROBE_MAX_STREAMS, sizeof(*counts));
+    if (!counts) {
+        return 1;
+    }
+    for (i = 0; i < listenerCount; i++) {
+        listener_t *l = &listeners[i];
+
+        if (filter) {
+            checkKernelCounts(l, counts, 2 * PROBE_MAX_STREAMS);
+            if (l->kernelPassed != l->expected) {
+                passMismatches++;
+            }
+            dropMismatches += l->dropMismatches;
+        }
+        if (l->own < l->expected) {
+            lost++;
+        }
+        if (filter && l->foreign) {
+            leaked++;
+        }
+        own += l->own;
+        foreign += l->foreign;
+        expected += l->expected;
+        kernelPassed += l->kernelPassed;
+        kernelDropped += l->kernelDropped;
+        openavbRawsockClose(l->rawsock);
+    }
+    free(counts);
+
+    ok = sent == frameCount && lost == 0 && leaked == 0 && passMismatches == 0 && dropMismatches == 0;
+
+    printf("{\"label\": \"%s\", \"backend\": \"%s\", \"stream_filter\": %s, \"streams\": %u, "
+           "\"pcap_frames\": %u, \"no_stream_frames\": %" PRIu64 ", \"sent\": %u, \"tx_errors\": %u, "
+           "\"expected\": %" PRIu64 ", \"own\": %" PRIu64 ", \"foreign\": %" PRIu64 ", "
+           "\"userspace_frames\": %" PRIu64 ", \"kernel_passed\": %" PRIu64 ", \"kernel_dropped\": %" PRIu64 ", "
+           "\"streams_short\": %u, \"streams_leaked\": %u, \"pass_mismatches\": %u, \"drop_mismatches\": %u, "
+           "\"rx_cpu_usec\": %.0f, \"rx_cpu_usec_per_own_frame\": %.3f, \"ok\": %s}\n",
+           label, backend, filter ? "true" : "false", listenerCount,
+           frameCount, noStreamFrames, sent, txErrors,
+           expected, own, foreign, own + foreign, kernelPassed, kernelDropped,
+           lost, leaked, passMismatches, dropMismatches,
+           rxCpuUsec, own ? rxCpuUsec / own : 0.0, ok ? "true" : "false");
+
+    if (csvPath) {
+        FILE *csv = fopen(csvPath, "a");
+        if (csv) {
+            fseek(csv, 0, SEEK_END);
+            if (ftell(csv) == 0) {
+                fprintf(csv, "label,backend,stream_filter,streams,sent,expected,own,foreign,kernel_passed,"
+                             "kernel_dropped,streams_short,streams_leaked,pass_mismatches,drop_mismatches,"
+                             "rx_cpu_usec,ok\n");
+            }
+            fprintf(csv, "%s,%s,%d,%u,%u,%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%u,%u,%u,%u,%.0f,%d\n",
+                    label, backend, filter, listenerCount, sent, expected, own, foreign, kernelPassed,
+                    kernelDropped, lost, leaked, passMismatches, dropMismatches, rxCpuUsec, ok);
+            fclose(csv);
+        }
+    }
+
+    return ok ? 0 : 2;
+}
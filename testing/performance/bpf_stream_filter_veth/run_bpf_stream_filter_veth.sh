@@ -0,0 +1,131 @@
+#!/bin/bash
+#
+# eBPF stream filter test over a veth pair.
+#
+# Replays a pcap of interleaved AVTP streams (by default one written by the
+# probe: 64 streams over 4 multicast addresses) on one end of a veth pair. The
+# probe opens one listener rawsock per stream on the other end and runs twice
+# per rawsock implementation:
+#   - address_filter: multicast address filter only; each listener also
+#                     gets the streams that share its address
+#   - stream_filter:  eBPF filter on the stream_id; each listener must get
+#                     only its own stream, and the per stream kernel drop
+#                     counters must match the pcap
+# Per run it records frames delivered to user space, frames dropped in the
+# kernel and the receive CPU time.
+#
+# One JSON object per run is appended to results.jsonl and the probe adds a
+# row to results.csv in the output directory. The exit status is non-zero if
+# a stream_filter run lost frames, let other streams through or has counters
+# that do not match the pcap.
+#
+# Requirements: root (veth creation, raw sockets, loading BPF programs) and a
+# kernel with eBPF socket filters (Linux 4.4 or later).
+
+set -u
+
+PROBE=""
+PCAP=""
+BACKENDS="simple sendmmsg ring"
+STREAMS=64
+ADDRS=4
+FRAMES=500
+INTERVAL_USEC=1000
+OUT_DIR="./bpf_stream_filter_veth_results"
+VETH_TX="bsf0"
+VETH_RX="bsf1"
+KEEP_VETH=0
+
+usage() {
+    cat <<USAGE
+Usage: $0 --probe PATH [options]
+  --probe PATH          bpf_stream_filter_probe binary
+  --pcap FILE           pcap to replay (default: written by the probe)
+  --backends "LIST"     Rawsock implementations (default "${BACKENDS}")
+  --streams N           Streams in the written pcap (default ${STREAMS})
+  --addrs N             Multicast addresses they share (default ${ADDRS})
+  --frames N            Frames per stream in the written pcap (default ${FRAMES})
+  --interval USEC       Interval between frames of a stream (default ${INTERVAL_USEC})
+  --out DIR             Output directory (default ${OUT_DIR})
+  --keep-veth           Leave the veth pair in place on exit
+USAGE
+}
+
+while [ $# -gt 0 ]; do
+    case "$1" in
+        --probe) PROBE="$2"; shift 2 ;;
+        --pcap) PCAP="$2"; shift 2 ;;
+        --backends) BACKENDS="$2"; shift 2 ;;
+        --streams) STREAMS="$2"; shift 2 ;;
+        --addrs) ADDRS="$2"; shift 2 ;;
+        --frames) FRAMES="$2"; shift 2 ;;
+        --interval) INTERVAL_USEC="$2"; shift 2 ;;
+        --out) OUT_DIR="$2"; shift 2 ;;
+        --keep-veth) KEEP_VETH=1; shift ;;
+        -h|--help) usage; exit 0 ;;
+        *) echo "Unknown option: $1"; usage; exit 1 ;;
+    esac
+done
+
+if [ -z "${PROBE}" ]; then
+    usage
+    exit 1
+fi
+if [ "$(id -u)" -ne 0 ]; then
+    echo "This test needs root to create veth interfaces and load BPF programs"
+    exit 1
+fi
+
+mkdir -p "${OUT_DIR}"
+OUT_DIR="$(cd "${OUT_DIR}" && pwd)"
+RESULTS_JSON="${OUT_DIR}/results.jsonl"
+RESULTS_CSV="${OUT_DIR}/results.csv"
+
+if [ -z "${PCAP}" ]; then
+    PCAP="${OUT_DIR}/streams.pcap"
+    "${PROBE}" -w "${PCAP}" -s "${STREAMS}" -a "${ADDRS}" -n "${FRAMES}" -p "${INTERVAL_USEC}" || exit 1
+fi
+
+teardown() {
+    if [ ${KEEP_VETH} -eq 0 ]; then
+        ip link del "${VETH_TX}" 2>/dev/null
+    fi
+}
+trap teardown EXIT INT TERM
+
+ip link del "${VETH_TX}" 2>/dev/null
+ip link add "${VETH_TX}" type veth peer name "${VETH_RX}" || exit 1
+for dev in "${VETH_TX}" "${VETH_RX}"; do
+    sysctl -qw "net.ipv6.conf.${dev}.disable_ipv6=1" 2>/dev/null
+    ip link set "${dev}" up || exit 1
+done
+
+FAILED=0
+for BACKEND in ${BACKENDS}; do
+    for RUN in address_filter stream_filter; do
+        case "${RUN}" in
+            address_filter) ARGS="" ;;
+            stream_filter) ARGS="-F" ;;
+        esac
+        LABEL="${BACKEND}_${RUN}"
+        # shellcheck disable=SC2086
+        "${PROBE}" -f "${PCAP}" -i "${VETH_TX}" -r "${VETH_RX}" -m "${BACKEND}" ${ARGS} \
+            -l "${LABEL}" -c "${RESULTS_CSV}" > "${OUT_DIR}/${LABEL}.json" 2> "${OUT_DIR}/${LABEL}.log"
+        PROBE_RC=$?
+        # Listeners losing frames without the stream filter is a result, not a failure
+        if [ ${PROBE_RC} -ne 0 ] && [ ${PROBE_RC} -ne 2 -o "${RUN}" = stream_filter ]; then
+            FAILED=1
+        fi
+
+        {
+            printf '{"run": "%s", "backend": "%s", "probe_rc": %d, "probe": ' "${RUN}" "${BACKEND}" "${PROBE_RC}"
+            tr -d '\n' < "${OUT_DIR}/${LABEL}.json"
+            printf '}\n'
+        } >> "${RESULTS_JSON}"
+
+        echo "${LABEL}: $(grep -o '"own": [0-9]*, "foreign": [0-9]*, "userspace_frames": [0-9]*, "kernel_passed": [0-9]*, "kernel_dropped": [0-9]*' "${OUT_DIR}/${LABEL}.json")" \
+             "$(grep -o '"rx_cpu_usec": [0-9.]*, "rx_cpu_usec_per_own_frame": [0-9.]*, "ok": [a-z]*' "${OUT_DIR}/${LABEL}.json")"
+    done
+done
+
+exit ${FAILED}
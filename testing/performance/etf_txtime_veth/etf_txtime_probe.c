@@ -0,0 +1,411 @@
+/**
+ * ETF Launch Time Probe
+ *
+ * Sends a paced AVTP-ethertype stream through the avtp_pipeline Linux rawsock
+ * implementations (simple, sendmmsg and ring, linked as is) on one end of a
+ * veth pair, and timestamps the frames as they arrive on the other end.
+ *
+ * Every frame k has a target launch time start + k * interval on CLOCK_TAI.
+ *
+ *  - Without -L the sender wakes at the launch time of each batch and sends
+ *    the batch right away. Pacing is only as good as the thread wakeup, and
+ *    with -b > 1 every frame in a batch goes out at once.
+ *  - With -L the rawsock has openavbRawsockTxSetLaunchTime() enabled. The
+ *    sender wakes -d usec ahead of each batch and hands the frames to the
+ *    kernel with their launch times. The ETF qdisc on the interface
+ *    (set up by run_etf_txtime_veth.sh) releases them on time.
+ *
+ * The receiver reports arrival minus target launch time per frame. Frames
+ * dropped by ETF for a missed launch time come back on the socket error queue
+ * and are counted by the rawsock (openavbRawsockGetTXLaunchMissed()).
+ *
+ * Results are written as a single JSON object on stdout (and optionally a CSV
+ * row).
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <sys/socket.h>
+#include <sys/resource.h>
+#include <linux/if_packet.h>
+#include <linux/if_ether.h>
+
+#include "openavb_types_pub.h"
+#include "openavb_rawsock.h"
+#include "openavb_arena.h"
+
+#define PROBE_ETHERTYPE         0x22F0
+#define PROBE_MAGIC             0x45544650  // "ETFP"
+#define PROBE_FRAME_LEN         128
+#define DEFAULT_FRAMES          8000
+#define DEFAULT_INTERVAL_USEC   125
+#define DEFAULT_LEAD_USEC       1000
+#define DEFAULT_BACKEND         "simple"
+#define RX_IDLE_MSEC            300
+
+typedef struct {
+    uint32_t magic;
+    uint32_t seq;
+    uint64_t launchNs;
+} __attribute__((packed)) probe_payload_t;
+
+static const uint8_t probeDest[ETH_ALEN] = { 0x91, 0xE0, 0xF0, 0x00, 0xFE, 0x00 };
+
+static const char *rxIfname;
+static uint32_t frameCount = DEFAULT_FRAMES;
+static int64_t *arrivalErrNs;       // per frame, INT64_MIN until received
+static uint32_t rxFrames;
+static uint32_t rxDuplicates;
+static volatile bool txDone;
+static int64_t taiOffsetNs;         // CLOCK_TAI - CLOCK_REALTIME
+static int rxReady;
+
+/////////////////////////////////////////////////////////////////////////////
+// The rest of the avtp_pipeline is not linked; the rawsock only needs logging.
+/////////////////////////////////////////////////////////////////////////////
+
+void avbLogFn(int level, const char *tag, const char *company, const char *component,
+              const char *path, int line, const char *fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    fprintf(stderr, "%s %s: ", tag, component);
+    vfprintf(stderr, fmt, args);
+    fputc('\n', stderr);
+    va_end(args);
+}
+
+static uint64_t nowNs(clockid_t clk)
+{
+    struct timespec ts;
+    clock_gettime(clk, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void sleepUntilNs(clockid_t clk, uint64_t ns)
+{
+    struct timespec ts;
+    ts.tv_sec = ns / 1000000000ULL;
+    ts.tv_nsec = ns % 1000000000ULL;
+    while (clock_nanosleep(clk, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+    }
+}
+
+// Offset between the two clocks, taken from the closest of a few samples
+static int64_t taiOffset(void)
+{
+    int64_t best = 0;
+    uint64_t bestSpan = UINT64_MAX;
+    int i;
+
+    for (i = 0; i < 16; i++) {
+        uint64_t r0 = nowNs(CLOCK_REALTIME);
+        uint64_t tai = nowNs(CLOCK_TAI);
+        uint64_t r1 = nowNs(CLOCK_REALTIME);
+        if (r1 - r0 < bestSpan) {
+            bestSpan = r1 - r0;
+            best = (int64_t)(tai - (r0 + (r1 - r0) / 2));
+        }
+    }
+    return best;
+}
+
+static void *rxThread(void *arg)
+{
+    int sock = socket(AF_PACKET, SOCK_RAW, htons(PROBE_ETHERTYPE));
+    struct sockaddr_ll addr;
+    struct timeval tv = { 0, RX_IDLE_MSEC * 1000 };
+    int on = 1;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sll_family = AF_PACKET;
+    addr.sll_protocol = htons(PROBE_ETHERTYPE);
+    addr.sll_ifindex = if_nametoindex(rxIfname);
+    if (sock < 0 || addr.sll_ifindex == 0
+        || bind(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0
+        || setsockopt(sock, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on)) < 0
+        || setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv)) < 0) {
+        perror(rxIfname);
+        __atomic_store_n(&rxReady, -1, __ATOMIC_RELEASE);
+        return NULL;
+    }
+    __atomic_store_n(&rxReady, 1, __ATOMIC_RELEASE);
+
+    for (;;) {
+        uint8_t frame[2048];
+        uint8_t control[256];
+        struct iovec iov = { frame, sizeof(frame) };
+        struct msghdr msg;
+        struct cmsghdr *cmsg;
+        uint64_t arrivalNs = 0;
+        probe_payload_t payload;
+        ssize_t len;
+
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        len = recvmsg(sock, &msg, 0);
+        if (len < 0) {
+            if (txDone) {
+                break;
+            }
+            continue;
+        }
+        if (len < (ssize_t)(ETH_HLEN + sizeof(payload))) {
+            continue;
+        }
+        for (cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+                struct timespec ts;
+                memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+                arrivalNs = (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+            }
+        }
+        memcpy(&payload, frame + ETH_HLEN, sizeof(payload));
+        if (ntohl(payload.magic) != PROBE_MAGIC || payload.seq >= frameCount || !arrivalNs) {
+            continue;
+        }
+        if (arrivalErrNs[payload.seq] != INT64_MIN) {
+            rxDuplicates++;
+            continue;
+        }
+        arrivalErrNs[payload.seq] = (int64_t)(arrivalNs + taiOffsetNs - payload.launchNs);
+        rxFrames++;
+    }
+
+    close(sock);
+    return NULL;
+}
+
+static int cmpS64(const void *a, const void *b)
+{
+    int64_t x = *(const int64_t *)a, y = *(const int64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static double cpuUsec(void)
+{
+    struct rusage ru;
+    getrusage(RUSAGE_THREAD, &ru);
+    return ru.ru_utime.tv_sec * 1e6 + ru.ru_utime.tv_usec + ru.ru_stime.tv_sec * 1e6 + ru.ru_stime.tv_usec;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+        "Usage: %s -i TXIF -r RXIF [options]\n"
+        "  -i IF      Interface to send on (ETF qdisc for -L)\n"
+        "  -r IF      Peer interface to receive on\n"
+        "  -m NAME    Rawsock implementation: simple, sendmmsg or ring (default %s)\n"
+        "  -L         Send with launch times (SO_TXTIME)\n"
+        "  -n N       Frames (default %u)\n"
+        "  -p USEC    Interval between frames (default %u)\n"
+        "  -b N       Frames per wakeup (default 1)\n"
+        "  -d USEC    Wake this far ahead of the launch time with -L (default %u)\n"
+        "  -P PRIO    SO_PRIORITY of the sending socket, to select the ETF queue (default 0)\n"
+        "  -l LABEL   Label in the results\n"
+        "  -c FILE    Append a CSV row to FILE\n",
+        prog, DEFAULT_BACKEND, DEFAULT_FRAMES, DEFAULT_INTERVAL_USEC, DEFAULT_LEAD_USEC);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *txIfname = NULL;
+    const char *backend = DEFAULT_BACKEND;
+    const char *label = NULL;
+    const char *csvPath = NULL;
+    uint32_t intervalUsec = DEFAULT_INTERVAL_USEC;
+    uint32_t batch = 1;
+    uint32_t leadUsec = DEFAULT_LEAD_USEC;
+    bool launchTime = false;
+    int prio = 0;
+    char uri[IFNAMSIZ + 16];
+    hdr_info_t hdr;
+    U8 srcAddr[ETH_ALEN];
+    pthread_t rx;
+    void *rawsock;
+    uint64_t startNs;
+    uint32_t sent = 0, wakes = 0, txErrors = 0;
+    unsigned long missed;
+    double cpu0, txCpuUsec;
+    int opt;
+    uint32_t k;
+
+    while ((opt = getopt(argc, argv, "i:r:m:Ln:p:b:d:P:l:c:h")) != -1) {
+        switch (opt) {
+            case 'i': txIfname = optarg; break;
+            case 'r': rxIfname = optarg; break;
+            case 'm': backend = optarg; break;
+            case 'L': launchTime = true; break;
+            case 'n': frameCount = strtoul(optarg, NULL, 0); break;
+            case 'p': intervalUsec = strtoul(optarg, NULL, 0); break;
+            case 'b': batch = strtoul(optarg, NULL, 0); break;
+            case 'd': leadUsec = strtoul(optarg, NULL, 0); break;
+            case 'P': prio = strtol(optarg, NULL, 0); break;
+            case 'l': label = optarg; break;
+            case 'c': csvPath = optarg; break;
+            default: usage(argv[0]); return 1;
+        }
+    }
+    if (!txIfname || !rxIfname || frameCount == 0 || intervalUsec == 0 || batch == 0 || batch > 64) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (!label) {
+        label = launchTime ? "launch_time" : "immediate";
+    }
+
+    arrivalErrNs = malloc(frameCount * sizeof(*arrivalErrNs));
+    if (!arrivalErrNs) {
+        return 1;
+    }
+    for (k = 0; k < frameCount; k++) {
+        arrivalErrNs[k] = INT64_MIN;
+    }
+    taiOffsetNs = taiOffset();
+
+    openavbArenaInitialize();
+    snprintf(uri, sizeof(uri), "%s:%s", backend, txIfname);
+    rawsock = openavbRawsockOpen(uri, FALSE, TRUE, PROBE_ETHERTYPE, PROBE_FRAME_LEN + 64, 2 * batch + 8);
+    if (!rawsock) {
+        fprintf(stderr, "%s: rawsock open failed\n", uri);
+        return 1;
+    }
+    if (prio && setsockopt(openavbRawsockGetSocket(rawsock), SOL_SOCKET, SO_PRIORITY, &prio, sizeof(prio)) < 0) {
+        perror("SO_PRIORITY");
+        return 1;
+    }
+    if (launchTime && !openavbRawsockTxSetLaunchTime(rawsock, TRUE)) {
+        fprintf(stderr, "%s: SO_TXTIME not available\n", uri);
+        return 1;
+    }
+    openavbRawsockGetAddr(rawsock, srcAddr);
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.shost = srcAddr;
+    hdr.dhost = (U8 *)probeDest;
+    hdr.ethertype = PROBE_ETHERTYPE;
+    openavbRawsockTxSetHdr(rawsock, &hdr);
+
+    if (pthread_create(&rx, NULL, rxThread, NULL) != 0) {
+        return 1;
+    }
+    while (__atomic_load_n(&rxReady, __ATOMIC_ACQUIRE) == 0) {
+        usleep(1000);
+    }
+    if (rxReady < 0) {
+        return 1;
+    }
+
+    // Start on a whole interval, far enough out for the first wakeup
+    startNs = nowNs(CLOCK_TAI) + 20000000ULL;
+    startNs -= startNs % (intervalUsec * 1000ULL);
+    cpu0 = cpuUsec();
+
+    for (k = 0; k < frameCount; k += batch) {
+        uint64_t batchNs = startNs + (uint64_t)k * intervalUsec * 1000;
+        uint32_t j;
+
+        sleepUntilNs(CLOCK_TAI, launchTime ? batchNs - leadUsec * 1000ULL : batchNs);
+        wakes++;
+
+        for (j = k; j < k + batch && j < frameCount; j++) {
+            uint64_t launchNs = startNs + (uint64_t)j * intervalUsec * 1000;
+            probe_payload_t payload;
+            U32 size, hdrlen;
+            U8 *pBuf = openavbRawsockGetTxFrame(rawsock, TRUE, &size);
+
+            if (!pBuf) {
+                txErrors++;
+                continue;
+            }
+            openavbRawsockTxFillHdr(rawsock, pBuf, &hdrlen);
+            memset(pBuf + hdrlen, 0, PROBE_FRAME_LEN - hdrlen);
+            payload.magic = htonl(PROBE_MAGIC);
+            payload.seq = j;
+            payload.launchNs = launchNs;
+            memcpy(pBuf + hdrlen, &payload, sizeof(payload));
+            openavbRawsockTxFrameReady(rawsock, pBuf, PROBE_FRAME_LEN, launchTime ? launchNs : 0);
+            sent++;
+        }
+        if (openavbRawsockSend(rawsock) < 0) {
+            txErrors++;
+        }
+    }
+    txCpuUsec = cpuUsec() - cpu0;
+
+    // Let the last launch times pass, then collect late error reports
+    sleepUntilNs(CLOCK_TAI, startNs + (uint64_t)frameCount * intervalUsec * 1000 + 2000000ULL);
+    openavbRawsockSend(rawsock);
+    txDone = true;
+    pthread_join(rx, NULL);
+    missed = openavbRawsockGetTXLaunchMissed(rawsock);
+    openavbRawsockClose(rawsock);
+
+    // Arrival error distribution over the frames that arrived
+    int64_t *errs = malloc((rxFrames ? rxFrames : 1) * sizeof(*errs));
+    uint32_t n = 0;
+    double sum = 0;
+    for (k = 0; k < frameCount; k++) {
+        if (arrivalErrNs[k] != INT64_MIN) {
+            errs[n++] = arrivalErrNs[k];
+            sum += arrivalErrNs[k];
+        }
+    }
+    qsort(errs, n, sizeof(*errs), cmpS64);
+#define PCT(p) (n ? errs[(uint32_t)((n - 1) * (p))] / 1000.0 : 0.0)
+    double minUs = PCT(0), p01 = PCT(0.01), p50 = PCT(0.5), p99 = PCT(0.99), maxUs = PCT(1.0);
+    double meanUs = n ? sum / n / 1000.0 : 0.0;
+#undef PCT
+
+    printf("{\"label\": \"%s\", \"backend\": \"%s\", \"launch_time\": %s, \"frames\": %u, \"interval_usec\": %u, "
+           "\"batch\": %u, \"lead_usec\": %u,\n"
+           " \"sent\": %u, \"received\": %u, \"lost\": %u, \"duplicates\": %u, \"launch_missed\": %lu, \"tx_errors\": %u,\n"
+           " \"wakes\": %u, \"tx_cpu_usec_per_frame\": %.3f,\n"
+           " \"arrival_error_usec\": {\"min\": %.1f, \"p1\": %.1f, \"mean\": %.1f, \"p50\": %.1f, \"p99\": %.1f, \"max\": %.1f},"
+           " \"jitter_p1_p99_usec\": %.1f}\n",
+           label, backend, launchTime ? "true" : "false", frameCount, intervalUsec, batch, leadUsec,
+           sent, rxFrames, frameCount - rxFrames, rxDuplicates, missed, txErrors,
+           wakes, sent ? txCpuUsec / sent : 0.0,
+           minUs, p01, meanUs, p50, p99, maxUs, p99 - p01);
+
+    if (csvPath) {
+        FILE *csv = fopen(csvPath, "a");
+        if (!csv) {
+            perror(csvPath);
+            return 1;
+        }
+        if (ftell(csv) == 0) {
+            fprintf(csv, "label,backend,launch_time,frames,interval_usec,batch,lead_usec,sent,received,lost,"
+                         "launch_missed,wakes,tx_cpu_usec_per_frame,err_min_usec,err_p1_usec,err_mean_usec,"
+                         "err_p50_usec,err_p99_usec,err_max_usec,jitter_p1_p99_usec\n");
+        }
+        fprintf(csv, "%s,%s,%d,%u,%u,%u,%u,%u,%u,%u,%lu,%u,%.3f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f\n",
+                label, backend, launchTime, frameCount, intervalUsec, batch, leadUsec, sent, rxFrames,
+                frameCount - rxFrames, missed, wakes, sent ? txCpuUsec / sent : 0.0,
+                minUs, p01, meanUs, p50, p99, maxUs, p99 - p01);
+        fclose(csv);
+    }
+
+    free(errs);
+    free(arrivalErrNs);
+    return (rxFrames == 0 || txErrors) ? 2 : 0;
+}
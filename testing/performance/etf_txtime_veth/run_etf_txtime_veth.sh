@@ -0,0 +1,142 @@
+#!/bin/bash
+#
+# ETF launch time test over a veth pair.
+#
+# Sets up a veth pair with a multiqueue sender end: mqprio maps SO_PRIORITY 3
+# (class A) to traffic class 0 on queue 0, with an etf qdisc on CLOCK_TAI.
+# Everything else goes to queue 1. etf_txtime_probe then sends a paced stream
+# through each rawsock implementation in three ways:
+#   - immediate_b1: one frame per wakeup, sent when the thread wakes
+#   - immediate_bN: --batch frames per wakeup, sent together
+#   - launch_bN:    --batch frames per wakeup, each with its launch time
+# Per run it records arrival minus launch time on the peer (min/p1/p50/p99/max
+# and p1-p99 jitter), frames ETF dropped for a missed launch time, wakeups and
+# sender CPU time per frame.
+#
+# One JSON object per run is appended to results.jsonl and the probe adds a
+# row to results.csv in the output directory. The exit status is non-zero if
+# a launch time run lost or missed frames.
+#
+# Requirements: root (veth creation, raw sockets, qdiscs) and a kernel with
+# sch_mqprio and sch_etf. veth has no launch time offload, so ETF runs in
+# software mode; the arrival error then includes the qdisc watchdog timer
+# latency, but not the talker thread wakeup.
+
+set -u
+
+PROBE=""
+BACKENDS="simple sendmmsg ring"
+FRAMES=8000
+INTERVAL_USEC=125
+BATCH=8
+LEAD_USEC=1000
+DELTA_NSEC=200000
+OUT_DIR="./etf_txtime_veth_results"
+VETH_TX="etf0"
+VETH_RX="etf1"
+KEEP_VETH=0
+
+usage() {
+    cat <<EOF
+Usage: $0 --probe PATH [options]
+  --probe PATH          etf_txtime_probe binary
+  --backends "LIST"     Rawsock implementations (default "${BACKENDS}")
+  --frames N            Frames per run (default ${FRAMES})
+  --interval USEC       Interval between frames (default ${INTERVAL_USEC})
+  --batch N             Frames per wakeup for the batched runs (default ${BATCH})
+  --lead USEC           Wakeup ahead of the first launch time (default ${LEAD_USEC})
+  --delta NSEC          ETF delta: how early the qdisc dequeues (default ${DELTA_NSEC})
+  --out DIR             Output directory (default ${OUT_DIR})
+  --keep-veth           Leave the veth pair in place on exit
+EOF
+}
+
+while [ $# -gt 0 ]; do
+    case "$1" in
+        --probe) PROBE="$2"; shift 2 ;;
+        --backends) BACKENDS="$2"; shift 2 ;;
+        --frames) FRAMES="$2"; shift 2 ;;
+        --interval) INTERVAL_USEC="$2"; shift 2 ;;
+        --batch) BATCH="$2"; shift 2 ;;
+        --lead) LEAD_USEC="$2"; shift 2 ;;
+        --delta) DELTA_NSEC="$2"; shift 2 ;;
+        --out) OUT_DIR="$2"; shift 2 ;;
+        --keep-veth) KEEP_VETH=1; shift ;;
+        -h|--help) usage; exit 0 ;;
+        *) echo "Unknown option: $1"; usage; exit 1 ;;
+    esac
+done
+
+if [ -z "${PROBE}" ]; then
+    usage
+    exit 1
+fi
+if [ "$(id -u)" -ne 0 ]; then
+    echo "This test needs root to create veth interfaces and qdiscs"
+    exit 1
+fi
+
+mkdir -p "${OUT_DIR}"
+OUT_DIR="$(cd "${OUT_DIR}" && pwd)"
+RESULTS_JSON="${OUT_DIR}/results.jsonl"
+RESULTS_CSV="${OUT_DIR}/results.csv"
+
+teardown() {
+    if [ ${KEEP_VETH} -eq 0 ]; then
+        ip link del "${VETH_TX}" 2>/dev/null
+    fi
+}
+trap teardown EXIT INT TERM
+
+ip link del "${VETH_TX}" 2>/dev/null
+ip link add "${VETH_TX}" numtxqueues 4 numrxqueues 4 type veth peer name "${VETH_RX}" || exit 1
+for dev in "${VETH_TX}" "${VETH_RX}"; do
+    sysctl -qw "net.ipv6.conf.${dev}.disable_ipv6=1" 2>/dev/null
+    ip link set "${dev}" up || exit 1
+done
+
+# Priority 3 (class A) to TC 0 on queue 0 with ETF; the rest to TC 1 on queue 1
+if ! tc qdisc replace dev "${VETH_TX}" parent root handle 100 mqprio num_tc 2 \
+        map 1 1 1 0 1 1 1 1 1 1 1 1 1 1 1 1 queues 1@0 1@1 hw 0 \
+    || ! tc qdisc replace dev "${VETH_TX}" parent 100:1 etf \
+        clockid CLOCK_TAI delta "${DELTA_NSEC}"; then
+    echo "Could not set up mqprio and etf on ${VETH_TX}; sch_mqprio and sch_etf are needed"
+    exit 1
+fi
+tc qdisc show dev "${VETH_TX}" > "${OUT_DIR}/qdisc.txt"
+
+FAILED=0
+for BACKEND in ${BACKENDS}; do
+    for RUN in immediate_b1 "immediate_b${BATCH}" "launch_b${BATCH}"; do
+        case "${RUN}" in
+            immediate_b1) ARGS="-b 1" ;;
+            immediate_*) ARGS="-b ${BATCH}" ;;
+            launch_*) ARGS="-L -b ${BATCH}" ;;
+        esac
+        LABEL="${BACKEND}_${RUN}"
+        # shellcheck disable=SC2086
+        "${PROBE}" -i "${VETH_TX}" -r "${VETH_RX}" -m "${BACKEND}" ${ARGS} \
+            -n "${FRAMES}" -p "${INTERVAL_USEC}" -d "${LEAD_USEC}" -P 3 \
+            -l "${LABEL}" -c "${RESULTS_CSV}" > "${OUT_DIR}/${LABEL}.json" 2> "${OUT_DIR}/${LABEL}.log"
+        PROBE_RC=$?
+
+        MISSED=$(grep -o '"launch_missed": [0-9]*' "${OUT_DIR}/${LABEL}.json" | awk '{ print $2 }')
+        LOST=$(grep -o '"lost": [0-9]*' "${OUT_DIR}/${LABEL}.json" | awk '{ print $2 }')
+        if [ ${PROBE_RC} -ne 0 ]; then
+            FAILED=1
+        elif [ "${RUN#launch}" != "${RUN}" ] && [ "${MISSED:-0}" -ne 0 -o "${LOST:-0}" -ne 0 ]; then
+            FAILED=1
+        fi
+
+        {
+            printf '{"run": "%s", "backend": "%s", "probe_rc": %d, "probe": ' "${RUN}" "${BACKEND}" "${PROBE_RC}"
+            tr -d '\n' < "${OUT_DIR}/${LABEL}.json"
+            printf '}\n'
+        } >> "${RESULTS_JSON}"
+
+        echo "${LABEL}: $(grep -o '"lost": [0-9]*, "duplicates": [0-9]*, "launch_missed": [0-9]*' "${OUT_DIR}/${LABEL}.json")" \
+             "$(grep -o '"arrival_error_usec": {[^}]*}, "jitter_p1_p99_usec": [-0-9.]*' "${OUT_DIR}/${LABEL}.json")"
+    done
+done
+
+exit ${FAILED}
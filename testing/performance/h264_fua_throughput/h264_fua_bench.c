@@ -0,0 +1,406 @@
+/**
+ * H.264 Mapping Packetization Throughput Benchmark
+ *
+ * Measures the cost of carrying an H.264 elementary stream through the
+ * packetization code of the avtp_pipeline H.264 mapping (map_h264), without
+ * any network in the way. The stream is read from an Annex B file (for example
+ * a 4K capture, see README.md) and split into access units. Every access unit
+ * is then sent through two paths, each pass over the file timed separately
+ * for TX and RX:
+ *
+ *  - in_map: access unit mode of the mapping. TX writes single NAL unit and
+ *    FU-A payloads straight into a frame buffer behind the AVTP header. RX
+ *    rebuilds the access unit from the frames into one contiguous buffer.
+ *  - per_item: fragment mode as used by intf_h264_gst. The interface writes
+ *    each payload into its own media queue item and the mapping copies it into
+ *    the frame. On RX the mapping copies each payload into an item and the
+ *    interface rebuilds the access unit from the items.
+ *
+ * Both paths use openavb_h264_fua.c from the mapping, so the difference is the
+ * extra copy and the item churn of the per_item path. An untimed first pass
+ * checks that every rebuilt access unit matches the input.
+ *
+ * Results are written as a single JSON object on stdout (and optionally CSV
+ * rows).
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <getopt.h>
+#include <arpa/inet.h>
+
+#include "openavb_h264_fua.h"
+
+// AVTP header plus H.264 mapping header, as in openavb_map_h264.c
+#define MAP_HEADER_SIZE             28
+#define MAP_STREAM_DATA_LEN16       20
+#define MAP_M0_BYTE                 22
+#define MAP_H264_TIMESTAMP32        24
+#define MAP_MAX_PAYLOAD_SIZE        1416
+
+#define PER_ITEM_COUNT              20
+
+typedef struct {
+    uint32_t offset;
+    uint32_t len;
+} access_unit_t;
+
+typedef struct {
+    const char *name;
+    uint64_t packets;
+    uint64_t bytes;
+    double txSec;
+    double rxSec;
+    uint32_t mismatches;
+} path_result_t;
+
+static uint8_t *fileData;
+static uint32_t fileLen;
+static access_unit_t *aus;
+static uint32_t auCount;
+static uint32_t maxAuLen;
+
+static uint8_t *frames;         // all frames of one access unit
+static uint32_t *frameLens;
+static uint32_t maxFrames;
+static uint8_t *items;          // per_item media queue items
+static uint8_t *rxBuf;
+static uint8_t *expected;       // input access unit with 4 byte start codes
+
+static double nowSec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Offset just past the next 0x000001 at or after pos, fileLen if none
+static uint32_t nextStartCode(uint32_t pos)
+{
+    for (pos += 2; pos < fileLen; pos++) {
+        const uint8_t *p = memchr(fileData + pos, 0x01, fileLen - pos);
+        if (!p) {
+            break;
+        }
+        pos = p - fileData;
+        if (fileData[pos - 1] == 0x00 && fileData[pos - 2] == 0x00) {
+            return pos + 1;
+        }
+    }
+    return fileLen;
+}
+
+// Split the file into access units (ITU-T H.264 7.4.1.2.3): a new access unit
+// starts with an access unit delimiter, SEI, SPS, PPS or types 14-18 after a
+// slice, or with a slice whose first_mb_in_slice is 0.
+static bool splitAccessUnits(void)
+{
+    uint32_t cap = 1024;
+    uint32_t auStart = 0;
+    bool haveSlice = false;
+    uint32_t nal = (fileLen > 0) ? nextStartCode(0) : fileLen;
+
+    aus = malloc(cap * sizeof(*aus));
+    if (!aus) {
+        return false;
+    }
+    if (nal < fileLen) {
+        auStart = nal - 3;
+    }
+
+    while (nal < fileLen) {
+        uint32_t next = nextStartCode(nal);
+        uint8_t type = fileData[nal] & 0x1F;
+        bool slice = (type == 1 || type == 5);
+        bool firstMb = slice && nal + 1 < fileLen && (fileData[nal + 1] & 0x80);
+        bool startsAu = (type == 9 || type == 6 || type == 7 || type == 8 || (type >= 14 && type <= 18) || firstMb);
+
+        if (haveSlice && startsAu) {
+            uint32_t start = nal - 3;
+            if (auCount == cap) {
+                cap *= 2;
+                aus = realloc(aus, cap * sizeof(*aus));
+                if (!aus) {
+                    return false;
+                }
+            }
+            aus[auCount].offset = auStart;
+            aus[auCount].len = start - auStart;
+            auCount++;
+            auStart = start;
+            haveSlice = false;
+        }
+        if (slice) {
+            haveSlice = true;
+        }
+        nal = next;
+    }
+
+    if (fileLen > auStart) {
+        if (auCount == cap) {
+            aus = realloc(aus, (cap + 1) * sizeof(*aus));
+            if (!aus) {
+                return false;
+            }
+        }
+        aus[auCount].offset = auStart;
+        aus[auCount].len = fileLen - auStart;
+        auCount++;
+    }
+
+    for (uint32_t i = 0; i < auCount; i++) {
+        if (aus[i].len > maxAuLen) {
+            maxAuLen = aus[i].len;
+        }
+    }
+    return auCount > 0;
+}
+
+// Expected reassembler output: the NAL units of the access unit, each behind 0x00000001
+static uint32_t normalize(const access_unit_t *au, uint8_t *pDst)
+{
+    openavb_h264_fua_tx_t tx;
+    uint32_t len = 0;
+
+    // Reuse the packetizer's NAL unit walk with a payload size no NAL unit exceeds
+    openavbH264FuaTxStart(&tx, fileData + au->offset, au->len);
+    while (!openavbH264FuaTxDone(&tx)) {
+        bool last;
+        memcpy(pDst + len, "\x00\x00\x00\x01", 4);
+        len += 4 + openavbH264FuaTxNext(&tx, pDst + len + 4, au->len + 3, &last);
+    }
+    return len;
+}
+
+static void setHeader(uint8_t *pFrame, uint32_t payloadLen, bool last, uint32_t timestamp)
+{
+    *(uint16_t *)(pFrame + MAP_STREAM_DATA_LEN16) = htons(payloadLen + 4);
+    pFrame[MAP_M0_BYTE] = last ? 0x10 : 0x00;
+    *(uint32_t *)(pFrame + MAP_H264_TIMESTAMP32) = htonl(timestamp);
+}
+
+static uint32_t payloadLenOf(const uint8_t *pFrame)
+{
+    return ntohs(*(const uint16_t *)(pFrame + MAP_STREAM_DATA_LEN16)) - 4;
+}
+
+// Frames of the access unit go to frames[], like consecutive TX callbacks
+static uint32_t txInMap(const access_unit_t *au, uint32_t maxPayload, uint32_t timestamp)
+{
+    openavb_h264_fua_tx_t tx;
+    uint32_t n = 0;
+    bool last = false;
+
+    openavbH264FuaTxStart(&tx, fileData + au->offset, au->len);
+    while (!last && n < maxFrames) {
+        uint8_t *pFrame = frames + (size_t)n * (MAP_HEADER_SIZE + maxPayload);
+        uint32_t len = openavbH264FuaTxNext(&tx, pFrame + MAP_HEADER_SIZE, maxPayload, &last);
+        if (len == 0) {
+            break;
+        }
+        setHeader(pFrame, len, last, timestamp);
+        frameLens[n++] = len + MAP_HEADER_SIZE;
+    }
+    return n;
+}
+
+static uint32_t txPerItem(const access_unit_t *au, uint32_t maxPayload, uint32_t timestamp)
+{
+    openavb_h264_fua_tx_t tx;
+    uint32_t n = 0;
+    bool last = false;
+
+    openavbH264FuaTxStart(&tx, fileData + au->offset, au->len);
+    while (!last && n < maxFrames) {
+        // Interface: one payload per item
+        uint8_t *pItem = items + (size_t)(n % PER_ITEM_COUNT) * maxPayload;
+        uint32_t len = openavbH264FuaTxNext(&tx, pItem, maxPayload, &last);
+        if (len == 0) {
+            break;
+        }
+        // Mapping: copy the item into the frame
+        uint8_t *pFrame = frames + (size_t)n * (MAP_HEADER_SIZE + maxPayload);
+        setHeader(pFrame, len, last, timestamp);
+        memcpy(pFrame + MAP_HEADER_SIZE, pItem, len);
+        frameLens[n++] = len + MAP_HEADER_SIZE;
+    }
+    return n;
+}
+
+static uint32_t rxInMap(uint32_t n, uint32_t maxPayload, uint32_t *pStatus)
+{
+    openavb_h264_fua_rx_t rx;
+
+    openavbH264FuaRxStart(&rx, rxBuf, maxAuLen * 2 + 64);
+    for (uint32_t i = 0; i < n; i++) {
+        const uint8_t *pFrame = frames + (size_t)i * (MAP_HEADER_SIZE + maxPayload);
+        openavbH264FuaRxAdd(&rx, pFrame + MAP_HEADER_SIZE, payloadLenOf(pFrame));
+    }
+    return openavbH264FuaRxEnd(&rx, pStatus);
+}
+
+static uint32_t rxPerItem(uint32_t n, uint32_t maxPayload, uint32_t *pStatus)
+{
+    openavb_h264_fua_rx_t rx;
+
+    openavbH264FuaRxStart(&rx, rxBuf, maxAuLen * 2 + 64);
+    for (uint32_t i = 0; i < n; i++) {
+        // Mapping: copy the payload into an item
+        const uint8_t *pFrame = frames + (size_t)i * (MAP_HEADER_SIZE + maxPayload);
+        uint8_t *pItem = items + (size_t)(i % PER_ITEM_COUNT) * maxPayload;
+        uint32_t len = payloadLenOf(pFrame);
+        memcpy(pItem, pFrame + MAP_HEADER_SIZE, len);
+        // Interface: rebuild the access unit from the items
+        openavbH264FuaRxAdd(&rx, pItem, len);
+    }
+    return openavbH264FuaRxEnd(&rx, pStatus);
+}
+
+// Pass 0 checks the output and warms up the buffers, the other passes are timed
+static void runPath(path_result_t *res, bool inMap, uint32_t maxPayload, uint32_t passes)
+{
+    for (uint32_t pass = 0; pass <= passes; pass++) {
+        for (uint32_t i = 0; i < auCount; i++) {
+            uint32_t status;
+            double t0 = nowSec();
+            uint32_t n = inMap ? txInMap(&aus[i], maxPayload, i * 3000) : txPerItem(&aus[i], maxPayload, i * 3000);
+            double t1 = nowSec();
+            uint32_t len = inMap ? rxInMap(n, maxPayload, &status) : rxPerItem(n, maxPayload, &status);
+            double t2 = nowSec();
+
+            if (pass == 0) {
+                uint32_t expLen = normalize(&aus[i], expected);
+                if (status != H264_AU_OK || len != expLen || memcmp(rxBuf, expected, len) != 0) {
+                    res->mismatches++;
+                }
+                continue;
+            }
+
+            res->txSec += t1 - t0;
+            res->rxSec += t2 - t1;
+            res->packets += n;
+            res->bytes += aus[i].len;
+        }
+    }
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+        "Usage: %s -f FILE [options]\n"
+        "  -f FILE   H.264 Annex B elementary stream\n"
+        "  -p BYTES  Max RTP payload per packet (default %d)\n"
+        "  -n N      Timed passes over the file (default 10)\n"
+        "  -l LABEL  Label for the results (default file name)\n"
+        "  -c FILE   Append CSV rows to FILE\n",
+        prog, MAP_MAX_PAYLOAD_SIZE);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *fileName = NULL;
+    const char *label = NULL;
+    const char *csvFile = NULL;
+    uint32_t maxPayload = MAP_MAX_PAYLOAD_SIZE;
+    uint32_t passes = 10;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "f:p:n:l:c:h")) != -1) {
+        switch (opt) {
+            case 'f': fileName = optarg; break;
+            case 'p': maxPayload = strtoul(optarg, NULL, 0); break;
+            case 'n': passes = strtoul(optarg, NULL, 0); break;
+            case 'l': label = optarg; break;
+            case 'c': csvFile = optarg; break;
+            default: usage(argv[0]); return 2;
+        }
+    }
+    if (!fileName || maxPayload <= H264_FU_A_HEADER_SIZE || maxPayload > 9000 || passes == 0) {
+        usage(argv[0]);
+        return 2;
+    }
+    if (!label) {
+        label = fileName;
+    }
+
+    FILE *f = fopen(fileName, "rb");
+    if (!f) {
+        perror(fileName);
+        return 2;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    fileData = (size > 0) ? malloc(size) : NULL;
+    if (!fileData || fread(fileData, 1, size, f) != (size_t)size) {
+        fprintf(stderr, "Unable to read %s\n", fileName);
+        fclose(f);
+        return 2;
+    }
+    fclose(f);
+    fileLen = size;
+
+    if (!splitAccessUnits()) {
+        fprintf(stderr, "No access units in %s\n", fileName);
+        return 2;
+    }
+
+    // Worst case: every byte in FU-A fragments, plus one packet per NAL unit
+    maxFrames = maxAuLen / (maxPayload - H264_FU_A_HEADER_SIZE) + maxAuLen / 4 + 2;
+    frames = malloc((size_t)maxFrames * (MAP_HEADER_SIZE + maxPayload));
+    frameLens = malloc(maxFrames * sizeof(*frameLens));
+    items = malloc((size_t)PER_ITEM_COUNT * maxPayload);
+    rxBuf = malloc(maxAuLen * 2 + 64);
+    expected = malloc(maxAuLen * 2 + 64);
+    if (!frames || !frameLens || !items || !rxBuf || !expected) {
+        fprintf(stderr, "Out of memory\n");
+        return 2;
+    }
+
+    path_result_t results[2] = { { .name = "in_map" }, { .name = "per_item" } };
+    runPath(&results[0], true, maxPayload, passes);
+    runPath(&results[1], false, maxPayload, passes);
+
+    bool ok = true;
+    printf("{\"label\": \"%s\", \"file_bytes\": %u, \"access_units\": %u, \"max_au_bytes\": %u, "
+        "\"max_payload\": %u, \"passes\": %u, \"paths\": {",
+        label, fileLen, auCount, maxAuLen, maxPayload, passes);
+    for (int i = 0; i < 2; i++) {
+        path_result_t *r = &results[i];
+        printf("%s\"%s\": {\"packets\": %" PRIu64 ", \"bytes\": %" PRIu64 ", \"mismatches\": %u, "
+            "\"tx_gbps\": %.2f, \"rx_gbps\": %.2f, \"tx_ns_per_packet\": %.1f, \"rx_ns_per_packet\": %.1f}",
+            i ? ", " : "", r->name, r->packets, r->bytes, r->mismatches,
+            r->bytes * 8 / r->txSec / 1e9, r->bytes * 8 / r->rxSec / 1e9,
+            r->txSec * 1e9 / r->packets, r->rxSec * 1e9 / r->packets);
+        if (r->mismatches) {
+            ok = false;
+        }
+    }
+    printf("}, \"ok\": %s}\n", ok ? "true" : "false");
+
+    if (csvFile) {
+        FILE *csv = fopen(csvFile, "a");
+        if (csv) {
+            if (ftell(csv) == 0) {
+                fprintf(csv, "label,path,access_units,packets,bytes,mismatches,tx_gbps,rx_gbps,tx_ns_per_packet,rx_ns_per_packet\n");
+            }
+            for (int i = 0; i < 2; i++) {
+                path_result_t *r = &results[i];
+                fprintf(csv, "%s,%s,%u,%" PRIu64 ",%" PRIu64 ",%u,%.2f,%.2f,%.1f,%.1f\n",
+                    label, r->name, auCount, r->packets, r->bytes, r->mismatches,
+                    r->bytes * 8 / r->txSec / 1e9, r->bytes * 8 / r->rxSec / 1e9,
+                    r->txSec * 1e9 / r->packets, r->rxSec * 1e9 / r->packets);
+            }
+            fclose(csv);
+        }
+    }
+
+    return ok ? 0 : 1;
+}
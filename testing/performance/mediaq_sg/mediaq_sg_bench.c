@@ -0,0 +1,636 @@
+/**
+ * Media Queue Scatter-Gather Benchmark
+ *
+ * Measures the memory footprint and CPU cost of the talker side of the
+ * avtp_pipeline media queue (mediaq/openavb_mediaq.c, linked as is) for MJPEG
+ * and H.264 video. Each video frame goes from an encoder output buffer through
+ * the media queue into AVTP payloads, with the queue holding a fixed number of
+ * frames, in three ways:
+ *
+ *  - copy_fragment: one payload per item, as intf_mjpeg_gst and intf_h264_gst
+ *    did before. The interface copies each payload into an item and the
+ *    mapping copies it into the frame. Items are payload sized but there is
+ *    one per packet of every buffered frame.
+ *  - copy_frame: one frame per item, copied into the item by the interface.
+ *    Every item has to be as big as the largest frame.
+ *  - by_ref: one frame per item, added by reference with
+ *    openavbMediaQBufWrap() and openavbMediaQItemAddSeg() to items of size 0.
+ *    The mapping copies each payload straight from the frame buffer with
+ *    openavbMediaQItemCopy(). The buffer is released when the item is pulled.
+ *
+ * Frames come from an MJPEG (concatenated JPEG) or H.264 Annex B file, or are
+ * generated with the frame size pattern of the stream type. An untimed first
+ * pass checks every payload against the input.
+ *
+ * Results are written as a single JSON object on stdout (and optionally CSV
+ * rows).
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <string.h>
+#include <time.h>
+#include <getopt.h>
+
+#include "openavb_types_pub.h"
+#include "openavb_avtp_time_pub.h"
+#include "openavb_time_osal_pub.h"
+#include "openavb_mediaq_pub.h"
+#include "openavb_arena.h"
+
+#define DEFAULT_PAYLOAD             1400
+#define DEFAULT_DEPTH               4
+#define DEFAULT_PASSES              10
+#define DEFAULT_SYNTH_FRAMES        300
+#define MJPEG_SYNTH_FRAME_BYTES     400000      // 1080p MJPEG, quality ~85
+#define H264_SYNTH_FRAME_BYTES      170000      // 40 Mbit/s at 30 fps
+#define H264_SYNTH_GOP              30
+
+// Size of an item in the media queue, with its private segment list
+#define ITEM_BYTES  (sizeof(media_q_item_t) + sizeof(uint32_t) \
+                     + MEDIAQ_ITEM_MAX_SEGS * (sizeof(void *) + 2 * sizeof(uint32_t)))
+
+typedef enum {
+    MODE_COPY_FRAGMENT,
+    MODE_COPY_FRAME,
+    MODE_BY_REF,
+    MODE_COUNT
+} bench_mode_t;
+
+static const char *modeNames[MODE_COUNT] = { "copy_fragment", "copy_frame", "by_ref" };
+
+typedef struct {
+    const uint8_t *data;
+    uint32_t len;
+} frame_t;
+
+typedef struct {
+    uint32_t itemCount;
+    uint32_t itemSize;
+    uint64_t queueBytes;
+    uint64_t peakRefBytes;
+    uint64_t packets;
+    uint64_t bytes;
+    double sec;
+    uint32_t mismatches;
+    uint32_t queueFull;
+} mode_result_t;
+
+static uint8_t *streamData;
+static uint32_t streamLen;
+static frame_t *frames;
+static uint32_t frameCount;
+static uint32_t maxFrameLen;
+
+static uint32_t payloadMax = DEFAULT_PAYLOAD;
+static uint32_t depth = DEFAULT_DEPTH;
+static uint8_t packet[65536];
+
+// By-reference buffers currently held by the media queue
+static uint64_t refBytes;
+static uint64_t peakRefBytes;
+
+/////////////////////////////////////////////////////////////////////////////
+// The rest of the avtp_pipeline is not linked; the media queue only needs
+// these to build and to check timestamps, which this benchmark ignores.
+/////////////////////////////////////////////////////////////////////////////
+
+void avbLogFn(int level, const char *tag, const char *company, const char *component,
+              const char *path, int line, const char *fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    fprintf(stderr, "%s %s: ", tag, component);
+    vfprintf(stderr, fmt, args);
+    fputc('\n', stderr);
+    va_end(args);
+}
+
+avtp_time_t *openavbAvtpTimeCreate(U32 maxLatencyUsec)
+{
+    return calloc(1, sizeof(avtp_time_t));
+}
+
+void openavbAvtpTimeDelete(avtp_time_t *pAvtpTime)
+{
+    free(pAvtpTime);
+}
+
+bool openavbAvtpTimeIsPast(avtp_time_t *pAvtpTime)
+{
+    return TRUE;
+}
+
+bool openavbAvtpTimeIsPastTime(avtp_time_t *pAvtpTime, U64 nSecTime)
+{
+    return TRUE;
+}
+
+bool openavbAvtpTimeUsecTill(avtp_time_t *pAvtpTime, U32 *pUsecTill)
+{
+    *pUsecTill = 0;
+    return TRUE;
+}
+
+S32 openavbAvtpTimeUsecDelta(avtp_time_t *pAvtpTime)
+{
+    return 0;
+}
+
+bool osalClockGettime64(openavb_clockId_t openavbClockId, U64 *timeNsec)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    *timeNsec = (U64)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+    return TRUE;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+static double nowSec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static bool addFrame(uint32_t *pCap, const uint8_t *data, uint32_t len)
+{
+    if (len == 0) {
+        return true;
+    }
+    if (frameCount == *pCap) {
+        frame_t *p = realloc(frames, 2 * *pCap * sizeof(*frames));
+        if (!p) {
+            return false;
+        }
+        frames = p;
+        *pCap *= 2;
+    }
+    frames[frameCount].data = data;
+    frames[frameCount].len = len;
+    frameCount++;
+    if (len > maxFrameLen) {
+        maxFrameLen = len;
+    }
+    return true;
+}
+
+// MJPEG: a frame starts at each SOI marker followed by another marker
+static bool splitMjpeg(uint32_t *pCap)
+{
+    uint32_t start = 0;
+    uint32_t pos = 0;
+
+    while (pos + 2 < streamLen) {
+        const uint8_t *p = memchr(streamData + pos, 0xFF, streamLen - 2 - pos);
+        if (!p) {
+            break;
+        }
+        pos = p - streamData;
+        if (p[1] == 0xD8 && p[2] == 0xFF && pos > start) {
+            if (!addFrame(pCap, streamData + start, pos - start)) {
+                return false;
+            }
+            start = pos;
+        }
+        pos++;
+    }
+    return addFrame(pCap, streamData + start, streamLen - start);
+}
+
+// Offset just past the next 0x000001 at or after pos, streamLen if none
+static uint32_t nextStartCode(uint32_t pos)
+{
+    for (pos += 2; pos < streamLen; pos++) {
+        const uint8_t *p = memchr(streamData + pos, 0x01, streamLen - pos);
+        if (!p) {
+            break;
+        }
+        pos = p - streamData;
+        if (streamData[pos - 1] == 0x00 && streamData[pos - 2] == 0x00) {
+            return pos + 1;
+        }
+    }
+    return streamLen;
+}
+
+// H.264: a frame (access unit) starts with an access unit delimiter, SEI or
+// parameter set after a slice, or with a slice whose first_mb_in_slice is 0
+static bool splitH264(uint32_t *pCap)
+{
+    uint32_t start = 0;
+    bool haveSlice = false;
+    uint32_t nal = nextStartCode(0);
+
+    while (nal < streamLen) {
+        uint8_t type = streamData[nal] & 0x1F;
+        uint32_t nalStart = (nal >= 4 && streamData[nal - 4] == 0x00) ? nal - 4 : nal - 3;
+        bool slice = (type == 1 || type == 5);
+        bool newAu = false;
+
+        if (slice) {
+            // first_mb_in_slice is ue(v); a leading 1 bit codes 0
+            newAu = haveSlice && nal + 1 < streamLen && (streamData[nal + 1] & 0x80);
+        }
+        else if (type >= 6 && type <= 9) {
+            newAu = haveSlice;
+        }
+        if (newAu) {
+            if (!addFrame(pCap, streamData + start, nalStart - start)) {
+                return false;
+            }
+            start = nalStart;
+            haveSlice = false;
+        }
+        haveSlice = haveSlice || slice;
+        nal = nextStartCode(nal);
+    }
+    return addFrame(pCap, streamData + start, streamLen - start);
+}
+
+static bool loadFile(const char *path, bool h264)
+{
+    FILE *f = fopen(path, "rb");
+    uint32_t cap = 1024;
+
+    if (!f) {
+        perror(path);
+        return false;
+    }
+    fseek(f, 0, SEEK_END);
+    long len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    if (len <= 0 || len > 0x7FFFFFFF) {
+        fprintf(stderr, "%s: bad file size\n", path);
+        fclose(f);
+        return false;
+    }
+    streamLen = (uint32_t)len;
+    streamData = malloc(streamLen);
+    if (!streamData || fread(streamData, 1, streamLen, f) != streamLen) {
+        fprintf(stderr, "%s: read failed\n", path);
+        fclose(f);
+        return false;
+    }
+    fclose(f);
+
+    frames = malloc(cap * sizeof(*frames));
+    if (!frames) {
+        return false;
+    }
+    return h264 ? splitH264(&cap) : splitMjpeg(&cap);
+}
+
+// Frame sizes of the stream type, random content. MJPEG frames are all of
+// about the same size; H.264 has an I frame 8 times the size of the P frames
+// every GOP.
+static bool synthesize(bool h264, uint32_t count, uint32_t meanLen)
+{
+    uint32_t cap = count;
+    uint32_t seed = 12345;
+    uint64_t total = 0;
+    uint32_t *lens = malloc(count * sizeof(*lens));
+    uint32_t i;
+
+    frames = malloc(cap * sizeof(*frames));
+    if (!lens || !frames) {
+        free(lens);
+        return false;
+    }
+    for (i = 0; i < count; i++) {
+        double scale;
+        seed = seed * 1103515245 + 12345;
+        scale = 0.75 + ((seed >> 16) & 0x7FFF) / 65536.0;      // 0.75 .. 1.25
+        if (h264) {
+            // mean of one 8x frame and GOP-1 1x frames is meanLen
+            double pLen = meanLen * (double)H264_SYNTH_GOP / (H264_SYNTH_GOP + 7);
+            scale *= (i % H264_SYNTH_GOP == 0) ? 8 * pLen / meanLen : pLen / meanLen;
+        }
+        lens[i] = (uint32_t)(meanLen * scale);
+        total += lens[i];
+    }
+    if (total > 0x7FFFFFFF) {
+        free(lens);
+        return false;
+    }
+
+    streamLen = (uint32_t)total;
+    streamData = malloc(streamLen);
+    if (!streamData) {
+        free(lens);
+        return false;
+    }
+    for (i = 0; i < streamLen; i++) {
+        seed = seed * 1103515245 + 12345;
+        streamData[i] = seed >> 24;
+    }
+    total = 0;
+    for (i = 0; i < count; i++) {
+        addFrame(&cap, streamData + total, lens[i]);
+        total += lens[i];
+    }
+    free(lens);
+    return true;
+}
+
+static uint32_t packetsOf(uint32_t len)
+{
+    return (len + payloadMax - 1) / payloadMax;
+}
+
+static void releaseFrame(void *pData, void *pCtx)
+{
+    refBytes -= (uintptr_t)pCtx;
+}
+
+// Interface side: put frame f in the queue. FALSE if the queue was full.
+static bool produce(media_q_t *pMediaQ, bench_mode_t mode, uint32_t f)
+{
+    const frame_t *pFrame = &frames[f];
+    media_q_item_t *pItem;
+
+    if (mode == MODE_COPY_FRAGMENT) {
+        uint32_t off;
+        for (off = 0; off < pFrame->len; off += payloadMax) {
+            uint32_t len = pFrame->len - off < payloadMax ? pFrame->len - off : payloadMax;
+            pItem = openavbMediaQHeadLock(pMediaQ);
+            if (!pItem) {
+                return FALSE;
+            }
+            memcpy(pItem->pPubData, pFrame->data + off, len);
+            pItem->dataLen = len;
+            openavbMediaQHeadPush(pMediaQ);
+        }
+        return TRUE;
+    }
+
+    pItem = openavbMediaQHeadLock(pMediaQ);
+    if (!pItem) {
+        return FALSE;
+    }
+    if (mode == MODE_COPY_FRAME) {
+        memcpy(pItem->pPubData, pFrame->data, pFrame->len);
+        pItem->dataLen = pFrame->len;
+    }
+    else {
+        media_q_buf_t *pBuf = openavbMediaQBufWrap((void *)pFrame->data, pFrame->len,
+                                                   releaseFrame, (void *)(uintptr_t)pFrame->len);
+        if (!pBuf || !openavbMediaQItemAddSeg(pItem, pBuf, 0, pFrame->len)) {
+            openavbMediaQBufUnref(pBuf);
+            openavbMediaQHeadUnlock(pMediaQ);
+            return FALSE;
+        }
+        openavbMediaQBufUnref(pBuf);
+        refBytes += pFrame->len;
+        if (refBytes > peakRefBytes) {
+            peakRefBytes = refBytes;
+        }
+    }
+    openavbMediaQHeadPush(pMediaQ);
+    return TRUE;
+}
+
+// Mapping side: turn frame f into payloads
+static void consume(media_q_t *pMediaQ, bench_mode_t mode, uint32_t f, bool verify, mode_result_t *pRes)
+{
+    const frame_t *pFrame = &frames[f];
+    uint32_t off = 0;
+
+    if (mode == MODE_COPY_FRAGMENT) {
+        uint32_t n;
+        for (n = packetsOf(pFrame->len); n > 0; n--) {
+            media_q_item_t *pItem = openavbMediaQTailLock(pMediaQ, TRUE);
+            uint32_t len;
+            if (!pItem) {
+                pRes->mismatches++;
+                return;
+            }
+            len = openavbMediaQItemCopy(pItem, 0, packet, pItem->dataLen);
+            if (verify && (off + len > pFrame->len || memcmp(packet, pFrame->data + off, len) != 0)) {
+                pRes->mismatches++;
+            }
+            off += len;
+            pRes->packets++;
+            openavbMediaQTailPull(pMediaQ);
+        }
+    }
+    else {
+        media_q_item_t *pItem = openavbMediaQTailLock(pMediaQ, TRUE);
+        if (!pItem) {
+            pRes->mismatches++;
+            return;
+        }
+        while (off < pItem->dataLen) {
+            uint32_t len = openavbMediaQItemCopy(pItem, off, packet, payloadMax);
+            if (verify && memcmp(packet, pFrame->data + off, len) != 0) {
+                pRes->mismatches++;
+            }
+            off += len;
+            pRes->packets++;
+        }
+        openavbMediaQTailPull(pMediaQ);
+    }
+    if (verify && off != pFrame->len) {
+        pRes->mismatches++;
+    }
+    pRes->bytes += off;
+}
+
+// Run all frames through the queue, keeping depth frames buffered
+static bool runPass(media_q_t *pMediaQ, bench_mode_t mode, bool verify, mode_result_t *pRes)
+{
+    uint32_t f;
+
+    for (f = 0; f < frameCount; f++) {
+        if (!produce(pMediaQ, mode, f)) {
+            pRes->queueFull++;
+            return false;
+        }
+        if (f + 1 >= depth) {
+            consume(pMediaQ, mode, f + 1 - depth, verify, pRes);
+        }
+    }
+    for (f = frameCount >= depth ? frameCount - depth + 1 : 0; f < frameCount; f++) {
+        consume(pMediaQ, mode, f, verify, pRes);
+    }
+    return true;
+}
+
+static bool runMode(bench_mode_t mode, uint32_t passes, mode_result_t *pRes)
+{
+    media_q_t *pMediaQ = openavbMediaQCreate();
+    uint32_t i;
+    bool ok;
+
+    memset(pRes, 0, sizeof(*pRes));
+    if (!pMediaQ) {
+        return false;
+    }
+
+    switch (mode) {
+        case MODE_COPY_FRAGMENT:
+            pRes->itemCount = depth * packetsOf(maxFrameLen);
+            pRes->itemSize = payloadMax;
+            break;
+        case MODE_COPY_FRAME:
+            pRes->itemCount = depth;
+            pRes->itemSize = maxFrameLen;
+            break;
+        default:
+            pRes->itemCount = depth;
+            pRes->itemSize = 0;
+            break;
+    }
+    if (pRes->itemSize ? !openavbMediaQSetSize(pMediaQ, pRes->itemCount, pRes->itemSize)
+                       : !openavbMediaQSetSizeByRef(pMediaQ, pRes->itemCount)) {
+        openavbMediaQDelete(pMediaQ);
+        return false;
+    }
+    // Same layout as openavbMediaQSetSize()
+    pRes->queueBytes = OPENAVB_ARENA_ALIGN((uint64_t)pRes->itemCount * ITEM_BYTES)
+        + (uint64_t)pRes->itemCount * (pRes->itemSize ? OPENAVB_ARENA_ALIGN(pRes->itemSize + 4) : 0);
+
+    refBytes = peakRefBytes = 0;
+    ok = runPass(pMediaQ, mode, true, pRes);
+    pRes->peakRefBytes = peakRefBytes;
+
+    if (ok) {
+        uint32_t mismatches = pRes->mismatches;
+        double t0;
+
+        pRes->packets = pRes->bytes = 0;
+        t0 = nowSec();
+        for (i = 0; i < passes && ok; i++) {
+            ok = runPass(pMediaQ, mode, false, pRes);
+        }
+        pRes->sec = nowSec() - t0;
+        pRes->mismatches = mismatches;
+    }
+
+    openavbMediaQDelete(pMediaQ);
+    if (refBytes != 0) {
+        // A reference was leaked
+        pRes->mismatches++;
+    }
+    return ok;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+        "Usage: %s -t mjpeg|h264 [-f file] [options]\n"
+        "  -t TYPE    Stream type, mjpeg or h264\n"
+        "  -f FILE    MJPEG (concatenated JPEG) or H.264 Annex B file; generated frames if omitted\n"
+        "  -F N       Generated frames (default %u)\n"
+        "  -S BYTES   Mean generated frame size (default %u mjpeg, %u h264)\n"
+        "  -p BYTES   Payload bytes per packet (default %u)\n"
+        "  -d N       Frames buffered in the media queue (default %u)\n"
+        "  -n N       Timed passes (default %u)\n"
+        "  -l LABEL   Label in the results\n"
+        "  -c FILE    Append CSV rows to FILE\n",
+        prog, DEFAULT_SYNTH_FRAMES, MJPEG_SYNTH_FRAME_BYTES, H264_SYNTH_FRAME_BYTES,
+        DEFAULT_PAYLOAD, DEFAULT_DEPTH, DEFAULT_PASSES);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *type = NULL;
+    const char *path = NULL;
+    const char *label = NULL;
+    const char *csvPath = NULL;
+    uint32_t synthFrames = DEFAULT_SYNTH_FRAMES;
+    uint32_t synthLen = 0;
+    uint32_t passes = DEFAULT_PASSES;
+    mode_result_t res[MODE_COUNT];
+    bool h264;
+    bool ok = true;
+    int opt;
+    int m;
+
+    while ((opt = getopt(argc, argv, "t:f:F:S:p:d:n:l:c:h")) != -1) {
+        switch (opt) {
+            case 't': type = optarg; break;
+            case 'f': path = optarg; break;
+            case 'F': synthFrames = strtoul(optarg, NULL, 0); break;
+            case 'S': synthLen = strtoul(optarg, NULL, 0); break;
+            case 'p': payloadMax = strtoul(optarg, NULL, 0); break;
+            case 'd': depth = strtoul(optarg, NULL, 0); break;
+            case 'n': passes = strtoul(optarg, NULL, 0); break;
+            case 'l': label = optarg; break;
+            case 'c': csvPath = optarg; break;
+            default: usage(argv[0]); return 1;
+        }
+    }
+    if (!type || (strcmp(type, "mjpeg") != 0 && strcmp(type, "h264") != 0)
+        || payloadMax == 0 || payloadMax > sizeof(packet) || depth == 0 || synthFrames == 0) {
+        usage(argv[0]);
+        return 1;
+    }
+    h264 = strcmp(type, "h264") == 0;
+    if (!synthLen) {
+        synthLen = h264 ? H264_SYNTH_FRAME_BYTES : MJPEG_SYNTH_FRAME_BYTES;
+    }
+    if (path ? !loadFile(path, h264) : !synthesize(h264, synthFrames, synthLen)) {
+        return 1;
+    }
+    if (!label) {
+        label = path ? path : (h264 ? "synthetic_h264" : "synthetic_mjpeg");
+    }
+
+    for (m = 0; m < MODE_COUNT; m++) {
+        if (!runMode((bench_mode_t)m, passes, &res[m])) {
+            fprintf(stderr, "%s: media queue setup or run failed\n", modeNames[m]);
+            ok = false;
+        }
+        ok = ok && res[m].mismatches == 0;
+    }
+
+    printf("{\"label\": \"%s\", \"type\": \"%s\", \"frames\": %u, \"stream_bytes\": %u, \"max_frame_bytes\": %u, "
+           "\"payload\": %u, \"depth\": %u, \"passes\": %u,\n \"modes\": {",
+           label, type, frameCount, streamLen, maxFrameLen, payloadMax, depth, passes);
+    for (m = 0; m < MODE_COUNT; m++) {
+        mode_result_t *r = &res[m];
+        double sec = r->sec > 0 ? r->sec : 1e-9;
+        printf("%s\n  \"%s\": {\"item_count\": %u, \"item_size\": %u, \"queue_bytes\": %" PRIu64
+               ", \"peak_ref_bytes\": %" PRIu64 ", \"mismatches\": %u, \"queue_full\": %u"
+               ", \"packets\": %" PRIu64 ", \"gbps\": %.3f, \"ns_per_packet\": %.1f, \"ns_per_frame\": %.1f}",
+               m ? "," : "", modeNames[m], r->itemCount, r->itemSize, r->queueBytes, r->peakRefBytes,
+               r->mismatches, r->queueFull, r->packets,
+               r->bytes * 8 / sec / 1e9,
+               r->packets ? sec * 1e9 / r->packets : 0.0,
+               passes ? sec * 1e9 / ((double)passes * frameCount) : 0.0);
+    }
+    printf("},\n \"ok\": %s}\n", ok ? "true" : "false");
+
+    if (csvPath) {
+        FILE *csv = fopen(csvPath, "a");
+        if (!csv) {
+            perror(csvPath);
+            return 1;
+        }
+        if (ftell(csv) == 0) {
+            fprintf(csv, "label,type,mode,frames,max_frame_bytes,payload,depth,item_count,item_size,"
+                         "queue_bytes,peak_ref_bytes,mismatches,gbps,ns_per_packet,ns_per_frame\n");
+        }
+        for (m = 0; m < MODE_COUNT; m++) {
+            mode_result_t *r = &res[m];
+            double sec = r->sec > 0 ? r->sec : 1e-9;
+            fprintf(csv, "%s,%s,%s,%u,%u,%u,%u,%u,%u,%" PRIu64 ",%" PRIu64 ",%u,%.3f,%.1f,%.1f\n",
+                    label, type, modeNames[m], frameCount, maxFrameLen, payloadMax, depth,
+                    r->itemCount, r->itemSize, r->queueBytes, r->peakRefBytes, r->mismatches,
+                    r->bytes * 8 / sec / 1e9,
+                    r->packets ? sec * 1e9 / r->packets : 0.0,
+                    passes ? sec * 1e9 / ((double)passes * frameCount) : 0.0);
+        }
+        fclose(csv);
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,493 @@
+/**
+ * mrpd Notification Decode Benchmark
+ *
+ * Compares the text notifications mrpd sends to its clients with the binary
+ * records a client gets after "N+B" (daemons/mrpd/mrpd_binary.h). The client
+ * side is examples/mrp_client/mrpdhelper.c, linked as is.
+ *
+ * The events are an even mix of MSRP Talker Advertise (SNE T:...) and
+ * Listener Ready (SJO L:D=2,...) notifications, each with its own stream ID,
+ * formatted exactly as msrp_send_notifications() formats them.
+ *
+ *  - decode: every event is decoded by mrpdhelper_parse_notification() from
+ *    text and from binary, and read in place with mrpdhelper_bin_record().
+ *    An untimed first pass checks that both formats decode to the same
+ *    notification.
+ *  - loopback: a sender thread paces the events over a UDP socket on
+ *    127.0.0.1 at a fixed rate, the way mrpd sends them (text as a full
+ *    MAX_MRPD_CMDSZ datagram, binary as one record). A receiver thread
+ *    decodes them and records its CPU time, lost datagrams and the delay from
+ *    send to decode.
+ *
+ * Results are written as a single JSON object on stdout (and optionally CSV
+ * rows).
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/resource.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "mrpd_binary.h"
+#include "mrpdhelper.h"
+
+#define MAX_MRPD_CMDSZ          1500    // as in daemons/mrpd/mrpd.h
+#define DEFAULT_RATE            10000
+#define DEFAULT_SECONDS         5
+#define DEFAULT_PASSES          20
+#define STREAM_ID_BASE          0x001b210000000000ULL
+#define STREAM_DA_BASE          0x91e0f0000000ULL
+#define REGISTRAR_MAC           0x001b21a1b2c3ULL
+
+typedef enum {
+    FMT_TEXT,
+    FMT_BINARY,
+    FMT_COUNT
+} bench_fmt_t;
+
+static const char *fmtNames[FMT_COUNT] = { "text", "binary" };
+
+typedef struct {
+    struct mrpd_bin_notify bin;
+    uint16_t textLen;
+    char text[190];
+} event_t;
+
+typedef struct {
+    double nsText;
+    double nsBinary;
+    double nsInPlace;
+    uint32_t mismatches;
+} decode_result_t;
+
+typedef struct {
+    uint32_t datagramBytes;
+    uint64_t sent;
+    uint64_t received;
+    uint64_t decodeErrors;
+    double sec;
+    double cpuSec;
+    double lagP50;
+    double lagP99;
+    double lagMax;
+} loop_result_t;
+
+typedef struct {
+    int fd;
+    uint32_t count;
+    uint64_t *sendNs;           // written by the sender before each send
+    uint64_t *lagNs;
+    volatile bool senderDone;
+    loop_result_t *res;
+} loop_ctx_t;
+
+static event_t *events;
+static uint32_t eventCount;
+static volatile uint64_t sink;
+
+static uint64_t nowNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static double threadCpuSec(void)
+{
+    struct rusage ru;
+    getrusage(RUSAGE_THREAD, &ru);
+    return ru.ru_utime.tv_sec + ru.ru_stime.tv_sec
+        + (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e6;
+}
+
+// Same text and record mrpd sends for a TalkerAdv in IN state with a QA
+// applicant (msrp_send_notifications(), mrp_encode_bin_notify())
+static void makeTalker(event_t *ev, uint64_t id)
+{
+    struct mrpd_bin_record *rec = &ev->bin.rec;
+    uint64_t da = STREAM_DA_BASE | (id & 0xffff);
+
+    ev->textLen = snprintf(ev->text, sizeof(ev->text),
+        "SNE T:S=%016" PRIx64 ",A=%012" PRIx64 ",V=%04x,Z=%d,I=%d,P=%d,L=%d R=%012" PRIx64 " QA/IN\n",
+        id, da, 2, 224, 1, 96, 125000, (uint64_t)REGISTRAR_MAC);
+
+    rec->attrib = MRPD_BIN_ATTRIB_MSRP_TALKER;
+    rec->notify = MRPD_BIN_NOTIFY_NEW;
+    rec->u.st.id = id;
+    rec->u.st.dest_mac = da;
+    rec->u.st.vid = 2;
+    rec->u.st.max_frame_size = 224;
+    rec->u.st.max_interval_frames = 1;
+    rec->u.st.priority_and_rank = 96;
+    rec->u.st.accum_latency = 125000;
+}
+
+static void makeListener(event_t *ev, uint64_t id)
+{
+    struct mrpd_bin_record *rec = &ev->bin.rec;
+
+    ev->textLen = snprintf(ev->text, sizeof(ev->text),
+        "SJO L:D=%d,S=%016" PRIx64 " R=%012" PRIx64 " QA/IN\n",
+        mrpdhelper_listener_declaration_type_ready, id, (uint64_t)REGISTRAR_MAC);
+
+    rec->attrib = MRPD_BIN_ATTRIB_MSRP_LISTENER;
+    rec->notify = MRPD_BIN_NOTIFY_JOIN;
+    rec->u.sl.id = id;
+    rec->u.sl.substate = mrpdhelper_listener_declaration_type_ready;
+}
+
+static bool makeEvents(uint32_t count)
+{
+    uint32_t i;
+
+    events = calloc(count, sizeof(*events));
+    if (!events) {
+        return false;
+    }
+    for (i = 0; i < count; i++) {
+        event_t *ev = &events[i];
+
+        ev->bin.hdr.magic = MRPD_BIN_MAGIC;
+        ev->bin.hdr.version = MRPD_BIN_VERSION;
+        ev->bin.hdr.count = 1;
+        ev->bin.hdr.record_size = sizeof(struct mrpd_bin_record);
+        ev->bin.rec.state = MRPD_BIN_STATE_IN;
+        ev->bin.rec.app_state = mrpdhelper_applicant_state_QA;
+        ev->bin.rec.registrar = REGISTRAR_MAC;
+        if (i & 1) {
+            makeListener(ev, STREAM_ID_BASE + i);
+        }
+        else {
+            makeTalker(ev, STREAM_ID_BASE + i);
+        }
+    }
+    eventCount = count;
+    return true;
+}
+
+static uint64_t notifyId(const struct mrpdhelper_notify *n)
+{
+    return n->attrib == mrpdhelper_attribtype_msrp_listener ? n->u.sl.id : n->u.st.id;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Decode
+/////////////////////////////////////////////////////////////////////////////
+
+static void runDecode(uint32_t passes, decode_result_t *res)
+{
+    struct mrpdhelper_notify nText, nBin;
+    uint64_t acc = 0;
+    uint64_t t0;
+    uint32_t p, i;
+
+    memset(res, 0, sizeof(*res));
+
+    for (i = 0; i < eventCount; i++) {
+        event_t *ev = &events[i];
+        const struct mrpd_bin_record *rec;
+
+        if (mrpdhelper_parse_notification(ev->text, ev->textLen, &nText) != 0
+            || mrpdhelper_parse_notification((char *)&ev->bin, sizeof(ev->bin), &nBin) != 0
+            || memcmp(&nText, &nBin, sizeof(nText)) != 0) {
+            res->mismatches++;
+            continue;
+        }
+        rec = mrpdhelper_bin_record((const char *)&ev->bin, sizeof(ev->bin), 0);
+        if (!rec || rec->u.st.id != notifyId(&nText)) {
+            res->mismatches++;
+        }
+    }
+
+    t0 = nowNs();
+    for (p = 0; p < passes; p++) {
+        for (i = 0; i < eventCount; i++) {
+            mrpdhelper_parse_notification(events[i].text, events[i].textLen, &nText);
+            acc += notifyId(&nText);
+        }
+    }
+    res->nsText = (double)(nowNs() - t0) / ((double)passes * eventCount);
+
+    t0 = nowNs();
+    for (p = 0; p < passes; p++) {
+        for (i = 0; i < eventCount; i++) {
+            mrpdhelper_parse_notification((char *)&events[i].bin, sizeof(events[i].bin), &nBin);
+            acc += notifyId(&nBin);
+        }
+    }
+    res->nsBinary = (double)(nowNs() - t0) / ((double)passes * eventCount);
+
+    // The talker and listener IDs are both the first field of the union
+    t0 = nowNs();
+    for (p = 0; p < passes; p++) {
+        for (i = 0; i < eventCount; i++) {
+            const struct mrpd_bin_record *rec =
+                mrpdhelper_bin_record((const char *)&events[i].bin, sizeof(events[i].bin), 0);
+            if (rec) {
+                acc += rec->u.st.id;
+            }
+        }
+    }
+    res->nsInPlace = (double)(nowNs() - t0) / ((double)passes * eventCount);
+
+    sink = acc;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Loopback
+/////////////////////////////////////////////////////////////////////////////
+
+static int cmpU64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static void *receiver(void *arg)
+{
+    loop_ctx_t *ctx = arg;
+    loop_result_t *res = ctx->res;
+    struct mrpdhelper_notify n;
+    char *buf;
+    double cpu0;
+
+    // Heap buffer, 8 byte aligned like a client's receive buffer
+    buf = malloc(MAX_MRPD_CMDSZ + 8);
+    if (!buf) {
+        return NULL;
+    }
+    cpu0 = threadCpuSec();
+
+    for (;;) {
+        ssize_t len = recv(ctx->fd, buf, MAX_MRPD_CMDSZ, 0);
+        uint64_t id;
+
+        if (len < 0) {
+            if ((errno == EAGAIN || errno == EWOULDBLOCK) && ctx->senderDone) {
+                break;
+            }
+            continue;
+        }
+        if (mrpdhelper_parse_notification(buf, len, &n) != 0) {
+            res->decodeErrors++;
+            continue;
+        }
+        id = notifyId(&n) - STREAM_ID_BASE;
+        if (id >= ctx->count) {
+            res->decodeErrors++;
+            continue;
+        }
+        ctx->lagNs[res->received++] = nowNs() - __atomic_load_n(&ctx->sendNs[id], __ATOMIC_ACQUIRE);
+    }
+
+    res->cpuSec = threadCpuSec() - cpu0;
+    free(buf);
+    return NULL;
+}
+
+static bool runLoopback(bench_fmt_t fmt, uint32_t rate, loop_result_t *res)
+{
+    struct sockaddr_in addr;
+    socklen_t addrLen = sizeof(addr);
+    struct timeval tv = { 0, 200000 };
+    struct timespec next;
+    loop_ctx_t ctx;
+    pthread_t thread;
+    char txbuf[MAX_MRPD_CMDSZ];
+    uint64_t period = 1000000000ULL / rate;
+    uint64_t t0;
+    int txfd;
+    uint32_t i;
+
+    memset(res, 0, sizeof(*res));
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.count = eventCount;
+    ctx.res = res;
+    ctx.sendNs = calloc(eventCount, sizeof(uint64_t));
+    ctx.lagNs = calloc(eventCount, sizeof(uint64_t));
+    ctx.fd = socket(AF_INET, SOCK_DGRAM, 0);
+    txfd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (!ctx.sendNs || !ctx.lagNs || ctx.fd < 0 || txfd < 0) {
+        perror("loopback setup");
+        return false;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(ctx.fd, (struct sockaddr *)&addr, sizeof(addr)) < 0
+        || getsockname(ctx.fd, (struct sockaddr *)&addr, &addrLen) < 0
+        || connect(txfd, (struct sockaddr *)&addr, sizeof(addr)) < 0
+        || setsockopt(ctx.fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv)) < 0) {
+        perror("loopback socket");
+        return false;
+    }
+    if (pthread_create(&thread, NULL, receiver, &ctx) != 0) {
+        return false;
+    }
+
+    res->datagramBytes = fmt == FMT_TEXT ? MAX_MRPD_CMDSZ : sizeof(struct mrpd_bin_notify);
+    memset(txbuf, 0, sizeof(txbuf));
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    t0 = nowNs();
+
+    for (i = 0; i < eventCount; i++) {
+        const void *msg;
+
+        // mrpd sends the whole zeroed text buffer
+        if (fmt == FMT_TEXT) {
+            memset(txbuf, 0, sizeof(txbuf));
+            memcpy(txbuf, events[i].text, events[i].textLen);
+            msg = txbuf;
+        }
+        else {
+            msg = &events[i].bin;
+        }
+
+        next.tv_nsec += period;
+        while (next.tv_nsec >= 1000000000L) {
+            next.tv_nsec -= 1000000000L;
+            next.tv_sec++;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+
+        __atomic_store_n(&ctx.sendNs[i], nowNs(), __ATOMIC_RELEASE);
+        if (send(txfd, msg, res->datagramBytes, 0) == (ssize_t)res->datagramBytes) {
+            res->sent++;
+        }
+    }
+    res->sec = (nowNs() - t0) / 1e9;
+    ctx.senderDone = true;
+    pthread_join(thread, NULL);
+
+    if (res->received) {
+        qsort(ctx.lagNs, res->received, sizeof(uint64_t), cmpU64);
+        res->lagP50 = ctx.lagNs[res->received / 2] / 1e3;
+        res->lagP99 = ctx.lagNs[(res->received * 99) / 100] / 1e3;
+        res->lagMax = ctx.lagNs[res->received - 1] / 1e3;
+    }
+
+    close(txfd);
+    close(ctx.fd);
+    free(ctx.sendNs);
+    free(ctx.lagNs);
+    return true;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+        "Usage: %s [options]\n"
+        "  -r RATE    Loopback events per second (default %u)\n"
+        "  -s SEC     Loopback duration, also sets the event count (default %u)\n"
+        "  -n N       Timed decode passes over all events (default %u)\n"
+        "  -l LABEL   Label in the results\n"
+        "  -c FILE    Append CSV rows to FILE\n",
+        prog, DEFAULT_RATE, DEFAULT_SECONDS, DEFAULT_PASSES);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *label = "mrpd_notify";
+    const char *csvPath = NULL;
+    uint32_t rate = DEFAULT_RATE;
+    uint32_t seconds = DEFAULT_SECONDS;
+    uint32_t passes = DEFAULT_PASSES;
+    decode_result_t dec;
+    loop_result_t res[FMT_COUNT];
+    double nsDecode[FMT_COUNT];
+    bool ok = true;
+    int opt;
+    int f;
+
+    while ((opt = getopt(argc, argv, "r:s:n:l:c:h")) != -1) {
+        switch (opt) {
+            case 'r': rate = strtoul(optarg, NULL, 0); break;
+            case 's': seconds = strtoul(optarg, NULL, 0); break;
+            case 'n': passes = strtoul(optarg, NULL, 0); break;
+            case 'l': label = optarg; break;
+            case 'c': csvPath = optarg; break;
+            default: usage(argv[0]); return 1;
+        }
+    }
+    if (rate == 0 || rate > 1000000 || seconds == 0 || passes == 0) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (!makeEvents(rate * seconds)) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    runDecode(passes, &dec);
+    ok = dec.mismatches == 0;
+    nsDecode[FMT_TEXT] = dec.nsText;
+    nsDecode[FMT_BINARY] = dec.nsBinary;
+
+    for (f = 0; f < FMT_COUNT; f++) {
+        if (!runLoopback((bench_fmt_t)f, rate, &res[f])) {
+            fprintf(stderr, "%s: loopback run failed\n", fmtNames[f]);
+            return 1;
+        }
+        ok = ok && res[f].decodeErrors == 0;
+    }
+
+    printf("{\"label\": \"%s\", \"events\": %u, \"passes\": %u,\n"
+           " \"decode\": {\"mismatches\": %u, \"text_ns_per_event\": %.1f, \"binary_ns_per_event\": %.1f"
+           ", \"binary_in_place_ns_per_event\": %.1f, \"speedup\": %.1f},\n"
+           " \"loopback\": {\"rate\": %u, \"seconds\": %u,",
+           label, eventCount, passes, dec.mismatches, dec.nsText, dec.nsBinary, dec.nsInPlace,
+           dec.nsBinary > 0 ? dec.nsText / dec.nsBinary : 0.0, rate, seconds);
+    for (f = 0; f < FMT_COUNT; f++) {
+        loop_result_t *r = &res[f];
+        printf("%s\n  \"%s\": {\"datagram_bytes\": %u, \"sent\": %" PRIu64 ", \"received\": %" PRIu64
+               ", \"dropped\": %" PRIu64 ", \"decode_errors\": %" PRIu64 ", \"achieved_rate\": %.0f"
+               ", \"rx_cpu_pct\": %.2f, \"rx_cpu_ns_per_event\": %.1f"
+               ", \"lag_usec\": {\"p50\": %.1f, \"p99\": %.1f, \"max\": %.1f}}",
+               f ? "," : "", fmtNames[f], r->datagramBytes, r->sent, r->received,
+               r->sent - r->received, r->decodeErrors, r->sec > 0 ? r->sent / r->sec : 0.0,
+               r->sec > 0 ? r->cpuSec * 100.0 / r->sec : 0.0,
+               r->received ? r->cpuSec * 1e9 / r->received : 0.0,
+               r->lagP50, r->lagP99, r->lagMax);
+    }
+    printf("},\n \"ok\": %s}\n", ok ? "true" : "false");
+
+    if (csvPath) {
+        FILE *csv = fopen(csvPath, "a");
+        if (!csv) {
+            perror(csvPath);
+            return 1;
+        }
+        if (ftell(csv) == 0) {
+            fprintf(csv, "label,format,events,decode_ns_per_event,rate,datagram_bytes,sent,received,"
+                         "decode_errors,rx_cpu_pct,rx_cpu_ns_per_event,lag_p50_usec,lag_p99_usec,lag_max_usec\n");
+        }
+        for (f = 0; f < FMT_COUNT; f++) {
+            loop_result_t *r = &res[f];
+            fprintf(csv, "%s,%s,%u,%.1f,%u,%u,%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%.2f,%.1f,%.1f,%.1f,%.1f\n",
+                    label, fmtNames[f], eventCount, nsDecode[f], rate, r->datagramBytes, r->sent,
+                    r->received, r->decodeErrors,
+                    r->sec > 0 ? r->cpuSec * 100.0 / r->sec : 0.0,
+                    r->received ? r->cpuSec * 1e9 / r->received : 0.0,
+                    r->lagP50, r->lagP99, r->lagMax);
+        }
+        fclose(csv);
+    }
+
+    free(events);
+    return ok ? 0 : 1;
+}
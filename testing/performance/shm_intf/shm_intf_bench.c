@@ -0,0 +1,493 @@
+/**
+ * Shared Memory Interface Benchmark
+ *
+ * Runs frames through the avtp_pipeline shared memory interface module
+ * (platform/Linux/intf_shm, linked as is) and the media queue in one process,
+ * with the external client on the other end of the ring, and measures the CPU
+ * cost per frame for a range of frame sizes in three modes:
+ *
+ *  - tx_copy: talker with an audio mapping format. openavbIntfShmTxCB() copies
+ *    each ring slot into a media queue item and the mapping copies the item
+ *    into the packet.
+ *  - tx_by_ref: talker with the Pipe mapping format. openavbIntfShmTxCB() adds
+ *    the ring slot to the item by reference and the mapping copies it straight
+ *    into the packet with openavbMediaQItemCopy(). The slot goes back to the
+ *    client when the item is pulled.
+ *  - rx_copy: listener. The mapping writes each packet into an item and
+ *    openavbIntfShmRxCB() copies the item into a ring slot for the client.
+ *
+ * memcpy_ns is the cost of one plain copy of the frame size, measured on a
+ * working set the size of the ring, for comparison with the difference between
+ * the modes.
+ *
+ * Every frame is checked on the far side, and after each run the ring must be
+ * empty, so a slot the media queue never released fails the run.
+ *
+ * Results are written as a single JSON object on stdout (and optionally CSV
+ * rows).
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <getopt.h>
+
+#include "openavb_types_pub.h"
+#include "openavb_avtp_time_pub.h"
+#include "openavb_time_osal_pub.h"
+#include "openavb_mediaq_pub.h"
+#include "openavb_intf_pub.h"
+#include "openavb_intf_shm_pub.h"
+#include "openavb_map_pipe_pub.h"
+#include "openavb_map_uncmp_audio_pub.h"
+
+#define DEFAULT_FRAMES      20000
+#define DEFAULT_DEPTH       8
+#define DEFAULT_SLOTS       64
+#define MAX_SIZES           16
+#define MAX_FRAME_BYTES     (1024 * 1024)
+
+typedef enum {
+    MODE_TX_COPY,
+    MODE_TX_BY_REF,
+    MODE_RX_COPY,
+    MODE_COUNT
+} bench_mode_t;
+
+static const char *modeNames[MODE_COUNT] = { "tx_copy", "tx_by_ref", "rx_copy" };
+
+typedef struct {
+    double nsPerFrame;
+    uint32_t mismatches;
+    uint32_t ringLevelEnd;
+    bool ok;
+} mode_result_t;
+
+extern bool openavbIntfShmInitialize(media_q_t *pMediaQ, openavb_intf_cb_t *pIntfCB);
+
+static uint32_t frameCount = DEFAULT_FRAMES;
+static uint32_t depth = DEFAULT_DEPTH;
+static uint32_t ringSlots = DEFAULT_SLOTS;
+static uint8_t *packet;
+static uint32_t runId;
+
+/////////////////////////////////////////////////////////////////////////////
+// The rest of the avtp_pipeline is not linked; the media queue and the
+// interface only need these to build and to stamp items, which this benchmark
+// ignores.
+/////////////////////////////////////////////////////////////////////////////
+
+void avbLogFn(int level, const char *tag, const char *company, const char *component,
+              const char *path, int line, const char *fmt, ...)
+{
+    va_list args;
+    if (level > 2) {
+        return;     // errors and warnings only
+    }
+    va_start(args, fmt);
+    fprintf(stderr, "%s %s: ", tag, component);
+    vfprintf(stderr, fmt, args);
+    fputc('\n', stderr);
+    va_end(args);
+}
+
+avtp_time_t *openavbAvtpTimeCreate(U32 maxLatencyUsec)
+{
+    return calloc(1, sizeof(avtp_time_t));
+}
+
+void openavbAvtpTimeDelete(avtp_time_t *pAvtpTime)
+{
+    free(pAvtpTime);
+}
+
+bool openavbAvtpTimeIsPast(avtp_time_t *pAvtpTime)
+{
+    return TRUE;
+}
+
+bool openavbAvtpTimeIsPastTime(avtp_time_t *pAvtpTime, U64 nSecTime)
+{
+    return TRUE;
+}
+
+bool openavbAvtpTimeUsecTill(avtp_time_t *pAvtpTime, U32 *pUsecTill)
+{
+    *pUsecTill = 0;
+    return TRUE;
+}
+
+S32 openavbAvtpTimeUsecDelta(avtp_time_t *pAvtpTime)
+{
+    return 0;
+}
+
+void openavbAvtpTimeSetToWallTime(avtp_time_t *pAvtpTime)
+{
+}
+
+void openavbAvtpTimeSetToTimestampNS(avtp_time_t *pAvtpTime, U64 timeNS)
+{
+}
+
+U64 openavbAvtpTimeGetAvtpTimeNS(avtp_time_t *pAvtpTime)
+{
+    return 0;
+}
+
+bool osalClockGettime64(openavb_clockId_t openavbClockId, U64 *timeNsec)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    *timeNsec = (U64)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+    return TRUE;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+static double nowSec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Frame f: its number in the first 4 bytes, the low byte of it in the last one.
+// The bytes in between are left as they are so the client does not pay for a
+// full write of every frame.
+static void stampFrame(uint8_t *pData, uint32_t len, uint32_t f)
+{
+    memcpy(pData, &f, sizeof(f));
+    pData[len - 1] = (uint8_t)f;
+}
+
+static bool checkFrame(const uint8_t *pData, uint32_t len, uint32_t expectLen, uint32_t f)
+{
+    uint32_t got;
+    if (len != expectLen) {
+        return false;
+    }
+    memcpy(&got, pData, sizeof(got));
+    return got == f && pData[len - 1] == (uint8_t)f;
+}
+
+typedef struct {
+    openavb_shm_ring_t ring;
+    char socketPath[64];
+    volatile bool done;
+    bool ok;
+} client_t;
+
+static void *clientConnectThread(void *pArg)
+{
+    client_t *pClient = pArg;
+    int tries;
+
+    // The interface only starts listening on its first callback
+    for (tries = 0; tries < 100 && !pClient->ok; tries++) {
+        pClient->ok = openavbShmClientConnect(&pClient->ring, pClient->socketPath);
+        if (!pClient->ok) {
+            usleep(10000);
+        }
+    }
+    pClient->done = true;
+    return NULL;
+}
+
+// Call the interface until the client is connected. The interface accepts at
+// most every 100 ms.
+static bool connectClient(media_q_t *pMediaQ, openavb_intf_cb_t *pIntfCB, bool talker, client_t *pClient)
+{
+    pthread_t thread;
+
+    if (pthread_create(&thread, NULL, clientConnectThread, pClient) != 0) {
+        return false;
+    }
+    while (!pClient->done) {
+        if (talker) {
+            pIntfCB->intf_tx_cb(pMediaQ);
+        }
+        else {
+            pIntfCB->intf_rx_cb(pMediaQ);
+        }
+        usleep(1000);
+    }
+    pthread_join(thread, NULL);
+    return pClient->ok;
+}
+
+// Talker: the client writes frames into the ring, the interface moves them
+// into the media queue and the mapping copies each item into the packet
+static void runTalker(media_q_t *pMediaQ, openavb_intf_cb_t *pIntfCB, bool byRef, openavb_shm_ring_t *pRing,
+                      uint32_t frameLen, mode_result_t *pRes)
+{
+    uint32_t produced = 0;
+    uint32_t consumed = 0;
+
+    while (consumed < frameCount) {
+        uint32_t maxLen;
+        uint8_t *pData;
+        media_q_item_t *pItem;
+
+        while (produced < frameCount && (pData = openavbShmRingProduceBegin(pRing, &maxLen)) != NULL) {
+            stampFrame(pData, frameLen, produced);
+            openavbShmRingProduceCommit(pRing, frameLen, 0);
+            produced++;
+        }
+
+        pIntfCB->intf_tx_cb(pMediaQ);
+
+        while ((pItem = openavbMediaQTailLock(pMediaQ, TRUE)) != NULL) {
+            uint32_t len;
+            if (byRef) {
+                len = openavbMediaQItemCopy(pItem, 0, packet, pItem->dataLen);
+            }
+            else {
+                // What the audio mappings do with pPubData
+                len = pItem->dataLen;
+                memcpy(packet, pItem->pPubData, len);
+            }
+            if (!checkFrame(packet, len, frameLen, consumed)) {
+                pRes->mismatches++;
+            }
+            consumed++;
+            openavbMediaQTailPull(pMediaQ);
+        }
+    }
+}
+
+// Listener: the mapping writes each packet into an item, the interface moves
+// the items into the ring and the client reads them in place
+static void runListener(media_q_t *pMediaQ, openavb_intf_cb_t *pIntfCB, openavb_shm_ring_t *pRing,
+                        uint32_t frameLen, mode_result_t *pRes)
+{
+    uint32_t produced = 0;
+    uint32_t consumed = 0;
+
+    while (consumed < frameCount) {
+        media_q_item_t *pItem;
+        uint32_t len;
+        uint8_t *pData;
+
+        while (produced < frameCount && (pItem = openavbMediaQHeadLock(pMediaQ)) != NULL) {
+            stampFrame(packet, frameLen, produced);
+            memcpy(pItem->pPubData, packet, frameLen);
+            pItem->dataLen = frameLen;
+            openavbMediaQHeadPush(pMediaQ);
+            produced++;
+        }
+
+        pIntfCB->intf_rx_cb(pMediaQ);
+
+        while ((pData = openavbShmRingConsumeBegin(pRing, &len, NULL)) != NULL) {
+            if (!checkFrame(pData, len, frameLen, consumed)) {
+                pRes->mismatches++;
+            }
+            consumed++;
+            openavbShmRingConsumeRelease(pRing);
+        }
+    }
+}
+
+static bool runMode(bench_mode_t mode, uint32_t frameLen, mode_result_t *pRes)
+{
+    media_q_t *pMediaQ = openavbMediaQCreate();
+    openavb_intf_cb_t intfCB;
+    client_t client;
+    char value[32];
+    bool talker = mode != MODE_RX_COPY;
+    double t0;
+
+    memset(pRes, 0, sizeof(*pRes));
+    memset(&intfCB, 0, sizeof(intfCB));
+    memset(&client, 0, sizeof(client));
+    if (!pMediaQ) {
+        return false;
+    }
+    pMediaQ->pMediaQDataFormat = strdup(mode == MODE_TX_BY_REF ? MapPipeMediaQDataFormat : MapUncmpAudioMediaQDataFormat);
+    if (!pMediaQ->pMediaQDataFormat
+        || !openavbMediaQSetSize(pMediaQ, depth, frameLen)
+        || !openavbIntfShmInitialize(pMediaQ, &intfCB)) {
+        openavbMediaQDelete(pMediaQ);
+        return false;
+    }
+
+    snprintf(client.socketPath, sizeof(client.socketPath), "@openavb_shm_bench_%d_%u", (int)getpid(), runId++);
+    intfCB.intf_cfg_cb(pMediaQ, "intf_nv_socket_path", client.socketPath);
+    snprintf(value, sizeof(value), "%u", ringSlots);
+    intfCB.intf_cfg_cb(pMediaQ, "intf_nv_ring_slots", value);
+    intfCB.intf_cfg_cb(pMediaQ, "intf_nv_ignore_timestamp", "1");
+    intfCB.intf_gen_init_cb(pMediaQ);
+    if (talker) {
+        intfCB.intf_tx_init_cb(pMediaQ);
+    }
+    else {
+        intfCB.intf_rx_init_cb(pMediaQ);
+    }
+
+    if (connectClient(pMediaQ, &intfCB, talker, &client)) {
+        t0 = nowSec();
+        if (talker) {
+            runTalker(pMediaQ, &intfCB, mode == MODE_TX_BY_REF, &client.ring, frameLen, pRes);
+        }
+        else {
+            runListener(pMediaQ, &intfCB, &client.ring, frameLen, pRes);
+        }
+        pRes->nsPerFrame = (nowSec() - t0) * 1e9 / frameCount;
+        pRes->ringLevelEnd = openavbShmRingLevel(&client.ring);
+        pRes->ok = pRes->mismatches == 0 && pRes->ringLevelEnd == 0;
+        openavbShmClientClose(&client.ring);
+    }
+    else {
+        fprintf(stderr, "%s: client could not connect to %s\n", modeNames[mode], client.socketPath);
+    }
+
+    intfCB.intf_end_cb(pMediaQ);
+    intfCB.intf_gen_end_cb(pMediaQ);
+    openavbMediaQDelete(pMediaQ);
+    return pRes->ok;
+}
+
+// One copy of frameLen bytes, cycling through as many buffers as the ring has
+// slots like the modes do
+static double memcpyNs(uint32_t frameLen)
+{
+    uint8_t *src = malloc((size_t)ringSlots * frameLen);
+    uint32_t i;
+    double t0, sec;
+
+    if (!src) {
+        return 0;
+    }
+    memset(src, 0x5A, (size_t)ringSlots * frameLen);
+    t0 = nowSec();
+    for (i = 0; i < frameCount; i++) {
+        memcpy(packet, src + (size_t)(i % ringSlots) * frameLen, frameLen);
+        __asm__ __volatile__("" : : "r"(packet) : "memory");
+    }
+    sec = nowSec() - t0;
+    free(src);
+    return sec * 1e9 / frameCount;
+}
+
+static uint32_t parseSizes(const char *list, uint32_t *sizes)
+{
+    uint32_t n = 0;
+    char *copy = strdup(list);
+    char *save = NULL;
+    char *tok;
+
+    for (tok = strtok_r(copy, ",", &save); tok && n < MAX_SIZES; tok = strtok_r(NULL, ",", &save)) {
+        unsigned long v = strtoul(tok, NULL, 0);
+        if (v < sizeof(uint32_t) + 1 || v > MAX_FRAME_BYTES) {
+            n = 0;
+            break;
+        }
+        sizes[n++] = (uint32_t)v;
+    }
+    free(copy);
+    return n;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+        "Usage: %s [options]\n"
+        "  -s LIST    Comma separated frame sizes in bytes (default 64,1024,8192,65536)\n"
+        "  -n N       Frames per size and mode (default %u)\n"
+        "  -d N       Media queue items (default %u)\n"
+        "  -r N       Ring slots (default %u)\n"
+        "  -l LABEL   Label in the results\n"
+        "  -c FILE    Append CSV rows to FILE\n",
+        prog, DEFAULT_FRAMES, DEFAULT_DEPTH, DEFAULT_SLOTS);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *label = "shm_intf";
+    const char *csvPath = NULL;
+    uint32_t sizes[MAX_SIZES];
+    uint32_t sizeCount = parseSizes("64,1024,8192,65536", sizes);
+    mode_result_t res[MAX_SIZES][MODE_COUNT];
+    double copyNs[MAX_SIZES];
+    bool ok = true;
+    uint32_t s;
+    int opt;
+    int m;
+
+    while ((opt = getopt(argc, argv, "s:n:d:r:l:c:h")) != -1) {
+        switch (opt) {
+            case 's': sizeCount = parseSizes(optarg, sizes); break;
+            case 'n': frameCount = strtoul(optarg, NULL, 0); break;
+            case 'd': depth = strtoul(optarg, NULL, 0); break;
+            case 'r': ringSlots = strtoul(optarg, NULL, 0); break;
+            case 'l': label = optarg; break;
+            case 'c': csvPath = optarg; break;
+            default: usage(argv[0]); return 1;
+        }
+    }
+    if (sizeCount == 0 || frameCount == 0 || depth == 0 || ringSlots < 2) {
+        usage(argv[0]);
+        return 1;
+    }
+    packet = malloc(MAX_FRAME_BYTES);
+    if (!packet) {
+        return 1;
+    }
+
+    for (s = 0; s < sizeCount; s++) {
+        for (m = 0; m < MODE_COUNT; m++) {
+            if (!runMode((bench_mode_t)m, sizes[s], &res[s][m])) {
+                fprintf(stderr, "%s %u bytes: failed (mismatches %u, ring level %u)\n",
+                        modeNames[m], sizes[s], res[s][m].mismatches, res[s][m].ringLevelEnd);
+                ok = false;
+            }
+        }
+        copyNs[s] = memcpyNs(sizes[s]);
+    }
+
+    printf("{\"label\": \"%s\", \"frames\": %u, \"depth\": %u, \"ring_slots\": %u,\n \"sizes\": [",
+           label, frameCount, depth, ringSlots);
+    for (s = 0; s < sizeCount; s++) {
+        printf("%s\n  {\"frame_bytes\": %u, \"memcpy_ns\": %.1f", s ? "," : "", sizes[s], copyNs[s]);
+        for (m = 0; m < MODE_COUNT; m++) {
+            mode_result_t *r = &res[s][m];
+            printf(", \"%s\": {\"ns_per_frame\": %.1f, \"mismatches\": %u, \"ring_level_end\": %u}",
+                   modeNames[m], r->nsPerFrame, r->mismatches, r->ringLevelEnd);
+        }
+        printf("}");
+    }
+    printf("],\n \"ok\": %s}\n", ok ? "true" : "false");
+
+    if (csvPath) {
+        FILE *csv = fopen(csvPath, "a");
+        if (!csv) {
+            perror(csvPath);
+            return 1;
+        }
+        if (ftell(csv) == 0) {
+            fprintf(csv, "label,mode,frame_bytes,frames,depth,ring_slots,ns_per_frame,memcpy_ns,mismatches,ring_level_end\n");
+        }
+        for (s = 0; s < sizeCount; s++) {
+            for (m = 0; m < MODE_COUNT; m++) {
+                mode_result_t *r = &res[s][m];
+                fprintf(csv, "%s,%s,%u,%u,%u,%u,%.1f,%.1f,%u,%u\n",
+                        label, modeNames[m], sizes[s], frameCount, depth, ringSlots,
+                        r->nsPerFrame, copyNs[s], r->mismatches, r->ringLevelEnd);
+            }
+        }
+        fclose(csv);
+    }
+
+    free(packet);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,183 @@
+#!/bin/bash
+#
+# Stream placement test over a veth pair.
+#
+# Sets up a veth pair with a multiqueue sender end and an mq root qdisc, so
+# every TX queue has its own qdisc and counters. The XPS map gives CPU c the
+# queue c % --queues. stream_placement_probe then runs --streams talkers
+# through each rawsock implementation twice:
+#   - unplaced: the talker threads run wherever the scheduler puts them
+#   - placed:   each talker is placed with openavbPlacementAssign() and
+#               pinned to the core of its queue
+# Per run it records frames per second, CPU time per frame, the cores the
+# talkers ran on and the frames counted by the qdisc of each queue.
+#
+# One JSON object per run is appended to results.jsonl and the probe adds a
+# row to results.csv in the output directory. The exit status is non-zero if
+# a run fails, or if the frames a placed run put on each queue do not match
+# that queue's qdisc counter.
+#
+# Requirements: root (veth creation, raw sockets, qdiscs and XPS maps) and a
+# kernel with CONFIG_XPS.
+
+set -u
+
+PROBE=""
+BACKENDS="simple sendmmsg ring"
+STREAMS="8 32 128"
+FRAMES=20000
+QUEUES=8
+OUT_DIR="./stream_placement_veth_results"
+VETH_TX="spl0"
+VETH_RX="spl1"
+KEEP_VETH=0
+
+usage() {
+    cat <<EOF
+Usage: $0 --probe PATH [options]
+  --probe PATH          stream_placement_probe binary
+  --backends "LIST"     Rawsock implementations (default "${BACKENDS}")
+  --streams "LIST"      Talker stream counts to run (default "${STREAMS}")
+  --frames N            Frames per stream (default ${FRAMES})
+  --queues N            TX queues on the veth (default ${QUEUES})
+  --out DIR             Output directory (default ${OUT_DIR})
+  --keep-veth           Leave the veth pair in place on exit
+EOF
+}
+
+while [ $# -gt 0 ]; do
+    case "$1" in
+        --probe) PROBE="$2"; shift 2 ;;
+        --backends) BACKENDS="$2"; shift 2 ;;
+        --streams) STREAMS="$2"; shift 2 ;;
+        --frames) FRAMES="$2"; shift 2 ;;
+        --queues) QUEUES="$2"; shift 2 ;;
+        --out) OUT_DIR="$2"; shift 2 ;;
+        --keep-veth) KEEP_VETH=1; shift ;;
+        -h|--help) usage; exit 0 ;;
+        *) echo "Unknown option: $1"; usage; exit 1 ;;
+    esac
+done
+
+if [ -z "${PROBE}" ]; then
+    usage
+    exit 1
+fi
+if [ "$(id -u)" -ne 0 ]; then
+    echo "This test needs root to create veth interfaces and qdiscs"
+    exit 1
+fi
+
+mkdir -p "${OUT_DIR}"
+OUT_DIR="$(cd "${OUT_DIR}" && pwd)"
+RESULTS_JSON="${OUT_DIR}/results.jsonl"
+RESULTS_CSV="${OUT_DIR}/results.csv"
+
+teardown() {
+    if [ ${KEEP_VETH} -eq 0 ]; then
+        ip link del "${VETH_TX}" 2>/dev/null
+    fi
+}
+trap teardown EXIT INT TERM
+
+ip link del "${VETH_TX}" 2>/dev/null
+ip link add "${VETH_TX}" numtxqueues "${QUEUES}" numrxqueues "${QUEUES}" type veth \
+    peer name "${VETH_RX}" numtxqueues "${QUEUES}" numrxqueues "${QUEUES}" || exit 1
+for dev in "${VETH_TX}" "${VETH_RX}"; do
+    sysctl -qw "net.ipv6.conf.${dev}.disable_ipv6=1" 2>/dev/null
+    ip link set "${dev}" up || exit 1
+done
+if ! tc qdisc replace dev "${VETH_TX}" root handle 1: mq; then
+    echo "Could not set up mq on ${VETH_TX}"
+    exit 1
+fi
+
+# XPS: CPU c sends on queue c % QUEUES. The mask is written as comma
+# separated 32 bit words, most significant first.
+NCPU=$(nproc --all)
+WORDS=$(( (NCPU + 31) / 32 ))
+for ((q = 0; q < QUEUES; q++)); do
+    MASK=""
+    for ((w = WORDS - 1; w >= 0; w--)); do
+        WORD=0
+        for ((b = 0; b < 32; b++)); do
+            c=$(( w * 32 + b ))
+            if [ ${c} -lt "${NCPU}" ] && [ $(( c % QUEUES )) -eq ${q} ]; then
+                WORD=$(( WORD | (1 << b) ))
+            fi
+        done
+        MASK="${MASK}${MASK:+,}$(printf '%08x' ${WORD})"
+    done
+    if ! echo "${MASK}" > "/sys/class/net/${VETH_TX}/queues/tx-${q}/xps_cpus" 2>/dev/null; then
+        echo "Could not set the XPS map of tx-${q} to ${MASK}; CONFIG_XPS is needed"
+        exit 1
+    fi
+done
+grep . /sys/class/net/"${VETH_TX}"/queues/tx-*/xps_cpus > "${OUT_DIR}/xps.txt"
+
+# Packets counted by the qdisc of each TX queue, in queue order
+queue_packets() {
+    tc -s qdisc show dev "${VETH_TX}" | awk -v n="${QUEUES}" '
+        / parent 1:/ {
+            # mq class minors are hex, one per queue from 1
+            split($0, a, "parent 1:"); split(a[2], b, " "); q = 0
+            for (i = 1; i <= length(b[1]); i++) q = q * 16 + index("0123456789abcdef", substr(b[1], i, 1)) - 1
+            q--; next
+        }
+        /^ Sent/ && q >= 0 { pkts[q] = $4; q = -1 }
+        END { for (i = 0; i < n; i++) printf "%d ", pkts[i] + 0 }'
+}
+
+FAILED=0
+for BACKEND in ${BACKENDS}; do
+    for N in ${STREAMS}; do
+        for RUN in unplaced placed; do
+            ARGS=""
+            [ "${RUN}" = placed ] && ARGS="-P"
+            LABEL="${BACKEND}_${RUN}_s${N}"
+
+            read -r -a BEFORE <<< "$(queue_packets)"
+            # shellcheck disable=SC2086
+            "${PROBE}" -i "${VETH_TX}" -m "${BACKEND}" -s "${N}" -n "${FRAMES}" ${ARGS} \
+                -l "${LABEL}" -c "${RESULTS_CSV}" > "${OUT_DIR}/${LABEL}.json" 2> "${OUT_DIR}/${LABEL}.log"
+            PROBE_RC=$?
+            read -r -a AFTER <<< "$(queue_packets)"
+
+            COUNTED=""
+            for ((q = 0; q < QUEUES; q++)); do
+                COUNTED="${COUNTED}${COUNTED:+, }$(( AFTER[q] - BEFORE[q] ))"
+            done
+
+            # Every stream of a placed run is on a queue: the qdisc counters must agree
+            MATCH=true
+            if [ "${RUN}" = placed ]; then
+                UNPLACED=$(grep -o '"unplaced_frames": [0-9]*' "${OUT_DIR}/${LABEL}.json" | awk '{ print $2 }')
+                read -r -a EXPECT <<< "$(grep -o '"queue_frames": \[[^]]*\]' "${OUT_DIR}/${LABEL}.json" \
+                    | sed 's/.*\[//; s/\]//; s/,/ /g')"
+                if [ "${UNPLACED:-1}" -ne 0 ]; then
+                    MATCH=false
+                fi
+                for ((q = 0; q < QUEUES; q++)); do
+                    if [ $(( AFTER[q] - BEFORE[q] )) -ne "${EXPECT[q]:-0}" ]; then
+                        MATCH=false
+                    fi
+                done
+            fi
+            if [ ${PROBE_RC} -ne 0 ] || [ "${MATCH}" = false ]; then
+                FAILED=1
+            fi
+
+            {
+                printf '{"run": "%s", "backend": "%s", "probe_rc": %d, "qdisc_queue_frames": [%s], "queues_match": %s, "probe": ' \
+                    "${RUN}" "${BACKEND}" "${PROBE_RC}" "${COUNTED}" "${MATCH}"
+                tr -d '\n' < "${OUT_DIR}/${LABEL}.json"
+                printf '}\n'
+            } >> "${RESULTS_JSON}"
+
+            echo "${LABEL}: $(grep -o '"frames_per_sec": [0-9]*, "cpu_usec_per_frame": [0-9.]*, "cores_used": [0-9]*' "${OUT_DIR}/${LABEL}.json")," \
+                 "qdisc queues [${COUNTED}], match ${MATCH}"
+        done
+    done
+done
+
+exit ${FAILED}
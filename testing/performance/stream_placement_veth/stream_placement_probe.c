@@ -0,0 +1,310 @@
+/**
+ * Stream Placement Probe
+ *
+ * Runs -s talker threads, each with its own avtp_pipeline rawsock (simple,
+ * sendmmsg or ring, linked as is) on one interface, and sends -n frames per
+ * stream as fast as the socket takes them.
+ *
+ *  - With -P every talker places itself with openavbPlacementAssign() and
+ *    pins its thread to the core it got, as a talker with queue_placement
+ *    does. The TX queue follows from the XPS map of that core.
+ *  - Without -P the threads run wherever the scheduler puts them.
+ *
+ * Each talker records the core it ran on, and with -P the queue and core of
+ * its placement. The JSON result has the frames placed on each TX queue, so
+ * run_stream_placement_veth.sh can compare them with the qdisc counters of
+ * the queues.
+ *
+ * Results are written as a single JSON object on stdout (and optionally a CSV
+ * row).
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <sys/resource.h>
+
+#include "openavb_types_pub.h"
+#include "openavb_rawsock.h"
+#include "openavb_arena.h"
+#include "openavb_placement.h"
+
+#define PROBE_ETHERTYPE         0x22F0
+#define PROBE_FRAME_LEN         128
+#define PROBE_BATCH             16
+#define PROBE_MAX_STREAMS       256
+#define PROBE_MAX_QUEUES        64
+#define PROBE_MAX_CPUS          1024
+#define DEFAULT_STREAMS         32
+#define DEFAULT_FRAMES          20000
+#define DEFAULT_BACKEND         "simple"
+
+typedef struct {
+    uint32_t index;
+    pthread_t thread;
+    openavb_placement_t placement;
+    int ranOnCpu;               // core the thread was on when it finished
+    uint64_t sent;
+    uint32_t txErrors;
+    double elapsedSec;
+} talker_t;
+
+static talker_t talkers[PROBE_MAX_STREAMS];
+static const char *gUri;
+static const char *gIfname;
+static uint32_t gFrames = DEFAULT_FRAMES;
+static bool gPlace;
+static pthread_barrier_t gStart;
+
+/////////////////////////////////////////////////////////////////////////////
+// The rest of the avtp_pipeline is not linked; the rawsock and the placement
+// only need logging.
+/////////////////////////////////////////////////////////////////////////////
+
+void avbLogFn(int level, const char *tag, const char *company, const char *component,
+              const char *path, int line, const char *fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    fprintf(stderr, "%s %s: ", tag, component);
+    vfprintf(stderr, fmt, args);
+    fputc('\n', stderr);
+    va_end(args);
+}
+
+static uint64_t nowNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static double cpuUsec(void)
+{
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_utime.tv_sec * 1e6 + ru.ru_utime.tv_usec + ru.ru_stime.tv_sec * 1e6 + ru.ru_stime.tv_usec;
+}
+
+static void *talkerThread(void *arg)
+{
+    talker_t *t = arg;
+    U8 srcAddr[ETH_ALEN];
+    U8 dest[ETH_ALEN] = { 0x91, 0xe0, 0xf0, 0x00, 0xfe, 0x00 };
+    hdr_info_t hdr;
+    void *rawsock;
+    uint64_t startNs;
+    uint32_t k;
+
+    if (gPlace) {
+        openavbPlacementAssign(&t->placement, gIfname, TRUE, OPENAVB_PLACEMENT_AUTO, NULL);
+        openavbPlacementPinThread(&t->placement);
+    }
+
+    rawsock = openavbRawsockOpen(gUri, FALSE, TRUE, PROBE_ETHERTYPE, PROBE_FRAME_LEN + 64, 2 * PROBE_BATCH + 8);
+    if (rawsock) {
+        dest[5] = (U8)t->index;
+        openavbRawsockGetAddr(rawsock, srcAddr);
+        memset(&hdr, 0, sizeof(hdr));
+        hdr.shost = srcAddr;
+        hdr.dhost = dest;
+        hdr.ethertype = PROBE_ETHERTYPE;
+        openavbRawsockTxSetHdr(rawsock, &hdr);
+    }
+    else {
+        fprintf(stderr, "%s: rawsock open failed\n", gUri);
+    }
+
+    pthread_barrier_wait(&gStart);
+    if (!rawsock) {
+        t->txErrors++;
+        return NULL;
+    }
+
+    startNs = nowNs();
+    for (k = 0; k < gFrames; k += PROBE_BATCH) {
+        uint32_t j;
+        for (j = k; j < k + PROBE_BATCH && j < gFrames; j++) {
+            U32 size, hdrlen;
+            U8 *pBuf = openavbRawsockGetTxFrame(rawsock, TRUE, &size);
+            if (!pBuf) {
+                t->txErrors++;
+                continue;
+            }
+            openavbRawsockTxFillHdr(rawsock, pBuf, &hdrlen);
+            memset(pBuf + hdrlen, 0, PROBE_FRAME_LEN - hdrlen);
+            pBuf[hdrlen] = (U8)t->index;
+            openavbRawsockTxFrameReady(rawsock, pBuf, PROBE_FRAME_LEN, 0);
+            t->sent++;
+        }
+        if (openavbRawsockSend(rawsock) < 0) {
+            t->txErrors++;
+        }
+    }
+    t->elapsedSec = (nowNs() - startNs) / 1e9;
+    t->ranOnCpu = sched_getcpu();
+
+    openavbRawsockClose(rawsock);
+    if (gPlace) {
+        openavbPlacementRelease(&t->placement);
+    }
+    return NULL;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+        "Usage: %s -i IF [options]\n"
+        "  -i IF      Interface to send on\n"
+        "  -s N       Talker streams, one thread each (default %u, at most %u)\n"
+        "  -n N       Frames per stream (default %u)\n"
+        "  -m NAME    Rawsock implementation: simple, sendmmsg or ring (default %s)\n"
+        "  -P         Place the streams on TX queues and pin them (openavbPlacementAssign)\n"
+        "  -l LABEL   Label in the results\n"
+        "  -c FILE    Append a CSV row to FILE\n",
+        prog, DEFAULT_STREAMS, PROBE_MAX_STREAMS, DEFAULT_FRAMES, DEFAULT_BACKEND);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *backend = DEFAULT_BACKEND;
+    const char *label = NULL;
+    const char *csvPath = NULL;
+    char uri[IFNAMSIZ + 16];
+    uint32_t streams = DEFAULT_STREAMS;
+    uint64_t queueFrames[PROBE_MAX_QUEUES];
+    uint64_t unplacedFrames = 0, sent = 0;
+    uint32_t txErrors = 0, cores = 0, i;
+    uint8_t *coreUsed;
+    double elapsedMax = 0, cpu0, cpu;
+    int maxQueue = -1;
+    bool ok;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "i:s:n:m:Pl:c:h")) != -1) {
+        switch (opt) {
+            case 'i': gIfname = optarg; break;
+            case 's': streams = strtoul(optarg, NULL, 0); break;
+            case 'n': gFrames = strtoul(optarg, NULL, 0); break;
+            case 'm': backend = optarg; break;
+            case 'P': gPlace = true; break;
+            case 'l': label = optarg; break;
+            case 'c': csvPath = optarg; break;
+            default: usage(argv[0]); return 1;
+        }
+    }
+    if (!gIfname || streams == 0 || streams > PROBE_MAX_STREAMS || gFrames == 0) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (!label) {
+        label = gPlace ? "placed" : "unplaced";
+    }
+    snprintf(uri, sizeof(uri), "%s:%s", backend, gIfname);
+    gUri = uri;
+
+    openavbArenaInitialize();
+    openavbPlacementInitialize();
+    pthread_barrier_init(&gStart, NULL, streams + 1);
+
+    for (i = 0; i < streams; i++) {
+        talkers[i].index = i;
+        talkers[i].ranOnCpu = -1;
+        if (pthread_create(&talkers[i].thread, NULL, talkerThread, &talkers[i]) != 0) {
+            fprintf(stderr, "pthread_create failed\n");
+            return 1;
+        }
+    }
+    pthread_barrier_wait(&gStart);
+    cpu0 = cpuUsec();
+    for (i = 0; i < streams; i++) {
+        pthread_join(talkers[i].thread, NULL);
+    }
+    cpu = cpuUsec() - cpu0;
+
+    memset(queueFrames, 0, sizeof(queueFrames));
+    coreUsed = calloc(PROBE_MAX_CPUS, 1);
+    for (i = 0; i < streams; i++) {
+        talker_t *t = &talkers[i];
+        int q = gPlace ? t->placement.queue : -1;
+
+        sent += t->sent;
+        txErrors += t->txErrors;
+        if (t->elapsedSec > elapsedMax) {
+            elapsedMax = t->elapsedSec;
+        }
+        if (q >= 0 && q < PROBE_MAX_QUEUES) {
+            queueFrames[q] += t->sent;
+            if (q > maxQueue) {
+                maxQueue = q;
+            }
+        }
+        else {
+            unplacedFrames += t->sent;
+        }
+        if (t->ranOnCpu >= 0 && t->ranOnCpu < PROBE_MAX_CPUS && !coreUsed[t->ranOnCpu]) {
+            coreUsed[t->ranOnCpu] = 1;
+            cores++;
+        }
+        // Placed threads must not have moved off their core
+        if (gPlace && t->placement.cpu >= 0 && t->ranOnCpu != t->placement.cpu) {
+            txErrors++;
+        }
+    }
+    free(coreUsed);
+    openavbPlacementFinalize();
+
+    ok = txErrors == 0 && sent == (uint64_t)streams * gFrames;
+
+    printf("{\"label\": \"%s\", \"backend\": \"%s\", \"placed\": %s, \"streams\": %u, \"frames_per_stream\": %u, "
+           "\"sent\": %" PRIu64 ", \"tx_errors\": %u, \"elapsed_sec\": %.3f, \"frames_per_sec\": %.0f, "
+           "\"cpu_usec_per_frame\": %.3f, \"cores_used\": %u, \"unplaced_frames\": %" PRIu64 ", \"queue_frames\": [",
+           label, backend, gPlace ? "true" : "false", streams, gFrames,
+           sent, txErrors, elapsedMax, elapsedMax > 0 ? sent / elapsedMax : 0.0,
+           sent ? cpu / sent : 0.0, cores, unplacedFrames);
+    for (i = 0; (int)i <= maxQueue; i++) {
+        printf("%s%" PRIu64, i ? ", " : "", queueFrames[i]);
+    }
+    printf("], \"placement\": [");
+    for (i = 0; i < streams; i++) {
+        talker_t *t = &talkers[i];
+        printf("%s{\"queue\": %d, \"cpu\": %d, \"source\": \"%s\", \"ran_on\": %d}", i ? ", " : "",
+               gPlace ? t->placement.queue : -1, gPlace ? t->placement.cpu : -1,
+               gPlace ? openavbPlacementCpuSourceName(t->placement.cpuSource) : "none", t->ranOnCpu);
+    }
+    printf("], \"ok\": %s}\n", ok ? "true" : "false");
+
+    if (csvPath) {
+        FILE *csv = fopen(csvPath, "a");
+        if (csv) {
+            fseek(csv, 0, SEEK_END);
+            if (ftell(csv) == 0) {
+                fprintf(csv, "label,backend,placed,streams,sent,tx_errors,elapsed_sec,frames_per_sec,"
+                             "cpu_usec_per_frame,cores_used,unplaced_frames,ok\n");
+            }
+            fprintf(csv, "%s,%s,%d,%u,%" PRIu64 ",%u,%.3f,%.0f,%.3f,%u,%" PRIu64 ",%d\n",
+                    label, backend, gPlace, streams, sent, txErrors, elapsedMax,
+                    elapsedMax > 0 ? sent / elapsedMax : 0.0, sent ? cpu / sent : 0.0, cores,
+                    unplacedFrames, ok);
+            fclose(csv);
+        }
+    }
+
+    return ok ? 0 : 2;
+}